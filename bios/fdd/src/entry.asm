@@ -142,6 +142,11 @@ rom_init:
     ; Map profiles to drive type codes
     call    map_drive_types
 
+%if ENABLE_FWIN
+    ; Find the FDC track window for INT 13h reads
+    call    fwin_detect
+%endif
+
     ; Setup default DOS drive letter mapping
     call    setup_default_mapping
 
@@ -318,6 +323,11 @@ motor_status:
 secondary_fdc_present:
     db      0                       ; Secondary FDC (0x370) present flag
 
+%if ENABLE_FWIN
+fwin_seg:
+    dw      0                       ; FDC track window segment, 0 = none
+%endif
+
 ;------------------------------------------------------------------------------
 ; Drive Letter Mapping Tables
 ;------------------------------------------------------------------------------
@@ -570,3 +570,185 @@ fdc_read_id:
     pop     dx
     pop     cx
     ret
+
+%if ENABLE_FWIN
+;==============================================================================
+; Detect FDC Track Window
+;==============================================================================
+; Finds the FluxRipper FDC track window (CONFIG_FDC_WIN) by its header.
+; In legacy mode the window is enabled at E8000h first, with 16-bit cycles
+; in an AT slot; in PnP mode it is wherever the PnP BIOS put the memory
+; range of logical device 0, if anywhere.
+;
+; Input:  None
+; Output: [fwin_seg] = window segment, 0 if there is none
+;==============================================================================
+fwin_detect:
+    push    ax
+    push    cx
+    push    dx
+    push    es
+
+    mov     word [fwin_seg], 0
+
+    mov     dx, FDC_PRIMARY + CFG_REG_BASE + CFG_FDC_WIN
+    in      al, dx
+    test    al, CFG_FWIN_PRESENT
+    jz      .done
+
+    ; PnP mode: the memory config of LD0 decides, leave the register alone
+    mov     dx, FDC_PRIMARY + CFG_REG_BASE + CFG_STATUS
+    in      al, dx
+    test    al, CFG_STAT_PNP
+    jnz     .scan
+
+    mov     ah, CFG_FWIN_EN | CFG_FWIN_BASE_E800
+    test    al, CFG_STAT_16BIT
+    jz      .enable
+    or      ah, CFG_FWIN_16BIT
+.enable:
+    mov     al, ah
+    mov     dx, FDC_PRIMARY + CFG_REG_BASE + CFG_FDC_WIN
+    out     dx, al
+
+.scan:
+    ; Look for the header in every 32KB slot the window can occupy
+    mov     ax, FWIN_SEG_FIRST
+    mov     cx, FWIN_SLOTS
+
+.probe:
+    mov     es, ax
+    cmp     word [es:FWIN_HDR], 'FR'
+    jne     .next
+    cmp     word [es:FWIN_HDR + 2], 'FW'
+    jne     .next
+    mov     [fwin_seg], ax
+    jmp     .done
+
+.next:
+    add     ax, FWIN_SLOT_PARAS
+    loop    .probe
+
+.done:
+    pop     es
+    pop     dx
+    pop     cx
+    pop     ax
+    ret
+
+;==============================================================================
+; Arm FDC Track Window Fill
+;==============================================================================
+; Makes the card collect the data phase of the next FDC read command in the
+; track window instead of requesting DMA. The fill ends with the command's
+; interrupt; fwin_cancel ends it early.
+;
+; Input:  None
+; Output: CF=0 if armed, CF=1 if the fill did not start (config locked)
+;==============================================================================
+fwin_arm:
+    push    ax
+    push    dx
+
+    mov     dx, FDC_PRIMARY + CFG_REG_BASE + CFG_FDC_WIN
+    in      al, dx
+    and     al, CFG_FWIN_EN | CFG_FWIN_BASE_MASK | CFG_FWIN_16BIT
+    or      al, CFG_FWIN_FILL
+    out     dx, al
+
+    in      al, dx
+    test    al, CFG_FWIN_FILL
+    jnz     .armed
+
+    stc
+    jmp     .done
+
+.armed:
+    clc
+
+.done:
+    pop     dx
+    pop     ax
+    ret
+
+;==============================================================================
+; Cancel FDC Track Window Fill
+;==============================================================================
+; Puts FDC DMA requests back on the bus after a read that failed before its
+; interrupt.
+;
+; Input:  None
+; Output: None
+;==============================================================================
+fwin_cancel:
+    push    ax
+    push    dx
+
+    mov     dx, FDC_PRIMARY + CFG_REG_BASE + CFG_FDC_WIN
+    in      al, dx
+    and     al, CFG_FWIN_EN | CFG_FWIN_BASE_MASK | CFG_FWIN_16BIT
+    out     dx, al
+
+    pop     dx
+    pop     ax
+    ret
+
+;==============================================================================
+; Copy Sectors from FDC Track Window
+;==============================================================================
+; Copies the first sectors of the last fill to the caller's buffer.
+;
+; Input:  ES:BX = buffer address
+;         CL = sector count (1 to FWIN_MAX_SECTORS)
+; Output: CF=0 on success, CF=1 if the fill is still active or ended short
+;==============================================================================
+fwin_copy:
+    push    ax
+    push    cx
+    push    si
+    push    di
+    push    ds
+    push    es
+
+    ; Byte count = sectors * 512
+    xor     ch, ch
+    mov     ah, cl
+    xor     al, al
+    shl     ax, 1
+    mov     cx, ax
+
+    ; Normalize ES:BX so the copy cannot wrap the offset
+    mov     di, bx
+    shr     di, 4
+    mov     ax, es
+    add     ax, di
+    mov     es, ax
+    mov     di, bx
+    and     di, 0x000F
+
+    mov     ax, [fwin_seg]
+    mov     ds, ax
+    test    byte [FWIN_HDR + FWIN_HDR_STATUS], FWIN_STAT_FILL
+    jnz     .short
+    cmp     [FWIN_HDR + FWIN_HDR_COUNT], cx
+    jb      .short
+
+    xor     si, si
+    shr     cx, 1
+    cld
+    rep     movsw
+    clc
+    jmp     .done
+
+.short:
+    stc
+
+.done:
+    pop     es
+    pop     ds
+    pop     di
+    pop     si
+    pop     cx
+    pop     ax
+    ret
+%endif
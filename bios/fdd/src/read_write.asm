@@ -21,6 +21,11 @@
 ; Output: AH = status
 ;         AL = sectors read
 ;         CF = 0 if success, 1 if error
+;
+; With the FluxRipper track window the data phase goes to window memory
+; and is copied out with REP MOVSW; the 8237 is not used. Without terminal
+; count the FDC stops at EOT, so EOT is the last sector wanted and MT is
+; only set when the request runs onto head 1.
 ;==============================================================================
 int13h_read_sectors:
     push    bx
@@ -37,6 +42,9 @@ int13h_read_sectors:
     push    dx                      ; [bp-6] = head/drive
     push    bx                      ; [bp-8] = buffer offset
     push    es                      ; [bp-10] = buffer segment
+    sub     sp, 2                   ; [bp-12] = window EOT (0 = DMA)
+                                    ; [bp-11] = window command
+    mov     byte [bp-12], 0
 
     ; Get drive type for data rate
     mov     bl, dl
@@ -56,6 +64,35 @@ int13h_read_sectors:
     call    fdc_seek
     jc      .error
 
+%if ENABLE_FWIN
+    ; Track window read if there is one and the request fits
+    cmp     word [fwin_seg], 0
+    je      .dma
+    cmp     byte [bp-2], FWIN_MAX_SECTORS
+    ja      .dma
+    call    fwin_arm
+    jc      .dma
+
+    mov     bl, [bp-6]              ; Drive number
+    xor     bh, bh
+    shl     bx, 2
+    mov     ah, [drive_params + bx + 3]  ; SPT
+    mov     al, [bp-4]              ; Starting sector
+    and     al, 0x3F
+    add     al, [bp-2]
+    dec     al                      ; Last sector wanted
+    mov     dl, CMD_READ_DATA & ~OPT_MT
+    cmp     al, ah
+    jbe     .window_eot
+    mov     al, ah                  ; Continues on head 1
+    mov     dl, CMD_READ_DATA
+.window_eot:
+    mov     [bp-12], al
+    mov     [bp-11], dl
+    jmp     .command
+
+.dma:
+%endif
     ; Setup DMA for read
     mov     ax, [bp-10]             ; Buffer segment
     mov     bx, [bp-8]              ; Buffer offset
@@ -64,8 +101,13 @@ int13h_read_sectors:
     call    setup_dma
     jc      .error
 
+.command:
     ; Send READ DATA command
     mov     al, CMD_READ_DATA
+    cmp     byte [bp-12], 0
+    je      .send_command
+    mov     al, [bp-11]             ; Window read: MT per request
+.send_command:
     call    fdc_write_data
     jc      .error
 
@@ -109,6 +151,10 @@ int13h_read_sectors:
     xor     bh, bh
     shl     bx, 2
     mov     al, [drive_params + bx + 3]  ; SPT
+    cmp     byte [bp-12], 0
+    je      .send_eot
+    mov     al, [bp-12]             ; Window read: stop at the last sector
+.send_eot:
     call    fdc_write_data
     jc      .error
 
@@ -142,7 +188,29 @@ int13h_read_sectors:
     mov     al, [ss:di]             ; ST0
     and     al, ST0_IC
     cmp     al, ST0_IC_NORMAL
+%if ENABLE_FWIN
+    je      .transferred
+
+    ; No terminal count on a window read: ending at EOT is success
+    cmp     byte [bp-12], 0
+    je      .error_check_st
+    cmp     al, ST0_IC_ABNORMAL
+    jne     .error_check_st
+    cmp     byte [ss:di+1], ST1_EN
+    jne     .error_check_st
+
+.transferred:
+    cmp     byte [bp-12], 0
+    je      .success
+    mov     es, [bp-10]             ; Buffer segment
+    mov     bx, [bp-8]              ; Buffer offset
+    mov     cl, [bp-2]              ; Sector count
+    call    fwin_copy
+    jc      .error_cleanup
+.success:
+%else
     jne     .error_check_st
+%endif
 
     ; Success
     add     sp, 8
@@ -187,13 +255,19 @@ int13h_read_sectors:
     mov     ah, STAT_TIMEOUT
 
 .set_error:
+%if ENABLE_FWIN
+    cmp     byte [bp-12], 0
+    je      .status
+    call    fwin_cancel             ; DRQ2 back on the bus
+.status:
+%endif
     mov     al, ah
     call    set_disk_status
     xor     al, al                  ; No sectors read
     stc
 
 .done:
-    add     sp, 10                  ; Clean up saved parameters
+    add     sp, 12                  ; Clean up saved parameters
     pop     bp
     pop     di
     pop     si
@@ -142,6 +142,9 @@ rom_init:
     ; Set up Fixed Disk Parameter Tables in our ROM
     call    setup_fdpt
 
+    ; Track window for fast reads (optional)
+    call    twin_detect
+
     ; Hook INT 13h
     call    hook_int13h
 
@@ -216,6 +219,7 @@ detect_fluxripper:
 %include "int13h.asm"
 %include "func_basic.asm"
 %include "wd_io.asm"
+%include "track_window.asm"
 %include "geometry.asm"
 %include "boot.asm"
 %include "strings.asm"
@@ -317,6 +321,12 @@ current_base:
 personality:
     db      PERSONALITY_WD1003      ; Detected personality (WD1002/3/6/7)
 
+twin_seg:
+    dw      0                       ; Track window segment (0 = PIO only)
+
+twin_done:
+    dw      0                       ; Sectors moved by the last twin_read
+
 ;==============================================================================
 ; ROM Padding and Checksum
 ;==============================================================================
@@ -158,6 +158,16 @@ int13h_read_sectors:
     mov     [.sector_count], al
     mov     byte [.sectors_done], 0
 
+    ; Track window: whole request in LOAD WINDOW chunks
+    cmp     word [twin_seg], 0
+    je      .pio
+    call    twin_read_chs
+    jnc     .done
+    cmp     word [twin_seg], 0      ; Refused: fall back to PIO
+    jne     .done
+    mov     al, [.sector_count]
+
+.pio:
     ; Select drive and head
     call    select_drive
 
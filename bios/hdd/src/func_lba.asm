@@ -82,6 +82,16 @@ int13h_ext_read:
     push    bp
     push    es
 
+    ; Track window: DAP is at the caller's DS:SI (INT13_SAVE_REGS frame)
+    cmp     word [twin_seg], 0
+    je      .pio
+    mov     es, [bp + 14]
+    call    twin_ext_read
+    jnc     .done
+    cmp     word [twin_seg], 0      ; Refused: fall back to PIO
+    jne     .done
+
+.pio:
     ; Validate DAP
     mov     bp, si                  ; BP = DAP pointer
     cmp     byte [si], DAP_SIZE_BASIC
@@ -0,0 +1,404 @@
+;==============================================================================
+; FluxRipper HDD BIOS - Track Window Read Path
+;==============================================================================
+; Fast multi-sector reads through the FluxRipper track window: a 16KB
+; read-only memory window onto the controller's track buffer. One LOAD
+; WINDOW command (F0h) reads up to TWIN_SECTORS sectors into the buffer
+; and ends with BSY clear, no DRQ; the sectors are then copied out with
+; REP MOVSW. That replaces a DRQ wait and 256 data port reads per sector
+; with one command per track buffer.
+;
+; Reads only. Writes and every other command keep the task file path.
+; If the window is missing, or the controller rejects LOAD WINDOW,
+; twin_seg stays/becomes 0 and callers use the PIO path.
+;
+; SPDX-License-Identifier: BSD-3-Clause
+; Copyright (c) 2025 FluxRipper Project
+;==============================================================================
+
+;==============================================================================
+; Detect and Enable the Track Window
+;==============================================================================
+; Enables the window at its configured base (CFG_XFER) and checks the
+; header the firmware keeps after the data sectors. 16-bit cycles are
+; only turned on in an AT slot with the window at E000h or above:
+; MEMCS16# covers a whole 128KB block, so it would break the 8-bit
+; option ROM in C000h-DFFFh.
+;
+; Output: [twin_seg] = window segment, 0 if not usable
+; Destroys: AX, BX, CX, DX, ES
+;==============================================================================
+twin_detect:
+    mov     word [twin_seg], 0
+
+    mov     dx, [current_base]
+    add     dx, CFG_REG_BASE + CFG_XFER
+    in      al, dx
+    test    al, CFG_XFER_PRESENT
+    jz      .done
+
+    and     al, CFG_XFER_BASE_MASK
+    mov     bl, al                  ; BL = base select << 1
+
+    ; 16-bit cycles: AT slot and a block of its own
+    cmp     bl, CFG_XFER_BASE_E000
+    jb      .enable
+    push    dx
+    mov     dx, [current_base]
+    add     dx, CFG_REG_BASE + CFG_STATUS
+    in      al, dx
+    pop     dx
+    test    al, CFG_STAT_16BIT
+    jz      .enable
+    or      bl, CFG_XFER_16BIT
+
+.enable:
+    mov     al, bl
+    or      al, CFG_XFER_WIN_EN
+    out     dx, al
+    in      al, dx                  ; Config may be locked
+    test    al, CFG_XFER_WIN_EN
+    jz      .done
+
+    ; Segment = TWIN_SEG_BASE + select * 400h
+    xor     bh, bh
+    and     bl, CFG_XFER_BASE_MASK
+    mov     cl, 9
+    shl     bx, cl
+    add     bx, TWIN_SEG_BASE
+    mov     es, bx
+
+    ; Header written by the firmware: 'FRTW', version, capacity
+    cmp     word [es:TWIN_HDR], 'FR'
+    jne     .disable
+    cmp     word [es:TWIN_HDR + 2], 'TW'
+    jne     .disable
+    cmp     byte [es:TWIN_HDR + TWIN_HDR_CAPACITY], TWIN_SECTORS
+    jb      .disable
+
+    mov     [twin_seg], bx
+    jmp     .done
+
+.disable:
+    in      al, dx
+    and     al, ~CFG_XFER_WIN_EN
+    out     dx, al
+
+.done:
+    ret
+
+;==============================================================================
+; Read Sectors Through the Track Window
+;==============================================================================
+; Reads in LOAD WINDOW chunks. The controller advances the task file
+; past each loaded chunk, so only the sector count is rewritten between
+; commands. On an error the sectors before the failing one are still
+; copied out.
+;
+; Input:  AX = sector count
+;         BX = cylinder
+;         CL = sector (1-based)
+;         DH = head
+;         DL = drive (80h, 81h)
+;         ES:DI = buffer
+; Output: AH = status
+;         CF = 0 if success, 1 if error
+;         [twin_done] = sectors read
+;         ES:DI advanced past the data (normalized)
+; Destroys: AL
+;==============================================================================
+twin_read:
+    push    bx
+    push    cx
+    push    dx
+
+    mov     word [twin_done], 0
+    mov     [.remaining], ax
+    test    ax, ax
+    jz      .success
+
+    push    cx
+    push    dx
+    call    select_drive
+    call    wait_drive_ready
+    pop     dx
+    pop     cx
+    jc      .timeout
+
+    ; Starting sector and cylinder
+    mov     dx, [current_base]
+    add     dx, WD_SECNUM
+    mov     al, cl
+    out     dx, al
+    inc     dx                      ; WD_CYL_LO
+    mov     al, bl
+    out     dx, al
+    inc     dx                      ; WD_CYL_HI
+    mov     al, bh
+    out     dx, al
+
+.chunk:
+    mov     ax, TWIN_SECTORS
+    cmp     ax, [.remaining]
+    jbe     .count_ok
+    mov     ax, [.remaining]
+.count_ok:
+    mov     [.chunk_len], al
+    mov     dx, [current_base]
+    add     dx, WD_SECCNT
+    out     dx, al
+
+    mov     dx, [current_base]
+    add     dx, WD_COMMAND
+    mov     al, CMD_LOAD_WINDOW
+    out     dx, al
+
+    call    twin_wait
+    jc      .timeout
+    test    al, STS_ERR
+    jnz     .error
+
+    mov     al, [.chunk_len]
+    call    twin_copy
+    xor     ah, ah
+    add     [twin_done], ax
+    sub     [.remaining], ax
+    jnz     .chunk
+
+.success:
+    mov     ah, ST_SUCCESS
+    clc
+    jmp     .done
+
+.error:
+    ; Sector count holds what was not loaded
+    mov     dx, [current_base]
+    add     dx, WD_SECCNT
+    in      al, dx
+    mov     ah, [.chunk_len]
+    sub     ah, al
+    mov     al, ah
+    call    twin_copy
+    xor     ah, ah
+    add     [twin_done], ax
+
+    mov     dx, [current_base]
+    add     dx, WD_ERROR
+    in      al, dx
+    test    al, ERR_ABRT
+    jz      .translate
+    cmp     word [twin_done], 0
+    jne     .translate
+    mov     word [twin_seg], 0      ; LOAD WINDOW refused: PIO from now on
+
+.translate:
+    call    translate_error
+    stc
+    jmp     .done
+
+.timeout:
+    mov     ah, ST_TIMEOUT
+    stc
+
+.done:
+    pop     dx
+    pop     cx
+    pop     bx
+    ret
+
+.remaining:     dw 0
+.chunk_len:     db 0
+
+;==============================================================================
+; Copy Sectors Out of the Track Window
+;==============================================================================
+; Input:  AL = sectors (from window offset 0)
+;         ES:DI = destination
+; Output: ES:DI advanced, normalized so the offset stays below 10h
+; Destroys: None
+;==============================================================================
+twin_copy:
+    push    ax
+    push    cx
+    push    si
+    push    ds
+
+    mov     ch, al
+    xor     cl, cl                  ; CX = sectors * 256 words
+    mov     ds, [twin_seg]
+    xor     si, si
+    cld
+    rep movsw
+
+    pop     ds
+
+    ; Fold DI into ES: requests over 127 sectors would wrap the offset
+    mov     ax, di
+    mov     cl, 4
+    shr     ax, cl
+    mov     cx, es
+    add     cx, ax
+    mov     es, cx
+    and     di, 0x000F
+
+    pop     si
+    pop     cx
+    pop     ax
+    ret
+
+;==============================================================================
+; Wait for LOAD WINDOW Completion
+;==============================================================================
+; A load can include a seek and a full revolution, longer than one
+; TIMEOUT_BSY_CLR loop.
+;
+; Output: CF = 0 if BSY clear, CF = 1 if timeout
+;         AL = status register value
+; Destroys: AX, CX, DX
+;==============================================================================
+twin_wait:
+    push    bx
+    mov     bx, TWIN_WAIT_LOOPS
+
+.again:
+    call    wd_wait_not_busy
+    jnc     .done
+    dec     bx
+    jnz     .again
+    stc
+
+.done:
+    pop     bx
+    ret
+
+;==============================================================================
+; Function 02h Fast Path
+;==============================================================================
+; Input:  Function 02h registers (AL count, CX/DH CHS, DL drive, ES:BX)
+;         [twin_seg] != 0
+; Output: AH = status
+;         AL = sectors read
+;         CF = 0 if success, 1 if error. If [twin_seg] is 0 afterwards
+;         nothing was read and the caller should use PIO.
+; Destroys: None besides AX
+;==============================================================================
+twin_read_chs:
+    push    bx
+    push    cx
+    push    di
+    push    es
+
+    mov     di, bx                  ; ES:DI = buffer
+    mov     bl, ch                  ; BX = cylinder
+    mov     bh, cl
+    shr     bh, 6
+    and     cl, 0x3F                ; CL = sector
+    xor     ah, ah                  ; AX = count
+    call    twin_read
+    mov     al, [twin_done]
+
+    pop     es
+    pop     di
+    pop     cx
+    pop     bx
+    ret
+
+%if ENABLE_LBA
+;==============================================================================
+; Function 42h Fast Path
+;==============================================================================
+; LBA to CHS with the full cylinder range (no 1024 limit), then
+; twin_read. Only the low 32 bits of the LBA are supported.
+;
+; Input:  ES:SI = caller's DAP
+;         DL = drive
+;         [twin_seg] != 0
+; Output: AH = status
+;         CF = 0 if success, 1 if error
+;         DAP count = sectors read
+;         If [twin_seg] is 0 afterwards nothing was read and the caller
+;         should use PIO.
+; Destroys: None besides AX
+;==============================================================================
+twin_ext_read:
+    push    bx
+    push    cx
+    push    dx
+    push    si
+    push    di
+    push    bp
+    push    es
+
+    mov     bp, si                  ; ES:BP = DAP
+    cmp     byte [es:bp + DAP.size], DAP_SIZE_BASIC
+    jb      .invalid_dap
+    cmp     word [es:bp + DAP.count], 0
+    je      .success
+
+    mov     ax, [es:bp + DAP.lba + 4]
+    or      ax, [es:bp + DAP.lba + 6]
+    jnz     .out_of_range
+
+    push    dx
+    call    get_drive_params        ; SI = drive parameters
+    pop     dx
+    jc      .invalid_dap
+    mov     [.drive], dl
+
+    ; LBA / sectors per track
+    mov     ax, [es:bp + DAP.lba]
+    mov     dx, [es:bp + DAP.lba + 2]
+    xor     bh, bh
+    mov     bl, [si + 3]
+    cmp     dx, bx                  ; Quotient must fit 16 bits
+    jae     .out_of_range
+    div     bx                      ; AX = track, DX = sector - 1
+    inc     dl
+    mov     cl, dl                  ; CL = sector
+
+    ; Track / heads
+    xor     dx, dx
+    mov     bl, [si + 2]
+    div     bx                      ; AX = cylinder, DX = head
+    cmp     ax, [si]
+    jae     .out_of_range
+
+    mov     dh, dl                  ; DH = head
+    mov     dl, [.drive]
+    mov     bx, ax                  ; BX = cylinder
+    mov     ax, [es:bp + DAP.count]
+    push    es
+    les     di, [es:bp + DAP.buffer]
+    call    twin_read
+    pop     es
+    mov     si, [twin_done]
+    mov     [es:bp + DAP.count], si
+    jmp     .done
+
+.success:
+    mov     ah, ST_SUCCESS
+    clc
+    jmp     .done
+
+.invalid_dap:
+    mov     ah, ST_BAD_COMMAND
+    stc
+    jmp     .done
+
+.out_of_range:
+    mov     word [es:bp + DAP.count], 0
+    mov     ah, ST_SECTOR_NOT_FOUND
+    stc
+
+.done:
+    pop     es
+    pop     bp
+    pop     di
+    pop     si
+    pop     dx
+    pop     cx
+    pop     bx
+    ret
+
+.drive:         db 0
+%endif ; ENABLE_LBA
@@ -6,6 +6,7 @@
 //   0x00-0x2C: Standard 82077AA + FluxRipper registers (Interface A)
 //   0x30-0x74: Dual interface extension registers
 //   0x78-0x9C: QIC-117 Tape interface registers
+//   0xA0-0xA8: QIC-117 segment capture (axi_stream_tape)
 //
 // Target: AMD Spartan UltraScale+ SCU35
 // Updated: 2025-12-10
@@ -212,7 +213,16 @@ module axi_fdc_periph_dual (
     input  wire [15:0] tape_error_count,         // Error count
     input  wire        tape_is_file_mark,        // Current block is file mark
     input  wire        tape_is_eod,              // Current block is EOD
-    input  wire        tape_streaming            // Tape is currently streaming
+    input  wire        tape_streaming,           // Tape is currently streaming
+
+    // Segment capture (axi_stream_tape)
+    output reg         tape_seg_enable,          // Capture blocks to the DMA stream
+    output reg         tape_seg_clear,           // Clear the capture counters (pulse)
+    input  wire        tape_seg_active,          // Block staged or being sent
+    input  wire [15:0] tape_seg_blocks,          // Blocks sent
+    input  wire [15:0] tape_seg_segments,        // Segments sent
+    input  wire [15:0] tape_seg_ecc_errors,      // Blocks sent with an ECC error
+    input  wire [15:0] tape_seg_gaps             // Blocks sent after a dropped one
 );
 
     //-------------------------------------------------------------------------
@@ -269,6 +279,9 @@ module axi_fdc_periph_dual (
     localparam ADDR_TAPE_DATA_FIFO     = 8'h94;  // Tape data FIFO read port
     localparam ADDR_TAPE_DATA_STATUS   = 8'h98;  // Tape data streaming status
     localparam ADDR_TAPE_BLOCK_INFO    = 8'h9C;  // Current block info
+    localparam ADDR_TAPE_SEG_CTRL      = 8'hA0;  // Segment capture control
+    localparam ADDR_TAPE_SEG_COUNT     = 8'hA4;  // Segments/blocks sent
+    localparam ADDR_TAPE_SEG_ERRORS    = 8'hA8;  // Gaps/ECC errors
 
     //-------------------------------------------------------------------------
     // Version constant
@@ -464,6 +477,8 @@ module axi_fdc_periph_dual (
             tape_direct_strobe  <= 1'b0;
             tape_start_detect   <= 1'b0;
             tape_abort_detect   <= 1'b0;
+            tape_seg_enable     <= 1'b0;
+            tape_seg_clear      <= 1'b0;
             tape_fifo_wr_ptr    <= {TAPE_FIFO_BITS{1'b0}};
             tape_fifo_rd_ptr    <= {TAPE_FIFO_BITS{1'b0}};
             tape_fifo_count     <= {(TAPE_FIFO_BITS+1){1'b0}};
@@ -480,6 +495,7 @@ module axi_fdc_periph_dual (
             tape_direct_strobe <= 1'b0;
             tape_start_detect  <= 1'b0;
             tape_abort_detect  <= 1'b0;
+            tape_seg_clear     <= 1'b0;
 
             case (state)
                 S_IDLE: begin
@@ -606,6 +622,13 @@ module axi_fdc_periph_dual (
                                 tape_start_detect <= s_axi_wdata[0];
                                 tape_abort_detect <= s_axi_wdata[1];
                             end
+
+                            ADDR_TAPE_SEG_CTRL: begin
+                                // Bit 0: capture enable
+                                // Bit 1: clear counters (pulse)
+                                tape_seg_enable <= s_axi_wdata[0];
+                                tape_seg_clear  <= s_axi_wdata[1];
+                            end
                         endcase
 
                         s_axi_bresp <= 2'b00;  // OKAY
@@ -816,6 +839,18 @@ module axi_fdc_periph_dual (
                             s_axi_rdata <= tape_block_info_value;
                         end
 
+                        ADDR_TAPE_SEG_CTRL: begin
+                            s_axi_rdata <= {tape_seg_active, 30'd0, tape_seg_enable};
+                        end
+
+                        ADDR_TAPE_SEG_COUNT: begin
+                            s_axi_rdata <= {tape_seg_segments, tape_seg_blocks};
+                        end
+
+                        ADDR_TAPE_SEG_ERRORS: begin
+                            s_axi_rdata <= {tape_seg_gaps, tape_seg_ecc_errors};
+                        end
+
                         default: begin
                             s_axi_rdata <= 32'hDEADBEEF;
                         end
@@ -0,0 +1,428 @@
+//-----------------------------------------------------------------------------
+// AXI-Stream QIC-117 Tape Segment Capture
+// FluxRipper - FPGA-based Floppy Disk Controller
+//
+// Packs the blocks found by qic117_data_streamer into an AXI-Stream for the
+// S2MM DMA, so a tape can be imaged in one continuous pass: the firmware
+// only re-arms the DMA once per segment while the tape keeps moving.
+//
+// Each block is staged in the clk_sys domain while its bytes arrive and
+// its syndrome is computed by reed_solomon_ecc. A complete block is then
+// handed to the AXI domain and sent as one 130-word record:
+//
+//   Words 0-128: the 516 block bytes (header, 512 data, 3 ECC), packed
+//                little-endian (byte 4n in bits 7:0 of word n)
+//   Word 129:    record status
+//                [31:16] segment position at the start of the block
+//                [15:11] block number from the streamer
+//                [10]    ECC error (non-zero syndrome)
+//                [9]     gap: one or more blocks were dropped before this one
+//                [8]     0
+//                [7:0]   header byte
+//
+// Segments are framed by the tape position, not by counting blocks: when
+// the position moves on (INDEX) or the tape stops, a segment that sent
+// records is closed by a single trailer word with TLAST set:
+//                [31:16] segment position
+//                [8]     1 (trailer)
+//                [5:0]   records sent for the segment
+// Each S2MM transfer therefore holds exactly one segment, at most
+// 32 x 520 + 4 bytes, even after blocks were lost.
+//
+// Two staging banks are used: one is sent while the next block arrives,
+// which leaves the firmware about one block time (over 4ms at 1 Mbps) to
+// re-arm the DMA after each segment. A block that finds both banks full,
+// or that loses sync, is dropped; the next record carries the gap flag.
+// Clearing capture_enable drops any staged block, so a stream restarted
+// after repositioning the tape begins with fresh data.
+//
+// The ECC check is detection only: reed_solomon_ecc reports a non-zero
+// syndrome but does not correct, so correction is left to the host.
+//
+// Target: AMD Spartan UltraScale+ (SCU35)
+// Author: FluxRipper Project
+// Created: 2025-12-11 21:10
+//-----------------------------------------------------------------------------
+
+`timescale 1ns / 1ps
+
+module axi_stream_tape #(
+    parameter BLOCK_BYTES  = 516,           // Header + data + ECC
+    parameter DATA_BYTES   = 512,
+    parameter ECC_BYTES    = 3,
+    parameter BLOCK_WORDS  = 129            // BLOCK_BYTES / 4
+)(
+    //-------------------------------------------------------------------------
+    // Clocks/Reset
+    //-------------------------------------------------------------------------
+    input  wire        clk_sys,           // Streamer clock (200MHz)
+    input  wire        aclk,              // AXI clock (100MHz)
+    input  wire        aresetn,
+
+    //-------------------------------------------------------------------------
+    // Data Streamer (clk_sys domain)
+    //-------------------------------------------------------------------------
+    input  wire [7:0]  tape_byte,         // Block byte
+    input  wire        tape_byte_valid,   // Byte strobe
+    input  wire        tape_is_header,    // Byte is the block header
+    input  wire        tape_is_ecc,       // Byte is ECC
+    input  wire        tape_block_start,  // Block started (with the header byte)
+    input  wire        tape_block_done,   // Last ECC byte received
+    input  wire        tape_sync_lost,    // Block aborted
+    input  wire [4:0]  tape_block_num,    // Block number in segment
+    input  wire [15:0] tape_segment,      // Segment position
+    input  wire        tape_streaming,    // Tape moving in a streaming mode
+
+    //-------------------------------------------------------------------------
+    // Control (aclk domain)
+    //-------------------------------------------------------------------------
+    input  wire        capture_enable,    // Accept new blocks
+    input  wire        clear,             // Clear the counters
+
+    //-------------------------------------------------------------------------
+    // AXI-Stream Master (to DMA)
+    //-------------------------------------------------------------------------
+    output wire [31:0] m_axis_tdata,
+    output wire        m_axis_tvalid,
+    input  wire        m_axis_tready,
+    output wire        m_axis_tlast,      // Segment trailer
+    output wire [3:0]  m_axis_tkeep,
+
+    //-------------------------------------------------------------------------
+    // Status (aclk domain)
+    //-------------------------------------------------------------------------
+    output reg  [15:0] blocks_sent,
+    output reg  [15:0] ecc_errors,        // Records sent with a non-zero syndrome
+    output reg  [15:0] segments_sent,     // Trailers sent
+    output reg  [15:0] gaps,              // Records sent with the gap flag
+    output wire        active             // Record staged or being sent
+);
+
+    localparam STATUS_WORD = BLOCK_WORDS;   // Word index of the status word
+
+    localparam ST_TRAILER  = 8;             // Status bit: trailer word
+    localparam ST_GAP      = 9;
+    localparam ST_ECC      = 10;
+
+    //=========================================================================
+    // Staging Banks (written in clk_sys, read in aclk)
+    //=========================================================================
+    // One byte lane per array, two banks of BLOCK_WORDS words each
+    reg [7:0] lane0 [0:2*BLOCK_WORDS-1];
+    reg [7:0] lane1 [0:2*BLOCK_WORDS-1];
+    reg [7:0] lane2 [0:2*BLOCK_WORDS-1];
+    reg [7:0] lane3 [0:2*BLOCK_WORDS-1];
+
+    reg [31:0] bank_status [0:1];
+
+    //=========================================================================
+    // Bank Handshake
+    //=========================================================================
+    // A bank is full while its commit toggle (clk_sys) differs from its
+    // done toggle (aclk). Both sides walk the banks in order. bank_status
+    // is written before the commit toggle and read after it has crossed.
+    reg  [1:0] commit_tgl;
+    reg  [1:0] done_tgl;
+
+    reg  [1:0] done_sync1, done_sync2;      // done_tgl in clk_sys
+    reg  [1:0] commit_sync1, commit_sync2;  // commit_tgl in aclk
+    reg  [1:0] enable_sync;                 // capture_enable in clk_sys
+
+    wire [1:0] bank_full_sys  = commit_tgl ^ done_sync2;
+    wire [1:0] bank_ready_axi = commit_sync2 ^ done_tgl;
+    wire       enabled        = enable_sync[1];
+
+    //=========================================================================
+    // Syndrome Check
+    //=========================================================================
+    // Flushed at every block start so an aborted block cannot leave it
+    // mid-count, then started for the block's 515 data and ECC bytes.
+    reg  rs_flush;
+    reg  rs_start;
+    wire rs_done;
+    wire rs_error;
+
+    reed_solomon_ecc #(
+        .DATA_BYTES(DATA_BYTES),
+        .ECC_BYTES(ECC_BYTES)
+    ) u_rs (
+        .clk(clk_sys),
+        .reset_n(aresetn && !rs_flush),
+        .enable(1'b1),
+        .encode_mode(1'b0),
+        .start(rs_start),
+        .busy(),
+        .done(rs_done),
+        .data_in(tape_byte),
+        .data_valid(tape_byte_valid && !tape_is_header && !tape_is_ecc),
+        .data_out(),
+        .data_out_valid(),
+        .ecc_out(),
+        .ecc_out_valid(),
+        .ecc_in(tape_byte),
+        .ecc_in_valid(tape_byte_valid && tape_is_ecc),
+        .decode_error(rs_error),
+        .errors_corrected(),
+        .error_positions()
+    );
+
+    //=========================================================================
+    // Block Capture (clk_sys)
+    //=========================================================================
+    reg        wr_bank;             // Bank of the next record
+    reg        wr_active;           // Storing a block
+    reg        wr_pending;          // Block complete, waiting for the syndrome
+    reg [9:0]  wr_byte;             // Byte index in the block
+    reg        wr_gap;              // Blocks lost since the last record
+    reg [15:0] wr_segment;
+    reg [4:0]  wr_block;
+    reg [7:0]  wr_header;
+
+    // Segment framing
+    reg [15:0] seg_pos_d;           // tape_segment last cycle
+    reg        streaming_d;
+    reg        seg_open;            // Records sent for seg_cur
+    reg [15:0] seg_cur;
+    reg [5:0]  seg_records;
+    reg        trl_pending;         // Trailer waiting for a bank
+    reg [15:0] trl_segment;
+    reg [5:0]  trl_records;
+
+    wire       seg_end = seg_open &&
+                         (tape_segment != seg_pos_d || (streaming_d && !tape_streaming));
+
+    wire [8:0] wr_base  = wr_bank ? BLOCK_WORDS : 9'd0;
+
+    // A block is taken if capture is on, no trailer is owed and its bank
+    // has been sent
+    wire       wr_accept = tape_block_start && enabled && !trl_pending &&
+                           !bank_full_sys[wr_bank];
+
+    // The header byte comes with tape_block_start, before wr_active is set
+    wire       wr_store = tape_byte_valid &&
+                          (wr_accept || (wr_active && !tape_block_start && wr_byte < BLOCK_BYTES));
+    wire [9:0] wr_index = wr_accept ? 10'd0 : wr_byte;
+    wire [8:0] wr_addr  = wr_base + wr_index[9:2];
+
+    always @(posedge clk_sys) begin
+        if (wr_store) begin
+            case (wr_index[1:0])
+                2'd0: lane0[wr_addr] <= tape_byte;
+                2'd1: lane1[wr_addr] <= tape_byte;
+                2'd2: lane2[wr_addr] <= tape_byte;
+                2'd3: lane3[wr_addr] <= tape_byte;
+            endcase
+        end
+    end
+
+    always @(posedge clk_sys or negedge aresetn) begin
+        if (!aresetn) begin
+            done_sync1  <= 2'b00;
+            done_sync2  <= 2'b00;
+            enable_sync <= 2'b00;
+            commit_tgl  <= 2'b00;
+            wr_bank     <= 1'b0;
+            wr_active   <= 1'b0;
+            wr_pending  <= 1'b0;
+            wr_byte     <= 10'd0;
+            wr_gap      <= 1'b0;
+            wr_segment  <= 16'd0;
+            wr_block    <= 5'd0;
+            wr_header   <= 8'd0;
+            rs_flush    <= 1'b0;
+            rs_start    <= 1'b0;
+            seg_pos_d   <= 16'd0;
+            streaming_d <= 1'b0;
+            seg_open    <= 1'b0;
+            seg_cur     <= 16'd0;
+            seg_records <= 6'd0;
+            trl_pending <= 1'b0;
+            trl_segment <= 16'd0;
+            trl_records <= 6'd0;
+        end else begin
+            done_sync1  <= done_tgl;
+            done_sync2  <= done_sync1;
+            enable_sync <= {enable_sync[0], capture_enable};
+            seg_pos_d   <= tape_segment;
+            streaming_d <= tape_streaming;
+
+            rs_flush <= 1'b0;
+            rs_start <= rs_flush;
+
+            // Close the open segment when the tape moves past it
+            if (seg_end) begin
+                trl_pending <= 1'b1;
+                trl_segment <= seg_cur;
+                trl_records <= seg_records;
+                seg_open    <= 1'b0;
+                seg_records <= 6'd0;
+            end
+
+            if (!enabled) begin
+                // Capture off: nothing staged, nothing owed
+                wr_active   <= 1'b0;
+                wr_pending  <= 1'b0;
+                wr_gap      <= 1'b0;
+                seg_open    <= 1'b0;
+                seg_records <= 6'd0;
+                trl_pending <= 1'b0;
+            end else if (tape_block_start) begin
+                // A block still waiting for its syndrome is superseded
+                if (wr_active || wr_pending) begin
+                    wr_gap <= 1'b1;
+                end
+                wr_pending <= 1'b0;
+
+                if (wr_accept) begin
+                    wr_active  <= 1'b1;
+                    wr_byte    <= 10'd1;    // Header stored this cycle
+                    wr_segment <= tape_segment;
+                    wr_block   <= tape_block_num;
+                    wr_header  <= tape_byte;
+                    rs_flush   <= 1'b1;
+                end else begin
+                    wr_active <= 1'b0;
+                    wr_gap    <= 1'b1;      // Banks still with the AXI side
+                end
+            end else if (wr_active) begin
+                if (tape_sync_lost) begin
+                    wr_active <= 1'b0;
+                    wr_gap    <= 1'b1;
+                end else begin
+                    if (tape_byte_valid && wr_byte < BLOCK_BYTES) begin
+                        wr_byte <= wr_byte + 1'b1;
+                    end
+                    if (tape_block_done) begin
+                        wr_active  <= 1'b0;
+                        wr_pending <= 1'b1;
+                    end
+                end
+            end else if (wr_pending && rs_done) begin
+                // Block record
+                bank_status[wr_bank] <= {wr_segment, wr_block, rs_error, wr_gap,
+                                         1'b0, wr_header};
+                commit_tgl[wr_bank] <= ~commit_tgl[wr_bank];
+                wr_bank    <= ~wr_bank;
+                wr_pending <= 1'b0;
+                wr_gap     <= 1'b0;
+
+                // A block that started before the boundary belongs to
+                // the segment being closed
+                if (seg_end) begin
+                    trl_records <= seg_records + 1'b1;
+                end else if (trl_pending) begin
+                    trl_records <= trl_records + 1'b1;
+                end else begin
+                    seg_open    <= 1'b1;
+                    seg_cur     <= wr_segment;
+                    seg_records <= seg_records + 1'b1;
+                end
+            end else if (trl_pending && !seg_end && !wr_pending &&
+                         !bank_full_sys[wr_bank]) begin
+                // Segment trailer
+                bank_status[wr_bank] <= {trl_segment, 7'd0, 1'b1, 2'd0, trl_records};
+                commit_tgl[wr_bank] <= ~commit_tgl[wr_bank];
+                wr_bank     <= ~wr_bank;
+                trl_pending <= 1'b0;
+            end
+        end
+    end
+
+    //=========================================================================
+    // Record Output (aclk)
+    //=========================================================================
+    reg        rd_bank;
+    reg        rd_active;
+    reg [7:0]  rd_word;
+    reg [31:0] tdata_r;
+    reg        tvalid_r;
+    reg        tlast_r;
+
+    wire [8:0]  rd_addr    = (rd_bank ? BLOCK_WORDS : 9'd0) + rd_word;
+    wire [31:0] rd_status  = bank_status[rd_bank];
+    wire [31:0] rd_data    = {lane3[rd_addr], lane2[rd_addr], lane1[rd_addr], lane0[rd_addr]};
+    wire        rd_trailer = rd_status[ST_TRAILER];
+
+    always @(posedge aclk or negedge aresetn) begin
+        if (!aresetn) begin
+            commit_sync1  <= 2'b00;
+            commit_sync2  <= 2'b00;
+            done_tgl      <= 2'b00;
+            rd_bank       <= 1'b0;
+            rd_active     <= 1'b0;
+            rd_word       <= 8'd0;
+            tdata_r       <= 32'd0;
+            tvalid_r      <= 1'b0;
+            tlast_r       <= 1'b0;
+            blocks_sent   <= 16'd0;
+            ecc_errors    <= 16'd0;
+            segments_sent <= 16'd0;
+            gaps          <= 16'd0;
+        end else begin
+            commit_sync1 <= commit_tgl;
+            commit_sync2 <= commit_sync1;
+
+            if (clear) begin
+                blocks_sent   <= 16'd0;
+                ecc_errors    <= 16'd0;
+                segments_sent <= 16'd0;
+                gaps          <= 16'd0;
+            end
+
+            if (!capture_enable) begin
+                // Drop whatever is staged; the DMA is reset before reuse
+                rd_active <= 1'b0;
+                tvalid_r  <= 1'b0;
+                tlast_r   <= 1'b0;
+                if (bank_ready_axi[rd_bank]) begin
+                    done_tgl[rd_bank] <= ~done_tgl[rd_bank];
+                    rd_bank <= ~rd_bank;
+                end
+            end else begin
+                if (!rd_active && bank_ready_axi[rd_bank]) begin
+                    rd_active <= 1'b1;
+                    // A trailer is the status word alone
+                    rd_word   <= rd_trailer ? STATUS_WORD : 8'd0;
+                end
+
+                if (!tvalid_r || m_axis_tready) begin
+                    tvalid_r <= 1'b0;
+                    tlast_r  <= 1'b0;
+
+                    if (rd_active) begin
+                        tvalid_r <= 1'b1;
+
+                        if (rd_word == STATUS_WORD) begin
+                            tdata_r   <= rd_status;
+                            tlast_r   <= rd_trailer;
+                            rd_active <= 1'b0;
+                            rd_bank   <= ~rd_bank;
+                            done_tgl[rd_bank] <= ~done_tgl[rd_bank];
+
+                            if (!clear) begin
+                                if (rd_trailer) begin
+                                    segments_sent <= segments_sent + 1'b1;
+                                end else begin
+                                    blocks_sent <= blocks_sent + 1'b1;
+                                    ecc_errors  <= ecc_errors + rd_status[ST_ECC];
+                                    gaps        <= gaps + rd_status[ST_GAP];
+                                end
+                            end
+                        end else begin
+                            tdata_r <= rd_data;
+                            rd_word <= rd_word + 1'b1;
+                        end
+                    end
+                end
+            end
+        end
+    end
+
+    assign m_axis_tdata  = tdata_r;
+    assign m_axis_tvalid = tvalid_r;
+    assign m_axis_tlast  = tlast_r;
+    assign m_axis_tkeep  = 4'hF;
+
+    assign active = rd_active || tvalid_r || (bank_ready_axi != 2'b00);
+
+endmodule
@@ -12,12 +12,24 @@
 //   Supports single-word reads/writes and burst operations for efficiency.
 //   Used by both JTAG debug and CDC console commands.
 //
+//   The block engine copies (or fills) up to 256 words per command as one
+//   AXI INCR read burst into a local buffer followed by one INCR write
+//   burst, and flags completion in blk_done like a DMA channel. Commands
+//   must not cross a 4KB boundary; the driver splits transfers.
+//
+//   With blk_local set the read phase comes from the local port instead
+//   of AXI: blk_src is a word index into a debug-side BRAM (the trace
+//   buffer), streamed one word per clock, so a whole buffer reaches
+//   system memory in 256-word bursts without the CPU touching each word.
+//
 // Features:
 //   - 32-bit address, 32-bit data
-//   - AXI-Lite master interface
+//   - AXI-Lite master interface (plus INCR burst sidebands for blocks)
 //   - Transaction timeout detection
 //   - Error capture and reporting
 //   - Byte/half/word access modes
+//   - 256-beat block copy/fill with done/error status
+//   - Block copy from the local read port (trace buffer readout)
 //
 //-----------------------------------------------------------------------------
 
@@ -42,25 +54,51 @@ module debug_mem_port #(
     output                      error,
     output [1:0]                error_type, // 0=ok, 1=timeout, 2=slave_err, 3=decode_err
 
+    //-------------------------------------------------------------------------
+    // Block Transfer Interface
+    //-------------------------------------------------------------------------
+    input  [ADDR_WIDTH-1:0]     blk_src,    // Source address (copy)
+    input  [ADDR_WIDTH-1:0]     blk_dst,    // Destination address
+    input  [8:0]                blk_len,    // Words, 1-256
+    input                       blk_fill,   // Write blk_pattern instead of copying
+    input                       blk_local,  // Read from the local port (blk_src = word index)
+    input  [DATA_WIDTH-1:0]     blk_pattern,
+    input                       blk_start,  // Start pulse
+    output reg                  blk_busy,
+    output reg                  blk_done,   // Set on completion, cleared by start
+    output reg                  blk_error,  // Last block hit a bus error/timeout
+
+    //-------------------------------------------------------------------------
+    // Local Read Port (block source when blk_local)
+    //-------------------------------------------------------------------------
+    output [13:0]               loc_addr,   // Word index
+    input  [DATA_WIDTH-1:0]     loc_data,   // Word at loc_addr, one clock later
+
     //-------------------------------------------------------------------------
     // AXI-Lite Master Interface
     //-------------------------------------------------------------------------
     output reg [ADDR_WIDTH-1:0] m_axi_awaddr,
+    output reg [7:0]            m_axi_awlen,
+    output [1:0]                m_axi_awburst,
     output reg                  m_axi_awvalid,
     input                       m_axi_awready,
     output reg [DATA_WIDTH-1:0] m_axi_wdata,
     output reg [3:0]            m_axi_wstrb,
     output reg                  m_axi_wvalid,
+    output reg                  m_axi_wlast,
     input                       m_axi_wready,
     input  [1:0]                m_axi_bresp,
     input                       m_axi_bvalid,
     output reg                  m_axi_bready,
     output reg [ADDR_WIDTH-1:0] m_axi_araddr,
+    output reg [7:0]            m_axi_arlen,
+    output [1:0]                m_axi_arburst,
     output reg                  m_axi_arvalid,
     input                       m_axi_arready,
     input  [DATA_WIDTH-1:0]     m_axi_rdata,
     input  [1:0]                m_axi_rresp,
     input                       m_axi_rvalid,
+    input                       m_axi_rlast,
     output reg                  m_axi_rready
 );
 
@@ -68,18 +106,25 @@ module debug_mem_port #(
     // State Machine
     //=========================================================================
 
-    localparam [2:0]
-        IDLE        = 3'd0,
-        READ_ADDR   = 3'd1,
-        READ_DATA   = 3'd2,
-        WRITE_ADDR  = 3'd3,
-        WRITE_DATA  = 3'd4,
-        WRITE_RESP  = 3'd5,
-        DONE        = 3'd6,
-        ERROR_STATE = 3'd7;
-
-    reg [2:0] state;
-    reg [2:0] next_state;
+    localparam [3:0]
+        IDLE        = 4'd0,
+        READ_ADDR   = 4'd1,
+        READ_DATA   = 4'd2,
+        WRITE_ADDR  = 4'd3,
+        WRITE_DATA  = 4'd4,
+        WRITE_RESP  = 4'd5,
+        DONE        = 4'd6,
+        ERROR_STATE = 4'd7,
+        BLK_RADDR   = 4'd8,
+        BLK_RDATA   = 4'd9,
+        BLK_WADDR   = 4'd10,
+        BLK_WDATA   = 4'd11,
+        BLK_WRESP   = 4'd12,
+        BLK_DONE    = 4'd13,
+        BLK_LREAD   = 4'd14;
+
+    reg [3:0] state;
+    reg [3:0] next_state;
 
     //=========================================================================
     // Registers
@@ -91,6 +136,28 @@ module debug_mem_port #(
     reg [1:0]            error_type_reg;
     reg                  ready_reg;
 
+    // Block engine
+    reg [DATA_WIDTH-1:0] blk_buf [0:255];
+    reg [ADDR_WIDTH-1:0] blk_dst_reg;
+    reg [8:0]            blk_len_reg;
+    reg [8:0]            blk_cnt;
+    reg                  blk_fill_reg;
+    reg [DATA_WIDTH-1:0] blk_pattern_reg;
+
+    // Local read: index of the next word to request, data due next clock
+    reg [13:0]           loc_base;
+    reg [8:0]            loc_idx;
+    reg                  loc_pend;
+
+    assign loc_addr = loc_base + loc_idx;
+
+    wire                 blk_last = (blk_cnt == blk_len_reg - 1'b1);
+    wire [DATA_WIDTH-1:0] blk_word_next =
+        blk_fill_reg ? blk_pattern_reg : blk_buf[blk_cnt[7:0] + 1'b1];
+
+    assign m_axi_arburst = 2'b01;   // INCR
+    assign m_axi_awburst = 2'b01;
+
     //=========================================================================
     // Write Strobe Generation
     //=========================================================================
@@ -137,6 +204,9 @@ module debug_mem_port #(
                     next_state = READ_ADDR;
                 else if (write_req)
                     next_state = WRITE_ADDR;
+                else if (blk_start && blk_len != 0)
+                    next_state = blk_fill  ? BLK_WADDR :
+                                 blk_local ? BLK_LREAD : BLK_RADDR;
             end
 
             READ_ADDR: begin
@@ -181,6 +251,52 @@ module debug_mem_port #(
             ERROR_STATE: begin
                 next_state = IDLE;
             end
+
+            BLK_RADDR: begin
+                if (m_axi_arready)
+                    next_state = BLK_RDATA;
+                else if (timeout_cnt == 0)
+                    next_state = ERROR_STATE;
+            end
+
+            BLK_RDATA: begin
+                if (m_axi_rvalid && (m_axi_rlast || blk_last))
+                    next_state = BLK_WADDR;
+                else if (timeout_cnt == 0)
+                    next_state = ERROR_STATE;
+            end
+
+            BLK_LREAD: begin
+                if (loc_pend && blk_last)
+                    next_state = BLK_WADDR;
+            end
+
+            BLK_WADDR: begin
+                if (m_axi_awready)
+                    next_state = BLK_WDATA;
+                else if (timeout_cnt == 0)
+                    next_state = ERROR_STATE;
+            end
+
+            BLK_WDATA: begin
+                if (m_axi_wready && blk_last)
+                    next_state = BLK_WRESP;
+                else if (timeout_cnt == 0)
+                    next_state = ERROR_STATE;
+            end
+
+            BLK_WRESP: begin
+                if (m_axi_bvalid)
+                    next_state = BLK_DONE;
+                else if (timeout_cnt == 0)
+                    next_state = ERROR_STATE;
+            end
+
+            BLK_DONE: begin
+                next_state = IDLE;
+            end
+
+            default: next_state = IDLE;
         endcase
     end
 
@@ -191,15 +307,29 @@ module debug_mem_port #(
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             m_axi_awaddr  <= {ADDR_WIDTH{1'b0}};
+            m_axi_awlen   <= 8'd0;
             m_axi_awvalid <= 1'b0;
             m_axi_wdata   <= {DATA_WIDTH{1'b0}};
             m_axi_wstrb   <= 4'b0000;
             m_axi_wvalid  <= 1'b0;
+            m_axi_wlast   <= 1'b0;
             m_axi_bready  <= 1'b0;
             m_axi_araddr  <= {ADDR_WIDTH{1'b0}};
+            m_axi_arlen   <= 8'd0;
             m_axi_arvalid <= 1'b0;
             m_axi_rready  <= 1'b0;
             rdata_reg     <= {DATA_WIDTH{1'b0}};
+            blk_busy      <= 1'b0;
+            blk_done      <= 1'b0;
+            blk_error     <= 1'b0;
+            blk_dst_reg   <= {ADDR_WIDTH{1'b0}};
+            blk_len_reg   <= 9'd0;
+            blk_cnt       <= 9'd0;
+            blk_fill_reg  <= 1'b0;
+            blk_pattern_reg <= {DATA_WIDTH{1'b0}};
+            loc_base      <= 14'd0;
+            loc_idx       <= 9'd0;
+            loc_pend      <= 1'b0;
             timeout_cnt   <= TIMEOUT_CYCLES[15:0];
             error_reg     <= 1'b0;
             error_type_reg <= 2'b00;
@@ -216,15 +346,43 @@ module debug_mem_port #(
 
                     if (read_req) begin
                         m_axi_araddr  <= addr;
+                        m_axi_arlen   <= 8'd0;
                         m_axi_arvalid <= 1'b1;
                         m_axi_rready  <= 1'b1;
                     end else if (write_req) begin
                         m_axi_awaddr  <= addr;
+                        m_axi_awlen   <= 8'd0;
                         m_axi_awvalid <= 1'b1;
                         m_axi_wdata   <= wdata;
                         m_axi_wstrb   <= wstrb_calc;
                         m_axi_wvalid  <= 1'b1;
+                        m_axi_wlast   <= 1'b1;
                         m_axi_bready  <= 1'b1;
+                    end else if (blk_start && blk_len != 0) begin
+                        blk_busy        <= 1'b1;
+                        blk_done        <= 1'b0;
+                        blk_error       <= 1'b0;
+                        blk_dst_reg     <= blk_dst;
+                        blk_len_reg     <= blk_len;
+                        blk_cnt         <= 9'd0;
+                        blk_fill_reg    <= blk_fill;
+                        blk_pattern_reg <= blk_pattern;
+                        if (blk_fill) begin
+                            // Fill: no read phase
+                            m_axi_awaddr  <= blk_dst;
+                            m_axi_awlen   <= blk_len[7:0] - 1'b1;
+                            m_axi_awvalid <= 1'b1;
+                        end else if (blk_local) begin
+                            // Local: words arrive one per clock
+                            loc_base <= blk_src[13:0];
+                            loc_idx  <= 9'd0;
+                            loc_pend <= 1'b0;
+                        end else begin
+                            m_axi_araddr  <= blk_src;
+                            m_axi_arlen   <= blk_len[7:0] - 1'b1;
+                            m_axi_arvalid <= 1'b1;
+                            m_axi_rready  <= 1'b1;
+                        end
                     end
                 end
 
@@ -259,6 +417,7 @@ module debug_mem_port #(
                     timeout_cnt <= timeout_cnt - 1;
                     if (m_axi_wready) begin
                         m_axi_wvalid <= 1'b0;
+                        m_axi_wlast  <= 1'b0;
                     end
                 end
 
@@ -279,8 +438,108 @@ module debug_mem_port #(
                     error_reg <= (error_type_reg != 2'b00);
                 end
 
+                BLK_RADDR: begin
+                    timeout_cnt <= timeout_cnt - 1;
+                    if (m_axi_arready) begin
+                        m_axi_arvalid <= 1'b0;
+                        timeout_cnt   <= TIMEOUT_CYCLES[15:0];
+                    end
+                end
+
+                BLK_RDATA: begin
+                    // Timeout restarts on every beat
+                    timeout_cnt <= timeout_cnt - 1;
+                    if (m_axi_rvalid) begin
+                        timeout_cnt <= TIMEOUT_CYCLES[15:0];
+                        blk_buf[blk_cnt[7:0]] <= m_axi_rdata;
+                        if (m_axi_rresp != 2'b00) begin
+                            error_type_reg <= m_axi_rresp;
+                        end
+
+                        if (m_axi_rlast || blk_last) begin
+                            m_axi_rready  <= 1'b0;
+                            m_axi_awaddr  <= blk_dst_reg;
+                            m_axi_awlen   <= blk_len_reg[7:0] - 1'b1;
+                            m_axi_awvalid <= 1'b1;
+                            blk_cnt       <= 9'd0;
+                        end else begin
+                            blk_cnt <= blk_cnt + 1'b1;
+                        end
+                    end
+                end
+
+                BLK_LREAD: begin
+                    // Request the next word while storing the previous one
+                    loc_pend <= (loc_idx != blk_len_reg);
+                    if (loc_idx != blk_len_reg) begin
+                        loc_idx <= loc_idx + 1'b1;
+                    end
+
+                    if (loc_pend) begin
+                        blk_buf[blk_cnt[7:0]] <= loc_data;
+                        if (blk_last) begin
+                            m_axi_awaddr  <= blk_dst_reg;
+                            m_axi_awlen   <= blk_len_reg[7:0] - 1'b1;
+                            m_axi_awvalid <= 1'b1;
+                            blk_cnt       <= 9'd0;
+                        end else begin
+                            blk_cnt <= blk_cnt + 1'b1;
+                        end
+                    end
+                end
+
+                BLK_WADDR: begin
+                    timeout_cnt <= timeout_cnt - 1;
+                    if (m_axi_awready) begin
+                        m_axi_awvalid <= 1'b0;
+                        m_axi_wdata   <= blk_fill_reg ? blk_pattern_reg : blk_buf[0];
+                        m_axi_wstrb   <= 4'b1111;
+                        m_axi_wlast   <= (blk_len_reg == 9'd1);
+                        m_axi_wvalid  <= 1'b1;
+                        m_axi_bready  <= 1'b1;
+                        timeout_cnt   <= TIMEOUT_CYCLES[15:0];
+                    end
+                end
+
+                BLK_WDATA: begin
+                    timeout_cnt <= timeout_cnt - 1;
+                    if (m_axi_wready) begin
+                        timeout_cnt <= TIMEOUT_CYCLES[15:0];
+                        if (blk_last) begin
+                            m_axi_wvalid <= 1'b0;
+                            m_axi_wlast  <= 1'b0;
+                        end else begin
+                            m_axi_wdata <= blk_word_next;
+                            m_axi_wlast <= (blk_cnt + 2'd2 == blk_len_reg);
+                            blk_cnt     <= blk_cnt + 1'b1;
+                        end
+                    end
+                end
+
+                BLK_WRESP: begin
+                    timeout_cnt <= timeout_cnt - 1;
+                    if (m_axi_bvalid) begin
+                        m_axi_bready <= 1'b0;
+                        if (m_axi_bresp != 2'b00) begin
+                            error_type_reg <= m_axi_bresp;
+                        end
+                    end
+                end
+
+                BLK_DONE: begin
+                    blk_busy  <= 1'b0;
+                    blk_done  <= 1'b1;
+                    blk_error <= (error_type_reg != 2'b00);
+                end
+
                 ERROR_STATE: begin
                     // Timeout - clean up
+                    if (blk_busy) begin
+                        blk_busy  <= 1'b0;
+                        blk_done  <= 1'b1;
+                        blk_error <= 1'b1;
+                    end
+                    m_axi_wlast   <= 1'b0;
                     m_axi_awvalid <= 1'b0;
                     m_axi_wvalid  <= 1'b0;
                     m_axi_bready  <= 1'b0;
@@ -288,7 +547,7 @@ module debug_mem_port #(
                     m_axi_rready  <= 1'b0;
                     error_type_reg <= 2'b01;  // Timeout
                     error_reg <= 1'b1;
-                    ready_reg <= 1'b1;
+                    ready_reg <= !blk_busy;   // Blocks report via blk_done
                 end
             endcase
         end
@@ -26,7 +26,8 @@
 //   0x28: TAP_TRIG_MASK  - Trigger mask
 //   0x2C: TAP_TRIG_VAL   - Trigger value
 //   0x30: TRACE_CTRL     - Trace control
-//   0x34: TRACE_STAT     - Trace status (read-only)
+//   0x34: TRACE_STAT     - Trace status (read-only: [11:0]=count, [14]=triggered,
+//                          [15]=wrapped, [27:16]=trigger entry)
 //   0x38: TRACE_ADDR     - Trace read address
 //   0x3C: TRACE_DATA_LO  - Trace data low (read-only)
 //   0x40: TRACE_DATA_HI  - Trace data high (read-only)
@@ -43,6 +44,12 @@
 //   0x6C: SCRATCH        - Scratch register (for testing)
 //   0x70: IDCODE         - JTAG IDCODE (read-only)
 //   0x74: LAYER          - Current bring-up layer (read-only)
+//   0x78: MEM_BLK_SRC    - Block transfer source address
+//   0x7C: MEM_BLK_DST    - Block transfer destination address
+//   0x80: MEM_BLK_CTRL   - Block control (W: [0]=start, [1]=fill, [2]=trace source,
+//                          [24:16]=words; with [2] MEM_BLK_SRC is a trace word index)
+//   0x84: MEM_BLK_STAT   - Block status (read-only: [0]=busy, [1]=done, [2]=error)
+//   0x88: MEM_BLK_PATTERN - Block fill pattern
 //
 //-----------------------------------------------------------------------------
 
@@ -71,6 +78,20 @@ module debug_register_bank #(
     input                   mem_write_done,
     input                   mem_error,
 
+    //-------------------------------------------------------------------------
+    // Memory Block Transfer Interface
+    //-------------------------------------------------------------------------
+    output [31:0]           blk_src,
+    output [31:0]           blk_dst,
+    output [8:0]            blk_len,
+    output                  blk_fill,
+    output                  blk_local,
+    output [31:0]           blk_pattern,
+    output reg              blk_start,
+    input                   blk_busy,
+    input                   blk_done,
+    input                   blk_error,
+
     //-------------------------------------------------------------------------
     // Signal Tap Interface
     //-------------------------------------------------------------------------
@@ -91,6 +112,7 @@ module debug_register_bank #(
     input  [11:0]           trace_count,
     input                   trace_wrapped,
     input                   trace_triggered,
+    input  [11:0]           trace_trigger_pos,
 
     //-------------------------------------------------------------------------
     // Status Outputs
@@ -133,7 +155,12 @@ module debug_register_bank #(
         REG_UPTIME_HI     = 8'h68,
         REG_SCRATCH       = 8'h6C,
         REG_IDCODE        = 8'h70,
-        REG_LAYER         = 8'h74;
+        REG_LAYER         = 8'h74,
+        REG_MEM_BLK_SRC   = 8'h78,
+        REG_MEM_BLK_DST   = 8'h7C,
+        REG_MEM_BLK_CTRL  = 8'h80,
+        REG_MEM_BLK_STAT  = 8'h84,
+        REG_MEM_BLK_PAT   = 8'h88;
 
     //=========================================================================
     // Registers
@@ -154,6 +181,10 @@ module debug_register_bank #(
     reg [31:0] cpu_bp_ctrl_reg;
     reg [31:0] error_reg;
     reg [31:0] scratch_reg;
+    reg [31:0] blk_src_reg;
+    reg [31:0] blk_dst_reg;
+    reg [31:0] blk_ctrl_reg;
+    reg [31:0] blk_pattern_reg;
 
     //=========================================================================
     // Uptime Counter
@@ -237,6 +268,10 @@ module debug_register_bank #(
             cpu_bp_ctrl_reg  <= 32'd0;
             error_reg        <= 32'd0;
             scratch_reg      <= 32'd0;
+            blk_src_reg      <= 32'd0;
+            blk_dst_reg      <= 32'd0;
+            blk_ctrl_reg     <= 32'd0;
+            blk_pattern_reg  <= 32'd0;
         end else if (reg_we) begin
             case (reg_addr)
                 REG_CTRL:          ctrl_reg <= reg_wdata;
@@ -254,6 +289,10 @@ module debug_register_bank #(
                 REG_CPU_BP_CTRL:   cpu_bp_ctrl_reg <= reg_wdata;
                 REG_ERROR:         error_reg <= reg_wdata;
                 REG_SCRATCH:       scratch_reg <= reg_wdata;
+                REG_MEM_BLK_SRC:   blk_src_reg <= reg_wdata;
+                REG_MEM_BLK_DST:   blk_dst_reg <= reg_wdata;
+                REG_MEM_BLK_CTRL:  blk_ctrl_reg <= reg_wdata;
+                REG_MEM_BLK_PAT:   blk_pattern_reg <= reg_wdata;
             endcase
         end
 
@@ -263,6 +302,15 @@ module debug_register_bank #(
         end
     end
 
+    // Block start: one-cycle pulse on a CTRL write with bit 0 set
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            blk_start <= 1'b0;
+        end else begin
+            blk_start <= reg_we && (reg_addr == REG_MEM_BLK_CTRL) && reg_wdata[0];
+        end
+    end
+
     //=========================================================================
     // Register Read Logic
     //=========================================================================
@@ -282,7 +330,7 @@ module debug_register_bank #(
             REG_TAP_TRIG_MASK: reg_rdata = tap_trig_mask_reg;
             REG_TAP_TRIG_VAL:  reg_rdata = tap_trig_val_reg;
             REG_TRACE_CTRL:    reg_rdata = trace_ctrl_reg;
-            REG_TRACE_STAT:    reg_rdata = {16'd0, trace_wrapped, trace_triggered, 2'd0, trace_count};
+            REG_TRACE_STAT:    reg_rdata = {4'd0, trace_trigger_pos, trace_wrapped, trace_triggered, 2'd0, trace_count};
             REG_TRACE_ADDR:    reg_rdata = trace_addr_reg;
             REG_TRACE_DATA_LO: reg_rdata = 32'd0;  // Would come from trace buffer
             REG_TRACE_DATA_HI: reg_rdata = 32'd0;
@@ -299,6 +347,11 @@ module debug_register_bank #(
             REG_SCRATCH:       reg_rdata = scratch_reg;
             REG_IDCODE:        reg_rdata = 32'hFB010001;
             REG_LAYER:         reg_rdata = {28'd0, layer_reg};
+            REG_MEM_BLK_SRC:   reg_rdata = blk_src_reg;
+            REG_MEM_BLK_DST:   reg_rdata = blk_dst_reg;
+            REG_MEM_BLK_CTRL:  reg_rdata = {blk_ctrl_reg[31:1], 1'b0};
+            REG_MEM_BLK_STAT:  reg_rdata = {29'd0, blk_error, blk_done, blk_busy};
+            REG_MEM_BLK_PAT:   reg_rdata = blk_pattern_reg;
             default:           reg_rdata = 32'hDEADDEAD;
         endcase
     end
@@ -310,5 +363,11 @@ module debug_register_bank #(
     assign reg_ready     = 1'b1;  // Always ready (combinational read)
     assign current_layer = layer_reg;
     assign last_error    = error_reg;
+    assign blk_src       = blk_src_reg;
+    assign blk_dst       = blk_dst_reg;
+    assign blk_len       = blk_ctrl_reg[24:16];
+    assign blk_fill      = blk_ctrl_reg[1];
+    assign blk_local     = blk_ctrl_reg[2];
+    assign blk_pattern   = blk_pattern_reg;
 
 endmodule
@@ -89,24 +89,30 @@ module fluxripper_debug_top #(
     input                       bscan_reset,
 
     //-------------------------------------------------------------------------
-    // Debug Memory Port (AXI-Lite Master)
+    // Debug Memory Port (AXI-Lite Master, INCR bursts for block transfers)
     //-------------------------------------------------------------------------
     output [MEM_ADDR_WIDTH-1:0] m_axi_awaddr,
+    output [7:0]                m_axi_awlen,
+    output [1:0]                m_axi_awburst,
     output                      m_axi_awvalid,
     input                       m_axi_awready,
     output [MEM_DATA_WIDTH-1:0] m_axi_wdata,
     output [3:0]                m_axi_wstrb,
     output                      m_axi_wvalid,
+    output                      m_axi_wlast,
     input                       m_axi_wready,
     input  [1:0]                m_axi_bresp,
     input                       m_axi_bvalid,
     output                      m_axi_bready,
     output [MEM_ADDR_WIDTH-1:0] m_axi_araddr,
+    output [7:0]                m_axi_arlen,
+    output [1:0]                m_axi_arburst,
     output                      m_axi_arvalid,
     input                       m_axi_arready,
     input  [MEM_DATA_WIDTH-1:0] m_axi_rdata,
     input  [1:0]                m_axi_rresp,
     input                       m_axi_rvalid,
+    input                       m_axi_rlast,
     output                      m_axi_rready,
 
     //-------------------------------------------------------------------------
@@ -249,6 +255,19 @@ module fluxripper_debug_top #(
     // Debug Register Bank (accessible via JTAG and CDC console)
     //=========================================================================
 
+    wire [31:0] blk_src;
+    wire [31:0] blk_dst;
+    wire [8:0]  blk_len;
+    wire        blk_fill;
+    wire        blk_local;
+    wire [13:0] blk_loc_addr;
+    wire [31:0] blk_loc_data;
+    wire [31:0] blk_pattern;
+    wire        blk_start;
+    wire        blk_busy;
+    wire        blk_done;
+    wire        blk_error;
+
     wire [31:0] dbg_reg_addr;
     wire [31:0] dbg_reg_wdata;
     wire [31:0] dbg_reg_rdata;
@@ -277,6 +296,18 @@ module fluxripper_debug_top #(
         .mem_write_done (m_axi_bvalid),
         .mem_error      (m_axi_rresp[1] | m_axi_bresp[1]),
 
+        // Memory block transfers
+        .blk_src        (blk_src),
+        .blk_dst        (blk_dst),
+        .blk_len        (blk_len),
+        .blk_fill       (blk_fill),
+        .blk_local      (blk_local),
+        .blk_pattern    (blk_pattern),
+        .blk_start      (blk_start),
+        .blk_busy       (blk_busy),
+        .blk_done       (blk_done),
+        .blk_error      (blk_error),
+
         // Signal tap
         .probe_signals  (probe_signals),
         .probe_group_sel(probe_group_sel),
@@ -291,6 +322,7 @@ module fluxripper_debug_top #(
         .trace_count    (trace_count),
         .trace_wrapped  (trace_wrapped),
         .trace_triggered(trace_triggered),
+        .trace_trigger_pos(trace_trigger_pos),
 
         // System status outputs
         .current_layer  (current_layer),
@@ -323,23 +355,45 @@ module fluxripper_debug_top #(
         .write_req      (mem_write_req),
         .ready          (mem_ready),
 
+        // Block transfers (debug register bank)
+        .blk_src        (blk_src),
+        .blk_dst        (blk_dst),
+        .blk_len        (blk_len),
+        .blk_fill       (blk_fill),
+        .blk_local      (blk_local),
+        .blk_pattern    (blk_pattern),
+        .blk_start      (blk_start),
+        .blk_busy       (blk_busy),
+        .blk_done       (blk_done),
+        .blk_error      (blk_error),
+
+        // Local read port (trace buffer)
+        .loc_addr       (blk_loc_addr),
+        .loc_data       (blk_loc_data),
+
         // AXI-Lite Master
         .m_axi_awaddr   (m_axi_awaddr),
+        .m_axi_awlen    (m_axi_awlen),
+        .m_axi_awburst  (m_axi_awburst),
         .m_axi_awvalid  (m_axi_awvalid),
         .m_axi_awready  (m_axi_awready),
         .m_axi_wdata    (m_axi_wdata),
         .m_axi_wstrb    (m_axi_wstrb),
         .m_axi_wvalid   (m_axi_wvalid),
+        .m_axi_wlast    (m_axi_wlast),
         .m_axi_wready   (m_axi_wready),
         .m_axi_bresp    (m_axi_bresp),
         .m_axi_bvalid   (m_axi_bvalid),
         .m_axi_bready   (m_axi_bready),
         .m_axi_araddr   (m_axi_araddr),
+        .m_axi_arlen    (m_axi_arlen),
+        .m_axi_arburst  (m_axi_arburst),
         .m_axi_arvalid  (m_axi_arvalid),
         .m_axi_arready  (m_axi_arready),
         .m_axi_rdata    (m_axi_rdata),
         .m_axi_rresp    (m_axi_rresp),
         .m_axi_rvalid   (m_axi_rvalid),
+        .m_axi_rlast    (m_axi_rlast),
         .m_axi_rready   (m_axi_rready)
     );
 
@@ -385,6 +439,23 @@ module fluxripper_debug_top #(
     wire                         trace_triggered;
     wire                         trace_enable;
     wire                         trace_clear;
+    wire [TRACE_DEPTH_LOG2-1:0]  trace_trigger_pos;
+    wire [TRACE_DEPTH_LOG2-1:0]  console_trace_addr;
+
+    // Block readout: the debug port streams the buffer as 32-bit words,
+    // even word = entry[31:0], odd word = entry[63:32]. It owns the read
+    // address while a trace-source block runs; the console otherwise.
+    wire trace_blk_active = blk_busy && blk_local;
+    reg  trace_word_hi;
+
+    always @(posedge clk) begin
+        trace_word_hi <= blk_loc_addr[0];
+    end
+
+    assign trace_read_addr = trace_blk_active ? blk_loc_addr[TRACE_DEPTH_LOG2:1] :
+                                                console_trace_addr;
+    assign blk_loc_data    = trace_word_hi ? trace_data_out[63:32] :
+                                             trace_data_out[31:0];
 
     trace_buffer #(
         .DEPTH_LOG2     (TRACE_DEPTH_LOG2),
@@ -409,6 +480,7 @@ module fluxripper_debug_top #(
         .read_addr      (trace_read_addr),
         .data_out       (trace_data_out),
         .count          (trace_count),
+        .trigger_pos    (trace_trigger_pos),
         .wrapped        (trace_wrapped),
         .triggered      (trace_triggered)
     );
@@ -458,7 +530,7 @@ module fluxripper_debug_top #(
         // Trace control
         .trace_enable   (trace_enable),
         .trace_clear    (trace_clear),
-        .trace_read_addr(trace_read_addr),
+        .trace_read_addr(console_trace_addr),
         .trace_data_out (trace_data_out),
         .trace_count    (trace_count),
 
@@ -23,6 +23,12 @@
 //   0x1C: BUF_DATA   - Buffer read data (RO)
 //   0x20: DEPTH      - Capture depth (RW)
 //   0x24: POSITION   - Trigger position in buffer (RO)
+//   0x28: WR_PTR     - Next buffer slot to be written (RO)
+//
+// CONTROL bits: [0]=arm, [1]=force trigger, [2]=ordered readout. With
+// [2] set, BUF_ADDR counts from the oldest sample (WR_PTR) and every
+// BUF_DATA read advances it, so a debug-port block read of BUF_DATA
+// drains the whole capture in order with one bus read per sample.
 //
 //-----------------------------------------------------------------------------
 
@@ -58,7 +64,8 @@ module signal_tap #(
         REG_BUF_ADDR  = 8'h18,
         REG_BUF_DATA  = 8'h1C,
         REG_DEPTH     = 8'h20,
-        REG_POSITION  = 8'h24;
+        REG_POSITION  = 8'h24,
+        REG_WR_PTR    = 8'h28;
 
     //=========================================================================
     // Internal Registers
@@ -85,6 +92,12 @@ module signal_tap #(
     reg [31:0] samples_after_trig;
     reg triggered;
 
+    // Ordered readout: BUF_ADDR relative to the oldest sample
+    wire                           rd_ordered = control_reg[2];
+    wire [$clog2(BUFFER_DEPTH)-1:0] rd_index  = rd_ordered ?
+        (wr_ptr + buf_addr[$clog2(BUFFER_DEPTH)-1:0]) :
+        buf_addr[$clog2(BUFFER_DEPTH)-1:0];
+
     //=========================================================================
     // Bus Interface
     //=========================================================================
@@ -103,9 +116,10 @@ module signal_tap #(
             REG_TRIG_MASK: rdata = trigger_mask;
             REG_PROBE_SEL: rdata = probe_sel;
             REG_BUF_ADDR:  rdata = buf_addr;
-            REG_BUF_DATA:  rdata = buffer[buf_addr[$clog2(BUFFER_DEPTH)-1:0]];
+            REG_BUF_DATA:  rdata = buffer[rd_index];
             REG_DEPTH:     rdata = capture_depth;
             REG_POSITION:  rdata = {24'b0, trigger_pos};
+            REG_WR_PTR:    rdata = {24'b0, wr_ptr};
             default:       rdata = 32'h0;
         endcase
     end
@@ -131,6 +145,8 @@ module signal_tap #(
                 REG_DEPTH:     capture_depth <= (wdata > BUFFER_DEPTH) ?
                                                 BUFFER_DEPTH : wdata;
             endcase
+        end else if (read && addr == REG_BUF_DATA && rd_ordered) begin
+            buf_addr <= buf_addr + 1;
         end
     end
 
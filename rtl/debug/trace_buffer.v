@@ -85,7 +85,7 @@ module trace_buffer #(
     input  [DEPTH_LOG2-1:0]     read_addr,       // Read address (relative to start)
     output [WIDTH-1:0]          data_out,        // Read data
     output [DEPTH_LOG2-1:0]     count,           // Number of entries captured
-    output [DEPTH_LOG2-1:0]     trigger_pos,     // Position of trigger in buffer
+    output [DEPTH_LOG2-1:0]     trigger_pos,     // Trigger entry, in read_addr terms
     output                      wrapped,         // Buffer has wrapped
     output                      triggered,       // Trigger has occurred
     output                      full             // Buffer is full (post-trigger mode)
@@ -238,7 +238,9 @@ module trace_buffer #(
 
     assign data_out    = data_out_reg;
     assign count       = wrapped_reg ? {DEPTH_LOG2{1'b1}} : count_reg;
-    assign trigger_pos = trigger_pos_reg;
+    // Relative to the oldest entry, like read_addr
+    assign trigger_pos = wrapped_reg ? (trigger_pos_reg - write_ptr) :
+                                       trigger_pos_reg;
     assign wrapped     = wrapped_reg;
     assign triggered   = triggered_reg;
     assign full        = full_reg;
@@ -23,6 +23,13 @@
 //   0x1C0-0x1FF: Error counters
 //   0x200-0x2FF: Histogram data
 //   0x300-0x3FF: Trace buffer control
+//   0x400-0x49F: Latched snapshot (shadow bank)
+//
+// Snapshot: writing CONTROL bit 2 copies every counter into the shadow bank
+// on the same clock and bumps SNAP_GEN. The bank is contiguous, so software
+// can read it as one block and get values that all belong to one instant.
+// It holds sums and counts rather than the divided averages, so rates and
+// averages worked out from two snapshots are consistent.
 //-----------------------------------------------------------------------------
 
 module instrumentation_regs #(
@@ -132,6 +139,7 @@ module instrumentation_regs #(
     localparam REG_STATUS           = 12'h008;
     localparam REG_UPTIME_SEC       = 12'h00C;
     localparam REG_UPTIME_MS        = 12'h010;
+    localparam REG_SNAP_GEN         = 12'h014;
 
     localparam REG_USB_RX_BYTES_LO  = 12'h040;
     localparam REG_USB_RX_BYTES_HI  = 12'h044;
@@ -186,6 +194,51 @@ module instrumentation_regs #(
     localparam REG_TRACE_HEAD       = 12'h30C;
     localparam REG_TRACE_DATA       = 12'h310;
 
+    localparam REG_SNAP_BASE        = 12'h400;
+    localparam SNAP_WORDS           = 40;
+
+    // Shadow bank word index (REG_SNAP_BASE + 4*n)
+    localparam SNAP_UPTIME_SEC      = 0;
+    localparam SNAP_UPTIME_MS       = 1;
+    localparam SNAP_USB_RX_BYTES_LO = 2;
+    localparam SNAP_USB_RX_BYTES_HI = 3;
+    localparam SNAP_USB_TX_BYTES_LO = 4;
+    localparam SNAP_USB_TX_BYTES_HI = 5;
+    localparam SNAP_USB_RX_PACKETS  = 6;
+    localparam SNAP_USB_TX_PACKETS  = 7;
+    localparam SNAP_USB_ERRORS      = 8;
+    localparam SNAP_DMA_BYTES_LO    = 9;
+    localparam SNAP_DMA_BYTES_HI    = 10;
+    localparam SNAP_DMA_TRANSFERS   = 11;
+    localparam SNAP_DMA_ERRORS      = 12;
+    localparam SNAP_FIFO_RX_HWM     = 13;
+    localparam SNAP_FIFO_TX_HWM     = 14;
+    localparam SNAP_FIFO_FLUX_HWM   = 15;
+    localparam SNAP_FIFO_SECTOR_HWM = 16;
+    localparam SNAP_FIFO_OVERFLOWS  = 17;
+    localparam SNAP_LATENCY_MIN     = 18;
+    localparam SNAP_LATENCY_MAX     = 19;
+    localparam SNAP_LATENCY_SUM     = 20;   // Low 32 bits
+    localparam SNAP_LATENCY_COUNT   = 21;
+    localparam SNAP_LATENCY_LAST    = 22;
+    localparam SNAP_SIG_AMP_MIN     = 23;
+    localparam SNAP_SIG_AMP_MAX     = 24;
+    localparam SNAP_SIG_AMP_SUM     = 25;
+    localparam SNAP_SIG_AMP_COUNT   = 26;
+    localparam SNAP_FLUX_COUNT      = 27;
+    localparam SNAP_INDEX_COUNT     = 28;
+    localparam SNAP_WEAK_COUNT      = 29;
+    localparam SNAP_PLL_STATUS      = 30;
+    localparam SNAP_PLL_LOCK_COUNT  = 31;
+    localparam SNAP_INDEX_PERIOD    = 32;
+    localparam SNAP_INDEX_MIN       = 33;
+    localparam SNAP_INDEX_MAX       = 34;
+    localparam SNAP_RPM_MEASURED    = 35;
+    localparam SNAP_ERR_FDD         = 36;
+    localparam SNAP_ERR_HDD         = 37;
+    localparam SNAP_ERR_CRC         = 38;
+    localparam SNAP_ERR_TIMEOUT     = 39;
+
     //=========================================================================
     // Performance Counters
     //=========================================================================
@@ -268,6 +321,14 @@ module instrumentation_regs #(
 
     assign trigger_fired = trigger_detected;
 
+    //=========================================================================
+    // Snapshot Shadow Bank
+    //=========================================================================
+
+    reg [31:0] snap_bank [0:SNAP_WORDS-1];
+    reg [31:0] snap_gen;
+    reg        snap_latch;              // One-clock strobe from CONTROL bit 2
+
     //=========================================================================
     // Uptime Counter
     //=========================================================================
@@ -554,11 +615,70 @@ module instrumentation_regs #(
         end
     end
 
+    //=========================================================================
+    // Snapshot Latch
+    //=========================================================================
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            snap_gen <= 32'h0;
+            for (i = 0; i < SNAP_WORDS; i = i + 1) begin
+                snap_bank[i] <= 32'h0;
+            end
+        end else if (snap_latch) begin
+            snap_gen <= snap_gen + 1'b1;
+
+            snap_bank[SNAP_UPTIME_SEC]      <= uptime_seconds;
+            snap_bank[SNAP_UPTIME_MS]       <= {22'h0, uptime_ms};
+            snap_bank[SNAP_USB_RX_BYTES_LO] <= usb_rx_bytes[31:0];
+            snap_bank[SNAP_USB_RX_BYTES_HI] <= usb_rx_bytes[63:32];
+            snap_bank[SNAP_USB_TX_BYTES_LO] <= usb_tx_bytes[31:0];
+            snap_bank[SNAP_USB_TX_BYTES_HI] <= usb_tx_bytes[63:32];
+            snap_bank[SNAP_USB_RX_PACKETS]  <= usb_rx_packets;
+            snap_bank[SNAP_USB_TX_PACKETS]  <= usb_tx_packets;
+            snap_bank[SNAP_USB_ERRORS]      <= usb_error_count;
+            snap_bank[SNAP_DMA_BYTES_LO]    <= dma_bytes_total[31:0];
+            snap_bank[SNAP_DMA_BYTES_HI]    <= dma_bytes_total[63:32];
+            snap_bank[SNAP_DMA_TRANSFERS]   <= dma_transfer_count;
+            snap_bank[SNAP_DMA_ERRORS]      <= dma_error_count;
+            snap_bank[SNAP_FIFO_RX_HWM]     <= {22'h0, fifo_rx_hwm};
+            snap_bank[SNAP_FIFO_TX_HWM]     <= {22'h0, fifo_tx_hwm};
+            snap_bank[SNAP_FIFO_FLUX_HWM]   <= {19'h0, fifo_flux_hwm};
+            snap_bank[SNAP_FIFO_SECTOR_HWM] <= {22'h0, fifo_sector_hwm};
+            snap_bank[SNAP_FIFO_OVERFLOWS]  <= fifo_overflow_count;
+            snap_bank[SNAP_LATENCY_MIN]     <= latency_min;
+            snap_bank[SNAP_LATENCY_MAX]     <= latency_max;
+            snap_bank[SNAP_LATENCY_SUM]     <= latency_sum[31:0];
+            snap_bank[SNAP_LATENCY_COUNT]   <= latency_count;
+            snap_bank[SNAP_LATENCY_LAST]    <= latency_last;
+            snap_bank[SNAP_SIG_AMP_MIN]     <= {16'h0, sig_amp_min};
+            snap_bank[SNAP_SIG_AMP_MAX]     <= {16'h0, sig_amp_max};
+            snap_bank[SNAP_SIG_AMP_SUM]     <= sig_amp_sum;
+            snap_bank[SNAP_SIG_AMP_COUNT]   <= sig_amp_count;
+            snap_bank[SNAP_FLUX_COUNT]      <= flux_transition_count;
+            snap_bank[SNAP_INDEX_COUNT]     <= flux_index_count;
+            snap_bank[SNAP_WEAK_COUNT]      <= flux_weak_count;
+            snap_bank[SNAP_PLL_STATUS]      <= {30'h0, pll_locked_prev, pll_locked};
+            snap_bank[SNAP_PLL_LOCK_COUNT]  <= pll_lock_count;
+            snap_bank[SNAP_INDEX_PERIOD]    <= index_period_reg;
+            snap_bank[SNAP_INDEX_MIN]       <= index_period_min;
+            snap_bank[SNAP_INDEX_MAX]       <= index_period_max;
+            snap_bank[SNAP_RPM_MEASURED]    <= {16'h0, rpm_measured};
+            snap_bank[SNAP_ERR_FDD]         <= err_fdd_count;
+            snap_bank[SNAP_ERR_HDD]         <= err_hdd_count;
+            snap_bank[SNAP_ERR_CRC]         <= err_crc_count;
+            snap_bank[SNAP_ERR_TIMEOUT]     <= err_timeout_count;
+        end
+    end
+
     //=========================================================================
     // Register Read/Write
     //=========================================================================
 
     wire [11:0] reg_offset = reg_addr[11:0];
+    wire        snap_sel   = (reg_offset >= REG_SNAP_BASE) &&
+                             (reg_offset < REG_SNAP_BASE + SNAP_WORDS * 4);
+    wire [7:0]  snap_idx   = reg_offset[9:2];
 
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
@@ -566,6 +686,7 @@ module instrumentation_regs #(
             reg_ready <= 1'b0;
             counters_reset <= 1'b0;
             histogram_reset <= 1'b0;
+            snap_latch <= 1'b0;
             trace_mask <= 32'h0;
             trace_enable <= 1'b0;
             trigger_arm <= 1'b0;
@@ -575,6 +696,7 @@ module instrumentation_regs #(
             reg_ready <= 1'b0;
             counters_reset <= 1'b0;
             histogram_reset <= 1'b0;
+            snap_latch <= 1'b0;
 
             if (reg_re || reg_we) begin
                 reg_ready <= 1'b1;
@@ -585,6 +707,7 @@ module instrumentation_regs #(
                         REG_CONTROL: begin
                             counters_reset <= reg_wdata[0];
                             histogram_reset <= reg_wdata[1];
+                            snap_latch <= reg_wdata[2];
                         end
                         REG_TRACE_CTRL: begin
                             trace_enable <= reg_wdata[0];
@@ -600,13 +723,16 @@ module instrumentation_regs #(
                 end
 
                 // Handle reads
-                if (reg_re) begin
+                if (reg_re && snap_sel) begin
+                    reg_rdata <= snap_bank[snap_idx];
+                end else if (reg_re) begin
                     case (reg_offset)
-                        REG_VERSION:        reg_rdata <= 32'h00010000;  // v1.0.0
+                        REG_VERSION:        reg_rdata <= 32'h00010100;  // v1.1.0: snapshot bank
                         REG_CONTROL:        reg_rdata <= 32'h0;
                         REG_STATUS:         reg_rdata <= {30'h0, trigger_detected, trace_enable};
                         REG_UPTIME_SEC:     reg_rdata <= uptime_seconds;
                         REG_UPTIME_MS:      reg_rdata <= {22'h0, uptime_ms};
+                        REG_SNAP_GEN:       reg_rdata <= snap_gen;
 
                         REG_USB_RX_BYTES_LO: reg_rdata <= usb_rx_bytes[31:0];
                         REG_USB_RX_BYTES_HI: reg_rdata <= usb_rx_bytes[63:32];
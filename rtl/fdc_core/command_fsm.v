@@ -4,7 +4,7 @@
 //
 // Based on CAPSImg CapsFDCEmulator.cpp FdcCom() and fdcinit[] table
 //
-// Updated: 2025-12-03 22:15
+// Updated: 2025-12-10 11:00
 //-----------------------------------------------------------------------------
 
 module command_fsm (
@@ -88,6 +88,7 @@ module command_fsm (
     localparam CMD_READ_DEL_DATA  = 5'b01100;  // Read deleted data
     localparam CMD_WRITE_DATA     = 5'b00101;  // Write sector
     localparam CMD_WRITE_DEL_DATA = 5'b01001;  // Write deleted data
+    localparam CMD_VERIFY         = 5'b10110;  // Verify sectors (82077AA)
 
     // Type 3 commands (Read/Write Track)
     localparam CMD_READ_TRACK     = 5'b00010;  // Read track
@@ -163,6 +164,9 @@ module command_fsm (
     wire mf_flag = cmd_reg[6];
     wire sk_flag = cmd_reg[5];
 
+    // VERIFY runs the read path with CRC checks but no data phase
+    wire verify_cmd = (cmd_reg[4:0] == CMD_VERIFY);
+
     //-------------------------------------------------------------------------
     // Internal counters and flags
     //-------------------------------------------------------------------------
@@ -206,7 +210,8 @@ module command_fsm (
             CMD_READ_DEL_DATA,
             CMD_WRITE_DATA,
             CMD_WRITE_DEL_DATA,
-            CMD_READ_TRACK:      param_expected = 4'd8;
+            CMD_READ_TRACK,
+            CMD_VERIFY:          param_expected = 4'd8;
             CMD_READ_ID:         param_expected = 4'd1;
             CMD_FORMAT_TRACK:    param_expected = 4'd5;
             CMD_RECALIBRATE:     param_expected = 4'd1;
@@ -366,7 +371,8 @@ module command_fsm (
                                 end
 
                                 CMD_READ_DATA,
-                                CMD_READ_DEL_DATA: begin
+                                CMD_READ_DEL_DATA,
+                                CMD_VERIFY: begin
                                     head_select <= params[0][2] ? 2'b01 : 2'b00;
                                     current_sector <= params[3];
                                     index_count <= 8'd0;
@@ -495,15 +501,19 @@ module command_fsm (
                     if (a1_detected) begin
                         byte_count <= 16'd0;
                         state <= S_T2R_READ_DATA;
-                        dio <= 1'b1;  // FDC->CPU
-                        rqm <= 1'b1;
+                        if (!verify_cmd) begin
+                            dio <= 1'b1;  // FDC->CPU
+                            rqm <= 1'b1;
+                        end
                     end
                 end
 
                 S_T2R_READ_DATA: begin
                     if (read_ready) begin
-                        fifo_write_data <= read_data;
-                        fifo_write <= 1'b1;
+                        if (!verify_cmd) begin
+                            fifo_write_data <= read_data;
+                            fifo_write <= 1'b1;
+                        end
                         byte_count <= byte_count + 1'b1;
 
                         if (byte_count >= sector_bytes - 1) begin
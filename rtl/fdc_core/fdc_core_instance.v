@@ -129,7 +129,20 @@ module fdc_core_instance #(
     output wire [5:0]  tape_last_command,     // Last decoded command
     output wire        tape_command_active,   // Command in progress
     output wire        tape_ready,            // Tape drive ready
-    output wire        tape_error             // Tape error condition
+    output wire        tape_error,            // Tape error condition
+    output wire        tape_streaming,        // Tape moving (segment framing)
+
+    //-------------------------------------------------------------------------
+    // QIC-117 Tape Block Data (to axi_stream_tape)
+    //-------------------------------------------------------------------------
+    output wire [7:0]  tape_data_byte,        // Block byte from the data streamer
+    output wire        tape_data_valid,       // Byte strobe
+    output wire        tape_data_is_header,   // Byte is the block header
+    output wire        tape_data_is_ecc,      // Byte is ECC
+    output wire        tape_block_start,      // Block started
+    output wire        tape_block_complete,   // Block complete (last ECC byte)
+    output wire        tape_sync_lost,        // Block aborted
+    output wire [4:0]  tape_block_in_segment  // Block number in segment
 );
 
     //-------------------------------------------------------------------------
@@ -258,6 +271,11 @@ module fdc_core_instance #(
     wire [4:0]  qic_block_in_segment;
     wire        qic_segment_complete;
     wire        qic_file_mark;
+    wire        qic_block_start;
+    wire        qic_block_complete;
+    wire        qic_sync_lost;
+    wire        qic_read_is_header;
+    wire        qic_read_is_ecc;
 
     //-------------------------------------------------------------------------
     // Drive Multiplexer
@@ -532,17 +550,33 @@ module fdc_core_instance #(
         .command_active    (tape_command_active),
         .tape_ready        (tape_ready),
         .tape_error        (tape_error),
+        .tape_streaming    (tape_streaming),
         // Data streamer status
         .block_sync        (qic_block_sync),
         .byte_in_block     (qic_byte_in_block),
         .block_in_segment  (qic_block_in_segment),
         .segment_complete  (qic_segment_complete),
-        .file_mark_detect  (qic_file_mark)
+        .file_mark_detect  (qic_file_mark),
+        .block_start       (qic_block_start),
+        .block_complete    (qic_block_complete),
+        .block_sync_lost   (qic_sync_lost),
+        .read_is_header    (qic_read_is_header),
+        .read_is_ecc       (qic_read_is_ecc)
     );
 
     // Assign tape last command output
     assign tape_last_command = qic_current_command;
 
+    // Block data for segment capture
+    assign tape_data_byte        = qic_read_data;
+    assign tape_data_valid       = qic_read_valid;
+    assign tape_data_is_header   = qic_read_is_header;
+    assign tape_data_is_ecc      = qic_read_is_ecc;
+    assign tape_block_start      = qic_block_start;
+    assign tape_block_complete   = qic_block_complete;
+    assign tape_sync_lost        = qic_sync_lost;
+    assign tape_block_in_segment = qic_block_in_segment;
+
     //-------------------------------------------------------------------------
     // Output Assignments
     //-------------------------------------------------------------------------
@@ -96,6 +96,7 @@ module qic117_controller #(
     output wire        command_active,    // Command in progress
     output wire        tape_ready,        // Drive ready
     output wire        tape_error,        // Error condition
+    output wire        tape_streaming,    // Tape moving in a streaming mode
 
     //=========================================================================
     // Data Streamer Status
@@ -105,6 +106,11 @@ module qic117_controller #(
     output wire [4:0]  block_in_segment,  // Block number in segment
     output wire        segment_complete,  // Segment complete pulse
     output wire        file_mark_detect,  // File mark detected
+    output wire        block_start,       // Block header byte on read_data
+    output wire        block_complete,    // Last ECC byte of a block on read_data
+    output wire        block_sync_lost,   // Block aborted
+    output wire        read_is_header,    // read_data is the block header
+    output wire        read_is_ecc,       // read_data is ECC
 
     //=========================================================================
     // Drive Detection Control
@@ -1096,6 +1102,7 @@ module qic117_controller #(
     assign command_active   = (state != ST_IDLE) || status_busy || fsm_tape_moving;
     assign tape_ready       = ready_reg;
     assign tape_error       = error_reg || fsm_command_error;
+    assign tape_streaming   = fsm_tape_moving;
 
     // Data streamer status outputs
     assign block_sync       = streamer_block_sync;
@@ -1103,5 +1110,10 @@ module qic117_controller #(
     assign block_in_segment = streamer_block_in_segment;
     assign segment_complete = streamer_segment_complete;
     assign file_mark_detect = streamer_file_mark;
+    assign block_start      = streamer_block_start;
+    assign block_complete   = streamer_block_complete;
+    assign block_sync_lost  = streamer_sync_lost;
+    assign read_is_header   = streamer_data_is_header;
+    assign read_is_ecc      = streamer_data_is_ecc;
 
 endmodule
@@ -16,6 +16,7 @@
 //   - Read-ahead: fills entire track on first sector access
 //   - Write-back: buffers writes, flushes on track change
 //   - Valid/dirty bitmap for sector tracking
+//   - 16-bit read port for the ISA track window (isa_track_window)
 //
 // Author: Claude Code (FluxRipper Project)
 // Date: 2025-12-04
@@ -77,6 +78,12 @@ module wd_track_buffer #(
     input  wire        direct_write,      // Direct write enable
     output wire [7:0]  direct_rdata,      // Direct read data
 
+    //-------------------------------------------------------------------------
+    // Track Window Read Port (to isa_track_window)
+    //-------------------------------------------------------------------------
+    input  wire [12:0] win_addr,          // Word address (0-4415)
+    output wire [15:0] win_rdata,         // {odd byte, even byte}
+
     //-------------------------------------------------------------------------
     // Benchmark Mode Control
     //-------------------------------------------------------------------------
@@ -88,6 +95,7 @@ module wd_track_buffer #(
     //=========================================================================
     // Port A: Controller/Host interface
     // Port B: Direct access (debug)
+    // Port C: Track window (read-only, host memory cycles)
 
     reg [7:0] buffer_mem [0:BUFFER_SIZE+127];  // 8832 bytes
 
@@ -116,6 +124,9 @@ module wd_track_buffer #(
         end
     end
 
+    // Port C (track window): little-endian word, like the ISA data bus
+    assign win_rdata = {buffer_mem[{win_addr, 1'b1}], buffer_mem[{win_addr, 1'b0}]};
+
     //=========================================================================
     // Status Tracking
     //=========================================================================
@@ -118,6 +118,9 @@ module isa_auto_config (
     output wire [3:0]  active_wd_irq,       // Active WD IRQ
     output wire [2:0]  active_fdc_dma,      // Active FDC DMA channel
     output wire [2:0]  active_wd_dma,       // Active WD DMA channel (XT mode)
+    output wire        active_fdc_win_enable, // FDC track window decode enabled
+    output wire [8:0]  active_fdc_win_base, // FDC track window base [23:15]
+    output wire        active_fdc_win_16bit, // FDC track window 16-bit cycles
 
     //=========================================================================
     // PnP Controller Interface
@@ -131,6 +134,8 @@ module isa_auto_config (
     input  wire [3:0]  pnp_wd_irq,          // PnP-assigned WD IRQ
     input  wire [2:0]  pnp_fdc_dma,         // PnP-assigned FDC DMA
     input  wire [2:0]  pnp_wd_dma,          // PnP-assigned WD DMA
+    input  wire [15:0] pnp_fdc_mem_base,    // PnP-assigned FDC window [23:8]
+    input  wire        pnp_fdc_mem_16bit,   // PnP-assigned FDC window width
 
     //=========================================================================
     // User Configuration Register Interface (from isa_config_regs)
@@ -143,6 +148,9 @@ module isa_auto_config (
     input  wire [3:0]  user_wd_irq,         // User WD IRQ override
     input  wire [2:0]  user_fdc_dma,        // User FDC DMA channel override
     input  wire [2:0]  user_wd_dma,         // User WD DMA channel override
+    input  wire        user_fdc_win_enable, // User FDC track window enable
+    input  wire [1:0]  user_fdc_win_base_sel, // User FDC window base (D0000 + n*32KB)
+    input  wire        user_fdc_win_16bit,  // User FDC window 16-bit cycles
 
     //=========================================================================
     // Controller Enable Outputs (final gated enable signals)
@@ -317,6 +325,15 @@ module isa_auto_config (
     assign active_wd_alt   = mode_xt ? 10'h000 :  // No alternate in XT mode
                                        10'h3F6;   // Standard AT alternate
 
+    // FDC track window: PnP memory descriptor of LD0 (unassigned = 0),
+    // legacy mode uses CONFIG_FDC_WIN. 16-bit cycles need an AT slot.
+    assign active_fdc_win_enable = mode_pnp ? (pnp_fdc_mem_base != 16'h0000) :
+                                              user_fdc_win_enable;
+    assign active_fdc_win_base   = mode_pnp ? pnp_fdc_mem_base[15:7] :
+                                              (9'h1A + {7'd0, user_fdc_win_base_sel});
+    assign active_fdc_win_16bit  = mode_at &
+                                   (mode_pnp ? pnp_fdc_mem_16bit : user_fdc_win_16bit);
+
     //=========================================================================
     // Controller Enable Gating
     //=========================================================================
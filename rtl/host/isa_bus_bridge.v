@@ -12,6 +12,7 @@
 //   - IRQ generation (IRQ6 for FDC, IRQ14/15 for WD)
 //   - DMA request generation (DRQ2 for FDC, DRQ3 for WD in XT mode)
 //   - Wait state insertion via IOCHRDY
+//   - FDC track window fill: answers FDC DRQ internally (isa_fdc_window)
 //
 // Author: Claude Code (FluxRipper Project)
 // Date: 2025-12-04 21:45
@@ -94,7 +95,14 @@ module isa_bus_bridge #(
     input  wire        wd_enable,         // Enable WD decode
     input  wire [9:0]  wd_io_base,        // WD I/O base (default 0x1F0)
     input  wire [9:0]  wd_alt_base,       // WD alternate base (default 0x3F6)
-    input  wire        wd_dma_enable      // Enable WD DMA mode (XT compatibility)
+    input  wire        wd_dma_enable,     // Enable WD DMA mode (XT compatibility)
+
+    //=========================================================================
+    // FDC Track Window Fill (isa_fdc_window)
+    //=========================================================================
+    input  wire        fdc_win_fill,      // Fill armed: take FDC DRQ off the bus
+    output reg  [7:0]  fdc_win_wdata,     // FIFO byte for the window
+    output reg         fdc_win_we         // fdc_win_wdata valid
 );
 
     //=========================================================================
@@ -133,6 +141,12 @@ module isa_bus_bridge #(
     wire [2:0] fdc_reg_offset = isa_addr[2:0];
     wire [2:0] wd_reg_offset = wd_alt_select ? 3'h7 : isa_addr[2:0];
 
+    localparam [2:0] FDC_REG_DATA = 3'h5;   // 82077AA data FIFO
+
+    // Cycles to wait after a fill read before sampling DRQ again, so the
+    // request of the byte just read has time to drop
+    localparam FILL_HOLDOFF = 4'd15;
+
     //=========================================================================
     // ISA Bus State Machine
     //=========================================================================
@@ -148,19 +162,32 @@ module isa_bus_bridge #(
     reg [2:0] reg_offset;
     reg [7:0] read_data_latch;
     reg       ready_out;
+    reg       is_fill;              // Current AXI read is a window fill
+    reg [3:0] fill_holdoff;
 
     // Edge detection for ISA strobes
     reg isa_ior_n_d, isa_iow_n_d;
-    wire isa_read_start  = isa_ior_n_d && !isa_ior_n && device_select;
-    wire isa_write_start = isa_iow_n_d && !isa_iow_n && device_select;
+    wire isa_read_edge   = isa_ior_n_d && !isa_ior_n && device_select;
+    wire isa_write_edge  = isa_iow_n_d && !isa_iow_n && device_select;
     wire isa_cycle_end   = (!isa_ior_n_d && isa_ior_n) ||
                            (!isa_iow_n_d && isa_iow_n);
 
+    // An ISA cycle that starts during a fill read is held until ST_IDLE;
+    // the strobe is still low then, so address and data remain valid
+    reg  read_pend, write_pend;
+    wire isa_read_start  = isa_read_edge || read_pend;
+    wire isa_write_start = isa_write_edge || write_pend;
+
     always @(posedge clk) begin
         isa_ior_n_d <= isa_ior_n;
         isa_iow_n_d <= isa_iow_n;
     end
 
+    // Window fill request: FDC wants a byte moved and no ISA cycle waits
+    wire fill_start = fdc_win_fill && fdc_drq && fdc_enable &&
+                      (fill_holdoff == 4'd0) &&
+                      !isa_read_start && !isa_write_start;
+
     //=========================================================================
     // AXI Address Calculation
     //=========================================================================
@@ -194,6 +221,12 @@ module isa_bus_bridge #(
             reg_offset      <= 3'b0;
             read_data_latch <= 8'h00;
             ready_out       <= 1'b1;
+            is_fill         <= 1'b0;
+            fill_holdoff    <= 4'd0;
+            read_pend       <= 1'b0;
+            write_pend      <= 1'b0;
+            fdc_win_wdata   <= 8'h00;
+            fdc_win_we      <= 1'b0;
 
             m_axi_awaddr    <= 32'h0;
             m_axi_awvalid   <= 1'b0;
@@ -205,10 +238,28 @@ module isa_bus_bridge #(
             m_axi_arvalid   <= 1'b0;
             m_axi_rready    <= 1'b0;
         end else begin
+            fdc_win_we <= 1'b0;
+
+            if (fill_holdoff != 4'd0) begin
+                fill_holdoff <= fill_holdoff - 1'b1;
+            end
+
+            // Hold ISA cycles that start while the machine is busy
+            if (state != ST_IDLE) begin
+                if (isa_read_edge) begin
+                    read_pend <= 1'b1;
+                end
+                if (isa_write_edge) begin
+                    write_pend <= 1'b1;
+                end
+            end
+
             case (state)
                 //-------------------------------------------------------------
                 ST_IDLE: begin
-                    ready_out <= 1'b1;
+                    ready_out  <= 1'b1;
+                    read_pend  <= 1'b0;
+                    write_pend <= 1'b0;
 
                     if (isa_read_start) begin
                         // ISA read cycle starting
@@ -243,6 +294,16 @@ module isa_bus_bridge #(
                         m_axi_wvalid  <= 1'b1;
 
                         state <= ST_AXI_ADDR;
+
+                    end else if (fill_start) begin
+                        // Window fill: read the FIFO as a DACK cycle would
+                        is_read       <= 1'b1;
+                        is_fdc        <= 1'b1;
+                        is_fill       <= 1'b1;
+                        reg_offset    <= FDC_REG_DATA;
+                        m_axi_araddr  <= calc_axi_addr(1'b1, FDC_REG_DATA, 1'b0);
+                        m_axi_arvalid <= 1'b1;
+                        state         <= ST_AXI_ADDR;
                     end
                 end
 
@@ -275,9 +336,19 @@ module isa_bus_bridge #(
                 ST_AXI_DATA: begin
                     // Read data phase
                     if (m_axi_rvalid) begin
-                        read_data_latch <= m_axi_rdata[7:0];  // Capture low byte
-                        m_axi_rready    <= 1'b0;
-                        state           <= ST_COMPLETE;
+                        m_axi_rready <= 1'b0;
+                        if (is_fill) begin
+                            // No ISA cycle to complete: straight back to idle
+                            fdc_win_wdata <= m_axi_rdata[7:0];
+                            fdc_win_we    <= 1'b1;
+                            is_fill       <= 1'b0;
+                            is_read       <= 1'b0;
+                            fill_holdoff  <= FILL_HOLDOFF;
+                            state         <= ST_IDLE;
+                        end else begin
+                            read_data_latch <= m_axi_rdata[7:0];  // Capture low byte
+                            state           <= ST_COMPLETE;
+                        end
                     end
                 end
 
@@ -315,7 +386,7 @@ module isa_bus_bridge #(
 
     // Data bus output
     always @(*) begin
-        if (is_read && (state == ST_COMPLETE || state == ST_AXI_DATA)) begin
+        if (is_read && !is_fill && (state == ST_COMPLETE || state == ST_AXI_DATA)) begin
             isa_data_out = read_data_latch;
         end else begin
             isa_data_out = 8'hFF;  // Default pullup value
@@ -325,8 +396,8 @@ module isa_bus_bridge #(
     // Output enable - active when reading from this device
     assign isa_data_oe = device_select && !isa_ior_n && !isa_aen;
 
-    // IOCHRDY - low to insert wait states
-    assign isa_iochrdy = ready_out;
+    // IOCHRDY - low to insert wait states (also while a cycle is held)
+    assign isa_iochrdy = ready_out && !read_pend && !write_pend;
 
     //=========================================================================
     // Interrupt and DMA Outputs
@@ -337,8 +408,8 @@ module isa_bus_bridge #(
     assign isa_irq14 = wd_irq_pri && wd_enable;
     assign isa_irq15 = wd_irq_sec && wd_enable;
 
-    // FDC DMA request (channel 2)
-    assign isa_drq2 = fdc_drq && fdc_enable;
+    // FDC DMA request (channel 2), answered internally during a window fill
+    assign isa_drq2 = fdc_drq && fdc_enable && !fdc_win_fill;
 
     // WD HDD DMA request (channel 3 - XT mode only)
     // In XT mode, the WD1002 uses DMA channel 3 for data transfers
@@ -17,6 +17,8 @@
 //   0x07: CONFIG_MAGIC     - Magic number for validation
 //   0x08: CONFIG_INTLV_CTRL - Interleave control (0=auto, 1-8=override)
 //   0x09: CONFIG_INTLV_STAT - Detected interleave (read-only)
+//   0x0A: CONFIG_XFER      - Track window control
+//   0x0B: CONFIG_FDC_WIN   - FDC track window control
 //   0x0E: CONFIG_SAVE      - Write 0x5A to save to flash
 //   0x0F: CONFIG_RESTORE   - Write 0xA5 to restore defaults
 //
@@ -96,7 +98,26 @@ module isa_config_regs #(
     //-------------------------------------------------------------------------
     // Track Buffer Control
     //-------------------------------------------------------------------------
-    output wire        track_buf_bypass      // 1 = bypass track buffer caching (for benchmark)
+    output wire        track_buf_bypass,     // 1 = bypass track buffer caching (for benchmark)
+
+    //-------------------------------------------------------------------------
+    // Track Window Control (isa_track_window)
+    //-------------------------------------------------------------------------
+    output wire        win_enable,           // WD track window decode enabled
+    output wire [2:0]  win_base_sel,         // Window base select (0=D0000 .. 7=EC000)
+    output wire        win_16bit,            // Claim 16-bit cycles (MEMCS16#)
+    input  wire        win_present,          // Window hardware is installed
+
+    //-------------------------------------------------------------------------
+    // FDC Track Window Control (isa_fdc_window)
+    //-------------------------------------------------------------------------
+    output wire        fdc_win_enable,       // Legacy-mode window decode enabled
+    output wire [1:0]  fdc_win_base_sel,     // Window base select (0=D0000 .. 3=E8000)
+    output wire        fdc_win_16bit,        // Claim 16-bit cycles (MEMCS16#)
+    output reg         fdc_win_arm,          // Pulse: start a window fill
+    output reg         fdc_win_abort,        // Pulse: cancel a window fill
+    input  wire        fdc_win_filling,      // Fill in progress
+    input  wire        fdc_win_present       // FDC window hardware is installed
 );
 
     //=========================================================================
@@ -112,6 +133,8 @@ module isa_config_regs #(
     localparam REG_MAGIC    = 4'h7;     // Magic number
     localparam REG_INTLV_CTRL = 4'h8;   // Interleave control
     localparam REG_INTLV_STAT = 4'h9;   // Interleave status (read-only)
+    localparam REG_XFER     = 4'hA;     // Track window control
+    localparam REG_FDC_WIN  = 4'hB;     // FDC track window control
     localparam REG_SAVE     = 4'hE;     // Save to flash
     localparam REG_RESTORE  = 4'hF;     // Restore defaults
 
@@ -164,6 +187,25 @@ module isa_config_regs #(
     //   [7:4] Reserved
     reg [7:0] r_intlv_ctrl;
 
+    // CONFIG_XFER (0x0A) - Track window control
+    //   [0]   WD track window enable
+    //   [3:1] Window base (0=D0000, 1=D4000 .. 7=EC000, 16KB steps)
+    //   [4]   16-bit window cycles (AT slot, window outside C0000-DFFFF)
+    //   [6:5] Reserved
+    //   [7]   Window hardware present (read-only)
+    reg [7:0] r_xfer;
+
+    // CONFIG_FDC_WIN (0x0B) - FDC track window control
+    //   [0]   Window enable (legacy mode; PnP uses the LD0 memory config)
+    //   [2:1] Window base (0=D0000, 1=D8000, 2=E0000, 3=E8000, 32KB steps)
+    //   [3]   16-bit window cycles
+    //   [4]   Fill: write 1 to arm a fill, 0 to cancel one; reads 1 until
+    //         the FDC interrupts
+    //   [6:5] Reserved
+    //   [7]   Window hardware present (read-only)
+    // Not saved to flash: the FDD BIOS sets it up at every boot.
+    reg [7:0] r_fdc_win;
+
     //=========================================================================
     // Default Values
     //=========================================================================
@@ -173,6 +215,8 @@ module isa_config_regs #(
     localparam DEFAULT_DMA  = 8'b0011_0010;  // WD=3, FDC=2
     localparam DEFAULT_IRQ  = 8'b1110_0110;  // WD=14, FDC=6
     localparam DEFAULT_INTLV = 8'b0000_0000; // Interleave auto-match (0)
+    localparam DEFAULT_XFER = 8'b0000_0000;  // Window off, D0000 (BIOS enables)
+    localparam DEFAULT_FDC_WIN = 8'b0000_0110; // Window off, E8000 (BIOS enables)
 
     //=========================================================================
     // Status Register Composition (read-only)
@@ -215,9 +259,19 @@ module isa_config_regs #(
     // Track buffer bypass (bit 7 of CONFIG_WD)
     assign track_buf_bypass = r_wd[7];
 
+    // Track window outputs
+    assign win_enable   = r_xfer[0] && win_present;
+    assign win_base_sel = r_xfer[3:1];
+    assign win_16bit    = r_xfer[4];
+
+    // FDC track window outputs
+    assign fdc_win_enable   = r_fdc_win[0] && fdc_win_present;
+    assign fdc_win_base_sel = r_fdc_win[2:1];
+    assign fdc_win_16bit    = r_fdc_win[3];
+
     // Flash data packing
     assign flash_wdata = {
-        8'h00,          // [63:56] Reserved
+        r_xfer,         // [63:56] Track window config
         r_scratch,      // [55:48] Scratch
         r_irq,          // [47:40] IRQ config
         r_dma,          // [39:32] DMA config
@@ -242,12 +296,18 @@ module isa_config_regs #(
             r_irq        <= DEFAULT_IRQ;
             r_scratch    <= 8'h00;
             r_intlv_ctrl <= DEFAULT_INTLV;
+            r_xfer       <= DEFAULT_XFER;
+            r_fdc_win    <= DEFAULT_FDC_WIN;
+            fdc_win_arm  <= 1'b0;
+            fdc_win_abort <= 1'b0;
             flash_save_req    <= 1'b0;
             flash_restore_req <= 1'b0;
         end else begin
             // Clear single-cycle requests
             flash_save_req    <= 1'b0;
             flash_restore_req <= 1'b0;
+            fdc_win_arm       <= 1'b0;
+            fdc_win_abort     <= 1'b0;
 
             // Handle flash restore completion
             if (flash_valid) begin
@@ -259,6 +319,7 @@ module isa_config_regs #(
                     r_dma     <= flash_rdata[39:32];
                     r_irq     <= flash_rdata[47:40];
                     r_scratch <= flash_rdata[55:48];
+                    r_xfer    <= {1'b0, flash_rdata[62:56]};
                 end
                 // If magic doesn't match, keep defaults
             end
@@ -297,6 +358,21 @@ module isa_config_regs #(
                         end
                     end
 
+                    REG_XFER: begin
+                        // Bit 7 reflects the hardware, not stored
+                        r_xfer <= {1'b0, reg_wdata[6:0]};
+                    end
+
+                    REG_FDC_WIN: begin
+                        // Bit 4 is a command, bit 7 reflects the hardware
+                        r_fdc_win <= {4'b0, reg_wdata[3:0]};
+                        if (reg_wdata[4] && fdc_win_present) begin
+                            fdc_win_arm <= 1'b1;
+                        end else begin
+                            fdc_win_abort <= 1'b1;
+                        end
+                    end
+
                     REG_SAVE: begin
                         if (reg_wdata == MAGIC_SAVE && !flash_busy) begin
                             flash_save_req <= 1'b1;
@@ -338,6 +414,9 @@ module isa_config_regs #(
             REG_MAGIC:      reg_rdata = MAGIC_NUMBER;
             REG_INTLV_CTRL: reg_rdata = r_intlv_ctrl;
             REG_INTLV_STAT: reg_rdata = {4'h0, interleave_detected};  // Read-only
+            REG_XFER:       reg_rdata = {win_present, r_xfer[6:0]};
+            REG_FDC_WIN:    reg_rdata = {fdc_win_present, 2'b00, fdc_win_filling,
+                                         r_fdc_win[3:0]};
             REG_SAVE:       reg_rdata = flash_busy ? 8'hFF : 8'h00;
             REG_RESTORE:    reg_rdata = flash_busy ? 8'hFF : 8'h00;
             default:        reg_rdata = 8'hFF;
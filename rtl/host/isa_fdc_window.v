@@ -0,0 +1,214 @@
+//==============================================================================
+// ISA FDC Track Window
+//==============================================================================
+// File: isa_fdc_window.v
+// Description: Read-only ISA memory window that collects the data phase of
+//              an FDC read command. While a fill is armed, isa_bus_bridge
+//              answers the FDC's DMA requests itself and stores each FIFO
+//              byte here instead of raising DRQ2; the host then copies the
+//              whole track out with REP MOVSW instead of one 8237 cycle per
+//              byte.
+//
+// Features:
+//   - 32KB window: PnP memory descriptor of LD0, or CONFIG_FDC_WIN base
+//   - 16-bit cycles (MEMCS16#) when enabled, 8-bit otherwise
+//   - Address decode with AEN/REFRESH# checks like isa_track_window
+//   - Fill armed by CONFIG_FDC_WIN, ended by the FDC interrupt or a cancel
+//
+// Memory Map (offsets in the window):
+//   0000h-7BFFh - Data bytes of the last fill, in disk order
+//   7C00h-7C07h - Window header:
+//                 +0 'FRFW', +4 version, +5 status (bit 0 fill active,
+//                 bit 1 overflow), +6 bytes filled (word)
+//   7C08h-7FFFh - Reads FFh
+//
+// A fill keeps draining the FIFO after the data area is full, so the FDC
+// still reaches its result phase; the extra bytes are dropped and the
+// overflow bit is set. One cylinder of 1.44MB media (18KB) fits; an ED
+// track side does too, an ED cylinder does not.
+//
+// MEMCS16# is decoded from LA[23:17] and covers the whole 128KB block, as
+// in isa_track_window.
+//
+// Author: FluxRipper Project
+// Date: 2025-12-11 16:40
+//==============================================================================
+
+`timescale 1ns / 1ps
+
+module isa_fdc_window #(
+    parameter DATA_BYTES = 31744                // 0000h-7BFFh
+)(
+    input  wire        clk,
+    input  wire        reset_n,
+
+    //=========================================================================
+    // ISA Memory Bus Interface
+    //=========================================================================
+    input  wire [19:0] isa_sa,            // System Address SA[19:0]
+    input  wire [6:0]  isa_la,            // Latched Address LA[23:17]
+    input  wire        isa_sbhe_n,        // System Byte High Enable (active low)
+
+    input  wire        isa_memr_n,        // Memory Read strobe (active low)
+    input  wire        isa_aen,           // Address Enable (high during DMA)
+    input  wire        isa_refresh_n,     // Refresh cycle (ignore when low)
+
+    output wire [15:0] isa_data_out,      // Data to ISA bus
+    output wire        isa_data_oe_lo,    // Output enable SD[7:0]
+    output wire        isa_data_oe_hi,    // Output enable SD[15:8]
+    output wire        isa_memcs16_n,     // 16-bit memory cycle (open collector)
+    output wire        isa_mem_ready,     // I/O Channel Ready (active high)
+
+    //=========================================================================
+    // Fill Port (from isa_bus_bridge)
+    //=========================================================================
+    input  wire [7:0]  fill_data,         // FIFO byte
+    input  wire        fill_we,           // Store fill_data at the fill pointer
+    output reg         fill_active,       // Fill armed, bridge answers DRQ
+
+    //=========================================================================
+    // Control
+    //=========================================================================
+    input  wire        fill_arm,          // Pulse: reset pointer, start a fill
+    input  wire        fill_abort,        // Pulse: cancel the fill (DRQ2 back on the bus)
+    input  wire        fdc_irq,           // FDC interrupt (ends the fill)
+
+    //=========================================================================
+    // Configuration (isa_auto_config active_fdc_win_*)
+    //=========================================================================
+    input  wire        win_enable,        // Enable window decode
+    input  wire [8:0]  win_base,          // Window base [23:15]
+    input  wire        win_16bit          // Claim 16-bit cycles
+);
+
+    localparam HDR_OFFSET = 15'h7C00;
+    localparam HDR_BYTES  = 8;
+    localparam VERSION    = 8'h01;
+
+    //=========================================================================
+    // Window Buffer (even and odd byte banks)
+    //=========================================================================
+    reg [7:0] mem_lo [0:DATA_BYTES/2-1];
+    reg [7:0] mem_hi [0:DATA_BYTES/2-1];
+
+    reg [15:0] fill_ptr;
+    reg        overflow;
+    reg        fdc_irq_d;
+
+    always @(posedge clk or negedge reset_n) begin
+        if (!reset_n) begin
+            fill_ptr    <= 16'd0;
+            fill_active <= 1'b0;
+            overflow    <= 1'b0;
+            fdc_irq_d   <= 1'b0;
+        end else begin
+            fdc_irq_d <= fdc_irq;
+
+            if (fill_arm) begin
+                fill_ptr    <= 16'd0;
+                fill_active <= 1'b1;
+                overflow    <= 1'b0;
+            end else if (fill_abort) begin
+                fill_active <= 1'b0;
+            end else if (fill_active) begin
+                if (fill_we) begin
+                    if (fill_ptr < DATA_BYTES) begin
+                        fill_ptr <= fill_ptr + 1'b1;
+                    end else begin
+                        overflow <= 1'b1;
+                    end
+                end
+
+                // Result phase reached: data phase is over
+                if (fdc_irq && !fdc_irq_d) begin
+                    fill_active <= 1'b0;
+                end
+            end
+        end
+    end
+
+    always @(posedge clk) begin
+        if (fill_active && fill_we && fill_ptr < DATA_BYTES) begin
+            if (fill_ptr[0]) begin
+                mem_hi[fill_ptr[15:1]] <= fill_data;
+            end else begin
+                mem_lo[fill_ptr[15:1]] <= fill_data;
+            end
+        end
+    end
+
+    //=========================================================================
+    // Address Decode
+    //=========================================================================
+    wire [23:0] active_base = {win_base, 15'd0};
+    wire [23:0] full_addr   = {isa_la[6:0], isa_sa[16:0]};
+
+    wire addr_in_range = (full_addr[23:15] == win_base);
+
+    wire win_selected = win_enable &&
+                        addr_in_range &&
+                        !isa_memr_n &&
+                        !isa_aen &&
+                        isa_refresh_n;
+
+    // MEMCS16# must come from LA alone, before MEMR#: whole 128KB block
+    wire block_match = (isa_la[6:0] == active_base[23:17]);
+    wire cycle_16 = win_enable && win_16bit && block_match;
+
+    assign isa_memcs16_n = !cycle_16;
+
+    //=========================================================================
+    // Window Data
+    //=========================================================================
+    wire [14:0] win_offset = full_addr[14:0];
+    wire        in_data    = (win_offset < DATA_BYTES);
+    wire        in_header  = (win_offset >= HDR_OFFSET) &&
+                             (win_offset < HDR_OFFSET + HDR_BYTES);
+
+    wire [7:0]  status = {6'd0, overflow, fill_active};
+
+    reg  [15:0] word_data;
+
+    always @(*) begin
+        if (in_data) begin
+            word_data = {mem_hi[win_offset[14:1]], mem_lo[win_offset[14:1]]};
+        end else if (in_header) begin
+            case (win_offset[2:1])
+                2'd0:    word_data = {"R", "F"};
+                2'd1:    word_data = {"W", "F"};
+                2'd2:    word_data = {status, VERSION};
+                default: word_data = fill_ptr;
+            endcase
+        end else begin
+            word_data = 16'hFFFF;
+        end
+    end
+
+    // 16-bit cycle: even byte on SD[7:0], odd byte on SD[15:8], lanes
+    // chosen by SA0/SBHE#. 8-bit cycle: the addressed byte on SD[7:0].
+    wire lane_lo = cycle_16 ? !win_offset[0] : 1'b1;
+    wire lane_hi = cycle_16 ? !isa_sbhe_n    : 1'b0;
+
+    assign isa_data_out[7:0]  = (!cycle_16 && win_offset[0]) ? word_data[15:8] :
+                                                               word_data[7:0];
+    assign isa_data_out[15:8] = word_data[15:8];
+
+    assign isa_data_oe_lo = win_selected && lane_lo;
+    assign isa_data_oe_hi = win_selected && lane_hi;
+
+    // Buffer read is combinational: no wait states
+    assign isa_mem_ready = 1'b1;
+
+    `ifdef SIMULATION
+    always @(posedge clk) begin
+        if (fill_arm) begin
+            $display("[FWIN] Fill armed");
+        end
+        if (fill_active && fdc_irq && !fdc_irq_d) begin
+            $display("[FWIN] Fill done: %0d bytes%s", fill_ptr,
+                     overflow ? " (overflow)" : "");
+        end
+    end
+    `endif
+
+endmodule
@@ -10,6 +10,7 @@
 //   - Serial isolation protocol
 //   - Two logical devices: FDC (LD0) and WD (LD1)
 //   - Dynamic I/O base and IRQ configuration
+//   - 24-bit memory range for the FDC track window (LD0)
 //   - Resource descriptor ROM
 //   - Integration with isa_pnp_sniffer for "Sleep-until-Key" strategy
 //   - Legacy mode support for non-PnP systems
@@ -60,6 +61,8 @@ module isa_pnp_controller #(
     output reg  [9:0]  fdc_io_base,        // Default 0x3F0
     output reg  [3:0]  fdc_irq,            // Default IRQ6
     output reg  [2:0]  fdc_dma,            // Default DRQ2
+    output reg  [15:0] fdc_mem_base,       // Track window base [23:8], 0=none
+    output reg         fdc_mem_16bit,      // Track window 16-bit cycles
 
     // WD Configuration (Logical Device 1)
     output reg         wd_activated,
@@ -103,6 +106,11 @@ module isa_pnp_controller #(
     // Logical Device Registers (base + offset)
     localparam REG_ACTIVATE      = 8'h30;
     localparam REG_IO_RANGE_CHK  = 8'h31;
+    localparam REG_MEM_BASE_HI   = 8'h40;
+    localparam REG_MEM_BASE_LO   = 8'h41;
+    localparam REG_MEM_CTRL      = 8'h42;
+    localparam REG_MEM_LIMIT_HI  = 8'h43;
+    localparam REG_MEM_LIMIT_LO  = 8'h44;
     localparam REG_IO_BASE_HI    = 8'h60;
     localparam REG_IO_BASE_LO    = 8'h61;
     localparam REG_IO2_BASE_HI   = 8'h62;
@@ -116,6 +124,10 @@ module isa_pnp_controller #(
     localparam CC_WAIT_FOR_KEY   = 8'h02;
     localparam CC_RETURN_CSN     = 8'h04;
 
+    // Memory control: [1] 16-bit, [0] 0 = limit registers hold range length
+    // FDC track window range length (32KB, bits [23:8]), read-only
+    localparam [15:0] FDC_MEM_LENGTH = 16'h0080;
+
     //=========================================================================
     // PnP Initiation Key (LFSR sequence)
     //=========================================================================
@@ -204,6 +216,8 @@ module isa_pnp_controller #(
             fdc_io_base      <= 10'h3F0;
             fdc_irq          <= 4'd6;
             fdc_dma          <= 3'd2;
+            fdc_mem_base     <= 16'h0000;  // Window unassigned
+            fdc_mem_16bit    <= 1'b0;
 
             // Default WD configuration
             wd_activated     <= 1'b0;
@@ -389,6 +403,24 @@ module isa_pnp_controller #(
                                 end
                             end
 
+                            REG_MEM_BASE_HI: begin
+                                if (current_ld == 8'h00) begin
+                                    fdc_mem_base[15:8] <= isa_data_in;
+                                end
+                            end
+
+                            REG_MEM_BASE_LO: begin
+                                if (current_ld == 8'h00) begin
+                                    fdc_mem_base[7:0] <= isa_data_in;
+                                end
+                            end
+
+                            REG_MEM_CTRL: begin
+                                if (current_ld == 8'h00) begin
+                                    fdc_mem_16bit <= isa_data_in[1];
+                                end
+                            end
+
                             REG_IO2_BASE_HI: begin
                                 // Secondary I/O base (WD alternate)
                                 if (current_ld == 8'h01) begin
@@ -501,6 +533,27 @@ module isa_pnp_controller #(
                     end
                 end
 
+                REG_MEM_BASE_HI: begin
+                    isa_data_out = (current_ld == 8'h00) ? fdc_mem_base[15:8] : 8'h00;
+                end
+
+                REG_MEM_BASE_LO: begin
+                    isa_data_out = (current_ld == 8'h00) ? fdc_mem_base[7:0] : 8'h00;
+                end
+
+                REG_MEM_CTRL: begin
+                    isa_data_out = (current_ld == 8'h00) ? {6'b0, fdc_mem_16bit, 1'b0} :
+                                                           8'h00;
+                end
+
+                REG_MEM_LIMIT_HI: begin
+                    isa_data_out = (current_ld == 8'h00) ? FDC_MEM_LENGTH[15:8] : 8'h00;
+                end
+
+                REG_MEM_LIMIT_LO: begin
+                    isa_data_out = (current_ld == 8'h00) ? FDC_MEM_LENGTH[7:0] : 8'h00;
+                end
+
                 REG_IRQ_SELECT: begin
                     if (current_ld == 8'h00) begin
                         isa_data_out = {4'b0, fdc_irq};
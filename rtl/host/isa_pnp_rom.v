@@ -40,12 +40,17 @@ module isa_pnp_rom #(
     localparam TAG_FIXED_IO          = 8'h4B;  // Fixed I/O (3 bytes)
     localparam TAG_END               = 8'h79;  // End tag
 
+    //=========================================================================
+    // Resource Descriptor Tags (Large Resource)
+    //=========================================================================
+    localparam TAG_MEM_RANGE         = 8'h81;  // 24-bit memory range (9 bytes)
+
     //=========================================================================
     // Resource Data ROM
     //=========================================================================
     // ROM contains descriptors for:
     //   - Card identification (Vendor ID, Serial, etc.)
-    //   - Logical Device 0: FDC (0x3F0-0x3F7, IRQ6, DRQ2)
+    //   - Logical Device 0: FDC (0x3F0-0x3F7, IRQ6, DRQ2, 32KB track window)
     //   - Logical Device 1: WD HDD (0x1F0-0x1F7, 0x3F6-0x3F7, IRQ14)
 
     always @(posedge clk) begin
@@ -105,47 +110,61 @@ module isa_pnp_rom #(
             8'h1D: data <= 8'h04;  // DMA2 (bit 2)
             8'h1E: data <= 8'h00;  // 8-bit, compatibility mode
 
+            // FDC Track Window: 32KB 24-bit memory range, D0000-EFFFF
+            8'h1F: data <= TAG_MEM_RANGE;
+            8'h20: data <= 8'h09;  // Length low (9 bytes)
+            8'h21: data <= 8'h00;  // Length high
+            8'h22: data <= 8'h10;  // Read-only, 8/16-bit, range length
+            8'h23: data <= 8'h00;  // Min base [15:8] (0xD0000)
+            8'h24: data <= 8'h0D;  // Min base [23:16]
+            8'h25: data <= 8'h80;  // Max base [15:8] (0xE8000)
+            8'h26: data <= 8'h0E;  // Max base [23:16]
+            8'h27: data <= 8'h00;  // Alignment low (0x8000)
+            8'h28: data <= 8'h80;  // Alignment high
+            8'h29: data <= 8'h80;  // Range length low (32KB / 256)
+            8'h2A: data <= 8'h00;  // Range length high
+
             //=================================================================
             // Logical Device 1: WD HDD (Hard Disk Controller)
             //=================================================================
             // Logical Device ID: PNP0600 (Standard IDE)
-            8'h1F: data <= TAG_LOG_DEV_ID;
-            8'h20: data <= 8'h41;  // 'P' compressed
-            8'h21: data <= 8'hD0;  // 'N' + 'P' compressed
-            8'h22: data <= 8'h06;  // Device 06
-            8'h23: data <= 8'h00;  // 00
+            8'h2B: data <= TAG_LOG_DEV_ID;
+            8'h2C: data <= 8'h41;  // 'P' compressed
+            8'h2D: data <= 8'hD0;  // 'N' + 'P' compressed
+            8'h2E: data <= 8'h06;  // Device 06
+            8'h2F: data <= 8'h00;  // 00
 
             // WD Primary I/O Port: 0x1F0-0x1F7
-            8'h24: data <= TAG_IO_PORT;
-            8'h25: data <= 8'h01;  // Decode 10-bit
-            8'h26: data <= 8'hF0;  // Min base low (0x1F0)
-            8'h27: data <= 8'h01;  // Min base high
-            8'h28: data <= 8'hF0;  // Max base low (0x1F0)
-            8'h29: data <= 8'h01;  // Max base high
-            8'h2A: data <= 8'h01;  // Alignment
-            8'h2B: data <= 8'h08;  // Range length (8 ports)
+            8'h30: data <= TAG_IO_PORT;
+            8'h31: data <= 8'h01;  // Decode 10-bit
+            8'h32: data <= 8'hF0;  // Min base low (0x1F0)
+            8'h33: data <= 8'h01;  // Min base high
+            8'h34: data <= 8'hF0;  // Max base low (0x1F0)
+            8'h35: data <= 8'h01;  // Max base high
+            8'h36: data <= 8'h01;  // Alignment
+            8'h37: data <= 8'h08;  // Range length (8 ports)
 
             // WD Alternate I/O Port: 0x3F6-0x3F7
-            8'h2C: data <= TAG_FIXED_IO;
-            8'h2D: data <= 8'hF6;  // Base low (0x3F6)
-            8'h2E: data <= 8'h03;  // Base high
-            8'h2F: data <= 8'h02;  // Range length (2 ports)
+            8'h38: data <= TAG_FIXED_IO;
+            8'h39: data <= 8'hF6;  // Base low (0x3F6)
+            8'h3A: data <= 8'h03;  // Base high
+            8'h3B: data <= 8'h02;  // Range length (2 ports)
 
             // WD IRQ Descriptor: IRQ14 (AT) / IRQ5 (XT)
-            8'h30: data <= TAG_IRQ_FORMAT;
-            8'h31: data <= 8'h20;  // IRQ5 (bit 5) for XT compatibility
-            8'h32: data <= 8'h40;  // IRQ14 (bit 6 of high byte) for AT
+            8'h3C: data <= TAG_IRQ_FORMAT;
+            8'h3D: data <= 8'h20;  // IRQ5 (bit 5) for XT compatibility
+            8'h3E: data <= 8'h40;  // IRQ14 (bit 6 of high byte) for AT
 
             // WD DMA Descriptor: DRQ3 (XT mode)
-            8'h33: data <= TAG_DMA_FORMAT;
-            8'h34: data <= 8'h08;  // DMA3 (bit 3)
-            8'h35: data <= 8'h00;  // 8-bit, compatibility mode
+            8'h3F: data <= TAG_DMA_FORMAT;
+            8'h40: data <= 8'h08;  // DMA3 (bit 3)
+            8'h41: data <= 8'h00;  // 8-bit, compatibility mode
 
             //=================================================================
             // End Tag
             //=================================================================
-            8'h36: data <= TAG_END;
-            8'h37: data <= 8'h00;  // Checksum (placeholder)
+            8'h42: data <= TAG_END;
+            8'h43: data <= 8'h00;  // Checksum (placeholder)
 
             //=================================================================
             // Padding / Default
@@ -277,66 +296,80 @@ module isa_pnp_rom_extended #(
             9'h04C: data <= 8'h04;
             9'h04D: data <= 8'h00;
 
+            // FDC track window (same as basic)
+            9'h04E: data <= 8'h81;  // TAG_MEM_RANGE
+            9'h04F: data <= 8'h09;
+            9'h050: data <= 8'h00;
+            9'h051: data <= 8'h10;
+            9'h052: data <= 8'h00;
+            9'h053: data <= 8'h0D;
+            9'h054: data <= 8'h80;
+            9'h055: data <= 8'h0E;
+            9'h056: data <= 8'h00;
+            9'h057: data <= 8'h80;
+            9'h058: data <= 8'h80;
+            9'h059: data <= 8'h00;
+
             //=================================================================
             // Logical Device 1: WD HDD
             //=================================================================
-            9'h04E: data <= 8'h15;  // TAG_LOG_DEV_ID
-            9'h04F: data <= 8'h41;  // PNP
-            9'h050: data <= 8'hD0;
-            9'h051: data <= 8'h06;  // 0600
-            9'h052: data <= 8'h00;
+            9'h05A: data <= 8'h15;  // TAG_LOG_DEV_ID
+            9'h05B: data <= 8'h41;  // PNP
+            9'h05C: data <= 8'hD0;
+            9'h05D: data <= 8'h06;  // 0600
+            9'h05E: data <= 8'h00;
 
             // WD ANSI name
-            9'h053: data <= TAG_ANSI_ID;
-            9'h054: data <= 8'h0E;  // Length (14 bytes)
-            9'h055: data <= 8'h00;
+            9'h05F: data <= TAG_ANSI_ID;
+            9'h060: data <= 8'h0E;  // Length (14 bytes)
+            9'h061: data <= 8'h00;
             // "HDD Controller"
-            9'h056: data <= "H";
-            9'h057: data <= "D";
-            9'h058: data <= "D";
-            9'h059: data <= " ";
-            9'h05A: data <= "C";
-            9'h05B: data <= "o";
-            9'h05C: data <= "n";
-            9'h05D: data <= "t";
-            9'h05E: data <= "r";
-            9'h05F: data <= "o";
-            9'h060: data <= "l";
-            9'h061: data <= "l";
-            9'h062: data <= "e";
-            9'h063: data <= "r";
+            9'h062: data <= "H";
+            9'h063: data <= "D";
+            9'h064: data <= "D";
+            9'h065: data <= " ";
+            9'h066: data <= "C";
+            9'h067: data <= "o";
+            9'h068: data <= "n";
+            9'h069: data <= "t";
+            9'h06A: data <= "r";
+            9'h06B: data <= "o";
+            9'h06C: data <= "l";
+            9'h06D: data <= "l";
+            9'h06E: data <= "e";
+            9'h06F: data <= "r";
 
             // WD Primary I/O
-            9'h064: data <= 8'h47;
-            9'h065: data <= 8'h01;
-            9'h066: data <= 8'hF0;
-            9'h067: data <= 8'h01;
-            9'h068: data <= 8'hF0;
-            9'h069: data <= 8'h01;
-            9'h06A: data <= 8'h01;
-            9'h06B: data <= 8'h08;
+            9'h070: data <= 8'h47;
+            9'h071: data <= 8'h01;
+            9'h072: data <= 8'hF0;
+            9'h073: data <= 8'h01;
+            9'h074: data <= 8'hF0;
+            9'h075: data <= 8'h01;
+            9'h076: data <= 8'h01;
+            9'h077: data <= 8'h08;
 
             // WD Alternate I/O
-            9'h06C: data <= 8'h4B;  // TAG_FIXED_IO
-            9'h06D: data <= 8'hF6;
-            9'h06E: data <= 8'h03;
-            9'h06F: data <= 8'h02;
+            9'h078: data <= 8'h4B;  // TAG_FIXED_IO
+            9'h079: data <= 8'hF6;
+            9'h07A: data <= 8'h03;
+            9'h07B: data <= 8'h02;
 
             // WD IRQ14 (AT) / IRQ5 (XT)
-            9'h070: data <= 8'h22;
-            9'h071: data <= 8'h20;  // IRQ5 (bit 5) for XT
-            9'h072: data <= 8'h40;  // IRQ14 (bit 6 high byte) for AT
+            9'h07C: data <= 8'h22;
+            9'h07D: data <= 8'h20;  // IRQ5 (bit 5) for XT
+            9'h07E: data <= 8'h40;  // IRQ14 (bit 6 high byte) for AT
 
             // WD DMA3 (XT mode)
-            9'h073: data <= 8'h2A;  // TAG_DMA_FORMAT
-            9'h074: data <= 8'h08;  // DMA3 (bit 3)
-            9'h075: data <= 8'h00;  // 8-bit, compatibility mode
+            9'h07F: data <= 8'h2A;  // TAG_DMA_FORMAT
+            9'h080: data <= 8'h08;  // DMA3 (bit 3)
+            9'h081: data <= 8'h00;  // 8-bit, compatibility mode
 
             //=================================================================
             // End Tag
             //=================================================================
-            9'h076: data <= 8'h79;  // TAG_END
-            9'h077: data <= 8'h00;
+            9'h082: data <= 8'h79;  // TAG_END
+            9'h083: data <= 8'h00;
 
             default: data <= 8'hFF;
         endcase
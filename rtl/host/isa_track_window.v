@@ -0,0 +1,134 @@
+//==============================================================================
+// ISA Track Window
+//==============================================================================
+// File: isa_track_window.v
+// Description: Read-only ISA memory window onto the WD track buffer.
+//              The option ROM loads up to a track of sectors into the
+//              buffer with the vendor LOAD WINDOW command (F0h) and copies
+//              them out with REP MOVSW, instead of one DRQ handshake and
+//              256 data port reads per sector.
+//
+// Features:
+//   - 16KB window, base selectable in CONFIG_XFER (D0000h default)
+//   - 16-bit cycles (MEMCS16#) when enabled, 8-bit otherwise
+//   - Address decode with AEN/REFRESH# checks like isa_option_rom
+//   - Single-cycle access from the buffer's window read port
+//
+// Memory Map (offsets in the window):
+//   0000h-21FFh - Sectors loaded by LOAD WINDOW, in request order
+//   2200h-227Fh - Buffer metadata, window header written by firmware:
+//                 +0 'FRTW', +4 version, +5 capacity (sectors),
+//                 +6 sectors loaded, +7 drive, +8 cylinder (word),
+//                 +A head, +B first sector
+//   2280h-3FFFh - Reads FFh
+//
+// MEMCS16# is decoded from LA[23:17] as the bus requires, so it covers
+// the whole 128KB block. Only enable 16-bit cycles when nothing 8-bit
+// (this card's option ROM included) shares the block, i.e. for bases at
+// E0000h and up.
+//
+// Author: FluxRipper Project
+// Date: 2025-12-11 14:20
+//==============================================================================
+
+`timescale 1ns / 1ps
+
+module isa_track_window #(
+    parameter BUFFER_BYTES = 8832               // wd_track_buffer incl. metadata
+)(
+    input  wire        clk,
+    input  wire        reset_n,
+
+    //=========================================================================
+    // ISA Memory Bus Interface
+    //=========================================================================
+    input  wire [19:0] isa_sa,            // System Address SA[19:0]
+    input  wire [6:0]  isa_la,            // Latched Address LA[23:17]
+    input  wire        isa_sbhe_n,        // System Byte High Enable (active low)
+
+    input  wire        isa_memr_n,        // Memory Read strobe (active low)
+    input  wire        isa_aen,           // Address Enable (high during DMA)
+    input  wire        isa_refresh_n,     // Refresh cycle (ignore when low)
+
+    output wire [15:0] isa_data_out,      // Data to ISA bus
+    output wire        isa_data_oe_lo,    // Output enable SD[7:0]
+    output wire        isa_data_oe_hi,    // Output enable SD[15:8]
+    output wire        isa_memcs16_n,     // 16-bit memory cycle (open collector)
+    output wire        isa_mem_ready,     // I/O Channel Ready (active high)
+
+    //=========================================================================
+    // Track Buffer Window Port
+    //=========================================================================
+    output wire [12:0] win_addr,          // Word address into the buffer
+    input  wire [15:0] win_rdata,         // {odd byte, even byte}
+
+    //=========================================================================
+    // Configuration (isa_config_regs CONFIG_XFER)
+    //=========================================================================
+    input  wire        win_enable,        // Enable window decode
+    input  wire [2:0]  win_base_sel,      // 0=D0000h .. 7=EC000h
+    input  wire        win_16bit          // Claim 16-bit cycles
+);
+
+    localparam WIN_SIZE = 16 * 1024;
+
+    //=========================================================================
+    // Base Address Selection
+    //=========================================================================
+    wire [23:0] active_base = 24'hD0000 + {7'd0, win_base_sel, 14'd0};
+
+    //=========================================================================
+    // Address Decode
+    //=========================================================================
+    wire [23:0] full_addr = {isa_la[6:0], isa_sa[16:0]};
+
+    wire addr_in_range = (full_addr >= active_base) &&
+                         (full_addr < (active_base + WIN_SIZE));
+
+    wire win_selected = win_enable &&
+                        addr_in_range &&
+                        !isa_memr_n &&
+                        !isa_aen &&
+                        isa_refresh_n;
+
+    // MEMCS16# must come from LA alone, before MEMR#: whole 128KB block
+    wire block_match = (isa_la[6:0] == active_base[23:17]);
+    wire cycle_16 = win_enable && win_16bit && block_match;
+
+    assign isa_memcs16_n = !cycle_16;
+
+    //=========================================================================
+    // Buffer Address and Data
+    //=========================================================================
+    wire [13:0] win_offset = full_addr[13:0] - active_base[13:0];
+    wire        in_buffer  = (win_offset < BUFFER_BYTES);
+    wire [15:0] word_data  = in_buffer ? win_rdata : 16'hFFFF;
+
+    assign win_addr = win_offset[13:1];
+
+    // 16-bit cycle: even byte on SD[7:0], odd byte on SD[15:8], lanes
+    // chosen by SA0/SBHE#. 8-bit cycle: the addressed byte on SD[7:0]
+    // (the motherboard swaps odd bytes).
+    wire lane_lo = cycle_16 ? !win_offset[0] : 1'b1;
+    wire lane_hi = cycle_16 ? !isa_sbhe_n    : 1'b0;
+
+    assign isa_data_out[7:0]  = (!cycle_16 && win_offset[0]) ? word_data[15:8] :
+                                                               word_data[7:0];
+    assign isa_data_out[15:8] = word_data[15:8];
+
+    assign isa_data_oe_lo = win_selected && lane_lo;
+    assign isa_data_oe_hi = win_selected && lane_hi;
+
+    // Buffer port is combinational: no wait states
+    assign isa_mem_ready = 1'b1;
+
+    `ifdef SIMULATION
+    always @(posedge clk) begin
+        if (win_selected) begin
+            $display("[TWIN] Read: Addr=%h Data=%h %s", full_addr, word_data,
+                     cycle_16 ? "16" : "8");
+        end
+    end
+    `endif
+
+endmodule
@@ -10,6 +10,10 @@
 //   - Running statistics: min, max, mean, peak bin
 //   - Overflow/underflow counting
 //   - Snapshot capability for multi-pass comparison
+//   - Block read port: two bins per 32-bit word, so the whole array maps
+//     into a linear register window (BIN_WIDTH <= 16)
+//   - Ping-pong banks: one bank counts while the other holds the previous
+//     interval frozen for readout, swapped on index or on command
 //
 // Created: 2025-12-04 18:00
 //-----------------------------------------------------------------------------
@@ -36,12 +40,28 @@ module flux_histogram #(
     input  wire                    clear,           // Clear all bins and stats
     input  wire                    snapshot,        // Capture current stats to snapshot regs
 
+    //-------------------------------------------------------------------------
+    // Ping-pong Banks
+    //   banked=0: one bank, reads see the live counts (original behaviour)
+    //   banked=1: reads see the frozen bank; a swap freezes the live bank
+    //             and its stats and restarts counting in the other one
+    //-------------------------------------------------------------------------
+    input  wire                    banked,          // Enable ping-pong banks
+    input  wire                    swap_on_index,   // Swap on every index pulse
+    input  wire                    index_pulse,     // Index (one-clock pulse)
+    input  wire                    swap,            // Swap now (one-clock pulse)
+
     //-------------------------------------------------------------------------
     // Histogram Read Interface
     //-------------------------------------------------------------------------
     input  wire [7:0]              read_bin,        // Bin index to read
     output wire [BIN_WIDTH-1:0]    read_data,       // Bin count at read_bin
 
+    // Block read: word n = {bin 2n+1, bin 2n}, addressed straight from the
+    // bus offset so a full readout is BIN_COUNT/2 plain loads
+    input  wire [6:0]              read_word,       // Bin pair index
+    output wire [31:0]             read_word_data,  // Bin pair counts
+
     //-------------------------------------------------------------------------
     // Statistics Output
     //-------------------------------------------------------------------------
@@ -64,13 +84,30 @@ module flux_histogram #(
     output reg  [31:0]             snap_total,
     output reg  [7:0]              snap_peak_bin,
     output reg  [BIN_WIDTH-1:0]    snap_peak_count,
-    output reg  [INTERVAL_BITS-1:0] snap_mean
+    output reg  [INTERVAL_BITS-1:0] snap_mean,
+
+    //-------------------------------------------------------------------------
+    // Frozen Bank Statistics (captured on swap)
+    //-------------------------------------------------------------------------
+    output reg                     active_bank,     // Bank being counted
+    output reg  [15:0]             swap_count,      // Swaps since clear
+    output reg  [31:0]             frz_total,
+    output reg  [INTERVAL_BITS-1:0] frz_min,
+    output reg  [INTERVAL_BITS-1:0] frz_max,
+    output reg  [7:0]              frz_peak_bin,
+    output reg  [BIN_WIDTH-1:0]    frz_peak_count,
+    output reg  [INTERVAL_BITS-1:0] frz_mean,
+    output reg  [31:0]             frz_overflow
 );
 
     //-------------------------------------------------------------------------
-    // Histogram Memory (dual-port: one for update, one for read)
+    // Histogram Memory (two banks: one for update, one for read)
     //-------------------------------------------------------------------------
-    reg [BIN_WIDTH-1:0] histogram [0:BIN_COUNT-1];
+    reg [BIN_WIDTH-1:0] histogram [0:2*BIN_COUNT-1];
+
+    // Banked: reads come from the frozen bank, otherwise from the live one
+    wire read_bank = banked ? ~active_bank : active_bank;
+    wire do_swap = banked && (swap || (swap_on_index && index_pulse));
 
     // Bin index calculation
     wire [7:0] bin_index;
@@ -85,6 +122,9 @@ module flux_histogram #(
     assign bin_index = bin_overflow ? (BIN_COUNT - 1) : shifted_interval[7:0];
     assign bin_valid = flux_valid && enable;
 
+    wire [8:0] live_index = {active_bank, bin_index};
+    wire [8:0] next_index = {~active_bank, bin_index};
+
     //-------------------------------------------------------------------------
     // Histogram Update Logic
     //-------------------------------------------------------------------------
@@ -93,10 +133,21 @@ module flux_histogram #(
     always @(posedge clk) begin
         if (reset || clear) begin
             // Clear all bins
-            for (i = 0; i < BIN_COUNT; i = i + 1) begin
+            for (i = 0; i < 2*BIN_COUNT; i = i + 1) begin
                 histogram[i] <= {BIN_WIDTH{1'b0}};
             end
 
+            // Banks and frozen stats
+            active_bank    <= 1'b0;
+            swap_count     <= 16'd0;
+            frz_total      <= 32'd0;
+            frz_min        <= {INTERVAL_BITS{1'b1}};
+            frz_max        <= {INTERVAL_BITS{1'b0}};
+            frz_peak_bin   <= 8'd0;
+            frz_peak_count <= {BIN_WIDTH{1'b0}};
+            frz_mean       <= {INTERVAL_BITS{1'b0}};
+            frz_overflow   <= 32'd0;
+
             // Clear statistics
             total_count     <= 32'd0;
             interval_min    <= {INTERVAL_BITS{1'b1}};  // Max value
@@ -107,6 +158,37 @@ module flux_histogram #(
             underflow_count <= 32'd0;
             mean_interval   <= {INTERVAL_BITS{1'b0}};
 
+        end else if (do_swap) begin
+            // Freeze the live bank with its stats, count on in the other
+            frz_total      <= total_count;
+            frz_min        <= interval_min;
+            frz_max        <= interval_max;
+            frz_peak_bin   <= peak_bin;
+            frz_peak_count <= peak_count;
+            frz_mean       <= mean_interval;
+            frz_overflow   <= overflow_count;
+
+            active_bank <= ~active_bank;
+            swap_count  <= swap_count + 1;
+
+            for (i = 0; i < BIN_COUNT; i = i + 1) begin
+                histogram[{~active_bank, i[7:0]}] <= {BIN_WIDTH{1'b0}};
+            end
+
+            // A transition on the swap clock is the new bank's first sample
+            total_count     <= bin_valid ? 32'd1 : 32'd0;
+            interval_min    <= bin_valid ? flux_interval : {INTERVAL_BITS{1'b1}};
+            interval_max    <= bin_valid ? flux_interval : {INTERVAL_BITS{1'b0}};
+            peak_bin        <= bin_valid ? bin_index : 8'd0;
+            peak_count      <= bin_valid ? {{(BIN_WIDTH-1){1'b0}}, 1'b1} : {BIN_WIDTH{1'b0}};
+            overflow_count  <= (bin_valid && bin_overflow) ? 32'd1 : 32'd0;
+            underflow_count <= 32'd0;
+            if (bin_valid) begin
+                histogram[next_index] <= {{(BIN_WIDTH-1){1'b0}}, 1'b1};
+                // The running mean spans the swap: it tracks the drive, not the bank
+                mean_interval <= mean_interval - (mean_interval >> 4) + (flux_interval >> 4);
+            end
+
         end else if (bin_valid) begin
             // Update total count
             total_count <= total_count + 1;
@@ -125,13 +207,13 @@ module flux_histogram #(
             end
 
             // Increment histogram bin (saturating)
-            if (histogram[bin_index] != {BIN_WIDTH{1'b1}}) begin
-                histogram[bin_index] <= histogram[bin_index] + 1;
+            if (histogram[live_index] != {BIN_WIDTH{1'b1}}) begin
+                histogram[live_index] <= histogram[live_index] + 1;
 
                 // Update peak tracking
-                if (histogram[bin_index] + 1 > peak_count) begin
+                if (histogram[live_index] + 1 > peak_count) begin
                     peak_bin   <= bin_index;
-                    peak_count <= histogram[bin_index] + 1;
+                    peak_count <= histogram[live_index] + 1;
                 end
             end
 
@@ -145,7 +227,11 @@ module flux_histogram #(
     //-------------------------------------------------------------------------
     // Read Port
     //-------------------------------------------------------------------------
-    assign read_data = histogram[read_bin];
+    assign read_data = histogram[{read_bank, read_bin}];
+
+    wire [15:0] read_word_lo = histogram[{read_bank, read_word, 1'b0}];
+    wire [15:0] read_word_hi = histogram[{read_bank, read_word, 1'b1}];
+    assign read_word_data = {read_word_hi, read_word_lo};
 
     //-------------------------------------------------------------------------
     // Snapshot Logic
@@ -239,8 +325,14 @@ module flux_histogram_dual #(
         .enable(1'b1),
         .clear(clear_a),
         .snapshot(1'b0),
+        .banked(1'b0),
+        .swap_on_index(1'b0),
+        .index_pulse(1'b0),
+        .swap(1'b0),
         .read_bin(read_bin),
         .read_data(read_data_a),
+        .read_word(7'd0),
+        .read_word_data(),
         .total_count(total_a),
         .interval_min(),
         .interval_max(),
@@ -252,7 +344,16 @@ module flux_histogram_dual #(
         .snap_total(),
         .snap_peak_bin(),
         .snap_peak_count(),
-        .snap_mean()
+        .snap_mean(),
+        .active_bank(),
+        .swap_count(),
+        .frz_total(),
+        .frz_min(),
+        .frz_max(),
+        .frz_peak_bin(),
+        .frz_peak_count(),
+        .frz_mean(),
+        .frz_overflow()
     );
 
     // Histogram B
@@ -269,8 +370,14 @@ module flux_histogram_dual #(
         .enable(1'b1),
         .clear(clear_b),
         .snapshot(1'b0),
+        .banked(1'b0),
+        .swap_on_index(1'b0),
+        .index_pulse(1'b0),
+        .swap(1'b0),
         .read_bin(read_bin),
         .read_data(read_data_b),
+        .read_word(7'd0),
+        .read_word_data(),
         .total_count(total_b),
         .interval_min(),
         .interval_max(),
@@ -282,7 +389,16 @@ module flux_histogram_dual #(
         .snap_total(),
         .snap_peak_bin(),
         .snap_peak_count(),
-        .snap_mean()
+        .snap_mean(),
+        .active_bank(),
+        .swap_count(),
+        .frz_total(),
+        .frz_min(),
+        .frz_max(),
+        .frz_peak_bin(),
+        .frz_peak_count(),
+        .frz_mean(),
+        .frz_overflow()
     );
 
     // Peak bin comparison (within ±2 bins = rate match)
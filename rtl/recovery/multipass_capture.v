@@ -8,6 +8,12 @@
 //   - Track per-pass metadata (flux count, index timing, duration)
 //   - Trigger histogram updates during capture
 //
+// Windowed mode: with window_len non-zero each pass waits window_start
+// clocks after the index edge, captures for window_len clocks and stops,
+// so repeated reads of one damaged sector cost a sector's worth of time
+// and memory per pass instead of a revolution. pass_stride overrides
+// PASS_SIZE so short passes can be packed closely (0 = PASS_SIZE).
+//
 // Created: 2025-12-04 18:15
 //-----------------------------------------------------------------------------
 
@@ -28,6 +34,9 @@ module multipass_capture #(
     input  wire                    abort,           // Abort current capture
     input  wire [PASS_BITS-1:0]    pass_count,      // Number of passes to capture (1-64)
     input  wire [ADDR_WIDTH-1:0]   base_addr,       // Base address in memory
+    input  wire [31:0]             window_start,    // Clocks from index to window (windowed mode)
+    input  wire [31:0]             window_len,      // Window length in clocks (0 = full revolution)
+    input  wire [ADDR_WIDTH-1:0]   pass_stride,     // Memory per pass (0 = PASS_SIZE)
     output reg                     busy,            // Capture in progress
     output reg                     done,            // All passes complete
     output reg                     error,           // Error occurred
@@ -98,7 +107,8 @@ module multipass_capture #(
         ST_CAPTURE_DONE  = 4'd5,
         ST_NEXT_PASS     = 4'd6,
         ST_COMPLETE      = 4'd7,
-        ST_ERROR         = 4'd8;
+        ST_ERROR         = 4'd8,
+        ST_WINDOW_DELAY  = 4'd9;
 
     reg [3:0] state;
     reg [3:0] next_state;
@@ -127,6 +137,10 @@ module multipass_capture #(
     reg                 first_index_seen;     // Have we seen first index?
     reg                 second_index_seen;    // Have we seen second index (track complete)?
     reg [31:0]          global_timer;         // Global time counter
+    reg [31:0]          win_start;            // Latched window start (clocks after index)
+    reg [31:0]          win_len;              // Latched window length (0 = revolution)
+    reg [ADDR_WIDTH-1:0] stride;              // Latched memory per pass
+    reg [31:0]          window_counter;       // Time since index while delaying
 
     // Edge detection for index
     reg index_pulse_d;
@@ -139,7 +153,7 @@ module multipass_capture #(
     //-------------------------------------------------------------------------
     // Memory Address Calculation
     //-------------------------------------------------------------------------
-    assign mem_end_addr = mem_base_addr + PASS_SIZE - 1;
+    assign mem_end_addr = mem_base_addr + stride - 1;
 
     //-------------------------------------------------------------------------
     // Global Timer
@@ -184,6 +198,15 @@ module multipass_capture #(
                 if (abort) begin
                     next_state = ST_ERROR;
                 end else if (index_edge) begin
+                    next_state = (win_len != 0 && win_start != 0) ?
+                                 ST_WINDOW_DELAY : ST_CAPTURE_START;
+                end
+            end
+
+            ST_WINDOW_DELAY: begin
+                if (abort) begin
+                    next_state = ST_ERROR;
+                end else if (window_counter >= win_start - 1) begin
                     next_state = ST_CAPTURE_START;
                 end
             end
@@ -199,6 +222,8 @@ module multipass_capture #(
                     next_state = ST_ERROR;
                 end else if (second_index_seen) begin
                     next_state = ST_CAPTURE_DONE;
+                end else if (win_len != 0 && index_counter >= win_len - 1) begin
+                    next_state = ST_CAPTURE_DONE;
                 end
             end
 
@@ -252,6 +277,10 @@ module multipass_capture #(
             first_index_seen <= 1'b0;
             second_index_seen<= 1'b0;
             capture_start_time <= 32'd0;
+            win_start        <= 32'd0;
+            win_len          <= 32'd0;
+            stride           <= PASS_SIZE;
+            window_counter   <= 32'd0;
             total_flux_count <= 32'd0;
             min_flux_count   <= 32'hFFFFFFFF;
             max_flux_count   <= 32'd0;
@@ -301,6 +330,9 @@ module multipass_capture #(
                     current_pass     <= {PASS_BITS{1'b0}};
                     target_passes    <= pass_count;
                     mem_base_addr    <= base_addr;
+                    win_start        <= window_start;
+                    win_len          <= window_len;
+                    stride           <= (pass_stride != 0) ? pass_stride : PASS_SIZE;
                     total_flux_count <= 32'd0;
                     min_flux_count   <= 32'hFFFFFFFF;
                     max_flux_count   <= 32'd0;
@@ -322,11 +354,17 @@ module multipass_capture #(
                     second_index_seen<= 1'b0;
                     flux_counter     <= 32'd0;
                     index_counter    <= 32'd0;
+                    window_counter   <= 32'd0;
 
                     // Clear histogram for new pass (optional - keep for comparison)
                     // hist_clear <= 1'b1;
                 end
 
+                ST_WINDOW_DELAY: begin
+                    // Index edge seen: hold off until the window opens
+                    window_counter <= window_counter + 1;
+                end
+
                 ST_CAPTURE_START: begin
                     wait_for_index     <= 1'b0;
                     capture_start      <= 1'b1;
@@ -340,7 +378,7 @@ module multipass_capture #(
                 end
 
                 ST_CAPTURING: begin
-                    // Continue capture until second index
+                    // Continue capture until second index or window end
                 end
 
                 ST_CAPTURE_DONE: begin
@@ -369,7 +407,7 @@ module multipass_capture #(
 
                 ST_NEXT_PASS: begin
                     current_pass  <= current_pass + 1;
-                    mem_base_addr <= mem_base_addr + PASS_SIZE;
+                    mem_base_addr <= mem_base_addr + stride;
                 end
 
                 ST_COMPLETE: begin
@@ -403,6 +441,7 @@ module multipass_capture #(
             ST_NEXT_PASS:     state_name = "NEXT_PASS";
             ST_COMPLETE:      state_name = "COMPLETE";
             ST_ERROR:         state_name = "ERROR";
+            ST_WINDOW_DELAY:  state_name = "WINDOW_DELAY";
             default:          state_name = "UNKNOWN";
         endcase
     end
@@ -426,7 +465,7 @@ module multipass_capture_regs #(
     //-------------------------------------------------------------------------
     // Register Interface (directly from AXI-Lite decoder)
     //-------------------------------------------------------------------------
-    input  wire [7:0]  reg_addr,
+    input  wire [10:0] reg_addr,         // Offset in the interface's FluxStat block
     input  wire        reg_write,
     input  wire        reg_read,
     input  wire [31:0] reg_wdata,
@@ -440,6 +479,9 @@ module multipass_capture_regs #(
     output reg         mp_abort,
     output reg  [PASS_BITS-1:0] mp_pass_count,
     output reg  [ADDR_WIDTH-1:0] mp_base_addr,
+    output reg  [31:0] mp_window_start,
+    output reg  [31:0] mp_window_len,
+    output reg  [ADDR_WIDTH-1:0] mp_pass_stride,
     input  wire        mp_busy,
     input  wire        mp_done,
     input  wire        mp_error,
@@ -458,7 +500,9 @@ module multipass_capture_regs #(
 
     assign reg_ready = 1'b1;  // Single-cycle access
 
-    // Register map:
+    // Register map (offsets from the interface's FluxStat block base,
+    // FLUXSTAT_IF_BASE() in fluxstat_hal.h; the window registers follow
+    // the histogram and bank registers decoded elsewhere in the block):
     // 0x00: Control (W: [0]=start, [1]=abort, [7:2]=pass_count)
     // 0x04: Status (R: [0]=busy, [1]=done, [2]=error, [13:8]=current_pass, [21:16]=completed)
     // 0x08: Base Address (RW)
@@ -469,6 +513,9 @@ module multipass_capture_regs #(
     // 0x1C: Metadata Pass Select (RW) - Select which pass to read
     // 0x20: Selected Pass Flux Count (R)
     // 0x24: Selected Pass Index Time (R)
+    // 0x170: Window Start, clocks after index (RW)
+    // 0x174: Window Length, clocks (RW) - 0 = full revolution
+    // 0x178: Pass Stride, bytes (RW) - 0 = PASS_SIZE
 
     always @(posedge clk) begin
         if (reset) begin
@@ -477,6 +524,9 @@ module multipass_capture_regs #(
             mp_pass_count   <= 6'd8;  // Default 8 passes
             mp_base_addr    <= {ADDR_WIDTH{1'b0}};
             mp_metadata_sel <= {PASS_BITS{1'b0}};
+            mp_window_start <= 32'd0;
+            mp_window_len   <= 32'd0;
+            mp_pass_stride  <= {ADDR_WIDTH{1'b0}};
             reg_rdata       <= 32'd0;
         end else begin
             // Auto-clear pulses
@@ -485,29 +535,35 @@ module multipass_capture_regs #(
 
             if (reg_write) begin
                 case (reg_addr)
-                    8'h00: begin
+                    11'h000: begin
                         mp_start      <= reg_wdata[0];
                         mp_abort      <= reg_wdata[1];
                         mp_pass_count <= reg_wdata[7:2];
                     end
-                    8'h08: mp_base_addr <= reg_wdata[ADDR_WIDTH-1:0];
-                    8'h1C: mp_metadata_sel <= reg_wdata[PASS_BITS-1:0];
+                    11'h008: mp_base_addr <= reg_wdata[ADDR_WIDTH-1:0];
+                    11'h01C: mp_metadata_sel <= reg_wdata[PASS_BITS-1:0];
+                    11'h170: mp_window_start <= reg_wdata;
+                    11'h174: mp_window_len   <= reg_wdata;
+                    11'h178: mp_pass_stride  <= reg_wdata[ADDR_WIDTH-1:0];
                 endcase
             end
 
             if (reg_read) begin
                 case (reg_addr)
-                    8'h00: reg_rdata <= {24'd0, mp_pass_count, 2'b00};
-                    8'h04: reg_rdata <= {10'd0, mp_passes_completed, mp_current_pass, 5'd0,
-                                         mp_error, mp_done, mp_busy};
-                    8'h08: reg_rdata <= {{(32-ADDR_WIDTH){1'b0}}, mp_base_addr};
-                    8'h0C: reg_rdata <= mp_total_flux;
-                    8'h10: reg_rdata <= mp_min_flux;
-                    8'h14: reg_rdata <= mp_max_flux;
-                    8'h18: reg_rdata <= mp_total_time;
-                    8'h1C: reg_rdata <= {{(32-PASS_BITS){1'b0}}, mp_metadata_sel};
-                    8'h20: reg_rdata <= mp_metadata_flux;
-                    8'h24: reg_rdata <= mp_metadata_index_time;
+                    11'h000: reg_rdata <= {24'd0, mp_pass_count, 2'b00};
+                    11'h004: reg_rdata <= {10'd0, mp_passes_completed, mp_current_pass, 5'd0,
+                                           mp_error, mp_done, mp_busy};
+                    11'h008: reg_rdata <= {{(32-ADDR_WIDTH){1'b0}}, mp_base_addr};
+                    11'h00C: reg_rdata <= mp_total_flux;
+                    11'h010: reg_rdata <= mp_min_flux;
+                    11'h014: reg_rdata <= mp_max_flux;
+                    11'h018: reg_rdata <= mp_total_time;
+                    11'h01C: reg_rdata <= {{(32-PASS_BITS){1'b0}}, mp_metadata_sel};
+                    11'h020: reg_rdata <= mp_metadata_flux;
+                    11'h024: reg_rdata <= mp_metadata_index_time;
+                    11'h170: reg_rdata <= mp_window_start;
+                    11'h174: reg_rdata <= mp_window_len;
+                    11'h178: reg_rdata <= {{(32-ADDR_WIDTH){1'b0}}, mp_pass_stride};
                     default: reg_rdata <= 32'd0;
                 endcase
             end
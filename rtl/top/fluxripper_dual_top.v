@@ -313,6 +313,49 @@ module fluxripper_dual_top (
     wire        fdc_b_track_density_detected;
     wire        fdc_b_detected_40_track;
 
+    //-------------------------------------------------------------------------
+    // QIC-117 Tape Signals (Interface A)
+    //-------------------------------------------------------------------------
+    wire        tape_mode_en_a;
+    wire [2:0]  tape_select_a;
+    wire [7:0]  tape_status_a;
+    wire [15:0] tape_segment_a;
+    wire [4:0]  tape_track_a;
+    wire [5:0]  tape_last_command_a;
+    wire        tape_command_active_a;
+    wire        tape_ready_a;
+    wire        tape_error_a;
+    wire        tape_streaming_a;
+
+    wire [7:0]  tape_data_byte_a;
+    wire        tape_data_valid_a;
+    wire        tape_data_is_header_a;
+    wire        tape_data_is_ecc_a;
+    wire        tape_block_start_a;
+    wire        tape_block_complete_a;
+    wire        tape_sync_lost_a;
+    wire [4:0]  tape_block_in_segment_a;
+
+    wire        tape_seg_enable;
+    wire        tape_seg_clear;
+    wire        tape_seg_active;
+    wire [15:0] tape_seg_blocks;
+    wire [15:0] tape_seg_segments;
+    wire [15:0] tape_seg_ecc_errors;
+    wire [15:0] tape_seg_gaps;
+
+    // Interface A stream sources, muxed onto m_axis_a by tape mode
+    wire [31:0] flux_axis_a_tdata;
+    wire        flux_axis_a_tvalid;
+    wire        flux_axis_a_tready;
+    wire        flux_axis_a_tlast;
+    wire [3:0]  flux_axis_a_tkeep;
+    wire [31:0] tape_axis_tdata;
+    wire        tape_axis_tvalid;
+    wire        tape_axis_tready;
+    wire        tape_axis_tlast;
+    wire [3:0]  tape_axis_tkeep;
+
     //-------------------------------------------------------------------------
     // Flux Analyzer Signals
     //-------------------------------------------------------------------------
@@ -474,7 +517,31 @@ module fluxripper_dual_top (
 
         // Track density auto-detection status
         .track_density_detected(fdc_a_track_density_detected),
-        .detected_40_track(fdc_a_detected_40_track)
+        .detected_40_track(fdc_a_detected_40_track),
+
+        // QIC-117 tape mode (TDR)
+        .tape_mode_en(tape_mode_en_a),
+        .tape_select(tape_select_a),
+        .tape_cartridge_in(1'b1),                // No sensor lines on the Shugart bus
+        .tape_write_protect(if_a_drv0_wp),
+        .tape_status(tape_status_a),
+        .tape_segment(tape_segment_a),
+        .tape_track(tape_track_a),
+        .tape_last_command(tape_last_command_a),
+        .tape_command_active(tape_command_active_a),
+        .tape_ready(tape_ready_a),
+        .tape_error(tape_error_a),
+        .tape_streaming(tape_streaming_a),
+
+        // QIC-117 block data
+        .tape_data_byte(tape_data_byte_a),
+        .tape_data_valid(tape_data_valid_a),
+        .tape_data_is_header(tape_data_is_header_a),
+        .tape_data_is_ecc(tape_data_is_ecc_a),
+        .tape_block_start(tape_block_start_a),
+        .tape_block_complete(tape_block_complete_a),
+        .tape_sync_lost(tape_sync_lost_a),
+        .tape_block_in_segment(tape_block_in_segment_a)
     );
 
     //-------------------------------------------------------------------------
@@ -966,7 +1033,28 @@ module fluxripper_dual_top (
         .drive_profile_locked_a(drive_profile_locked_a),
         .drive_profile_b(drive_profile_b),
         .drive_profile_valid_b(drive_profile_valid_b),
-        .drive_profile_locked_b(drive_profile_locked_b)
+        .drive_profile_locked_b(drive_profile_locked_b),
+
+        // QIC-117 tape (Interface A)
+        .tape_mode_en(tape_mode_en_a),
+        .tape_select(tape_select_a),
+        .tape_status(tape_status_a),
+        .tape_segment(tape_segment_a),
+        .tape_track(tape_track_a),
+        .tape_last_command(tape_last_command_a),
+        .tape_command_active(tape_command_active_a),
+        .tape_ready(tape_ready_a),
+        .tape_error(tape_error_a),
+        .tape_streaming(tape_streaming_a),
+
+        // QIC-117 segment capture
+        .tape_seg_enable(tape_seg_enable),
+        .tape_seg_clear(tape_seg_clear),
+        .tape_seg_active(tape_seg_active),
+        .tape_seg_blocks(tape_seg_blocks),
+        .tape_seg_segments(tape_seg_segments),
+        .tape_seg_ecc_errors(tape_seg_ecc_errors),
+        .tape_seg_gaps(tape_seg_gaps)
     );
 
     //-------------------------------------------------------------------------
@@ -1063,11 +1151,11 @@ module fluxripper_dual_top (
         .soft_reset(sw_reset),
 
         // AXI-Stream output
-        .m_axis_tdata(m_axis_a_tdata),
-        .m_axis_tvalid(m_axis_a_tvalid),
-        .m_axis_tready(m_axis_a_tready),
-        .m_axis_tlast(m_axis_a_tlast),
-        .m_axis_tkeep(m_axis_a_tkeep),
+        .m_axis_tdata(flux_axis_a_tdata),
+        .m_axis_tvalid(flux_axis_a_tvalid),
+        .m_axis_tready(flux_axis_a_tready),
+        .m_axis_tlast(flux_axis_a_tlast),
+        .m_axis_tkeep(flux_axis_a_tkeep),
 
         // Status
         .capture_count(),
@@ -1076,6 +1164,53 @@ module fluxripper_dual_top (
         .fifo_level()
     );
 
+    //-------------------------------------------------------------------------
+    // AXI-Stream Tape Segment Capture (Interface A)
+    //-------------------------------------------------------------------------
+    axi_stream_tape u_tape_stream_a (
+        .clk_sys(clk),
+        .aclk(s_axi_aclk),
+        .aresetn(s_axi_aresetn & ~sw_reset),
+
+        // Data streamer
+        .tape_byte(tape_data_byte_a),
+        .tape_byte_valid(tape_data_valid_a),
+        .tape_is_header(tape_data_is_header_a),
+        .tape_is_ecc(tape_data_is_ecc_a),
+        .tape_block_start(tape_block_start_a),
+        .tape_block_done(tape_block_complete_a),
+        .tape_sync_lost(tape_sync_lost_a),
+        .tape_block_num(tape_block_in_segment_a),
+        .tape_segment(tape_segment_a),
+        .tape_streaming(tape_streaming_a),
+
+        // Control
+        .capture_enable(tape_seg_enable),
+        .clear(tape_seg_clear),
+
+        // AXI-Stream output
+        .m_axis_tdata(tape_axis_tdata),
+        .m_axis_tvalid(tape_axis_tvalid),
+        .m_axis_tready(tape_axis_tready),
+        .m_axis_tlast(tape_axis_tlast),
+        .m_axis_tkeep(tape_axis_tkeep),
+
+        // Status
+        .blocks_sent(tape_seg_blocks),
+        .ecc_errors(tape_seg_ecc_errors),
+        .segments_sent(tape_seg_segments),
+        .gaps(tape_seg_gaps),
+        .active(tape_seg_active)
+    );
+
+    // DMA channel 0 carries tape segments while Interface A is in tape mode
+    assign m_axis_a_tdata     = tape_mode_en_a ? tape_axis_tdata  : flux_axis_a_tdata;
+    assign m_axis_a_tvalid    = tape_mode_en_a ? tape_axis_tvalid : flux_axis_a_tvalid;
+    assign m_axis_a_tlast     = tape_mode_en_a ? tape_axis_tlast  : flux_axis_a_tlast;
+    assign m_axis_a_tkeep     = tape_mode_en_a ? tape_axis_tkeep  : flux_axis_a_tkeep;
+    assign tape_axis_tready   = tape_mode_en_a && m_axis_a_tready;
+    assign flux_axis_a_tready = !tape_mode_en_a && m_axis_a_tready;
+
     //-------------------------------------------------------------------------
     // AXI-Stream Flux Capture B
     //-------------------------------------------------------------------------
@@ -4,6 +4,7 @@
 //
 // Created: 2025-12-05 21:50
 // Updated: 2025-12-06 00:17 - Added media change interrupt support
+// Updated: 2025-12-10 13:00 - Ready transitions latch a change too
 //
 // Provides AXI-Lite accessible registers for USB Mass Storage configuration.
 // Firmware writes drive geometry after profile detection; RTL reads for
@@ -99,6 +100,7 @@ module msc_config_regs (
     // Media changed latches (set by hardware, cleared by firmware write)
     reg [3:0]  media_changed_latch;
     reg [3:0]  media_changed_prev;
+    reg [3:0]  drive_present_prev;
 
     // Interrupt control
     reg [3:0]  int_enable;          // Per-drive interrupt enable
@@ -130,6 +132,7 @@ module msc_config_regs (
 
             media_changed_latch <= 4'b0;
             media_changed_prev  <= 4'b0;
+            drive_present_prev  <= 4'b0;
 
             int_enable          <= 4'b0;
             global_int_enable   <= 1'b0;
@@ -241,10 +244,15 @@ module msc_config_regs (
                 s_axi_awready <= 1'b1;
             end
 
-            // Media change detection (edge detect)
+            // Media change detection (edge detect): a disk change going
+            // active, or the drive becoming ready or not ready
             media_changed_prev <= media_changed_in;
-            if (media_changed_in & ~media_changed_prev) begin
-                media_changed_latch <= media_changed_latch | (media_changed_in & ~media_changed_prev);
+            drive_present_prev <= drive_present;
+            if ((media_changed_in & ~media_changed_prev) |
+                (drive_present ^ drive_present_prev)) begin
+                media_changed_latch <= media_changed_latch |
+                                       (media_changed_in & ~media_changed_prev) |
+                                       (drive_present ^ drive_present_prev);
             end
         end
     end
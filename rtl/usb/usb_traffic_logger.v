@@ -15,8 +15,15 @@
  * Transaction Record Format (variable length, 4-32 bytes):
  *   [0]     : Header byte (type[3:0], dir[1], ep[3:0] >> 1, flags[2:0])
  *   [1-4]   : Timestamp (32-bit, relative to capture start)
- *   [5]     : Length (0-64 for data, 0 for tokens/handshakes)
- *   [6-69]  : Payload (for DATA packets only)
+ *   [5]     : Length of the payload that follows (bytes after the PID)
+ *   [6-71]  : Payload (token address/CRC5, data + CRC16; none for handshakes)
+ *
+ * Compound trigger:
+ *   A sequence of 1-4 PIDs on consecutive packets (SOF optionally skipped),
+ *   an optional masked payload byte match on the last packet, and a hit
+ *   count with an optional maximum gap between hits. While armed, records
+ *   are written but only the newest pre_depth are kept; after the trigger,
+ *   post_depth records are captured and then writing stops.
  *
  * Created: 2025-12-07 12:15
  * License: BSD-3-Clause
@@ -24,6 +31,7 @@
 
 module usb_traffic_logger #(
     parameter BUFFER_DEPTH_LOG2 = 13,   // 8KB buffer (2^13 bytes)
+    parameter PRE_DEPTH_LOG2    = 6,    // Pre-trigger window, up to 63 records
     parameter CLK_FREQ_HZ       = 60000000  // 60 MHz ULPI clock
 )(
     input  wire        clk,              // ULPI clock (60 MHz)
@@ -62,7 +70,8 @@ module usb_traffic_logger #(
     // Register Map
     // =========================================================================
     localparam REG_CONTROL      = 8'h00;  // [0]=enable, [1]=clear, [2]=wrap_mode
-    localparam REG_STATUS       = 8'h04;  // [0]=active, [1]=overflow, [2]=wrapped
+    localparam REG_STATUS       = 8'h04;  // [0]=active, [1]=overflow, [2]=wrapped,
+                                          // [3]=armed, [4]=post-trigger done
     localparam REG_FILTER       = 8'h08;  // [3:0]=ep_mask, [4]=dir_filter, [7:5]=type_mask
     localparam REG_WRITE_PTR    = 8'h0C;  // Current write pointer
     localparam REG_READ_PTR     = 8'h10;  // Current read pointer
@@ -72,6 +81,14 @@ module usb_traffic_logger #(
     localparam REG_BUFFER_DATA  = 8'h20;  // Read buffer data (auto-increment)
     localparam REG_BUFFER_SIZE  = 8'h24;  // Buffer size in bytes
     localparam REG_TRIGGER      = 8'h28;  // [7:0]=trigger_pid, [8]=trigger_enable
+    localparam REG_BUFFER_WORD  = 8'h2C;  // Read 4 buffer bytes, LE (auto-increment by 4)
+    localparam REG_DROP_COUNT   = 8'h30;  // Records dropped for lack of space
+    localparam REG_TRIG_SEQ     = 8'h34;  // [11:0]=PIDs 1-3, [13:12]=extra stages,
+                                          // [14]=skip SOF, [15]=payload match
+    localparam REG_TRIG_MATCH   = 8'h38;  // [7:0]=value, [15:8]=mask, [22:16]=offset
+    localparam REG_TRIG_COUNT   = 8'h3C;  // [15:0]=hits, [31:16]=max gap (64 clk units)
+    localparam REG_TRIG_DEPTH   = 8'h40;  // [7:0]=pre records, [31:16]=post records
+    localparam REG_TRIG_TIME    = 8'h44;  // Trigger timestamp (relative, read-only)
 
     // =========================================================================
     // Packet Type Definitions (USB PIDs)
@@ -112,6 +129,19 @@ module usb_traffic_logger #(
     reg [7:0]  trigger_pid;
     reg        trigger_enable;
     reg        triggered;
+    reg [11:0] trig_seq_pids;      // Stage 1-3 PIDs (stage 0 = trigger_pid)
+    reg [1:0]  trig_seq_extra;     // Stages after the first
+    reg        trig_skip_sof;
+    reg        trig_match_en;
+    reg [7:0]  trig_match_value;
+    reg [7:0]  trig_match_mask;
+    reg [6:0]  trig_match_offset;
+    reg [15:0] trig_hits;          // Hits needed (0 = 1)
+    reg [15:0] trig_gap;           // Max gap between hits, 0 = no limit
+    reg [7:0]  pre_depth;
+    reg [15:0] post_depth;         // 0 = until stopped
+    reg [31:0] trigger_time;
+    reg        post_done;          // Post-trigger window captured
 
     // =========================================================================
     // Buffer Memory (Dual-Port BRAM)
@@ -125,6 +155,7 @@ module usb_traffic_logger #(
     reg                         overflow_flag;
     reg                         wrapped_flag;
     reg [31:0]                  trans_count;
+    reg [31:0]                  drop_count;
 
     // =========================================================================
     // Timestamp Counter (free-running)
@@ -327,20 +358,74 @@ module usb_traffic_logger #(
     // =========================================================================
     // Trigger Logic
     // =========================================================================
+    // Packet seen by the trigger (RX wins if both complete together)
+    wire       pkt_valid = rx_packet_valid || tx_packet_valid;
+    wire [3:0] pkt_pid   = rx_packet_valid ? rx_pid[3:0] : tx_pid[3:0];
+    wire [6:0] pkt_len   = rx_packet_valid ? rx_byte_count : tx_byte_count;
+    wire [7:0] pkt_byte  = rx_packet_valid ? rx_buffer[trig_match_offset] :
+                                             tx_buffer[trig_match_offset];
+
+    reg [1:0]  trig_stage;
+    reg [15:0] trig_hit_count;
+    reg [31:0] trig_last_hit;
+    reg        capture_started;
+
+    wire [3:0] stage_pid = (trig_stage == 2'd0) ? trigger_pid[3:0] :
+                           (trig_stage == 2'd1) ? trig_seq_pids[3:0] :
+                           (trig_stage == 2'd2) ? trig_seq_pids[7:4] :
+                                                  trig_seq_pids[11:8];
+    wire       last_stage = (trig_stage == trig_seq_extra);
+    wire       payload_ok = !trig_match_en || !last_stage ||
+                            ((pkt_len > trig_match_offset) &&
+                             (((pkt_byte ^ trig_match_value) & trig_match_mask) == 8'd0));
+    wire       stage_hit  = (pkt_pid == stage_pid) && payload_ok;
+    wire       pkt_skip   = trig_skip_sof && (pkt_pid == PID_SOF);
+
+    // Hit counting: a gap longer than trig_gap restarts the count
+    wire        gap_expired = (trig_gap != 16'd0) && (trig_hit_count != 16'd0) &&
+                              ((timestamp[31:0] - trig_last_hit) > {10'd0, trig_gap, 6'd0});
+    wire [15:0] next_hits   = gap_expired ? 16'd1 : trig_hit_count + 1'b1;
+    wire [15:0] hits_needed = (trig_hits == 16'd0) ? 16'd1 : trig_hits;
+
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             triggered <= 1'b0;
+            trig_stage <= 2'd0;
+            trig_hit_count <= 16'd0;
+            trig_last_hit <= 32'd0;
+            trigger_time <= 32'd0;
+            capture_started <= 1'b0;
         end else if (!ctrl_enable) begin
             triggered <= 1'b0;
-        end else if (trigger_enable && !triggered) begin
-            if ((rx_packet_valid && rx_pid == trigger_pid) ||
-                (tx_packet_valid && tx_pid == trigger_pid)) begin
-                triggered <= 1'b1;
+            trig_stage <= 2'd0;
+            trig_hit_count <= 16'd0;
+            capture_started <= 1'b0;
+        end else begin
+            // Timestamps are relative to arming, so pre-trigger records line up
+            if (!capture_started) begin
+                capture_started <= 1'b1;
                 capture_start_time <= timestamp[31:0];
             end
-        end else if (!trigger_enable) begin
-            triggered <= 1'b1;  // No trigger = always armed
-            if (!triggered) capture_start_time <= timestamp[31:0];
+
+            if (!trigger_enable) begin
+                triggered <= 1'b1;  // No trigger = always armed
+            end else if (!triggered && pkt_valid && !pkt_skip) begin
+                if (stage_hit && last_stage) begin
+                    trig_stage <= 2'd0;
+                    trig_hit_count <= next_hits;
+                    trig_last_hit <= timestamp[31:0];
+                    if (next_hits >= hits_needed) begin
+                        triggered <= 1'b1;
+                        trigger_time <= timestamp[31:0] - capture_start_time;
+                    end
+                end else if (stage_hit) begin
+                    trig_stage <= trig_stage + 1'b1;
+                end else begin
+                    // Broken sequence: this packet may still start a new one
+                    trig_stage <= (trig_seq_extra != 2'd0 &&
+                                   pkt_pid == trigger_pid[3:0]) ? 2'd1 : 2'd0;
+                end
+            end
         end
     end
 
@@ -353,6 +438,22 @@ module usb_traffic_logger #(
     reg [6:0]  wr_record_len;
     reg        wr_pending;
 
+    // Pre-trigger window: end pointers of the records held while armed.
+    // Once more than pre_depth are held, the oldest is released by moving
+    // read_ptr past it (pre_discard, applied in the register block).
+    localparam PRE_MAX = (1 << PRE_DEPTH_LOG2) - 1;
+
+    reg [BUFFER_DEPTH_LOG2-1:0] pre_end [0:PRE_MAX];
+    reg [PRE_DEPTH_LOG2:0]      pre_wr;
+    reg [PRE_DEPTH_LOG2:0]      pre_rd;
+    reg                         pre_discard;
+    reg [BUFFER_DEPTH_LOG2-1:0] pre_discard_ptr;
+    reg [15:0]                  post_count;
+
+    wire [PRE_DEPTH_LOG2:0] pre_held = pre_wr - pre_rd;
+    wire [7:0] pre_limit = (pre_depth > PRE_MAX) ? PRE_MAX : pre_depth;
+    wire       armed     = trigger_enable && !triggered;
+
     localparam WR_IDLE   = 4'd0;
     localparam WR_HEADER = 4'd1;
     localparam WR_TS0    = 4'd2;
@@ -380,6 +481,11 @@ module usb_traffic_logger #(
     wire [BUFFER_DEPTH_LOG2:0] bytes_used = write_ptr - read_ptr;
     wire [BUFFER_DEPTH_LOG2:0] bytes_free = BUFFER_SIZE - bytes_used;
 
+    // Word read taps (wrap with the ring)
+    wire [BUFFER_DEPTH_LOG2-1:0] read_ptr_1 = read_ptr + 1'd1;
+    wire [BUFFER_DEPTH_LOG2-1:0] read_ptr_2 = read_ptr + 2'd2;
+    wire [BUFFER_DEPTH_LOG2-1:0] read_ptr_3 = read_ptr + 2'd3;
+
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             wr_state <= WR_IDLE;
@@ -387,15 +493,30 @@ module usb_traffic_logger #(
             overflow_flag <= 1'b0;
             wrapped_flag <= 1'b0;
             trans_count <= 32'd0;
+            drop_count <= 32'd0;
             wr_pending <= 1'b0;
+            pre_wr <= {(PRE_DEPTH_LOG2+1){1'b0}};
+            pre_rd <= {(PRE_DEPTH_LOG2+1){1'b0}};
+            pre_discard <= 1'b0;
+            pre_discard_ptr <= {BUFFER_DEPTH_LOG2{1'b0}};
+            post_count <= 16'd0;
+            post_done <= 1'b0;
         end else if (!ctrl_enable) begin
             // Capture disabled - can clear on rising edge
             wr_state <= WR_IDLE;
             wr_pending <= 1'b0;
+            pre_wr <= {(PRE_DEPTH_LOG2+1){1'b0}};
+            pre_rd <= {(PRE_DEPTH_LOG2+1){1'b0}};
+            pre_discard <= 1'b0;
+            post_count <= 16'd0;
+            post_done <= 1'b0;
         end else begin
+            pre_discard <= 1'b0;
+
             case (wr_state)
                 WR_IDLE: begin
-                    if (ctrl_enable && triggered) begin
+                    // Armed records fill the pre-trigger window
+                    if ((triggered || armed) && !post_done) begin
                         if (rx_packet_valid && rx_pass_filter) begin
                             // Start RX record
                             wr_record[0] <= rx_header;
@@ -405,12 +526,8 @@ module usb_traffic_logger #(
                             wr_record[4] <= rel_timestamp_rx[31:24];
                             wr_record[5] <= rx_byte_count;  // Payload length
 
-                            // Copy payload for data packets
-                            if (is_data_pid && rx_byte_count > 0) begin
-                                wr_record_len <= 7'd6 + rx_byte_count;
-                            end else begin
-                                wr_record_len <= 7'd6;  // Header only
-                            end
+                            // Payload always follows, so [5] frames the record
+                            wr_record_len <= 7'd6 + rx_byte_count;
 
                             wr_byte_idx <= 7'd0;
                             wr_state <= WR_HEADER;
@@ -433,9 +550,12 @@ module usb_traffic_logger #(
                 end
 
                 WR_HEADER, WR_TS0, WR_TS1, WR_TS2, WR_TS3, WR_LEN, WR_DATA: begin
-                    // Check for buffer space
-                    if (bytes_free < wr_record_len && !ctrl_wrap_mode) begin
+                    // Check for space once per record, so a record is
+                    // either stored whole or dropped whole
+                    if (wr_byte_idx == 7'd0 && bytes_free < wr_record_len &&
+                        !ctrl_wrap_mode) begin
                         overflow_flag <= 1'b1;
+                        drop_count <= drop_count + 1'b1;
                         wr_state <= WR_IDLE;
                         wr_pending <= 1'b0;
                     end else begin
@@ -468,6 +588,23 @@ module usb_traffic_logger #(
                     trans_count <= trans_count + 1'b1;
                     wr_pending <= 1'b0;
                     wr_state <= WR_IDLE;
+
+                    if (!triggered) begin
+                        // write_ptr now points past this record
+                        pre_end[pre_wr[PRE_DEPTH_LOG2-1:0]] <= write_ptr;
+                        pre_wr <= pre_wr + 1'b1;
+                        if (pre_held >= pre_limit) begin
+                            pre_discard <= 1'b1;
+                            pre_discard_ptr <= (pre_held == 0) ? write_ptr :
+                                               pre_end[pre_rd[PRE_DEPTH_LOG2-1:0]];
+                            pre_rd <= pre_rd + 1'b1;
+                        end
+                    end else if (post_depth != 16'd0) begin
+                        post_count <= post_count + 1'b1;
+                        if (post_count + 1'b1 >= post_depth) begin
+                            post_done <= 1'b1;
+                        end
+                    end
                 end
 
                 default: wr_state <= WR_IDLE;
@@ -490,6 +627,17 @@ module usb_traffic_logger #(
             filter_type_mask <= 3'b111;
             trigger_pid <= 8'd0;
             trigger_enable <= 1'b0;
+            trig_seq_pids <= 12'd0;
+            trig_seq_extra <= 2'd0;
+            trig_skip_sof <= 1'b0;
+            trig_match_en <= 1'b0;
+            trig_match_value <= 8'd0;
+            trig_match_mask <= 8'd0;
+            trig_match_offset <= 7'd0;
+            trig_hits <= 16'd0;
+            trig_gap <= 16'd0;
+            pre_depth <= 8'd0;
+            post_depth <= 16'd0;
             read_ptr <= {BUFFER_DEPTH_LOG2{1'b0}};
             reg_rdata <= 32'd0;
             reg_rvalid <= 1'b0;
@@ -504,9 +652,15 @@ module usb_traffic_logger #(
                 overflow_flag <= 1'b0;
                 wrapped_flag <= 1'b0;
                 trans_count <= 32'd0;
+                drop_count <= 32'd0;
                 clear_pending <= 1'b0;
             end
 
+            // Drop the oldest pre-trigger record (firmware does not read while armed)
+            if (pre_discard) begin
+                read_ptr <= pre_discard_ptr;
+            end
+
             // Register writes
             if (reg_we) begin
                 case (reg_addr)
@@ -531,6 +685,29 @@ module usb_traffic_logger #(
                         trigger_pid <= reg_wdata[7:0];
                         trigger_enable <= reg_wdata[8];
                     end
+
+                    REG_TRIG_SEQ: begin
+                        trig_seq_pids <= reg_wdata[11:0];
+                        trig_seq_extra <= reg_wdata[13:12];
+                        trig_skip_sof <= reg_wdata[14];
+                        trig_match_en <= reg_wdata[15];
+                    end
+
+                    REG_TRIG_MATCH: begin
+                        trig_match_value <= reg_wdata[7:0];
+                        trig_match_mask <= reg_wdata[15:8];
+                        trig_match_offset <= reg_wdata[22:16];
+                    end
+
+                    REG_TRIG_COUNT: begin
+                        trig_hits <= reg_wdata[15:0];
+                        trig_gap <= reg_wdata[31:16];
+                    end
+
+                    REG_TRIG_DEPTH: begin
+                        pre_depth <= reg_wdata[7:0];
+                        post_depth <= reg_wdata[31:16];
+                    end
                 endcase
             end
 
@@ -539,7 +716,8 @@ module usb_traffic_logger #(
                 reg_rvalid <= 1'b1;
                 case (reg_addr)
                     REG_CONTROL:      reg_rdata <= {29'd0, ctrl_wrap_mode, 1'b0, ctrl_enable};
-                    REG_STATUS:       reg_rdata <= {29'd0, wrapped_flag, overflow_flag,
+                    REG_STATUS:       reg_rdata <= {27'd0, post_done, ctrl_enable && armed,
+                                                    wrapped_flag, overflow_flag,
                                                     ctrl_enable && triggered};
                     REG_FILTER:       reg_rdata <= {23'd0, filter_type_mask, filter_dir_val,
                                                     filter_dir, filter_ep_mask};
@@ -552,8 +730,21 @@ module usb_traffic_logger #(
                         reg_rdata <= {24'd0, buffer_mem[read_ptr]};
                         read_ptr <= read_ptr + 1'b1;  // Auto-increment
                     end
+                    REG_BUFFER_WORD: begin
+                        reg_rdata <= {buffer_mem[read_ptr_3], buffer_mem[read_ptr_2],
+                                      buffer_mem[read_ptr_1], buffer_mem[read_ptr]};
+                        read_ptr <= read_ptr + 3'd4;  // Auto-increment by 4
+                    end
                     REG_BUFFER_SIZE:  reg_rdata <= BUFFER_SIZE;
                     REG_TRIGGER:      reg_rdata <= {23'd0, trigger_enable, trigger_pid};
+                    REG_DROP_COUNT:   reg_rdata <= drop_count;
+                    REG_TRIG_SEQ:     reg_rdata <= {16'd0, trig_match_en, trig_skip_sof,
+                                                    trig_seq_extra, trig_seq_pids};
+                    REG_TRIG_MATCH:   reg_rdata <= {9'd0, trig_match_offset,
+                                                    trig_match_mask, trig_match_value};
+                    REG_TRIG_COUNT:   reg_rdata <= {trig_gap, trig_hits};
+                    REG_TRIG_DEPTH:   reg_rdata <= {post_depth, 8'd0, pre_depth};
+                    REG_TRIG_TIME:    reg_rdata <= trigger_time;
                     default:          reg_rdata <= 32'd0;
                 endcase
             end
@@ -0,0 +1,688 @@
+// FluxRipper Bus-Functional Models - C++ Header Library for Verilator
+// Created: 2025-12-08 19:15
+//
+// Cycle-based agents for Verilator testbenches:
+//   - CycleScheduler: owns the clock, calls every agent once per cycle and
+//     runs timed callbacks
+//   - AxiLiteMaster:  AXI4-Lite master with several reads and writes in flight
+//   - AxisSink:       AXI-Stream slave with optional backpressure, decodes
+//                     axi_stream_flux words
+//   - FluxPattern:    MFM/FM track encoder (port of flux_generator.vh)
+//   - FluxSource:     plays a FluxPattern onto flux/index pins, looping once
+//                     per revolution
+//
+// Each cycle the scheduler calls drive() on every agent, settles the DUT,
+// calls sample() (handshakes are taken from the pre-edge values, as the RTL
+// sees them), then runs the clock edge.
+//
+// Port names are bound with the BFM_*_PORT macros, so one agent class works
+// for any DUT and prefix:
+//   #include "axi_bfm.hpp"
+//   BFM_AXIL_PORT(CsrPort, s_axi_)
+//   CycleScheduler sched([&]{ dut->eval(); }, [&]{ tick(); }, 10);
+//   AxiLiteMaster<Vtop, CsrPort> csr(dut, sched);
+//   uint32_t v;
+//   csr.read(0x04, v);
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Port bindings
+//
+// Optional signals (rresp, bresp, wstrb, tlast) are detected at compile time;
+// a DUT without them reads as OKAY / full strobe / no last.
+//-----------------------------------------------------------------------------
+#define BFM_OPT_GET_(FN, P, SIG, DEFAULT) \
+    template<class D> static auto FN##_(D* d, int) -> decltype((uint32_t)d->P##SIG) \
+        { return d->P##SIG; } \
+    template<class D> static uint32_t FN##_(D*, long) { return DEFAULT; } \
+    template<class D> static uint32_t FN(D* d) { return FN##_(d, 0); }
+
+#define BFM_OPT_SET_(FN, P, SIG) \
+    template<class D> static auto FN##_(D* d, uint32_t v, int) -> decltype((void)(d->P##SIG = v)) \
+        { d->P##SIG = v; } \
+    template<class D> static void FN##_(D*, uint32_t, long) {} \
+    template<class D> static void FN(D* d, uint32_t v) { FN##_(d, v, 0); }
+
+#define BFM_AXIL_PORT(NAME, P) \
+struct NAME { \
+    template<class D> static void ar(D* d, uint32_t a, bool v) { d->P##araddr = a; d->P##arvalid = v; } \
+    template<class D> static bool arready(D* d) { return d->P##arready; } \
+    template<class D> static void rready(D* d, bool v) { d->P##rready = v; } \
+    template<class D> static bool rvalid(D* d) { return d->P##rvalid; } \
+    template<class D> static uint32_t rdata(D* d) { return d->P##rdata; } \
+    template<class D> static void aw(D* d, uint32_t a, bool v) { d->P##awaddr = a; d->P##awvalid = v; } \
+    template<class D> static bool awready(D* d) { return d->P##awready; } \
+    template<class D> static void w(D* d, uint32_t v, uint32_t s, bool vld) \
+        { d->P##wdata = v; wstrb(d, s); d->P##wvalid = vld; } \
+    template<class D> static bool wready(D* d) { return d->P##wready; } \
+    template<class D> static void bready(D* d, bool v) { d->P##bready = v; } \
+    template<class D> static bool bvalid(D* d) { return d->P##bvalid; } \
+    BFM_OPT_GET_(rresp, P, rresp, 0) \
+    BFM_OPT_GET_(bresp, P, bresp, 0) \
+    BFM_OPT_SET_(wstrb, P, wstrb) \
+};
+
+#define BFM_AXIS_PORT(NAME, P) \
+struct NAME { \
+    template<class D> static bool tvalid(D* d) { return d->P##tvalid; } \
+    template<class D> static uint32_t tdata(D* d) { return d->P##tdata; } \
+    template<class D> static void tready(D* d, bool v) { d->P##tready = v; } \
+    BFM_OPT_GET_(tlast, P, tlast, 0) \
+};
+
+#define BFM_FLUX_PORT(NAME, FLUX, INDEX) \
+struct NAME { \
+    template<class D> static void flux(D* d, bool v) { d->FLUX = v; } \
+    template<class D> static void index(D* d, bool v) { d->INDEX = v; } \
+};
+
+// Defaults matching rtl/axi/axi_stream_flux.v and the SoC CSR slave
+BFM_AXIL_PORT(SAxiPort, s_axi_)
+BFM_AXIS_PORT(MAxisPort, m_axis_)
+BFM_FLUX_PORT(FluxRawPort, flux_raw, index_pulse)
+
+//-----------------------------------------------------------------------------
+// Agent interface
+//-----------------------------------------------------------------------------
+class BfmAgent {
+public:
+    virtual ~BfmAgent() {}
+    virtual void drive(uint64_t cycle) = 0;     // Set outputs for this cycle
+    virtual void sample(uint64_t cycle) = 0;    // Observe settled inputs
+    virtual bool busy() const { return false; } // Work still queued
+};
+
+//-----------------------------------------------------------------------------
+// Cycle Scheduler
+//-----------------------------------------------------------------------------
+class CycleScheduler {
+public:
+    using Fn = std::function<void()>;
+
+    // settle: evaluate without a clock edge (usually dut->eval())
+    // clock:  advance one full clock period
+    CycleScheduler(Fn settle_, Fn clock_, uint32_t period_ns_)
+        : settle(settle_), clock(clock_), period_ns(period_ns_) {}
+
+    void attach(BfmAgent* agent) { agents.push_back(agent); }
+
+    uint64_t cycle() const { return cyc; }
+    uint64_t now_ns() const { return cyc * period_ns; }
+    uint32_t period() const { return period_ns; }
+
+    // Run fn before the agents' drive() on the given cycle
+    void at(uint64_t when, Fn fn) {
+        events.push(Event{when < cyc ? cyc : when, seq++, fn});
+    }
+    void after(uint64_t n, Fn fn) { at(cyc + n, fn); }
+
+    void step(uint64_t n = 1) {
+        while (n--) {
+            while (!events.empty() && events.top().when <= cyc) {
+                Fn fn = events.top().fn;
+                events.pop();
+                fn();
+            }
+            for (BfmAgent* a : agents) a->drive(cyc);
+            settle();
+            for (BfmAgent* a : agents) a->sample(cyc);
+            clock();
+            cyc++;
+        }
+    }
+
+    // Step until done() holds; false if timeout cycles pass first
+    bool run_until(const std::function<bool()>& done, uint64_t timeout) {
+        for (uint64_t i = 0; i < timeout; i++) {
+            if (done()) return true;
+            step();
+        }
+        return done();
+    }
+
+    // Step until no agent has work queued, leaving outputs idle
+    bool drain(uint64_t timeout) {
+        bool ok = run_until([this] {
+            for (BfmAgent* a : agents) if (a->busy()) return false;
+            return true;
+        }, timeout);
+        for (BfmAgent* a : agents) a->drive(cyc);
+        return ok;
+    }
+
+private:
+    struct Event {
+        uint64_t when;
+        uint64_t order;
+        Fn fn;
+        bool operator<(const Event& o) const {
+            return when != o.when ? when > o.when : order > o.order;
+        }
+    };
+
+    Fn settle;
+    Fn clock;
+    uint32_t period_ns;
+    uint64_t cyc = 0;
+    uint64_t seq = 0;
+    std::vector<BfmAgent*> agents;
+    std::priority_queue<Event> events;
+};
+
+//-----------------------------------------------------------------------------
+// AXI4-Lite Master
+//
+// Reads and writes are queued and issued back to back, up to max_outstanding
+// per direction. AXI-Lite has no IDs, so responses complete in issue order.
+//-----------------------------------------------------------------------------
+namespace AXI {
+    constexpr uint32_t RESP_OKAY   = 0;
+    constexpr uint32_t RESP_SLVERR = 2;
+    constexpr uint32_t RESP_DECERR = 3;
+    constexpr uint32_t RESP_TIMEOUT = 0x100;  // BFM only: no response seen
+}
+
+template<typename DUT, typename Port = SAxiPort>
+class AxiLiteMaster : public BfmAgent {
+public:
+    // data is the read data (0 for writes), resp the AXI response code
+    using Done = std::function<void(uint32_t data, uint32_t resp)>;
+
+    AxiLiteMaster(DUT* dut_, CycleScheduler& sched_, unsigned max_outstanding_ = 4)
+        : dut(dut_), sched(sched_), max_outstanding(max_outstanding_) {
+        Port::ar(dut, 0, false);
+        Port::aw(dut, 0, false);
+        Port::w(dut, 0, 0xF, false);
+        Port::rready(dut, false);
+        Port::bready(dut, false);
+        sched.attach(this);
+    }
+
+    //-------------------------------------------------------------------------
+    // Non-blocking
+    //-------------------------------------------------------------------------
+    void post_read(uint32_t addr, Done done = nullptr) {
+        read_q.push_back(Txn{addr, 0, 0, done});
+    }
+
+    void post_write(uint32_t addr, uint32_t data, uint32_t strb = 0xF, Done done = nullptr) {
+        write_q.push_back(Txn{addr, data, strb, done});
+    }
+
+    bool busy() const override {
+        return !read_q.empty() || !r_wait.empty() || !write_q.empty() || !b_wait.empty();
+    }
+
+    // Drop everything queued or in flight; callbacks see RESP_TIMEOUT
+    void abort() {
+        for (auto* q : {&read_q, &r_wait, &write_q, &b_wait}) {
+            for (Txn& t : *q) if (t.done) t.done(0, AXI::RESP_TIMEOUT);
+            q->clear();
+        }
+        aw_sent = w_sent = false;
+        Port::ar(dut, 0, false);
+        Port::aw(dut, 0, false);
+        Port::w(dut, 0, 0xF, false);
+    }
+
+    //-------------------------------------------------------------------------
+    // Blocking (run the scheduler until this transaction completes)
+    //
+    // On return the outputs are already set for the next cycle, so the
+    // testbench may clock the DUT outside the scheduler without replaying
+    // the handshake.
+    //-------------------------------------------------------------------------
+    uint32_t read(uint32_t addr, uint32_t& data, uint64_t timeout = 1000) {
+        bool done = false;
+        uint32_t resp = AXI::RESP_TIMEOUT;
+        post_read(addr, [&](uint32_t d, uint32_t r) { data = d; resp = r; done = true; });
+        if (!sched.run_until([&] { return done; }, timeout)) abort();
+        drive(sched.cycle());
+        return resp;
+    }
+
+    uint32_t write(uint32_t addr, uint32_t data, uint32_t strb = 0xF, uint64_t timeout = 1000) {
+        bool done = false;
+        uint32_t resp = AXI::RESP_TIMEOUT;
+        post_write(addr, data, strb, [&](uint32_t, uint32_t r) { resp = r; done = true; });
+        if (!sched.run_until([&] { return done; }, timeout)) abort();
+        drive(sched.cycle());
+        return resp;
+    }
+
+    //-------------------------------------------------------------------------
+    // Agent
+    //-------------------------------------------------------------------------
+    void drive(uint64_t) override {
+        bool ar_vld = !read_q.empty() && r_wait.size() < max_outstanding;
+        Port::ar(dut, ar_vld ? read_q.front().addr : 0, ar_vld);
+        Port::rready(dut, true);
+
+        bool wr_vld = !write_q.empty() && b_wait.size() < max_outstanding;
+        const Txn* t = wr_vld ? &write_q.front() : nullptr;
+        Port::aw(dut, t ? t->addr : 0, wr_vld && !aw_sent);
+        Port::w(dut, t ? t->data : 0, t ? t->strb : 0xF, wr_vld && !w_sent);
+        Port::bready(dut, true);
+    }
+
+    void sample(uint64_t) override {
+        // Responses first: an address accepted this cycle cannot also complete
+        if (Port::rvalid(dut) && !r_wait.empty()) {
+            Txn t = r_wait.front();
+            r_wait.pop_front();
+            if (t.done) t.done(Port::rdata(dut), Port::rresp(dut));
+        }
+        if (Port::bvalid(dut) && !b_wait.empty()) {
+            Txn t = b_wait.front();
+            b_wait.pop_front();
+            if (t.done) t.done(0, Port::bresp(dut));
+        }
+
+        if (!read_q.empty() && r_wait.size() < max_outstanding && Port::arready(dut)) {
+            r_wait.push_back(read_q.front());
+            read_q.pop_front();
+        }
+
+        if (!write_q.empty() && b_wait.size() < max_outstanding) {
+            if (!aw_sent && Port::awready(dut)) aw_sent = true;
+            if (!w_sent && Port::wready(dut)) w_sent = true;
+            if (aw_sent && w_sent) {
+                b_wait.push_back(write_q.front());
+                write_q.pop_front();
+                aw_sent = w_sent = false;
+            }
+        }
+    }
+
+private:
+    struct Txn {
+        uint32_t addr;
+        uint32_t data;
+        uint32_t strb;
+        Done done;
+    };
+
+    DUT* dut;
+    CycleScheduler& sched;
+    unsigned max_outstanding;
+    std::deque<Txn> read_q;     // Waiting for AR handshake
+    std::deque<Txn> r_wait;     // AR accepted, waiting for R
+    std::deque<Txn> write_q;    // Waiting for AW and W handshakes
+    std::deque<Txn> b_wait;     // AW/W accepted, waiting for B
+    bool aw_sent = false;
+    bool w_sent = false;
+};
+
+//-----------------------------------------------------------------------------
+// AXI-Stream Sink
+//-----------------------------------------------------------------------------
+
+// axi_stream_flux word: [31] index, [30] overflow, [27:0] timestamp
+struct FluxWord {
+    uint32_t raw;
+    bool index() const { return raw >> 31; }
+    bool overflow() const { return (raw >> 30) & 1; }
+    uint32_t timestamp() const { return raw & 0x0FFFFFFF; }
+};
+
+template<typename DUT, typename Port = MAxisPort>
+class AxisSink : public BfmAgent {
+public:
+    struct Beat {
+        uint32_t data;
+        bool     last;
+        uint64_t cycle;
+    };
+    using OnBeat = std::function<void(const Beat&)>;
+
+    AxisSink(DUT* dut_, CycleScheduler& sched_) : dut(dut_) {
+        Port::tready(dut, false);
+        sched_.attach(this);
+    }
+
+    // Accept on 'ready_num' of every 'ready_den' cycles (1/1 = always ready)
+    void set_backpressure(unsigned ready_num, unsigned ready_den) {
+        num = ready_num;
+        den = ready_den ? ready_den : 1;
+    }
+
+    void enable(bool on) { enabled = on; }
+    void on_beat(OnBeat fn) { callback = fn; }
+    void keep_beats(bool on) { keep = on; }     // Off for long runs
+
+    const std::vector<Beat>& beats() const { return log; }
+    uint64_t count() const { return total; }
+    uint64_t packets() const { return lasts; }
+    void clear() { log.clear(); total = lasts = 0; }
+
+    void drive(uint64_t cycle) override {
+        ready_now = enabled && (cycle % den) < num;
+        Port::tready(dut, ready_now);
+    }
+
+    void sample(uint64_t cycle) override {
+        if (!ready_now || !Port::tvalid(dut)) return;
+        Beat b{Port::tdata(dut), Port::tlast(dut) != 0, cycle};
+        total++;
+        if (b.last) lasts++;
+        if (keep) log.push_back(b);
+        if (callback) callback(b);
+    }
+
+private:
+    DUT* dut;
+    bool enabled = true;
+    bool keep = true;
+    bool ready_now = false;
+    unsigned num = 1;
+    unsigned den = 1;
+    uint64_t total = 0;
+    uint64_t lasts = 0;
+    std::vector<Beat> log;
+    OnBeat callback;
+};
+
+//-----------------------------------------------------------------------------
+// Flux Pattern
+//
+// Port of sim/common/flux_generator.vh. Builds a list of transition times
+// (ns from the start of the pattern) instead of driving a signal with delays.
+// Differences from the Verilog tasks: the MFM/FM address marks carry their
+// real missing-clock patterns and ID/data CRCs are computed, so the output
+// decodes cleanly end to end.
+//-----------------------------------------------------------------------------
+namespace FLUX {
+    constexpr uint32_t RATE_DD   = 250000;
+    constexpr uint32_t RATE_HD   = 500000;
+    constexpr uint32_t RATE_ED   = 1000000;
+    constexpr uint32_t RATE_MFM  = 5000000;
+    constexpr uint32_t RATE_RLL  = 7500000;
+    constexpr uint32_t RATE_ESDI = 10000000;
+
+    constexpr uint16_t MFM_SYNC_A1 = 0x4489;    // A1, clock missing between bits 4 and 5
+    constexpr uint16_t MFM_SYNC_C2 = 0x5224;    // C2, index mark sync
+}
+
+class FluxPattern {
+public:
+    explicit FluxPattern(uint32_t bit_rate = FLUX::RATE_DD) {
+        init(bit_rate);
+    }
+
+    void init(uint32_t bit_rate) {
+        bit_ns = 1000000000.0 / bit_rate;
+        t_ns = 0;
+        prev_bit = false;
+        noise_percent = 0;
+        lfsr = 0xACE1u;
+        times.clear();
+    }
+
+    // Per-transition jitter, uniform over +/- percent/2 of a bit cell
+    void set_noise(unsigned percent, uint32_t seed = 0xACE1u) {
+        noise_percent = percent;
+        lfsr = seed ? seed : 1;
+    }
+
+    const std::vector<uint64_t>& transitions() const { return times; }
+    uint64_t length_ns() const { return (uint64_t)t_ns; }
+
+    //-------------------------------------------------------------------------
+    // MFM
+    //-------------------------------------------------------------------------
+    void mfm_bit(bool d) {
+        cell(!prev_bit && !d);  // Clock: only between two zeros
+        cell(d);
+        prev_bit = d;
+    }
+
+    void mfm_byte(uint8_t v) {
+        for (int i = 7; i >= 0; i--) mfm_bit((v >> i) & 1);
+    }
+
+    void mfm_data(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) mfm_byte(data[i]);
+    }
+
+    void mfm_gap(unsigned n, uint8_t fill = 0x4E) {
+        for (unsigned i = 0; i < n; i++) mfm_byte(fill);
+    }
+
+    // Raw 16-cell mark (e.g. MFM_SYNC_A1); ends on a data 1
+    void mfm_raw(uint16_t cells) {
+        for (int i = 15; i >= 0; i--) cell((cells >> i) & 1);
+        prev_bit = cells & 1;
+    }
+
+    void mfm_sync(uint16_t mark = FLUX::MFM_SYNC_A1) {
+        for (int i = 0; i < 3; i++) mfm_raw(mark);
+    }
+
+    void mfm_sector(uint8_t c, uint8_t h, uint8_t r, uint8_t n,
+                    const uint8_t* data, uint8_t dam = 0xFB) {
+        size_t len = (size_t)128 << (n & 7);
+
+        mfm_gap(12, 0x00);
+        mfm_sync();
+        uint8_t id[5] = {0xFE, c, h, r, n};
+        uint16_t crc = crc16(id, 5, CRC_AFTER_A1S);
+        for (uint8_t b : id) mfm_byte(b);
+        mfm_byte(crc >> 8);
+        mfm_byte(crc & 0xFF);
+
+        mfm_gap(22);
+        mfm_gap(12, 0x00);
+        mfm_sync();
+        crc = crc16(&dam, 1, CRC_AFTER_A1S);
+        crc = crc16(data, len, crc);
+        mfm_byte(dam);
+        mfm_data(data, len);
+        mfm_byte(crc >> 8);
+        mfm_byte(crc & 0xFF);
+
+        mfm_gap(54);
+    }
+
+    // IBM System/34 track; data(r) supplies each sector's bytes (nullptr = E5)
+    void mfm_track(uint8_t c, uint8_t h, unsigned sectors, uint8_t n = 2,
+                   const std::function<const uint8_t*(uint8_t r)>& data = nullptr) {
+        std::vector<uint8_t> fill((size_t)128 << (n & 7), 0xE5);
+
+        mfm_gap(80);
+        mfm_gap(12, 0x00);
+        mfm_sync(FLUX::MFM_SYNC_C2);
+        mfm_byte(0xFC);
+        mfm_gap(50);
+        for (unsigned r = 1; r <= sectors; r++) {
+            const uint8_t* p = data ? data((uint8_t)r) : nullptr;
+            mfm_sector(c, h, (uint8_t)r, n, p ? p : fill.data());
+        }
+        mfm_gap(200);
+    }
+
+    //-------------------------------------------------------------------------
+    // FM
+    //-------------------------------------------------------------------------
+    void fm_bit(bool d) {
+        cell(true);
+        cell(d);
+    }
+
+    void fm_byte(uint8_t v) {
+        for (int i = 7; i >= 0; i--) fm_bit((v >> i) & 1);
+    }
+
+    // Address mark with missing clocks, e.g. fm_mark(0xFE, 0xC7)
+    void fm_mark(uint8_t data, uint8_t clock) {
+        for (int i = 7; i >= 0; i--) {
+            cell((clock >> i) & 1);
+            cell((data >> i) & 1);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // Raw and test patterns
+    //-------------------------------------------------------------------------
+    void raw_intervals(const uint32_t* intervals, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            t_ns += intervals[i];
+            emit();
+        }
+    }
+
+    void pattern_alt(unsigned bits) {
+        for (unsigned i = 0; i < bits; i++) mfm_bit(i & 1);
+    }
+
+    void pattern_ones(unsigned bits) {
+        for (unsigned i = 0; i < bits; i++) mfm_bit(true);
+    }
+
+    void pattern_zeros(unsigned bits) {
+        prev_bit = true;
+        for (unsigned i = 0; i < bits; i++) mfm_bit(false);
+    }
+
+    // Same polynomial as flux_test_pattern_prbs: x^32 + x^22 + x^2 + x + 1
+    void pattern_prbs(unsigned bits, uint32_t seed) {
+        uint32_t r = seed;
+        for (unsigned i = 0; i < bits; i++) {
+            mfm_bit(r & 1);
+            r = (r << 1) | (((r >> 31) ^ (r >> 21) ^ (r >> 1) ^ r) & 1);
+        }
+    }
+
+    // CRC-CCITT as used by the FDC (poly 0x1021)
+    static constexpr uint16_t CRC_AFTER_A1S = 0xCDB4;   // 0xFFFF after A1 A1 A1
+
+    static uint16_t crc16(const uint8_t* p, size_t len, uint16_t crc = 0xFFFF) {
+        while (len--) {
+            crc ^= (uint16_t)(*p++) << 8;
+            for (int i = 0; i < 8; i++) {
+                crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+private:
+    double bit_ns;
+    double t_ns;
+    bool prev_bit;
+    unsigned noise_percent;
+    uint32_t lfsr;
+    std::vector<uint64_t> times;
+
+    // One half-bit cell; a 1 cell is a transition at its start
+    void cell(bool one) {
+        if (one) emit();
+        t_ns += bit_ns / 2;
+    }
+
+    void emit() {
+        double t = t_ns;
+        if (noise_percent) {
+            lfsr ^= lfsr << 13;
+            lfsr ^= lfsr >> 17;
+            lfsr ^= lfsr << 5;
+            double range = bit_ns * noise_percent / 100.0;
+            t += range * ((double)lfsr / 4294967296.0 - 0.5);
+        }
+        if (t < 0) t = 0;
+        uint64_t ns = (uint64_t)t;
+        if (!times.empty() && ns <= times.back()) ns = times.back() + 1;
+        times.push_back(ns);
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Flux Source
+//
+// Each transition is a flux pulse of pulse_ns (drives pulse their read data
+// line; axi_stream_flux counts rising edges). With a revolution time set the
+// pattern restarts on every index pulse; otherwise it plays once.
+//-----------------------------------------------------------------------------
+template<typename DUT, typename Port = FluxRawPort>
+class FluxSource : public BfmAgent {
+public:
+    FluxSource(DUT* dut_, CycleScheduler& sched_)
+        : dut(dut_), sched(sched_) {
+        Port::flux(dut, false);
+        Port::index(dut, false);
+        sched.attach(this);
+    }
+
+    void load(const FluxPattern& p) { load(p.transitions()); }
+
+    void load(const std::vector<uint64_t>& t) {
+        times = t;
+        pos = 0;
+        start_ns = sched.now_ns();
+        revs = 0;
+        playing = true;
+    }
+
+    // revolution_ns = 0: play once; 200000000 = 300 RPM
+    void set_revolution(uint64_t revolution_ns, uint64_t index_width_ns = 2000) {
+        rev_ns = revolution_ns;
+        index_ns = index_width_ns;
+    }
+
+    void set_pulse_width(uint64_t ns) { pulse_ns = ns; }
+    void stop() { playing = false; }
+
+    uint64_t revolutions() const { return revs; }
+    uint64_t emitted() const { return sent; }
+    // A looping source never finishes, so it does not hold up drain()
+    bool busy() const override { return playing && !rev_ns && pos < times.size(); }
+
+    void drive(uint64_t) override {
+        if (!playing) {
+            Port::flux(dut, false);
+            Port::index(dut, false);
+            return;
+        }
+
+        uint64_t t = sched.now_ns() - start_ns;
+        if (rev_ns && t >= rev_ns) {
+            start_ns += rev_ns;
+            t -= rev_ns;
+            pos = 0;
+            revs++;
+        }
+
+        while (pos < times.size() && times[pos] + pulse_ns <= t) {
+            pos++;
+            sent++;
+        }
+        if (rev_ns) {
+            // Transitions past the index are cut, as on a real revolution
+            if (pos < times.size() && times[pos] >= rev_ns) pos = times.size();
+        }
+
+        Port::flux(dut, pos < times.size() && times[pos] <= t);
+        Port::index(dut, t < index_ns && (rev_ns || revs == 0));
+    }
+
+    void sample(uint64_t) override {}
+
+private:
+    DUT* dut;
+    CycleScheduler& sched;
+    std::vector<uint64_t> times;
+    size_t pos = 0;
+    uint64_t start_ns = 0;
+    uint64_t rev_ns = 0;
+    uint64_t index_ns = 2000;
+    uint64_t pulse_ns = 40;
+    uint64_t revs = 0;
+    uint64_t sent = 0;
+    bool playing = false;
+};
@@ -11,6 +11,7 @@
 //   uint32_t idcode = jtag.read_idcode();
 
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -27,6 +28,31 @@ namespace JTAG {
     constexpr uint8_t CAPS      = 0x08;
 }
 
+// Debug Module registers and sbcs bits (as decoded by rtl/debug/debug_module.v)
+namespace DM {
+    constexpr uint8_t  SBCS        = 0x38;
+    constexpr uint8_t  SBADDRESS0  = 0x39;
+    constexpr uint8_t  SBDATA0     = 0x3C;
+
+    constexpr uint32_t SBCS_SBACCESS32     = 2u << 1;   // Write [3:1], reads back at [4:2]
+    constexpr uint32_t SBCS_AUTOINCREMENT  = 1u << 5;
+    constexpr uint32_t SBCS_READONADDR     = 1u << 10;
+    constexpr uint32_t SBCS_READONDATA     = 1u << 11;
+    constexpr uint32_t SBCS_MODE_MASK      = SBCS_AUTOINCREMENT | SBCS_READONADDR |
+                                             SBCS_READONDATA;
+}
+
+// DMI scan ops: [1:0] of the 41-bit DMI register
+namespace DMI {
+    constexpr uint64_t OP_NOP   = 0;
+    constexpr uint64_t OP_READ  = 1;
+    constexpr uint64_t OP_WRITE = 2;
+
+    constexpr uint64_t request(uint8_t addr, uint32_t data, uint64_t op) {
+        return ((uint64_t)(addr & 0x7F) << 34) | ((uint64_t)data << 2) | op;
+    }
+}
+
 template<typename DUT>
 class JtagDriver {
 private:
@@ -72,6 +98,13 @@ private:
         posedge();       // Run-Test/Idle
     }
 
+    // Set sbcs mode bits, returning the previous sbcs in write layout
+    uint32_t sbcs_enter(uint32_t mode) {
+        uint32_t prev = dmi_read(DM::SBCS);
+        dmi_write(DM::SBCS, DM::SBCS_SBACCESS32 | mode);
+        return (((prev >> 2) & 0x7) << 1) | (prev & DM::SBCS_MODE_MASK);
+    }
+
 public:
     JtagDriver(DUT* dut_, uint64_t& sim_time_) 
         : dut(dut_), sim_time(sim_time_) {}
@@ -209,15 +242,53 @@ public:
     }
 
     //-------------------------------------------------------------------------
-    // Bulk Memory Read
+    // Bulk Memory Read (system bus burst)
+    //   sbautoincrement + sbreadondata are set once and sbaddress0 written
+    //   once; after that the DMI IR stays selected and every DR scan is a
+    //   single sbdata0 read. Each read triggers the bus read of the next
+    //   word, and the scan after it captures that word (this DM returns
+    //   the latch as it stands at Capture-DR), so N words take N + 1 scans
+    //   instead of N address writes, N reads and 2N IR shifts.
+    //   sbcs mode bits are restored afterwards.
     //-------------------------------------------------------------------------
     std::vector<uint32_t> mem_read_bulk(uint32_t addr, size_t count) {
         std::vector<uint32_t> data;
         data.reserve(count);
-        // Enable auto-increment in sbcs if not already done
-        for (size_t i = 0; i < count; i++) {
-            data.push_back(mem_read(addr + i * 4));
+        if (count == 0) return data;
+
+        uint32_t prev = sbcs_enter(DM::SBCS_AUTOINCREMENT | DM::SBCS_READONDATA);
+        dmi_write(DM::SBADDRESS0, addr);
+
+        const uint64_t read = DMI::request(DM::SBDATA0, 0, DMI::OP_READ);
+        shift_dr_41(read);                      // Captures nothing useful
+        for (size_t i = 1; i < count; i++) {
+            data.push_back((shift_dr_41(read) >> 2) & 0xFFFFFFFF);
         }
+        data.push_back((shift_dr_41(DMI::OP_NOP) >> 2) & 0xFFFFFFFF);
+
+        dmi_write(DM::SBCS, prev);
         return data;
     }
+
+    //-------------------------------------------------------------------------
+    // Bulk Memory Write (system bus burst)
+    //   sbautoincrement is set once and sbaddress0 written once; each word
+    //   is then one sbdata0 write scan on the already-selected DMI IR.
+    //-------------------------------------------------------------------------
+    void mem_write_bulk(uint32_t addr, const uint32_t* words, size_t count) {
+        if (count == 0) return;
+
+        uint32_t prev = sbcs_enter(DM::SBCS_AUTOINCREMENT);
+        dmi_write(DM::SBADDRESS0, addr);
+
+        for (size_t i = 0; i < count; i++) {
+            shift_dr_41(DMI::request(DM::SBDATA0, words[i], DMI::OP_WRITE));
+        }
+
+        dmi_write(DM::SBCS, prev);
+    }
+
+    void mem_write_bulk(uint32_t addr, const std::vector<uint32_t>& words) {
+        mem_write_bulk(addr, words.data(), words.size());
+    }
 };
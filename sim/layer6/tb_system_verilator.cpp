@@ -0,0 +1,504 @@
+// Verilator C++ Testbench - Layer 6: Full System Integration
+// Created: 2025-12-13 10:20
+//
+// The twelve tb_system.v tests against a Verilator build of fluxripper_top,
+// driven through common/jtag_driver.hpp. Every test brings the system up
+// from reset on its own, so each one runs in a forked child with a fresh
+// model; the children share the compiled model and run in parallel.
+//
+// Usage:
+//   Vfluxripper_top              Run all tests, one process per test
+//   Vfluxripper_top -j N         At most N tests at once (default: CPUs)
+//   Vfluxripper_top --test N     Run test N in this process
+//   Vfluxripper_top --vcd        Dump tb_system_<N>.vcd per test
+//   Vfluxripper_top --list       List the tests
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Vfluxripper_top.h"
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "common/jtag_driver.hpp"
+
+#define REF_HALF_NS   20            // 25 MHz clk_25m
+#define SYS_PERIOD_NS 80            // clk_sys from the behavioral clock_reset_mgr
+#define TCK_HALF_NS   50            // 10 MHz TCK, as tb_system.v
+
+//=============================================================================
+// System model: owns the DUT, the reference clock and the VCD
+//=============================================================================
+class SystemModel {
+public:
+    Vfluxripper_top* dut;
+    uint64_t time_ns = 0;
+    uint64_t ref_cycles = 0;
+
+    explicit SystemModel(const char* vcd_path) {
+        dut = new Vfluxripper_top;
+        if (vcd_path) {
+            tfp = new VerilatedVcdC;
+            dut->trace(tfp, 99);
+            tfp->open(vcd_path);
+        }
+        dut->clk_25m = 0;
+        dut->rst_n = 0;
+        dut->trst_n = 0;
+        dut->tck = 0;
+        dut->tms = 1;
+        dut->tdi = 0;
+        dut->flux_in = 0;
+        dut->index_in = 0;
+        settle();
+    }
+
+    ~SystemModel() {
+        dut->final();
+        if (tfp) {
+            tfp->close();
+            delete tfp;
+        }
+        delete dut;
+    }
+
+    // Propagate input changes made at the current time
+    void settle() {
+        dut->eval();
+        if (tfp) tfp->dump(time_ns);
+    }
+
+    // Run the reference clock for ns
+    void advance(uint64_t ns) {
+        uint64_t end = time_ns + ns;
+        while (next_edge <= end) {
+            time_ns = next_edge;
+            dut->clk_25m ^= 1;
+            if (dut->clk_25m) ref_cycles++;
+            settle();
+            next_edge += REF_HALF_NS;
+        }
+        time_ns = end;
+    }
+
+    void wait_ref(unsigned n) { advance((uint64_t)n * 2 * REF_HALF_NS); }
+    void wait_sys(unsigned n) { advance((uint64_t)n * SYS_PERIOD_NS); }
+
+private:
+    VerilatedVcdC* tfp = nullptr;
+    uint64_t next_edge = REF_HALF_NS;
+};
+
+//=============================================================================
+// JTAG port: what JtagDriver sees as its DUT
+//   Pin writes go straight to the model; eval() applies the edge and lets
+//   the system clock run for half a TCK period, so both domains advance
+//   together as they do under Icarus.
+//=============================================================================
+struct PinRef {
+    CData& pin;
+    PinRef& operator=(uint64_t v) { pin = (CData)(v & 1); return *this; }
+    operator int() const { return pin; }
+};
+
+struct JtagPort {
+    SystemModel& sys;
+    PinRef tck, tms, tdi, tdo;
+
+    explicit JtagPort(SystemModel& s)
+        : sys(s), tck{s.dut->tck}, tms{s.dut->tms}, tdi{s.dut->tdi}, tdo{s.dut->tdo} {}
+
+    void eval() {
+        sys.settle();
+        sys.advance(TCK_HALF_NS);
+    }
+};
+
+//=============================================================================
+// Test context: tb_system.v's access tasks over JtagDriver
+//=============================================================================
+struct System {
+    SystemModel model;
+    JtagPort port;
+    uint64_t jtag_time = 0;         // JtagDriver's own count; model time rules
+    JtagDriver<JtagPort> jtag;
+    int errors = 0;
+
+    explicit System(const char* vcd_path)
+        : model(vcd_path), port(model), jtag(&port, jtag_time) {}
+
+    Vfluxripper_top* dut() { return model.dut; }
+
+    // Reset, PLL lock and TAP reset, as the start of tb_system.v
+    void bring_up() {
+        model.advance(100);
+        dut()->rst_n = 1;
+        dut()->trst_n = 1;
+        model.settle();
+        model.wait_ref(500);
+        model.advance(2000);
+        jtag.reset();
+    }
+
+    // DMI op followed by a nop scan after the DM has had time to act
+    uint32_t dmi_reg_read(uint8_t addr) {
+        jtag.shift_ir(JTAG::DMI);
+        jtag.shift_dr_41(DMI::request(addr, 0, DMI::OP_READ));
+        model.wait_sys(10);
+        return (jtag.shift_dr_41(DMI::OP_NOP) >> 2) & 0xFFFFFFFF;
+    }
+
+    void dmi_reg_write(uint8_t addr, uint32_t data) {
+        jtag.shift_ir(JTAG::DMI);
+        jtag.shift_dr_41(DMI::request(addr, data, DMI::OP_WRITE));
+        model.wait_sys(10);
+        jtag.shift_dr_41(DMI::OP_NOP);
+    }
+
+    uint32_t mem_read(uint32_t addr) {
+        dmi_reg_write(DM::SBCS, DM::SBCS_SBACCESS32 | DM::SBCS_READONADDR);
+        dmi_reg_write(DM::SBADDRESS0, addr);
+        model.wait_sys(20);
+        return dmi_reg_read(DM::SBDATA0);
+    }
+
+    void mem_write(uint32_t addr, uint32_t data) {
+        dmi_reg_write(DM::SBCS, DM::SBCS_SBACCESS32);
+        dmi_reg_write(DM::SBADDRESS0, addr);
+        dmi_reg_write(DM::SBDATA0, data);
+        model.wait_sys(20);
+    }
+
+    void fail(const std::string& msg) {
+        std::cout << "  FAIL: " << msg << "\n";
+        errors++;
+    }
+
+    // Read addr and compare; prints the value either way
+    void expect_reg(const char* name, uint32_t addr, uint32_t expect) {
+        uint32_t v = mem_read(addr);
+        if (v != expect) {
+            fail(std::string(name) + " = " + hex(v) + " (expected " + hex(expect) + ")");
+        } else {
+            std::cout << "  " << name << " = " << hex(v) << "\n";
+        }
+    }
+
+    static std::string hex(uint32_t v) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "0x%08X", v);
+        return buf;
+    }
+};
+
+//=============================================================================
+// Tests (numbering and checks as tb_system.v)
+//=============================================================================
+static void test_reset(System& s) {
+    if (!s.dut()->pll_locked) s.fail("PLL not locked");
+    if (!s.dut()->sys_rst_n) s.fail("System reset not released");
+}
+
+static void test_idcode(System& s) {
+    uint32_t id = s.jtag.read_idcode();
+    if (id != 0xFB010001) {
+        s.fail("IDCODE = " + System::hex(id) + " (expected 0xFB010001)");
+    } else {
+        std::cout << "  IDCODE = " << System::hex(id) << "\n";
+    }
+}
+
+static void test_rom(System& s) {
+    s.expect_reg("ROM[0]", 0x00000000, 0x13000000);
+}
+
+static void test_ram(System& s) {
+    s.mem_write(0x10000000, 0xDEADBEEF);
+    s.expect_reg("RAM", 0x10000000, 0xDEADBEEF);
+}
+
+static void test_sysctrl(System& s) {
+    s.expect_reg("SYSCTRL_ID", 0x40000000, 0xFB010100);
+}
+
+static void test_motor(System& s) {
+    s.mem_write(0x40010004, 0x00000004);
+    s.model.wait_sys(50);
+    if (s.dut()->motor_on != 1) s.fail("motor_on = 0 after motor on");
+
+    s.mem_write(0x40010004, 0x00000000);
+    s.model.wait_sys(50);
+    if (s.dut()->motor_on != 0) s.fail("motor_on = 1 after motor off");
+}
+
+static void test_index(System& s) {
+    for (int i = 0; i < 5; i++) {
+        s.dut()->index_in = 1;
+        s.model.settle();
+        s.model.wait_sys(10);
+        s.dut()->index_in = 0;
+        s.model.settle();
+        s.model.wait_sys(100);
+    }
+
+    uint32_t count = s.mem_read(0x40010010);
+    if (count < 5) {
+        s.fail("INDEX_CNT = " + std::to_string(count) + " (expected >= 5)");
+    } else {
+        std::cout << "  INDEX_CNT = " << count << " pulses\n";
+    }
+}
+
+static void test_usb_id(System& s) {
+    s.expect_reg("USB_ID", 0x40020000, 0x05B20001);
+}
+
+static void test_usb_connect(System& s) {
+    s.mem_write(0x40020008, 0x00000003);
+    s.model.wait_sys(50);
+    if (!s.dut()->usb_connected || !s.dut()->usb_configured) {
+        s.fail("connected=" + std::to_string(s.dut()->usb_connected) +
+               " configured=" + std::to_string(s.dut()->usb_configured));
+    }
+}
+
+static void test_sigtap_id(System& s) {
+    s.expect_reg("SIGTAP_ID", 0x40030000, 0x51670001);
+}
+
+static void test_sigtap_capture(System& s) {
+    s.mem_write(0x4003000C, 0x00800000);    // Trigger value: motor_on (probe bit 23)
+    s.mem_write(0x40030010, 0x00800000);    // Trigger mask
+    s.mem_write(0x40030008, 0x00000001);    // Arm
+    s.model.wait_sys(20);
+
+    s.mem_write(0x40010004, 0x00000004);    // Motor on fires the trigger
+    s.model.wait_sys(300);
+
+    uint32_t status = s.mem_read(0x40030004);
+    if (!(status & (1u << 3))) {
+        s.fail("Signal Tap not triggered, STATUS=" + System::hex(status));
+    } else {
+        std::cout << "  STATUS = " << System::hex(status) << "\n";
+    }
+    s.mem_write(0x40010004, 0x00000000);
+}
+
+static void test_pattern(System& s) {
+    static const uint32_t pattern[4] = {0x11111111, 0x22222222, 0x33333333, 0x44444444};
+
+    for (int i = 0; i < 4; i++) s.mem_write(0x10001000 + 4 * i, pattern[i]);
+    for (int i = 0; i < 4; i++) {
+        uint32_t v = s.mem_read(0x10001000 + 4 * i);
+        if (v != pattern[i]) {
+            s.fail("RAM[" + System::hex(0x10001000 + 4 * i) + "] = " + System::hex(v));
+        }
+    }
+}
+
+struct TestCase {
+    const char* name;
+    void (*run)(System&);
+};
+
+static const TestCase tests[] = {
+    {"Power-On Reset Sequence",     test_reset},
+    {"JTAG IDCODE Read",            test_idcode},
+    {"Read Boot ROM",               test_rom},
+    {"RAM Write/Read",              test_ram},
+    {"System Control ID",           test_sysctrl},
+    {"Disk Controller Motor Control", test_motor},
+    {"Disk Index Pulse Counter",    test_index},
+    {"USB Controller ID",           test_usb_id},
+    {"USB Connection Enable",       test_usb_connect},
+    {"Signal Tap ID",               test_sigtap_id},
+    {"Signal Tap Capture",          test_sigtap_capture},
+    {"Memory Pattern Test",         test_pattern},
+};
+
+static const int NUM_TESTS = sizeof(tests) / sizeof(tests[0]);
+
+//=============================================================================
+// Runner
+//=============================================================================
+struct TestResult {
+    int      done;                  // Set by the child; 0 means it died
+    int      errors;
+    uint64_t cycles;                // clk_25m cycles
+    uint64_t sim_ns;
+    double   secs;
+};
+
+static void run_test(int n, bool vcd, TestResult& r) {
+    std::string vcd_path = "tb_system_" + std::to_string(n) + ".vcd";
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::cout << "Test " << n << ": " << tests[n - 1].name << "\n";
+    {
+        System s(vcd ? vcd_path.c_str() : nullptr);
+        s.bring_up();
+        tests[n - 1].run(s);
+        if (s.errors == 0) std::cout << "  PASS\n";
+
+        r.errors = s.errors;
+        r.cycles = s.model.ref_cycles;
+        r.sim_ns = s.model.time_ns;
+    }
+
+    r.secs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    r.done = 1;
+    std::cout << std::flush;
+}
+
+static void print_timing(int n, const TestResult& r) {
+    std::cout << "  [" << std::setw(2) << n << "] "
+              << std::fixed << std::setprecision(3) << std::setw(7) << r.secs << " s  "
+              << std::setw(9) << r.cycles << " cycles  "
+              << std::setprecision(2) << std::setw(6)
+              << (r.secs > 0 ? r.cycles / r.secs / 1e6 : 0.0) << " MHz";
+    if (!r.done) {
+        std::cout << "  CRASHED";
+    } else if (r.errors) {
+        std::cout << "  FAIL (" << r.errors << ")";
+    }
+    std::cout << "\n";
+}
+
+// Fork one child per test, at most jobs at a time. Each child's output
+// goes to its own temp file and is printed in test order afterwards.
+static void run_parallel(const std::vector<int>& which, int jobs, bool vcd,
+                         TestResult* results) {
+    std::vector<FILE*> out(which.size(), nullptr);
+    std::vector<pid_t> pid(which.size(), -1);
+    size_t next = 0;
+    int running = 0;
+
+    std::cout << std::flush;
+    while (next < which.size() || running > 0) {
+        while (next < which.size() && running < jobs) {
+            out[next] = tmpfile();
+            pid[next] = fork();
+            if (pid[next] == 0) {
+                dup2(fileno(out[next]), STDOUT_FILENO);
+                run_test(which[next], vcd, results[next]);
+                _exit(results[next].errors ? 1 : 0);
+            }
+            if (pid[next] < 0) {
+                std::cout << "  fork failed for test " << which[next] << "\n";
+            } else {
+                running++;
+            }
+            next++;
+        }
+        if (running > 0 && wait(nullptr) > 0) running--;
+    }
+
+    for (size_t i = 0; i < which.size(); i++) {
+        if (!out[i]) continue;
+        char buf[4096];
+        size_t len;
+        rewind(out[i]);
+        while ((len = fread(buf, 1, sizeof(buf), out[i])) > 0) {
+            std::cout.write(buf, len);
+        }
+        fclose(out[i]);
+    }
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::traceEverOn(true);
+
+    std::vector<int> which;
+    bool vcd = false;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--list")) {
+            for (int n = 1; n <= NUM_TESTS; n++) {
+                std::cout << std::setw(2) << n << "  " << tests[n - 1].name << "\n";
+            }
+            return 0;
+        } else if (!strcmp(argv[i], "--vcd")) {
+            vcd = true;
+        } else if (!strcmp(argv[i], "--test") && i + 1 < argc) {
+            int n = atoi(argv[++i]);
+            if (n < 1 || n > NUM_TESTS) {
+                std::cerr << "No test " << n << " (1-" << NUM_TESTS << ")\n";
+                return 2;
+            }
+            which.push_back(n);
+        } else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (argv[i][0] != '+') {
+            std::cerr << "Usage: " << argv[0] << " [--list] [--test N]... [--vcd] [-j N]\n";
+            return 2;
+        }
+    }
+    if (jobs < 1) jobs = 1;
+
+    std::cout << "\n===========================================================\n";
+    std::cout << "  Layer 6: Full System Integration Test (Verilator)\n";
+    std::cout << "===========================================================\n\n";
+
+    // A single named test runs in-process, which is what a debugger wants
+    bool fork_tests = which.size() != 1;
+    if (which.empty()) {
+        for (int n = 1; n <= NUM_TESTS; n++) which.push_back(n);
+    }
+
+    TestResult* results = (TestResult*)mmap(nullptr, sizeof(TestResult) * which.size(),
+                                            PROT_READ | PROT_WRITE,
+                                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        perror("mmap");
+        return 2;
+    }
+    memset(results, 0, sizeof(TestResult) * which.size());
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (fork_tests) {
+        run_parallel(which, jobs, vcd, results);
+    } else {
+        run_test(which[0], vcd, results[0]);
+    }
+    double wall = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    //-------------------------------------------------------------------------
+    // Summary
+    //-------------------------------------------------------------------------
+    int failed = 0;
+    uint64_t cycles = 0;
+    double cpu = 0;
+
+    std::cout << "\nPer-test timing (clk_25m cycles):\n";
+    for (size_t i = 0; i < which.size(); i++) {
+        print_timing(which[i], results[i]);
+        if (!results[i].done || results[i].errors) failed++;
+        cycles += results[i].cycles;
+        cpu += results[i].secs;
+    }
+
+    std::cout << "\n===========================================================\n";
+    if (failed == 0) {
+        std::cout << "  ALL TESTS PASSED\n";
+    } else {
+        std::cout << "  FAILED: " << failed << " of " << which.size() << " tests\n";
+    }
+    std::cout << "  Tests: " << which.size() << "  Jobs: " << (fork_tests ? jobs : 1) << "\n";
+    std::cout << std::fixed << std::setprecision(2)
+              << "  Wall: " << wall << " s  (test time " << cpu << " s)\n"
+              << "  Simulated: " << cycles << " cycles, "
+              << (wall > 0 ? cycles / wall / 1e6 : 0.0) << " MHz aggregate\n";
+    std::cout << "===========================================================\n\n";
+
+    munmap(results, sizeof(TestResult) * which.size());
+    return failed ? 1 : 0;
+}
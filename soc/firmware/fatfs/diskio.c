@@ -3,12 +3,39 @@
 /*                                                                       */
 /* Bridges FatFs generic disk operations to FluxRipper HAL               */
 /*                                                                       */
-/* Updated: 2025-12-03 19:00                                             */
+/* Physical drives 0-1 are the FDC floppies, 2-3 the hard drives         */
+/* (local storage for standalone imaging, see image_writer.h).           */
+/*                                                                       */
+/* Updated: 2025-12-10 09:00                                             */
 /*-----------------------------------------------------------------------*/
 
 #include "ff.h"
 #include "diskio.h"
 #include "fluxripper_hal.h"
+#include "hdd_hal.h"
+
+/* HDD drive behind a physical drive number, or -1 for a floppy */
+static int pdrv_hdd(BYTE pdrv)
+{
+    return (pdrv >= DISK_PDRV_HDD0) ? (int)(pdrv - DISK_PDRV_HDD0) : -1;
+}
+
+static DRESULT hal_result(int ret)
+{
+    switch (ret) {
+    case HAL_OK:
+        return RES_OK;
+    case HAL_ERR_NO_DISK:
+        return RES_NOTRDY;
+    case HAL_ERR_WRITE_PROT:
+        return RES_WRPRT;
+    case HAL_ERR_TIMEOUT:
+    case HAL_ERR_NOT_READY:
+        return RES_NOTRDY;
+    default:
+        return RES_ERROR;
+    }
+}
 
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                       */
@@ -22,6 +49,10 @@ DSTATUS disk_status(BYTE pdrv)
     if (pdrv >= FF_VOLUMES)
         return STA_NOINIT;
 
+    /* Hard drives: fixed media, ready once spun up */
+    if (pdrv_hdd(pdrv) >= 0)
+        return hdd_is_ready((uint8_t)pdrv_hdd(pdrv)) ? 0 : STA_NOINIT;
+
     /* Check if disk is present */
     if (!hal_disk_present(pdrv))
         return STA_NODISK;
@@ -45,6 +76,17 @@ DSTATUS disk_initialize(BYTE pdrv)
     if (pdrv >= FF_VOLUMES)
         return STA_NOINIT;
 
+    /* Hard drives need a discovered geometry for LBA access */
+    if (pdrv_hdd(pdrv) >= 0) {
+        hdd_profile_t profile;
+        uint8_t drive = (uint8_t)pdrv_hdd(pdrv);
+
+        if ((hdd_get_profile(drive, &profile) != HAL_OK || !profile.valid) &&
+            hdd_discover_quick(drive, &profile) != HAL_OK)
+            return STA_NOINIT;
+        return disk_status(pdrv);
+    }
+
     /* Turn on motor and wait for spin-up */
     ret = hal_motor_on(pdrv);
     if (ret != HAL_OK)
@@ -81,19 +123,12 @@ DRESULT disk_read(
         return RES_PARERR;
 
     /* Read sectors via HAL */
-    ret = hal_read_sectors(pdrv, (uint32_t)sector, buff, count);
+    if (pdrv_hdd(pdrv) >= 0)
+        ret = hdd_read_lba((uint8_t)pdrv_hdd(pdrv), (uint32_t)sector, count, buff);
+    else
+        ret = hal_read_sectors(pdrv, (uint32_t)sector, buff, count);
 
-    switch (ret) {
-    case HAL_OK:
-        return RES_OK;
-    case HAL_ERR_NO_DISK:
-        return RES_NOTRDY;
-    case HAL_ERR_TIMEOUT:
-    case HAL_ERR_NOT_READY:
-        return RES_NOTRDY;
-    default:
-        return RES_ERROR;
-    }
+    return hal_result(ret);
 }
 
 /*-----------------------------------------------------------------------*/
@@ -119,26 +154,18 @@ DRESULT disk_write(
     if (!buff)
         return RES_PARERR;
 
-    /* Check write protection */
-    if (hal_write_protected(pdrv))
-        return RES_WRPRT;
-
-    /* Write sectors via HAL */
-    ret = hal_write_sectors(pdrv, (uint32_t)sector, buff, count);
-
-    switch (ret) {
-    case HAL_OK:
-        return RES_OK;
-    case HAL_ERR_NO_DISK:
-        return RES_NOTRDY;
-    case HAL_ERR_WRITE_PROT:
-        return RES_WRPRT;
-    case HAL_ERR_TIMEOUT:
-    case HAL_ERR_NOT_READY:
-        return RES_NOTRDY;
-    default:
-        return RES_ERROR;
+    /* Write sectors via HAL (multi-sector runs go down in one call) */
+    if (pdrv_hdd(pdrv) >= 0) {
+        ret = hal_hdd_write_sectors((uint8_t)pdrv_hdd(pdrv), (uint32_t)sector,
+                                    buff, count);
+    } else {
+        /* Check write protection */
+        if (hal_write_protected(pdrv))
+            return RES_WRPRT;
+        ret = hal_write_sectors(pdrv, (uint32_t)sector, buff, count);
     }
+
+    return hal_result(ret);
 }
 
 #endif /* FF_FS_READONLY == 0 */
@@ -165,6 +192,17 @@ DRESULT disk_ioctl(
         return RES_OK;
 
     case GET_SECTOR_COUNT:
+        /* Hard drives: discovered geometry */
+        if (buff && pdrv_hdd(pdrv) >= 0) {
+            hdd_profile_t profile;
+
+            if (hdd_get_profile((uint8_t)pdrv_hdd(pdrv), &profile) != HAL_OK ||
+                !profile.valid)
+                return RES_NOTRDY;
+            *(LBA_t *)buff = profile.geometry.total_sectors;
+            return RES_OK;
+        }
+
         /* Return total sectors on disk based on drive profile */
         if (buff) {
             drive_profile_t profile;
@@ -191,7 +229,7 @@ DRESULT disk_ioctl(
         return RES_PARERR;
 
     case GET_SECTOR_SIZE:
-        /* Return sector size (always 512 for floppy) */
+        /* Return sector size (512 for floppy and the supported HDDs) */
         if (buff) {
             *(WORD *)buff = 512;
             return RES_OK;
@@ -4,7 +4,7 @@
 /* Low level disk interface module include file                          */
 /* Based on FatFs R0.15 by ChaN                                          */
 /*                                                                       */
-/* Updated: 2025-12-03 19:00                                             */
+/* Updated: 2025-12-10 09:00                                             */
 /*-----------------------------------------------------------------------*/
 
 #ifndef DISKIO_DEFINED
@@ -32,6 +32,12 @@ typedef enum {
     RES_PARERR      /* 4: Invalid Parameter */
 } DRESULT;
 
+/* Physical drive numbers */
+#define DISK_PDRV_FDD0      0   /* FDC drive A */
+#define DISK_PDRV_FDD1      1   /* FDC drive B */
+#define DISK_PDRV_HDD0      2   /* Hard drive 0 */
+#define DISK_PDRV_HDD1      3   /* Hard drive 1 */
+
 /*-----------------------------------------------------------------------*/
 /* Disk Status Bits                                                       */
 /*-----------------------------------------------------------------------*/
@@ -29,8 +29,8 @@
 #define FF_USE_FASTSEEK 0
 /* 0: Disable fast seek (saves RAM) */
 
-#define FF_USE_EXPAND   0
-/* 0: Disable f_expand() */
+#define FF_USE_EXPAND   1
+/* 1: Enable f_expand() - image_writer preallocates contiguous files */
 
 #define FF_USE_CHMOD    0
 /* 0: Disable f_chmod/f_utime (not needed for floppy) */
@@ -85,7 +85,7 @@
 
 #define FF_VOLUMES      4
 /* Number of volumes (drives) to support (1-10)
-   FluxRipper has 4 drives max (2 per interface) */
+   0-1: FDC floppies, 2-3: hard drives (diskio.h DISK_PDRV_*) */
 
 #define FF_STR_VOLUME_ID    0
 /* 0: Use numbers for volume ID (0:, 1:, etc.)
@@ -0,0 +1,219 @@
+/*-----------------------------------------------------------------------*/
+/* FluxRipper - Streaming Image Writer                                   */
+/*                                                                       */
+/* Created: 2025-12-10 09:00                                             */
+/*-----------------------------------------------------------------------*/
+
+#include "image_writer.h"
+#include "diskio.h"
+#include "fluxripper_hal.h"
+#include "platform.h"
+#include <string.h>
+
+#if FF_FS_READONLY == 0 && FF_USE_EXPAND == 1
+
+/*-----------------------------------------------------------------------*/
+/* Buffers                                                                */
+/*-----------------------------------------------------------------------*/
+
+static uint8_t *imgw_buf(unsigned int i)
+{
+    return (uint8_t *)(IMGW_BUF_BASE + i * IMGW_CHUNK);
+}
+
+/* Gathers writes that do not start on a cluster boundary */
+static uint8_t *imgw_staging(void)
+{
+    return imgw_buf(IMGW_CAPTURE_BUFS);
+}
+
+/*-----------------------------------------------------------------------*/
+/* Output                                                                 */
+/*-----------------------------------------------------------------------*/
+
+/*
+ * Write whole sectors at the current position: straight into the
+ * preallocated run while it lasts, through FatFs after that.
+ * pos is the file offset the data starts at.
+ */
+static FRESULT put(imgw_t *w, const uint8_t *src, uint32_t bytes, uint32_t pos)
+{
+    FRESULT res;
+    UINT bw;
+
+    if (w->direct) {
+        LBA_t count = (bytes + FF_MAX_SS - 1) / FF_MAX_SS;
+
+        if (w->sect + count <= w->sect_end) {
+            if (disk_write(w->fil.obj.fs->pdrv, src, w->sect, (UINT)count) != RES_OK)
+                return FR_DISK_ERR;
+            w->sect += count;
+            w->stats.disk_writes++;
+            return FR_OK;
+        }
+
+        /* Run used up: continue from its end, FatFs extends the chain */
+        w->direct = false;
+        res = f_lseek(&w->fil, pos);
+        if (res != FR_OK)
+            return res;
+    }
+
+    res = f_write(&w->fil, src, bytes, &bw);
+    w->stats.fs_writes++;
+    if (res == FR_OK && bw != bytes)
+        res = FR_DENIED;    /* Volume full */
+    return res;
+}
+
+/*-----------------------------------------------------------------------*/
+/* API                                                                    */
+/*-----------------------------------------------------------------------*/
+
+FRESULT imgw_open(imgw_t *w, const TCHAR *path, uint32_t expected_size)
+{
+    FATFS *fs;
+    FRESULT res;
+
+    memset(w, 0, sizeof(*w));
+
+    res = f_open(&w->fil, path, FA_WRITE | FA_CREATE_ALWAYS);
+    if (res != FR_OK)
+        return res;
+
+    fs = w->fil.obj.fs;
+    w->cluster = (uint32_t)fs->csize * FF_MAX_SS;
+    w->open = true;
+
+    if (expected_size > 0) {
+        uint32_t clusters = (expected_size + w->cluster - 1) / w->cluster;
+
+        /* Contiguous or not at all; a fragmented volume uses f_write() */
+        if (f_expand(&w->fil, (FSIZE_t)clusters * w->cluster, 1) == FR_OK) {
+            w->direct = true;
+            w->sect = fs->database + (LBA_t)fs->csize * (w->fil.obj.sclust - 2);
+            w->sect_end = w->sect + (LBA_t)clusters * fs->csize;
+        }
+    }
+    return FR_OK;
+}
+
+uint8_t *imgw_acquire(imgw_t *w)
+{
+    uint8_t *buf = imgw_buf(w->next);
+
+    w->next = (uint8_t)((w->next + 1) % IMGW_CAPTURE_BUFS);
+    return buf;
+}
+
+FRESULT imgw_write(imgw_t *w, const void *data, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t pos = w->stats.bytes - w->staged;
+    FRESULT res = FR_OK;
+
+    if (!w->open)
+        return FR_INVALID_OBJECT;
+    w->stats.bytes += len;
+
+    while (len > 0 && res == FR_OK) {
+        uint32_t n;
+
+        /* On a cluster boundary: whole clusters go out in place */
+        if (w->staged == 0 && len >= w->cluster) {
+            n = len - len % w->cluster;
+            res = put(w, src, n, pos);
+            pos += n;
+            src += n;
+            len -= n;
+            continue;
+        }
+
+        n = IMGW_CHUNK - w->staged;
+        if (n > len)
+            n = len;
+        memcpy(imgw_staging() + w->staged, src, n);
+        w->staged += n;
+        w->stats.copied += n;
+        src += n;
+        len -= n;
+
+        if (w->staged == IMGW_CHUNK) {
+            res = put(w, imgw_staging(), IMGW_CHUNK, pos);
+            pos += IMGW_CHUNK;
+            w->staged = 0;
+        }
+    }
+    return res;
+}
+
+FRESULT imgw_close(imgw_t *w)
+{
+    uint32_t size = w->stats.bytes;
+    FRESULT res = FR_OK;
+    FRESULT cres;
+
+    if (!w->open)
+        return FR_INVALID_OBJECT;
+
+    if (w->staged > 0) {
+        uint32_t bytes = w->staged;
+        LBA_t count = (bytes + FF_MAX_SS - 1) / FF_MAX_SS;
+
+        /* Raw sector writes need the last sector padded out; trimmed below */
+        if (w->direct && w->sect + count <= w->sect_end) {
+            memset(imgw_staging() + bytes, 0, count * FF_MAX_SS - bytes);
+            bytes = count * FF_MAX_SS;
+        }
+        res = put(w, imgw_staging(), bytes, size - w->staged);
+        w->staged = 0;
+    }
+
+    /* Drop the unused tail of the preallocated run */
+    if (res == FR_OK && w->direct) {
+        res = f_lseek(&w->fil, size);
+        if (res == FR_OK)
+            res = f_truncate(&w->fil);
+    }
+
+    cres = f_close(&w->fil);
+    w->open = false;
+    return (res != FR_OK) ? res : cres;
+}
+
+FRESULT imgw_save_fdd(uint8_t drive, const TCHAR *path)
+{
+    imgw_t w;
+    LBA_t total, lba;
+    FRESULT res, cres;
+
+    if (drive >= MAX_DRIVES)
+        return FR_INVALID_PARAMETER;
+    if (disk_ioctl(DISK_PDRV_FDD0 + drive, GET_SECTOR_COUNT, &total) != RES_OK)
+        return FR_NOT_READY;
+
+    res = imgw_open(&w, path, (uint32_t)total * FDC_SECTOR_SIZE);
+    if (res != FR_OK)
+        return res;
+
+    for (lba = 0; lba < total && res == FR_OK; ) {
+        uint8_t *buf = imgw_acquire(&w);
+        uint32_t count = IMGW_CHUNK / FDC_SECTOR_SIZE;
+
+        if (count > total - lba)
+            count = (uint32_t)(total - lba);
+
+        if (hal_read_sectors(drive, (uint32_t)lba, buf, count) != HAL_OK) {
+            res = FR_DISK_ERR;
+            break;
+        }
+        res = imgw_write(&w, buf, count * FDC_SECTOR_SIZE);
+        lba += count;
+    }
+
+    cres = imgw_close(&w);
+    hal_motor_release(drive);
+    return (res != FR_OK) ? res : cres;
+}
+
+#endif /* FF_FS_READONLY == 0 && FF_USE_EXPAND == 1 */
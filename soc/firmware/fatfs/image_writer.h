@@ -0,0 +1,106 @@
+/*-----------------------------------------------------------------------*/
+/* FluxRipper - Streaming Image Writer                                   */
+/*                                                                       */
+/* Writes capture output (raw flux, decoded sector images) to a file on  */
+/* a local FAT volume for standalone imaging without a host PC.          */
+/*                                                                       */
+/* The file is preallocated as one contiguous cluster run (f_expand)     */
+/* when the expected size is known; data then goes to disk_write() in    */
+/* multi-cluster runs that bypass the FatFs window, and the file is      */
+/* trimmed to the bytes written at close. Without preallocation (or once */
+/* the run is exhausted) writes go through f_write() in whole clusters.  */
+/*                                                                       */
+/* Buffers are 64KB, page aligned, in HyperRAM (IMGW_BUF_BASE). Two are  */
+/* handed out by imgw_acquire() for a double-buffered producer: capture  */
+/* into one while the other is written. Buffers passed to imgw_write()   */
+/* at a cluster-aligned file position are written in place; anything    */
+/* else is gathered in the third (staging) buffer.                       */
+/* The buffers are shared, so one writer is open at a time.             */
+/*                                                                       */
+/* Created: 2025-12-10 09:00                                             */
+/*-----------------------------------------------------------------------*/
+
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ff.h"
+
+/*-----------------------------------------------------------------------*/
+/* Configuration                                                          */
+/*-----------------------------------------------------------------------*/
+
+#define IMGW_CHUNK          (64 * 1024)     /* Buffer size: the largest FAT cluster */
+#define IMGW_CAPTURE_BUFS   2               /* imgw_acquire() buffers */
+
+/*-----------------------------------------------------------------------*/
+/* Types                                                                  */
+/*-----------------------------------------------------------------------*/
+
+typedef struct {
+    uint32_t    disk_writes;    /* disk_write() calls on the direct path */
+    uint32_t    fs_writes;      /* f_write() calls */
+    uint32_t    bytes;          /* Bytes accepted */
+    uint32_t    copied;         /* Bytes gathered through the staging buffer */
+} imgw_stats_t;
+
+typedef struct {
+    FIL         fil;
+    bool        open;
+    bool        direct;         /* Writing raw sectors into the preallocated run */
+    LBA_t       sect;           /* Direct: next sector */
+    LBA_t       sect_end;       /* Direct: end of the preallocated run */
+    uint32_t    cluster;        /* Cluster size in bytes */
+    uint32_t    staged;         /* Bytes pending in the staging buffer */
+    uint8_t     next;           /* Next imgw_acquire() buffer */
+    imgw_stats_t stats;
+} imgw_t;
+
+/*-----------------------------------------------------------------------*/
+/* API                                                                    */
+/*-----------------------------------------------------------------------*/
+
+/**
+ * Create (or truncate) an image file for writing
+ * @param w             writer state
+ * @param path          file path, e.g. "2:/DISK001.IMG"
+ * @param expected_size expected total bytes (0 = unknown, no preallocation)
+ * @return FR_OK on success, FatFs error otherwise
+ */
+FRESULT imgw_open(imgw_t *w, const TCHAR *path, uint32_t expected_size);
+
+/**
+ * Get the next capture buffer (IMGW_CHUNK bytes, alternating)
+ * Fill it and pass it to imgw_write(); the other buffer stays free to
+ * capture into meanwhile.
+ * @param w             writer state
+ * @return buffer in HyperRAM
+ */
+uint8_t *imgw_acquire(imgw_t *w);
+
+/**
+ * Append data to the image
+ * @param w             writer state
+ * @param data          bytes to append
+ * @param len           byte count
+ * @return FR_OK on success, FatFs error otherwise
+ */
+FRESULT imgw_write(imgw_t *w, const void *data, uint32_t len);
+
+/**
+ * Write out pending data, trim the file to its size and close it
+ * @param w             writer state
+ * @return FR_OK on success, FatFs error otherwise
+ */
+FRESULT imgw_close(imgw_t *w);
+
+/**
+ * Save a floppy's decoded sectors as a raw sector image
+ * @param drive         FDC drive (0-1)
+ * @param path          destination file on a mounted volume
+ * @return FR_OK on success, FatFs error (FR_DISK_ERR on a read error)
+ */
+FRESULT imgw_save_fdd(uint8_t drive, const TCHAR *path);
+
+#endif /* IMAGE_WRITER_H */
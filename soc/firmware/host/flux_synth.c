@@ -0,0 +1,239 @@
+/**
+ * FluxRipper SoC - Synthetic Flux Tracks
+ *
+ * Created: 2025-12-08 22:10
+ */
+
+#include "flux_synth.h"
+#include "platform.h"
+#include "raw_protocol.h"
+#include "crc16.h"
+#include <stdlib.h>
+
+#define SYN_CELL_CLKS       (FDC_FREQ_HZ / (2 * FLUX_SYNTH_RATE))  /* 1 us MFM cell */
+#define SYN_REV_CELLS       (2 * FLUX_SYNTH_RATE / 5)              /* 200 ms */
+
+/* Data bytes in the weak patch or dropout start this far into the sector */
+#define SYN_WEAK_OFFSET     200
+#define SYN_DROPOUT_OFFSET  100
+#define SYN_FLIP_OFFSET     300
+#define SYN_FLIP_STRIDE     37      /* Bytes between flipped bits */
+
+typedef struct {
+    const flux_synth_t *p;
+    uint32_t *words;
+    uint32_t  count;
+    uint32_t  cap;
+    int       failed;
+    uint32_t  rev;                  /* Revolution being generated */
+    uint64_t  cell;                 /* Cells since index */
+    uint64_t  origin;               /* Clock of this revolution's index */
+    uint64_t  cell_q16;             /* Cell length this revolution, Q16 clocks */
+    uint8_t   prev;                 /* Last data bit (for clock cells) */
+    uint32_t  rng;
+    uint32_t  jitter;               /* Current peak jitter */
+    int       mute;                 /* Inside a dropout */
+} synth_t;
+
+static uint32_t syn_rand(synth_t *s)
+{
+    s->rng ^= s->rng << 13;
+    s->rng ^= s->rng >> 17;
+    s->rng ^= s->rng << 5;
+    return s->rng;
+}
+
+static void syn_emit(synth_t *s, uint32_t word)
+{
+    if (s->count == s->cap) {
+        uint32_t cap = s->cap ? s->cap * 2 : 65536;
+        uint32_t *w = realloc(s->words, (size_t)cap * 4);
+        if (!w) {
+            s->failed = 1;
+            return;
+        }
+        s->words = w;
+        s->cap = cap;
+    }
+    s->words[s->count++] = word;
+}
+
+static void syn_cell(synth_t *s, uint8_t flux)
+{
+    if (flux && !s->mute) {
+        int32_t j = 0;
+        if (s->jitter) {
+            j = (int32_t)(syn_rand(s) % (2 * s->jitter + 1)) - (int32_t)s->jitter;
+        }
+        uint64_t t = s->origin + ((s->cell * s->cell_q16) >> 16) + SYN_CELL_CLKS / 2 + j;
+        syn_emit(s, (uint32_t)t & FLUX_TIMESTAMP_MASK);
+    }
+    s->cell++;
+}
+
+static void syn_byte(synth_t *s, uint8_t b)
+{
+    for (int i = 7; i >= 0; i--) {
+        uint8_t d = (b >> i) & 1;
+        syn_cell(s, !(s->prev | d));
+        syn_cell(s, d);
+        s->prev = d;
+    }
+}
+
+/* A1 with the missing clock (0x4489) */
+static void syn_sync_a1(synth_t *s)
+{
+    for (int i = 15; i >= 0; i--) {
+        syn_cell(s, (0x4489 >> i) & 1);
+    }
+    s->prev = 1;
+}
+
+static void syn_fill(synth_t *s, uint8_t b, int n)
+{
+    while (n-- > 0) {
+        syn_byte(s, b);
+    }
+}
+
+void flux_synth_sector_data(uint8_t r, uint8_t *buf)
+{
+    for (int i = 0; i < FLUX_SYNTH_SECTOR_SIZE; i++) {
+        buf[i] = (uint8_t)(r * 37 + i * 11);
+    }
+}
+
+static void syn_revolution(synth_t *s)
+{
+    const flux_synth_t *p = s->p;
+    uint8_t id[8] = { 0xA1, 0xA1, 0xA1, 0xFE, 0, 0, 0, 2 };
+    uint8_t data[4 + FLUX_SYNTH_SECTOR_SIZE + 2];
+    bool dropout = p->dropout_sector && (syn_rand(s) % 100) < p->dropout_pct;
+
+    /* Spindle speed for this revolution: slower spindle, longer cells */
+    int64_t ppm = p->speed_ppm;
+    if (p->drift_ppm) {
+        ppm += (int64_t)(syn_rand(s) % (2 * p->drift_ppm + 1)) - p->drift_ppm;
+    }
+    s->cell_q16 = ((uint64_t)SYN_CELL_CLKS << 16) * 1000000 / (uint64_t)(1000000 + ppm);
+
+    s->cell = 0;
+    s->prev = 0;
+    s->jitter = p->jitter;
+    syn_emit(s, FLUX_FLAG_INDEX | ((uint32_t)s->origin & FLUX_TIMESTAMP_MASK));
+
+    syn_fill(s, 0x4E, 80);
+    syn_fill(s, 0x00, 12);
+    syn_fill(s, 0x4E, 50);
+
+    for (uint8_t r = 1; r <= FLUX_SYNTH_SPT; r++) {
+        id[6] = r;
+        uint16_t crc = crc16_ccitt(id, 8);
+
+        syn_fill(s, 0x00, 12);
+        syn_sync_a1(s);
+        syn_sync_a1(s);
+        syn_sync_a1(s);
+        for (int i = 3; i < 8; i++) {
+            syn_byte(s, id[i]);
+        }
+        syn_byte(s, crc >> 8);
+        syn_byte(s, crc & 0xFF);
+        syn_fill(s, 0x4E, 22);
+
+        data[0] = data[1] = data[2] = 0xA1;
+        data[3] = 0xFB;
+        flux_synth_sector_data(r, &data[4]);
+        crc = crc16_ccitt(data, 4 + FLUX_SYNTH_SECTOR_SIZE);
+        data[4 + FLUX_SYNTH_SECTOR_SIZE] = crc >> 8;
+        data[5 + FLUX_SYNTH_SECTOR_SIZE] = crc & 0xFF;
+
+        syn_fill(s, 0x00, 12);
+        syn_sync_a1(s);
+        syn_sync_a1(s);
+        syn_sync_a1(s);
+        /* Flipped bits read wrong on revolutions 0, 1, 3, 4, ... */
+        if (r == p->flip_sector && s->rev % 3 != 2) {
+            for (int f = 0; f < p->flip_bits; f++) {
+                data[4 + SYN_FLIP_OFFSET + f * SYN_FLIP_STRIDE] ^= 0x80 >> (f * 3 % 8);
+            }
+        }
+
+        for (int i = 3; i < (int)sizeof(data); i++) {
+            int pos = i - 4;
+            s->jitter = p->jitter;
+            if (r == p->weak_sector && pos >= SYN_WEAK_OFFSET &&
+                pos < SYN_WEAK_OFFSET + p->weak_bytes) {
+                s->jitter = SYN_CELL_CLKS * 45 / 100;
+            }
+            s->mute = dropout && r == p->dropout_sector && pos >= SYN_DROPOUT_OFFSET &&
+                      pos < SYN_DROPOUT_OFFSET + p->dropout_bytes;
+            syn_byte(s, data[i]);
+        }
+        s->mute = 0;
+        s->jitter = p->jitter;
+        syn_fill(s, 0x4E, 80);
+    }
+
+    /* Gap 4b up to the next index */
+    while (s->cell + 16 < SYN_REV_CELLS) {
+        syn_byte(s, 0x4E);
+    }
+    s->origin += (SYN_REV_CELLS * s->cell_q16) >> 16;
+}
+
+/*
+ * Peak shift: each transition moves away from its closer neighbour, so
+ * short intervals bordered by longer ones read long and vice versa
+ */
+static void syn_peak_shift(synth_t *s, int32_t shift)
+{
+    uint32_t prev = 0, cur = 0, seen = 0;
+    uint32_t *at = NULL;
+
+    for (uint32_t i = 0; i < s->count; i++) {
+        uint32_t w = s->words[i];
+
+        if (w & FLUX_FLAG_INDEX) {
+            continue;
+        }
+        /* Intervals from the unshifted neighbours */
+        if (seen >= 2) {
+            uint32_t a = (cur - prev) & FLUX_TIMESTAMP_MASK;
+            uint32_t b = (w - cur) & FLUX_TIMESTAMP_MASK;
+
+            if (a < b) {
+                *at = (uint32_t)(cur + shift) & FLUX_TIMESTAMP_MASK;
+            } else if (a > b) {
+                *at = (uint32_t)(cur - shift) & FLUX_TIMESTAMP_MASK;
+            }
+        }
+        prev = cur;
+        cur = w;
+        at = &s->words[i];
+        seen++;
+    }
+}
+
+int flux_synth_track(const flux_synth_t *p, uint8_t revs, uint32_t **words, uint32_t *count)
+{
+    synth_t s = { .p = p, .rng = p->seed ? p->seed : 0x1234567 };
+
+    for (uint8_t r = 0; r < revs; r++) {
+        s.rev = r;
+        syn_revolution(&s);
+    }
+    syn_emit(&s, FLUX_FLAG_INDEX | ((uint32_t)s.origin & FLUX_TIMESTAMP_MASK));
+    if (p->peak_shift && !s.failed) {
+        syn_peak_shift(&s, p->peak_shift);
+    }
+
+    if (s.failed) {
+        free(s.words);
+        return -1;
+    }
+    *words = s.words;
+    *count = s.count;
+    return 0;
+}
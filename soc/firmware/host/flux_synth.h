@@ -0,0 +1,59 @@
+/**
+ * FluxRipper SoC - Synthetic Flux Tracks
+ *
+ * Generates IBM MFM DD tracks (250 kbps, 300 RPM, 9 x 512) as index-marked
+ * 200 MHz flux words, with the degradations the recovery path has to cope
+ * with: timing noise, weak bit patches, spindle speed offset and drift,
+ * intermittent dropouts, bits that read wrong on most revolutions, and the
+ * peak shift of an uncompensated write.
+ * Sector contents are deterministic so recovered
+ * data can be checked, not just its CRC.
+ *
+ * Created: 2025-12-08 22:10
+ */
+
+#ifndef FLUX_SYNTH_H
+#define FLUX_SYNTH_H
+
+#include <stdint.h>
+
+#define FLUX_SYNTH_SPT          9
+#define FLUX_SYNTH_SECTOR_SIZE  512
+#define FLUX_SYNTH_RATE         250000
+
+/**
+ * Track degradation parameters (all zero = clean track, nominal speed)
+ */
+typedef struct {
+    uint32_t seed;              /* Noise seed (0 = fixed default) */
+    uint32_t jitter;            /* Peak random timing noise, capture clocks */
+    int32_t  speed_ppm;         /* Spindle speed offset */
+    uint32_t drift_ppm;         /* Peak random speed change per revolution */
+    uint8_t  weak_sector;       /* Sector (R) with a weak patch, 0 = none */
+    uint16_t weak_bytes;        /* Weak patch length in data bytes */
+    uint8_t  dropout_sector;    /* Sector (R) with a dropout, 0 = none */
+    uint16_t dropout_bytes;     /* Dropout length in data bytes */
+    uint8_t  dropout_pct;       /* Revolutions showing the dropout (%) */
+    int32_t  peak_shift;        /* Write peak shift after precompensation, capture clocks */
+    uint8_t  flip_sector;       /* Sector (R) with flipped bits, 0 = none */
+    uint8_t  flip_bits;         /* Data bits inverted on two of every three revolutions */
+} flux_synth_t;
+
+/**
+ * Generate 'revs' revolutions, each opened by an index mark, plus the
+ * closing index mark
+ *
+ * @param p         Degradation parameters
+ * @param revs      Revolutions to generate
+ * @param words     Allocated flux words (caller frees)
+ * @param count     Word count
+ * @return 0 on success, -1 on allocation failure
+ */
+int flux_synth_track(const flux_synth_t *p, uint8_t revs, uint32_t **words, uint32_t *count);
+
+/**
+ * Expected contents of sector R
+ */
+void flux_synth_sector_data(uint8_t r, uint8_t *buf);
+
+#endif /* FLUX_SYNTH_H */
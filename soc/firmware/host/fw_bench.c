@@ -0,0 +1,1271 @@
+/**
+ * FluxRipper SoC - Host Firmware Benchmark
+ *
+ * Runs firmware modules built for x86 (make host) against replayed flux
+ * dumps and drive images. Reports host time for the algorithm itself and
+ * virtual SoC time (register accesses, drive latency) for the I/O it
+ * issued.
+ *
+ *   fw_bench flux  <dump> [passes]          FluxStat capture + track recovery
+ *   fw_bench diag  <dump> [loops]           diag_update_flux_block() throughput
+ *   fw_bench decode <dump> [loops]          Software PLL + MFM decoder throughput
+ *   fw_bench eye   <dump> [loops] [decim]   Eye diagram + streamed waveform
+ *   fw_bench gw    <dump> [loops]           Greaseweazle stream encode/decode
+ *   fw_bench kf    <dump> [loops]           KryoFlux stream encode + parse
+ *   fw_bench msc   <image> [seq|rand|back|verify] [ops] [blocks]
+ *                                          SCSI READ(10) / VERIFY(10) through msc_hal
+ *   fw_bench recovery [passes] [dump...]    Bit Healer corpus benchmark
+ *   fw_bench pll   [passes] [dump...]       PLL bandwidth/damping search
+ *   fw_bench format [tracks] [dump...]      Automatic encoding, cached vs probed
+ *   fw_bench precomp [shift ns]             Write precompensation sweep
+ *   fw_bench synth <dump> [revs] [weak]     Write a synthetic MFM DD track
+ *
+ * Created: 2025-12-08 20:30
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include "host_shim.h"
+#include "fluxstat_hal.h"
+#include "fluxripper_hal.h"
+#include "diagnostics_handler.h"
+#include "scsi_handler.h"
+#include "msc_hal.h"
+#include "raw_protocol.h"
+#include "flux_synth.h"
+#include "prof.h"
+#include "gw_flux.h"
+#include "kf_stream.h"
+#include "pll_cal.h"
+#include "flux_decode.h"
+#include "format_cache.h"
+#include "precomp_cal.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*============================================================================
+ * Timing
+ *============================================================================*/
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define bench_tsc()         __rdtsc()
+#else
+#define bench_tsc()         0ULL
+#endif
+
+typedef struct {
+    struct timespec host;
+    uint64_t        cycles;
+    uint64_t        mmio;
+} bench_mark_t;
+
+static void mark(bench_mark_t *m)
+{
+    clock_gettime(CLOCK_MONOTONIC, &m->host);
+    m->cycles = host_cycles();
+    m->mmio = host_mmio_count();
+}
+
+static void report(const char *what, const bench_mark_t *a)
+{
+    bench_mark_t b;
+    mark(&b);
+
+    double host_us = (b.host.tv_sec - a->host.tv_sec) * 1e6 +
+                     (b.host.tv_nsec - a->host.tv_nsec) / 1e3;
+    printf("  %-24s host %10.1f us   soc %10.3f ms   mmio %llu\n", what, host_us,
+           (double)(b.cycles - a->cycles) / (CPU_FREQ_HZ / 1000),
+           (unsigned long long)(b.mmio - a->mmio));
+}
+
+/*============================================================================
+ * Synthetic Tracks
+ *============================================================================*/
+
+static int cmd_synth(int argc, char **argv)
+{
+    uint32_t *words;
+    uint32_t count;
+
+    if (argc < 1) {
+        return -1;
+    }
+    int revs = argc > 1 ? atoi(argv[1]) : 8;
+    flux_synth_t p = {
+        .jitter = FDC_FREQ_HZ / (2 * FLUX_SYNTH_RATE) / 20,
+        .weak_sector = argc > 2 ? (uint8_t)atoi(argv[2]) : 0,
+        .weak_bytes = 4,
+    };
+
+    if (revs < 1 || revs > 255 || flux_synth_track(&p, (uint8_t)revs, &words, &count) != 0) {
+        return -1;
+    }
+
+    FILE *f = fopen(argv[0], "wb");
+    if (!f || fwrite(words, 4, count, f) != count) {
+        perror(argv[0]);
+        return 1;
+    }
+    fclose(f);
+    printf("%s: %d revolutions, %u flux words\n", argv[0], revs, count);
+    free(words);
+    return 0;
+}
+
+/*============================================================================
+ * FluxStat
+ *============================================================================*/
+
+static int cmd_flux(int argc, char **argv)
+{
+    static fluxstat_capture_t capture;
+    static fluxstat_track_t track;
+    static fluxstat_sector_t sector;
+    bench_mark_t m;
+
+    if (argc < 1) {
+        return -1;
+    }
+    int revs = host_flux_load(0, argv[0]);
+    if (revs < 0) {
+        return 1;
+    }
+    printf("%s: %d revolutions\n", argv[0], revs);
+
+    timer_init();
+    fluxstat_init();
+
+    fluxstat_config_t cfg;
+    fluxstat_get_config(&cfg);
+    cfg.pass_count = argc > 1 ? (uint8_t)atoi(argv[1]) : FLUXSTAT_DEFAULT_PASSES;
+    cfg.encoding = ENC_MFM;
+    cfg.data_rate = 250000;
+    if (fluxstat_configure(&cfg) != FLUXSTAT_OK) {
+        fprintf(stderr, "fluxstat_configure failed\n");
+        return 1;
+    }
+
+    mark(&m);
+    int ret = fluxstat_capture_start(0, 0, 0);
+    if (ret == FLUXSTAT_OK) {
+        ret = fluxstat_capture_wait(cfg.pass_count * 400 + 1000);
+    }
+    report("capture", &m);
+    if (ret == FLUXSTAT_OK) {
+        ret = fluxstat_capture_result(&capture);
+    }
+    if (ret != FLUXSTAT_OK) {
+        fprintf(stderr, "capture failed: %d\n", ret);
+        return 1;
+    }
+    printf("  %u passes, %u flux words (min %u, max %u per pass)\n", capture.pass_count,
+           capture.total_flux, capture.min_flux, capture.max_flux);
+
+    mark(&m);
+    ret = fluxstat_analyze_track(&track);
+    report("analyze_track", &m);
+    if (ret != FLUXSTAT_OK) {
+        fprintf(stderr, "analyze failed: %d\n", ret);
+        return 1;
+    }
+    printf("  sectors %u: %u recovered, %u partial, %u failed, confidence %u%%\n",
+           track.sector_count, track.sectors_recovered, track.sectors_partial,
+           track.sectors_failed, track.overall_confidence);
+
+    mark(&m);
+    uint32_t ok = 0;
+    for (uint8_t s = 0; s < track.sector_count; s++) {
+        if (fluxstat_recover_sector(track.sectors[s].sector_id, &sector) == FLUXSTAT_OK &&
+            sector.crc_ok) {
+            ok++;
+        }
+    }
+    report("recover_sector (all)", &m);
+    printf("  recover_sector CRC ok: %u/%u\n", ok, track.sector_count);
+    return 0;
+}
+
+/*============================================================================
+ * Diagnostics
+ *============================================================================*/
+
+static int cmd_diag(int argc, char **argv)
+{
+    bench_mark_t m;
+    uint32_t count;
+
+    if (argc < 1) {
+        return -1;
+    }
+    if (host_flux_load(0, argv[0]) < 0) {
+        return 1;
+    }
+    const uint32_t *words = host_flux_words(0, &count);
+    int loops = argc > 1 ? atoi(argv[1]) : 10;
+
+    timer_init();
+    diag_init();
+
+    mark(&m);
+    for (int l = 0; l < loops; l++) {
+        for (uint32_t w = 0; w < count; w += 256) {
+            diag_update_flux_block(&words[w], count - w < 256 ? count - w : 256);
+        }
+    }
+    report("diag_update_flux_block", &m);
+    printf("  %llu flux words in blocks of 256\n", (unsigned long long)count * loops);
+    return 0;
+}
+
+/*
+ * Reference decoder over the whole dump, one fdec_decode_pass() per loop
+ */
+static int cmd_decode(int argc, char **argv)
+{
+    fdec_sector_t list[64];
+    fdec_track_t out;
+    bench_mark_t m;
+    uint32_t count;
+
+    if (argc < 1) {
+        return -1;
+    }
+    if (host_flux_load(0, argv[0]) < 0) {
+        return 1;
+    }
+    const uint32_t *words = host_flux_words(0, &count);
+    int loops = argc > 1 ? atoi(argv[1]) : 10;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    mark(&m);
+    for (int l = 0; l < loops; l++) {
+        fdec_track_init(&out, list, 64);
+        fdec_decode_pass(words, count, ENC_MFM, 250000, FDEC_DEFAULT_BW_PM,
+                         FDEC_DEFAULT_DAMPING, &out);
+    }
+    report("fdec_decode_pass", &m);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double s = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("  %u flux words: %u ids (%u bad), %u sectors (%u bad), %u listed\n",
+           count, out.ids, out.bad_ids, out.sectors, out.bad_data, out.count);
+    printf("  %.1f Mtransitions/s (host)\n", s > 0 ? (double)count * loops / s / 1e6 : 0.0);
+    return 0;
+}
+
+/*
+ * Eye diagram accumulation with a waveform capture streaming alongside.
+ * Samples come from the dump's flux intervals: the phase is the residual
+ * against a 1 us (MFM DD) cell grid, the amplitude is synthetic (weaker
+ * off centre), as dumps carry no ADC data.
+ */
+#define EYE_CELL_TICKS  200             /* 1 us in 5 ns ticks */
+#define EYE_BLOCK       256
+#define EYE_POLL_BLOCKS 8               /* Host drains the stream this often */
+
+typedef struct {
+    uint32_t    drains;
+    uint32_t    bytes;              /* Response bytes */
+    uint32_t    pairs;              /* Pairs received */
+    uint32_t    end;                /* Stream offset after the last buffer */
+} eye_stream_t;
+
+static void eye_drain(eye_stream_t *st)
+{
+    static uint8_t rsp[8192];
+    uint32_t len;
+    const diag_waveform_header_t *wf =
+        (const diag_waveform_header_t *)(rsp + sizeof(raw_rsp_header_t));
+
+    diag_cmd_capture_waveform(NULL, rsp, &len);
+    st->drains++;
+    st->bytes += len;
+    st->pairs += wf->sample_count;
+    st->end = wf->trigger_pos + wf->sample_count;
+}
+
+static int cmd_eye(int argc, char **argv)
+{
+    static uint8_t rsp[8192];
+    eye_stream_t st = { 0 };
+    int16_t phase[EYE_BLOCK];
+    uint16_t ampl[EYE_BLOCK];
+    bench_mark_t m;
+    uint32_t count, rsp_len, fed = 0, blocks = 0;
+
+    if (argc < 1) {
+        return -1;
+    }
+    if (host_flux_load(0, argv[0]) < 0) {
+        return 1;
+    }
+    const uint32_t *words = host_flux_words(0, &count);
+    int loops = argc > 1 ? atoi(argv[1]) : 10;
+    uint32_t decim = argc > 2 ? (uint32_t)atoi(argv[2]) : 64;
+    diag_waveform_config_t cfg = {
+        .sample_rate_hz = 1000000 / (decim ? decim : 1),
+        .trigger_source = DIAG_WAVE_TRIG_INDEX,
+    };
+
+    timer_init();
+    diag_init();
+    diag_cmd_capture_waveform(&cfg, rsp, &rsp_len);
+
+    mark(&m);
+    for (int l = 0; l < loops; l++) {
+        uint32_t prev = 0, n = 0;
+        bool have_prev = false;
+
+        for (uint32_t w = 0; w < count; w++) {
+            uint32_t ts = words[w] & FLUX_TIMESTAMP_MASK;
+
+            if (words[w] & FLUX_FLAG_INDEX) {
+                diag_update_index_pulse(200000000);
+                continue;
+            }
+            if (have_prev) {
+                uint32_t dt = (ts - prev) & FLUX_TIMESTAMP_MASK;
+                int32_t r = (int32_t)((dt + EYE_CELL_TICKS / 2) % EYE_CELL_TICKS) -
+                            EYE_CELL_TICKS / 2;
+
+                phase[n] = (int16_t)(r * 32767 / (EYE_CELL_TICKS / 2));
+                ampl[n] = (uint16_t)(1000 - 4 * (r < 0 ? -r : r));
+                if (++n == EYE_BLOCK) {
+                    diag_update_eye_block(phase, ampl, n, 1000000);
+                    fed += n;
+                    n = 0;
+                    if (++blocks % EYE_POLL_BLOCKS == 0) {
+                        eye_drain(&st);
+                    }
+                }
+            }
+            prev = ts;
+            have_prev = true;
+        }
+        diag_update_eye_block(phase, ampl, n, 1000000);
+        fed += n;
+    }
+    report("diag_update_eye_block", &m);
+
+    diag_cmd_get_eye_diagram(rsp, &rsp_len);
+    const diag_eye_header_t *eye =
+        (const diag_eye_header_t *)(rsp + sizeof(raw_rsp_header_t));
+    printf("  %u samples over %u revolutions, peak cell %u, %u rescales, %u clipped\n",
+           eye->samples, eye->revolutions, eye->peak_count, eye->rescales,
+           eye->clipped);
+    eye_drain(&st);
+    printf("  waveform: %u bytes in %u drains for %u source bytes (1/%u), "
+           "%u pairs lost\n", st.bytes, st.drains, fed * 4, decim,
+           st.end - st.pairs);
+    return 0;
+}
+
+/*============================================================================
+ * Greaseweazle Flux Stream
+ *============================================================================*/
+
+static int cmd_gw(int argc, char **argv)
+{
+    static gw_flux_enc_t enc;
+    static gw_flux_dec_t dec;
+    bench_mark_t m;
+    uint32_t count, bytes = 0, decoded = 0, expect = 0, worst = 0;
+
+    if (argc < 1) {
+        return -1;
+    }
+    if (host_flux_load(0, argv[0]) < 0) {
+        return 1;
+    }
+    const uint32_t *words = host_flux_words(0, &count);
+    int loops = argc > 1 ? atoi(argv[1]) : 10;
+
+    uint8_t *stream = malloc((size_t)count * GW_FLUX_MAX_TOKEN + 1);
+    uint32_t *out = malloc((size_t)count * sizeof(uint32_t));
+    if (!stream || !out) {
+        return 1;
+    }
+
+    /* Encode in DMA-chunk sized pieces, as gw_mode does */
+    mark(&m);
+    for (int l = 0; l < loops; l++) {
+        gw_flux_enc_init(&enc, 0, 0, 0);
+        bytes = 0;
+        for (uint32_t w = 0; w < count; w += 1024) {
+            bytes += gw_flux_encode(&enc, &words[w], count - w < 1024 ? count - w : 1024,
+                                    stream + bytes, NULL);
+        }
+    }
+    report("gw_flux_encode", &m);
+    stream[bytes++] = FLUX_STREAM_END;
+    printf("  %u words -> %u bytes (%.2f bytes/word), %u index\n", count, bytes,
+           (double)bytes / count, enc.index_count);
+
+    /* Decode in 64-byte bulk packets, then check against the capture */
+    mark(&m);
+    for (int l = 0; l < loops; l++) {
+        gw_dec_status_t st = GW_DEC_MORE;
+        gw_flux_dec_init(&dec);
+        for (uint32_t b = 0; b < bytes && st == GW_DEC_MORE; b += 64) {
+            st = gw_flux_decode(&dec, stream + b, bytes - b < 64 ? bytes - b : 64,
+                                out, count, NULL);
+        }
+        if (st != GW_DEC_END) {
+            fprintf(stderr, "decode failed: %d\n", st);
+            return 1;
+        }
+    }
+    report("gw_flux_decode", &m);
+
+    uint32_t t0 = FLUX_TIMESTAMP(words[0]), prev = t0;
+    for (uint32_t w = 0; w < count; w++) {
+        uint32_t ts = FLUX_TIMESTAMP(words[w]);
+        if (w == 0 || FLUX_IS_INDEX(words[w]) || FLUX_IS_OVERFLOW(words[w]) ||
+            ((ts - prev) & FLUX_TIMESTAMP_MASK) < GW_FLUX_CLK_DIV / GW_FLUX_TICK_MUL + 1) {
+            continue;
+        }
+        prev = ts;
+        if (decoded >= dec.count) {
+            break;
+        }
+        uint32_t want = (ts - t0) & FLUX_TIMESTAMP_MASK;
+        uint32_t err = (out[decoded++] - want) & FLUX_TIMESTAMP_MASK;
+        if (err > FLUX_TIMESTAMP_MASK / 2) {
+            err = (FLUX_TIMESTAMP_MASK + 1) - err;
+        }
+        if (err > worst) {
+            worst = err;
+        }
+        expect++;
+    }
+    printf("  round trip: %u/%u transitions, worst error %u clocks\n", dec.count, expect, worst);
+    free(stream);
+    free(out);
+    return (dec.count == expect && worst <= GW_FLUX_CLK_DIV / GW_FLUX_TICK_MUL + 1) ? 0 : 1;
+}
+
+/*============================================================================
+ * KryoFlux Stream
+ *============================================================================*/
+
+static uint32_t kf_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static int cmd_kf(int argc, char **argv)
+{
+    static kf_stream_t kfs;
+    bench_mark_t m;
+    uint32_t count, bytes = 0;
+
+    if (argc < 1) {
+        return -1;
+    }
+    if (host_flux_load(0, argv[0]) < 0) {
+        return 1;
+    }
+    const uint32_t *words = host_flux_words(0, &count);
+    int loops = argc > 1 ? atoi(argv[1]) : 10;
+
+    /* Room for 3 bytes per word, as the raw_mode chunk buffers allow */
+    uint32_t cap = count * 3 + KF_HEADER_MAX + KF_TRAILER_MAX + (count / 8191 + 1) * 12;
+    uint8_t *stream = malloc(cap);
+    if (!stream) {
+        return 1;
+    }
+
+    /* Encode in READ_FLUX chunk sized pieces, as raw_mode does */
+    mark(&m);
+    for (int l = 0; l < loops; l++) {
+        kf_stream_init(&kfs);
+        bytes = kf_stream_begin(&kfs, stream);
+        for (uint32_t w = 0; w < count; w += 8191) {
+            uint32_t used, n = count - w < 8191 ? count - w : 8191;
+            bytes += kf_stream_info(&kfs, stream + bytes, w / 1000);
+            bytes += kf_stream_encode(&kfs, &words[w], n, stream + bytes, cap - bytes, &used);
+            if (used != n) {
+                fprintf(stderr, "encode stopped at word %u\n", w + used);
+                return 1;
+            }
+        }
+        bytes += kf_stream_end(&kfs, stream + bytes, KF_RESULT_OK);
+    }
+    report("kf_stream_encode", &m);
+    printf("  %u words -> %u bytes (%.2f bytes/word), %u index\n", count, bytes,
+           (double)bytes / count, kfs.index_count);
+
+    /* Parse it back: positions, cells and index times against the capture */
+    uint32_t pos = 0, cells = 0, bad_pos = 0, index = 0, ovl = 0, expect = 0;
+    uint64_t t = 0, worst = 0;
+    bool eof = false;
+    uint32_t prev = FLUX_TIMESTAMP(words[0]), w = 1;
+    uint64_t clocks = 0;
+
+    for (uint32_t i = 0; i < bytes && !eof;) {
+        uint8_t b = stream[i];
+        uint32_t v;
+
+        if (b == KF_OOB) {
+            uint8_t type = stream[i + 1];
+            uint32_t size = stream[i + 2] | (stream[i + 3] << 8);
+            const uint8_t *d = &stream[i + 4];
+            if (type == KF_OOB_EOF) {
+                eof = true;
+                break;
+            }
+            if ((type == KF_OOB_STREAM_INFO || type == KF_OOB_STREAM_END ||
+                 type == KF_OOB_INDEX) && kf_le32(d) != pos) {
+                bad_pos++;
+            }
+            if (type == KF_OOB_INDEX) {
+                index++;
+            }
+            i += 4 + size;
+            continue;
+        }
+        if (b == KF_OVL16) {
+            ovl += 0x10000;
+            i++;
+            pos++;
+            continue;
+        }
+        if (b >= KF_FLUX1_MIN) {
+            v = b;
+            i += 1;
+            pos += 1;
+        } else if (b <= KF_FLUX2_MAX) {
+            v = ((uint32_t)b << 8) | stream[i + 1];
+            i += 2;
+            pos += 2;
+        } else if (b == KF_FLUX3) {
+            v = ((uint32_t)stream[i + 1] << 8) | stream[i + 2];
+            i += 3;
+            pos += 3;
+        } else {
+            i += b - KF_NOP1 + 1;
+            pos += b - KF_NOP1 + 1;
+            continue;
+        }
+        t += ovl + v;
+        ovl = 0;
+        cells++;
+
+        /* Next transition in the capture (timestamps wrap every 0.67 s) */
+        while (w < count && (FLUX_IS_INDEX(words[w]) || FLUX_IS_OVERFLOW(words[w]))) {
+            clocks += (FLUX_TIMESTAMP(words[w]) - prev) & FLUX_TIMESTAMP_MASK;
+            prev = FLUX_TIMESTAMP(words[w++]);
+        }
+        if (w < count) {
+            clocks += (FLUX_TIMESTAMP(words[w]) - prev) & FLUX_TIMESTAMP_MASK;
+            prev = FLUX_TIMESTAMP(words[w]);
+            uint64_t want = clocks * KF_TICK_MUL / KF_CLK_DIV;
+            uint64_t err = t > want ? t - want : want - t;
+            if (err > worst) {
+                worst = err;
+            }
+            expect++;
+            w++;
+        }
+    }
+
+    printf("  parse: %u cells, %u index, %u bad positions, eof %s, worst error %llu ticks\n",
+           cells, index, bad_pos, eof ? "yes" : "no", (unsigned long long)worst);
+    free(stream);
+    return (eof && bad_pos == 0 && index == kfs.index_count && worst <= 1) ? 0 : 1;
+}
+
+/*============================================================================
+ * MSC / SCSI
+ *============================================================================*/
+
+static int cmd_msc(int argc, char **argv)
+{
+    static uint8_t buf[64 * 1024];
+    bench_mark_t m;
+
+    if (argc < 1) {
+        return -1;
+    }
+    const char *pattern = argc > 1 ? argv[1] : "seq";
+    bool verify = pattern[0] == 'v';
+    int ops = argc > 2 ? atoi(argv[2]) : 256;
+    uint32_t blocks = argc > 3 ? (uint32_t)atoi(argv[3]) : 8;
+    uint8_t lun = 0;
+
+    if (blocks == 0 || blocks > sizeof(buf) / 512) {
+        return -1;
+    }
+    if (host_fdd_attach(0, argv[0], true) != 0) {
+        /* Not a floppy size: serve it as the first hard disk */
+        if (host_hdd_attach(0, argv[0], 0, 0) != 0) {
+            return 1;
+        }
+        lun = MSC_MAX_FDDS;
+    }
+
+    timer_init();
+    msc_hal_init();
+    scsi_handler_init();
+
+    uint32_t last_lba;
+    uint16_t block_size;
+    if (msc_hal_get_capacity(lun, &last_lba, &block_size) != MSC_OK || last_lba < blocks) {
+        fprintf(stderr, "LUN %u not ready\n", lun);
+        return 1;
+    }
+    printf("%s: LUN %u, %u blocks\n", argv[0], lun, last_lba + 1);
+
+    uint32_t span = last_lba + 1 - blocks;
+    uint32_t lba = 0;
+    uint32_t rng = 0x2545F491;
+    uint32_t errors = 0;
+
+    host_drive_stats_reset();
+    prof_reset();
+    mark(&m);
+    for (int op = 0; op < ops; op++) {
+        if (pattern[0] == 'r') {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            lba = rng % (span + 1);
+        } else if (pattern[0] == 'b') {
+            lba = span - (uint32_t)(op * blocks) % (span + 1);
+        } else {
+            lba = (uint32_t)(op * blocks) % (span + 1);
+        }
+
+        uint8_t cdb[10] = { verify ? SCSI_VERIFY_10 : SCSI_READ_10, 0,
+                            lba >> 24, lba >> 16, lba >> 8, lba, 0,
+                            blocks >> 8, blocks, 0 };
+        uint32_t len = sizeof(buf);
+        scsi_result_t result;
+
+        if (scsi_process_command(lun, cdb, sizeof(cdb), buf, &len, &result) != 0 ||
+            result.status != 0) {
+            errors++;
+            continue;
+        }
+        if (result.streamed) {
+            /* Drain the data phase as the bulk-in endpoint would */
+            const uint8_t *chunk;
+            uint32_t n;
+            while ((chunk = scsi_xfer_in_get(&n)) != NULL) {
+                scsi_xfer_in_release();
+            }
+            if (scsi_xfer_finish(&result) != 0) {
+                errors++;
+            }
+        }
+        msc_hal_poll();
+    }
+    report(pattern, &m);
+
+    uint32_t hits, misses;
+    host_drive_stats_t ds;
+    msc_hal_get_cache_stats(&hits, &misses);
+    host_drive_stats(lun >= MSC_MAX_FDDS, 0, &ds);
+    printf("  %d %s x %u blocks, %u errors\n", ops, verify ? "VERIFY(10)" : "READ(10)",
+           blocks, errors);
+    printf("  track cache: %u hits, %u misses\n", hits, misses);
+    printf("  drive: %u reads, %u sectors, %u seeks (%u cylinders), busy %.1f ms\n",
+           ds.reads, ds.sectors_read, ds.seeks, ds.tracks_stepped, ds.busy_us / 1000.0);
+
+    /* Firmware zones, in virtual CPU cycles (drive time included) */
+    prof_stats_t zones[PROF_ZONES];
+    prof_snapshot(zones);
+    for (int i = 0; i < PROF_ZONES; i++) {
+        if (zones[i].calls) {
+            printf("  prof %-9s %6u calls, min/avg/max %u / %llu / %u cycles\n",
+                   prof_zone_name((prof_zone_t)i), zones[i].calls, zones[i].min,
+                   (unsigned long long)(zones[i].total / zones[i].calls), zones[i].max);
+        }
+    }
+    return 0;
+}
+
+/*============================================================================
+ * Recovery Benchmark
+ *
+ * Replays a corpus of degraded multipass captures through the Bit Healer
+ * path (adaptive capture, fluxstat_analyze_track, fluxstat_recover_sector,
+ * a full fluxstat_get_bit_analysis sweep) and reports recovery rate,
+ * passes used and host cost per bitcell of analysis and recovery (the
+ * capture itself is timed by the virtual clock). Synthetic tracks check the
+ * recovered bytes, so a CRC-passing miscorrection counts as a failure, and
+ * a sector with bits flipped on most revolutions has to come back through
+ * CRC correction.
+ *============================================================================*/
+
+#define SYN_JITTER          (FDC_FREQ_HZ / (2 * FLUX_SYNTH_RATE) / 20)
+#define RECOVERY_SEEDS      3
+#define RECOVERY_BIT_CHUNK  1024
+
+typedef struct {
+    const char   *name;
+    flux_synth_t  p;
+} recovery_case_t;
+
+static const recovery_case_t corpus[] = {
+    { "clean",    { .jitter = SYN_JITTER } },
+    { "noise",    { .jitter = SYN_JITTER * 4 } },
+    { "weak",     { .jitter = SYN_JITTER, .weak_sector = 2, .weak_bytes = 8 } },
+    { "drift",    { .jitter = SYN_JITTER, .speed_ppm = 15000, .drift_ppm = 10000 } },
+    { "dropout",  { .jitter = SYN_JITTER, .dropout_sector = 3, .dropout_bytes = 16,
+                    .dropout_pct = 50 } },
+    { "combined", { .jitter = SYN_JITTER * 2, .speed_ppm = -10000, .drift_ppm = 5000,
+                    .weak_sector = 1, .weak_bytes = 4, .dropout_sector = 4,
+                    .dropout_bytes = 8, .dropout_pct = 30 } },
+    { "flip1",    { .jitter = SYN_JITTER, .flip_sector = 5, .flip_bits = 1 } },
+    { "flip2",    { .jitter = SYN_JITTER, .flip_sector = 6, .flip_bits = 2 } },
+    { "flip3",    { .jitter = SYN_JITTER, .flip_sector = 7, .flip_bits = 3 } },
+};
+
+typedef struct {
+    uint32_t tracks;
+    uint32_t passes;
+    uint32_t found;
+    uint32_t crc_ok;
+    uint32_t correct;
+    uint32_t wrong;                 /* CRC ok, data differs */
+    uint32_t unfixed;               /* Flipped sector not corrected */
+    uint64_t cells;
+    uint64_t cells_swept;
+    uint64_t tsc;
+    uint64_t tsc_sweep;
+    double   host_us;
+} recovery_total_t;
+
+static double elapsed_us(const struct timespec *a)
+{
+    struct timespec b;
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    return (b.tv_sec - a->tv_sec) * 1e6 + (b.tv_nsec - a->tv_nsec) / 1e3;
+}
+
+/**
+ * Bitcells from the index mark to the last transition of a pass
+ */
+static uint32_t pass_cells(uint8_t pass, uint32_t cell_ticks)
+{
+    uint32_t addr, size;
+
+    if (fluxstat_get_pass_data(pass, &addr, &size) != FLUXSTAT_OK || size < 8) {
+        return 0;
+    }
+    const uint32_t *w = (const uint32_t *)(uintptr_t)addr;
+    uint32_t span = (FLUX_TIMESTAMP(w[size / 4 - 1]) - FLUX_TIMESTAMP(w[0])) &
+                    FLUX_TIMESTAMP_MASK;
+    return span / cell_ticks;
+}
+
+/**
+ * Run one capture through the recovery pipeline
+ * @param syn   Synthesis parameters to check recovered data against
+ *              flux_synth_sector_data(), NULL for a real capture
+ */
+static int recovery_run(const char *name, uint32_t seed, const flux_synth_t *syn,
+                        recovery_total_t *tot)
+{
+    bool synthetic = syn != NULL;
+    bool fixed = false;
+    static fluxstat_capture_t capture;
+    static fluxstat_track_t track;
+    static fluxstat_sector_t sector;
+    static fluxstat_bit_t bits[RECOVERY_BIT_CHUNK];
+    uint8_t expect[FLUX_SYNTH_SECTOR_SIZE];
+    struct timespec t0;
+    uint32_t cell_ticks = FDC_FREQ_HZ / (2 * FLUX_SYNTH_RATE);
+
+    /* Capture (with adaptive stop) runs against the shim's virtual clock */
+    int ret = fluxstat_capture_start(0, 0, 0);
+    if (ret == FLUXSTAT_OK) {
+        ret = fluxstat_capture_wait(FLUXSTAT_MAX_PASSES * 400);
+    }
+    if (ret == FLUXSTAT_OK) {
+        ret = fluxstat_capture_result(&capture);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    uint64_t tsc0 = bench_tsc();
+    if (ret == FLUXSTAT_OK) {
+        ret = fluxstat_analyze_track(&track);
+    }
+    if (ret != FLUXSTAT_OK) {
+        printf("  %-9s %5u  failed: %d\n", name, seed, ret);
+        tot->tracks++;
+        return ret;
+    }
+
+    uint32_t crc_ok = 0, correct = 0, wrong = 0, weak = 0, corrected = 0;
+    for (uint8_t s = 0; s < track.sector_count; s++) {
+        uint8_t r = track.sectors[s].sector_id;
+        if (fluxstat_recover_sector(r, &sector) != FLUXSTAT_OK) {
+            continue;
+        }
+        weak += sector.weak_bit_count;
+        corrected += sector.corrected_count;
+        if (!sector.crc_ok) {
+            continue;
+        }
+        crc_ok++;
+        if (synthetic) {
+            flux_synth_sector_data(r, expect);
+            if (sector.size == sizeof(expect) && memcmp(sector.data, expect, sizeof(expect)) == 0) {
+                correct++;
+                if (r == syn->flip_sector && sector.corrected_count > 0) {
+                    fixed = true;
+                }
+            } else {
+                wrong++;
+            }
+        }
+    }
+    if (synthetic && syn->flip_sector && !fixed) {
+        tot->unfixed++;
+    }
+    uint64_t tsc1 = bench_tsc();
+    double pipe_us = elapsed_us(&t0);
+
+    /* Bitcells examined: every pass up to its last transition */
+    uint64_t cells = 0;
+    for (uint8_t p = 0; p < capture.pass_count; p++) {
+        cells += pass_cells(p, cell_ticks);
+    }
+
+    /* Full-track bit analysis sweep over the cells all passes cover */
+    uint32_t sweep = pass_cells(0, cell_ticks);
+    uint64_t tsc2 = bench_tsc();
+    for (uint32_t b = 0; b + RECOVERY_BIT_CHUNK <= sweep; b += RECOVERY_BIT_CHUNK) {
+        if (fluxstat_get_bit_analysis(b, RECOVERY_BIT_CHUNK, bits) != FLUXSTAT_OK) {
+            break;
+        }
+    }
+    uint64_t tsc3 = bench_tsc();
+
+    printf("  %-9s %5u %6u %5u %6u", name, seed, capture.pass_count, track.sector_count, crc_ok);
+    if (synthetic) {
+        printf(" %7u %5u", correct, wrong);
+    } else {
+        printf(" %7s %5s", "-", "-");
+    }
+    printf(" %5u %5u %9.2f %8.1f %8.1f\n", weak, corrected, pipe_us / 1000.0,
+           cells ? (double)(tsc1 - tsc0) / cells : 0.0,
+           sweep ? (double)(tsc3 - tsc2) / sweep : 0.0);
+
+    tot->tracks++;
+    tot->passes += capture.pass_count;
+    tot->found += track.sector_count;
+    tot->crc_ok += crc_ok;
+    tot->correct += correct;
+    tot->wrong += wrong;
+    tot->cells += cells;
+    tot->cells_swept += sweep;
+    tot->tsc += tsc1 - tsc0;
+    tot->tsc_sweep += tsc3 - tsc2;
+    tot->host_us += pipe_us;
+    return FLUXSTAT_OK;
+}
+
+static int cmd_recovery(int argc, char **argv)
+{
+    recovery_total_t tot = { 0 };
+    int max_passes = argc > 0 ? atoi(argv[0]) : 16;
+
+    if (max_passes < FLUXSTAT_MIN_PASSES || max_passes > FLUXSTAT_MAX_PASSES) {
+        return -1;
+    }
+
+    timer_init();
+    fluxstat_init();
+
+    fluxstat_config_t cfg;
+    fluxstat_get_config(&cfg);
+    cfg.pass_count = (uint8_t)max_passes;
+    cfg.encoding = ENC_MFM;
+    cfg.data_rate = FLUX_SYNTH_RATE;
+    cfg.adaptive = true;
+    if (fluxstat_configure(&cfg) != FLUXSTAT_OK) {
+        fprintf(stderr, "fluxstat_configure failed\n");
+        return 1;
+    }
+
+    printf("Recovery benchmark: up to %d passes, adaptive stop after %u\n",
+           max_passes, cfg.adaptive_stall);
+    printf("  %-9s %5s %6s %5s %6s %7s %5s %5s %5s %9s %8s %8s\n", "case", "seed",
+           "passes", "found", "crc_ok", "correct", "wrong", "weak", "fixed", "ms",
+           "cyc/cell", "sweep");
+
+    for (size_t c = 0; c < ARRAY_SIZE(corpus); c++) {
+        for (uint32_t k = 0; k < RECOVERY_SEEDS; k++) {
+            flux_synth_t p = corpus[c].p;
+            uint32_t *words;
+            uint32_t count;
+
+            p.seed = 1 + k * 7919;
+            if (flux_synth_track(&p, (uint8_t)max_passes, &words, &count) != 0 ||
+                host_flux_load_words(0, words, count) < 0) {
+                return 1;
+            }
+            free(words);
+            recovery_run(corpus[c].name, p.seed, &p, &tot);
+        }
+    }
+
+    /* Real captures from the command line */
+    for (int a = 1; a < argc; a++) {
+        if (host_flux_load(0, argv[a]) < 0) {
+            return 1;
+        }
+        const char *base = strrchr(argv[a], '/');
+        recovery_run(base ? base + 1 : argv[a], 0, NULL, &tot);
+    }
+
+    printf("\n  tracks %u, %.1f tracks/s (host)\n", tot.tracks,
+           tot.host_us > 0 ? tot.tracks * 1e6 / tot.host_us : 0.0);
+    printf("  sectors: %u found, %u CRC ok, %u verified, %u miscorrected\n",
+           tot.found, tot.crc_ok, tot.correct, tot.wrong);
+    printf("  flipped sectors left uncorrected: %u\n", tot.unfixed);
+    printf("  passes: %.1f mean\n", tot.tracks ? (double)tot.passes / tot.tracks : 0.0);
+    printf("  host cycles/bitcell: %.1f pipeline, %.1f bit analysis sweep\n",
+           tot.cells ? (double)tot.tsc / tot.cells : 0.0,
+           tot.cells_swept ? (double)tot.tsc_sweep / tot.cells_swept : 0.0);
+
+    /* A CRC-passing wrong sector is worse than a failed one */
+    return (tot.wrong || tot.unfixed) ? 1 : 0;
+}
+
+/*============================================================================
+ * PLL Search
+ *
+ * Runs pllcal_calibrate_track() on the recovery corpus (and any dumps
+ * given) and prints the sectors each grid point recovered, bandwidth
+ * across and damping down, with the winner and its phase error.
+ *============================================================================*/
+
+static void pll_run(const char *name, bool table)
+{
+    static pllcal_results_t res;
+    bench_mark_t m;
+
+    mark(&m);
+    int ret = pllcal_calibrate_track(0, 0, 0, &res);
+    if (ret != FLUXSTAT_OK) {
+        printf("  %-9s failed: %d\n", name, ret);
+        return;
+    }
+
+    uint32_t best = pllcal_best(&res);
+    const pllcal_result_t *b = &res.cand[best];
+    uint32_t worst = b->sectors;
+    for (uint32_t c = 0; c < PLLCAL_CANDIDATES; c++) {
+        if (res.cand[c].sectors < worst) {
+            worst = res.cand[c].sectors;
+        }
+    }
+    printf("  %-9s best bw %2u damp %3u: %3u sectors (worst %u), %3u ids in %u passes, "
+           "rms %u/256\n", name, b->bandwidth_pm, b->damping, b->sectors, worst,
+           b->ids, res.passes, b->phase_rms);
+
+    if (table) {
+        printf("  %9s", "damp\\bw");
+        for (uint32_t i = 0; i < PLLCAL_BW_STEPS; i++) {
+            printf(" %5u", res.cand[i * PLLCAL_DAMP_STEPS].bandwidth_pm);
+        }
+        printf("\n");
+        for (uint32_t d = 0; d < PLLCAL_DAMP_STEPS; d++) {
+            printf("  %9u", res.cand[d].damping);
+            for (uint32_t i = 0; i < PLLCAL_BW_STEPS; i++) {
+                printf(" %5u", res.cand[i * PLLCAL_DAMP_STEPS + d].sectors);
+            }
+            printf("\n");
+        }
+    }
+    report("capture + sweep", &m);
+}
+
+static int cmd_pll(int argc, char **argv)
+{
+    int passes = argc > 0 ? atoi(argv[0]) : 4;
+
+    if (passes < 1 || passes > FLUXSTAT_MAX_PASSES) {
+        return -1;
+    }
+
+    timer_init();
+    fluxstat_init();
+
+    fluxstat_config_t cfg;
+    fluxstat_get_config(&cfg);
+    cfg.pass_count = (uint8_t)passes;
+    cfg.encoding = ENC_MFM;
+    cfg.data_rate = FLUX_SYNTH_RATE;
+    cfg.adaptive = false;
+    if (fluxstat_configure(&cfg) != FLUXSTAT_OK) {
+        fprintf(stderr, "fluxstat_configure failed\n");
+        return 1;
+    }
+
+    printf("PLL search: %d candidates, %d passes\n", PLLCAL_CANDIDATES, passes);
+    for (size_t c = 0; c < ARRAY_SIZE(corpus); c++) {
+        flux_synth_t p = corpus[c].p;
+        uint32_t *words;
+        uint32_t count;
+
+        p.seed = 1;
+        if (flux_synth_track(&p, (uint8_t)passes, &words, &count) != 0 ||
+            host_flux_load_words(0, words, count) < 0) {
+            return 1;
+        }
+        free(words);
+        pll_run(corpus[c].name, true);
+    }
+
+    for (int a = 1; a < argc; a++) {
+        if (host_flux_load(0, argv[a]) < 0) {
+            return 1;
+        }
+        const char *base = strrchr(argv[a], '/');
+        pll_run(base ? base + 1 : argv[a], true);
+    }
+    return 0;
+}
+
+/*============================================================================
+ * Format Cache
+ *
+ * Identifies the same captured track repeatedly, once as a session
+ * (probe on the first track, prediction after that) and once with the
+ * session reset before every track (a full probe each time).
+ *============================================================================*/
+
+static void format_run(const char *name, int tracks)
+{
+    static fluxstat_capture_t cap;
+    fmtc_format_t fmt;
+    fmtc_stats_t st;
+
+    if (fluxstat_capture_start(0, 0, 0) != FLUXSTAT_OK ||
+        fluxstat_capture_wait(8000) != FLUXSTAT_OK ||
+        fluxstat_capture_result(&cap) != FLUXSTAT_OK) {
+        printf("  %-9s capture failed\n", name);
+        return;
+    }
+    const uint32_t *words = (const uint32_t *)(uintptr_t)cap.passes[0].base_addr;
+    uint32_t count = cap.passes[0].flux_count;
+
+    for (int mode = 0; mode < 2; mode++) {
+        uint32_t hits = 0, probes = 0, found = 0;
+        struct timespec t0, t1;
+
+        fmtc_reset(FMTC_ALL_DRIVES);
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int t = 0; t < tracks; t++) {
+            if (mode == 1) {
+                fmtc_reset(0);
+            }
+            if (fmtc_identify(0, words, count, &fmt) == FLUXSTAT_OK) {
+                found++;
+            }
+            fmtc_get_stats(0, &st);
+            if (mode == 1 || t == tracks - 1) {
+                hits += st.hits;
+                probes += st.probes;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        double us = (t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3;
+        if (mode == 0) {
+            printf("  %-9s enc %u rate %6u: sectors %u-%u (%u), N %u\n", name,
+                   fmt.encoding, fmt.data_rate, fmt.first_sector, fmt.last_sector,
+                   fmt.sectors, fmt.size_code);
+        }
+        printf("  %-9s %-10s %2u/%d identified, %2u hits, %2u probes, %8.1f us/track (host)\n",
+               "", mode == 0 ? "session" : "probe all", found, tracks, hits, probes,
+               us / tracks);
+    }
+}
+
+static int cmd_format(int argc, char **argv)
+{
+    int tracks = argc > 0 ? atoi(argv[0]) : 8;
+
+    if (tracks < 1) {
+        return -1;
+    }
+
+    timer_init();
+    fluxstat_init();
+
+    fluxstat_config_t cfg;
+    fluxstat_get_config(&cfg);
+    cfg.pass_count = 2;
+    cfg.encoding = ENC_UNKNOWN;
+    cfg.data_rate = 0;
+    cfg.adaptive = false;
+    if (fluxstat_configure(&cfg) != FLUXSTAT_OK) {
+        fprintf(stderr, "fluxstat_configure failed\n");
+        return 1;
+    }
+
+    printf("Format cache: %d tracks, automatic encoding\n", tracks);
+    for (size_t c = 0; c < ARRAY_SIZE(corpus); c++) {
+        flux_synth_t p = corpus[c].p;
+        uint32_t *words;
+        uint32_t count;
+
+        p.seed = 1;
+        if (flux_synth_track(&p, 2, &words, &count) != 0 ||
+            host_flux_load_words(0, words, count) < 0) {
+            return 1;
+        }
+        free(words);
+        format_run(corpus[c].name, tracks);
+    }
+
+    for (int a = 1; a < argc; a++) {
+        if (host_flux_load(0, argv[a]) < 0) {
+            return 1;
+        }
+        const char *base = strrchr(argv[a], '/');
+        format_run(base ? base + 1 : argv[a], tracks);
+    }
+    return 0;
+}
+
+/*============================================================================
+ * Write Precompensation
+ *
+ * Sweeps the precompensation settings over a synthetic drive whose
+ * uncompensated write shifts each transition by the given amount: every
+ * setting's track carries the residual shift (negative once the setting
+ * overcompensates), which the histogram measurement has to find.
+ *============================================================================*/
+
+static int cmd_precomp(int argc, char **argv)
+{
+    static const uint8_t codes[PCAL_SETTINGS] = {
+        PRECOMP_OFF, PRECOMP_41NS, PRECOMP_83NS, PRECOMP_125NS,
+        PRECOMP_167NS, PRECOMP_208NS, PRECOMP_250NS
+    };
+    static fdec_sector_t list[32];
+    static pcal_results_t results;
+    static pcal_hist_t hist;
+    int shift_ns = argc > 0 ? atoi(argv[0]) : 150;
+
+    if (shift_ns < 0 || shift_ns > 400) {
+        return -1;
+    }
+
+    memset(&results, 0, sizeof(results));
+    results.cell_ticks = fdec_cell_ticks(ENC_MFM, FLUX_SYNTH_RATE);
+    results.sectors = FLUX_SYNTH_SPT;
+
+    printf("Precompensation sweep: drive peak shift %d ns\n", shift_ns);
+    printf("  Precomp  Residual  Sectors  2T shift  4T shift (1/256 cell)\n");
+    for (uint32_t c = 0; c < PCAL_SETTINGS; c++) {
+        pcal_result_t *r = &results.cand[c];
+        flux_synth_t p = { .seed = 1, .jitter = SYN_JITTER };
+        fdec_track_t out;
+        uint32_t *words;
+        uint32_t count;
+
+        r->code = codes[c];
+        r->precomp_ns = pcal_precomp_ns(r->code, FLUX_SYNTH_RATE);
+        p.peak_shift = (shift_ns - (int32_t)r->precomp_ns) * (int32_t)(FDC_FREQ_HZ / 1000000) / 1000;
+        if (flux_synth_track(&p, 2, &words, &count) != 0) {
+            return 1;
+        }
+
+        memset(&hist, 0, sizeof(hist));
+        pcal_histogram(words, count, results.cell_ticks, &hist);
+        pcal_measure(&hist, r);
+
+        fdec_track_init(&out, list, ARRAY_SIZE(list));
+        fdec_decode_pass(words, count, ENC_MFM, FLUX_SYNTH_RATE, FDEC_DEFAULT_BW_PM,
+                         FDEC_DEFAULT_DAMPING, &out);
+        r->sectors = (uint8_t)out.sectors;
+        free(words);
+
+        printf("  %4u ns  %5d ns  %7u  %8d  %8d\n", r->precomp_ns,
+               shift_ns - (int)r->precomp_ns, (unsigned)r->sectors, r->shift2, r->shift4);
+    }
+
+    uint32_t best = pcal_best(&results);
+    printf("  best: %u ns (code %u)\n", results.cand[best].precomp_ns,
+           results.cand[best].code);
+    return 0;
+}
+
+/*============================================================================
+ * Main
+ *============================================================================*/
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: fw_bench flux  <dump> [passes]\n"
+            "       fw_bench diag  <dump> [loops]\n"
+            "       fw_bench decode <dump> [loops]\n"
+            "       fw_bench eye   <dump> [loops] [decim]\n"
+            "       fw_bench gw    <dump> [loops]\n"
+            "       fw_bench kf    <dump> [loops]\n"
+            "       fw_bench msc   <image> [seq|rand|back] [ops] [blocks]\n"
+            "       fw_bench recovery [passes] [dump...]\n"
+            "       fw_bench pll   [passes] [dump...]\n"
+            "       fw_bench format [tracks] [dump...]\n"
+            "       fw_bench precomp [shift ns]\n"
+            "       fw_bench synth <dump> [revs] [weak sector]\n");
+}
+
+int main(int argc, char **argv)
+{
+    int ret = -1;
+
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    if (host_shim_init() != 0) {
+        return 1;
+    }
+
+    if (strcmp(argv[1], "flux") == 0) {
+        ret = cmd_flux(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "diag") == 0) {
+        ret = cmd_diag(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "decode") == 0) {
+        ret = cmd_decode(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "eye") == 0) {
+        ret = cmd_eye(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "gw") == 0) {
+        ret = cmd_gw(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "kf") == 0) {
+        ret = cmd_kf(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "msc") == 0) {
+        ret = cmd_msc(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "recovery") == 0) {
+        ret = cmd_recovery(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "pll") == 0) {
+        ret = cmd_pll(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "format") == 0) {
+        ret = cmd_format(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "precomp") == 0) {
+        ret = cmd_precomp(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "synth") == 0) {
+        ret = cmd_synth(argc - 2, argv + 2);
+    }
+
+    if (ret < 0) {
+        usage();
+        return 2;
+    }
+    return ret;
+}
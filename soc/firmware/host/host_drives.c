@@ -0,0 +1,615 @@
+/**
+ * FluxRipper SoC - Host Drive Models
+ *
+ * Serves the fluxripper_hal and hdd_hal drive entry points used by the
+ * MSC/SCSI path from raw image files. Each drive keeps a head position,
+ * motor state and spindle phase against the shim's virtual clock, so
+ * seeks, spin-up and rotational latency cost what they would on the
+ * drive and cache or read-ahead changes show up in the timings.
+ *
+ * Created: 2025-12-08 20:30
+ */
+
+#include "host_shim.h"
+#include "fluxripper_hal.h"
+#include "hdd_hal.h"
+#include "hdd_metadata.h"
+#include "spinup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Floppy timing */
+#define FDD_STEP_US         3000    /* Step rate */
+#define FDD_SPINUP_US       300000  /* Motor on to stable index */
+
+/* ST-506 timing */
+#define HDD_RPM             3600
+#define HDD_SEEK_BASE_US    3000    /* Track-to-track */
+#define HDD_SEEK_PER_CYL_US 100
+#define HDD_SEEK_MAX_US     85000
+
+typedef struct {
+    uint8_t            *data;
+    uint32_t            sectors;
+    char                path[256];
+    bool                dirty;
+
+    uint16_t            cylinders;
+    uint8_t             heads;
+    uint8_t             spt;
+    uint32_t            rev_us;
+
+    uint16_t            cyl;        /* Head position */
+    bool                motor;
+    uint16_t            seek_target;
+    uint64_t            seek_done;  /* Cycle the pending seek settles */
+    bool                seeking;
+
+    bool                write_protect;
+    drive_profile_t     profile;
+    host_drive_stats_t  stats;
+} host_drive_t;
+
+static host_drive_t fdd[HOST_FDDS];
+static host_drive_t hdd[HOST_HDDS];
+static uint8_t      fdd_precomp[HOST_FDDS][HAL_PRECOMP_ZONES];
+
+#define CYCLES_PER_US   (CPU_FREQ_HZ / 1000000)
+
+/*============================================================================
+ * Common
+ *============================================================================*/
+
+static void drive_wait(host_drive_t *d, uint32_t us)
+{
+    host_advance_us(us);
+    d->stats.busy_us += us;
+}
+
+static int load_image(host_drive_t *d, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0 || (size % 512) != 0) {
+        fprintf(stderr, "%s: size is not a whole number of sectors\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    free(d->data);
+    d->data = malloc((size_t)size);
+    if (!d->data || fread(d->data, 1, (size_t)size, f) != (size_t)size) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    d->sectors = (uint32_t)(size / 512);
+    snprintf(d->path, sizeof(d->path), "%s", path);
+    d->dirty = false;
+    d->cyl = 0;
+    d->motor = false;
+    d->seeking = false;
+    memset(&d->stats, 0, sizeof(d->stats));
+    return 0;
+}
+
+/**
+ * Wait out a pending seek
+ */
+static void seek_settle(host_drive_t *d)
+{
+    if (d->seeking) {
+        uint64_t now = host_cycles();
+        if (d->seek_done > now) {
+            drive_wait(d, (uint32_t)((d->seek_done - now) / CYCLES_PER_US));
+        }
+        d->cyl = d->seek_target;
+        d->seeking = false;
+    }
+}
+
+static void seek_start(host_drive_t *d, uint16_t cyl, uint32_t us)
+{
+    seek_settle(d);
+    if (cyl != d->cyl) {
+        d->stats.seeks++;
+        d->stats.tracks_stepped += (cyl > d->cyl) ? cyl - d->cyl : d->cyl - cyl;
+    }
+    d->seek_target = cyl;
+    d->seek_done = host_cycles() + (uint64_t)us * CYCLES_PER_US;
+    d->seeking = true;
+}
+
+/**
+ * Rotate to a sector and read or write a run of it on one track side
+ * Spindle phase is taken from the virtual clock.
+ */
+static void track_transfer(host_drive_t *d, uint8_t first, uint8_t count)
+{
+    uint64_t rev = (uint64_t)d->rev_us * CYCLES_PER_US;
+    uint64_t phase = host_cycles() % rev;
+    uint64_t target = rev * first / d->spt;
+    uint64_t wait = (target + rev - phase) % rev;
+
+    drive_wait(d, (uint32_t)((wait + rev * count / d->spt) / CYCLES_PER_US));
+}
+
+/**
+ * Split an LBA run into track sides and move the data
+ * With neither rd nor wr the run is only passed over (verify).
+ */
+static int lba_transfer(host_drive_t *d, uint32_t lba, uint8_t *rd, const uint8_t *wr,
+                        uint32_t count, uint32_t (*seek_us)(host_drive_t *, uint16_t))
+{
+    if (!d->data) {
+        return HAL_ERR_NO_DISK;
+    }
+    if (count == 0 || lba >= d->sectors || count > d->sectors - lba) {
+        return HAL_ERR_INVALID;
+    }
+
+    while (count > 0) {
+        uint32_t track = lba / d->spt;
+        uint16_t cyl = (uint16_t)(track / d->heads);
+        uint8_t sector = (uint8_t)(lba % d->spt);
+        uint32_t run = d->spt - sector;
+        if (run > count) {
+            run = count;
+        }
+
+        seek_settle(d);
+        if (cyl != d->cyl) {
+            seek_start(d, cyl, seek_us(d, cyl));
+            seek_settle(d);
+        }
+        track_transfer(d, sector, (uint8_t)run);
+
+        if (rd) {
+            memcpy(rd, d->data + (size_t)lba * 512, run * 512);
+            rd += run * 512;
+            d->stats.sectors_read += run;
+        } else if (wr) {
+            memcpy(d->data + (size_t)lba * 512, wr, run * 512);
+            wr += run * 512;
+            d->stats.sectors_written += run;
+            d->dirty = true;
+        } else {
+            d->stats.sectors_read += run;
+        }
+        lba += run;
+        count -= run;
+    }
+    return HAL_OK;
+}
+
+/*============================================================================
+ * Floppy (fluxripper_hal.h)
+ *============================================================================*/
+
+static const struct {
+    uint32_t sectors;
+    uint8_t  tracks;
+    uint8_t  spt;
+    uint8_t  form_factor;
+    uint8_t  density;
+    uint16_t rpm;
+} fdd_formats[] = {
+    {  720, 40,  9, FF_5_25, DENS_DD, 300 },
+    { 1440, 80,  9, FF_3_5,  DENS_DD, 300 },
+    { 2400, 80, 15, FF_5_25, DENS_HD, 360 },
+    { 2880, 80, 18, FF_3_5,  DENS_HD, 300 },
+    { 5760, 80, 36, FF_3_5,  DENS_ED, 300 },
+};
+
+static uint32_t fdd_seek_us(host_drive_t *d, uint16_t cyl)
+{
+    uint32_t dist = (cyl > d->cyl) ? cyl - d->cyl : d->cyl - cyl;
+    return dist ? dist * FDD_STEP_US + SEEK_SETTLE_MS * 1000 : 0;
+}
+
+static host_drive_t *fdd_get(uint8_t drive)
+{
+    return (drive < HOST_FDDS && fdd[drive].data) ? &fdd[drive] : NULL;
+}
+
+static void fdd_spin_up(host_drive_t *d)
+{
+    if (!d->motor) {
+        d->motor = true;
+        drive_wait(d, FDD_SPINUP_US);
+    }
+}
+
+int host_fdd_attach(uint8_t drive, const char *path, bool write_protect)
+{
+    if (drive >= HOST_FDDS) {
+        return -1;
+    }
+
+    host_drive_t *d = &fdd[drive];
+    if (load_image(d, path) != 0) {
+        return -1;
+    }
+
+    for (size_t f = 0; f < ARRAY_SIZE(fdd_formats); f++) {
+        if (fdd_formats[f].sectors == d->sectors) {
+            d->cylinders = fdd_formats[f].tracks;
+            d->heads = 2;
+            d->spt = fdd_formats[f].spt;
+            d->rev_us = 60000000u / fdd_formats[f].rpm;
+            d->write_protect = write_protect;
+
+            memset(&d->profile, 0, sizeof(d->profile));
+            d->profile.form_factor = fdd_formats[f].form_factor;
+            d->profile.density = fdd_formats[f].density;
+            d->profile.tracks = fdd_formats[f].tracks;
+            d->profile.encoding = ENC_MFM;
+            d->profile.rpm = fdd_formats[f].rpm;
+            d->profile.quality = 200;
+            d->profile.valid = true;
+            d->profile.locked = true;
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "%s: %u sectors is not a known floppy format\n", path, d->sectors);
+    free(d->data);
+    d->data = NULL;
+    return -1;
+}
+
+hal_mode_t hal_get_mode(uint8_t drive)
+{
+    return fdd_get(drive) ? MODE_FDC : MODE_IDLE;
+}
+
+uint8_t hal_get_track(uint8_t drive)
+{
+    host_drive_t *d = fdd_get(drive);
+    return d ? (uint8_t)d->cyl : 0;
+}
+
+int hal_get_profile(uint8_t drive, drive_profile_t *profile)
+{
+    host_drive_t *d = fdd_get(drive);
+    if (!d || !profile) {
+        return HAL_ERR_INVALID;
+    }
+    *profile = d->profile;
+    return HAL_OK;
+}
+
+bool hal_disk_present(uint8_t drive)
+{
+    return fdd_get(drive) != NULL;
+}
+
+bool hal_write_protected(uint8_t drive)
+{
+    host_drive_t *d = fdd_get(drive);
+    return d ? d->write_protect : false;
+}
+
+int hal_motor_on(uint8_t drive)
+{
+    if (drive >= HOST_FDDS) {
+        return HAL_ERR_INVALID;
+    }
+    /* Drives without an image still spin (flux replay needs no image) */
+    fdd_spin_up(&fdd[drive]);
+    return HAL_OK;
+}
+
+int hal_motor_off(uint8_t drive)
+{
+    if (drive >= HOST_FDDS) {
+        return HAL_ERR_INVALID;
+    }
+    fdd[drive].motor = false;
+    return HAL_OK;
+}
+
+/* No idle timeout on the bench: a released motor keeps spinning */
+int hal_motor_release(uint8_t drive)
+{
+    return (drive < HOST_FDDS) ? HAL_OK : HAL_ERR_INVALID;
+}
+
+int hal_seek_start(uint8_t drive, uint8_t track)
+{
+    if (drive >= HOST_FDDS) {
+        return HAL_ERR_INVALID;
+    }
+    host_drive_t *d = &fdd[drive];
+    seek_start(d, track, fdd_seek_us(d, track));
+    return HAL_OK;
+}
+
+int hal_seek_poll(uint8_t drive)
+{
+    if (drive >= HOST_FDDS) {
+        return HAL_ERR_INVALID;
+    }
+    host_drive_t *d = &fdd[drive];
+    if (d->seeking && host_cycles() < d->seek_done) {
+        return HAL_ERR_BUSY;
+    }
+    seek_settle(d);
+    return HAL_OK;
+}
+
+int hal_seek(uint8_t drive, uint8_t track)
+{
+    int ret = hal_seek_start(drive, track);
+    if (ret == HAL_OK) {
+        seek_settle(&fdd[drive]);
+    }
+    return ret;
+}
+
+int hal_read_sectors(uint8_t drive, uint32_t lba, void *buf, uint32_t count)
+{
+    host_drive_t *d = fdd_get(drive);
+    if (!d) {
+        return HAL_ERR_NO_DISK;
+    }
+    fdd_spin_up(d);
+    d->stats.reads++;
+    return lba_transfer(d, lba, buf, NULL, count, fdd_seek_us);
+}
+
+int hal_verify_sectors(uint8_t drive, uint32_t lba, uint32_t count, uint32_t *bad_lba)
+{
+    host_drive_t *d = fdd_get(drive);
+    (void)bad_lba;
+    if (!d) {
+        return HAL_ERR_NO_DISK;
+    }
+    fdd_spin_up(d);
+    d->stats.reads++;
+    return lba_transfer(d, lba, NULL, NULL, count, fdd_seek_us);
+}
+
+int hal_write_sectors(uint8_t drive, uint32_t lba, const void *buf, uint32_t count)
+{
+    host_drive_t *d = fdd_get(drive);
+    if (!d) {
+        return HAL_ERR_NO_DISK;
+    }
+    if (d->write_protect) {
+        return HAL_ERR_WRITE_PROT;
+    }
+    fdd_spin_up(d);
+    d->stats.writes++;
+    return lba_transfer(d, lba, NULL, buf, count, fdd_seek_us);
+}
+
+int hal_set_write_precomp(uint8_t drive, uint8_t zone, uint8_t code)
+{
+    if (drive >= HOST_FDDS || zone >= HAL_PRECOMP_ZONES || code > PRECOMP_OFF) {
+        return HAL_ERR_INVALID;
+    }
+    fdd_precomp[drive][zone] = code;
+    return HAL_OK;
+}
+
+uint8_t hal_get_write_precomp(uint8_t drive, uint8_t track)
+{
+    uint32_t zone = track / HAL_PRECOMP_ZONE_TRACKS;
+
+    if (drive >= HOST_FDDS) {
+        return PRECOMP_DEFAULT;
+    }
+    return fdd_precomp[drive][zone < HAL_PRECOMP_ZONES ? zone : HAL_PRECOMP_ZONES - 1];
+}
+
+uint8_t hal_get_sectors_per_track(uint8_t drive)
+{
+    host_drive_t *d = fdd_get(drive);
+    return d ? d->spt : 0;
+}
+
+/*============================================================================
+ * Hard Disk (hdd_hal.h)
+ *============================================================================*/
+
+static uint32_t hdd_seek_us(host_drive_t *d, uint16_t cyl)
+{
+    uint32_t dist = (cyl > d->cyl) ? cyl - d->cyl : d->cyl - cyl;
+    uint32_t us = HDD_SEEK_BASE_US + dist * HDD_SEEK_PER_CYL_US;
+    return dist ? (us < HDD_SEEK_MAX_US ? us : HDD_SEEK_MAX_US) : 0;
+}
+
+static host_drive_t *hdd_get(uint8_t drive)
+{
+    return (drive < HOST_HDDS && hdd[drive].data) ? &hdd[drive] : NULL;
+}
+
+int host_hdd_attach(uint8_t drive, const char *path, uint8_t heads, uint8_t spt)
+{
+    if (drive >= HOST_HDDS) {
+        return -1;
+    }
+
+    host_drive_t *d = &hdd[drive];
+    if (load_image(d, path) != 0) {
+        return -1;
+    }
+
+    d->heads = heads ? heads : 4;
+    d->spt = spt ? spt : 17;
+    d->cylinders = (uint16_t)(d->sectors / ((uint32_t)d->heads * d->spt));
+    d->rev_us = 60000000u / HDD_RPM;
+    d->motor = true;
+    d->write_protect = false;
+    return 0;
+}
+
+bool hdd_is_ready(uint8_t drive)
+{
+    return hdd_get(drive) != NULL;
+}
+
+int hdd_get_profile(uint8_t drive, hdd_profile_t *profile)
+{
+    host_drive_t *d = hdd_get(drive);
+    if (!d || !profile) {
+        return HAL_ERR_INVALID;
+    }
+
+    memset(profile, 0, sizeof(*profile));
+    profile->geometry.cylinders = d->cylinders;
+    profile->geometry.heads = d->heads;
+    profile->geometry.sectors = d->spt;
+    profile->geometry.sector_size = 512;
+    profile->geometry.interleave = 1;
+    profile->geometry.total_sectors = d->sectors;
+    profile->geometry.capacity_mb = d->sectors / 2048;
+    profile->valid = true;
+    return HAL_OK;
+}
+
+int hdd_discover_quick(uint8_t drive, hdd_profile_t *profile)
+{
+    return hdd_get_profile(drive, profile);
+}
+
+bool hdd_discover_pending(uint8_t drive)
+{
+    (void)drive;
+    return false;
+}
+
+/* Bench drives spin from attach and have no supply budget to respect */
+int spinup_wait(uint32_t mask, uint32_t timeout_ms)
+{
+    (void)mask;
+    (void)timeout_ms;
+    return HAL_OK;
+}
+
+int hdd_sched_read_lba(uint8_t drive, uint32_t lba, uint32_t count, void *buf)
+{
+    host_drive_t *d = hdd_get(drive);
+    if (!d) {
+        return HAL_ERR_NOT_READY;
+    }
+    d->stats.reads++;
+    return lba_transfer(d, lba, buf, NULL, count, hdd_seek_us);
+}
+
+int hdd_sched_verify_lba(uint8_t drive, uint32_t lba, uint32_t count, uint32_t *bad_lba)
+{
+    host_drive_t *d = hdd_get(drive);
+    (void)bad_lba;
+    if (!d) {
+        return HAL_ERR_NOT_READY;
+    }
+    d->stats.reads++;
+    return lba_transfer(d, lba, NULL, NULL, count, hdd_seek_us);
+}
+
+int hal_hdd_write_sectors(uint8_t drive, uint32_t lba, const void *buf, uint32_t count)
+{
+    host_drive_t *d = hdd_get(drive);
+    if (!d) {
+        return HAL_ERR_NOT_READY;
+    }
+    d->stats.writes++;
+    return lba_transfer(d, lba, NULL, buf, count, hdd_seek_us);
+}
+
+/* Images carry no hidden metadata cylinder */
+meta_error_t meta_read(uint8_t drive, hdd_metadata_t *meta)
+{
+    (void)drive;
+    (void)meta;
+    return META_ERR_NO_SIGNATURE;
+}
+
+meta_error_t meta_read_cached(uint8_t drive, hdd_metadata_t *meta)
+{
+    return meta_read(drive, meta);
+}
+
+/*============================================================================
+ * Board EEPROM (power_hal.h I2C): not fitted, calibration stays in RAM
+ *============================================================================*/
+
+int i2c_write(uint8_t addr, const uint8_t *data, uint8_t len)
+{
+    (void)addr;
+    (void)data;
+    (void)len;
+    return PMU_ERR_NO_DEVICE;
+}
+
+int i2c_read(uint8_t addr, uint8_t *data, uint8_t len)
+{
+    (void)addr;
+    (void)data;
+    (void)len;
+    return PMU_ERR_NO_DEVICE;
+}
+
+/*============================================================================
+ * Statistics and Write-back
+ *============================================================================*/
+
+void host_drive_stats(bool is_hdd, uint8_t drive, host_drive_stats_t *stats)
+{
+    host_drive_t *d = is_hdd ? (drive < HOST_HDDS ? &hdd[drive] : NULL)
+                             : (drive < HOST_FDDS ? &fdd[drive] : NULL);
+    if (d) {
+        *stats = d->stats;
+    } else {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+void host_drive_stats_reset(void)
+{
+    for (int i = 0; i < HOST_FDDS; i++) {
+        memset(&fdd[i].stats, 0, sizeof(fdd[i].stats));
+    }
+    for (int i = 0; i < HOST_HDDS; i++) {
+        memset(&hdd[i].stats, 0, sizeof(hdd[i].stats));
+    }
+}
+
+static int flush_one(host_drive_t *d)
+{
+    if (!d->data || !d->dirty) {
+        return 0;
+    }
+    FILE *f = fopen(d->path, "r+b");
+    if (!f) {
+        perror(d->path);
+        return -1;
+    }
+    size_t n = fwrite(d->data, 512, d->sectors, f);
+    fclose(f);
+    d->dirty = false;
+    return n == d->sectors ? 0 : -1;
+}
+
+int host_drives_flush(void)
+{
+    int ret = 0;
+    for (int i = 0; i < HOST_FDDS; i++) {
+        ret |= flush_one(&fdd[i]);
+    }
+    for (int i = 0; i < HOST_HDDS; i++) {
+        ret |= flush_one(&hdd[i]);
+    }
+    return ret;
+}
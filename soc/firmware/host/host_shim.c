@@ -0,0 +1,497 @@
+/**
+ * FluxRipper SoC - Host Register Shim
+ *
+ * SoC address windows backed by fixed host mappings, a virtual CPU clock
+ * advanced per register access, and register-level models of the AXI
+ * timer and the FluxStat multipass engine replaying captured flux.
+ *
+ * Models are evaluated lazily: a register write lands in the backing word
+ * and takes effect on the next access to the same block, like a posted
+ * AXI write. Completion times are computed from the virtual clock, so a
+ * firmware poll loop sees a capture finish after the same number of
+ * revolutions it would on hardware.
+ *
+ * Created: 2025-12-08 20:30
+ */
+
+#define _GNU_SOURCE
+#include "host_shim.h"
+#include "platform.h"
+#include "fluxstat_hal.h"
+#include "raw_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE MAP_FIXED
+#endif
+
+/*============================================================================
+ * Address Windows
+ *============================================================================*/
+
+typedef struct {
+    uintptr_t   base;
+    size_t      size;
+    const char *name;
+} host_window_t;
+
+static const host_window_t windows[] = {
+    { DDR_ARENA_BASE,     DDR_ARENA_SIZE,   "DDR capture arena" },
+    { HYPERRAM_BASE,      HYPERRAM_SIZE,    "HyperRAM" },
+    { 0x44A00000,         0x00100000,       "debug/system peripherals" },
+    { PERIPH_BASE,        0x00010000,       "AXI peripherals" },
+};
+
+static uint64_t g_cycles;
+static uint64_t g_mmio;
+static bool g_mapped;
+
+/* Backing word of a register, bypassing host_mmio() */
+#define HREG(addr)          (*(volatile uint32_t *)(uintptr_t)(addr))
+
+/*============================================================================
+ * FluxStat Model
+ *============================================================================*/
+
+typedef struct {
+    uint32_t start;                 /* Index mark word */
+    uint32_t count;                 /* Words up to the next index mark */
+    uint32_t period;                /* Index-to-index time (capture clocks) */
+} host_rev_t;
+
+typedef struct {
+    uint32_t total;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t overflow;
+    uint16_t bins[FLUXSTAT_HIST_BINS];
+} host_hist_t;
+
+static struct {
+    /* Replay source */
+    uint32_t   *words;
+    uint32_t    nwords;
+    host_rev_t *revs;
+    uint32_t    nrevs;
+    bool        warned;             /* Truncation reported for this dump */
+
+    /* Multipass engine */
+    bool        busy;
+    bool        done;
+    bool        error;
+    uint8_t     passes;
+    uint8_t     completed;
+    uint64_t    t0;                 /* Cycle of the index that starts pass 0 */
+    uint64_t    rev_cycles;
+    uint32_t    base;
+    uint32_t    stride;
+    uint32_t    win_start;
+    uint32_t    win_len;
+    uint32_t    total_flux;
+    uint32_t    min_flux;
+    uint32_t    max_flux;
+    uint32_t    total_time;
+
+    /* Histogram (live and frozen bank) */
+    uint32_t    hist_prev;
+    uint16_t    swaps;
+    host_hist_t live;
+    host_hist_t frozen;
+} fs[FLUXSTAT_INTERFACES];
+
+/* Capture clocks per CPU cycle (200 MHz FDC domain, 100 MHz CPU) */
+#define FS_CLKS_PER_CYCLE   (FDC_FREQ_HZ / CPU_FREQ_HZ)
+
+static void fs_hist_clear(host_hist_t *h)
+{
+    memset(h, 0, sizeof(*h));
+    h->min = 0xFFFF;
+}
+
+static void fs_hist_add(host_hist_t *h, uint32_t interval)
+{
+    uint32_t bin = interval >> FLUXSTAT_HIST_BIN_SHIFT;
+
+    h->total++;
+    h->sum += interval;
+    if (interval < h->min) {
+        h->min = interval;
+    }
+    if (interval > h->max) {
+        h->max = interval;
+    }
+    if (bin >= FLUXSTAT_HIST_BINS) {
+        h->overflow++;
+        return;
+    }
+    if (h->bins[bin] != 0xFFFF) {
+        h->bins[bin]++;
+    }
+}
+
+static uint32_t fs_hist_peak(const host_hist_t *h)
+{
+    uint32_t peak = 0;
+
+    for (uint32_t b = 1; b < FLUXSTAT_HIST_BINS; b++) {
+        if (h->bins[b] > h->bins[peak]) {
+            peak = b;
+        }
+    }
+    return ((uint32_t)h->bins[peak] << 16) | peak;
+}
+
+static uint32_t fs_hist_mean(const host_hist_t *h)
+{
+    return h->total ? (uint32_t)(h->sum / h->total) : 0;
+}
+
+static void fs_hist_swap(uint8_t i)
+{
+    fs[i].frozen = fs[i].live;
+    fs_hist_clear(&fs[i].live);
+    fs[i].swaps++;
+}
+
+/**
+ * Write one pass to memory and update the pass registers
+ */
+static void fs_write_pass(uint8_t i, uint8_t pass)
+{
+    const host_rev_t *rev = &fs[i].revs[pass % fs[i].nrevs];
+    const uint32_t *src = &fs[i].words[rev->start];
+    uintptr_t addr = (uintptr_t)fs[i].base + (uintptr_t)pass * fs[i].stride;
+    uint32_t max = fs[i].stride / 4;
+    uint32_t n = 0;
+
+    if (addr < windows[0].base || addr + fs[i].stride > windows[0].base + windows[0].size) {
+        fs[i].error = true;
+        return;
+    }
+    uint32_t *dst = (uint32_t *)addr;
+
+    if ((HREG(FLUXSTAT_IF_BASE(i) + 0x120) & HIST_CTRL_SWAP_INDEX) &&
+        (HREG(FLUXSTAT_IF_BASE(i) + 0x120) & HIST_CTRL_BANKED)) {
+        fs_hist_swap(i);
+    }
+
+    if (fs[i].win_len == 0) {
+        n = rev->count < max ? rev->count : max;
+        memcpy(dst, src, n * 4);
+        if (n < rev->count && !fs[i].warned) {
+            fs[i].warned = true;
+            fprintf(stderr, "host_shim: pass truncated to %u of %u flux words by %u byte stride\n",
+                    n, rev->count, fs[i].stride);
+        }
+    } else {
+        /* Windowed: transitions win_start..win_start+win_len after index */
+        uint32_t origin = FLUX_TIMESTAMP(src[0]);
+        for (uint32_t w = 1; w < rev->count && n < max; w++) {
+            uint32_t rel = (FLUX_TIMESTAMP(src[w]) - origin) & FLUX_TIMESTAMP_MASK;
+            if (rel >= fs[i].win_start && rel - fs[i].win_start < fs[i].win_len) {
+                dst[n++] = src[w];
+            }
+        }
+    }
+
+    if (HREG(FLUXSTAT_IF_BASE(i) + 0x120) & HIST_CTRL_ENABLE) {
+        for (uint32_t w = 1; w < n; w++) {
+            if (FLUX_IS_INDEX(dst[w]) || FLUX_IS_INDEX(dst[w - 1])) {
+                continue;
+            }
+            fs_hist_add(&fs[i].live,
+                        (FLUX_TIMESTAMP(dst[w]) - FLUX_TIMESTAMP(dst[w - 1])) &
+                        FLUX_TIMESTAMP_MASK);
+        }
+    }
+
+    if (pass < 32) {
+        HREG(FLUXSTAT_IF_BASE(i) + 0x20 + pass * 4) = n;
+        HREG(FLUXSTAT_IF_BASE(i) + 0xA0 + pass * 4) = rev->period;
+    }
+    fs[i].total_flux += n;
+    fs[i].total_time += rev->period;
+    if (n < fs[i].min_flux) {
+        fs[i].min_flux = n;
+    }
+    if (n > fs[i].max_flux) {
+        fs[i].max_flux = n;
+    }
+}
+
+static void fs_start(uint8_t i, uint32_t ctrl)
+{
+    uint8_t passes = (ctrl & MP_CTRL_PASS_COUNT_MASK) >> MP_CTRL_PASS_COUNT_SHIFT;
+    uint32_t stride = HREG(FLUXSTAT_IF_BASE(i) + 0x178);
+
+    fs[i].passes = passes ? passes : FLUXSTAT_MAX_PASSES;
+    fs[i].completed = 0;
+    fs[i].busy = true;
+    fs[i].done = false;
+    fs[i].error = false;
+    fs[i].base = HREG(FLUXSTAT_IF_BASE(i) + 0x08);
+    fs[i].stride = stride ? stride : FLUXSTAT_PASS_SIZE;
+    fs[i].win_start = HREG(FLUXSTAT_IF_BASE(i) + 0x170);
+    fs[i].win_len = HREG(FLUXSTAT_IF_BASE(i) + 0x174);
+    fs[i].total_flux = 0;
+    fs[i].min_flux = 0xFFFFFFFF;
+    fs[i].max_flux = 0;
+    fs[i].total_time = 0;
+
+    if (fs[i].nrevs == 0) {
+        /* No media: the engine never sees an index pulse */
+        fs[i].rev_cycles = UINT64_MAX / 4;
+        fs[i].t0 = g_cycles;
+        return;
+    }
+
+    /* Armed mid-revolution: the first pass starts at the next index */
+    fs[i].rev_cycles = fs[i].revs[0].period / FS_CLKS_PER_CYCLE;
+    if (fs[i].rev_cycles == 0) {
+        fs[i].rev_cycles = 1;
+    }
+    fs[i].t0 = (g_cycles / fs[i].rev_cycles + 1) * fs[i].rev_cycles;
+}
+
+static void fs_step(uint8_t i)
+{
+    uint32_t base = FLUXSTAT_IF_BASE(i);
+    uint32_t ctrl = HREG(base + 0x00);
+
+    if (ctrl & MP_CTRL_ABORT) {
+        if (fs[i].busy) {
+            fs[i].busy = false;
+            fs[i].error = true;
+        }
+        ctrl &= ~MP_CTRL_ABORT;
+        HREG(base + 0x00) = ctrl;
+    }
+    if (ctrl & MP_CTRL_START) {
+        HREG(base + 0x00) = ctrl & ~MP_CTRL_START;
+        if (!fs[i].busy) {
+            fs_start(i, ctrl);
+        }
+    }
+
+    while (fs[i].busy && fs[i].completed < fs[i].passes &&
+           g_cycles >= fs[i].t0 + (uint64_t)(fs[i].completed + 1) * fs[i].rev_cycles) {
+        fs_write_pass(i, fs[i].completed);
+        fs[i].completed++;
+        if (fs[i].error) {
+            fs[i].busy = false;
+        }
+    }
+    if (fs[i].busy && fs[i].completed == fs[i].passes) {
+        fs[i].busy = false;
+        fs[i].done = true;
+    }
+
+    uint8_t current = fs[i].busy ? fs[i].completed : 0;
+    HREG(base + 0x04) = (fs[i].busy ? MP_STATUS_BUSY : 0) |
+                        (fs[i].done ? MP_STATUS_DONE : 0) |
+                        (fs[i].error ? MP_STATUS_ERROR : 0) |
+                        ((uint32_t)(current & 0x3F) << MP_STATUS_CURRENT_SHIFT) |
+                        ((uint32_t)(fs[i].completed & 0x3F) << MP_STATUS_COMPLETE_SHIFT);
+    HREG(base + 0x0C) = fs[i].total_flux;
+    HREG(base + 0x10) = fs[i].completed ? fs[i].min_flux : 0;
+    HREG(base + 0x14) = fs[i].max_flux;
+    HREG(base + 0x18) = fs[i].total_time;
+
+    /* Histogram control edges */
+    uint32_t hc = HREG(base + 0x120);
+    uint32_t rise = hc & ~fs[i].hist_prev;
+    if (hc & HIST_CTRL_CLEAR) {
+        fs_hist_clear(&fs[i].live);
+        fs_hist_clear(&fs[i].frozen);
+        fs[i].swaps = 0;
+    }
+    if (rise & HIST_CTRL_SWAP) {
+        fs_hist_swap(i);
+    }
+    if (rise & HIST_CTRL_SNAPSHOT) {
+        HREG(base + 0x140) = fs[i].live.total;
+        HREG(base + 0x144) = fs_hist_peak(&fs[i].live) & 0xFF;
+        HREG(base + 0x148) = fs_hist_peak(&fs[i].live) >> 16;
+        HREG(base + 0x14C) = fs_hist_mean(&fs[i].live);
+    }
+    fs[i].hist_prev = hc;
+
+    const host_hist_t *h = (hc & HIST_CTRL_BANKED) ? &fs[i].frozen : &fs[i].live;
+    uint32_t bin = HREG(base + 0x124) & (FLUXSTAT_HIST_BINS - 1);
+    HREG(base + 0x128) = h->bins[bin];
+    HREG(base + 0x12C) = h->total;
+    HREG(base + 0x130) = h->total ? h->min : 0;
+    HREG(base + 0x134) = h->max;
+    HREG(base + 0x138) = fs_hist_peak(h);
+    HREG(base + 0x13C) = fs_hist_mean(h);
+    for (uint32_t n = 0; n < FLUXSTAT_HIST_BINS / 2; n++) {
+        HREG(base + 0x400 + n * 4) = ((uint32_t)h->bins[2 * n + 1] << 16) | h->bins[2 * n];
+    }
+
+    HREG(base + 0x150) = fs[i].swaps | ((fs[i].swaps & 1) ? BANK_STATUS_ACTIVE : 0);
+    HREG(base + 0x154) = fs[i].frozen.total;
+    HREG(base + 0x158) = fs[i].frozen.total ? fs[i].frozen.min : 0;
+    HREG(base + 0x15C) = fs[i].frozen.max;
+    HREG(base + 0x160) = fs_hist_peak(&fs[i].frozen);
+    HREG(base + 0x164) = fs_hist_mean(&fs[i].frozen);
+    HREG(base + 0x168) = fs[i].frozen.overflow;
+}
+
+/*============================================================================
+ * Bus
+ *============================================================================*/
+
+volatile void *host_mmio(uintptr_t addr)
+{
+    g_cycles += HOST_MMIO_CYCLES;
+    g_mmio++;
+
+    if (addr >= FLUXSTAT_BASE &&
+        addr < FLUXSTAT_BASE + FLUXSTAT_INTERFACES * FLUXSTAT_IF_STRIDE) {
+        fs_step((uint8_t)((addr - FLUXSTAT_BASE) / FLUXSTAT_IF_STRIDE));
+    } else if (addr >= TIMER_BASE && addr < TIMER_BASE + 0x1000) {
+        /* Free-running up counter at the CPU clock */
+        HREG(TIMER_BASE + 0x08) = (uint32_t)g_cycles;
+    }
+
+    for (size_t w = 0; w < ARRAY_SIZE(windows); w++) {
+        if (addr - windows[w].base < windows[w].size) {
+            return (volatile void *)addr;
+        }
+    }
+
+    fprintf(stderr, "host_mmio: access to unmapped address 0x%08lx\n", (unsigned long)addr);
+    abort();
+}
+
+int host_shim_init(void)
+{
+    if (!g_mapped) {
+        for (size_t w = 0; w < ARRAY_SIZE(windows); w++) {
+            void *p = mmap((void *)windows[w].base, windows[w].size,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+            if (p != (void *)windows[w].base) {
+                fprintf(stderr, "host_shim: cannot map %s at 0x%08lx\n",
+                        windows[w].name, (unsigned long)windows[w].base);
+                return -1;
+            }
+        }
+        g_mapped = true;
+    }
+
+    g_cycles = 0;
+    g_mmio = 0;
+    for (uint8_t i = 0; i < FLUXSTAT_INTERFACES; i++) {
+        fs[i].busy = fs[i].done = fs[i].error = false;
+        fs[i].completed = 0;
+        fs[i].hist_prev = 0;
+        fs[i].swaps = 0;
+        fs_hist_clear(&fs[i].live);
+        fs_hist_clear(&fs[i].frozen);
+    }
+    return 0;
+}
+
+uint64_t host_cycles(void)
+{
+    return g_cycles;
+}
+
+void host_advance_us(uint32_t us)
+{
+    g_cycles += (uint64_t)us * (CPU_FREQ_HZ / 1000000);
+}
+
+uint64_t host_mmio_count(void)
+{
+    return g_mmio;
+}
+
+/*============================================================================
+ * Flux Dumps
+ *============================================================================*/
+
+int host_flux_load_words(uint8_t iface, const uint32_t *words, uint32_t count)
+{
+    if (iface >= FLUXSTAT_INTERFACES || count == 0) {
+        return -1;
+    }
+
+    free(fs[iface].words);
+    free(fs[iface].revs);
+    fs[iface].words = malloc((size_t)count * 4);
+    fs[iface].revs = malloc((size_t)count * sizeof(host_rev_t));
+    if (!fs[iface].words || !fs[iface].revs) {
+        return -1;
+    }
+    memcpy(fs[iface].words, words, (size_t)count * 4);
+    fs[iface].nwords = count;
+    fs[iface].nrevs = 0;
+    fs[iface].warned = false;
+
+    /* One revolution per index-to-index span; a trailing partial one is dropped */
+    int64_t last = -1;
+    for (uint32_t w = 0; w < count; w++) {
+        if (!FLUX_IS_INDEX(words[w])) {
+            continue;
+        }
+        if (last >= 0) {
+            host_rev_t *r = &fs[iface].revs[fs[iface].nrevs++];
+            r->start = (uint32_t)last;
+            r->count = w - (uint32_t)last;
+            r->period = (FLUX_TIMESTAMP(words[w]) - FLUX_TIMESTAMP(words[last])) &
+                        FLUX_TIMESTAMP_MASK;
+        }
+        last = w;
+    }
+
+    /* No index marks: the whole dump is one revolution */
+    if (fs[iface].nrevs == 0) {
+        host_rev_t *r = &fs[iface].revs[fs[iface].nrevs++];
+        r->start = 0;
+        r->count = count;
+        r->period = (FLUX_TIMESTAMP(words[count - 1]) - FLUX_TIMESTAMP(words[0])) &
+                    FLUX_TIMESTAMP_MASK;
+    }
+
+    return (int)fs[iface].nrevs;
+}
+
+int host_flux_load(uint8_t iface, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint32_t count = size > 0 ? (uint32_t)(size / 4) : 0;
+    uint32_t *words = malloc((size_t)count * 4 + 4);
+    int ret = -1;
+    if (words && fread(words, 4, count, f) == count) {
+        ret = host_flux_load_words(iface, words, count);
+    }
+
+    free(words);
+    fclose(f);
+    return ret;
+}
+
+const uint32_t *host_flux_words(uint8_t iface, uint32_t *count)
+{
+    if (iface >= FLUXSTAT_INTERFACES) {
+        *count = 0;
+        return NULL;
+    }
+    *count = fs[iface].nwords;
+    return fs[iface].words;
+}
@@ -0,0 +1,123 @@
+/**
+ * FluxRipper SoC - Host Register Shim
+ *
+ * x86 stand-in for the SoC bus used by the FW_HOST build (make host).
+ * Firmware modules compile unchanged: REG32() lands in host_mmio(), which
+ * maps the SoC address map onto host memory, keeps a virtual CPU clock
+ * and runs small device models (AXI timer, FluxStat multipass engine).
+ *
+ * Drive I/O above the register level comes from host_drives.c, which
+ * serves the fluxripper_hal/hdd_hal entry points from image files.
+ *
+ * Created: 2025-12-08 20:30
+ */
+
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Virtual CPU cycles charged per register access (AXI-Lite round trip) */
+#define HOST_MMIO_CYCLES    10
+
+/* Drives served from images (2 FDD + 2 HDD, as on the board) */
+#define HOST_FDDS           2
+#define HOST_HDDS           2
+
+/*============================================================================
+ * Shim
+ *============================================================================*/
+
+/**
+ * Map the SoC address windows and reset the device models
+ * @return 0 on success, -1 if a window could not be mapped
+ */
+int host_shim_init(void);
+
+/**
+ * Virtual CPU clock (100 MHz cycles since host_shim_init)
+ */
+uint64_t host_cycles(void);
+
+/**
+ * Advance the virtual clock, as a drive or bus transfer would
+ */
+void host_advance_us(uint32_t us);
+
+/**
+ * Register accesses since host_shim_init
+ */
+uint64_t host_mmio_count(void);
+
+/*============================================================================
+ * FluxStat Replay
+ *============================================================================*/
+
+/**
+ * Load a flux dump for one FluxStat interface
+ *
+ * The dump is a raw little-endian array of flux words as carried by the
+ * READ_FLUX payload: 27-bit 200 MHz timestamps, FLUX_FLAG_INDEX on the
+ * index marks. Each index-to-index span is one revolution; pass N of a
+ * capture replays revolution N modulo the revolutions in the dump.
+ *
+ * @param iface     FluxStat interface (0-1)
+ * @param path      Dump file
+ * @return Revolutions found, or -1 on error
+ */
+int host_flux_load(uint8_t iface, const char *path);
+
+/**
+ * Load flux words already in memory (copied)
+ */
+int host_flux_load_words(uint8_t iface, const uint32_t *words, uint32_t count);
+
+/**
+ * Flux words loaded for an interface
+ */
+const uint32_t *host_flux_words(uint8_t iface, uint32_t *count);
+
+/*============================================================================
+ * Drive Images (host_drives.c)
+ *============================================================================*/
+
+/**
+ * Attach a floppy image (raw sector dump, 512-byte sectors)
+ * Geometry follows the image size (360K, 720K, 1.2M, 1.44M, 2.88M).
+ *
+ * @return 0 on success, -1 on error or unknown size
+ */
+int host_fdd_attach(uint8_t drive, const char *path, bool write_protect);
+
+/**
+ * Attach a hard disk image (raw LBA order, 512-byte sectors)
+ *
+ * @param heads     Heads for LBA to CHS (0 = 4)
+ * @param spt       Sectors per track (0 = 17, ST-506 MFM)
+ * @return 0 on success, -1 on error
+ */
+int host_hdd_attach(uint8_t drive, const char *path, uint8_t heads, uint8_t spt);
+
+/**
+ * Drive activity counters
+ */
+typedef struct {
+    uint32_t seeks;             /* Head movements */
+    uint32_t tracks_stepped;    /* Cylinders crossed */
+    uint32_t reads;             /* Read commands */
+    uint32_t sectors_read;      /* Sectors transferred to the firmware */
+    uint32_t writes;            /* Write commands */
+    uint32_t sectors_written;   /* Sectors transferred from the firmware */
+    uint64_t busy_us;           /* Virtual time spent in the drive model */
+} host_drive_stats_t;
+
+void host_drive_stats(bool hdd, uint8_t drive, host_drive_stats_t *stats);
+void host_drive_stats_reset(void);
+
+/**
+ * Write attached images back to their files
+ */
+int host_drives_flush(void);
+
+#endif /* HOST_SHIM_H */
@@ -0,0 +1,50 @@
+/**
+ * FluxRipper Board Configuration EEPROM
+ *
+ * 24xx256-class EEPROM on I2C0 holding calibration data and the HDD
+ * profile cache. Reads are arbitrary length; writes go a page at a time
+ * and wait out the write cycle.
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-10 15:00
+ */
+
+#ifndef BOARD_EEPROM_H
+#define BOARD_EEPROM_H
+
+#include <stdint.h>
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#define EEPROM_I2C_ADDR         0x50        /* 7-bit I2C address */
+#define EEPROM_PAGE             64          /* Write page size */
+#define EEPROM_WRITE_MS         10          /* Max page write cycle */
+
+/* Layout */
+#define EEPROM_CAL_BASE         0x0000      /* Calibration data */
+#define EEPROM_PCACHE_BASE      0x1000      /* HDD profile cache */
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+/**
+ * Read from the EEPROM
+ * @param addr  byte address
+ * @param buf   destination
+ * @param len   byte count
+ * @return HAL_OK, or HAL_ERR_HARDWARE if the EEPROM does not answer
+ */
+int eeprom_read(uint16_t addr, void *buf, uint8_t len);
+
+/**
+ * Write one page, then ACK-poll until the write cycle completes
+ * @param addr  page-aligned byte address
+ * @param buf   EEPROM_PAGE bytes
+ * @return HAL_OK, HAL_ERR_HARDWARE or HAL_ERR_TIMEOUT
+ */
+int eeprom_write_page(uint16_t addr, const void *buf);
+
+#endif /* BOARD_EEPROM_H */
@@ -17,16 +17,45 @@
 /* Maximum number of arguments */
 #define CLI_MAX_ARGS    8
 
+/* Command table size (linked + registered at run time) */
+#define CLI_MAX_COMMANDS    48
+
+/* Command flags */
+#define CLI_CMD_DRIVES  (1 << 0)    /* Handler uses the drive HALs */
+
 /* Command handler function type */
 typedef int (*cli_handler_t)(int argc, char *argv[]);
 
-/* Command definition */
-typedef struct {
+/*
+ * Command definition
+ *
+ * A command with a subcommand table dispatches on its first argument:
+ * the matching entry runs with argv shifted by one (argv[0] = subcommand
+ * name), recursively for nested tables. With no argument the command's
+ * own handler runs, or a usage list is generated from the table if it
+ * has none. Subcommand tables end with an entry whose name is NULL.
+ */
+typedef struct cli_cmd {
     const char *name;           /* Command name */
     const char *help;           /* Help text */
-    cli_handler_t handler;      /* Handler function */
+    cli_handler_t handler;      /* Handler function (may be NULL with sub) */
+    uint8_t flags;              /* CLI_CMD_* flags (top level only) */
+    const struct cli_cmd *sub;  /* Subcommand table, or NULL */
 } cli_cmd_t;
 
+/*
+ * Link a command into the table at build time:
+ *
+ *     const cli_cmd_t hdd_cli_cmd = { "hdd", "...", NULL, 0, hdd_subcmds };
+ *     CLI_COMMAND(hdd_cli_cmd);
+ *
+ * Entries land in the .cli_cmds section (see link.ld); cli_init() sorts
+ * them by name once, and lookups are a binary search.
+ */
+#define CLI_COMMAND(cmd) \
+    static const cli_cmd_t *const cli_entry_##cmd \
+    __attribute__((used, section(".cli_cmds." #cmd))) = &(cmd)
+
 /**
  * Initialize CLI subsystem
  */
@@ -34,20 +63,37 @@ void cli_init(void);
 
 /**
  * Run CLI main loop (never returns)
+ * Standalone loop for builds without the task scheduler.
  */
 void cli_run(void);
 
+/**
+ * Print the banner and first prompt
+ * Call once before polling with cli_poll().
+ */
+void cli_start(void);
+
+/**
+ * Service the console without blocking (scheduler task body)
+ * Collects typed characters and runs the command once a line is
+ * complete. Commands flagged CLI_CMD_DRIVES wait until no other drive
+ * work is running, then hold the drives for their duration.
+ */
+void cli_poll(void);
+
 /**
  * Process a single command line
+ * A "--bin" argument is removed before dispatch and selects the framed
+ * binary response (see cli_bin.h).
  * @param line command line to process
  * @return command return value, or -1 if not found
  */
 int cli_process(char *line);
 
 /**
- * Register a command
- * @param cmd command definition
- * @return 0 on success, -1 if table full
+ * Register a command at run time (CLI_COMMAND() is preferred)
+ * @param cmd command definition (kept referenced)
+ * @return 0 on success, -1 if the table is full or the name is taken
  */
 int cli_register(const cli_cmd_t *cmd);
 
@@ -55,7 +101,7 @@ int cli_register(const cli_cmd_t *cmd);
  * Built-in Commands (Milestone 0)
  *============================================================================*/
 
-/* help - Show available commands */
+/* help [cmd] - Show available commands or a command's subcommands */
 int cmd_help(int argc, char *argv[]);
 
 /* echo - Echo arguments */
@@ -0,0 +1,81 @@
+/**
+ * FluxRipper CLI Binary Output
+ *
+ * Machine-readable output for dashboards and test scripts. A command run
+ * with "--bin" anywhere on its line emits its fields as one CBOR map
+ * instead of formatted text, so neither side spends time formatting or
+ * parsing numbers.
+ *
+ * Frame on the console stream:
+ *   0x02 'B' len[2] payload[len] crc[2]
+ * len and crc are little-endian; crc is CRC16-CCITT over len and payload.
+ * A newline follows the frame so a terminal user still gets the prompt on
+ * its own line.
+ * The payload is an indefinite-length CBOR map with text keys; "cmd"
+ * comes first and "rc" (handler return value) last. Commands that have
+ * no binary form still produce the frame, carrying only "cmd" and "rc",
+ * after their normal text.
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-09 20:30
+ */
+
+#ifndef CLI_BIN_H
+#define CLI_BIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#define CLI_BIN_FLAG        "--bin"
+#define CLI_BIN_STX         0x02
+#define CLI_BIN_TAG         'B'
+#define CLI_BIN_OVERHEAD    6           /* STX, tag, len, crc */
+
+/*============================================================================
+ * Frame Control (used by cli_process)
+ *============================================================================*/
+
+/**
+ * Start collecting a binary response
+ * @param cmd command name, emitted as "cmd"
+ */
+void cli_bin_begin(const char *cmd);
+
+/**
+ * Append "rc", close the map and send the frame
+ * A payload that did not fit is replaced by {"cmd", "overflow": true, "rc"}.
+ * @param rc handler return value
+ */
+void cli_bin_end(int rc);
+
+/**
+ * Check whether the running command should emit binary
+ * @return true between cli_bin_begin() and cli_bin_end()
+ */
+bool cli_bin_active(void);
+
+/*============================================================================
+ * Field Emitters
+ *
+ * key is the map key; pass NULL for elements inside an array.
+ *============================================================================*/
+
+void cli_bin_uint(const char *key, uint32_t value);
+void cli_bin_int(const char *key, int32_t value);
+void cli_bin_bool(const char *key, bool value);
+void cli_bin_str(const char *key, const char *value);
+
+/* Fixed-length arrays of unsigned values (histograms) */
+void cli_bin_u16_array(const char *key, const uint16_t *values, uint32_t count);
+void cli_bin_u32_array(const char *key, const uint32_t *values, uint32_t count);
+
+/* Nested containers (indefinite length, must be closed) */
+void cli_bin_map_begin(const char *key);
+void cli_bin_array_begin(const char *key);
+void cli_bin_end_container(void);
+
+#endif /* CLI_BIN_H */
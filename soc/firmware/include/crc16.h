@@ -0,0 +1,65 @@
+/**
+ * FluxRipper SoC - CRC16-CCITT
+ *
+ * Software CRC16-CCITT (poly 0x1021, MSB first) matching rtl/crc/crc16_ccitt.v.
+ * Used for IBM-format ID and data field checks in firmware recovery paths.
+ *
+ * The update function is resumable: pass the returned state back in to
+ * continue a CRC across buffers, or fork a prefix CRC to test candidate
+ * suffixes without rehashing the common part.
+ *
+ * Created: 2025-12-07 16:00
+ */
+
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+
+/* Configuration: slice-by-4 (2 KB of tables) or bytewise (512 B) */
+#ifndef CRC16_SLICE_BY_4
+#define CRC16_SLICE_BY_4    1
+#endif
+
+/* IBM floppy/MFM preset */
+#define CRC16_INIT          0xFFFF
+
+/* Lookup tables (code BRAM); [0] is the bytewise table */
+#if CRC16_SLICE_BY_4
+extern const uint16_t crc16_table[4][256];
+#else
+extern const uint16_t crc16_table[1][256];
+#endif
+
+/**
+ * Update CRC with one byte
+ * @param crc current CRC state
+ * @param byte next data byte
+ * @return updated CRC state
+ */
+static inline uint16_t crc16_update_byte(uint16_t crc, uint8_t byte)
+{
+    return (uint16_t)((crc << 8) ^ crc16_table[0][(crc >> 8) ^ byte]);
+}
+
+/**
+ * Update CRC with a buffer
+ * @param crc current CRC state (CRC16_INIT to start)
+ * @param buf data
+ * @param len byte count
+ * @return updated CRC state
+ */
+uint16_t crc16_update(uint16_t crc, const void *buf, uint32_t len);
+
+/**
+ * Compute CRC of a buffer from CRC16_INIT
+ * @param buf data
+ * @param len byte count
+ * @return CRC (0 if buf includes a correct trailing big-endian CRC)
+ */
+static inline uint16_t crc16_ccitt(const void *buf, uint32_t len)
+{
+    return crc16_update(CRC16_INIT, buf, len);
+}
+
+#endif /* CRC16_H */
@@ -0,0 +1,145 @@
+/**
+ * FluxRipper DDR Capture Buffer Arena
+ *
+ * Region allocator for the DDR behind the capture engines (the FluxStat
+ * multipass engine writes its passes here). The region is carved into
+ * DDR_GRANULE blocks; every allocation is one contiguous run of them, so
+ * a capture takes passes * stride bytes sized for its own track instead
+ * of a fixed slot per pass.
+ *
+ * Buffers are reference counted. The owner holds the first reference;
+ * anything that hands the memory to a DMA engine (USB bulk IN, S2MM)
+ * takes another with ddr_retain() and drops it with ddr_release() from
+ * the completion, so the data goes out with no copy and the run returns
+ * to the region when the last holder lets go. Retain and release are
+ * safe from interrupt context.
+ *
+ * On top of the region, slabs split a run into equal buffers (the tape
+ * job's DMA chunks), each reference counted like a run of its own.
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-11 19:30
+ */
+
+#ifndef DDR_ARENA_H
+#define DDR_ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#define DDR_ARENA_BASE          0x00100000  /* Capture DDR region */
+#define DDR_ARENA_SIZE          0x00800000  /* 8MB */
+#define DDR_GRANULE             0x4000      /* 16KB allocation unit */
+#define DDR_GRANULES            (DDR_ARENA_SIZE / DDR_GRANULE)
+
+#define DDR_MAX_BUFS            64          /* Buffer descriptors (runs + slab buffers) */
+#define DDR_SLAB_MAX_OBJS       32          /* Buffers per slab */
+
+/*============================================================================
+ * Data Structures
+ *============================================================================*/
+
+typedef struct ddr_slab ddr_slab_t;
+
+/**
+ * Buffer: a run of granules, or one buffer of a slab
+ */
+typedef struct {
+    uint32_t    addr;               /* First byte */
+    uint32_t    size;               /* Bytes */
+    uint8_t     refs;               /* 0: descriptor free (or slab buffer idle) */
+    ddr_slab_t *slab;               /* Owning slab, NULL for a run */
+    uint16_t    first;              /* First granule (runs only) */
+    uint16_t    granules;           /* Granules in the run (runs only) */
+} ddr_buf_t;
+
+/**
+ * Slab: one run split into count buffers of obj_size bytes
+ */
+struct ddr_slab {
+    ddr_buf_t  *run;                /* Backing run, NULL if not set up */
+    uint32_t    obj_size;           /* Bytes per buffer (granule multiple) */
+    uint8_t     count;              /* Buffers in the slab */
+    uint8_t     in_use;             /* Buffers with a reference */
+    ddr_buf_t  *obj[DDR_SLAB_MAX_OBJS];
+};
+
+typedef struct {
+    uint32_t    free_bytes;         /* Unallocated region */
+    uint32_t    largest_free;       /* Longest free run, bytes */
+    uint32_t    peak_bytes;         /* Most region allocated at once */
+    uint16_t    bufs;               /* Descriptors in use */
+    uint32_t    allocs;             /* Runs allocated */
+    uint32_t    failures;           /* Allocations that did not fit */
+} ddr_stats_t;
+
+/*============================================================================
+ * Region API
+ *============================================================================*/
+
+/**
+ * Set up the region allocator (idempotent)
+ * @return FLUXSTAT_OK
+ */
+int ddr_init(void);
+
+/**
+ * Allocate a contiguous buffer, rounded up to whole granules
+ * @param size      bytes
+ * @return buffer holding one reference, NULL if it does not fit
+ */
+ddr_buf_t *ddr_alloc(uint32_t size);
+
+/**
+ * Take another reference (e.g. before queueing the buffer for DMA)
+ */
+void ddr_retain(ddr_buf_t *buf);
+
+/**
+ * Drop a reference; the last one frees the run or idles the slab buffer
+ * Safe from interrupt context. NULL is ignored.
+ */
+void ddr_release(ddr_buf_t *buf);
+
+/**
+ * Longest run ddr_alloc() could return now
+ * @return bytes
+ */
+uint32_t ddr_largest_free(void);
+
+/**
+ * Get region counters
+ */
+void ddr_get_stats(ddr_stats_t *stats);
+
+/*============================================================================
+ * Slab API
+ *============================================================================*/
+
+/**
+ * Reserve a slab of equal buffers
+ * @param slab      slab to set up
+ * @param obj_size  bytes per buffer (rounded up to whole granules)
+ * @param count     buffers (1-DDR_SLAB_MAX_OBJS)
+ * @return FLUXSTAT_OK, FLUXSTAT_ERR_INVALID for a bad size or count,
+ *         FLUXSTAT_ERR_OVERFLOW if the region or descriptors run out
+ */
+int ddr_slab_init(ddr_slab_t *slab, uint32_t obj_size, uint8_t count);
+
+/**
+ * Take an idle buffer from a slab
+ * @return buffer holding one reference, NULL if all are in use
+ */
+ddr_buf_t *ddr_slab_alloc(ddr_slab_t *slab);
+
+/**
+ * Return a slab's run to the region
+ * @return FLUXSTAT_OK, FLUXSTAT_ERR_BUSY while a buffer is still referenced
+ */
+int ddr_slab_destroy(ddr_slab_t *slab);
+
+#endif /* DDR_ARENA_H */
@@ -21,6 +21,38 @@
 
 #define DEBUG_BASE_ADDR     0x44A80000
 
+/* Memory block transfer registers (debug_register_bank.v, 0x78-0x88) */
+#define DBG_REG(off)            (*(volatile uint32_t *)(DEBUG_BASE_ADDR + (off)))
+#define DBG_MEM_BLK_SRC         DBG_REG(0x78)
+#define DBG_MEM_BLK_DST         DBG_REG(0x7C)
+#define DBG_MEM_BLK_CTRL        DBG_REG(0x80)
+#define DBG_MEM_BLK_STAT        DBG_REG(0x84)
+#define DBG_MEM_BLK_PATTERN     DBG_REG(0x88)
+#define DBG_TRACE_STAT          DBG_REG(0x34)
+
+/* MEM_BLK_CTRL */
+#define DBG_BLK_CTRL_START      (1 << 0)    /* Start block (self-clearing) */
+#define DBG_BLK_CTRL_FILL       (1 << 1)    /* Write PATTERN instead of copying */
+#define DBG_BLK_CTRL_LOCAL      (1 << 2)    /* Source is the trace buffer; SRC is a word index */
+#define DBG_BLK_CTRL_WORDS_SHIFT 16         /* [24:16] words, 1-256 */
+
+/* MEM_BLK_STAT */
+#define DBG_BLK_STAT_BUSY       (1 << 0)
+#define DBG_BLK_STAT_DONE       (1 << 1)    /* Cleared by the next start */
+#define DBG_BLK_STAT_ERROR      (1 << 2)    /* Bus error or timeout */
+
+#define DBG_BLK_MAX_WORDS       256         /* One AXI INCR burst */
+#define DBG_BLK_BOUNDARY        4096        /* Bursts may not cross 4KB */
+
+/* TRACE_STAT */
+#define DBG_TRACE_STAT_COUNT    0x00000FFF  /* [11:0] entries captured */
+#define DBG_TRACE_STAT_TRIGGERED (1 << 14)
+#define DBG_TRACE_STAT_WRAPPED  (1 << 15)
+#define DBG_TRACE_STAT_TRIG_SHIFT 16        /* [27:16] trigger entry (0 = oldest) */
+
+#define DBG_TRACE_DEPTH         4096        /* Entries */
+#define DBG_TRACE_WORDS         2           /* 32-bit words per entry: data, {ts, type, src} */
+
 /*============================================================================
  * Return Codes
  *============================================================================*/
@@ -180,7 +212,9 @@ int dbg_mem_write(uint32_t addr, uint32_t data);
 
 /**
  * Read multiple words
- * @param addr Start address
+ * When both ranges are in HyperRAM the copy runs on the debug port block
+ * engine as 256-beat AXI bursts; otherwise the CPU copies word by word.
+ * @param addr Start address (word aligned)
  * @param buf Output buffer
  * @param count Number of words
  * @return Number of words read, or negative error code
@@ -189,6 +223,7 @@ int dbg_mem_read_block(uint32_t addr, uint32_t *buf, uint32_t count);
 
 /**
  * Write multiple words
+ * Uses the block engine like dbg_mem_read_block().
  * @param addr Start address
  * @param buf Data buffer
  * @param count Number of words
@@ -198,6 +233,7 @@ int dbg_mem_write_block(uint32_t addr, const uint32_t *buf, uint32_t count);
 
 /**
  * Fill memory with pattern
+ * HyperRAM ranges are filled by the block engine without a read phase.
  * @param addr Start address
  * @param pattern Pattern to fill
  * @param count Number of words
@@ -284,6 +320,33 @@ void dbg_trace_status(uint32_t *count, bool *triggered, bool *wrapped);
  */
 int dbg_trace_read(uint32_t index, trace_entry_t *entry);
 
+/**
+ * Read a run of trace entries in one go
+ *
+ * The debug port block engine streams the buffer straight into memory,
+ * DBG_TRACE_WORDS raw words per entry (see dbg_trace_unpack()), with no
+ * CPU access per entry. The destination must be in HyperRAM.
+ *
+ * @param first First entry (0 = oldest)
+ * @param count Entries to read (clipped to the entries captured)
+ * @param dst Output: count * DBG_TRACE_WORDS words
+ * @return Entries read, or DBG_ERR_* on failure
+ */
+int dbg_trace_read_block(uint32_t first, uint32_t count, uint32_t *dst);
+
+/**
+ * Get the entry the trigger fired on
+ * @return Entry index (0 = oldest), only meaningful once triggered
+ */
+uint32_t dbg_trace_trigger_index(void);
+
+/**
+ * Decode one raw entry as returned by dbg_trace_read_block()
+ * @param words Raw entry words
+ * @param entry Output structure
+ */
+void dbg_trace_unpack(const uint32_t words[DBG_TRACE_WORDS], trace_entry_t *entry);
+
 /**
  * Set trace trigger filter
  * @param type_mask Event types to trigger on (bitmask)
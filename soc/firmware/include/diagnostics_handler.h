@@ -70,6 +70,7 @@ int diag_cmd_get_usb_stats(uint8_t *response, uint32_t *len);
 int diag_cmd_get_dma_stats(uint8_t *response, uint32_t *len);
 int diag_cmd_get_fifo_stats(uint8_t *response, uint32_t *len);
 int diag_cmd_get_irq_stats(uint8_t *response, uint32_t *len);
+int diag_cmd_get_profile(uint8_t *response, uint32_t *len);
 
 /*---------------------------------------------------------------------------
  * Signal Analysis Commands
@@ -82,8 +83,27 @@ int diag_cmd_get_jitter_stats(uint8_t *response, uint32_t *len);
 int diag_cmd_get_bit_timing(uint8_t *response, uint32_t *len);
 int diag_cmd_get_weak_bit_map(uint8_t track, uint8_t head,
                               uint8_t *response, uint32_t *len);
+
+/**
+ * Start, stop or drain a decimated waveform capture
+ * With a config, (re)starts the capture (sample_rate_hz 0 stops it;
+ * sample_count 0 runs until stopped; pre_trigger must be 0). Without one,
+ * returns the samples produced since the last call, so a host polling
+ * this command receives a live stream at sample_rate_hz.
+ * @param config capture settings, NULL to drain
+ * @param response diag_waveform_header_t followed by min/max pairs
+ * @param len response length
+ * @return 0 on success, -1 on an invalid config
+ */
 int diag_cmd_capture_waveform(const diag_waveform_config_t *config,
                               uint8_t *response, uint32_t *len);
+
+/**
+ * Get the accumulated eye diagram
+ * @param response diag_eye_header_t followed by the scaled cells
+ * @param len response length
+ * @return 0 on success
+ */
 int diag_cmd_get_eye_diagram(uint8_t *response, uint32_t *len);
 
 /*---------------------------------------------------------------------------
@@ -129,9 +149,30 @@ int diag_cmd_get_state_machines(uint8_t *response, uint32_t *len);
  * Calibration Commands
  *---------------------------------------------------------------------------*/
 
+/**
+ * Run calibration sequences
+ * DIAG_CAL_PLL(d) searches PLL bandwidth/damping on each zone of drive d
+ * (see pll_cal.h).
+ * @param cal_mask DIAG_CAL_* bits
+ * @param response DIAG_CAL_DRIVES diag_cal_record_t, also on failure
+ * @param len response length
+ * @return 0 on success
+ */
 int diag_cmd_run_calibration(uint32_t cal_mask, uint8_t *response, uint32_t *len);
+
+/**
+ * Get the calibration records
+ * @param response DIAG_CAL_DRIVES diag_cal_record_t
+ * @param len response length
+ * @return 0 on success
+ */
 int diag_cmd_get_calibration_data(uint8_t *response, uint32_t *len);
 int diag_cmd_set_calibration_data(const uint8_t *data, uint32_t len);
+
+/**
+ * Save / load the calibration records (board EEPROM)
+ * @return 0 on success, -1 if the EEPROM is not reachable
+ */
 int diag_cmd_save_calibration(void);
 int diag_cmd_load_calibration(void);
 int diag_cmd_factory_reset(void);
@@ -165,11 +206,45 @@ void diag_update_sector_write(void);
 void diag_update_seek(bool success);
 void diag_update_error(uint8_t source, uint16_t code, uint32_t context);
 
+/**
+ * Batched performance counter updates
+ * Account for several packets or transfers in one call, e.g. once per
+ * interrupt rather than once per packet.
+ */
+void diag_update_usb_rx_batch(uint32_t bytes, uint32_t packets);
+void diag_update_usb_tx_batch(uint32_t bytes, uint32_t packets);
+void diag_update_dma_batch(uint32_t bytes, uint32_t transfers);
+
 /**
  * Update signal statistics
  */
 void diag_update_flux_sample(uint32_t flux_word);
+
+/**
+ * Account a block of captured flux words (raw_protocol.h format)
+ * Bins the intervals between consecutive transition timestamps into the
+ * flux histogram; the interval across the previous block's last word is
+ * included. The block is binned locally and merged in one update, so the
+ * per-word cost is a subtract and a shift.
+ * @param words flux words in capture order
+ * @param n number of words
+ */
+void diag_update_flux_block(const uint32_t *words, uint32_t n);
 void diag_update_amplitude(uint16_t amplitude_mv);
+
+/**
+ * Account a block of bit-cell samples (main loop only)
+ * One sample per decoded bit cell: the PLL phase error at the cell and
+ * the read amplitude. Each sample is binned into the eye diagram, which
+ * keeps accumulating across revolutions until reset, and feeds the
+ * waveform capture while one is running.
+ * @param phase PLL phase error, full scale (+/-32768) = +/- half a cell
+ * @param amplitude_mv read amplitude
+ * @param n number of samples
+ * @param rate_hz sample (bit cell) rate, sets the waveform decimation
+ */
+void diag_update_eye_block(const int16_t *phase, const uint16_t *amplitude_mv,
+                           uint32_t n, uint32_t rate_hz);
 void diag_update_pll_lock(bool locked);
 void diag_update_index_pulse(uint32_t period_ns);
 
@@ -198,7 +273,7 @@ void diag_histogram_add_amplitude(uint16_t amplitude_mv);
 void diag_histogram_add_phase_error(int16_t error_deg);
 
 /**
- * Reset all histograms
+ * Reset all histograms, including the eye diagram
  */
 void diag_histogram_reset_all(void);
 
@@ -41,6 +41,8 @@
 #define DIAG_CMD_GET_DMA_STATS      0x93    /* DMA transfer statistics */
 #define DIAG_CMD_GET_FIFO_STATS     0x94    /* FIFO high-water marks */
 #define DIAG_CMD_GET_IRQ_STATS      0x95    /* Interrupt statistics */
+#define DIAG_CMD_GET_PROFILE        0x96    /* Firmware hot path cycle profile */
+#define DIAG_CMD_RESET_PROFILE      0x97    /* Clear cycle profile */
 
 /* Signal Analysis (0xA0-0xAF) */
 #define DIAG_CMD_GET_SIGNAL_STATS   0xA0    /* Comprehensive signal stats */
@@ -73,7 +75,7 @@
 
 /* Debug/Trace (0xD0-0xDF) */
 #define DIAG_CMD_SET_TRACE_MASK     0xD0    /* Configure trace capture */
-#define DIAG_CMD_GET_TRACE_DATA     0xD1    /* Read trace buffer */
+#define DIAG_CMD_GET_TRACE_DATA     0xD1    /* Drain trace buffer, oldest first */
 #define DIAG_CMD_SET_TRIGGER        0xD2    /* Set debug trigger */
 #define DIAG_CMD_ARM_TRIGGER        0xD3    /* Arm trigger */
 #define DIAG_CMD_GET_TRIGGER_STATUS 0xD4    /* Check trigger status */
@@ -208,6 +210,24 @@ typedef struct __attribute__((packed)) {
     uint32_t    flux_fifo_overflows;/* Flux overflow count */
 } diag_fifo_stats_t;
 
+/**
+ * Hot Path Profile
+ * diag_prof_header_t followed by zone_count diag_prof_zone_t, in
+ * prof_zone_t order (prof.h).
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t    cpu_freq_hz;        /* Cycle counter rate */
+    uint8_t     zone_count;         /* Zones that follow */
+    uint8_t     reserved[3];
+} diag_prof_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t    calls;              /* Times the zone was entered */
+    uint32_t    min_cycles;         /* Shortest pass */
+    uint32_t    max_cycles;         /* Longest pass */
+    uint64_t    total_cycles;       /* Sum over all passes */
+} diag_prof_zone_t;
+
 /*---------------------------------------------------------------------------
  * Data Structures - Signal Analysis
  *---------------------------------------------------------------------------*/
@@ -430,11 +450,14 @@ typedef struct __attribute__((packed)) {
 typedef struct __attribute__((packed)) {
     uint32_t    timestamp;          /* Timestamp (clock cycles) */
     uint8_t     event_type;         /* Event type */
-    uint8_t     flags;              /* Event flags */
+    uint8_t     flags;              /* Event flags (DIAG_TRACE_FLAG_*) */
     uint16_t    data_len;           /* Data length following */
     uint32_t    data[4];            /* Event-specific data */
 } diag_trace_entry_t;
 
+/* Trace entry flags */
+#define DIAG_TRACE_FLAG_DROPPED (1 << 0)    /* Events were lost before this one */
+
 /**
  * State Machine Status
  */
@@ -530,8 +553,19 @@ typedef struct __attribute__((packed)) {
     uint16_t    pre_trigger;        /* Pre-trigger samples */
 } diag_waveform_config_t;
 
+/* Trigger sources */
+#define DIAG_WAVE_TRIG_MANUAL   0   /* Start at once */
+#define DIAG_WAVE_TRIG_INDEX    1   /* Start at the next index pulse */
+#define DIAG_WAVE_TRIG_LEVEL    2   /* Start when amplitude crosses trigger_level */
+
 /**
  * Waveform Data Header
+ * Samples are decimated peak-detect pairs: the minimum and maximum
+ * amplitude (uint16 mV each) over each sample_rate_hz period, so short
+ * dropouts survive the decimation. A streamed capture arrives as one
+ * buffer per drain; trigger_pos is then the offset of the buffer's first
+ * pair from the trigger, and a jump past the previous buffer's end marks
+ * pairs lost to a slow host.
  */
 typedef struct __attribute__((packed)) {
     uint32_t    sample_rate_hz;     /* Actual sample rate */
@@ -542,4 +576,76 @@ typedef struct __attribute__((packed)) {
     uint32_t    trigger_pos;        /* Trigger position in buffer */
 } diag_waveform_header_t;
 
+/*---------------------------------------------------------------------------
+ * Eye Diagram
+ *---------------------------------------------------------------------------*/
+
+#define DIAG_EYE_PHASE_BINS     64      /* Columns across one bit cell */
+#define DIAG_EYE_AMPL_BINS      32      /* Rows, 0 mV first */
+#define DIAG_EYE_AMPL_MAX_MV    2048    /* Top of the last row */
+
+/**
+ * Eye Diagram Header
+ * Followed by DIAG_EYE_AMPL_BINS rows of DIAG_EYE_PHASE_BINS bytes. Each
+ * cell is its sample count scaled to the densest cell (255). Column 0 is
+ * half a cell early, the cell centre is column DIAG_EYE_PHASE_BINS / 2.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t    samples;            /* Samples accumulated */
+    uint32_t    revolutions;        /* Index pulses while accumulating */
+    uint16_t    phase_bins;         /* DIAG_EYE_PHASE_BINS */
+    uint16_t    ampl_bins;          /* DIAG_EYE_AMPL_BINS */
+    uint16_t    ampl_bin_mv;        /* Amplitude per row */
+    uint16_t    rescales;           /* Times all counts were halved */
+    uint32_t    peak_count;         /* Count of the densest cell */
+    uint32_t    clipped;            /* Samples above full scale (top row) */
+} diag_eye_header_t;
+
+/*---------------------------------------------------------------------------
+ * Calibration
+ *---------------------------------------------------------------------------*/
+
+#define DIAG_CAL_DRIVES         4       /* FDC drives 0-3 */
+#define DIAG_CAL_ZONES          5       /* Matches zone_calculator.v */
+#define DIAG_CAL_ZONE_TRACKS    16      /* Tracks per zone */
+#define DIAG_CAL_MAGIC          0x4C50  /* "PL" */
+
+/* RUN_CALIBRATION mask bits */
+#define DIAG_CAL_PLL(drive)     (1u << (drive))  /* PLL search, one bit per drive */
+#define DIAG_CAL_PRECOMP(drive) (1u << (8 + (drive)))  /* Write precomp search (overwrites
+                                                          the middle track of each zone) */
+
+#define DIAG_PRECOMP_VALID      0x80    /* diag_precomp_cal_t.code: zone calibrated */
+
+/**
+ * PLL Settings for One Zone
+ * bandwidth_pm 0 means the zone has not been calibrated.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t    bandwidth_pm;       /* Loop bandwidth, per mille of the cell rate */
+    uint16_t    damping;            /* Damping factor x100 */
+    uint8_t     sectors;            /* CRC-good sectors per pass at this setting */
+    uint8_t     phase_rms;          /* RMS phase error, 1/256 cell */
+} diag_pll_cal_t;
+
+/**
+ * Write Precompensation for One Zone
+ * Without DIAG_PRECOMP_VALID the zone has not been calibrated.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t     code;               /* PRECOMP_* (fluxripper_hal.h) | DIAG_PRECOMP_VALID */
+    int8_t      shift;              /* Residual 2T peak shift, 1/256 cell */
+} diag_precomp_cal_t;
+
+/**
+ * Per-Drive Calibration Record (one EEPROM page)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t    magic;              /* DIAG_CAL_MAGIC */
+    diag_pll_cal_t zone[DIAG_CAL_ZONES];
+    diag_precomp_cal_t precomp[DIAG_CAL_ZONES];
+    uint8_t     reserved[20];
+    uint16_t    crc;                /* CRC16 of the preceding bytes */
+} diag_cal_record_t;
+
 #endif /* DIAGNOSTICS_PROTOCOL_H */
@@ -0,0 +1,71 @@
+/**
+ * FluxRipper SoC - Completion Events
+ *
+ * One-shot completion flags raised from interrupt handlers, and a
+ * bounded wait on them. Each wait also re-checks the device status
+ * through a callback every EVENT_POLL_US, so it ends when the hardware
+ * finishes whether or not that device's interrupt is wired up.
+ *
+ * Updated: 2025-12-08 10:00
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Status re-check interval while no interrupt has arrived */
+#define EVENT_POLL_US       20
+
+typedef struct {
+    volatile bool   signalled;
+} event_t;
+
+/**
+ * Hardware completion test
+ * @param arg caller context
+ * @return true once the device has finished (successfully or not)
+ */
+typedef bool (*event_check_t)(void *arg);
+
+/**
+ * Clear an event before starting the operation it will report
+ */
+static inline void event_clear(event_t *ev)
+{
+    ev->signalled = false;
+}
+
+/**
+ * Signal an event (safe from interrupt handlers)
+ */
+static inline void event_signal(event_t *ev)
+{
+    ev->signalled = true;
+}
+
+/**
+ * Wait for an operation to complete
+ * An interrupt (event_signal) triggers an immediate status check;
+ * otherwise check() runs every EVENT_POLL_US. The idle hook runs in
+ * between.
+ * @param ev event raised by the device interrupt, or NULL if none
+ * @param check completion test, evaluated at least once
+ * @param arg context passed to check
+ * @param timeout_ms give up after this long
+ * @return true if check() reported completion, false on timeout
+ */
+bool event_wait(event_t *ev, event_check_t check, void *arg, uint32_t timeout_ms);
+
+/**
+ * Set work to run while a wait is pending
+ * The hook runs in the middle of driver operations, so it must not
+ * start another drive operation; task_yield() (the scheduler's hook)
+ * holds back TASK_DRIVES work while a drive task is running.
+ * @param hook function to call, or NULL to disable
+ */
+void event_set_idle_hook(void (*hook)(void));
+
+#endif /* EVENT_H */
@@ -0,0 +1,267 @@
+/**
+ * FluxRipper Software Flux Decoder
+ *
+ * Reference PLL and channel decoders for re-decoding captured flux in
+ * firmware, built unchanged for the host tools (make host). Mirrors the
+ * data separator and rtl/encoding decoders closely enough to score PLL
+ * settings and count recoverable sectors, without the hardware in the
+ * loop.
+ *
+ * Flux is processed in blocks of FDEC_BLOCK transitions through three
+ * stages:
+ *   fdec_src_block()  flux words -> intervals (index marks dropped)
+ *   fdec_pll_block()  intervals  -> cell runs (PI loop on the cell period)
+ *   fdec_feed()       cell runs  -> marks, fields, sector status
+ * Each stage is a tight loop over its block. The decoder is specialized
+ * per encoding when it is compiled; fdec_init() picks the variant once,
+ * so the inner loop never switches on the encoding.
+ *
+ * Encodings:
+ *   ENC_FM, ENC_MFM    IBM 3740 / System 34 marks and CRC16 fields
+ *   ENC_M2FM           F77A sync (m2fm_sync_detector), then IBM-style
+ *                      mark byte and fields
+ *   ENC_GCR_APPLE      DOS 3.3 6-and-2: D5 AA 96 address, D5 AA AD data
+ *   ENC_GCR_C64        CBM GCR: sync, 0x08 header, 0x07 data block
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-10 19:00
+ */
+
+#ifndef FLUX_DECODE_H
+#define FLUX_DECODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#define FDEC_BLOCK              256         /* Transitions per block */
+#define FDEC_MAX_RUN            8           /* Longer gaps drop lock (cells) */
+#define FDEC_ID_TO_DATA_CELLS   1024        /* Max ID field end to data mark */
+
+/* Loop settings used when a drive/zone is not calibrated */
+#define FDEC_DEFAULT_BW_PM      10          /* Per mille of the cell rate */
+#define FDEC_DEFAULT_DAMPING    71          /* x100 */
+
+/* Cell run codes besides 1..FDEC_MAX_RUN */
+#define FDEC_RUN_NONE           0           /* Pulse inside the current cell */
+#define FDEC_RUN_LOST           0xFF        /* Dropout, lock lost */
+
+/* fdec_cd_mark() results besides a mark byte */
+#define FDEC_MARK_NONE          0
+#define FDEC_MARK_SYNC          1           /* Sync; the mark byte follows */
+
+/* IBM address marks */
+#define FDEC_MARK_IDAM          0xFE
+#define FDEC_MARK_DAM           0xFB
+#define FDEC_MARK_DDAM          0xF8
+
+/* fdec_sector_t flags */
+#define FDEC_SEC_ID_OK          (1 << 0)    /* ID field check passed */
+#define FDEC_SEC_DATA           (1 << 1)    /* Data field found */
+#define FDEC_SEC_DATA_OK        (1 << 2)    /* Data field check passed */
+#define FDEC_SEC_DELETED        (1 << 3)    /* Deleted data mark */
+
+/*============================================================================
+ * Data Structures
+ *============================================================================*/
+
+/**
+ * Flux word source for one pass
+ */
+typedef struct {
+    const uint32_t *words;
+    uint32_t    count;
+    uint32_t    pos;
+    uint32_t    prev;               /* Timestamp of the last transition */
+    bool        primed;             /* prev is valid */
+    uint32_t    gap_max;            /* Intervals clamp here (clocks) */
+} fdec_src_t;
+
+/**
+ * PI loop on the cell period, in Q8 capture clocks
+ */
+typedef struct {
+    int32_t     period;             /* Tracked cell period */
+    int32_t     carry;              /* Time since the last cell centre */
+    int32_t     p0;                 /* Nominal cell period */
+    int32_t     pmin, pmax;         /* Period limits (+/- 1/8) */
+    int32_t     kp;                 /* Proportional gain, Q12 */
+    int32_t     ki;                 /* Integral gain, Q16 */
+    uint32_t    transitions;        /* Transitions tracked in lock */
+    uint64_t    err2;               /* Sum of squared phase error */
+} fdec_pll_t;
+
+/**
+ * Sector found on the track
+ * GCR formats report the track as cylinder and a 256-byte size code (1).
+ */
+typedef struct {
+    uint8_t     cylinder;
+    uint8_t     head;
+    uint8_t     sector;
+    uint8_t     size_code;
+    uint8_t     flags;              /* FDEC_SEC_* */
+    uint32_t    id_cell;            /* Cell after the ID mark, from pass start */
+    uint32_t    data_cell;          /* Cell after the data mark */
+} fdec_sector_t;
+
+/**
+ * Decode results; the sector list is optional
+ */
+typedef struct {
+    uint32_t    ids;                /* Good ID fields */
+    uint32_t    sectors;            /* Good data fields */
+    uint32_t    bad_ids;
+    uint32_t    bad_data;
+    fdec_sector_t *list;            /* NULL: count only */
+    uint8_t     list_max;
+    uint8_t     count;              /* Entries in list */
+} fdec_track_t;
+
+typedef struct fdec fdec_t;
+typedef void (*fdec_feed_fn)(fdec_t *d, const uint8_t *runs, uint32_t n);
+
+/**
+ * Channel decoder and field framer state
+ */
+struct fdec {
+    fdec_feed_fn feed;
+    fdec_track_t *out;
+    uint32_t    cell;               /* Cells since the pass start */
+    uint32_t    sr;                 /* Recovered cells, newest in bit 0 */
+    uint32_t    marks;              /* GCR: last nibbles/bytes seen */
+    uint16_t    crc;                /* IBM: running CRC */
+    uint16_t    left;               /* Bytes left in the field */
+    uint8_t     encoding;
+    uint8_t     bits;               /* Cells of the current byte */
+    uint8_t     state;
+    uint8_t     ones;               /* C64: consecutive one cells */
+    uint8_t     sum;                /* GCR: running checksum */
+    bool        bad;                /* GCR: invalid code in the field */
+    uint8_t     hdr[8];             /* ID field bytes */
+    uint8_t     pos;                /* Next hdr[] byte */
+    int8_t      pend_slot;          /* List slot of the pending ID, -1 none */
+    bool        pend_ok;            /* An ID field awaits its data field */
+    uint16_t    pend_size;          /* Its data field size */
+    uint32_t    pend_cell;          /* Where it ended */
+};
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+/**
+ * Check whether an encoding has a decoder
+ */
+bool fdec_supported(uint8_t encoding);
+
+/**
+ * Nominal channel cell in capture clocks
+ * FM-family encodings carry a clock and a data cell per bit; GCR cells
+ * are the data bits.
+ * @param encoding  ENC_*
+ * @param data_rate data rate in bps (0 = 250 kbps)
+ */
+uint32_t fdec_cell_ticks(uint8_t encoding, uint32_t data_rate);
+
+/**
+ * Start reading one pass of flux words
+ */
+void fdec_src_init(fdec_src_t *s, const uint32_t *words, uint32_t count,
+                   uint32_t cell_ticks);
+
+/**
+ * Read the next block of intervals
+ * @param dt    Output: up to FDEC_BLOCK intervals, Q8 clocks
+ * @return intervals read, 0 at the end of the pass
+ */
+uint32_t fdec_src_block(fdec_src_t *s, int32_t *dt);
+
+/**
+ * Reset a loop
+ * @param cell_ticks    nominal cell, capture clocks
+ * @param bandwidth_pm  loop bandwidth, per mille of the cell rate
+ * @param damping       damping factor x100
+ */
+void fdec_pll_init(fdec_pll_t *p, uint32_t cell_ticks, uint16_t bandwidth_pm,
+                   uint16_t damping);
+
+/**
+ * Track a block of intervals
+ * @param dt    intervals from fdec_src_block()
+ * @param n     interval count
+ * @param runs  Output: cells per interval, the last one a transition
+ *              (FDEC_RUN_NONE / FDEC_RUN_LOST otherwise)
+ */
+void fdec_pll_block(fdec_pll_t *p, const int32_t *dt, uint32_t n, uint8_t *runs);
+
+/**
+ * RMS phase error in 1/256 cell
+ * @param err2          fdec_pll_t err2 (summed over any number of passes)
+ * @param transitions   matching transition count
+ * @param cell_ticks    nominal cell, capture clocks
+ */
+uint8_t fdec_phase_rms(uint64_t err2, uint32_t transitions, uint32_t cell_ticks);
+
+/**
+ * Clear decode results
+ * @param list      sector list (NULL: count only)
+ * @param list_max  list entries
+ */
+void fdec_track_init(fdec_track_t *t, fdec_sector_t *list, uint8_t list_max);
+
+/**
+ * Start decoding a pass
+ * @return 0, or -1 for an unsupported encoding
+ */
+int fdec_init(fdec_t *d, uint8_t encoding, fdec_track_t *out);
+
+/**
+ * Decode a block of cell runs from fdec_pll_block()
+ */
+static inline void fdec_feed(fdec_t *d, const uint8_t *runs, uint32_t n)
+{
+    d->feed(d, runs, n);
+}
+
+/**
+ * Decode one pass of flux words with the given loop settings
+ * @return 0, or -1 for an unsupported encoding
+ */
+int fdec_decode_pass(const uint32_t *words, uint32_t count, uint8_t encoding,
+                     uint32_t data_rate, uint16_t bandwidth_pm, uint16_t damping,
+                     fdec_track_t *out);
+
+/*============================================================================
+ * Cell Stream Primitives (FM, MFM, M2FM)
+ *
+ * For decoders that produce their own cells, e.g. the FluxStat pass
+ * correlator.
+ *============================================================================*/
+
+/**
+ * Check whether an encoding interleaves clock and data cells
+ */
+bool fdec_is_clock_data(uint8_t encoding);
+
+/**
+ * Data byte of 16 clock/data cells (clock first)
+ */
+uint8_t fdec_cd_byte(uint16_t cells);
+
+/**
+ * Match the last 16 cells against the encoding's marks
+ * @return FDEC_MARK_NONE, FDEC_MARK_SYNC, or the mark byte of a mark
+ *         that carries its own value (FM)
+ */
+uint8_t fdec_cd_mark(uint8_t encoding, uint16_t cells);
+
+/**
+ * CRC preset for a field: sync bytes and mark byte
+ */
+uint16_t fdec_mark_crc(uint8_t encoding, uint8_t mark);
+
+#endif /* FLUX_DECODE_H */
@@ -71,12 +71,23 @@
 #define DSR_SW_RESET        BIT(7)  /* Software Reset */
 #define DSR_POWER_DOWN      BIT(6)  /* Power Down */
 #define DSR_PRECOMP_MASK    (0x7 << 2)  /* Precompensation */
+#define DSR_PRECOMP_SHIFT   2
 #define DSR_DRATE_MASK      (0x3 << 0)  /* Data Rate */
 #define DSR_DRATE_500K      0x00    /* 500 Kbps (HD) */
 #define DSR_DRATE_300K      0x01    /* 300 Kbps (DD) */
 #define DSR_DRATE_250K      0x02    /* 250 Kbps (DD) */
 #define DSR_DRATE_1M        0x03    /* 1 Mbps (ED) */
 
+/* DSR precompensation codes (write shift of early/late bits) */
+#define PRECOMP_DEFAULT     0       /* 125 ns, 41.67 ns at 1 Mbps */
+#define PRECOMP_41NS        1       /* 41.67 ns */
+#define PRECOMP_83NS        2       /* 83.34 ns */
+#define PRECOMP_125NS       3       /* 125.00 ns */
+#define PRECOMP_167NS       4       /* 166.67 ns */
+#define PRECOMP_208NS       5       /* 208.33 ns */
+#define PRECOMP_250NS       6       /* 250.00 ns */
+#define PRECOMP_OFF         7       /* 0 ns */
+
 /* Digital Output Register (DOR) */
 #define DOR_MOTOR_3         BIT(7)  /* Motor Enable Drive 3 */
 #define DOR_MOTOR_2         BIT(6)  /* Motor Enable Drive 2 */
@@ -111,6 +122,32 @@
 #define SRB_DRV0_WP         BIT(9)      /* Drive 0 Write Protect */
 #define SRB_DRV1_WP         BIT(8)      /* Drive 1 Write Protect */
 
+/* FDC B Extended Status (FDC_B_STATUS) */
+#define FDC_B_STAT_PLL_LOCK BIT(7)  /* FDC B PLL Locked */
+#define FDC_B_STAT_BUSY     BIT(6)  /* FDC B Command Busy */
+
+/* Result Phase Status Bytes */
+#define ST0_IC_MASK         (0x3 << 6)  /* Interrupt Code */
+#define ST0_IC_NORMAL       (0x0 << 6)  /* Normal termination */
+#define ST0_IC_ABNORMAL     (0x1 << 6)  /* Abnormal termination */
+#define ST1_EN              BIT(7)  /* End of Cylinder */
+#define ST1_DE              BIT(5)  /* Data Error (CRC) */
+#define ST1_OR              BIT(4)  /* Overrun */
+#define ST1_ND              BIT(2)  /* No Data */
+#define ST1_NW              BIT(1)  /* Not Writable */
+#define ST1_MA              BIT(0)  /* Missing Address Mark */
+#define ST2_DD              BIT(5)  /* Data Error in Data Field */
+
+/* 82077AA Commands */
+#define FDC_CMD_SPECIFY     0x03
+#define FDC_CMD_WRITE_DATA  0x05
+#define FDC_CMD_READ_DATA   0x06
+#define FDC_CMD_VERIFY      0x16    /* READ DATA without the data phase */
+#define FDC_CMD_READ_ID     0x0A
+#define FDC_CMD_CONFIGURE   0x13
+#define FDC_CMD_MFM         BIT(6)  /* MFM encoding */
+#define FDC_CMD_MT          BIT(7)  /* Multi-track */
+
 /* Flux Control Register */
 #define FLUX_CTRL_START     BIT(0)  /* Start Capture */
 #define FLUX_CTRL_STOP      BIT(1)  /* Stop Capture */
@@ -202,6 +239,11 @@
 #define DENS_ED         2  /* Extended Density */
 #define DENS_UNKNOWN    3
 
+/* Track Count (drive_profile_t.tracks holds the count itself) */
+#define TRACKS_40       40
+#define TRACKS_77       77  /* 8" drives */
+#define TRACKS_80       80
+
 /* Encoding */
 #define ENC_UNKNOWN     0
 #define ENC_FM          1  /* FM (Single Density) */
@@ -227,6 +269,10 @@ typedef enum {
 #define HAL_ERR_OVERFLOW    -6  /* Buffer overflow */
 #define HAL_ERR_HARDWARE    -7  /* Hardware error */
 #define HAL_ERR_MODE        -8  /* Invalid mode for operation */
+#define HAL_ERR_BUSY        -9  /* Operation still in progress */
+#define HAL_ERR_CRC         -10 /* Data CRC error */
+#define HAL_ERR_NOT_SUPPORTED -11 /* Not supported by this drive/interface */
+#define HAL_ERR_CMD         -12 /* Drive rejected the command */
 
 /* Drive Numbers */
 #define DRIVE_A         0
@@ -238,6 +284,19 @@ typedef enum {
 #define TIMEOUT_MOTOR       500     /* Motor spin-up */
 #define TIMEOUT_SEEK        5000    /* Head seek */
 #define TIMEOUT_OPERATION   10000   /* General operation */
+#define SEEK_SETTLE_MS      15      /* Head settle after seek */
+
+/* Motor idle policy: a released motor stops after this long unused */
+#define MOTOR_IDLE_MS       5000    /* 0 = stop at hal_motor_release() */
+
+/* Sector Access */
+#define FDC_SECTOR_SIZE     512
+#define FDC_READ_RETRIES    3       /* Attempts per track on CRC error */
+#define FDC_TRACK_MAX_SECTORS 64    /* hal_sector_capture_t.bad_mask width */
+
+/* Write precompensation zones (as zone_calculator.v, last one open-ended) */
+#define HAL_PRECOMP_ZONES       5
+#define HAL_PRECOMP_ZONE_TRACKS 16
 
 /*============================================================================
  * Data Structures
@@ -258,6 +317,25 @@ typedef struct {
     bool     locked;        /* Profile is stable */
 } drive_profile_t;
 
+/**
+ * Motor Counters
+ */
+typedef struct {
+    uint32_t spinups;       /* Motor starts from standstill */
+    uint32_t reuses;        /* Motor-on requests served by a running motor */
+    uint32_t idle_stops;    /* Motors stopped by the idle timeout */
+} hal_motor_stats_t;
+
+/**
+ * Sector Capture Result
+ * One track side read by hal_sector_capture_start()
+ */
+typedef struct {
+    uint8_t  sectors;       /* Sectors per track side (R = 1..sectors) */
+    uint8_t  bad;           /* Sectors that failed CRC or were not read */
+    uint64_t bad_mask;      /* Bit n: sector n+1 is bad */
+} hal_sector_capture_t;
+
 /**
  * Flux Capture Callback
  * Called when flux data is available or capture completes
@@ -297,6 +375,14 @@ uint32_t hal_get_version(void);
  */
 hal_mode_t hal_get_mode(uint8_t drive);
 
+/**
+ * Get the cylinder the heads were last positioned on
+ *
+ * @param drive     Drive number (0-1)
+ * @return Present cylinder number, 0 on error
+ */
+uint8_t hal_get_track(uint8_t drive);
+
 /**
  * Get detected drive profile
  * Reads auto-detected or manually configured drive parameters.
@@ -307,9 +393,32 @@ hal_mode_t hal_get_mode(uint8_t drive);
  */
 int hal_get_profile(uint8_t drive, drive_profile_t *profile);
 
+/**
+ * Start drive motor without waiting for it to reach speed
+ * Used by the spin-up scheduler to overlap several drives; poll
+ * hal_motor_at_speed() for completion.
+ *
+ * @param drive     Drive number (0-1)
+ * @return HAL_OK on success, error code otherwise
+ */
+int hal_motor_start(uint8_t drive);
+
+/**
+ * Check whether the motor has reached operating speed
+ * A started motor counts as up TIMEOUT_MOTOR after hal_motor_start().
+ *
+ * @param drive     Drive number (0-1)
+ * @return true once the motor is at speed
+ */
+bool hal_motor_at_speed(uint8_t drive);
+
 /**
  * Turn drive motor on
- * Waits for motor to reach operating speed.
+ * Powers the connector and starts the motor through the spin-up
+ * scheduler (spinup.h), then waits for it to reach operating speed.
+ * A motor still running from an earlier job is reused as is. The caller
+ * holds the motor: the idle timeout leaves it alone until
+ * hal_motor_release().
  *
  * @param drive     Drive number (0-1)
  * @return HAL_OK on success, error code otherwise
@@ -318,12 +427,51 @@ int hal_motor_on(uint8_t drive);
 
 /**
  * Turn drive motor off
+ * Stops the motor now; for "done for the moment" use hal_motor_release().
  *
  * @param drive     Drive number (0-1)
  * @return HAL_OK on success, error code otherwise
  */
 int hal_motor_off(uint8_t drive);
 
+/**
+ * Release drive motor
+ * Leaves the motor running so a following job on the same drive starts
+ * without a spin-up; hal_motor_poll() stops it once it has been idle
+ * for the motor idle timeout. With a timeout of 0 it stops now.
+ *
+ * @param drive     Drive number (0-1)
+ * @return HAL_OK on success, error code otherwise
+ */
+int hal_motor_release(uint8_t drive);
+
+/**
+ * Stop motors idle past the timeout
+ * Any motor access (motor-on, seek, capture) restarts a drive's idle
+ * time; drives with a capture or seek in progress are never idle.
+ * Called from the drive task loop.
+ */
+void hal_motor_poll(void);
+
+/**
+ * Set motor idle timeout
+ * @param idle_ms   Idle time before a released motor stops, 0 to stop
+ *                  at release
+ */
+void hal_motor_set_idle_ms(uint32_t idle_ms);
+
+/**
+ * Get motor idle timeout
+ * @return Idle time in milliseconds
+ */
+uint32_t hal_motor_get_idle_ms(void);
+
+/**
+ * Get motor counters
+ * @param stats     Output: counters since boot
+ */
+void hal_motor_get_stats(hal_motor_stats_t *stats);
+
 /**
  * Seek to specified track
  * Uses FDC SEEK command for accurate positioning.
@@ -336,7 +484,8 @@ int hal_seek(uint8_t drive, uint8_t track);
 
 /**
  * Read sectors using FDC
- * Standard sector read using 82077AA commands.
+ * Standard sector read using 82077AA commands. Issues one READ DATA per
+ * track side covered by the request and one seek per cylinder.
  *
  * @param drive     Drive number (0-1)
  * @param lba       Logical block address
@@ -346,6 +495,139 @@ int hal_seek(uint8_t drive, uint8_t track);
  */
 int hal_read_sectors(uint8_t drive, uint32_t lba, void *buf, uint32_t count);
 
+/**
+ * Write sectors using FDC
+ * Counterpart of hal_read_sectors(); one WRITE DATA per track side, with
+ * the DSR precompensation set for the track's zone
+ * (hal_set_write_precomp()). An underrun is retried; there is no
+ * read-back verify.
+ *
+ * @param drive     Drive number (0-1)
+ * @param lba       Logical block address
+ * @param buf       Sector data (512*count bytes)
+ * @param count     Number of sectors to write
+ * @return HAL_OK on success, HAL_ERR_WRITE_PROT or other error code otherwise
+ */
+int hal_write_sectors(uint8_t drive, uint32_t lba, const void *buf, uint32_t count);
+
+/**
+ * Set the write precompensation of a zone of tracks
+ * Zone z covers tracks z * HAL_PRECOMP_ZONE_TRACKS onwards; the last zone
+ * runs to the end of the disk. All zones start at PRECOMP_DEFAULT.
+ *
+ * @param drive     Drive number (0-1)
+ * @param zone      Zone (0 .. HAL_PRECOMP_ZONES-1)
+ * @param code      PRECOMP_* code
+ * @return HAL_OK, HAL_ERR_INVALID for a bad drive, zone or code
+ */
+int hal_set_write_precomp(uint8_t drive, uint8_t zone, uint8_t code);
+
+/**
+ * Get the write precompensation used on a track
+ *
+ * @param drive     Drive number (0-1)
+ * @param track     Track number
+ * @return PRECOMP_* code
+ */
+uint8_t hal_get_write_precomp(uint8_t drive, uint8_t track);
+
+/**
+ * Get the sectors per track side of the inserted media
+ * The layout hal_read_sectors() and hal_write_sectors() map LBAs with.
+ *
+ * @param drive     Drive number (0-1)
+ * @return sectors per track side
+ */
+uint8_t hal_get_sectors_per_track(uint8_t drive);
+
+/**
+ * Verify sectors using FDC
+ * One VERIFY per track side: the controller reads and CRC-checks every
+ * sector in the decoder without a data phase, so nothing crosses the
+ * FIFO. Retries like hal_read_sectors().
+ *
+ * @param drive     Drive number (0-1)
+ * @param lba       Logical block address
+ * @param count     Number of sectors to verify
+ * @param bad_lba   Output: first sector that failed (may be NULL)
+ * @return HAL_OK if all sectors read back clean, HAL_ERR_CRC or other
+ *         error code otherwise
+ */
+int hal_verify_sectors(uint8_t drive, uint32_t lba, uint32_t count, uint32_t *bad_lba);
+
+/**
+ * Start a seek without waiting for it
+ * Issues the SEEK command and returns; complete with hal_seek_poll().
+ *
+ * @param drive     Drive number (0-1)
+ * @param track     Target track number
+ * @return HAL_OK if the seek was issued, error code otherwise
+ */
+int hal_seek_start(uint8_t drive, uint8_t track);
+
+/**
+ * Poll a seek started by hal_seek_start()
+ * Reports busy until the seek has completed and the head has settled.
+ * hal_seek() and hal_read_sectors() wait out a pending seek themselves.
+ *
+ * @param drive     Drive number (0-1)
+ * @return HAL_OK when settled, HAL_ERR_BUSY while in progress, error otherwise
+ */
+int hal_seek_poll(uint8_t drive);
+
+/**
+ * Arm flux capture on the current track
+ * No seek and no reset delay: the capture engine waits for the next index
+ * pulse and captures from there, so arming right after head settle loses
+ * at most the remainder of the current revolution.
+ *
+ * The flux engine reads the side the FDC has selected; a side change is
+ * made with a READ ID on that head before arming.
+ *
+ * @param drive         Drive number (0-1)
+ * @param head          Head to capture (0-1)
+ * @param revolutions   Number of revolutions (1-255)
+ * @param callback      Callback for flux data
+ * @return HAL_OK on success, error code otherwise
+ */
+int hal_arm_flux_capture(uint8_t drive, uint8_t head,
+                         uint8_t revolutions, flux_cb_t callback);
+
+/**
+ * Read a track side's sectors alongside an armed flux capture
+ * The FDC's decoder runs on the same read data as the flux engine, so
+ * the sectors come from the revolution being captured. There is no DMA
+ * channel for the FDC: hal_sector_capture_poll() drains its FIFO, and
+ * must be called often enough to keep up with the data rate (a FIFO
+ * overrun loses the rest of the track). A sector that fails CRC is
+ * marked bad and the read restarts at the next one.
+ *
+ * @param drive     Drive number (0-1), armed with hal_arm_flux_capture()
+ * @param head      Head being captured (0-1)
+ * @param buf       Sector data, FDC_TRACK_MAX_SECTORS * 512 bytes; sector
+ *                  R lands at (R-1) * 512, bad sectors hold what was read
+ * @return HAL_OK if the read was issued, HAL_ERR_BUSY if one is already
+ *         running, HAL_ERR_MODE without an armed capture, error otherwise
+ */
+int hal_sector_capture_start(uint8_t drive, uint8_t head, void *buf);
+
+/**
+ * Move data of a sector capture from the FDC FIFO and follow it up
+ *
+ * @param result    Output: the track side, once complete
+ * @return HAL_OK when every sector has been attempted, HAL_ERR_BUSY while
+ *         running, HAL_ERR_TIMEOUT or other error if the read was cut short
+ *         (the unread sectors are marked bad)
+ */
+int hal_sector_capture_poll(hal_sector_capture_t *result);
+
+/**
+ * Abandon a sector capture
+ * READ DATA cannot be aborted, so the command is run out with its data
+ * discarded; the FDC is free for sector commands on return.
+ */
+void hal_sector_capture_cancel(void);
+
 /**
  * Start flux capture
  * Captures raw flux transitions for specified number of revolutions.
@@ -394,6 +676,9 @@ int hal_reset(void);
 
 /*============================================================================
  * Low-Level Register Access (for advanced use)
+ *
+ * These talk to interface A (DRIVE_A) only; the HAL drives interface B
+ * through its own MSR/DATA pair internally.
  *============================================================================*/
 
 /**
@@ -12,12 +12,12 @@
 #include "cli.h"
 
 /**
- * FluxStat CLI command definition for registration
+ * FluxStat CLI command definition (linked in with CLI_COMMAND)
  */
 extern const cli_cmd_t fluxstat_cli_cmd;
 
 /**
- * Initialize and register FluxStat CLI commands
+ * Initialize the FluxStat HAL behind the 'fluxstat' command
  */
 void fluxstat_cli_init(void);
 
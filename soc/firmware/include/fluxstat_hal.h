@@ -13,43 +13,68 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "platform.h"
+#include "ddr_arena.h"
 
 /*============================================================================
- * FluxStat Register Offsets (from FLUXSTAT_BASE)
+ * FluxStat Register Offsets (from FLUXSTAT_IF_BASE(i))
+ *
+ * One register block per FDC interface: interface A (drives 0-1) and
+ * interface B (drives 2-3) each have their own multipass engine and
+ * histogram, so both can capture at once.
  *============================================================================*/
 
-#define FLUXSTAT_BASE           (PERIPH_BASE + 0xB000)
+#define FLUXSTAT_BASE              (PERIPH_BASE + 0xB000)
+#define FLUXSTAT_IF_STRIDE         0x800
+#define FLUXSTAT_IF_BASE(i)        (FLUXSTAT_BASE + (uint32_t)(i) * FLUXSTAT_IF_STRIDE)
 
 /* Multipass Capture Registers (0x00-0x1C) */
-#define FLUXSTAT_MP_CTRL        (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x00))
-#define FLUXSTAT_MP_STATUS      (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x04))
-#define FLUXSTAT_MP_BASE_ADDR   (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x08))
-#define FLUXSTAT_MP_TOTAL_FLUX  (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x0C))
-#define FLUXSTAT_MP_MIN_FLUX    (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x10))
-#define FLUXSTAT_MP_MAX_FLUX    (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x14))
-#define FLUXSTAT_MP_TOTAL_TIME  (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x18))
+#define FLUXSTAT_MP_CTRL(i)        REG32(FLUXSTAT_IF_BASE(i) + 0x00)
+#define FLUXSTAT_MP_STATUS(i)      REG32(FLUXSTAT_IF_BASE(i) + 0x04)
+#define FLUXSTAT_MP_BASE_ADDR(i)   REG32(FLUXSTAT_IF_BASE(i) + 0x08)
+#define FLUXSTAT_MP_TOTAL_FLUX(i)  REG32(FLUXSTAT_IF_BASE(i) + 0x0C)
+#define FLUXSTAT_MP_MIN_FLUX(i)    REG32(FLUXSTAT_IF_BASE(i) + 0x10)
+#define FLUXSTAT_MP_MAX_FLUX(i)    REG32(FLUXSTAT_IF_BASE(i) + 0x14)
+#define FLUXSTAT_MP_TOTAL_TIME(i)  REG32(FLUXSTAT_IF_BASE(i) + 0x18)
 
 /* Per-Pass Flux Count Array (0x20-0x9F) - 32 passes */
-#define FLUXSTAT_PASS_FLUX(n)   (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x20 + (n)*4))
+#define FLUXSTAT_PASS_FLUX(i, n)   REG32(FLUXSTAT_IF_BASE(i) + 0x20 + (n)*4)
 
 /* Per-Pass Index Time Array (0xA0-0x11F) - 32 passes */
-#define FLUXSTAT_PASS_TIME(n)   (*(volatile uint32_t *)(FLUXSTAT_BASE + 0xA0 + (n)*4))
+#define FLUXSTAT_PASS_TIME(i, n)   REG32(FLUXSTAT_IF_BASE(i) + 0xA0 + (n)*4)
 
 /* Histogram Registers (0x120-0x13C) */
-#define FLUXSTAT_HIST_CTRL      (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x120))
-#define FLUXSTAT_HIST_READ_BIN  (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x124))
-#define FLUXSTAT_HIST_READ_DATA (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x128))
-#define FLUXSTAT_HIST_TOTAL     (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x12C))
-#define FLUXSTAT_HIST_MIN       (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x130))
-#define FLUXSTAT_HIST_MAX       (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x134))
-#define FLUXSTAT_HIST_PEAK_BIN  (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x138))
-#define FLUXSTAT_HIST_MEAN      (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x13C))
+#define FLUXSTAT_HIST_CTRL(i)      REG32(FLUXSTAT_IF_BASE(i) + 0x120)
+#define FLUXSTAT_HIST_READ_BIN(i)  REG32(FLUXSTAT_IF_BASE(i) + 0x124)
+#define FLUXSTAT_HIST_READ_DATA(i) REG32(FLUXSTAT_IF_BASE(i) + 0x128)
+#define FLUXSTAT_HIST_TOTAL(i)     REG32(FLUXSTAT_IF_BASE(i) + 0x12C)
+#define FLUXSTAT_HIST_MIN(i)       REG32(FLUXSTAT_IF_BASE(i) + 0x130)
+#define FLUXSTAT_HIST_MAX(i)       REG32(FLUXSTAT_IF_BASE(i) + 0x134)
+#define FLUXSTAT_HIST_PEAK_BIN(i)  REG32(FLUXSTAT_IF_BASE(i) + 0x138)
+#define FLUXSTAT_HIST_MEAN(i)      REG32(FLUXSTAT_IF_BASE(i) + 0x13C)
 
 /* Snapshot Registers (0x140-0x14C) */
-#define FLUXSTAT_SNAP_TOTAL     (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x140))
-#define FLUXSTAT_SNAP_PEAK_BIN  (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x144))
-#define FLUXSTAT_SNAP_PEAK_CNT  (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x148))
-#define FLUXSTAT_SNAP_MEAN      (*(volatile uint32_t *)(FLUXSTAT_BASE + 0x14C))
+#define FLUXSTAT_SNAP_TOTAL(i)     REG32(FLUXSTAT_IF_BASE(i) + 0x140)
+#define FLUXSTAT_SNAP_PEAK_BIN(i)  REG32(FLUXSTAT_IF_BASE(i) + 0x144)
+#define FLUXSTAT_SNAP_PEAK_CNT(i)  REG32(FLUXSTAT_IF_BASE(i) + 0x148)
+#define FLUXSTAT_SNAP_MEAN(i)      REG32(FLUXSTAT_IF_BASE(i) + 0x14C)
+
+/* Histogram Bank Registers (0x150-0x168) - frozen bank, captured on swap */
+#define FLUXSTAT_BANK_STATUS(i)    REG32(FLUXSTAT_IF_BASE(i) + 0x150)
+#define FLUXSTAT_FRZ_TOTAL(i)      REG32(FLUXSTAT_IF_BASE(i) + 0x154)
+#define FLUXSTAT_FRZ_MIN(i)        REG32(FLUXSTAT_IF_BASE(i) + 0x158)
+#define FLUXSTAT_FRZ_MAX(i)        REG32(FLUXSTAT_IF_BASE(i) + 0x15C)
+#define FLUXSTAT_FRZ_PEAK_BIN(i)   REG32(FLUXSTAT_IF_BASE(i) + 0x160)
+#define FLUXSTAT_FRZ_MEAN(i)       REG32(FLUXSTAT_IF_BASE(i) + 0x164)
+#define FLUXSTAT_FRZ_OVERFLOW(i)   REG32(FLUXSTAT_IF_BASE(i) + 0x168)
+
+/* Capture Window Registers (0x170-0x178) - latched at MP_CTRL_START */
+#define FLUXSTAT_MP_WIN_START(i)   REG32(FLUXSTAT_IF_BASE(i) + 0x170)
+#define FLUXSTAT_MP_WIN_LEN(i)     REG32(FLUXSTAT_IF_BASE(i) + 0x174)
+#define FLUXSTAT_MP_STRIDE(i)      REG32(FLUXSTAT_IF_BASE(i) + 0x178)
+
+/* Histogram Bin Window (0x400-0x5FC) - word n = bin 2n [15:0], bin 2n+1 [31:16] */
+#define FLUXSTAT_HIST_WINDOW(i)    (&REG32(FLUXSTAT_IF_BASE(i) + 0x400))
+#define FLUXSTAT_HIST_PAIR(i, n)   (FLUXSTAT_HIST_WINDOW(i)[(n)])
 
 /*============================================================================
  * Register Bit Definitions
@@ -74,6 +99,13 @@
 #define HIST_CTRL_ENABLE        (1 << 0)    /* Enable histogram */
 #define HIST_CTRL_CLEAR         (1 << 1)    /* Clear histogram */
 #define HIST_CTRL_SNAPSHOT      (1 << 2)    /* Take snapshot */
+#define HIST_CTRL_BANKED        (1 << 3)    /* Ping-pong banks, reads see frozen bank */
+#define HIST_CTRL_SWAP_INDEX    (1 << 4)    /* Swap banks on every index pulse */
+#define HIST_CTRL_SWAP          (1 << 5)    /* Swap banks now */
+
+/* BANK_STATUS Register */
+#define BANK_STATUS_SWAPS_MASK  0xFFFF      /* Swaps since clear */
+#define BANK_STATUS_ACTIVE      (1 << 16)   /* Bank being counted */
 
 /*============================================================================
  * Constants
@@ -82,11 +114,28 @@
 #define FLUXSTAT_MAX_PASSES     64          /* Maximum capture passes */
 #define FLUXSTAT_MIN_PASSES     2           /* Minimum for statistics */
 #define FLUXSTAT_DEFAULT_PASSES 8           /* Default pass count */
+#define FLUXSTAT_DEFAULT_STALL  2           /* Adaptive: passes without gain before stopping */
 
 #define FLUXSTAT_HIST_BINS      256         /* Histogram bin count */
 #define FLUXSTAT_HIST_BIN_SHIFT 2           /* Interval >> shift = bin */
 
-#define FLUXSTAT_PASS_SIZE      0x10000     /* 64KB per pass */
+#define FLUXSTAT_PASS_SIZE      0x10000     /* 64KB: largest sector window pass */
+
+/*
+ * Pass buffers come from the DDR arena (ddr_arena.h), one run of
+ * passes * stride per capture. Full-revolution strides are sized for the
+ * data rate: a transition per data bit (two for FM) over the longest
+ * revolution, e.g. ~210KB for DD and ~840KB for ED.
+ */
+#define FLUXSTAT_REV_MS_MAX     210         /* 300 RPM nominal, 5% slow spindle */
+#define FLUXSTAT_STRIDE_ALIGN   0x1000      /* Pass stride granularity */
+#define FLUXSTAT_RATE_MAX       1000000     /* ED: stride for an unknown format */
+
+#define FLUXSTAT_INTERFACES     2
+#define FLUXSTAT_DRIVE_IF(d)    ((d) >> 1)  /* Drives 0-1: A, 2-3: B */
+
+#define FLUXSTAT_MAX_CORRECTION 8           /* Max bits flipped by CRC correction */
+#define FLUXSTAT_MAX_SECTORS    32          /* Sectors indexed per track */
 
 /* Bit cell classifications */
 #define BITCELL_STRONG_1        0           /* High confidence "1" */
@@ -120,13 +169,16 @@
  * FluxStat configuration
  */
 typedef struct {
-    uint8_t  pass_count;            /* Number of capture passes (2-64) */
+    uint8_t  pass_count;            /* Number of capture passes (2-64), adaptive: maximum */
     uint8_t  confidence_threshold;  /* Minimum confidence for "good" bit (0-100) */
     uint8_t  max_correction_bits;   /* Max bits to try correcting per sector */
-    uint8_t  encoding;              /* MFM, FM, GCR, etc. (from fluxripper_hal.h) */
+    uint8_t  encoding;              /* MFM, FM, GCR, etc. (from fluxripper_hal.h);
+                                       ENC_UNKNOWN: per track (format_cache.h) */
     uint32_t data_rate;             /* Expected data rate in bps */
     bool     use_crc_correction;    /* Enable CRC-guided correction */
     bool     preserve_weak_bits;    /* Preserve weak bit info in output */
+    bool     adaptive;              /* Stop once the track stops improving */
+    uint8_t  adaptive_stall;        /* Passes without gain before stopping (1-16) */
 } fluxstat_config_t;
 
 /**
@@ -189,6 +241,7 @@ typedef struct {
     uint8_t  confidence_avg;        /* Average bit confidence */
     uint8_t  weak_bit_count;        /* Number of weak bits */
     uint8_t  corrected_count;       /* Bits corrected by CRC guidance */
+    uint8_t  sector_id;             /* Sector number (R) from the ID field */
     uint16_t weak_positions[64];    /* Bit positions of weak bits (first 64) */
 } fluxstat_sector_t;
 
@@ -203,9 +256,37 @@ typedef struct {
     uint8_t  track;                 /* Track number */
     uint8_t  head;                  /* Head number */
     uint8_t  overall_confidence;    /* Overall track confidence */
-    fluxstat_sector_t sectors[32];  /* Per-sector results */
+    fluxstat_sector_t sectors[FLUXSTAT_MAX_SECTORS];  /* Per-sector results */
 } fluxstat_track_t;
 
+/**
+ * Sector location in the captured track (bitcell offsets from index)
+ */
+typedef struct {
+    uint8_t  cylinder;              /* C from ID field */
+    uint8_t  head;                  /* H from ID field */
+    uint8_t  sector;                /* R from ID field */
+    uint8_t  size_code;             /* N from ID field */
+    uint32_t idam_bit;              /* First cell after the ID address mark */
+    uint32_t data_bit;              /* First cell after the data mark (0 = none) */
+    uint16_t size;                  /* Data field size in bytes */
+    uint8_t  header_crc_ok;         /* ID field CRC verified */
+    uint8_t  data_crc_ok;           /* Data field CRC verified (first decode) */
+    uint8_t  deleted;               /* Deleted data mark (F8) */
+} fluxstat_sector_loc_t;
+
+/**
+ * Per-track sector index, built once per capture by the track decoder
+ */
+typedef struct {
+    uint8_t  count;                 /* Sectors found (physical order) */
+    uint8_t  track;                 /* Captured track */
+    uint8_t  head;                  /* Captured head */
+    uint8_t  encoding;              /* Encoding used for decode */
+    bool     valid;                 /* Index matches the cached capture */
+    fluxstat_sector_loc_t sectors[FLUXSTAT_MAX_SECTORS];
+} fluxstat_track_index_t;
+
 /**
  * Flux correlation result (for internal use)
  */
@@ -247,16 +328,69 @@ int fluxstat_get_config(fluxstat_config_t *config);
  * HAL Functions - Multi-Pass Capture
  *============================================================================*/
 
+/**
+ * Select the interface the other capture, histogram and analysis calls
+ * act on
+ *
+ * Each interface keeps its own last capture, so captures started on both
+ * can be collected and analyzed one after the other.
+ *
+ * @param iface     Interface (0 = drives 0-1, 1 = drives 2-3)
+ * @return FLUXSTAT_OK on success
+ */
+int fluxstat_select(uint8_t iface);
+
+/**
+ * Get the selected interface
+ */
+uint8_t fluxstat_selected(void);
+
 /**
  * Start multi-pass flux capture of a track
  *
- * @param drive     Drive number (0-1)
+ * Runs on the drive's interface and selects it. A capture already
+ * running on the other interface carries on. The pass stride is sized
+ * for the configured data rate (the session's format for ENC_UNKNOWN);
+ * when the DDR arena cannot hold pass_count passes, fewer are taken.
+ *
+ * @param drive     Drive number (0-3)
  * @param track     Track number
  * @param head      Head number (0-1)
- * @return FLUXSTAT_OK on success
+ * @return FLUXSTAT_OK on success, FLUXSTAT_ERR_BUSY if the drive's
+ *         interface is still capturing, FLUXSTAT_ERR_OVERFLOW if fewer
+ *         than FLUXSTAT_MIN_PASSES passes fit
  */
 int fluxstat_capture_start(uint8_t drive, uint8_t track, uint8_t head);
 
+/**
+ * Get the pass buffers of the selected capture for a zero-copy transfer
+ *
+ * Takes a reference on the capture's DDR run: the next capture on the
+ * interface leaves it alone and allocates elsewhere until the caller
+ * drops it with ddr_release() (e.g. from the USB DMA completion).
+ *
+ * @return run holding a new reference, NULL if there is no capture
+ */
+ddr_buf_t *fluxstat_capture_buffer(void);
+
+/**
+ * Re-capture one sector through an index-relative window
+ *
+ * Places a window from just before the sector's ID field to just past
+ * its data CRC, using the sector index of the drive's last full-track
+ * capture, and runs the passes on that window alone with small pass
+ * buffers. The windowed passes replace the capture of that interface;
+ * fluxstat_recover_sector() then works on them as on a full track. In
+ * adaptive mode only the target sector counts toward the early stop.
+ *
+ * @param drive         Drive of the full-track capture
+ * @param sector_num    Sector number (R field) to re-capture
+ * @param passes        Passes to take, 0 for the configured pass_count
+ * @return FLUXSTAT_OK on success, FLUXSTAT_ERR_NO_DATA if there is no
+ *         full-track capture of the drive or the sector was not found
+ */
+int fluxstat_capture_sector(uint8_t drive, uint8_t sector_num, uint8_t passes);
+
 /**
  * Abort current multi-pass capture
  *
@@ -267,6 +401,12 @@ int fluxstat_capture_abort(void);
 /**
  * Check if capture is in progress
  *
+ * In adaptive mode this also decodes each newly completed pass set
+ * (from FLUXSTAT_MIN_PASSES on) and ends the capture early once every
+ * sector found passes its data CRC, or once adaptive_stall passes in a
+ * row add neither a CRC-good sector nor a new sector. The passes taken
+ * so far then form the capture result.
+ *
  * @return true if busy
  */
 bool fluxstat_capture_busy(void);
@@ -324,6 +464,54 @@ int fluxstat_histogram_stats(fluxstat_histogram_t *hist);
  */
 int fluxstat_histogram_read_bin(uint8_t bin, uint16_t *count);
 
+/**
+ * Read every histogram bin through the bin window
+ *
+ * One load per pair of bins (FLUXSTAT_HIST_BINS / 2 in total). The
+ * live histogram keeps counting during the read, so bins may come from
+ * slightly different moments unless it is disabled first or banks are
+ * enabled (see fluxstat_histogram_banks()).
+ *
+ * @param bins      FLUXSTAT_HIST_BINS counts
+ * @return FLUXSTAT_OK on success
+ */
+int fluxstat_histogram_read_all(uint16_t *bins);
+
+/**
+ * Configure ping-pong histogram banks
+ *
+ * With banks enabled one bank counts while the other holds the previous
+ * interval frozen; fluxstat_histogram_read_bin()/read_all() then read
+ * the frozen bank. Swapping on index gives one histogram per revolution.
+ *
+ * @param enable        Enable banks (false: single live histogram)
+ * @param swap_on_index Swap on every index pulse
+ * @return FLUXSTAT_OK on success
+ */
+int fluxstat_histogram_banks(bool enable, bool swap_on_index);
+
+/**
+ * Swap histogram banks now
+ *
+ * @return FLUXSTAT_OK on success, FLUXSTAT_ERR_INVALID if banks are off
+ */
+int fluxstat_histogram_swap(void);
+
+/**
+ * Read the frozen bank: statistics and every bin
+ *
+ * Retries if a swap lands during the read, so the result always comes
+ * from one bank.
+ *
+ * @param stats     Frozen bank statistics (may be NULL)
+ * @param bins      FLUXSTAT_HIST_BINS counts (may be NULL)
+ * @param seq       Swap count identifying the bank (may be NULL)
+ * @return FLUXSTAT_OK on success, FLUXSTAT_ERR_NO_DATA if no swap yet,
+ *         FLUXSTAT_ERR_BUSY if swaps outpace the read
+ */
+int fluxstat_histogram_read_frozen(fluxstat_histogram_t *stats,
+                                   uint16_t *bins, uint16_t *seq);
+
 /**
  * Snapshot current histogram state
  *
@@ -338,6 +526,9 @@ int fluxstat_histogram_snapshot(void);
 /**
  * Analyze captured flux data and recover track
  *
+ * Decodes every ID and data field (FM/MFM) in one sweep of the track and
+ * builds the sector index used by fluxstat_recover_sector().
+ *
  * @param result    Track recovery result to fill
  * @return FLUXSTAT_OK on success
  */
@@ -346,15 +537,35 @@ int fluxstat_analyze_track(fluxstat_track_t *result);
 /**
  * Recover specific sector from captured data
  *
- * @param sector_num    Sector number to recover
+ * Seeks directly to the sector's data field using the track index; the
+ * index is built on first use if fluxstat_analyze_track() has not run.
+ * On a CRC error with use_crc_correction set, the least-confident cells
+ * are searched for a unique flip set of up to max_correction_bits that
+ * fixes the CRC. Only cells a share of the passes read the other way are
+ * flipped, and the corrected field is CRC-checked again before it is
+ * accepted; corrected_count reports the bits flipped.
+ *
+ * @param sector_num    Sector number (R field) to recover
  * @param result        Sector result to fill
  * @return FLUXSTAT_OK on success
  */
 int fluxstat_recover_sector(uint8_t sector_num, fluxstat_sector_t *result);
 
+/**
+ * Get sector index for the cached capture
+ *
+ * @param index     Index structure to fill
+ * @return FLUXSTAT_OK on success
+ */
+int fluxstat_get_track_index(fluxstat_track_index_t *index);
+
 /**
  * Get bit-level analysis for range of bits
  *
+ * Bit positions are bitcells counted from the index mark. All passes are
+ * correlated in one forward sweep, so consecutive calls over ascending
+ * ranges cost O(total flux) for the whole track.
+ *
  * @param bit_offset    Starting bit position
  * @param count         Number of bits to analyze
  * @param bits          Array of bit results (caller allocated)
@@ -0,0 +1,103 @@
+/**
+ * FluxRipper Track Format Cache
+ *
+ * Identifies the encoding, data rate and sector layout of captured
+ * tracks for FluxStat's automatic encoding (ENC_UNKNOWN in the config).
+ * A full probe decodes one revolution with every candidate format
+ * (flux_decode.h) and keeps the one recovering the most sectors. That
+ * costs a decode per candidate, so the result is cached per drive for
+ * the session: later tracks are decoded once with the cached format,
+ * and only a track whose ID fields do not fit the cached layout (or
+ * carry none) gets a full probe, whose result becomes the new
+ * prediction. Mixed-format and protected disks therefore probe only
+ * where the format actually changes.
+ *
+ * A session lasts until fmtc_reset(); fluxstat_configure() starts a new
+ * one for every drive.
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-10 21:00
+ */
+
+#ifndef FORMAT_CACHE_H
+#define FORMAT_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#define FMTC_DRIVES             4           /* FluxStat drives (0-3) */
+#define FMTC_ALL_DRIVES         0xFF        /* fmtc_reset(): every drive */
+
+/*============================================================================
+ * Data Structures
+ *============================================================================*/
+
+/**
+ * Track format: encoding, rate and the sector layout its ID fields show
+ */
+typedef struct {
+    uint8_t     encoding;           /* ENC_* */
+    uint32_t    data_rate;          /* bps */
+    uint8_t     sectors;            /* Distinct sectors with a good ID field */
+    uint8_t     first_sector;       /* Lowest R */
+    uint8_t     last_sector;        /* Highest R */
+    uint8_t     size_code;          /* N of the first good ID field */
+} fmtc_format_t;
+
+typedef struct {
+    uint32_t    tracks;             /* fmtc_identify() calls */
+    uint32_t    hits;               /* Tracks the cached format decoded */
+    uint32_t    probes;             /* Full probes run */
+    uint32_t    mismatches;         /* Probes after a failed prediction */
+    uint32_t    unknown;            /* Probes that found no format */
+} fmtc_stats_t;
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+/**
+ * Forget a drive's cached format and counters (start a new session)
+ * @param drive     FluxStat drive, or FMTC_ALL_DRIVES
+ */
+void fmtc_reset(uint8_t drive);
+
+/**
+ * Probe one revolution against every candidate format, no caching
+ * @param words     flux words of one pass
+ * @param count     word count
+ * @param fmt       Output: best format
+ * @return FLUXSTAT_OK, FLUXSTAT_ERR_NO_DATA if no candidate finds a
+ *         good ID field
+ */
+int fmtc_probe(const uint32_t *words, uint32_t count, fmtc_format_t *fmt);
+
+/**
+ * Identify a track's format, predicted from the drive's session
+ * @param drive     FluxStat drive (0-3)
+ * @param words     flux words of one pass
+ * @param count     word count
+ * @param fmt       Output: format of this track
+ * @return FLUXSTAT_OK, FLUXSTAT_ERR_INVALID for a bad drive,
+ *         FLUXSTAT_ERR_NO_DATA if neither the prediction nor a probe
+ *         finds a good ID field (the prediction is kept)
+ */
+int fmtc_identify(uint8_t drive, const uint32_t *words, uint32_t count,
+                  fmtc_format_t *fmt);
+
+/**
+ * Get a drive's cached format
+ * @return true if the session has one
+ */
+bool fmtc_get(uint8_t drive, fmtc_format_t *fmt);
+
+/**
+ * Get a drive's session counters
+ */
+void fmtc_get_stats(uint8_t drive, fmtc_stats_t *stats);
+
+#endif /* FORMAT_CACHE_H */
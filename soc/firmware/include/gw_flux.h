@@ -0,0 +1,120 @@
+/*-----------------------------------------------------------------------------
+ * gw_flux.h
+ * Greaseweazle Flux Stream Encoding
+ *
+ * Created: 2025-12-09 11:20
+ *
+ * Converts between FluxRipper capture words (raw_protocol.h: 27-bit
+ * 200 MHz timestamps, FLUX_FLAG_INDEX on index marks) and the Greaseweazle
+ * variable-length flux stream at GW_SAMPLE_FREQ. Both directions keep the
+ * clock conversion remainder, so long streams do not drift.
+ *
+ * The encoder runs word by word straight from a capture DMA chunk into the
+ * bulk IN buffer; the decoder accepts the bulk OUT stream in arbitrary
+ * pieces (a token may straddle two packets).
+ *---------------------------------------------------------------------------*/
+
+#ifndef GW_FLUX_H
+#define GW_FLUX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gw_protocol.h"
+
+/* FDC_FREQ_HZ : GW_SAMPLE_FREQ = 25 : 9 */
+#define GW_FLUX_CLK_DIV         25          /* FDC clocks ... */
+#define GW_FLUX_TICK_MUL        9           /* ... per this many GW ticks */
+
+/* Longest token: 0xFF, FLUXOP_SPACE, N28, 249 */
+#define GW_FLUX_MAX_TOKEN       7
+
+/* Index-to-index times kept for CMD_GET_INDEX_TIMES */
+#define GW_FLUX_INDEX_TIMES     15
+
+/*---------------------------------------------------------------------------
+ * Encoder (capture words -> GW stream)
+ *---------------------------------------------------------------------------*/
+
+typedef struct {
+    /* Limits (0 = none), as given by CMD_READ_FLUX */
+    uint32_t    max_ticks;          /* Stop after this many ticks */
+    uint16_t    max_index;          /* Stop after this many index pulses ... */
+    uint32_t    linger_ticks;       /* ... plus this long */
+
+    /* Running state */
+    bool        started;            /* First word seen */
+    bool        done;               /* A limit was reached */
+    uint32_t    prev_ts;            /* Timestamp of the last word */
+    uint32_t    rem;                /* Conversion remainder (clocks * 9) */
+    uint32_t    since_flux;         /* Ticks since the last transition */
+    uint32_t    since_index;        /* Ticks since the last index */
+    uint32_t    ticks;              /* Ticks since the first word */
+    uint16_t    index_count;
+    uint32_t    index_times[GW_FLUX_INDEX_TIMES];
+} gw_flux_enc_t;
+
+/**
+ * Start an encode
+ * @param e encoder
+ * @param max_ticks tick limit (0 = none)
+ * @param max_index index pulse limit (0 = none)
+ * @param linger_ticks ticks to continue past the last index
+ */
+void gw_flux_enc_init(gw_flux_enc_t *e, uint32_t max_ticks, uint16_t max_index,
+                      uint32_t linger_ticks);
+
+/**
+ * Encode capture words
+ * Stops early once a limit is reached (e->done set). The output needs at
+ * most GW_FLUX_MAX_TOKEN bytes per word; the stream terminator is not
+ * written.
+ * @param e encoder
+ * @param words capture words
+ * @param n number of words
+ * @param dst output
+ * @param consumed on exit: words taken (may be NULL)
+ * @return bytes written
+ */
+uint32_t gw_flux_encode(gw_flux_enc_t *e, const uint32_t *words, uint32_t n,
+                        uint8_t *dst, uint32_t *consumed);
+
+/*---------------------------------------------------------------------------
+ * Decoder (GW stream -> FDC-clock transition times)
+ *---------------------------------------------------------------------------*/
+
+typedef enum {
+    GW_DEC_MORE = 0,                /* Input taken, stream continues */
+    GW_DEC_END,                     /* Terminator seen */
+    GW_DEC_FULL,                    /* Output full */
+    GW_DEC_BAD                      /* Malformed stream */
+} gw_dec_status_t;
+
+typedef struct {
+    uint8_t     tok[GW_FLUX_MAX_TOKEN]; /* Token straddling two pieces */
+    uint8_t     tok_len;
+    uint32_t    rem;                /* Conversion remainder (ticks * 25) */
+    uint32_t    ts;                 /* Time of the last transition (clocks) */
+    uint32_t    pending;            /* Ticks since the last transition */
+    uint32_t    astable;            /* FLUXOP_ASTABLE period, 0 = off */
+    uint32_t    ticks;              /* Ticks decoded */
+    uint32_t    count;              /* Words written */
+} gw_flux_dec_t;
+
+void gw_flux_dec_init(gw_flux_dec_t *d);
+
+/**
+ * Decode a piece of the stream into transition timestamps
+ * Each output word is a 27-bit FDC-clock timestamp (raw_protocol.h
+ * format) of one transition.
+ * @param d decoder
+ * @param src stream bytes
+ * @param len byte count
+ * @param out output words
+ * @param cap output capacity in words (d->count words already written)
+ * @param used on exit: bytes taken (may be NULL)
+ * @return GW_DEC_*
+ */
+gw_dec_status_t gw_flux_decode(gw_flux_dec_t *d, const uint8_t *src, uint32_t len,
+                               uint32_t *out, uint32_t cap, uint32_t *used);
+
+#endif /* GW_FLUX_H */
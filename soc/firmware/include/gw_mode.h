@@ -0,0 +1,124 @@
+/*-----------------------------------------------------------------------------
+ * gw_mode.h
+ * Greaseweazle Compatibility Mode Handler API
+ *
+ * Created: 2025-12-09 11:40
+ *
+ * Firmware side of the Greaseweazle personality (gw_protocol.h): command
+ * processing plus the bulk data phases of CMD_READ_FLUX, CMD_WRITE_FLUX,
+ * CMD_SOURCE_BYTES and CMD_SINK_BYTES.
+ *---------------------------------------------------------------------------*/
+
+#ifndef GW_MODE_H
+#define GW_MODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gw_protocol.h"
+
+/*---------------------------------------------------------------------------
+ * Data Structures
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Bandwidth sample (GETINFO_BW_STATS)
+ */
+#pragma pack(push, 1)
+typedef struct {
+    uint32_t    bytes;
+    uint32_t    usecs;
+} gw_bw_t;
+
+typedef struct {
+    gw_bw_t     min_bw;
+    gw_bw_t     max_bw;
+} gw_bw_stats_t;
+#pragma pack(pop)
+
+/*---------------------------------------------------------------------------
+ * Initialization
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Initialize Greaseweazle mode (drive deselected, default delays)
+ * @return 0 on success
+ */
+int gw_mode_init(void);
+
+/**
+ * Abort any data phase and return to the post-init state (CMD_RESET)
+ */
+void gw_mode_reset(void);
+
+/*---------------------------------------------------------------------------
+ * Command Processing
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Process one command
+ * @param cmd Command bytes: opcode, total length, parameters
+ * @param len Bytes available at cmd
+ * @param response Response buffer (at least 2 + 32 bytes): opcode, ACK,
+ *                 then any reply data
+ * @param response_len On exit: response length
+ * @return 0 if acknowledged with ACK_OKAY, -1 otherwise
+ */
+int gw_mode_process_command(const uint8_t *cmd, uint32_t len,
+                            uint8_t *response, uint32_t *response_len);
+
+/*---------------------------------------------------------------------------
+ * Data Phases
+ *
+ * After an ACK_OKAY response to READ_FLUX or SOURCE_BYTES, the transport
+ * drains the IN data with gw_mode_stream_get()/gw_mode_stream_release().
+ * Flux is encoded straight from the capture DMA chunk into the segment
+ * handed out; the last segment ends with the stream terminator.
+ *
+ * After WRITE_FLUX or SINK_BYTES, OUT data goes to gw_mode_sink(); once
+ * the stream is complete, a single status byte is returned through
+ * gw_mode_stream_get() as Greaseweazle expects.
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Service the capture DMA and fill IN segments (polling loop or DMA ISR)
+ */
+void gw_mode_stream_poll(void);
+
+/**
+ * Get the next IN segment to send
+ * @param data On exit: segment start (valid until released)
+ * @param len On exit: segment length in bytes
+ * @return 1 if a segment is ready, 0 if none yet, -1 on error
+ */
+int gw_mode_stream_get(const uint8_t **data, uint32_t *len);
+
+/**
+ * Release the oldest segment returned by gw_mode_stream_get()
+ */
+void gw_mode_stream_release(void);
+
+/**
+ * Accept OUT data for the current WRITE_FLUX or SINK_BYTES
+ * @param data Received bytes
+ * @param len Byte count
+ * @return Bytes taken; less than len once the stream has ended
+ */
+uint32_t gw_mode_sink(const uint8_t *data, uint32_t len);
+
+/**
+ * Check whether a data phase is in progress
+ * @return true from the command ACK until the last IN byte is released
+ */
+bool gw_mode_busy(void);
+
+/*---------------------------------------------------------------------------
+ * Status
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Endpoint bandwidth seen by the data phases since init
+ * @param stats Filled with the slowest and fastest sample
+ */
+void gw_mode_get_bw_stats(gw_bw_stats_t *stats);
+
+#endif /* GW_MODE_H */
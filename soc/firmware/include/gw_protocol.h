@@ -235,11 +235,11 @@ typedef struct {
 #define FLUX_2BYTE_LO(v)        (1 + (((v) - 250) % 255))
 
 // N28 encoding (28-bit value in 4 bytes with LSB set)
-// Each byte: (value_bits << 1) | 1
-#define N28_BYTE0(v)            ((((v) & 0x3F) << 1) | 1)
-#define N28_BYTE1(v)            (((((v) >> 6) & 0x7F) << 1) | 1)
-#define N28_BYTE2(v)            (((((v) >> 13) & 0x7F) << 1) | 1)
-#define N28_BYTE3(v)            (((((v) >> 20) & 0x7F) << 1) | 1)
+// Each byte carries 7 value bits: (value_bits << 1) | 1
+#define N28_BYTE0(v)            ((((v) & 0x7F) << 1) | 1)
+#define N28_BYTE1(v)            (((((v) >> 7) & 0x7F) << 1) | 1)
+#define N28_BYTE2(v)            (((((v) >> 14) & 0x7F) << 1) | 1)
+#define N28_BYTE3(v)            (((((v) >> 21) & 0x7F) << 1) | 1)
 
 //=============================================================================
 // Rate Conversion (FluxRipper 300 MHz -> GW 72 MHz)
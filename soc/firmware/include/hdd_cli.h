@@ -12,19 +12,13 @@
 #include "cli.h"
 
 /**
- * Main HDD command handler
- * Dispatches to subcommands (detect, discover, status, etc.)
- */
-int cmd_hdd(int argc, char *argv[]);
-
-/**
- * Initialize and register HDD CLI commands
- * Call this from main() or cli_init()
+ * Initialize the HDD HAL behind the 'hdd' command
+ * Call this from main() after cli_init()
  */
 void hdd_cli_init(void);
 
 /**
- * HDD CLI command definition (for external registration)
+ * HDD CLI command definition (linked in with CLI_COMMAND)
  */
 extern const cli_cmd_t hdd_cli_cmd;
 
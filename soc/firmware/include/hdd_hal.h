@@ -15,6 +15,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "platform.h"
+#include "fluxripper_hal.h"     /* HAL_OK / HAL_ERR_* return codes */
 
 /*============================================================================
  * Drive Selection Constants
@@ -121,6 +122,26 @@
 #define HDD_CMD_HEAD_MASK       (0xF << 4)  /* Head select */
 #define HDD_CMD_HEAD_SHIFT      4
 
+/* HDD_SECTOR_CTRL - Sector/Track Buffer Control */
+#define SECTOR_CTRL_READ        BIT(0)  /* Start read into buffer */
+#define SECTOR_CTRL_MULTI       BIT(2)  /* Read COUNT sectors, not one */
+#define SECTOR_CTRL_IRQ_EN      BIT(3)  /* Raise IRQ_HDD on completion */
+#define SECTOR_CTRL_COUNT_MASK  (0xFF << 8) /* Sector count (MULTI) */
+#define SECTOR_CTRL_COUNT_SHIFT 8
+
+/* HDD_SECTOR_STATUS - Sector/Track Buffer Status */
+#define SECTOR_STAT_BUSY        BIT(0)  /* Read in progress */
+#define SECTOR_STAT_READY       BIT(1)  /* Data ready */
+#define SECTOR_STAT_ERROR       BIT(2)  /* ID not found / data CRC */
+#define SECTOR_STAT_IRQ         BIT(3)  /* Completion IRQ pending (W1C) */
+
+/*
+ * MULTI reads fill wd_track_buffer: HDD_SECTOR_ADDR holds the first
+ * sector and HDD_SECTOR_DATA then streams all COUNT sectors in order.
+ */
+#define HDD_TRACK_BUF_SECTORS   17      /* wd_track_buffer capacity */
+#define HDD_MAX_SPT             36      /* Largest track the interleave map covers */
+
 /* Detection Control Register */
 #define DETECT_CTRL_START       BIT(0)  /* Start detection */
 #define DETECT_CTRL_ABORT       BIT(1)  /* Abort detection */
@@ -146,6 +167,11 @@
 #define DISCOVER_CTRL_FULL      BIT(2)  /* Full scan (vs quick) */
 #define DISCOVER_CTRL_DRIVE_SEL BIT(8)  /* Drive to discover (0 or 1) */
 
+/* Discovery timing */
+#define HDD_DISCOVER_QUICK_MS   5000    /* Quick scan: rate, encoding, a few cylinders */
+#define HDD_DISCOVER_FULL_MS    60000   /* Full scan */
+#define HDD_DISCOVER_IDLE_MS    2000    /* Drive idle before a background scan resumes */
+
 /* Discovery Status Register */
 #define DISCOVER_STAT_BUSY      BIT(0)  /* Discovery in progress */
 #define DISCOVER_STAT_DONE      BIT(1)  /* Discovery complete */
@@ -285,6 +311,8 @@ typedef struct {
     hdd_geometry_t  geometry;
     hdd_health_t    health;
     esdi_config_t   esdi_config;    /* ESDI-specific config (if applicable) */
+    uint8_t         confidence;     /* Geometry confidence 0-255 (quality score) */
+    bool            provisional;    /* Quick-scan result, full scan still owed */
     bool            valid;          /* Profile is valid */
 } hdd_profile_t;
 
@@ -342,6 +370,50 @@ int hdd_force_interface(hdd_type_t type);
  */
 int hdd_discover(uint8_t drive, hdd_profile_t *profile);
 
+/**
+ * Staged discovery: return a provisional profile early
+ *
+ * A cached profile (see hdd_profile_cache.h) is returned final. Otherwise
+ * a quick scan detects rate and encoding, probes a few cylinders and
+ * returns with profile->provisional set and profile->confidence scored;
+ * the full scan is queued and run by hdd_discover_poll(), which refreshes
+ * the stored profile (hdd_get_profile()) when it completes.
+ *
+ * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
+ * @param profile   Pointer to profile structure to fill
+ * @return HAL_OK on success, error code otherwise (the full scan is
+ *         still queued if only the quick scan failed)
+ */
+int hdd_discover_quick(uint8_t drive, hdd_profile_t *profile);
+
+/**
+ * Run queued background full scans (scheduler task)
+ *
+ * The discovery pipeline is shared, so one drive is scanned at a time.
+ * A scan yields to seeks and reads on its drive and resumes once the
+ * drive has been idle for HDD_DISCOVER_IDLE_MS.
+ */
+void hdd_discover_poll(void);
+
+/**
+ * Time since the last seek or read on a drive
+ *
+ * Background work (discovery scans, metadata write-back) waits for the
+ * drive to go idle so it stays off the host I/O path.
+ *
+ * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
+ * @return milliseconds idle, 0 while a seek is in flight
+ */
+uint32_t hdd_idle_ms(uint8_t drive);
+
+/**
+ * Check whether a drive still has a full scan queued or running
+ *
+ * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
+ * @return true while the profile is provisional
+ */
+bool hdd_discover_pending(uint8_t drive);
+
 /**
  * Get HDD profile for specified drive
  *
@@ -360,6 +432,25 @@ int hdd_get_profile(uint8_t drive, hdd_profile_t *profile);
  */
 int hdd_seek(uint8_t drive, uint16_t cylinder);
 
+/**
+ * Start a seek without waiting for it
+ * Complete it with hdd_seek_poll() before the next command to the drive.
+ *
+ * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
+ * @param cylinder  Target cylinder number
+ * @return HAL_OK if the seek was issued, error code otherwise
+ */
+int hdd_seek_start(uint8_t drive, uint16_t cylinder);
+
+/**
+ * Check a seek started with hdd_seek_start()
+ *
+ * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
+ * @return HAL_OK when done (or none pending), HAL_ERR_BUSY while moving,
+ *         HAL_ERR_HARDWARE on seek error
+ */
+int hdd_seek_poll(uint8_t drive);
+
 /**
  * Select head on specified drive
  *
@@ -390,8 +481,36 @@ int hdd_recalibrate(uint8_t drive);
 int hdd_read_sector(uint8_t drive, uint16_t cylinder, uint8_t head,
                     uint8_t sector, void *buf);
 
+/**
+ * Read consecutive sectors of one track from specified drive
+ * One track buffer command for up to HDD_TRACK_BUF_SECTORS sectors,
+ * completed by IRQ_HDD. On an interleaved drive the sectors are instead
+ * fetched one at a time in physical order, so the span takes at most
+ * one revolution, and land in buf in logical order.
+ *
+ * With buf NULL the span is only verified: the decoder CRC-checks every
+ * sector into the track buffer and nothing is copied out.
+ *
+ * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
+ * @param cylinder  Cylinder number
+ * @param head      Head number
+ * @param sector    First sector number
+ * @param count     Number of sectors (1..HDD_TRACK_BUF_SECTORS)
+ * @param buf       Buffer for sector data, or NULL to verify
+ * @return HAL_OK on success, HAL_ERR_CRC on a bad sector, error code otherwise
+ */
+int hdd_read_sectors(uint8_t drive, uint16_t cylinder, uint8_t head,
+                     uint8_t sector, uint8_t count, void *buf);
+
+/**
+ * HDD controller interrupt handler
+ * Call from the external interrupt handler for IRQ_HDD.
+ */
+void hdd_irq_handler(void);
+
 /**
  * Read sectors by LBA from specified drive
+ * Issues one track buffer read per track (or buffer-full) span.
  *
  * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
  * @param lba       Logical block address
@@ -401,6 +520,17 @@ int hdd_read_sector(uint8_t drive, uint16_t cylinder, uint8_t head,
  */
 int hdd_read_lba(uint8_t drive, uint32_t lba, uint32_t count, void *buf);
 
+/**
+ * Write sectors by LBA
+ *
+ * @param drive     Drive number
+ * @param lba       Starting LBA
+ * @param buf       Sector data (512*count bytes)
+ * @param count     Number of sectors
+ * @return HAL_OK on success, error code otherwise
+ */
+int hal_hdd_write_sectors(uint8_t drive, uint32_t lba, const void *buf, uint32_t count);
+
 /**
  * Get drive ready status
  *
@@ -476,7 +606,9 @@ int hdd_set_termination(bool enable);
 /**
  * Query ESDI drive configuration (GET_DEV_CONFIG command)
  * This sends the ESDI GET_DEV_CONFIG command and retrieves drive geometry.
- * Only valid for ESDI drives.
+ * Only valid for ESDI drives. The result is cached per drive; later calls
+ * return it without touching the drive until the HAL is reset or the
+ * drive is detected or attached again.
  *
  * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
  * @param config    Pointer to ESDI config structure to fill
@@ -490,7 +622,8 @@ int hdd_esdi_get_config(uint8_t drive, esdi_config_t *config);
  * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
  * @param opcode    ESDI command opcode
  * @param param     Command parameter (cylinder, etc.)
- * @return HAL_OK on success, error code otherwise
+ * @return HAL_OK on success, HAL_ERR_BUSY while a queued command holds
+ *         the serial channel, error code otherwise
  */
 int hdd_esdi_command(uint8_t drive, uint8_t opcode, uint16_t param);
 
@@ -510,6 +643,76 @@ int hdd_esdi_wait(uint32_t timeout_ms);
  */
 bool hdd_esdi_config_valid(uint8_t drive);
 
+/*============================================================================
+ * ESDI Command Queue
+ *============================================================================*/
+
+/* Commands held across both drives */
+#define HDD_ESDI_QUEUE_DEPTH    8
+
+/* Give up on a queued command that has not completed after this long */
+#define HDD_ESDI_CMD_MS         1000
+#define HDD_ESDI_SEEK_MS        5000
+
+typedef enum {
+    HDD_ESDI_OP_SEEK    = 0,    /* arg: cylinder */
+    HDD_ESDI_OP_HEAD    = 1,    /* arg: head */
+    HDD_ESDI_OP_STATUS  = 2     /* GET_STATUS; result: command status */
+} hdd_esdi_op_t;
+
+/**
+ * Queued ESDI command
+ * Owned by the caller and must stay valid until status leaves
+ * HAL_ERR_BUSY.
+ */
+typedef struct {
+    uint8_t         op;             /* hdd_esdi_op_t */
+    uint16_t        arg;
+    uint32_t        result;         /* HDD_ESDI_CMD_STATUS at completion */
+    volatile int    status;         /* HAL_ERR_BUSY until complete */
+} hdd_esdi_req_t;
+
+/**
+ * Queue an ESDI command on a drive
+ * Commands for one drive run in order, each as soon as the one before it
+ * completes; commands for the other drive do not wait for them, so a seek
+ * on one drive overlaps a seek or status query on the other. The queue
+ * is started before returning.
+ *
+ * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
+ * @param req       Command (status is set to HAL_ERR_BUSY)
+ * @return HAL_OK if queued, HAL_ERR_BUSY if the queue is full,
+ *         HAL_ERR_NOT_SUPPORTED if the drive is not ESDI
+ */
+int hdd_esdi_submit(uint8_t drive, hdd_esdi_req_t *req);
+
+/**
+ * Advance the ESDI command queue
+ * Completes the commands that have finished and issues the ones they
+ * were holding up.
+ *
+ * @return number of commands still outstanding
+ */
+int hdd_esdi_poll(void);
+
+/**
+ * Wait for a queued command, advancing the queue on each HDD interrupt
+ * A command that times out is taken off the queue.
+ *
+ * @param req           Command passed to hdd_esdi_submit()
+ * @param timeout_ms    Timeout in milliseconds
+ * @return command status
+ */
+int hdd_esdi_req_wait(hdd_esdi_req_t *req, uint32_t timeout_ms);
+
+/**
+ * Position a drive through the queue: seek, then select the head
+ * Both commands are queued before the seek is waited on.
+ *
+ * @return HAL_OK on success, error code otherwise
+ */
+int hdd_esdi_seek_head(uint8_t drive, uint16_t cylinder, uint8_t head);
+
 /*============================================================================
  * Dual-Drive Convenience Functions
  *============================================================================*/
@@ -550,6 +753,109 @@ bool hdd_any_seeking(void);
 int hdd_get_dual_status(bool *ready_0, bool *ready_1,
                         uint16_t *cyl_0, uint16_t *cyl_1);
 
+/*============================================================================
+ * Request Queue (Shared Control Cable)
+ *============================================================================*/
+
+/* Requests held per drive */
+#define HDD_SCHED_DEPTH         8
+
+/* Give up on a seek that has not completed after this long */
+#define HDD_SCHED_SEEK_MS       5000
+
+/**
+ * Queued drive request
+ * Owned by the caller and must stay valid until status leaves
+ * HAL_ERR_BUSY. count == 0 only positions the heads.
+ */
+typedef struct {
+    uint16_t        cylinder;
+    uint8_t         head;
+    uint8_t         sector;         /* First sector */
+    uint8_t         count;          /* Sectors (0..HDD_TRACK_BUF_SECTORS) */
+    void            *buf;           /* NULL: verify only */
+    volatile int    status;         /* HAL_ERR_BUSY until complete */
+} hdd_req_t;
+
+/**
+ * Queue a request on a drive
+ * Requests are served in C-LOOK order: ascending cylinder from the
+ * current head position, then back to the lowest.
+ *
+ * @param drive     Drive number (HDD_DRIVE_0 or HDD_DRIVE_1)
+ * @param req       Request (status is set to HAL_ERR_BUSY)
+ * @return HAL_OK if queued, HAL_ERR_BUSY if the queue is full
+ */
+int hdd_sched_submit(uint8_t drive, hdd_req_t *req);
+
+/**
+ * Advance the request queues by one step
+ * Starts seeks on every drive that has work, then runs at most one
+ * transfer, alternating drives, so one drive seeks while the other
+ * transfers.
+ *
+ * @return number of requests still outstanding
+ */
+int hdd_sched_poll(void);
+
+/**
+ * Wait for a queued request, driving the queues meanwhile
+ * A request that times out is removed from its queue.
+ *
+ * @param req       Request passed to hdd_sched_submit()
+ * @param timeout_ms    Timeout in milliseconds
+ * @return request status
+ */
+int hdd_sched_wait(hdd_req_t *req, uint32_t timeout_ms);
+
+/**
+ * Read sectors of one track through the queue (blocking)
+ */
+int hdd_sched_read(uint8_t drive, uint16_t cylinder, uint8_t head,
+                   uint8_t sector, uint8_t count, void *buf);
+
+/**
+ * Seek through the queue (blocking)
+ */
+int hdd_sched_seek(uint8_t drive, uint16_t cylinder);
+
+/**
+ * Read sectors by LBA through the queue (blocking)
+ * Queues the track spans up to HDD_SCHED_DEPTH at a time.
+ */
+int hdd_sched_read_lba(uint8_t drive, uint32_t lba, uint32_t count, void *buf);
+
+/**
+ * Verify sectors by LBA through the queue (blocking)
+ * Same track spans as hdd_sched_read_lba() with nothing transferred; a
+ * span that fails is re-checked a sector at a time to find the bad one.
+ *
+ * @param bad_lba   Output: first sector that failed (may be NULL)
+ * @return HAL_OK if all sectors read back clean, error code otherwise
+ */
+int hdd_sched_verify_lba(uint8_t drive, uint32_t lba, uint32_t count, uint32_t *bad_lba);
+
+/**
+ * Queue a positioning seek without waiting
+ * Replaces an earlier hint for the same drive that has not started.
+ */
+int hdd_queue_seek(uint8_t drive, uint16_t cylinder);
+
+/**
+ * Seek through the queue, waiting for the result
+ */
+int hdd_seek_smart(uint8_t drive, uint16_t cylinder);
+
+/**
+ * Select drive for data path (20-pin cable) only
+ */
+int hdd_select_data_path(uint8_t drive);
+
+/**
+ * Select drive on both the control cable and the data path
+ */
+int hdd_select_full(uint8_t drive);
+
 /*============================================================================
  * Utility Functions
  *============================================================================*/
@@ -581,4 +887,15 @@ uint32_t hdd_chs_to_lba(uint16_t cylinder, uint8_t head, uint8_t sector,
 void hdd_lba_to_chs(uint32_t lba, uint16_t *cylinder, uint8_t *head,
                     uint8_t *sector, const hdd_geometry_t *geom);
 
+/**
+ * Build the physical sector layout of a track from its interleave
+ * Logical sector n+1 sits interleave slots after sector n, moving on to
+ * the next free slot on a collision (as a low-level format lays it out).
+ *
+ * @param geom  Geometry (sectors 1..HDD_MAX_SPT, interleave 0/1 = none)
+ * @param phys  Receives the sector ID in each physical slot
+ * @return HAL_OK, or HAL_ERR_INVALID if the track is too large
+ */
+int hdd_interleave_map(const hdd_geometry_t *geom, uint8_t phys[HDD_MAX_SPT]);
+
 #endif /* HDD_HAL_H */
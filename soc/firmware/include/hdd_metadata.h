@@ -281,6 +281,68 @@ meta_error_t meta_erase(uint8_t drive);
 meta_error_t meta_create_new(hdd_metadata_t *meta,
                              const drive_fingerprint_t *fingerprint);
 
+/**
+ * @brief Hash a drive fingerprint (djb2)
+ *
+ * Seeds GUID generation, and keys the discovery profile cache together
+ * with the GUID.
+ *
+ * @param fp Drive fingerprint
+ * @return 32-bit hash
+ */
+uint32_t meta_fingerprint_hash(const drive_fingerprint_t *fp);
+
+/**
+ * @brief Get drive metadata, from the copy kept by the last read or write
+ *
+ * Only the first call per drive touches the disk; later calls (LUN setup,
+ * profile cache) return the cached copy, including updates queued with
+ * meta_write_deferred().
+ *
+ * @param drive Drive number (0 or 1)
+ * @param meta Output metadata structure
+ * @return META_OK on success, as meta_read() otherwise
+ */
+meta_error_t meta_read_cached(uint8_t drive, hdd_metadata_t *meta);
+
+/**
+ * @brief Queue metadata to be written back when the drive is idle
+ *
+ * Returns at once. The latest image queued for a drive wins; the write
+ * runs from meta_writeback_poll() once the drive has seen no host I/O for
+ * META_WB_IDLE_MS. Use after meta_add_session() / meta_update_stats() so
+ * persisting them stays off the host I/O path.
+ *
+ * @param drive Drive number (0 or 1)
+ * @param meta Metadata to persist
+ * @return META_OK if queued, error code otherwise
+ */
+meta_error_t meta_write_deferred(uint8_t drive, const hdd_metadata_t *meta);
+
+/**
+ * @brief Run queued metadata write-back (scheduler task)
+ *
+ * Starts at most one write at a time and never waits for it: completion
+ * is picked up on a later call.
+ */
+void meta_writeback_poll(void);
+
+/**
+ * @brief Write any queued metadata for a drive now (blocking)
+ *
+ * @param drive Drive number (0 or 1)
+ * @return META_OK if nothing is left queued, error code otherwise
+ */
+meta_error_t meta_flush(uint8_t drive);
+
+/**
+ * @brief Check for queued or in-flight write-back on a drive
+ *
+ * @param drive Drive number (0 or 1)
+ * @return true if a write-back is outstanding
+ */
+bool meta_writeback_pending(uint8_t drive);
+
 /**
  * @brief Add diagnostic session to history
  *
@@ -439,6 +501,13 @@ void meta_print_history(const hdd_metadata_t *meta);
 #define META_REG_DIAG_DATA_1    (META_REG_BASE + 0x88)  // Session data word 1
 #define META_REG_DIAG_DATA_2    (META_REG_BASE + 0x8C)  // Session data word 2
 #define META_REG_DIAG_DATA_3    (META_REG_BASE + 0x90)  // Session data word 3
+#define META_REG_DIAG_TABLE     (META_REG_BASE + 0xC0)  // Session table, 16 x 4 words
+
+// Block-mapped readout: GUID through fingerprint (0x10-0x5F) is one
+// contiguous window, read in a single burst
+#define META_REG_WINDOW         META_REG_GUID_0
+#define META_REG_WINDOW_WORDS   20
+#define META_DIAG_TABLE_WORDS   (16 * 4)
 
 // Control register bits
 #define META_CTRL_READ_START    (1 << 0)
@@ -449,6 +518,12 @@ void meta_print_history(const hdd_metadata_t *meta);
 #define META_CTRL_ERROR         (1 << 10)
 #define META_CTRL_VALID         (1 << 11)
 #define META_CTRL_ERROR_CODE    (0xF << 12)
+#define META_CTRL_DIAG_TABLE    (1 << 16)   // Session table window present
+
+// Deferred write-back
+#define META_WB_IDLE_MS         500     // Drive idle before write-back starts
+#define META_WB_TIMEOUT_MS      10000   // Write operation limit
+#define META_WB_RETRIES         3       // Failed attempts before dropping
 
 // Config register bits
 #define META_CONFIG_ENABLE      (1 << 0)
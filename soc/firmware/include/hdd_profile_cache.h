@@ -0,0 +1,134 @@
+/**
+ * FluxRipper HDD Discovery Profile Cache
+ *
+ * Remembers discovered drive profiles (geometry, data rate, encoding, PHY
+ * mode) keyed by the drive's metadata GUID and fingerprint hash, so a
+ * known drive is re-attached with a metadata read and a verify seek
+ * instead of the full discovery scan.
+ *
+ * Records persist in the board configuration EEPROM (24xx256-class on
+ * I2C0, shared with the calibration data) and are mirrored in RAM; a
+ * failing or absent EEPROM leaves a RAM-only cache.
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-09 17:30
+ */
+
+#ifndef HDD_PROFILE_CACHE_H
+#define HDD_PROFILE_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hdd_hal.h"
+#include "hdd_metadata.h"
+#include "board_eeprom.h"
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#define PCACHE_EEPROM_BASE      EEPROM_PCACHE_BASE  /* Above the calibration area */
+
+#define PCACHE_SLOTS            32          /* Records (one page each) */
+#define PCACHE_MAGIC            0x50434143u /* "PCAC" */
+
+/*============================================================================
+ * Data Structures
+ *============================================================================*/
+
+/**
+ * Cached profile record (one EEPROM page)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t    magic;              /* PCACHE_MAGIC */
+    uint32_t    fp_hash;            /* meta_fingerprint_hash() */
+    uuid_t      guid;               /* Metadata GUID */
+    uint32_t    seq;                /* Last use, for replacement */
+
+    /* Detection */
+    uint8_t     type;               /* hdd_type_t */
+    uint8_t     phy_mode;           /* hdd_phy_mode_t */
+    uint8_t     rate;               /* hdd_rate_t */
+    uint8_t     confidence;
+
+    /* Geometry */
+    uint16_t    cylinders;
+    uint8_t     heads;
+    uint8_t     sectors;
+    uint16_t    sector_size;
+    uint8_t     interleave;
+    uint8_t     skew;
+
+    /* ESDI configuration */
+    uint16_t    esdi_cylinders;
+    uint8_t     esdi_heads;
+    uint8_t     esdi_spt;
+    uint8_t     esdi_rate;
+    uint8_t     flags;              /* PCACHE_F_* */
+
+    uint16_t    rpm;
+    uint8_t     reserved[14];
+    uint16_t    crc;                /* CRC16-CCITT of the bytes above */
+} hdd_pcache_rec_t;
+
+#define PCACHE_F_FROM_ESDI      (1 << 0)    /* geometry.from_esdi_config */
+#define PCACHE_F_ESDI_VALID     (1 << 1)
+#define PCACHE_F_ESDI_SOFT      (1 << 2)
+#define PCACHE_F_ESDI_FIXED     (1 << 3)
+
+/**
+ * Cache statistics
+ */
+typedef struct {
+    uint16_t    entries;            /* Valid records */
+    uint32_t    hits;               /* Attached from cache */
+    uint32_t    misses;             /* Full discovery needed */
+    uint32_t    verify_failed;      /* Record found, drive disagreed */
+    bool        eeprom_ok;          /* Backing store reachable */
+} hdd_pcache_stats_t;
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+/**
+ * Load the cache from EEPROM (done on first use if not called)
+ * @return HAL_OK, or HAL_ERR_HARDWARE if the EEPROM is not reachable
+ */
+int hdd_pcache_init(void);
+
+/**
+ * Try to attach a drive from the cache
+ *
+ * Reads the drive's metadata, looks up GUID + fingerprint hash and, on a
+ * hit, checks the cached profile against the current detection (type,
+ * PHY mode, rate) and a seek to the last cylinder. The key is kept for
+ * hdd_pcache_store() if the lookup misses.
+ *
+ * @param drive     Drive number
+ * @param profile   Filled on success (detection already in it)
+ * @return HAL_OK on a verified hit, HAL_ERR_* otherwise
+ */
+int hdd_pcache_attach(uint8_t drive, hdd_profile_t *profile);
+
+/**
+ * Record the profile of a full discovery under the key found by the last
+ * hdd_pcache_attach() on this drive (no-op if the drive has no metadata)
+ * @param drive     Drive number
+ * @param profile   Discovered profile
+ * @return HAL_OK if stored
+ */
+int hdd_pcache_store(uint8_t drive, const hdd_profile_t *profile);
+
+/**
+ * Drop every cached profile (RAM and EEPROM)
+ */
+void hdd_pcache_clear(void);
+
+/**
+ * Get cache statistics
+ * @param stats Filled on return
+ */
+void hdd_pcache_get_stats(hdd_pcache_stats_t *stats);
+
+#endif /* HDD_PROFILE_CACHE_H */
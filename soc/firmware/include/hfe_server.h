@@ -0,0 +1,141 @@
+/*-----------------------------------------------------------------------------
+ * hfe_server.h
+ * HxC HFE Image Server
+ *
+ * Created: 2025-12-09 16:00
+ *
+ * Serves the tracks of an HFE (HXCPICFE, revision 0) image held in
+ * memory for playback. The track LUT is decoded once at open; each
+ * cylinder is staged as two contiguous per-side bitstreams (HFE bit order:
+ * LSB first, two cells per data bit as stored).
+ *
+ * Three cylinders are kept staged: the current one and both neighbours.
+ * A single step in either direction is then served from a staged slot
+ * without touching the image, and the newly exposed neighbour is staged
+ * in the background by hfe_server_poll() while the head settles.
+ *---------------------------------------------------------------------------*/
+
+#ifndef HFE_SERVER_H
+#define HFE_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------------------------------------------------
+ * HFE File Format (hxc2001.com/floppy_drive_emulator/HFE-file-format.html)
+ *---------------------------------------------------------------------------*/
+
+#define HFE_SIGNATURE           "HXCPICFE"
+#define HFE_BLOCK_SIZE          512         /* LUT/track offsets are in blocks */
+#define HFE_SIDE_CHUNK          256         /* Track data: 256 B side 0, 256 B side 1 */
+#define HFE_MAX_CYLINDERS       256
+
+#pragma pack(push, 1)
+typedef struct {
+    char        signature[8];       /* HFE_SIGNATURE */
+    uint8_t     format_revision;    /* 0 */
+    uint8_t     number_of_track;    /* Cylinders */
+    uint8_t     number_of_side;
+    uint8_t     track_encoding;
+    uint16_t    bit_rate;           /* kbit/s */
+    uint16_t    floppy_rpm;
+    uint8_t     interface_mode;
+    uint8_t     dnu;
+    uint16_t    track_list_offset;  /* In HFE_BLOCK_SIZE blocks */
+    uint8_t     write_allowed;
+    uint8_t     single_step;        /* 0x00 = double step */
+    uint8_t     track0s0_altencoding;
+    uint8_t     track0s0_encoding;
+    uint8_t     track0s1_altencoding;
+    uint8_t     track0s1_encoding;
+} hfe_header_t;
+
+typedef struct {
+    uint16_t    offset;             /* In HFE_BLOCK_SIZE blocks */
+    uint16_t    track_len;          /* Bytes, both sides */
+} hfe_track_entry_t;
+#pragma pack(pop)
+
+/*---------------------------------------------------------------------------
+ * Return Codes
+ *---------------------------------------------------------------------------*/
+
+#define HFE_OK                  0
+#define HFE_ERR_INVALID         -1          /* Invalid parameter */
+#define HFE_ERR_FORMAT          -2          /* Not an HFE revision 0 image */
+#define HFE_ERR_RANGE           -3          /* Track outside the image */
+#define HFE_ERR_NOT_OPEN        -4          /* No image open */
+
+/*---------------------------------------------------------------------------
+ * Staging
+ *---------------------------------------------------------------------------*/
+
+#define HFE_SLOTS               3           /* Current cylinder and both neighbours */
+#define HFE_SLOT_SIDE_SIZE      (32 * 1024) /* track_len is 16-bit: <= 32 KB per side */
+
+/* Background staging work per hfe_server_poll() call */
+#define HFE_STAGE_STEP          (4 * 1024)
+
+/* Typical 3.5"/5.25" head settle time: the step-to-data budget */
+#define HFE_SETTLE_US           15000
+
+typedef struct {
+    uint32_t    steps;              /* hfe_server_seek() calls */
+    uint32_t    hits;               /* Served from a staged slot */
+    uint32_t    misses;             /* Staged on demand */
+    uint32_t    late;               /* Step-to-data over HFE_SETTLE_US */
+    uint32_t    last_us;            /* Last step-to-data latency */
+    uint32_t    max_us;             /* Worst step-to-data latency */
+} hfe_server_stats_t;
+
+/*---------------------------------------------------------------------------
+ * API
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Open an image and stage cylinder 0 and 1
+ * @param image HFE image (kept referenced until close)
+ * @param size image size in bytes
+ * @return HFE_OK or HFE_ERR_*
+ */
+int hfe_server_open(const uint8_t *image, uint32_t size);
+
+/**
+ * Close the image
+ */
+void hfe_server_close(void);
+
+/**
+ * Get the image header
+ * @return header, or NULL if no image is open
+ */
+const hfe_header_t *hfe_server_header(void);
+
+/**
+ * Move the head to a cylinder; staged neighbours make this O(1)
+ * @param cylinder new cylinder
+ * @return HFE_OK or HFE_ERR_*
+ */
+int hfe_server_seek(uint8_t cylinder);
+
+/**
+ * Get the bitstream of one side of the current cylinder
+ * @param side 0 or 1
+ * @param bits on exit: bitstream (valid until the next seek)
+ * @param len on exit: length in bytes
+ * @return HFE_OK or HFE_ERR_*
+ */
+int hfe_server_track(uint8_t side, const uint8_t **bits, uint32_t *len);
+
+/**
+ * Stage neighbours in the background (scheduler task)
+ */
+void hfe_server_poll(void);
+
+/**
+ * Get step-to-data statistics
+ * @param stats filled on return
+ */
+void hfe_server_get_stats(hfe_server_stats_t *stats);
+
+#endif /* HFE_SERVER_H */
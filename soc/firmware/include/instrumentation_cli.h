@@ -12,19 +12,13 @@
 #include "cli.h"
 
 /**
- * Main diagnostics command handler
- * Dispatches to subcommands (errors, pll, fifo, capture, seek, clear, all)
- */
-int cmd_diag(int argc, char *argv[]);
-
-/**
- * Initialize and register instrumentation CLI commands
- * Call this from main() or cli_init()
+ * Initialize the HALs behind the 'diag' command
+ * Call this from main() after cli_init()
  */
 void instrumentation_cli_init(void);
 
 /**
- * Instrumentation CLI command definition (for external registration)
+ * Instrumentation CLI command definition (linked in with CLI_COMMAND)
  */
 extern const cli_cmd_t diag_cli_cmd;
 
@@ -4,6 +4,11 @@
  * Provides access to diagnostic counters, statistics, and
  * performance metrics from the FPGA.
  *
+ * diag_read_all() and diag_read_delta() work from a latched snapshot:
+ * one strobe copies every counter into a shadow bank at once, so values in
+ * a snapshot are consistent with each other while the live counters keep
+ * moving.
+ *
  * Created: 2025-12-04 13:30
  */
 
@@ -86,6 +91,17 @@
 #define DIAG_SEEK_AVG_TIME  (*(volatile uint32_t *)(DIAG_BASE + 0x118))
 #define DIAG_SEEK_CTRL      (*(volatile uint32_t *)(DIAG_BASE + 0x11C))
 
+/* Snapshot Latch (0x120-0x124) */
+#define DIAG_LATCH_CTRL     (*(volatile uint32_t *)(DIAG_BASE + 0x120))
+#define DIAG_LATCH_GEN      (*(volatile uint32_t *)(DIAG_BASE + 0x124))   /* Latches taken (RO) */
+
+#define DIAG_LATCH_STROBE   0x01    /* Copy 0x000-0x11C to the shadow bank */
+
+/* Shadow Bank (0x200-0x31C): 0x000-0x11C as of the last latch */
+#define DIAG_SHADOW_BASE    (DIAG_BASE + 0x200)
+#define DIAG_SHADOW(n)      (*(volatile uint32_t *)(DIAG_SHADOW_BASE + (n)*4))
+#define DIAG_SNAP_WORDS     (0x120 / 4)
+
 /*============================================================================
  * Data Structures
  *============================================================================*/
@@ -187,6 +203,14 @@ typedef struct {
     diag_seek_t    seek;
 } diag_snapshot_t;
 
+/**
+ * One counter word that changed, from diag_read_delta()
+ */
+typedef struct {
+    uint16_t offset;            /* Register offset from DIAG_BASE */
+    uint32_t value;
+} diag_delta_t;
+
 /*============================================================================
  * HAL Return Codes
  *============================================================================*/
@@ -260,9 +284,23 @@ int diag_clear_seek(void);
 
 /**
  * Read complete diagnostics snapshot
+ * All groups come from one latch.
  */
 int diag_read_all(diag_snapshot_t *snapshot);
 
+/**
+ * Latch a snapshot and report the counter words that changed
+ * Words are reported in offset order when they changed after generation
+ * *gen. Pass *gen = 0 to get every word. On return *gen holds the
+ * generation of this snapshot, which the caller keeps for the next call;
+ * each caller keeps its own.
+ *
+ * @param gen       In: last generation seen, out: this generation
+ * @param out       Room for DIAG_SNAP_WORDS entries
+ * @return number of entries, or DIAG_ERR_INVALID
+ */
+int diag_read_delta(uint32_t *gen, diag_delta_t *out);
+
 /**
  * Clear all diagnostics
  */
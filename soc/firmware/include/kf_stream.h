@@ -0,0 +1,123 @@
+/*-----------------------------------------------------------------------------
+ * kf_stream.h
+ * KryoFlux Stream Encoding
+ *
+ * Created: 2025-12-09 14:10
+ *
+ * Converts FluxRipper capture words (raw_protocol.h: 27-bit 200 MHz
+ * timestamps, FLUX_FLAG_INDEX on index marks) into the KryoFlux stream
+ * format written by DTC (softpres.org/kryoflux:stream). The encoder keeps
+ * its state between calls, so a track is converted one DMA chunk at a
+ * time and the pieces concatenate into a single stream file.
+ *
+ * Sample clock: sck = ((18432000 * 73) / 14) / 2 = 24027428.57 Hz, index
+ * clock ick = sck / 8. The 200 MHz -> sck conversion carries its remainder
+ * and does not drift.
+ *---------------------------------------------------------------------------*/
+
+#ifndef KF_STREAM_H
+#define KF_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------------------------------------------------
+ * Stream Format
+ *---------------------------------------------------------------------------*/
+
+/* Block headers */
+#define KF_FLUX2_MAX            0x07        /* 0x00-0x07: Flux2 (2 bytes) */
+#define KF_NOP1                 0x08
+#define KF_NOP2                 0x09
+#define KF_NOP3                 0x0A
+#define KF_OVL16                0x0B        /* Add 0x10000 to the next cell */
+#define KF_FLUX3                0x0C        /* 0x0C, value (big endian) */
+#define KF_OOB                  0x0D        /* 0x0D, type, size (LE16), data */
+#define KF_FLUX1_MIN            0x0E        /* 0x0E-0xFF: Flux1 (1 byte) */
+
+/* OOB block types */
+#define KF_OOB_STREAM_INFO      0x01        /* Stream position, transfer ms */
+#define KF_OOB_INDEX            0x02        /* Stream position, sample/index counters */
+#define KF_OOB_STREAM_END       0x03        /* Stream position, result */
+#define KF_OOB_KF_INFO          0x04        /* NUL-terminated key=value text */
+#define KF_OOB_EOF              0x0D        /* Size 0x0D0D, no data */
+
+/* KF_OOB_STREAM_END result */
+#define KF_RESULT_OK            0
+#define KF_RESULT_BUFFERING     1           /* Capture data lost */
+#define KF_RESULT_NO_INDEX      2
+
+/* FDC_FREQ_HZ : sck = 21875 : 2628 */
+#define KF_CLK_DIV              21875       /* FDC clocks ... */
+#define KF_TICK_MUL             2628        /* ... per this many sck ticks */
+
+/* Largest single block: an index OOB (a flux cell needs at most 3 bytes
+ * plus one KF_OVL16 per 0x10000 ticks) */
+#define KF_MAX_BLOCK            16
+
+/* kf_stream_begin()/kf_stream_end() output bounds */
+#define KF_HEADER_MAX           128
+#define KF_TRAILER_MAX          16
+
+/*---------------------------------------------------------------------------
+ * Encoder
+ *---------------------------------------------------------------------------*/
+
+typedef struct {
+    bool        started;            /* First word seen */
+    uint32_t    prev_ts;            /* Timestamp of the last word */
+    uint32_t    rem;                /* Conversion remainder (clocks * 2628) */
+    uint32_t    since_flux;         /* Ticks since the last transition */
+    uint32_t    ticks;              /* Ticks since the first word */
+    uint32_t    position;           /* Stream position (non-OOB bytes) */
+    uint32_t    index_count;
+} kf_stream_t;
+
+/**
+ * Start a stream
+ * @param s encoder
+ */
+void kf_stream_init(kf_stream_t *s);
+
+/**
+ * Write the KF_OOB_KF_INFO block that opens a stream (clock rates)
+ * @param s encoder
+ * @param dst output (KF_HEADER_MAX bytes)
+ * @return bytes written
+ */
+uint32_t kf_stream_begin(kf_stream_t *s, uint8_t *dst);
+
+/**
+ * Write a KF_OOB_STREAM_INFO block for the current stream position
+ * @param s encoder
+ * @param dst output (12 bytes)
+ * @param transfer_ms time since the stream started
+ * @return bytes written
+ */
+uint32_t kf_stream_info(kf_stream_t *s, uint8_t *dst, uint32_t transfer_ms);
+
+/**
+ * Encode capture words: flux cells, plus a KF_OOB_INDEX block per index
+ * mark. Stops early, at a word boundary, if the next word may not fit.
+ * @param s encoder
+ * @param words capture words
+ * @param n number of words
+ * @param dst output
+ * @param cap output space in bytes
+ * @param consumed on exit: words taken (may be NULL)
+ * @return bytes written
+ */
+uint32_t kf_stream_encode(kf_stream_t *s, const uint32_t *words, uint32_t n,
+                          uint8_t *dst, uint32_t cap, uint32_t *consumed);
+
+/**
+ * Close the stream: KF_OOB_STREAM_END, then KF_OOB_EOF
+ * @param s encoder
+ * @param dst output (KF_TRAILER_MAX bytes)
+ * @param result KF_RESULT_* (KF_RESULT_NO_INDEX is also set here if no
+ *               index mark was seen)
+ * @return bytes written
+ */
+uint32_t kf_stream_end(kf_stream_t *s, uint8_t *dst, uint32_t result);
+
+#endif /* KF_STREAM_H */
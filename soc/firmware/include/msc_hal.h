@@ -39,6 +39,18 @@
 #define MSC_ERR_WRITE       6
 #define MSC_ERR_INVALID_LUN 7
 
+/* LUN state word (msc_hal_get_state) */
+#define MSC_STATE_READY     (1 << 0)    /* Media present and configured */
+#define MSC_STATE_WP        (1 << 1)    /* Write-protected */
+#define MSC_STATE_CHANGED   (1 << 2)    /* Media changed, not yet checked */
+#define MSC_STATE_RESCAN    (1 << 3)    /* Change interrupt seen, LUN not re-read */
+
+/*
+ * Empty LUNs and HDDs (which raise no interrupt) are re-probed this often;
+ * ready floppies have their disk-change state checked at the same rate
+ */
+#define MSC_PROBE_MS        1000
+
 /*---------------------------------------------------------------------------
  * Data Structures
  *---------------------------------------------------------------------------*/
@@ -52,9 +64,11 @@ typedef struct {
     bool        present;        /* Media present */
     bool        removable;      /* Removable media flag */
     bool        readonly;       /* Write-protected */
-    bool        changed;        /* Media changed since last check */
+    bool        provisional;    /* HDD capacity from a quick scan, full scan pending */
     uint32_t    capacity;       /* Total sectors */
     uint16_t    block_size;     /* Bytes per sector */
+    uint8_t     heads;          /* Heads per cylinder (0 = unknown) */
+    uint8_t     sectors_per_track; /* Sectors per track (0 = unknown) */
     char        vendor[9];      /* Vendor string (8 chars + null) */
     char        product[17];    /* Product string (16 chars + null) */
     char        revision[5];    /* Revision string (4 chars + null) */
@@ -99,14 +113,23 @@ int msc_hal_get_lun_config(uint8_t lun, msc_lun_config_t *config);
  *---------------------------------------------------------------------------*/
 
 /**
- * Check if LUN is ready
+ * Get a LUN's cached state word
+ * Kept current by the media-change interrupt and msc_hal_poll(); reading
+ * it touches no drive registers.
+ * @param lun LUN number
+ * @return MSC_STATE_xxx bits (0 for an invalid LUN)
+ */
+uint32_t msc_hal_get_state(uint8_t lun);
+
+/**
+ * Check if LUN is ready (from the cached state word)
  * @param lun LUN number
  * @return true if ready, false otherwise
  */
 bool msc_hal_is_ready(uint8_t lun);
 
 /**
- * Check if LUN is write-protected
+ * Check if LUN is write-protected (from the cached state word)
  * @param lun LUN number
  * @return true if write-protected
  */
@@ -121,13 +144,16 @@ bool msc_hal_media_changed(uint8_t lun);
 
 /**
  * Notify that media has changed (called from interrupt handler)
- * Sets the changed flag and re-scans drive geometry
+ * Drops the LUN's cached tracks, marks it not ready until msc_hal_poll()
+ * has re-read it, and raises UNIT ATTENTION for the host.
  * @param lun LUN index (0-3)
  */
 void msc_hal_notify_media_changed(uint8_t lun);
 
 /**
  * Read sectors from LUN
+ * Served from the track cache where possible; a miss reads the whole
+ * track side.
  * @param lun LUN number
  * @param lba Starting logical block address
  * @param buf Buffer to receive data
@@ -136,8 +162,48 @@ void msc_hal_notify_media_changed(uint8_t lun);
  */
 int msc_hal_read_sectors(uint8_t lun, uint32_t lba, void *buf, uint32_t count);
 
+/**
+ * Verify sectors on LUN media
+ * Reads the range with CRC checks in the drive decoder and transfers no
+ * data, a track side per command. Cached writes to the range are written
+ * back first; cached reads are bypassed.
+ * @param lun LUN number
+ * @param lba Starting logical block address
+ * @param count Number of sectors to verify
+ * @param bad_lba Output: first sector that failed (may be NULL)
+ * @return MSC_OK if all sectors read back clean, MSC_ERR_READ on a bad
+ *         sector, MSC_ERR_WRITE if a write-back failed, error code otherwise
+ */
+int msc_hal_verify_sectors(uint8_t lun, uint32_t lba, uint32_t count, uint32_t *bad_lba);
+
+/**
+ * Queue read-ahead from a LUN
+ * Replaces any pending window with the track sides of one cylinder
+ * starting at the track holding lba. Non-blocking: on FDD it only issues
+ * the seek, msc_hal_poll() does the reads.
+ * @param lun LUN number
+ * @param lba First sector the host is expected to read next
+ */
+void msc_hal_prefetch(uint8_t lun, uint32_t lba);
+
+/**
+ * Drop pending read-ahead for a LUN
+ * A background seek already issued still completes.
+ * @param lun LUN number
+ */
+void msc_hal_prefetch_cancel(uint8_t lun);
+
+/**
+ * Advance background work (LUN rescans, aged write-back, then read-ahead)
+ * Writes or reads at most one track side per call. Call from the transport loop
+ * while the previous command's data is being sent to the host.
+ */
+void msc_hal_poll(void);
+
 /**
  * Write sectors to LUN
+ * Held in the track cache where possible and written back a whole track
+ * at a time; see msc_hal_flush().
  * @param lun LUN number
  * @param lba Starting logical block address
  * @param buf Buffer containing data to write
@@ -148,21 +214,32 @@ int msc_hal_write_sectors(uint8_t lun, uint32_t lba, const void *buf, uint32_t c
 
 /**
  * Start/Stop unit (motor control)
+ * Flushes buffered writes first.
  * @param lun LUN number
  * @param start true to start, false to stop
  * @param eject true to eject media (if supported)
- * @return MSC_OK on success
+ * @return MSC_OK on success, MSC_ERR_WRITE if buffered data was lost
  */
 int msc_hal_start_stop(uint8_t lun, bool start, bool eject);
 
 /**
  * Prevent/Allow medium removal
+ * Allowing removal flushes buffered writes.
  * @param lun LUN number
  * @param prevent true to prevent removal, false to allow
- * @return MSC_OK on success
+ * @return MSC_OK on success, MSC_ERR_WRITE if buffered data was lost
  */
 int msc_hal_prevent_removal(uint8_t lun, bool prevent);
 
+/**
+ * Write buffered sectors of a LUN to the media
+ * Also reports write-backs that failed in the background since the
+ * last flush.
+ * @param lun LUN number
+ * @return MSC_OK on success, MSC_ERR_WRITE if any buffered data was lost
+ */
+int msc_hal_flush(uint8_t lun);
+
 /*---------------------------------------------------------------------------
  * Geometry and Capacity
  *---------------------------------------------------------------------------*/
@@ -204,4 +281,11 @@ int msc_hal_get_last_error(uint8_t lun);
 void msc_hal_get_stats(uint8_t lun, uint32_t *read_count,
                        uint32_t *write_count, uint32_t *error_count);
 
+/**
+ * Get track cache statistics (all LUNs)
+ * @param hits Pointer to receive track hits
+ * @param misses Pointer to receive track reads from the drive
+ */
+void msc_hal_get_cache_stats(uint32_t *hits, uint32_t *misses);
+
 #endif /* MSC_HAL_H */
@@ -41,8 +41,38 @@
 #define FS_METADATA_BASE    0x40600000
 #define FS_METADATA_SIZE    (512 * 1024)        /* 512KB */
 
-#define HEAP_BASE           0x40680000
-#define HEAP_SIZE           (1536 * 1024)       /* 1.5MB */
+#define SCSI_XFER_BASE      0x40680000          /* MSC data phase ring */
+#define SCSI_XFER_SIZE      (64 * 1024)         /* 64KB */
+
+#define WD_BURST_BASE       0x40690000          /* WD emulation READ SECTORS staging */
+#define WD_BURST_SIZE       (128 * 1024)        /* 128KB: 256 sectors */
+
+#define USBLOG_STREAM_BASE  0x406B0000          /* USB logger pcapng blocks */
+#define USBLOG_STREAM_SIZE  (64 * 1024)         /* 64KB */
+
+#define HFE_STAGE_BASE      0x406C0000          /* HFE server staged cylinders */
+#define HFE_STAGE_SIZE      (192 * 1024)        /* 192KB: 3 x 2 sides x 32KB */
+
+#define UART_RING_BASE      0x406F0000          /* UART TX/RX rings */
+#define UART_RING_SIZE      (16 * 1024)         /* 16KB */
+
+#define CLI_BIN_BASE        0x406F4000          /* CLI binary response frame */
+#define CLI_BIN_SIZE        (4 * 1024)          /* 4KB */
+
+#define IMGW_BUF_BASE       0x406F5000          /* FAT image writer buffers (page aligned) */
+#define IMGW_BUF_SIZE       (192 * 1024)        /* 192KB: 2 capture + 1 staging x 64KB */
+
+#define DIAG_CAPTURE_BASE   0x40725000          /* Eye diagram bins + waveform ring */
+#define DIAG_CAPTURE_SIZE   (8 * 1024)          /* 8KB */
+
+#define PRECOMP_BUF_BASE    0x40727000          /* Precomp calibration test track */
+#define PRECOMP_BUF_SIZE    (32 * 1024)         /* 32KB: 64 sectors */
+
+#define DBG_TRACE_BASE      0x4072F000          /* Trace buffer readout / TRACE_DUMP frame */
+#define DBG_TRACE_SIZE      (36 * 1024)         /* 36KB: 4096 entries + frame header */
+
+#define HEAP_BASE           0x40738000
+#define HEAP_SIZE           (800 * 1024)        /* 800KB */
 
 /* Peripherals */
 #define PERIPH_BASE         0x80000000
@@ -57,15 +87,16 @@
 #define HDD_BASE            (PERIPH_BASE + 0x7000)  /* HDD Controller (ST-506/ESDI) */
 #define I2C_BASE            (PERIPH_BASE + 0x8000)  /* AXI I2C Master */
 #define PMU_BASE            (PERIPH_BASE + 0x9000)  /* Power Monitor Unit */
+#define DMA_B_BASE          (PERIPH_BASE + 0xC000)  /* AXI DMA, flux interface B */
 
 /*============================================================================
  * AXI UART Lite Registers
  *============================================================================*/
 
-#define UART_RX_FIFO        (*(volatile uint32_t *)(UART_BASE + 0x00))
-#define UART_TX_FIFO        (*(volatile uint32_t *)(UART_BASE + 0x04))
-#define UART_STAT           (*(volatile uint32_t *)(UART_BASE + 0x08))
-#define UART_CTRL           (*(volatile uint32_t *)(UART_BASE + 0x0C))
+#define UART_RX_FIFO        REG32(UART_BASE + 0x00)
+#define UART_TX_FIFO        REG32(UART_BASE + 0x04)
+#define UART_STAT           REG32(UART_BASE + 0x08)
+#define UART_CTRL           REG32(UART_BASE + 0x0C)
 
 /* UART Status bits */
 #define UART_STAT_RX_VALID      (1 << 0)
@@ -82,13 +113,27 @@
 #define UART_CTRL_RST_RX        (1 << 1)
 #define UART_CTRL_INTR_EN       (1 << 4)
 
+/*============================================================================
+ * AXI Interrupt Controller Registers
+ *============================================================================*/
+
+#define INTC_ISR            REG32(INTC_BASE + 0x00)  /* Status (raw) */
+#define INTC_IPR            REG32(INTC_BASE + 0x04)  /* Pending (ISR & IER) */
+#define INTC_IER            REG32(INTC_BASE + 0x08)  /* Enable */
+#define INTC_IAR            REG32(INTC_BASE + 0x0C)  /* Acknowledge (W1C) */
+#define INTC_MER            REG32(INTC_BASE + 0x1C)  /* Master enable */
+
+/* INTC Master Enable bits */
+#define INTC_MER_ME             (1 << 0)    /* Drive the irq output */
+#define INTC_MER_HIE            (1 << 1)    /* Hardware inputs (write-once) */
+
 /*============================================================================
  * AXI Timer Registers
  *============================================================================*/
 
-#define TIMER_TCSR0         (*(volatile uint32_t *)(TIMER_BASE + 0x00))
-#define TIMER_TLR0          (*(volatile uint32_t *)(TIMER_BASE + 0x04))
-#define TIMER_TCR0          (*(volatile uint32_t *)(TIMER_BASE + 0x08))
+#define TIMER_TCSR0         REG32(TIMER_BASE + 0x00)
+#define TIMER_TLR0          REG32(TIMER_BASE + 0x04)
+#define TIMER_TCR0          REG32(TIMER_BASE + 0x08)
 
 /* Timer Control/Status bits */
 #define TIMER_TCSR_MDT          (1 << 0)    /* Mode: 0=generate, 1=capture */
@@ -104,14 +149,45 @@
 #define TIMER_TCSR_ENALL        (1 << 10)   /* Enable all timers */
 #define TIMER_TCSR_CASC         (1 << 11)   /* Cascade mode */
 
+/*============================================================================
+ * AXI DMA Registers (S2MM, direct register mode)
+ *============================================================================*/
+
+#define DMA_S2MM_DMACR      REG32(DMA_BASE + 0x30)
+#define DMA_S2MM_DMASR      REG32(DMA_BASE + 0x34)
+#define DMA_S2MM_DA         REG32(DMA_BASE + 0x48)
+#define DMA_S2MM_LENGTH     REG32(DMA_BASE + 0x58)   /* Write starts; read = bytes received */
+
+/* Per channel: 0 = flux interface A (and tape segments), 1 = interface B */
+#define DMA_CH_BASE(ch)         ((ch) == 0 ? DMA_BASE : DMA_B_BASE)
+#define DMA_S2MM_DMACR_CH(ch)   REG32(DMA_CH_BASE(ch) + 0x30)
+#define DMA_S2MM_DMASR_CH(ch)   REG32(DMA_CH_BASE(ch) + 0x34)
+#define DMA_S2MM_DA_CH(ch)      REG32(DMA_CH_BASE(ch) + 0x48)
+#define DMA_S2MM_LENGTH_CH(ch)  REG32(DMA_CH_BASE(ch) + 0x58)
+
+/* DMA Control bits */
+#define DMA_CR_RS               (1 << 0)    /* Run/stop */
+#define DMA_CR_RESET            (1 << 2)    /* Soft reset */
+#define DMA_CR_IOC_IRQ_EN       (1 << 12)   /* Interrupt on complete */
+#define DMA_CR_ERR_IRQ_EN       (1 << 14)   /* Interrupt on error */
+
+/* DMA Status bits */
+#define DMA_SR_HALTED           (1 << 0)
+#define DMA_SR_IDLE             (1 << 1)
+#define DMA_SR_INT_ERR          (1 << 4)    /* Internal error */
+#define DMA_SR_SLV_ERR          (1 << 5)    /* Slave error */
+#define DMA_SR_DEC_ERR          (1 << 6)    /* Decode error */
+#define DMA_SR_IOC_IRQ          (1 << 12)   /* Transfer complete (W1C) */
+#define DMA_SR_ERR_IRQ          (1 << 14)   /* Error (W1C) */
+
 /*============================================================================
  * AXI GPIO Registers
  *============================================================================*/
 
-#define GPIO_DATA           (*(volatile uint32_t *)(GPIO_BASE + 0x00))
-#define GPIO_TRI            (*(volatile uint32_t *)(GPIO_BASE + 0x04))
-#define GPIO_DATA2          (*(volatile uint32_t *)(GPIO_BASE + 0x08))
-#define GPIO_TRI2           (*(volatile uint32_t *)(GPIO_BASE + 0x0C))
+#define GPIO_DATA           REG32(GPIO_BASE + 0x00)
+#define GPIO_TRI            REG32(GPIO_BASE + 0x04)
+#define GPIO_DATA2          REG32(GPIO_BASE + 0x08)
+#define GPIO_TRI2           REG32(GPIO_BASE + 0x0C)
 
 /*============================================================================
  * DC-DC Converter GPIO Bit Assignments (GPIO Channel 2)
@@ -178,9 +254,78 @@
 #define BIT(n)              (1U << (n))
 #define ARRAY_SIZE(a)       (sizeof(a) / sizeof((a)[0]))
 
-/* Memory-mapped register access */
+/*
+ * Memory-mapped register access
+ *
+ * FW_HOST builds (make host) route every access through the register shim
+ * in host/host_shim.c, which runs the device models and advances virtual
+ * time before returning the backing word.
+ */
+#ifdef FW_HOST
+volatile void *host_mmio(uintptr_t addr);
+#define REG32(addr)         (*(volatile uint32_t *)host_mmio((uintptr_t)(addr)))
+#define REG16(addr)         (*(volatile uint16_t *)host_mmio((uintptr_t)(addr)))
+#define REG8(addr)          (*(volatile uint8_t *)host_mmio((uintptr_t)(addr)))
+#else
 #define REG32(addr)         (*(volatile uint32_t *)(addr))
 #define REG16(addr)         (*(volatile uint16_t *)(addr))
 #define REG8(addr)          (*(volatile uint8_t *)(addr))
+#endif
+
+/*============================================================================
+ * Interrupt Masking (mstatus.MIE)
+ *============================================================================*/
+
+#define MSTATUS_MIE         (1 << 3)
+#define MIE_MEIE            (1 << 11)   /* Machine external interrupt (INTC) */
+
+#ifdef FW_HOST
+/* Host build is single-threaded; nothing to mask */
+static inline uint32_t irq_save(void) { return 0; }
+static inline void irq_restore(uint32_t mstatus) { (void)mstatus; }
+static inline void irq_enable(void) { }
+#else
+static inline uint32_t irq_save(void)
+{
+    uint32_t mstatus;
+    __asm__ volatile ("csrrci %0, mstatus, %1" : "=r"(mstatus) : "i"(MSTATUS_MIE));
+    return mstatus;
+}
+
+static inline void irq_restore(uint32_t mstatus)
+{
+    if (mstatus & MSTATUS_MIE) {
+        __asm__ volatile ("csrsi mstatus, %0" : : "i"(MSTATUS_MIE));
+    }
+}
+
+/* Unmask the external interrupt line, then interrupts globally */
+static inline void irq_enable(void)
+{
+    __asm__ volatile ("csrs mie, %0" : : "r"(MIE_MEIE));
+    __asm__ volatile ("csrsi mstatus, %0" : : "i"(MSTATUS_MIE));
+}
+#endif
+
+/*============================================================================
+ * Cycle Counter (mcycle)
+ *============================================================================*/
+
+/*
+ * Low word of mcycle: CPU clocks, wraps every ~42.9 s at 100 MHz, so it
+ * suits interval timing only. The host build reads the shim's virtual
+ * clock, which advances on register accesses and modelled drive time.
+ */
+#ifdef FW_HOST
+uint64_t host_cycles(void);
+static inline uint32_t cpu_cycles(void) { return (uint32_t)host_cycles(); }
+#else
+static inline uint32_t cpu_cycles(void)
+{
+    uint32_t cycles;
+    __asm__ volatile ("csrr %0, mcycle" : "=r"(cycles));
+    return cycles;
+}
+#endif
 
 #endif /* PLATFORM_H */
@@ -0,0 +1,146 @@
+/**
+ * FluxRipper PLL Parameter Search
+ *
+ * Picks loop bandwidth and damping per drive and zone by replaying a
+ * captured track through a software model of the data separator at
+ * every point of a bandwidth x damping grid. All candidates run over
+ * each captured pass together: flux is read once per block and every
+ * candidate PLL, with its own decoder, consumes the block before the
+ * next one is fetched. Loop and decoders are the flux_decode.h model. The winner recovers the most CRC-good
+ * sectors, then the most good ID fields, then has the lowest phase-error
+ * variance.
+ *
+ * Results live in per-drive records (diag_cal_record_t) that persist
+ * one page per drive at EEPROM_CAL_BASE.
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-10 16:00
+ */
+
+#ifndef PLL_CAL_H
+#define PLL_CAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "diagnostics_protocol.h"
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+/* Sweep grid */
+#define PLLCAL_BW_STEPS         5           /* 5, 10, 20, 40, 80 per mille */
+#define PLLCAL_DAMP_STEPS       4           /* 0.50, 0.71, 1.00, 1.50 */
+#define PLLCAL_CANDIDATES       (PLLCAL_BW_STEPS * PLLCAL_DAMP_STEPS)
+
+#define PLLCAL_PASS_MS          400         /* Capture timeout per pass */
+
+/*============================================================================
+ * Data Structures
+ *============================================================================*/
+
+/**
+ * One grid point, accumulated over the passes swept so far
+ */
+typedef struct {
+    uint16_t    bandwidth_pm;       /* Loop bandwidth, per mille of the cell rate */
+    uint16_t    damping;            /* Damping factor x100 */
+    uint32_t    ids;                /* CRC-good ID fields */
+    uint32_t    sectors;            /* CRC-good data fields */
+    uint32_t    transitions;        /* Transitions tracked in lock */
+    uint64_t    err2;               /* Sum of squared phase error, clocks^2 x 2^16 */
+    uint8_t     phase_rms;          /* RMS phase error, 1/256 cell */
+} pllcal_result_t;
+
+typedef struct {
+    uint8_t         encoding;       /* ENC_* */
+    uint32_t        cell_ticks;     /* Nominal channel cell, capture clocks */
+    uint32_t        passes;         /* Passes swept */
+    pllcal_result_t cand[PLLCAL_CANDIDATES];
+} pllcal_results_t;
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+/**
+ * Prepare a sweep
+ * @param results    accumulated results, cleared
+ * @param encoding   ENC_* (fdec_supported())
+ * @param cell_ticks nominal channel cell in capture clocks (fdec_cell_ticks())
+ */
+void pllcal_results_init(pllcal_results_t *results, uint8_t encoding,
+                         uint32_t cell_ticks);
+
+/**
+ * Run every candidate over one index-aligned pass of flux words
+ * @param words     flux words (FLUX_FLAG_INDEX words are skipped)
+ * @param count     word count
+ * @param results   accumulated results
+ */
+void pllcal_sweep_pass(const uint32_t *words, uint32_t count,
+                       pllcal_results_t *results);
+
+/**
+ * Pick the best candidate of a sweep
+ * @param results   accumulated results
+ * @return index into results->cand
+ */
+uint32_t pllcal_best(const pllcal_results_t *results);
+
+/**
+ * Capture one track with the current FluxStat configuration, sweep all
+ * passes and store the winner for the track's zone. With automatic
+ * encoding the format comes from the drive's session (format_cache.h).
+ * @param drive     FDC drive (0-3)
+ * @param track     track to capture
+ * @param head      head
+ * @param results   Output: full sweep results (NULL if not needed)
+ * @return FLUXSTAT_OK, FLUXSTAT_ERR_INVALID for a bad drive or an
+ *         encoding without a decoder, FLUXSTAT_ERR_NO_DATA if automatic
+ *         encoding finds no format, or the capture error
+ */
+int pllcal_calibrate_track(uint8_t drive, uint8_t track, uint8_t head,
+                           pllcal_results_t *results);
+
+/**
+ * Calibrate every zone of a drive on the middle track of each zone
+ * @param drive     FDC drive (0-3)
+ * @param head      head
+ * @return FLUXSTAT_OK, or the first failing track's error
+ */
+int pllcal_calibrate_drive(uint8_t drive, uint8_t head);
+
+/**
+ * Get the calibrated settings for a track
+ * @param drive     FDC drive (0-3)
+ * @param track     track
+ * @return settings, NULL if the track's zone is not calibrated
+ */
+const diag_pll_cal_t *pllcal_lookup(uint8_t drive, uint8_t track);
+
+/**
+ * Get a drive's calibration record
+ * @param drive     FDC drive (0-3)
+ * @return record, NULL for a bad drive
+ */
+diag_cal_record_t *pllcal_record(uint8_t drive);
+
+/**
+ * Forget all calibration (RAM only; pllcal_save() clears the EEPROM)
+ */
+void pllcal_clear(void);
+
+/**
+ * Load the records from EEPROM; drives without a valid page stay cleared
+ * @return HAL_OK, or HAL_ERR_HARDWARE if the EEPROM is not reachable
+ */
+int pllcal_load(void);
+
+/**
+ * Write the records to EEPROM
+ * @return HAL_OK, or the first page write error
+ */
+int pllcal_save(void);
+
+#endif /* PLL_CAL_H */
@@ -18,13 +18,13 @@
 int cmd_power(int argc, char *argv[]);
 
 /**
- * Initialize and register power CLI commands
- * Call this from main() or cli_init()
+ * Initialize the power HAL behind the 'power' command
+ * Call this from main() after cli_init()
  */
 void power_cli_init(void);
 
 /**
- * Power CLI command definition (for external registration)
+ * Power CLI command definition (linked in with CLI_COMMAND)
  */
 extern const cli_cmd_t power_cli_cmd;
 
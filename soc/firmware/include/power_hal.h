@@ -349,6 +349,7 @@ typedef struct {
 #define PMU_ERR_TIMEOUT     -2
 #define PMU_ERR_NO_DEVICE   -3
 #define PMU_ERR_INVALID     -4
+#define PMU_ERR_NOT_READY   -5          /* No sampled snapshot yet */
 
 /*============================================================================
  * Low-Level I2C Functions
@@ -446,20 +447,53 @@ int pmu_init(void);
 int pmu_read_rail(pmu_rail_t rail, pmu_reading_t *reading);
 
 /**
- * Read all power rails
+ * Read all power rails (blocking: a full series of I2C transactions)
+ * Prefer pmu_get_cached() outside of bring-up and tests.
  * @param system    Output: complete system status
  * @return PMU_OK on success
  */
 int pmu_read_all(pmu_system_t *system);
 
+/*============================================================================
+ * Background Sampler
+ *
+ * pmu_sample_poll() reads one rail per call (two short I2C transactions),
+ * then the input/converter status, and publishes the finished sweep as a
+ * double-buffered pmu_system_t snapshot. Readers of the snapshot never
+ * touch the bus.
+ *============================================================================*/
+
+#define PMU_SAMPLE_STEP_US      5000    /* Poll period: sweep of 19 steps ~95 ms */
+#define PMU_SAMPLE_STALE_MS     1000    /* Sample through drive work past this age */
+
+/* Connector considered powered / loaded ('enabled' / 'present' in snapshots) */
+#define PMU_CONN_ON_MV          1000
+#define PMU_CONN_PRESENT_MW     100
+
+/**
+ * Advance the sampler by one step (periodic task, every PMU_SAMPLE_STEP_US)
+ * Steps are skipped while a drive task or claim is active, unless the
+ * published snapshot is older than PMU_SAMPLE_STALE_MS.
+ */
+void pmu_sample_poll(void);
+
+/**
+ * Get the last complete snapshot
+ * @param system    Output: copy of the snapshot
+ * @param age_ms    Output: time since the sweep completed (may be NULL)
+ * @return PMU_OK, or PMU_ERR_NOT_READY before the first sweep completes
+ */
+int pmu_get_cached(pmu_system_t *system, uint32_t *age_ms);
+
 /**
- * Get total system power consumption
+ * Get total system power consumption (from the snapshot)
+ * Falls back to a blocking pmu_read_all() before the first sweep.
  * @return Total power in milliwatts
  */
 uint32_t pmu_get_total_power_mw(void);
 
 /**
- * Get drive power consumption
+ * Get drive power consumption, FDD + HDD connectors (from the snapshot)
  * @return Drive power in milliwatts
  */
 uint32_t pmu_get_drive_power_mw(void);
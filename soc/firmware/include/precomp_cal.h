@@ -0,0 +1,138 @@
+/**
+ * FluxRipper Write Precompensation Calibration
+ *
+ * Picks the FDC write precompensation per drive and zone by writing a
+ * test track at every precompensation setting, reading it back as flux
+ * and measuring peak shift in its interval histogram. MFM intervals
+ * come in 2, 3 and 4 channel cells; uncompensated peak shift pushes
+ * adjacent transitions apart, so the 2-cell peak reads long and the
+ * 4-cell peak short against the 3-cell one. Too much precompensation
+ * reverses both. The winner reads back every sector CRC-good and has
+ * the smallest combined shift; its code is applied to hal_write_sectors()
+ * for all tracks of the zone.
+ *
+ * Calibration writes the test pattern over the whole track side: use
+ * scratch media. Results are stored with the PLL settings in the
+ * per-drive records (pll_cal.h) and go to EEPROM with pllcal_save().
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-11 09:30
+ */
+
+#ifndef PRECOMP_CAL_H
+#define PRECOMP_CAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "diagnostics_protocol.h"
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#define PCAL_BINS_PER_CELL      32          /* Histogram resolution */
+#define PCAL_HIST_CELLS         5           /* Histogram range, 0-5 cells */
+#define PCAL_HIST_BINS          (PCAL_BINS_PER_CELL * PCAL_HIST_CELLS)
+#define PCAL_SETTINGS           7           /* 0 ns .. 250 ns */
+
+#define PCAL_PASS_MS            400         /* Capture timeout per pass */
+
+/*============================================================================
+ * Data Structures
+ *============================================================================*/
+
+/**
+ * Interval histogram of read-back flux, 1/PCAL_BINS_PER_CELL cell bins
+ */
+typedef struct {
+    uint32_t    bins[PCAL_HIST_BINS];
+    uint32_t    intervals;          /* Intervals binned (incl. out of range) */
+} pcal_hist_t;
+
+/**
+ * One precompensation setting
+ */
+typedef struct {
+    uint8_t     code;               /* PRECOMP_* */
+    uint16_t    precomp_ns;         /* Write shift of the setting */
+    uint8_t     sectors;            /* CRC-good sectors read back (pass 0) */
+    int16_t     peak[3];            /* 2, 3 and 4 cell peaks, 1/256 cell */
+    int16_t     shift2;             /* 2-cell peak vs. 2/3 of the 3-cell one */
+    int16_t     shift4;             /* 4-cell peak vs. 4/3 of the 3-cell one */
+} pcal_result_t;
+
+typedef struct {
+    uint32_t        cell_ticks;     /* Nominal channel cell, capture clocks */
+    uint8_t         sectors;        /* Sectors written per setting */
+    pcal_result_t   cand[PCAL_SETTINGS];
+} pcal_results_t;
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+/**
+ * Add one pass of flux words to an interval histogram
+ * @param words     flux words (FLUX_FLAG_INDEX words are skipped)
+ * @param count     word count
+ * @param cell_ticks nominal channel cell in capture clocks
+ * @param hist      histogram to accumulate into
+ */
+void pcal_histogram(const uint32_t *words, uint32_t count, uint32_t cell_ticks,
+                    pcal_hist_t *hist);
+
+/**
+ * Measure the 2/3/4 cell peaks of a histogram
+ * @param hist      accumulated histogram
+ * @param result    Output: peak, shift2 and shift4
+ */
+void pcal_measure(const pcal_hist_t *hist, pcal_result_t *result);
+
+/**
+ * Pick the best setting of a calibration
+ * @return index into results->cand
+ */
+uint32_t pcal_best(const pcal_results_t *results);
+
+/**
+ * Write, read back and measure one track side at every setting and store
+ * the winner for the track's zone. Overwrites the track side.
+ * @param drive     FDC drive (0-1)
+ * @param track     track to use
+ * @param head      head
+ * @param results   Output: every setting (NULL if not needed)
+ * @return FLUXSTAT_OK, FLUXSTAT_ERR_INVALID for a bad drive, write
+ *         protected media or an encoding other than MFM,
+ *         FLUXSTAT_ERR_NO_DATA if no setting reads back, or the write or
+ *         capture error
+ */
+int pcal_calibrate_track(uint8_t drive, uint8_t track, uint8_t head,
+                         pcal_results_t *results);
+
+/**
+ * Calibrate every zone of a drive on the middle track of each zone
+ * @param drive     FDC drive (0-1)
+ * @param head      head
+ * @return FLUXSTAT_OK, or the first failing track's error
+ */
+int pcal_calibrate_drive(uint8_t drive, uint8_t head);
+
+/**
+ * Get the calibrated precompensation for a track
+ * @return setting, NULL if the track's zone is not calibrated
+ */
+const diag_precomp_cal_t *pcal_lookup(uint8_t drive, uint8_t track);
+
+/**
+ * Program the calibrated zones of every drive into the HAL
+ * Call after pllcal_load(); uncalibrated zones get PRECOMP_DEFAULT.
+ */
+void pcal_apply(void);
+
+/**
+ * Write shift of a PRECOMP_* code at a data rate
+ * @return nanoseconds
+ */
+uint16_t pcal_precomp_ns(uint8_t code, uint32_t data_rate);
+
+#endif /* PRECOMP_CAL_H */
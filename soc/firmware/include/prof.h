@@ -0,0 +1,105 @@
+/**
+ * FluxRipper SoC - Hot Path Profiler
+ *
+ * Begin/end zones timed with the CPU cycle counter (mcycle). Each zone
+ * keeps calls, total, min and max cycles in a static table, read out by
+ * the 'prof' CLI command and DIAG_CMD_GET_PROFILE.
+ *
+ * A zone costs two CSR reads and a short masked update, so zones go
+ * around whole operations (a command, a sector run), not inner loops.
+ * Build with -DPROF_ENABLE=0 to compile them out.
+ *
+ * Created: 2025-12-09 09:10
+ */
+
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdint.h>
+#include "platform.h"
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE         1
+#endif
+
+/*============================================================================
+ * Zones
+ *============================================================================*/
+
+typedef enum {
+    PROF_SCSI_CMD = 0,          /* scsi_process_command */
+    PROF_RAW_CMD,               /* raw_mode_process_command */
+    PROF_HISTOGRAM_ADD,         /* Diagnostics histogram sample */
+    PROF_FDD_READ,              /* hal_read_sectors track loop, incl. drive time */
+    PROF_HDD_READ,              /* HDD sector buffer copy-out */
+    PROF_MSC_READ,              /* msc_hal_read_sectors (cache or drive) */
+    PROF_ZONES
+} prof_zone_t;
+
+/**
+ * Zone statistics (CPU cycles)
+ */
+typedef struct {
+    uint32_t calls;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} prof_stats_t;
+
+extern prof_stats_t prof_table[PROF_ZONES];
+
+/*============================================================================
+ * Instrumentation
+ *============================================================================*/
+
+#if PROF_ENABLE
+
+/* Account one pass through a zone; safe against ISRs using zones too */
+static inline void prof_record(prof_zone_t zone, uint32_t cycles)
+{
+    prof_stats_t *z = &prof_table[zone];
+    uint32_t irq = irq_save();
+
+    z->calls++;
+    z->total += cycles;
+    if (z->calls == 1 || cycles < z->min) {
+        z->min = cycles;
+    }
+    if (cycles > z->max) {
+        z->max = cycles;
+    }
+
+    irq_restore(irq);
+}
+
+/* Open and close a zone in the same scope */
+#define PROF_BEGIN(zone)    uint32_t prof_t0_##zone = cpu_cycles()
+#define PROF_END(zone)      prof_record((zone), cpu_cycles() - prof_t0_##zone)
+
+#else
+
+#define PROF_BEGIN(zone)    do { } while (0)
+#define PROF_END(zone)      do { } while (0)
+
+#endif
+
+/*============================================================================
+ * Readout
+ *============================================================================*/
+
+/**
+ * Clear all zones
+ */
+void prof_reset(void);
+
+/**
+ * Copy the zone table as one consistent snapshot
+ */
+void prof_snapshot(prof_stats_t *out);
+
+/**
+ * Short zone name ("scsi", "raw", ...)
+ */
+const char *prof_zone_name(prof_zone_t zone);
+
+#endif /* PROF_H */
@@ -0,0 +1,30 @@
+/**
+ * FluxRipper Profiler CLI Commands - Header
+ *
+ * Command-line readout of the hot path cycle profile (prof.h).
+ *
+ * Created: 2025-12-09 09:10
+ */
+
+#ifndef PROF_CLI_H
+#define PROF_CLI_H
+
+#include "cli.h"
+
+/**
+ * prof [reset] - Show or clear the zone table
+ */
+int cmd_prof(int argc, char *argv[]);
+
+/**
+ * Clear the profile behind the 'prof' command
+ * Call this from main() or cli_init()
+ */
+void prof_cli_init(void);
+
+/**
+ * Profiler CLI command definition (linked in with CLI_COMMAND)
+ */
+extern const cli_cmd_t prof_cli_cmd;
+
+#endif /* PROF_CLI_H */
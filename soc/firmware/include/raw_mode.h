@@ -52,14 +52,28 @@ void raw_mode_reset(void);
 
 /**
  * Process a raw mode command packet
- * @param cmd Command packet (16 bytes)
+ * @param cmd Command packet (16 bytes); for RAW_CMD_BATCH, the start of the
+ *            OUT transfer with the sub-command packets following it
+ * @param cmd_len Bytes received in the OUT transfer; packets shorter than
+ *                RAW_CMD_PACKET_SIZE are rejected
  * @param response Buffer for response data
  * @param response_len On exit: actual response length
  * @return 0 on success, error code otherwise
  */
-int raw_mode_process_command(const raw_cmd_packet_t *cmd,
+int raw_mode_process_command(const raw_cmd_packet_t *cmd, uint32_t cmd_len,
                              uint8_t *response, uint32_t *response_len);
 
+/**
+ * Process a command received on a session's endpoints
+ * raw_mode_process_command() is session 0. Session entry points must all
+ * be called from the same context (not from an ISR).
+ * @param session Session (0 to RAW_SESSIONS-1)
+ * @return 0 on success, error code otherwise (-1 for a bad session)
+ */
+int raw_mode_session_command(uint8_t session, const raw_cmd_packet_t *cmd,
+                             uint32_t cmd_len, uint8_t *response,
+                             uint32_t *response_len);
+
 /*---------------------------------------------------------------------------
  * Individual Command Handlers
  *---------------------------------------------------------------------------*/
@@ -102,6 +116,44 @@ int raw_cmd_capture_start(uint8_t *response, uint32_t *response_len);
  */
 int raw_cmd_capture_stop(uint8_t *response, uint32_t *response_len);
 
+/**
+ * Handle READ_FLUX command - start a streaming capture
+ * @param revolutions Revolutions to capture (0 = default)
+ * @param format Chunk payload format (RAW_FLUX_FMT_*)
+ * @param max_samples Sample limit (0 = RAW_MAX_FLUX_SAMPLES)
+ */
+int raw_cmd_read_flux(uint8_t revolutions, uint8_t format, uint32_t max_samples,
+                      uint8_t *response, uint32_t *response_len);
+
+/**
+ * Handle BATCH command - queue sub-commands for back-to-back execution
+ * @param cmd BATCH packet, followed by param2 sub-command packets
+ * @param cmd_len Bytes received, BATCH packet included; must cover all
+ *                param2 sub-commands
+ */
+int raw_cmd_batch(const raw_cmd_packet_t *cmd, uint32_t cmd_len,
+                  uint8_t *response, uint32_t *response_len);
+
+/**
+ * Handle IMAGE command - capture a track range as a sequence of streams
+ * @param cmd IMAGE packet (see raw_protocol.h for the parameter layout)
+ */
+int raw_cmd_image(const raw_cmd_packet_t *cmd, uint8_t *response,
+                  uint32_t *response_len);
+
+/**
+ * Handle TAPE_READ command - stream a QIC-117 tape segment by segment
+ * @param cmd TAPE_READ packet (see raw_protocol.h for the parameter layout)
+ */
+int raw_cmd_tape_read(const raw_cmd_packet_t *cmd, uint8_t *response,
+                      uint32_t *response_len);
+
+/**
+ * Handle TRACE_DUMP command - export the debug trace buffer
+ * The frame (raw_trace_info_t + entries) follows from raw_mode_stream_get().
+ */
+int raw_cmd_trace_dump(uint8_t *response, uint32_t *response_len);
+
 /**
  * Handle GET_PLL_STATUS command
  */
@@ -146,6 +198,88 @@ bool raw_mode_is_capturing(void);
  */
 int raw_mode_get_capture_info(raw_capture_info_t *info);
 
+/*---------------------------------------------------------------------------
+ * Flux Streaming (READ_FLUX)
+ *
+ * The USB transport drains the stream after the READ_FLUX response:
+ * raw_mode_stream_get() hands out the next filled chunk in place, and
+ * raw_mode_stream_release() returns it to the DMA once the bulk IN
+ * transfer has completed. At most two chunks are outstanding.
+ *
+ * A BATCH is driven by the same calls: raw_mode_stream_get() runs queued
+ * sub-commands whenever no stream is open and finally hands out the
+ * BATCH frame. An IMAGE job likewise advances inside raw_mode_stream_get(),
+ * which interleaves its IMAGE frames with the per-track streams, and the
+ * TRACE_DUMP frame is handed out the same way.
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Service the flux DMA (called from the DMA ISR or polling loop)
+ * Also drains the FDC FIFO while an IMAGE job reads sectors, so it must
+ * run at least every few FIFO-fulls of data time.
+ */
+void raw_mode_stream_poll(void);
+
+/**
+ * Get the next stream segment to send
+ * @param data On exit: segment start (valid until released)
+ * @param len On exit: segment length in bytes
+ * @return 1 if a segment is ready, 0 if none yet, -1 on error
+ */
+int raw_mode_stream_get(const uint8_t **data, uint32_t *len);
+
+/**
+ * Release the oldest segment returned by raw_mode_stream_get()
+ */
+void raw_mode_stream_release(void);
+
+/**
+ * Get the next stream segment of one session
+ * raw_mode_stream_get() is session 0, which also carries the job frames.
+ * @return 1 if a segment is ready, 0 if none yet, -1 on error
+ */
+int raw_mode_session_stream_get(uint8_t session, const uint8_t **data, uint32_t *len);
+
+/**
+ * Release the oldest segment returned for a session
+ */
+void raw_mode_session_stream_release(uint8_t session);
+
+/**
+ * Get the next segment from any session, round robin
+ * For a transport with one bulk IN engine shared by the sessions' stream
+ * endpoints: sessions with data waiting take turns a chunk at a time.
+ * The segment goes out on RAW_SESSION_EP_FLUX(*session) and is released
+ * with raw_mode_session_stream_release(*session).
+ * @param session On exit: session the segment belongs to
+ * @return 1 if a segment is ready, 0 if none yet, -1 on error
+ */
+int raw_mode_stream_next(uint8_t *session, const uint8_t **data, uint32_t *len);
+
+/**
+ * Check if a BATCH is running or its closing frame is still pending
+ * @return true while a batch is in progress
+ */
+bool raw_mode_batch_active(void);
+
+/**
+ * Check if an IMAGE job is running or its closing frame is still pending
+ * @return true while the job is in progress
+ */
+bool raw_mode_image_active(void);
+
+/**
+ * Check if a TAPE_READ job is running or its closing frame is still pending
+ * @return true while the job is in progress
+ */
+bool raw_mode_tape_active(void);
+
+/**
+ * Check if a READ_FLUX stream is open
+ * @return true while streaming (including the drain after capture stop)
+ */
+bool raw_mode_is_streaming(void);
+
 /*---------------------------------------------------------------------------
  * Flux Data Processing
  *---------------------------------------------------------------------------*/
@@ -166,6 +300,16 @@ void raw_mode_process_flux(uint32_t flux_word);
  */
 void raw_mode_get_state(raw_mode_state_t *state);
 
+/**
+ * Get one session's state and capture statistics
+ * @param session Session (0 to RAW_SESSIONS-1)
+ * @param state State structure to fill, or NULL
+ * @param info Capture info to fill, or NULL
+ * @return 0 on success, -1 for a bad session
+ */
+int raw_mode_session_get_state(uint8_t session, raw_mode_state_t *state,
+                               raw_capture_info_t *info);
+
 /**
  * Get currently selected drive
  * @return Drive number (0-3)
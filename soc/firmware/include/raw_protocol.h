@@ -22,6 +22,23 @@
 #define RAW_CMD_PACKET_SIZE     16          /* 16 bytes = 4 words */
 #define RAW_RSP_HEADER_SIZE     8           /* Minimum response size */
 
+/*---------------------------------------------------------------------------
+ * Sessions
+ *
+ * Each bulk endpoint set carries its own raw session, with its own drive
+ * selection, capture statistics and READ_FLUX stream. A stream runs on
+ * the DMA channel of its drive's flux interface, so FDD A and FDD B can
+ * stream at the same time while the other session works with an HDD.
+ * While one session is capturing from a drive, SELECT_DRIVE, SEEK,
+ * MOTOR_CTRL and READ_FLUX for that drive from another session answer
+ * RAW_RSP_ERR_BUSY. IMAGE, TAPE_READ, BATCH and TRACE_DUMP are accepted on
+ * session 0 only.
+ *---------------------------------------------------------------------------*/
+
+#define RAW_SESSIONS            2
+#define RAW_SESSION_EP_CMD(s)   ((s) == 0 ? 1 : 4)  /* Bulk OUT commands, IN responses */
+#define RAW_SESSION_EP_FLUX(s)  ((s) == 0 ? 2 : 5)  /* Bulk IN stream */
+
 /*---------------------------------------------------------------------------
  * Command Opcodes
  *---------------------------------------------------------------------------*/
@@ -34,10 +51,14 @@
 #define RAW_CMD_CAPTURE_START       0x10    /* Begin flux capture */
 #define RAW_CMD_CAPTURE_STOP        0x11    /* End flux capture */
 #define RAW_CMD_READ_FLUX           0x13    /* Stream flux data */
+#define RAW_CMD_IMAGE               0x14    /* Capture a track range */
+#define RAW_CMD_TAPE_READ           0x15    /* Stream a QIC-117 tape */
 #define RAW_CMD_READ_TRACK_RAW      0x20    /* Read track with metadata */
 #define RAW_CMD_GET_PLL_STATUS      0x30    /* PLL diagnostics */
 #define RAW_CMD_GET_SIGNAL_QUAL     0x31    /* Signal quality metrics */
 #define RAW_CMD_GET_DRIVE_PROFILE   0x40    /* Detected drive parameters */
+#define RAW_CMD_BATCH               0x50    /* Run queued sub-commands */
+#define RAW_CMD_TRACE_DUMP          0x60    /* Export the debug trace buffer */
 
 /*---------------------------------------------------------------------------
  * Response Codes
@@ -51,6 +72,7 @@
 #define RAW_RSP_ERR_OVERFLOW        0x05    /* Buffer overflow */
 #define RAW_RSP_ERR_TIMEOUT         0x06    /* Operation timeout */
 #define RAW_RSP_ERR_BUSY            0x07    /* Device busy */
+#define RAW_RSP_ERR_CRC             0x08    /* Sector data CRC error */
 
 /*---------------------------------------------------------------------------
  * Flux Data Format (32-bit per transition)
@@ -61,6 +83,167 @@
 #define FLUX_FLAG_WEAK          (1 << 29)   /* Weak bit detected */
 #define FLUX_TIMESTAMP_MASK     0x07FFFFFF  /* 27-bit timestamp (~5ns @ 200MHz) */
 
+/*---------------------------------------------------------------------------
+ * READ_FLUX Streaming
+ *
+ * READ_FLUX (param1 = revolutions, 0 = default; param2 = RAW_FLUX_FMT_*;
+ * param3 = max samples, 0 = RAW_MAX_FLUX_SAMPLES) starts a capture on the
+ * selected FDD and is answered with a plain header. Flux then follows on the bulk IN pipe as
+ * chunks of at most RAW_FLUX_CHUNK_SIZE bytes, each a raw_rsp_header_t
+ * (opcode READ_FLUX, data_len = payload bytes) followed by flux words.
+ * Chunks end at index pulses, so a chunk never spans two revolutions.
+ * The stream is closed by a CAPTURE_STOP header carrying
+ * raw_capture_info_t; its status is RAW_RSP_ERR_OVERFLOW if the capture
+ * FIFO overflowed while both chunks were waiting for the host.
+ *---------------------------------------------------------------------------*/
+
+#define RAW_FLUX_CHUNK_SIZE     (32 * 1024) /* Header + payload per chunk */
+
+/*
+ * Chunk payload formats (READ_FLUX param2). Supported formats are
+ * advertised as RAW_FLUX_CAP_* bits in raw_info_data_t.flux_formats.
+ *
+ * RAW_FLUX_FMT_DELTA: each flux word becomes an unsigned LEB128 varint
+ * token (7 bits per byte, low group first, bit 7 = more):
+ *   token & 1 == 0   transition, delta = token >> 1
+ *   token & 1 == 1   escape, flags = token >> 1 (RAW_FLUX_ESC_*), then a
+ *                    varint delta for the flagged word
+ * Deltas are timestamp differences mod 2^27 from the previous word. The
+ * predictor restarts at 0 in every chunk, so chunks decode independently.
+ * At 200 MHz a DD/HD interval takes two bytes instead of four.
+ *
+ * RAW_FLUX_FMT_KRYOFLUX: KryoFlux stream (kf_stream.h). Unlike DELTA the
+ * encoder runs across chunks: the payloads of one READ_FLUX, in order,
+ * are a complete DTC stream file. Each chunk opens with a STREAM_INFO
+ * block; index marks become INDEX blocks; one extra chunk before the
+ * CAPTURE_STOP frame carries STREAM_END and EOF.
+ */
+#define RAW_FLUX_FMT_RAW32      0           /* 32-bit flux words */
+#define RAW_FLUX_FMT_DELTA      1           /* Delta + varint */
+#define RAW_FLUX_FMT_KRYOFLUX   2           /* KryoFlux stream */
+
+#define RAW_FLUX_CAP_RAW32      (1 << RAW_FLUX_FMT_RAW32)
+#define RAW_FLUX_CAP_DELTA      (1 << RAW_FLUX_FMT_DELTA)
+#define RAW_FLUX_CAP_KRYOFLUX   (1 << RAW_FLUX_FMT_KRYOFLUX)
+
+#define RAW_FLUX_ESC_INDEX      (1 << 0)    /* Word is an INDEX marker */
+#define RAW_FLUX_ESC_OVERFLOW   (1 << 1)    /* FLUX_FLAG_OVERFLOW */
+#define RAW_FLUX_ESC_WEAK       (1 << 2)    /* FLUX_FLAG_WEAK */
+
+/*---------------------------------------------------------------------------
+ * BATCH
+ *
+ * BATCH (param1 = RAW_BATCH_*, param2 = N) is followed in the same bulk
+ * OUT transfer by N ordinary command packets; a transfer too short to
+ * hold them is rejected with RAW_RSP_ERR_INVALID_PARAM. It is acknowledged
+ * with a plain header, then firmware runs the sub-commands back to back. Any
+ * READ_FLUX in the batch streams its chunks as usual before the next
+ * sub-command runs. A single BATCH frame closes the batch: its data is
+ * every sub-command response (header + data) concatenated in order, and
+ * its status is that of the first failing sub-command (RAW_RSP_OK if
+ * none). Batches do not nest.
+ *---------------------------------------------------------------------------*/
+
+#define RAW_BATCH_MAX_CMDS      1024        /* Sub-commands per batch */
+#define RAW_BATCH_STOP_ON_ERROR (1 << 0)    /* Skip the rest after a failure */
+
+/*---------------------------------------------------------------------------
+ * IMAGE
+ *
+ * IMAGE captures a range of tracks on the selected FDD without host
+ * round trips:
+ *   param1  revolutions per track (0 = default)
+ *   param2  first track (bits 7:0), last track (bits 15:8)
+ *   param3  head mask (bits 1:0, 0 = head 0 only), RAW_IMAGE_SECTORS
+ *           (bit 2), retries (bits 15:8), RAW_FLUX_FMT_* (bits 23:16)
+ *   param4  max samples per track (0 = RAW_MAX_FLUX_SAMPLES)
+ * It is acknowledged with a plain header. Every capture attempt is then
+ * announced by an IMAGE frame carrying raw_image_track_t and followed by
+ * a READ_FLUX stream (chunks + CAPTURE_STOP trailer). An attempt whose
+ * FIFO overflowed is repeated up to "retries" times; a track that could
+ * not be reached gets an IMAGE frame with an error status and no stream.
+ * The seek to the next track runs while the previous track drains, and
+ * each capture starts on the first index after head settle. A final
+ * IMAGE frame carrying raw_image_done_t closes the job; its status is
+ * that of the first failed track. CAPTURE_STOP ends the job early.
+ *
+ * With RAW_IMAGE_SECTORS the FDC also reads the track side's 512-byte
+ * sectors during the revolution being captured, and each attempt's
+ * stream is followed by an IMAGE frame carrying raw_image_sectors_t and
+ * the sector data (R = 1 first). Sectors flagged in bad_mask failed CRC
+ * or were not found, and the frame's status is then RAW_RSP_ERR_CRC
+ * (RAW_RSP_ERR_NOT_READY with no sectors if the read could not be
+ * started). Note that "retries" here still only covers overflows; a host
+ * building a sector image only needs to run
+ * flux recovery on the streams of tracks with bad sectors.
+ *---------------------------------------------------------------------------*/
+
+#define RAW_IMAGE_HEAD0         (1 << 0)
+#define RAW_IMAGE_HEAD1         (1 << 1)
+#define RAW_IMAGE_SECTORS       (1 << 2)    /* Read sectors alongside the flux */
+
+#define RAW_IMAGE_FRAME_TRACK   0           /* raw_image_track_t */
+#define RAW_IMAGE_FRAME_DONE    1           /* raw_image_done_t */
+#define RAW_IMAGE_FRAME_SECTORS 2           /* raw_image_sectors_t + data */
+#define RAW_IMAGE_MAX_SECTORS   64          /* bad_mask width */
+
+/*---------------------------------------------------------------------------
+ * TAPE_READ
+ *
+ * TAPE_READ images a QIC-117 tape on the selected FDD interface in one
+ * continuous pass:
+ *   param1  tape unit (0 = unit 1)
+ *   param2  RAW_TAPE_* flags
+ *   param3  segments to read (0 = until the tape stops at the end)
+ * It is acknowledged with a plain header. Every tape segment then comes
+ * as one TAPE_READ frame carrying raw_tape_segment_t followed by
+ * "blocks" records of RAW_TAPE_RECORD_SIZE bytes: the 516 block bytes
+ * as read (header, 512 data, 3 ECC) and a 32-bit status word
+ * (RAW_TAPE_REC_*). Its status is RAW_RSP_ERR_CRC if any block failed
+ * the ECC check. Correction is left to the host; the check only
+ * computes the syndrome.
+ *
+ * Segments go from the capture DMA to the host with no copy, so the tape
+ * keeps streaming as long as the host drains them. If the host falls
+ * behind and the DDR ring fills, the drive is paused, backed up and
+ * restarted once half the ring is free; segments read twice are dropped,
+ * so the frames stay in tape order with no duplicates. A final TAPE_READ
+ * frame carrying raw_tape_done_t closes the job; its status is that of
+ * the first failure. CAPTURE_STOP ends the job early.
+ *---------------------------------------------------------------------------*/
+
+#define RAW_TAPE_REWIND         (1 << 0)    /* Seek to BOT first */
+
+#define RAW_TAPE_FRAME_SEGMENT  0           /* raw_tape_segment_t + records */
+#define RAW_TAPE_FRAME_DONE     1           /* raw_tape_done_t */
+
+#define RAW_TAPE_SEG_GAP        (1 << 0)    /* Blocks were lost in this segment */
+
+#define RAW_TAPE_RECORD_SIZE    520         /* Block bytes + status word */
+#define RAW_TAPE_REC_ECC        (1 << 10)   /* Non-zero syndrome */
+#define RAW_TAPE_REC_GAP        (1 << 9)    /* Blocks lost before this one */
+
+/*---------------------------------------------------------------------------
+ * TRACE_DUMP
+ *
+ * TRACE_DUMP exports the debug trace buffer (trace_buffer.v) in one go.
+ * It is acknowledged with a plain header; a single TRACE_DUMP frame then
+ * carries raw_trace_info_t followed by "count" raw_trace_entry_t, oldest
+ * first, read out by the debug port block engine with no per-entry CPU
+ * work. Capture keeps running during the dump; stop it first for a
+ * consistent snapshot. Timestamps are the buffer's 16-bit cycle counter
+ * at clock_hz and wrap; a host unwraps them by assuming less than one
+ * wrap between neighbouring entries (tools/devloop/trace_codec.py, which
+ * also converts a dump to VCD). The dump is refused with
+ * RAW_RSP_ERR_BUSY while a stream, batch, IMAGE or TAPE_READ job is
+ * running.
+ *---------------------------------------------------------------------------*/
+
+#define RAW_TRACE_MAGIC         0x52545246  /* "FRTR" */
+#define RAW_TRACE_VERSION       1
+#define RAW_TRACE_WRAPPED       (1 << 0)    /* Older entries were overwritten */
+#define RAW_TRACE_TRIGGERED     (1 << 1)    /* trigger_pos is valid */
+
 /*---------------------------------------------------------------------------
  * Data Structures
  *---------------------------------------------------------------------------*/
@@ -97,7 +280,7 @@ typedef struct __attribute__((packed)) {
     uint8_t     max_luns;       /* Maximum LUNs supported */
     uint8_t     max_fdds;       /* Maximum FDD drives */
     uint8_t     max_hdds;       /* Maximum HDD drives */
-    uint8_t     reserved1;
+    uint8_t     flux_formats;   /* RAW_FLUX_CAP_* supported by READ_FLUX */
     uint8_t     status_flags;   /* Bit flags for device status */
     uint8_t     reserved2[3];
     uint8_t     selected_drive; /* Currently selected drive */
@@ -175,6 +358,87 @@ typedef struct __attribute__((packed)) {
     uint32_t    duration_us;    /* Capture duration in microseconds */
 } raw_capture_info_t;
 
+/**
+ * IMAGE per-attempt frame (4 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t     kind;           /* RAW_IMAGE_FRAME_TRACK */
+    uint8_t     track;          /* Cylinder */
+    uint8_t     head;           /* Head (0-1) */
+    uint8_t     attempt;        /* 0 = first try */
+} raw_image_track_t;
+
+/**
+ * IMAGE closing frame (8 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t     kind;           /* RAW_IMAGE_FRAME_DONE */
+    uint8_t     reserved;
+    uint16_t    tracks_ok;      /* Track sides captured cleanly */
+    uint16_t    tracks_failed;  /* Track sides given up on */
+    uint16_t    retries;        /* Extra attempts used */
+} raw_image_done_t;
+
+/**
+ * IMAGE sector frame (12 bytes), followed by sectors * 512 bytes
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t     kind;           /* RAW_IMAGE_FRAME_SECTORS */
+    uint8_t     track;          /* Cylinder */
+    uint8_t     head;           /* Head (0-1) */
+    uint8_t     sectors;        /* Sectors per track side */
+    uint64_t    bad_mask;       /* Bit n: sector n+1 failed or missing */
+} raw_image_sectors_t;
+
+/**
+ * TAPE_READ segment frame (8 bytes), followed by blocks * RAW_TAPE_RECORD_SIZE
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t     kind;           /* RAW_TAPE_FRAME_SEGMENT */
+    uint8_t     track;          /* Tape track */
+    uint16_t    segment;        /* Segment on the track */
+    uint8_t     blocks;         /* Records that follow */
+    uint8_t     ecc_errors;     /* Records with RAW_TAPE_REC_ECC */
+    uint8_t     flags;          /* RAW_TAPE_SEG_* */
+    uint8_t     reserved;
+} raw_tape_segment_t;
+
+/**
+ * TAPE_READ closing frame (16 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t     kind;           /* RAW_TAPE_FRAME_DONE */
+    uint8_t     reserved;
+    uint16_t    repositions;    /* Times the drive was stopped and backed up */
+    uint32_t    segments;       /* Segment frames sent */
+    uint32_t    blocks;         /* Records sent */
+    uint16_t    ecc_errors;     /* Records with RAW_TAPE_REC_ECC */
+    uint16_t    gaps;           /* Segments with RAW_TAPE_SEG_GAP */
+} raw_tape_done_t;
+
+/**
+ * TRACE_DUMP frame header (16 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t    magic;          /* RAW_TRACE_MAGIC */
+    uint8_t     version;        /* RAW_TRACE_VERSION */
+    uint8_t     flags;          /* RAW_TRACE_* */
+    uint16_t    count;          /* Entries that follow */
+    uint16_t    trigger_pos;    /* Entry the trigger fired on */
+    uint16_t    entry_size;     /* sizeof(raw_trace_entry_t) */
+    uint32_t    clock_hz;       /* Timestamp clock */
+} raw_trace_info_t;
+
+/**
+ * TRACE_DUMP entry (8 bytes; the buffer's own 64-bit entry layout)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t    data;           /* Event data */
+    uint8_t     source;         /* trace_source_t */
+    uint8_t     type;           /* trace_event_t */
+    uint16_t    timestamp;      /* Cycle counter, wraps */
+} raw_trace_entry_t;
+
 /*---------------------------------------------------------------------------
  * Utility Macros
  *---------------------------------------------------------------------------*/
@@ -0,0 +1,124 @@
+/**
+ * FluxRipper SoC - Single-Producer/Single-Consumer Ring Buffer
+ *
+ * Fixed-size elements in caller-provided storage. Capacity is a power of
+ * two; head and tail run freely and are masked on access, so count is
+ * head - tail with no modulo and no wasted slot. The producer only writes
+ * head and the consumer only writes tail, so one side may run in an
+ * interrupt handler without locking (single hart: a compiler barrier
+ * orders the element copy against the index update).
+ *
+ * A push into a full ring fails and is counted in 'dropped'; nothing is
+ * overwritten.
+ *
+ * Updated: 2025-12-08 16:00
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+    uint8_t             *data;          /* capacity * elem_size bytes */
+    uint32_t            elem_size;
+    uint32_t            mask;           /* capacity - 1 */
+    volatile uint32_t   head;           /* Producer: next slot to fill */
+    volatile uint32_t   tail;           /* Consumer: oldest element */
+    volatile uint32_t   dropped;        /* Pushes refused while full */
+} ring_t;
+
+/**
+ * Set up a ring over caller storage
+ * @param r ring
+ * @param storage capacity * elem_size bytes
+ * @param elem_size element size in bytes
+ * @param capacity number of elements, a power of two
+ * @return 0 on success, -1 if capacity is not a power of two
+ */
+int ring_init(ring_t *r, void *storage, uint32_t elem_size, uint32_t capacity);
+
+/**
+ * Empty the ring and clear the drop count (neither side may be running)
+ */
+void ring_reset(ring_t *r);
+
+static inline uint32_t ring_capacity(const ring_t *r)
+{
+    return r->mask + 1;
+}
+
+static inline uint32_t ring_count(const ring_t *r)
+{
+    return r->head - r->tail;
+}
+
+static inline uint32_t ring_space(const ring_t *r)
+{
+    return ring_capacity(r) - ring_count(r);
+}
+
+static inline bool ring_empty(const ring_t *r)
+{
+    return r->head == r->tail;
+}
+
+/*---------------------------------------------------------------------------
+ * Producer side
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Copy one element in
+ * @return true if stored, false if the ring was full (counted as dropped)
+ */
+bool ring_push(ring_t *r, const void *elem);
+
+/**
+ * Copy up to n elements in, oldest first
+ * Elements that do not fit are counted as dropped.
+ * @return number stored
+ */
+uint32_t ring_push_batch(ring_t *r, const void *elems, uint32_t n);
+
+/**
+ * Slot the next push will fill, for building an element in place
+ * @return slot, or NULL if the ring is full (counted as dropped)
+ */
+void *ring_claim(ring_t *r);
+
+/**
+ * Publish the slot returned by ring_claim()
+ */
+void ring_commit(ring_t *r);
+
+/*---------------------------------------------------------------------------
+ * Consumer side
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Copy one element out
+ * @return true if an element was removed
+ */
+bool ring_pop(ring_t *r, void *elem);
+
+/**
+ * Copy up to max elements out, oldest first
+ * @return number removed
+ */
+uint32_t ring_pop_batch(ring_t *r, void *elems, uint32_t max);
+
+/**
+ * Look at a queued element without removing it
+ * @param index 0 = oldest
+ * @return element, or NULL if fewer than index + 1 are queued
+ */
+const void *ring_peek(const ring_t *r, uint32_t index);
+
+/**
+ * Remove the n oldest elements (after ring_peek())
+ */
+void ring_consume(ring_t *r, uint32_t n);
+
+#endif /* RING_H */
@@ -29,6 +29,13 @@
 #define SCSI_READ_10                0x28
 #define SCSI_WRITE_10               0x2A
 #define SCSI_VERIFY_10              0x2F
+#define SCSI_SYNCHRONIZE_CACHE_10   0x35
+#define SCSI_READ_16                0x88
+#define SCSI_WRITE_16               0x8A
+#define SCSI_SERVICE_ACTION_IN_16   0x9E
+
+/* SERVICE ACTION IN (16) service actions */
+#define SCSI_SA_READ_CAPACITY_16    0x10
 
 /*---------------------------------------------------------------------------
  * SCSI Sense Keys
@@ -57,6 +64,8 @@
 #define ASC_NOT_READY_TO_READY      0x28
 #define ASC_MEDIUM_NOT_PRESENT      0x3A
 #define ASC_WRITE_PROTECTED         0x27
+#define ASC_WRITE_ERROR             0x0C
+#define ASC_UNRECOVERED_READ_ERROR  0x11
 
 /*---------------------------------------------------------------------------
  * Additional Sense Code Qualifiers (ASCQ)
@@ -74,6 +83,7 @@
 #define SCSI_INQUIRY_RESPONSE_LEN   36
 #define SCSI_SENSE_RESPONSE_LEN     18
 #define SCSI_READ_CAPACITY_LEN      8
+#define SCSI_READ_CAPACITY_16_LEN   32
 #define SCSI_MODE_SENSE_6_LEN       4
 #define SCSI_FORMAT_CAPACITY_LEN    12
 
@@ -123,7 +133,9 @@ typedef struct {
     uint8_t     last_sense_key;     /* Last sense key */
     uint8_t     last_asc;           /* Last ASC */
     uint8_t     last_ascq;          /* Last ASCQ */
-    bool        unit_attention[4];  /* Unit attention pending per LUN */
+    volatile bool unit_attention[4]; /* Unit attention pending per LUN (set from ISR) */
+    uint32_t    next_lba[4];        /* LBA following the last READ per LUN */
+    uint8_t     seq_run[4];         /* Back-to-back sequential READs per LUN */
 } scsi_handler_state_t;
 
 /**
@@ -133,6 +145,7 @@ typedef struct {
     int         status;             /* 0 = success, non-zero = error */
     uint32_t    data_len;           /* Response data length (if any) */
     bool        data_in;            /* true = data to host, false = data from host */
+    bool        streamed;           /* Data phase runs through scsi_xfer_*() */
 } scsi_result_t;
 
 /*---------------------------------------------------------------------------
@@ -219,23 +232,112 @@ int scsi_cmd_read_format_capacities(uint8_t lun, uint8_t *buf,
 int scsi_cmd_read_capacity_10(uint8_t lun, uint8_t *buf, uint32_t *len,
                               scsi_result_t *result);
 
+/**
+ * Handle READ CAPACITY (16) command (SERVICE ACTION IN)
+ */
+int scsi_cmd_read_capacity_16(uint8_t lun, const uint8_t *cdb, uint8_t *buf,
+                              uint32_t *len, scsi_result_t *result);
+
 /**
  * Handle READ (10) command
+ * *len is the buffer size on entry. A transfer that does not fit is
+ * streamed (result->streamed) instead of read into buf.
  */
 int scsi_cmd_read_10(uint8_t lun, const uint8_t *cdb, uint8_t *buf,
                      uint32_t *len, scsi_result_t *result);
 
 /**
  * Handle WRITE (10) command
+ * len is the data already in buf; if it is less than the transfer, the
+ * data is streamed in through scsi_xfer_out_get() instead.
  */
 int scsi_cmd_write_10(uint8_t lun, const uint8_t *cdb, const uint8_t *buf,
                       uint32_t len, scsi_result_t *result);
 
+/**
+ * Handle READ (16) command
+ */
+int scsi_cmd_read_16(uint8_t lun, const uint8_t *cdb, uint8_t *buf,
+                     uint32_t *len, scsi_result_t *result);
+
+/**
+ * Handle WRITE (16) command
+ */
+int scsi_cmd_write_16(uint8_t lun, const uint8_t *cdb, const uint8_t *buf,
+                      uint32_t len, scsi_result_t *result);
+
 /**
  * Handle VERIFY (10) command
+ * Media verification only (BYTCHK 0): the range is read with CRC checks
+ * in the drive decoder and no data moves. A bad sector reports MEDIUM
+ * ERROR with its LBA in the sense information field.
  */
 int scsi_cmd_verify_10(uint8_t lun, const uint8_t *cdb, scsi_result_t *result);
 
+/**
+ * Handle SYNCHRONIZE CACHE (10) command
+ * Flushes the whole LUN; the LBA range in the CDB is ignored.
+ */
+int scsi_cmd_synchronize_cache_10(uint8_t lun, const uint8_t *cdb, scsi_result_t *result);
+
+/*---------------------------------------------------------------------------
+ * Streamed Data Phase
+ *
+ * READ/WRITE transfers larger than the transport's buffer move through a
+ * ring of 16KB chunks in HyperRAM. For data-in the handler
+ * reads chunks ahead while the transport sends them; for data-out the
+ * transport fills chunks and the handler writes them behind. Call
+ * scsi_xfer_finish() after the last chunk for the command status.
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Check for a streamed transfer in progress
+ */
+bool scsi_xfer_active(void);
+
+/**
+ * Get the next chunk to send to the host
+ * @param len Receives the chunk length in bytes
+ * @return Chunk data, or NULL if none is ready or the data phase has ended
+ */
+const uint8_t *scsi_xfer_in_get(uint32_t *len);
+
+/**
+ * Hand back the chunk from scsi_xfer_in_get() once it has been sent
+ */
+void scsi_xfer_in_release(void);
+
+/**
+ * Get the next free chunk to receive host data into
+ * @param len Receives the number of bytes expected in the chunk
+ * @return Chunk buffer, or NULL if the ring is full or all data is in
+ */
+uint8_t *scsi_xfer_out_get(uint32_t *len);
+
+/**
+ * Queue the chunk from scsi_xfer_out_get() for writing once it is full
+ */
+void scsi_xfer_out_commit(void);
+
+/**
+ * Advance the media side: read or write at most one chunk
+ */
+void scsi_xfer_poll(void);
+
+/**
+ * Complete a streamed transfer
+ * Writes any queued data-out chunks, then fills in the final status and
+ * the number of bytes actually moved.
+ * @param result Command result; data_len is the byte count for the residue
+ * @return 0 on success, -1 if the transfer failed (sense data set)
+ */
+int scsi_xfer_finish(scsi_result_t *result);
+
+/**
+ * Abandon a streamed transfer (bus reset, BOT reset recovery)
+ */
+void scsi_xfer_abort(void);
+
 /*---------------------------------------------------------------------------
  * Sense Data Management
  *---------------------------------------------------------------------------*/
@@ -265,6 +367,7 @@ int scsi_build_sense_response(uint8_t lun, uint8_t *buf);
 
 /**
  * Set unit attention condition
+ * Safe from interrupt context (media change).
  * @param lun Logical Unit Number
  * @param asc Additional Sense Code for unit attention
  * @param ascq Additional Sense Code Qualifier
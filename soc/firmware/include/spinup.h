@@ -0,0 +1,124 @@
+/**
+ * FluxRipper Drive Spin-Up Scheduler
+ *
+ * Brings drives up through their connectors without overrunning the
+ * input supply. Each pending connector is admitted once
+ * pwr_budget_check() accepts its running load and the remaining budget
+ * also covers its spin-up surge on top of the surges already in flight;
+ * as motors reach speed their surge is released and the next drives
+ * start. As many drives as the budget allows spin up in parallel.
+ *
+ * The margin held back depends on the source: a USB-C PD contract is a
+ * hard limit (the source drops out when exceeded), an ATX supply rides
+ * through short overloads. With no source reported (PMU absent) the
+ * scheduler falls back to one drive at a time.
+ *
+ * FDD connectors 0-1 carry FDC drives A/B and start their motor after
+ * power-up; the other FDD connectors only switch power. HDD spindles
+ * start with connector power and are up once the drive reports ready.
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-09 23:00
+ */
+
+#ifndef SPINUP_H
+#define SPINUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "power_hal.h"
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+/* Spin-up surge estimates (mW, worst case per drive class) */
+#define SPINUP_FDD_SURGE_MW     9000        /* 5.25" motor, 12V ~0.75A */
+#define SPINUP_FDD8_SURGE_MW    36000       /* 8" on FDD3, 24V ~1.5A */
+#define SPINUP_HDD_SURGE_MW     48000       /* ST-506/ESDI spindle, 12V ~4A */
+
+/* How long the surge lasts (FDC drives use hal_motor_at_speed()) */
+#define SPINUP_FDD_SURGE_MS     500         /* Matches TIMEOUT_MOTOR */
+#define SPINUP_HDD_SURGE_MS     15000       /* Spindle at speed by then */
+
+/* Default spinup_wait() bound for a full batch */
+#define SPINUP_WAIT_MS          60000
+
+/* An HDD connector drawing under PMU_CONN_PRESENT_MW this long is empty */
+#define SPINUP_SENSE_MS         1000
+
+/* Budget held back from the surge headroom, by source (percent) */
+#define SPINUP_MARGIN_USBC_PCT  20
+#define SPINUP_MARGIN_ATX_PCT   10
+
+/* Connector bitmask helpers */
+#define SPINUP_MASK(conn)       (1u << (conn))
+#define SPINUP_MASK_ALL         ((1u << PWR_CONN_COUNT) - 1)
+
+/*============================================================================
+ * Data Structures
+ *============================================================================*/
+
+typedef enum {
+    SPINUP_IDLE = 0,            /* Not requested */
+    SPINUP_PENDING,             /* Waiting for budget */
+    SPINUP_SURGE,               /* Powered, motor coming up to speed */
+    SPINUP_UP,                  /* At speed (or nothing attached) */
+    SPINUP_FAILED               /* Connector fault or over budget */
+} spinup_state_t;
+
+typedef struct {
+    uint32_t    started;        /* Drives admitted */
+    uint32_t    peak_parallel;  /* Most surges in flight at once */
+    uint32_t    deferred;       /* Polls that held a drive back for budget */
+    uint32_t    failed;         /* Faults and permanent budget refusals */
+    uint32_t    last_batch_ms;  /* Request to all-up, last spinup_wait() */
+} spinup_stats_t;
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+/**
+ * Queue connectors for spin-up
+ * Connectors already up (or already queued) are left as they are.
+ * @param mask SPINUP_MASK() bits of the connectors
+ */
+void spinup_request(uint32_t mask);
+
+/**
+ * Advance the scheduler: retire finished surges, admit pending drives
+ * Cheap when nothing is pending; safe to call from a wait's check.
+ */
+void spinup_poll(void);
+
+/**
+ * Spin up connectors and wait for all of them
+ * @param mask SPINUP_MASK() bits of the connectors
+ * @param timeout_ms give up after this long
+ * @return HAL_OK once all are up, HAL_ERR_HARDWARE if any failed,
+ *         HAL_ERR_TIMEOUT otherwise
+ */
+int spinup_wait(uint32_t mask, uint32_t timeout_ms);
+
+/**
+ * Forget a connector's spin-up (after its power was switched off)
+ * The next request runs the full spin-up again.
+ * @param conn connector
+ */
+void spinup_release(pwr_conn_t conn);
+
+/**
+ * Get a connector's spin-up state
+ * @param conn connector
+ * @return state, SPINUP_IDLE for an invalid connector
+ */
+spinup_state_t spinup_get_state(pwr_conn_t conn);
+
+/**
+ * Get scheduler counters
+ * @param stats Output: counters since boot
+ */
+void spinup_get_stats(spinup_stats_t *stats);
+
+#endif /* SPINUP_H */
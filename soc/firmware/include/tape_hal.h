@@ -0,0 +1,186 @@
+/**
+ * FluxRipper QIC-117 Tape HAL
+ *
+ * Drives a floppy-interface tape (QIC-40/80/3010/3020) through the
+ * qic117_controller behind FDC A. In tape mode (TDR bit 7) the controller
+ * decodes STEP pulses: N pulses followed by a 100ms pause form QIC
+ * command N, as with ftape. Commands are therefore issued as relative FDC
+ * seeks of N cylinders; the drive ignores DIR.
+ *
+ * Blocks found by the data streamer go through axi_stream_tape, which
+ * checks each block's Reed-Solomon syndrome and sends one S2MM transfer
+ * per tape segment (TAPE_SEG_MAX bytes at most): the records, then a
+ * trailer word with TLAST once INDEX moves the position on.
+ *
+ * Commands are non-blocking (tape_cmd_start()/tape_cmd_poll()), so a
+ * caller can keep servicing the capture DMA while the tape is told to
+ * stop or reposition.
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-11 22:30
+ */
+
+#ifndef TAPE_HAL_H
+#define TAPE_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform.h"
+
+/*============================================================================
+ * Hardware Register Definitions (qic117_controller, interface A)
+ *============================================================================*/
+
+#define TAPE_STATUS_REG         (FDC_BASE + 0x78)   /* Status (R) */
+#define TAPE_POS_REG            (FDC_BASE + 0x7C)   /* Segment/track (R) */
+#define TAPE_DATA_STATUS_REG    (FDC_BASE + 0x98)   /* Streamer status (R) */
+#define TAPE_SEG_CTRL_REG       (FDC_BASE + 0xA0)   /* Segment capture control */
+#define TAPE_SEG_COUNT_REG      (FDC_BASE + 0xA4)   /* Segments/blocks sent (R) */
+#define TAPE_SEG_ERRORS_REG     (FDC_BASE + 0xA8)   /* Gaps/ECC errors (R) */
+
+/* TDR */
+#define TDR_TAPE_MODE           BIT(7)
+#define TDR_TAPE_SEL_MASK       0x07
+
+/* TAPE_STATUS_REG */
+#define TAPE_STAT_ERROR         BIT(23)
+#define TAPE_STAT_READY         BIT(22)
+#define TAPE_STAT_ACTIVE        BIT(21)     /* Command running or tape moving */
+#define TAPE_STAT_BYTE(x)       (((x) >> 8) & 0xFF)
+
+/* TAPE_POS_REG */
+#define TAPE_POS_TRACK(x)       (((x) >> 16) & 0x1F)
+#define TAPE_POS_SEGMENT(x)     ((x) & 0xFFFF)
+
+/* TAPE_DATA_STATUS_REG */
+#define TAPE_DATA_STREAMING     BIT(31)
+
+/* TAPE_SEG_CTRL_REG */
+#define TAPE_SEG_ENABLE         BIT(0)
+#define TAPE_SEG_CLEAR          BIT(1)      /* Write: clear counters */
+#define TAPE_SEG_ACTIVE         BIT(31)     /* Read: record staged or sending */
+
+/*============================================================================
+ * QIC-117 Commands (STEP pulse counts)
+ *============================================================================*/
+
+#define QIC_CMD_REPORT_STATUS   4
+#define QIC_CMD_PAUSE           6
+#define QIC_CMD_SEEK_BOT        8
+#define QIC_CMD_SKIP_REV_SEG    10
+#define QIC_CMD_SKIP_FWD_SEG    12
+#define QIC_CMD_LOGICAL_FWD     21
+#define QIC_CMD_LOGICAL_REV     22
+#define QIC_CMD_STOP            23
+#define QIC_CMD_MAX             47
+
+/*============================================================================
+ * Segment Capture Format (axi_stream_tape)
+ *============================================================================*/
+
+#define TAPE_BLOCK_BYTES        516         /* Header, 512 data, 3 ECC */
+#define TAPE_RECORD_BYTES       520         /* Block + status word */
+#define TAPE_BLOCKS_PER_SEG     32
+#define TAPE_SEG_MAX            (TAPE_BLOCKS_PER_SEG * TAPE_RECORD_BYTES + 4)
+
+/* Record status word (last word of a record) */
+#define TAPE_REC_SEGMENT(x)     ((x) >> 16)
+#define TAPE_REC_BLOCK(x)       (((x) >> 11) & 0x1F)
+#define TAPE_REC_ECC            BIT(10)     /* Non-zero syndrome */
+#define TAPE_REC_GAP            BIT(9)      /* Blocks dropped before this one */
+#define TAPE_REC_TRAILER        BIT(8)      /* Segment trailer word */
+#define TAPE_REC_HEADER(x)      ((x) & 0xFF)
+#define TAPE_TRL_RECORDS(x)     ((x) & 0x3F)
+
+/*============================================================================
+ * Timing
+ *============================================================================*/
+
+#define TAPE_CMD_GAP_MS         120         /* Pause after the pulses (>100ms) */
+
+/*============================================================================
+ * Data Structures
+ *============================================================================*/
+
+typedef struct {
+    uint16_t    segments;           /* Trailers sent */
+    uint16_t    blocks;             /* Records sent */
+    uint16_t    ecc_errors;         /* Records with a non-zero syndrome */
+    uint16_t    gaps;               /* Records with the gap flag */
+} tape_seg_stats_t;
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+/**
+ * Put FDC A in tape mode and select a tape unit
+ * @param drive     FDC drive whose STEP line carries the commands (0-1)
+ * @param unit      tape unit (TDR select, 0-7)
+ * @return HAL_OK, HAL_ERR_INVALID
+ */
+int tape_open(uint8_t drive, uint8_t unit);
+
+/**
+ * Stop segment capture and leave tape mode
+ */
+void tape_close(void);
+
+/**
+ * Send a QIC-117 command as STEP pulses
+ * @param cmd       command (1-QIC_CMD_MAX)
+ * @return HAL_OK, HAL_ERR_INVALID, HAL_ERR_NOT_READY if not open,
+ *         HAL_ERR_BUSY while the previous command is being sent,
+ *         or the hal_seek_start() error
+ */
+int tape_cmd_start(uint8_t cmd);
+
+/**
+ * Poll a command started by tape_cmd_start()
+ * @return HAL_ERR_BUSY until the pulses and the command gap are done,
+ *         then HAL_OK or the seek error
+ */
+int tape_cmd_poll(void);
+
+/**
+ * Controller status register
+ */
+uint32_t tape_status(void);
+
+/**
+ * Command running or tape in motion
+ */
+bool tape_busy(void);
+
+/**
+ * Tape moving in a streaming mode (logical forward/reverse)
+ */
+bool tape_streaming(void);
+
+/**
+ * Current position
+ */
+void tape_position(uint8_t *track, uint16_t *segment);
+
+/**
+ * Start segment capture
+ * @param clear     also clear the capture counters
+ */
+void tape_seg_start(bool clear);
+
+/**
+ * Stop segment capture; staged records are dropped
+ */
+void tape_seg_stop(void);
+
+/**
+ * Record staged or still being sent
+ */
+bool tape_seg_active(void);
+
+/**
+ * Get the capture counters
+ */
+void tape_seg_get_stats(tape_seg_stats_t *stats);
+
+#endif /* TAPE_HAL_H */
@@ -0,0 +1,95 @@
+/**
+ * FluxRipper SoC - Cooperative Task Scheduler
+ *
+ * Run-to-completion tasks polled from one loop. Each task does a bounded
+ * slice of work per call and returns; code that has to block (a CLI
+ * command, a driver wait) calls task_yield() so the other tasks keep
+ * running underneath it. A task is never re-entered: while it is on the
+ * stack, nested yields skip it.
+ *
+ * Tasks flagged TASK_DRIVES touch the drive HALs. Only one of them runs
+ * at a time, so a yield from inside a drive operation never starts
+ * another one on the same controller.
+ *
+ * Updated: 2025-12-08 14:00
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Task table size */
+#define TASK_MAX            8
+
+/* Task flags */
+#define TASK_DRIVES         (1 << 0)    /* Uses FDD/HDD controllers */
+
+/* Task body: one bounded slice of work */
+typedef void (*task_fn_t)(void);
+
+/* Per-task statistics */
+typedef struct {
+    const char  *name;
+    uint32_t    runs;               /* Times the body was called */
+    uint32_t    max_us;             /* Longest single call */
+    uint64_t    total_us;           /* Time in the body, nested yields included */
+} task_stats_t;
+
+/**
+ * Add a task
+ * @param name short name (for stats)
+ * @param fn task body
+ * @param period_us minimum time between calls, 0 to run on every pass
+ * @param flags TASK_* flags
+ * @return task id, or -1 if the table is full
+ */
+int task_register(const char *name, task_fn_t fn, uint32_t period_us,
+                  uint8_t flags);
+
+/**
+ * Run every task that is due once, skipping tasks already on the stack
+ * Safe to call from any task body or wait loop (not from interrupts).
+ */
+void task_yield(void);
+
+/**
+ * Scheduler main loop (never returns)
+ * Installs task_yield() as the event idle hook so driver waits keep the
+ * other tasks running.
+ */
+void task_run(void);
+
+/**
+ * Claim the drive HALs for the current context
+ * Used by contexts that are not TASK_DRIVES tasks themselves, such as a
+ * CLI command that talks to a drive. Claims nest.
+ */
+void task_drives_claim(void);
+
+/**
+ * Release a claim taken with task_drives_claim()
+ */
+void task_drives_release(void);
+
+/**
+ * Check if any context currently holds the drive HALs
+ * @return true if a drive task is running or a claim is held
+ */
+bool task_drives_busy(void);
+
+/**
+ * Get statistics for a task
+ * @param id task id
+ * @param stats output
+ * @return 0 on success, -1 if id is not registered
+ */
+int task_get_stats(int id, task_stats_t *stats);
+
+/**
+ * Get number of registered tasks
+ */
+int task_count(void);
+
+#endif /* TASK_H */
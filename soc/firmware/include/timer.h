@@ -48,4 +48,20 @@ void timer_delay_ms(uint32_t ms);
  */
 uint32_t timer_uptime_ms(void);
 
+/**
+ * Get monotonic time in microseconds
+ * Extends the 32-bit counter in software, so it must be called at least
+ * once per counter period (~42.9 s at 100 MHz); the main loop does.
+ * Safe to call from interrupt handlers.
+ * @return microseconds since timer_init()
+ */
+uint64_t timer_get_us(void);
+
+/**
+ * Get monotonic time in milliseconds
+ * Kept as its own accumulator next to timer_get_us(), so no 64-bit divide.
+ * @return milliseconds since timer_init() (wraps after ~49 days)
+ */
+uint32_t timer_get_ms(void);
+
 #endif /* TIMER_H */
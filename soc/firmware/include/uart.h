@@ -3,7 +3,14 @@
  *
  * AXI UART Lite driver for MicroBlaze V
  *
- * Updated: 2025-12-03 18:00
+ * Output goes through a TX ring refilled into the 16-byte FIFO by the
+ * UART interrupt (IRQ_UART, enabled by irq_init() in main.c), so a print returns once its text is queued rather than
+ * after it has gone out at line rate. Input is drained into an RX ring by
+ * the same interrupt. The blocking calls wait for ring space through the
+ * event idle hook (drive tasks keep running); the _nb calls drop and count
+ * whatever does not fit.
+ *
+ * Updated: 2025-12-09 19:00
  */
 
 #ifndef UART_H
@@ -12,6 +19,23 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/* Ring sizes (storage at UART_RING_BASE) */
+#define UART_TX_RING_SIZE   8192
+#define UART_RX_RING_SIZE   256
+
+/* Blocking output gives up (and drops) if the ring stays full this long */
+#define UART_TX_WAIT_MS     2000
+
+/**
+ * Ring statistics
+ */
+typedef struct {
+    uint32_t    tx_queued;      /* Bytes waiting in the TX ring */
+    uint32_t    tx_dropped;     /* Bytes lost to a full TX ring */
+    uint32_t    rx_dropped;     /* Bytes lost to a full RX ring */
+    uint32_t    rx_overruns;    /* Hardware RX FIFO overruns */
+} uart_stats_t;
+
 /**
  * Initialize UART peripheral
  * Resets TX/RX FIFOs
@@ -25,7 +49,7 @@ void uart_init(void);
 bool uart_rx_ready(void);
 
 /**
- * Check if transmit FIFO has space
+ * Check if the TX ring has space
  * @return true if can accept a byte
  */
 bool uart_tx_ready(void);
@@ -44,11 +68,18 @@ char uart_getc(void);
 bool uart_getc_nb(char *c);
 
 /**
- * Write a single character (blocking)
+ * Write a single character (blocking while the TX ring is full)
  * @param c character to send
  */
 void uart_putc(char c);
 
+/**
+ * Write a single character (non-blocking)
+ * @param c character to send
+ * @return true if queued, false if the ring was full (counted as dropped)
+ */
+bool uart_putc_nb(char c);
+
 /**
  * Write a null-terminated string
  * @param s string to send
@@ -63,6 +94,33 @@ void uart_puts(const char *s);
  */
 int uart_printf(const char *fmt, ...);
 
+/**
+ * Print formatted string without waiting for ring space
+ * Same formats as uart_printf(); characters that do not fit are dropped
+ * and counted in uart_stats_t.tx_dropped.
+ * @param fmt format string
+ * @return number of characters queued
+ */
+int uart_printf_nb(const char *fmt, ...);
+
+/**
+ * Wait until all queued output has left the transmitter
+ * (before a reset, or a long operation with interrupts masked)
+ */
+void uart_flush(void);
+
+/**
+ * UART interrupt: drain RX FIFO, refill TX FIFO
+ * Called by external_interrupt_handler() when IRQ_UART is pending.
+ */
+void uart_irq_handler(void);
+
+/**
+ * Get ring statistics
+ * @param stats filled on return
+ */
+void uart_get_stats(uart_stats_t *stats);
+
 /**
  * Read a line into buffer (with echo and backspace)
  * @param buf buffer to store line
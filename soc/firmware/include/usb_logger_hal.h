@@ -29,9 +29,17 @@
 /* Buffer size (must match RTL parameter) */
 #define USBLOG_BUFFER_SIZE    8192   /* 8KB */
 
+/* Compound trigger limits (must match RTL) */
+#define USBLOG_TRIG_SEQ_MAX   3      /* PIDs after the first */
+#define USBLOG_PRE_MAX        63     /* Pre-trigger records */
+
 /* Maximum packet payload */
 #define USBLOG_MAX_PAYLOAD    64
 
+/* Record framing in the capture buffer: header, timestamp[4], length */
+#define USBLOG_REC_HDR_SIZE   6
+#define USBLOG_REC_MAX_SIZE   (USBLOG_REC_HDR_SIZE + USBLOG_MAX_PAYLOAD + 2)
+
 /* Record types (matches RTL encoding) */
 #define USBLOG_REC_TOKEN      0
 #define USBLOG_REC_SOF        1
@@ -101,6 +109,10 @@ typedef struct {
     uint32_t trans_count;     /* Transactions captured */
     uint32_t bytes_used;      /* Bytes in buffer */
     uint32_t bytes_free;      /* Free space in buffer */
+    uint32_t drop_count;      /* Records dropped for lack of space */
+    bool     armed;           /* Waiting for the trigger */
+    bool     post_done;       /* Post-trigger window captured */
+    uint32_t trigger_time_us; /* Trigger time from capture start */
 } usblog_status_t;
 
 /**
@@ -117,10 +129,25 @@ typedef struct {
 
 /**
  * Trigger configuration
+ * Evaluated in the logger: the PID sequence must appear on consecutive
+ * packets, the payload match applies to the last packet of the sequence,
+ * and the whole condition must hit 'hits' times, each within max_gap_us
+ * of the previous one. Zeroed fields give a plain single-PID trigger.
  */
 typedef struct {
     bool     enabled;         /* Trigger enabled */
-    uint8_t  pid;             /* PID to trigger on */
+    uint8_t  pid;             /* PID to trigger on (first of the sequence) */
+    uint8_t  seq_len;         /* PIDs that must follow (0-USBLOG_TRIG_SEQ_MAX) */
+    uint8_t  seq_pid[USBLOG_TRIG_SEQ_MAX];
+    bool     skip_sof;        /* SOF packets don't break the sequence */
+    bool     match_enabled;   /* Match a payload byte on the last packet */
+    uint8_t  match_offset;    /* Byte offset after the PID */
+    uint8_t  match_value;
+    uint8_t  match_mask;      /* Bits compared */
+    uint16_t hits;            /* Condition hits needed (0 = 1) */
+    uint32_t max_gap_us;      /* Max gap between hits (0 = no limit) */
+    uint8_t  pre_records;     /* Records kept from before the trigger */
+    uint16_t post_records;    /* Records after the trigger (0 = until stopped) */
 } usblog_trigger_t;
 
 /**
@@ -159,6 +186,23 @@ typedef struct __attribute__((packed)) {
     uint16_t reserved;        /* Reserved */
 } pcap_usb2_header_t;
 
+/* Largest PCAP packet one record can produce */
+#define USBLOG_PCAP_REC_MAX   (sizeof(pcap_packet_header_t) + \
+                               sizeof(pcap_usb2_header_t) + \
+                               USBLOG_MAX_PAYLOAD + 2)
+
+/**
+ * PCAP batch writer
+ * Packets are formatted back to back into buf and handed to write_fn
+ * only when the buffer fills or on flush.
+ */
+typedef struct {
+    uint8_t  *buf;            /* Staging buffer */
+    uint32_t size;            /* Staging buffer size */
+    uint32_t used;            /* Bytes staged */
+    void     (*write_fn)(const uint8_t*, uint32_t);
+} usblog_pcap_batch_t;
+
 /*============================================================================
  * Initialization
  *============================================================================*/
@@ -175,8 +219,10 @@ int usblog_init(void);
 
 /**
  * Start capture with optional trigger
+ * While armed the logger keeps only the newest pre_records records and
+ * moves its own read pointer; read records once status.triggered is set.
  * @param trigger  Trigger configuration (NULL for immediate start)
- * @return USBLOG_OK on success
+ * @return USBLOG_OK on success, USBLOG_ERR_INVALID for a bad trigger
  */
 int usblog_start(const usblog_trigger_t *trigger);
 
@@ -247,6 +293,28 @@ uint32_t usblog_records_available(void);
  */
 int usblog_rewind(void);
 
+/**
+ * Drain raw capture bytes into memory
+ * Copies whole 32-bit words through the burst data port, so a block of
+ * records costs one bus read per four bytes. Records may be split at
+ * the end of the block; parse with usblog_parse_record().
+ *
+ * @param buf     Destination
+ * @param maxlen  Destination size in bytes
+ * @return Bytes copied (0 if the buffer is empty or not initialized)
+ */
+uint32_t usblog_drain(uint8_t *buf, uint32_t maxlen);
+
+/**
+ * Decode one record from drained bytes
+ * @param buf     Raw record bytes
+ * @param len     Bytes available at buf
+ * @param record  Output record structure
+ * @return Bytes consumed, 0 if buf holds only part of a record
+ */
+uint32_t usblog_parse_record(const uint8_t *buf, uint32_t len,
+                             usblog_record_t *record);
+
 /*============================================================================
  * PCAP Export
  *============================================================================*/
@@ -267,13 +335,116 @@ int usblog_write_pcap_header(void (*write_fn)(const uint8_t*, uint32_t));
 int usblog_write_pcap_record(const usblog_record_t *record,
                               void (*write_fn)(const uint8_t*, uint32_t));
 
+/**
+ * Start a PCAP batch
+ * @param batch     Batch state
+ * @param buf       Staging buffer (at least USBLOG_PCAP_REC_MAX bytes)
+ * @param size      Staging buffer size
+ * @param write_fn  Function to write bytes
+ * @return USBLOG_OK on success
+ */
+int usblog_pcap_batch_init(usblog_pcap_batch_t *batch, uint8_t *buf,
+                           uint32_t size,
+                           void (*write_fn)(const uint8_t*, uint32_t));
+
+/**
+ * Add a record to a PCAP batch, flushing first if it would not fit
+ * @param batch   Batch state
+ * @param record  Record to export
+ * @return USBLOG_OK on success
+ */
+int usblog_pcap_batch_add(usblog_pcap_batch_t *batch,
+                          const usblog_record_t *record);
+
+/**
+ * Write out everything staged in a PCAP batch
+ * @param batch   Batch state
+ * @return USBLOG_OK on success
+ */
+int usblog_pcap_batch_flush(usblog_pcap_batch_t *batch);
+
 /**
  * Export entire buffer as PCAP file
+ * Drains the capture in word bursts and writes packets in batches.
  * @param write_fn  Function to write bytes
  * @return Number of records exported, negative on error
  */
 int usblog_export_pcap(void (*write_fn)(const uint8_t*, uint32_t));
 
+/*============================================================================
+ * Streaming Capture
+ *
+ * The logger buffer acts only as a FIFO: usblog_stream_poll() drains it
+ * continuously and packs records into pcapng blocks in HyperRAM. The USB
+ * transport takes finished blocks with usblog_stream_get() and gives them
+ * back with usblog_stream_release() once the bulk IN transfer completes,
+ * the same contract as raw_mode_stream_get(). The first block opens with
+ * the section and interface headers; after usblog_stream_stop() the last
+ * block closes with interface statistics carrying the drop count.
+ *
+ * Record reads and PCAP export are refused while a stream is open.
+ *============================================================================*/
+
+#define USBLOG_STREAM_BLOCKS      4       /* Power of two */
+#define USBLOG_STREAM_BLOCK_SIZE  (16 * 1024)
+#define USBLOG_STREAM_FLUSH_US    100000  /* Send a part-filled block after 100ms */
+
+/**
+ * Streaming statistics
+ */
+typedef struct {
+    bool     active;          /* Stream open (including the final drain) */
+    bool     stopping;        /* Stop requested, draining */
+    uint32_t records;         /* Records packed into blocks */
+    uint32_t dropped;         /* Records the logger dropped (FIFO full) */
+    uint32_t blocks;          /* Blocks handed to the transport */
+    uint64_t bytes;           /* pcapng bytes handed to the transport */
+} usblog_stream_stats_t;
+
+/**
+ * Clear the logger and start streaming capture
+ * @param trigger  Trigger configuration (NULL for immediate start)
+ * @return USBLOG_OK on success
+ */
+int usblog_stream_start(const usblog_trigger_t *trigger);
+
+/**
+ * Stop capture; the stream closes once the FIFO has drained
+ * @return USBLOG_OK on success
+ */
+int usblog_stream_stop(void);
+
+/**
+ * Drain the logger FIFO into pcapng blocks (task body)
+ */
+void usblog_stream_poll(void);
+
+/**
+ * Get the next finished pcapng block
+ * @param data  On exit: block start (valid until released)
+ * @param len   On exit: block length in bytes
+ * @return 1 if a block is ready, 0 if none yet, negative on error
+ */
+int usblog_stream_get(const uint8_t **data, uint32_t *len);
+
+/**
+ * Release the oldest block returned by usblog_stream_get()
+ */
+void usblog_stream_release(void);
+
+/**
+ * Check if a stream is open
+ * @return true while streaming (including the drain after stop)
+ */
+bool usblog_stream_active(void);
+
+/**
+ * Get streaming statistics
+ * @param stats  Output statistics
+ * @return USBLOG_OK on success
+ */
+int usblog_stream_get_stats(usblog_stream_stats_t *stats);
+
 /*============================================================================
  * Utility Functions
  *============================================================================*/
@@ -127,6 +127,25 @@
 /* Identify command (WD1007/ESDI) */
 #define WD_CMD_IDENTIFY         0xEC    /* Identify drive */
 
+/* Block mode (WD_FEAT_MULTIPLE_SECT) */
+#define WD_CMD_READ_MULTIPLE    0xC4    /* Read, one IRQ per block */
+#define WD_CMD_SET_MULTIPLE     0xC6    /* Set sectors per block */
+#define WD_MULTIPLE_MAX         16      /* Largest block (IDENTIFY word 47) */
+
+/* FluxRipper track window (WD_FEAT_TRACK_WINDOW) */
+#define WD_CMD_LOAD_WINDOW      0xF0    /* Read sectors into the ISA window */
+#define WD_WINDOW_SECTORS       17      /* Window capacity per command */
+
+/*
+ * Window header in the track buffer metadata area, read by the option
+ * ROM through isa_track_window to detect the window and check a load
+ */
+#define WD_WINDOW_HDR_OFFSET    8704    /* After the 17 data sectors */
+#define WD_WINDOW_SIGNATURE     "FRTW"
+#define WD_WINDOW_VERSION       1
+#define WD_WINDOW_HDR_LOADED    6       /* Sectors loaded by the last command */
+#define WD_WINDOW_HDR_DRIVE     7       /* Drive, cylinder (LE), head, sector */
+
 /*============================================================================
  * Controller Variants
  *============================================================================*/
@@ -152,7 +171,8 @@ typedef enum {
     WD_FEAT_GET_DIAG        = 0x00000020u,  /* Diagnostics command */
     WD_FEAT_GET_ID          = 0x00000040u,  /* Identify command */
     WD_FEAT_ESDI            = 0x00000080u,  /* ESDI mode */
-    WD_FEAT_MULTIPLE_SECT   = 0x00000100u   /* Multi-sector transfers */
+    WD_FEAT_MULTIPLE_SECT   = 0x00000100u,  /* Multi-sector transfers */
+    WD_FEAT_TRACK_WINDOW    = 0x00000200u   /* LOAD WINDOW + ISA window */
 } wd_feature_t;
 
 /*============================================================================
@@ -240,6 +260,7 @@ typedef struct {
     uint8_t         sector_count;   /* Sector count */
     uint16_t        bytes_pending;  /* Bytes pending transfer */
     bool            irq_pending;    /* Interrupt pending */
+    uint8_t         multiple;       /* SET MULTIPLE block size, 0 = off */
 } wd_controller_state_t;
 
 /*============================================================================
@@ -347,6 +368,17 @@ void wd_write_reg(uint8_t reg, uint8_t value);
  */
 uint16_t wd_read_data(void);
 
+/**
+ * Read a run of data words (REP INSW)
+ * During READ SECTORS/MULTIPLE the words come straight from the
+ * prefilled staging buffer and DRQ stays asserted across sectors.
+ *
+ * @param buf       Destination
+ * @param words     Words requested
+ * @return Words transferred (stops at the end of the DRQ block)
+ */
+uint32_t wd_read_data_block(uint16_t *buf, uint32_t words);
+
 /**
  * Write data register (16-bit)
  *
@@ -0,0 +1,45 @@
+/**
+ * FluxRipper Board Configuration EEPROM - Implementation
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-10 15:00
+ */
+
+#include "board_eeprom.h"
+#include "fluxripper_hal.h"
+#include "power_hal.h"
+#include "timer.h"
+#include <string.h>
+
+int eeprom_read(uint16_t addr, void *buf, uint8_t len)
+{
+    uint8_t a[2] = { (uint8_t)(addr >> 8), (uint8_t)addr };
+
+    if (i2c_write(EEPROM_I2C_ADDR, a, sizeof(a)) != PMU_OK ||
+        i2c_read(EEPROM_I2C_ADDR, (uint8_t *)buf, len) != PMU_OK) {
+        return HAL_ERR_HARDWARE;
+    }
+    return HAL_OK;
+}
+
+int eeprom_write_page(uint16_t addr, const void *buf)
+{
+    uint8_t frame[2 + EEPROM_PAGE];
+    uint32_t start;
+
+    frame[0] = (uint8_t)(addr >> 8);
+    frame[1] = (uint8_t)addr;
+    memcpy(&frame[2], buf, EEPROM_PAGE);
+
+    if (i2c_write(EEPROM_I2C_ADDR, frame, sizeof(frame)) != PMU_OK) {
+        return HAL_ERR_HARDWARE;
+    }
+
+    start = timer_get_ms();
+    while (i2c_write(EEPROM_I2C_ADDR, NULL, 0) != PMU_OK) {
+        if (timer_get_ms() - start > EEPROM_WRITE_MS * 2) {
+            return HAL_ERR_TIMEOUT;
+        }
+    }
+    return HAL_OK;
+}
@@ -7,31 +7,41 @@
  */
 
 #include "cli.h"
+#include "cli_bin.h"
 #include "uart.h"
 #include "timer.h"
 #include "platform.h"
+#include "task.h"
 #include <string.h>
 
 /*============================================================================
  * Command Table
  *============================================================================*/
 
-#define MAX_COMMANDS    16
+/* Commands linked in with CLI_COMMAND() (link.ld) */
+extern const cli_cmd_t *const __cli_cmds_start[];
+extern const cli_cmd_t *const __cli_cmds_end[];
 
-static cli_cmd_t cmd_table[MAX_COMMANDS];
+/* All commands, sorted by name */
+static const cli_cmd_t *cmd_table[CLI_MAX_COMMANDS];
 static int num_commands = 0;
 
+/* Line being typed (cli_poll) */
+static char poll_line[CLI_MAX_LINE];
+static int poll_len;
+static bool poll_ready;             /* Complete line waiting to run */
+
 /* Built-in commands */
 static const cli_cmd_t builtin_commands[] = {
-    { "help",    "Show available commands",          cmd_help    },
-    { "?",       "Alias for help",                   cmd_help    },
-    { "echo",    "Echo arguments",                   cmd_echo    },
-    { "memtest", "Test memory region",               cmd_memtest },
-    { "read",    "Read memory: read <addr> [count]", cmd_read    },
-    { "write",   "Write memory: write <addr> <val>", cmd_write   },
-    { "info",    "Show system information",          cmd_info    },
-    { "reset",   "Software reset",                   cmd_reset   },
-    { NULL, NULL, NULL }
+    { "help",    "Show commands: help [cmd]",        cmd_help,    0, NULL },
+    { "?",       "Alias for help",                   cmd_help,    0, NULL },
+    { "echo",    "Echo arguments",                   cmd_echo,    0, NULL },
+    { "memtest", "Test memory region",               cmd_memtest, 0, NULL },
+    { "read",    "Read memory: read <addr> [count]", cmd_read,    0, NULL },
+    { "write",   "Write memory: write <addr> <val>", cmd_write,   0, NULL },
+    { "info",    "Show system information",          cmd_info,    0, NULL },
+    { "reset",   "Software reset",                   cmd_reset,   0, NULL },
+    { NULL, NULL, NULL, 0, NULL }
 };
 
 /*============================================================================
@@ -79,6 +89,100 @@ static uint32_t parse_num(const char *s)
     return val;
 }
 
+/* strcmp() of a length-delimited word against a command name */
+static int name_cmp(const char *word, size_t len, const char *name)
+{
+    int c = strncmp(word, name, len);
+
+    if (c != 0)
+        return c;
+    return name[len] == '\0' ? 0 : -1;
+}
+
+/* Binary search of the sorted table; returns the insert position on a miss */
+static int table_search(const char *word, size_t len, bool *found)
+{
+    int lo = 0;
+    int hi = num_commands;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        int c = name_cmp(word, len, cmd_table[mid]->name);
+
+        if (c == 0) {
+            *found = true;
+            return mid;
+        }
+        if (c < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    *found = false;
+    return lo;
+}
+
+/* Look up a command by the first word of a line (line is not modified) */
+static const cli_cmd_t *find_command(const char *line)
+{
+    const char *end;
+    bool found;
+    int i;
+
+    while (*line == ' ' || *line == '\t')
+        line++;
+
+    end = line;
+    while (*end && *end != ' ' && *end != '\t')
+        end++;
+
+    i = table_search(line, (size_t)(end - line), &found);
+    return found ? cmd_table[i] : NULL;
+}
+
+/* Subcommand tables are short and kept in help order: scan them */
+static const cli_cmd_t *find_subcommand(const cli_cmd_t *sub, const char *name)
+{
+    for (; sub->name != NULL; sub++) {
+        if (strcmp(sub->name, name) == 0)
+            return sub;
+    }
+    return NULL;
+}
+
+static void print_subcommands(const char *path, const cli_cmd_t *cmd)
+{
+    uart_printf("%s:\n", cmd->help);
+    for (const cli_cmd_t *sub = cmd->sub; sub->name != NULL; sub++) {
+        uart_printf("  %s %-12s %s\n", path, sub->name, sub->help);
+    }
+}
+
+/* Run a command, descending its subcommand tree */
+static int dispatch(const cli_cmd_t *cmd, int argc, char *argv[])
+{
+    while (cmd->sub != NULL && argc >= 2) {
+        const cli_cmd_t *sub = find_subcommand(cmd->sub, argv[1]);
+
+        if (sub == NULL) {
+            uart_printf("Unknown %s command: %s\n", argv[0], argv[1]);
+            uart_printf("Type '%s' for available commands.\n", argv[0]);
+            return -1;
+        }
+        cmd = sub;
+        argc--;
+        argv++;
+    }
+
+    if (cmd->handler != NULL)
+        return cmd->handler(argc, argv);
+
+    if (cmd->sub != NULL)
+        print_subcommands(argv[0], cmd);
+    return 0;
+}
+
 static int tokenize(char *line, char *argv[], int max_args)
 {
     int argc = 0;
@@ -115,18 +219,32 @@ void cli_init(void)
 {
     num_commands = 0;
 
-    /* Register built-in commands */
+    /* Built-in and linked commands, sorted as they go in */
     for (int i = 0; builtin_commands[i].name != NULL; i++) {
         cli_register(&builtin_commands[i]);
     }
+    for (const cli_cmd_t *const *p = __cli_cmds_start; p < __cli_cmds_end; p++) {
+        if (cli_register(*p) != 0)
+            uart_printf("cli: '%s' not registered\n", (*p)->name);
+    }
 }
 
 int cli_register(const cli_cmd_t *cmd)
 {
-    if (num_commands >= MAX_COMMANDS)
+    bool found;
+    int i;
+
+    if (num_commands >= CLI_MAX_COMMANDS)
         return -1;
 
-    cmd_table[num_commands++] = *cmd;
+    i = table_search(cmd->name, strlen(cmd->name), &found);
+    if (found)
+        return -1;
+
+    memmove(&cmd_table[i + 1], &cmd_table[i],
+            (size_t)(num_commands - i) * sizeof(cmd_table[0]));
+    cmd_table[i] = cmd;
+    num_commands++;
     return 0;
 }
 
@@ -135,38 +253,113 @@ int cli_process(char *line)
     char *argv[CLI_MAX_ARGS];
     int argc;
 
+    bool bin = false;
+
     /* Tokenize */
     argc = tokenize(line, argv, CLI_MAX_ARGS);
+
+    /* "--bin" anywhere selects the framed binary response */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], CLI_BIN_FLAG) == 0) {
+            bin = true;
+            for (int j = i; j < argc - 1; j++)
+                argv[j] = argv[j + 1];
+            argc--;
+            i--;
+        }
+    }
     if (argc == 0)
         return 0;
 
     /* Find command */
-    for (int i = 0; i < num_commands; i++) {
-        if (strcmp(argv[0], cmd_table[i].name) == 0) {
-            return cmd_table[i].handler(argc, argv);
-        }
+    const cli_cmd_t *cmd = find_command(argv[0]);
+    int ret;
+
+    if (cmd == NULL) {
+        uart_printf("Unknown command: %s\n", argv[0]);
+        uart_puts("Type 'help' for available commands.\n");
+        return -1;
     }
 
-    uart_printf("Unknown command: %s\n", argv[0]);
-    uart_puts("Type 'help' for available commands.\n");
-    return -1;
+    if (bin)
+        cli_bin_begin(argv[0]);
+
+    if (!(cmd->flags & CLI_CMD_DRIVES)) {
+        ret = dispatch(cmd, argc, argv);
+    } else {
+        /* Keep background drive tasks off the bus meanwhile */
+        task_drives_claim();
+        ret = dispatch(cmd, argc, argv);
+        task_drives_release();
+    }
+
+    if (bin)
+        cli_bin_end(ret);
+    return ret;
 }
 
-void cli_run(void)
+void cli_start(void)
 {
-    char line[CLI_MAX_LINE];
-
     uart_puts("\n");
     uart_puts("========================================\n");
     uart_puts("  FluxRipper SoC - Milestone 0\n");
     uart_puts("  MicroBlaze V @ 100 MHz\n");
     uart_puts("========================================\n");
     uart_puts("Type 'help' for available commands.\n\n");
+    uart_puts("> ");
+
+    poll_len = 0;
+    poll_ready = false;
+}
+
+void cli_poll(void)
+{
+    char c;
+
+    while (!poll_ready && uart_getc_nb(&c)) {
+        if (c == '\r' || c == '\n') {
+            uart_puts("\r\n");
+            poll_line[poll_len] = '\0';
+            poll_ready = true;
+        } else if (c == '\b' || c == 0x7F) {  /* Backspace or DEL */
+            if (poll_len > 0) {
+                poll_len--;
+                uart_puts("\b \b");
+            }
+        } else if (c == 0x03) {  /* Ctrl+C */
+            uart_puts("^C\r\n> ");
+            poll_len = 0;
+        } else if (c >= 0x20 && c < 0x7F && poll_len < CLI_MAX_LINE - 1) {
+            poll_line[poll_len++] = c;
+            uart_putc(c);  /* Echo */
+        }
+    }
+
+    if (!poll_ready)
+        return;
+
+    /* A drive command waits for background drive work to finish */
+    const cli_cmd_t *cmd = find_command(poll_line);
+    if (cmd != NULL && (cmd->flags & CLI_CMD_DRIVES) && task_drives_busy())
+        return;
+
+    cli_process(poll_line);
+
+    poll_len = 0;
+    poll_ready = false;
+    uart_puts("> ");
+}
+
+void cli_run(void)
+{
+    char line[CLI_MAX_LINE];
+
+    cli_start();
 
     while (1) {
-        uart_puts("> ");
         uart_readline(line, sizeof(line));
         cli_process(line);
+        uart_puts("> ");
     }
 }
 
@@ -176,12 +369,23 @@ void cli_run(void)
 
 int cmd_help(int argc, char *argv[])
 {
-    (void)argc;
-    (void)argv;
+    if (argc >= 2) {
+        const cli_cmd_t *cmd = find_command(argv[1]);
+
+        if (cmd == NULL) {
+            uart_printf("Unknown command: %s\n", argv[1]);
+            return -1;
+        }
+        if (cmd->sub != NULL)
+            print_subcommands(cmd->name, cmd);
+        else
+            uart_printf("  %-10s %s\n", cmd->name, cmd->help);
+        return 0;
+    }
 
     uart_puts("Available commands:\n");
     for (int i = 0; i < num_commands; i++) {
-        uart_printf("  %-10s %s\n", cmd_table[i].name, cmd_table[i].help);
+        uart_printf("  %-10s %s\n", cmd_table[i]->name, cmd_table[i]->help);
     }
     return 0;
 }
@@ -310,6 +514,8 @@ int cmd_write(int argc, char *argv[])
 
 int cmd_info(int argc, char *argv[])
 {
+    uart_stats_t us;
+
     (void)argc;
     (void)argv;
 
@@ -324,6 +530,9 @@ int cmd_info(int argc, char *argv[])
     uart_printf("  Uptime:     %u ms\n", timer_uptime_ms());
     uart_puts("\nPeripherals:\n");
     uart_printf("  UART:       0x%x (115200 baud)\n", UART_BASE);
+    uart_get_stats(&us);
+    uart_printf("  UART rings: %u queued, %u TX dropped, %u RX dropped, %u overruns\n",
+                us.tx_queued, us.tx_dropped, us.rx_dropped, us.rx_overruns);
     uart_printf("  Timer:      0x%x\n", TIMER_BASE);
     uart_printf("  GPIO:       0x%x\n", GPIO_BASE);
     uart_puts("\nMilestone 0 - Basic SoC (no FDC, no HyperRAM)\n");
@@ -337,11 +546,12 @@ int cmd_reset(int argc, char *argv[])
     (void)argv;
 
     uart_puts("Resetting...\n");
-    timer_delay_ms(100);  /* Allow UART to flush */
+    uart_flush();
 
     /* Trigger software reset via GPIO or watchdog */
     /* For now, just halt - actual reset depends on HW design */
     uart_puts("Reset not implemented in M0. Halting.\n");
+    uart_flush();
     while (1)
         ;
 
@@ -0,0 +1,233 @@
+/**
+ * FluxRipper CLI Binary Output - Implementation
+ *
+ * Minimal CBOR encoder (RFC 8949): unsigned/negative integers, text
+ * strings, booleans and indefinite-length maps/arrays. The frame is
+ * assembled in HyperRAM and sent in one go once the handler returns.
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-09 20:30
+ */
+
+#include "cli_bin.h"
+#include "platform.h"
+#include "uart.h"
+#include "crc16.h"
+#include <stddef.h>
+#include <string.h>
+
+/*============================================================================
+ * CBOR Encoding
+ *============================================================================*/
+
+#define CBOR_UINT           0x00
+#define CBOR_NEGINT         0x20
+#define CBOR_TEXT           0x60
+#define CBOR_ARRAY          0x80
+#define CBOR_MAP            0xA0
+#define CBOR_INDEFINITE     0x1F
+#define CBOR_FALSE          0xF4
+#define CBOR_TRUE           0xF5
+#define CBOR_BREAK          0xFF
+
+/* Payload starts after STX, tag and length; the CRC trails it */
+#define BIN_HDR             4
+#define BIN_CAP             (CLI_BIN_SIZE - CLI_BIN_OVERHEAD)
+
+static struct {
+    bool        active;
+    bool        overflow;
+    uint32_t    len;
+    const char  *cmd;
+} bin;
+
+static inline uint8_t *bin_buf(void)
+{
+    return (uint8_t *)CLI_BIN_BASE;
+}
+
+static void put_bytes(const void *src, uint32_t n)
+{
+    if (bin.overflow || bin.len + n > BIN_CAP) {
+        bin.overflow = true;
+        return;
+    }
+    memcpy(bin_buf() + BIN_HDR + bin.len, src, n);
+    bin.len += n;
+}
+
+static void put_byte(uint8_t b)
+{
+    put_bytes(&b, 1);
+}
+
+/* Major type with its shortest argument encoding */
+static void put_head(uint8_t major, uint32_t arg)
+{
+    uint8_t h[5];
+    uint32_t n;
+
+    if (arg < 24) {
+        h[0] = major | (uint8_t)arg;
+        n = 1;
+    } else if (arg <= 0xFF) {
+        h[0] = major | 24;
+        h[1] = (uint8_t)arg;
+        n = 2;
+    } else if (arg <= 0xFFFF) {
+        h[0] = major | 25;
+        h[1] = (uint8_t)(arg >> 8);
+        h[2] = (uint8_t)arg;
+        n = 3;
+    } else {
+        h[0] = major | 26;
+        h[1] = (uint8_t)(arg >> 24);
+        h[2] = (uint8_t)(arg >> 16);
+        h[3] = (uint8_t)(arg >> 8);
+        h[4] = (uint8_t)arg;
+        n = 5;
+    }
+    put_bytes(h, n);
+}
+
+static void put_text(const char *s)
+{
+    uint32_t n = (uint32_t)strlen(s);
+
+    put_head(CBOR_TEXT, n);
+    put_bytes(s, n);
+}
+
+static void put_key(const char *key)
+{
+    if (key != NULL) {
+        put_text(key);
+    }
+}
+
+/*============================================================================
+ * Frame Control
+ *============================================================================*/
+
+void cli_bin_begin(const char *cmd)
+{
+    bin.active = true;
+    bin.overflow = false;
+    bin.len = 0;
+    bin.cmd = cmd;
+
+    put_byte(CBOR_MAP | CBOR_INDEFINITE);
+    cli_bin_str("cmd", cmd);
+}
+
+void cli_bin_end(int rc)
+{
+    uint8_t *buf = bin_buf();
+    uint16_t crc;
+
+    if (!bin.active) {
+        return;
+    }
+
+    if (!bin.overflow) {
+        cli_bin_int("rc", rc);
+        put_byte(CBOR_BREAK);
+    }
+    if (bin.overflow) {
+        /* Start over with just the command, the flag and rc */
+        bin.overflow = false;
+        bin.len = 0;
+        put_byte(CBOR_MAP | CBOR_INDEFINITE);
+        cli_bin_str("cmd", bin.cmd);
+        cli_bin_bool("overflow", true);
+        cli_bin_int("rc", rc);
+        put_byte(CBOR_BREAK);
+    }
+
+    buf[0] = CLI_BIN_STX;
+    buf[1] = CLI_BIN_TAG;
+    buf[2] = (uint8_t)bin.len;
+    buf[3] = (uint8_t)(bin.len >> 8);
+    crc = crc16_ccitt(buf + 2, bin.len + 2);
+    buf[BIN_HDR + bin.len] = (uint8_t)crc;
+    buf[BIN_HDR + bin.len + 1] = (uint8_t)(crc >> 8);
+
+    for (uint32_t i = 0; i < bin.len + CLI_BIN_OVERHEAD; i++) {
+        uart_putc((char)buf[i]);
+    }
+    uart_puts("\n");
+
+    bin.active = false;
+}
+
+bool cli_bin_active(void)
+{
+    return bin.active;
+}
+
+/*============================================================================
+ * Field Emitters
+ *============================================================================*/
+
+void cli_bin_uint(const char *key, uint32_t value)
+{
+    put_key(key);
+    put_head(CBOR_UINT, value);
+}
+
+void cli_bin_int(const char *key, int32_t value)
+{
+    put_key(key);
+    if (value < 0) {
+        put_head(CBOR_NEGINT, (uint32_t)(-1 - value));
+    } else {
+        put_head(CBOR_UINT, (uint32_t)value);
+    }
+}
+
+void cli_bin_bool(const char *key, bool value)
+{
+    put_key(key);
+    put_byte(value ? CBOR_TRUE : CBOR_FALSE);
+}
+
+void cli_bin_str(const char *key, const char *value)
+{
+    put_key(key);
+    put_text(value != NULL ? value : "");
+}
+
+void cli_bin_u16_array(const char *key, const uint16_t *values, uint32_t count)
+{
+    put_key(key);
+    put_head(CBOR_ARRAY, count);
+    for (uint32_t i = 0; i < count; i++) {
+        put_head(CBOR_UINT, values[i]);
+    }
+}
+
+void cli_bin_u32_array(const char *key, const uint32_t *values, uint32_t count)
+{
+    put_key(key);
+    put_head(CBOR_ARRAY, count);
+    for (uint32_t i = 0; i < count; i++) {
+        put_head(CBOR_UINT, values[i]);
+    }
+}
+
+void cli_bin_map_begin(const char *key)
+{
+    put_key(key);
+    put_byte(CBOR_MAP | CBOR_INDEFINITE);
+}
+
+void cli_bin_array_begin(const char *key)
+{
+    put_key(key);
+    put_byte(CBOR_ARRAY | CBOR_INDEFINITE);
+}
+
+void cli_bin_end_container(void)
+{
+    put_byte(CBOR_BREAK);
+}
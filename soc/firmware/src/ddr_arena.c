@@ -0,0 +1,311 @@
+/**
+ * FluxRipper DDR Capture Buffer Arena - Implementation
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-11 19:30
+ */
+
+#include "ddr_arena.h"
+#include "fluxstat_hal.h"
+#include "platform.h"
+#include <stddef.h>
+#include <string.h>
+
+/*============================================================================
+ * Internal State
+ *============================================================================*/
+
+static bool g_initialized = false;
+
+/* Granule map: bit set = allocated */
+static uint32_t g_map[DDR_GRANULES / 32];
+static uint32_t g_used;             /* Granules allocated */
+
+/* Descriptor table; size 0 marks a free entry */
+static ddr_buf_t g_buf[DDR_MAX_BUFS];
+
+static ddr_stats_t g_stats;
+
+#define GRANULES_OF(bytes)  (((bytes) + DDR_GRANULE - 1) / DDR_GRANULE)
+
+/*============================================================================
+ * Granule Map
+ *============================================================================*/
+
+static inline bool granule_used(uint32_t g)
+{
+    return (g_map[g >> 5] >> (g & 31)) & 1;
+}
+
+static void mark(uint32_t first, uint32_t count, bool used)
+{
+    for (uint32_t g = first; g < first + count; g++) {
+        if (used) {
+            g_map[g >> 5] |= 1u << (g & 31);
+        } else {
+            g_map[g >> 5] &= ~(1u << (g & 31));
+        }
+    }
+}
+
+/**
+ * First fit: lowest run of count free granules
+ * @return first granule, DDR_GRANULES if none
+ */
+static uint32_t find_run(uint32_t count)
+{
+    uint32_t len = 0;
+
+    for (uint32_t g = 0; g < DDR_GRANULES; g++) {
+        /* Skip whole allocated words */
+        if ((g & 31) == 0 && g_map[g >> 5] == 0xFFFFFFFF) {
+            len = 0;
+            g += 31;
+            continue;
+        }
+        if (granule_used(g)) {
+            len = 0;
+        } else if (++len == count) {
+            return g + 1 - count;
+        }
+    }
+    return DDR_GRANULES;
+}
+
+static uint32_t longest_run(void)
+{
+    uint32_t len = 0, best = 0;
+
+    for (uint32_t g = 0; g < DDR_GRANULES; g++) {
+        if (granule_used(g)) {
+            len = 0;
+        } else if (++len > best) {
+            best = len;
+        }
+    }
+    return best;
+}
+
+static ddr_buf_t *desc_get(void)
+{
+    for (uint32_t i = 0; i < DDR_MAX_BUFS; i++) {
+        if (g_buf[i].size == 0) {
+            g_stats.bufs++;
+            return &g_buf[i];
+        }
+    }
+    return NULL;
+}
+
+static void desc_put(ddr_buf_t *buf)
+{
+    memset(buf, 0, sizeof(*buf));
+    g_stats.bufs--;
+}
+
+/*============================================================================
+ * Region API
+ *============================================================================*/
+
+int ddr_init(void)
+{
+    if (g_initialized) {
+        return FLUXSTAT_OK;
+    }
+
+    memset(g_map, 0, sizeof(g_map));
+    memset(g_buf, 0, sizeof(g_buf));
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_used = 0;
+    g_initialized = true;
+
+    return FLUXSTAT_OK;
+}
+
+ddr_buf_t *ddr_alloc(uint32_t size)
+{
+    uint32_t count = GRANULES_OF(size);
+    ddr_buf_t *buf = NULL;
+
+    if (!g_initialized || size == 0 || count > DDR_GRANULES) {
+        return NULL;
+    }
+
+    uint32_t irq = irq_save();
+
+    uint32_t first = find_run(count);
+    if (first < DDR_GRANULES) {
+        buf = desc_get();
+    }
+    if (buf == NULL) {
+        g_stats.failures++;
+        irq_restore(irq);
+        return NULL;
+    }
+
+    mark(first, count, true);
+    g_used += count;
+    if (g_used * DDR_GRANULE > g_stats.peak_bytes) {
+        g_stats.peak_bytes = g_used * DDR_GRANULE;
+    }
+    g_stats.allocs++;
+
+    buf->addr = DDR_ARENA_BASE + first * DDR_GRANULE;
+    buf->size = count * DDR_GRANULE;
+    buf->refs = 1;
+    buf->slab = NULL;
+    buf->first = (uint16_t)first;
+    buf->granules = (uint16_t)count;
+
+    irq_restore(irq);
+    return buf;
+}
+
+void ddr_retain(ddr_buf_t *buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+
+    uint32_t irq = irq_save();
+    if (buf->size != 0 && buf->refs < 0xFF) {
+        buf->refs++;
+    }
+    irq_restore(irq);
+}
+
+void ddr_release(ddr_buf_t *buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+
+    uint32_t irq = irq_save();
+
+    if (buf->size == 0 || buf->refs == 0) {
+        /* Double release: nothing left to drop */
+        irq_restore(irq);
+        return;
+    }
+
+    if (--buf->refs == 0) {
+        if (buf->slab != NULL) {
+            /* Back to the slab; the descriptor stays reserved */
+            buf->slab->in_use--;
+        } else {
+            mark(buf->first, buf->granules, false);
+            g_used -= buf->granules;
+            desc_put(buf);
+        }
+    }
+
+    irq_restore(irq);
+}
+
+uint32_t ddr_largest_free(void)
+{
+    uint32_t irq = irq_save();
+    uint32_t run = longest_run();
+    irq_restore(irq);
+
+    return run * DDR_GRANULE;
+}
+
+void ddr_get_stats(ddr_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    uint32_t irq = irq_save();
+    *stats = g_stats;
+    stats->free_bytes = (DDR_GRANULES - g_used) * DDR_GRANULE;
+    stats->largest_free = longest_run() * DDR_GRANULE;
+    irq_restore(irq);
+}
+
+/*============================================================================
+ * Slab API
+ *============================================================================*/
+
+int ddr_slab_init(ddr_slab_t *slab, uint32_t obj_size, uint8_t count)
+{
+    if (slab == NULL || obj_size == 0 || count == 0 || count > DDR_SLAB_MAX_OBJS) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
+    memset(slab, 0, sizeof(*slab));
+    slab->obj_size = GRANULES_OF(obj_size) * DDR_GRANULE;
+    slab->count = count;
+
+    slab->run = ddr_alloc(slab->obj_size * count);
+    if (slab->run == NULL) {
+        return FLUXSTAT_ERR_OVERFLOW;
+    }
+
+    uint32_t irq = irq_save();
+    for (uint8_t i = 0; i < count; i++) {
+        ddr_buf_t *obj = desc_get();
+
+        if (obj == NULL) {
+            irq_restore(irq);
+            ddr_slab_destroy(slab);
+            g_stats.failures++;
+            return FLUXSTAT_ERR_OVERFLOW;
+        }
+        obj->addr = slab->run->addr + i * slab->obj_size;
+        obj->size = slab->obj_size;
+        obj->refs = 0;
+        obj->slab = slab;
+        slab->obj[i] = obj;
+    }
+    irq_restore(irq);
+
+    return FLUXSTAT_OK;
+}
+
+ddr_buf_t *ddr_slab_alloc(ddr_slab_t *slab)
+{
+    ddr_buf_t *buf = NULL;
+
+    if (slab == NULL || slab->run == NULL) {
+        return NULL;
+    }
+
+    uint32_t irq = irq_save();
+    for (uint8_t i = 0; i < slab->count; i++) {
+        if (slab->obj[i] != NULL && slab->obj[i]->refs == 0) {
+            buf = slab->obj[i];
+            buf->refs = 1;
+            slab->in_use++;
+            break;
+        }
+    }
+    irq_restore(irq);
+
+    return buf;
+}
+
+int ddr_slab_destroy(ddr_slab_t *slab)
+{
+    if (slab == NULL || slab->run == NULL) {
+        return FLUXSTAT_OK;
+    }
+
+    uint32_t irq = irq_save();
+    if (slab->in_use != 0) {
+        irq_restore(irq);
+        return FLUXSTAT_ERR_BUSY;
+    }
+    for (uint8_t i = 0; i < slab->count; i++) {
+        if (slab->obj[i] != NULL) {
+            desc_put(slab->obj[i]);
+            slab->obj[i] = NULL;
+        }
+    }
+    irq_restore(irq);
+
+    ddr_release(slab->run);
+    slab->run = NULL;
+    return FLUXSTAT_OK;
+}
@@ -11,7 +11,9 @@
 
 #include "cli.h"
 #include "debug_hal.h"
+#include "platform.h"
 #include "uart.h"
+#include "task.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -247,6 +249,7 @@ static int cmd_dbg_watch(int argc, char *argv[])
             uart_printf("%08lX\n", val);
             last_val = val;
         }
+        task_yield();
     }
     uart_getc();  /* Consume the key */
 
@@ -265,7 +268,7 @@ static int cmd_dbg_trace(int argc, char *argv[])
         uart_puts("  stop    - Stop capture\n");
         uart_puts("  clear   - Clear buffer\n");
         uart_puts("  status  - Show status\n");
-        uart_puts("  dump [n]- Show last n entries\n");
+        uart_puts("  dump [n]- Show last n entries (* = trigger)\n");
         return 0;
     }
 
@@ -290,26 +293,36 @@ static int cmd_dbg_trace(int argc, char *argv[])
         if (argc >= 3) {
             n = strtoul(argv[2], NULL, 0);
             if (n == 0) n = 20;
-            if (n > 100) n = 100;
+            if (n > DBG_TRACE_DEPTH) n = DBG_TRACE_DEPTH;
         }
 
         uint32_t count;
         bool triggered, wrapped;
         dbg_trace_status(&count, &triggered, &wrapped);
 
-        uart_puts("Time(us)  Type         Source      Data\n");
-        uart_puts("--------  -----------  ----------  --------\n");
-
+        /* Pull the whole range in one block read, then format it */
+        uint32_t *raw = (uint32_t *)DBG_TRACE_BASE;
         uint32_t start = (count > n) ? count - n : 0;
-        for (uint32_t i = start; i < count; i++) {
+        int got = dbg_trace_read_block(start, count - start, raw);
+        if (got < 0) {
+            uart_printf("Trace read failed (%d)\n", got);
+            return -1;
+        }
+
+        uint32_t trig = triggered ? dbg_trace_trigger_index() : DBG_TRACE_DEPTH;
+
+        uart_puts("  Time(us)  Type         Source      Data\n");
+        uart_puts("  --------  -----------  ----------  --------\n");
+
+        for (int i = 0; i < got; i++) {
             trace_entry_t entry;
-            if (dbg_trace_read(i, &entry) == DBG_OK) {
-                uart_printf("%8u  %-11s  %-10s  %08lX\n",
-                    entry.timestamp,
-                    dbg_event_name(entry.event_type),
-                    dbg_source_name(entry.source),
-                    entry.data);
-            }
+            dbg_trace_unpack(&raw[i * DBG_TRACE_WORDS], &entry);
+            uart_printf("%c %8u  %-11s  %-10s  %08lX\n",
+                (start + i == trig) ? '*' : ' ',
+                entry.timestamp,
+                dbg_event_name(entry.event_type),
+                dbg_source_name(entry.source),
+                entry.data);
         }
     }
 
@@ -532,11 +545,13 @@ int cmd_dbg(int argc, char *argv[])
 
 const cli_cmd_t dbg_cli_cmd = {
     "dbg", "Debug subsystem (r/w/dump/probe/trace/cpu/status)",
-    cmd_dbg
+    cmd_dbg,
+    0,
+    NULL
 };
+CLI_COMMAND(dbg_cli_cmd);
 
 void debug_cli_init(void)
 {
     dbg_init();
-    cli_register(&dbg_cli_cmd);
 }
@@ -0,0 +1,303 @@
+/**
+ * FluxRipper Debug HAL - Memory Access and Trace Readout
+ *
+ * Single words are accessed directly: the CPU sees the same memory map as
+ * the debug port. Block transfers between HyperRAM addresses go through
+ * the debug port block engine, which moves up to 256 words per command as
+ * one AXI read burst and one write burst and reports completion in
+ * MEM_BLK_STAT. Ranges the engine cannot reach (the CPU-local BRAMs) fall
+ * back to a CPU copy.
+ *
+ * The same engine reads the trace buffer: with MEM_BLK_CTRL[2] set its
+ * source is the buffer itself, two words per entry from the oldest on,
+ * so a whole capture lands in HyperRAM in 32 bursts.
+ *
+ * Created: 2025-12-08 18:00
+ * License: BSD-3-Clause
+ */
+
+#include "debug_hal.h"
+#include "platform.h"
+#include "timer.h"
+#include <stddef.h>
+
+/* Per-block completion timeout (256 beats take a few microseconds) */
+#define DBG_BLK_TIMEOUT_US      10000
+
+#define MEM32(a)                (*(volatile uint32_t *)(uintptr_t)(a))
+
+/*============================================================================
+ * Block Engine
+ *============================================================================*/
+
+/**
+ * Internal: Check that a range lies in memory the debug port can burst
+ */
+static bool blk_reachable(uint32_t addr, uint32_t bytes)
+{
+    return addr >= HYPERRAM_BASE &&
+           bytes <= HYPERRAM_SIZE &&
+           addr - HYPERRAM_BASE <= HYPERRAM_SIZE - bytes;
+}
+
+/**
+ * Internal: Words in the next burst, stopping at each 4KB boundary
+ */
+static uint32_t blk_chunk(uint32_t src, uint32_t dst, uint32_t words, uint32_t mode)
+{
+    uint32_t n = words < DBG_BLK_MAX_WORDS ? words : DBG_BLK_MAX_WORDS;
+    uint32_t room = (DBG_BLK_BOUNDARY - (dst & (DBG_BLK_BOUNDARY - 1))) / 4;
+
+    if (room < n) {
+        n = room;
+    }
+    if (mode == 0) {
+        room = (DBG_BLK_BOUNDARY - (src & (DBG_BLK_BOUNDARY - 1))) / 4;
+        if (room < n) {
+            n = room;
+        }
+    }
+    return n;
+}
+
+/**
+ * Internal: Run one block command and wait for it to complete
+ *
+ * The start pulse clears DONE within two clocks of the CTRL write, long
+ * before the first status read returns.
+ */
+static int blk_run(uint32_t src, uint32_t dst, uint32_t words, uint32_t mode)
+{
+    DBG_MEM_BLK_SRC = src;
+    DBG_MEM_BLK_DST = dst;
+    DBG_MEM_BLK_CTRL = DBG_BLK_CTRL_START | mode |
+                       (words << DBG_BLK_CTRL_WORDS_SHIFT);
+
+    uint64_t start = timer_get_us();
+    uint32_t stat;
+    while (!((stat = DBG_MEM_BLK_STAT) & DBG_BLK_STAT_DONE)) {
+        if (timer_get_us() - start > DBG_BLK_TIMEOUT_US) {
+            return DBG_ERR_TIMEOUT;
+        }
+    }
+
+    return (stat & DBG_BLK_STAT_ERROR) ? DBG_ERR_BUS : DBG_OK;
+}
+
+/**
+ * Internal: Copy, fill or read the trace buffer in 4KB-safe bursts
+ * @param mode 0 (copy), DBG_BLK_CTRL_FILL or DBG_BLK_CTRL_LOCAL
+ *             (src is a trace word index)
+ */
+static int blk_transfer(uint32_t src, uint32_t dst, uint32_t count, uint32_t mode)
+{
+    while (count > 0) {
+        uint32_t n = blk_chunk(src, dst, count, mode);
+
+        int ret = blk_run(src, dst, n, mode);
+        if (ret != DBG_OK) {
+            return ret;
+        }
+
+        if (mode == 0) {
+            src += n * 4;
+        } else if (mode == DBG_BLK_CTRL_LOCAL) {
+            src += n;
+        }
+        dst += n * 4;
+        count -= n;
+    }
+    return DBG_OK;
+}
+
+/*============================================================================
+ * Memory Access
+ *============================================================================*/
+
+int dbg_mem_read(uint32_t addr, uint32_t *data)
+{
+    if (data == NULL || (addr & 3) != 0) {
+        return DBG_ERR_INVALID;
+    }
+
+    *data = MEM32(addr);
+    return DBG_OK;
+}
+
+int dbg_mem_write(uint32_t addr, uint32_t data)
+{
+    if ((addr & 3) != 0) {
+        return DBG_ERR_INVALID;
+    }
+
+    MEM32(addr) = data;
+    return DBG_OK;
+}
+
+int dbg_mem_read_block(uint32_t addr, uint32_t *buf, uint32_t count)
+{
+    uint32_t dst = (uint32_t)(uintptr_t)buf;
+
+    if (buf == NULL || (addr & 3) != 0 || count > 0x7FFFFFFF / 4) {
+        return DBG_ERR_INVALID;
+    }
+
+    if (blk_reachable(addr, count * 4) && blk_reachable(dst, count * 4)) {
+        int ret = blk_transfer(addr, dst, count, 0);
+        return ret != DBG_OK ? ret : (int)count;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        buf[i] = MEM32(addr + i * 4);
+    }
+    return (int)count;
+}
+
+int dbg_mem_write_block(uint32_t addr, const uint32_t *buf, uint32_t count)
+{
+    uint32_t src = (uint32_t)(uintptr_t)buf;
+
+    if (buf == NULL || (addr & 3) != 0 || count > 0x7FFFFFFF / 4) {
+        return DBG_ERR_INVALID;
+    }
+
+    if (blk_reachable(addr, count * 4) && blk_reachable(src, count * 4)) {
+        int ret = blk_transfer(src, addr, count, 0);
+        return ret != DBG_OK ? ret : (int)count;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        MEM32(addr + i * 4) = buf[i];
+    }
+    return (int)count;
+}
+
+int dbg_mem_fill(uint32_t addr, uint32_t pattern, uint32_t count)
+{
+    if ((addr & 3) != 0 || count > 0x7FFFFFFF / 4) {
+        return DBG_ERR_INVALID;
+    }
+
+    if (blk_reachable(addr, count * 4)) {
+        DBG_MEM_BLK_PATTERN = pattern;
+        return blk_transfer(0, addr, count, DBG_BLK_CTRL_FILL);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        MEM32(addr + i * 4) = pattern;
+    }
+    return DBG_OK;
+}
+
+int dbg_mem_test(uint32_t addr, uint32_t count)
+{
+    static const uint32_t patterns[] = {
+        0x00000000, 0xFFFFFFFF, 0xAAAAAAAA, 0x55555555
+    };
+
+    /* Data bus: solid and alternating patterns */
+    for (uint32_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++) {
+        int ret = dbg_mem_fill(addr, patterns[p], count);
+        if (ret != DBG_OK) {
+            return ret;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            if (MEM32(addr + i * 4) != patterns[p]) {
+                return DBG_ERR_BUS;
+            }
+        }
+    }
+
+    /* Address bus: every word holds its own address */
+    for (uint32_t i = 0; i < count; i++) {
+        MEM32(addr + i * 4) = addr + i * 4;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (MEM32(addr + i * 4) != addr + i * 4) {
+            return DBG_ERR_BUS;
+        }
+    }
+
+    return DBG_OK;
+}
+
+/*============================================================================
+ * Trace Buffer
+ *============================================================================*/
+
+/* Single-entry reads go through the last words of the readout frame */
+#define TRACE_SCRATCH   (DBG_TRACE_BASE + DBG_TRACE_SIZE - DBG_TRACE_WORDS * 4)
+
+void dbg_trace_status(uint32_t *count, bool *triggered, bool *wrapped)
+{
+    uint32_t stat = DBG_TRACE_STAT;
+
+    if (count) {
+        *count = stat & DBG_TRACE_STAT_COUNT;
+    }
+    if (triggered) {
+        *triggered = (stat & DBG_TRACE_STAT_TRIGGERED) != 0;
+    }
+    if (wrapped) {
+        *wrapped = (stat & DBG_TRACE_STAT_WRAPPED) != 0;
+    }
+}
+
+uint32_t dbg_trace_trigger_index(void)
+{
+    return (DBG_TRACE_STAT >> DBG_TRACE_STAT_TRIG_SHIFT) & (DBG_TRACE_DEPTH - 1);
+}
+
+void dbg_trace_unpack(const uint32_t words[DBG_TRACE_WORDS], trace_entry_t *entry)
+{
+    entry->data       = words[0];
+    entry->source     = (trace_source_t)(words[1] & 0xFF);
+    entry->event_type = (trace_event_t)((words[1] >> 8) & 0xFF);
+    entry->timestamp  = (uint16_t)(words[1] >> 16);
+}
+
+int dbg_trace_read_block(uint32_t first, uint32_t count, uint32_t *dst)
+{
+    uint32_t addr = (uint32_t)(uintptr_t)dst;
+    uint32_t captured;
+
+    if (dst == NULL || (addr & 3) != 0) {
+        return DBG_ERR_INVALID;
+    }
+
+    dbg_trace_status(&captured, NULL, NULL);
+    if (first >= captured) {
+        return 0;
+    }
+    if (count > captured - first) {
+        count = captured - first;
+    }
+
+    if (!blk_reachable(addr, count * DBG_TRACE_WORDS * 4)) {
+        return DBG_ERR_INVALID;
+    }
+
+    int ret = blk_transfer(first * DBG_TRACE_WORDS, addr,
+                           count * DBG_TRACE_WORDS, DBG_BLK_CTRL_LOCAL);
+    return ret != DBG_OK ? ret : (int)count;
+}
+
+int dbg_trace_read(uint32_t index, trace_entry_t *entry)
+{
+    uint32_t *words = (uint32_t *)(uintptr_t)TRACE_SCRATCH;
+
+    if (entry == NULL) {
+        return DBG_ERR_INVALID;
+    }
+
+    int ret = dbg_trace_read_block(index, 1, words);
+    if (ret < 0) {
+        return ret;
+    }
+    if (ret == 0) {
+        return DBG_ERR_INVALID;
+    }
+
+    dbg_trace_unpack(words, entry);
+    return DBG_OK;
+}
@@ -11,6 +11,14 @@
 #include "diagnostics_handler.h"
 #include "diagnostics_protocol.h"
 #include "raw_protocol.h"
+#include "timer.h"
+#include "prof.h"
+#include "platform.h"
+#include "ring.h"
+#include "pll_cal.h"
+#include "precomp_cal.h"
+#include "fluxstat_hal.h"
+#include "fluxripper_hal.h"
 #include <string.h>
 
 /*---------------------------------------------------------------------------
@@ -28,10 +36,60 @@ static diag_signal_stats_t signal_stats;
 static diag_jitter_stats_t jitter_stats;
 static diag_bit_timing_t bit_timing;
 
-/* Histograms */
-static diag_histogram_t flux_histogram;
-static diag_histogram_t amplitude_histogram;
-static diag_histogram_t phase_error_histogram;
+/* Histograms: power-of-two bin widths so binning is a shift */
+typedef struct {
+    diag_histogram_t    h;          /* As reported */
+    uint8_t             shift;      /* log2(h.bin_width) */
+} histogram_t;
+
+static histogram_t flux_histogram;
+static histogram_t amplitude_histogram;
+static histogram_t phase_error_histogram;
+
+/* Batch accumulator, merged into a histogram in one step */
+typedef struct {
+    uint32_t    total;
+    uint32_t    underflow;
+    uint32_t    overflow;
+    uint32_t    bins[DIAG_HISTOGRAM_BINS];
+} histogram_batch_t;
+
+static uint32_t flux_prev_ts;       /* Last timestamp of the previous block */
+static bool flux_prev_valid;
+
+/*---------------------------------------------------------------------------
+ * Private Data - Eye Diagram / Waveform Capture
+ *---------------------------------------------------------------------------*/
+
+#define EYE_CELLS           (DIAG_EYE_PHASE_BINS * DIAG_EYE_AMPL_BINS)
+#define EYE_PHASE_SHIFT     10      /* 64K phase steps over 64 columns */
+#define EYE_AMPL_SHIFT      6       /* 2048 mV over 32 rows */
+#define EYE_COUNT_MAX       0xFFFF
+
+#define WAVE_RING_SIZE      1024    /* Pairs, power of two; one drain empties it */
+
+typedef struct {
+    uint16_t    min_mv;
+    uint16_t    max_mv;
+} wave_pair_t;
+
+static diag_eye_header_t eye_info;
+static bool eye_rev_active;         /* Samples binned since the last index */
+
+static struct {
+    diag_waveform_config_t cfg;
+    ring_t      ring;
+    bool        armed;              /* Waiting for the trigger */
+    bool        running;            /* Producing pairs */
+    uint32_t    rate_hz;            /* Source rate of the last block */
+    uint32_t    decim;              /* Source samples per pair */
+    uint32_t    fill;               /* Source samples in the pair being built */
+    wave_pair_t pair;
+    uint32_t    produced;           /* Pairs since the trigger */
+    uint32_t    next_pos;           /* Stream offset of the next drained pair */
+    uint32_t    dropped_seen;       /* ring.dropped already accounted */
+    int32_t     prev_mv;            /* Level trigger: previous sample, -1 none */
+} wave;
 
 /*---------------------------------------------------------------------------
  * Private Data - PLL/Clock
@@ -55,12 +113,13 @@ static diag_error_entry_t last_error;
  * Private Data - Trace
  *---------------------------------------------------------------------------*/
 
-#define TRACE_BUFFER_SIZE   256
+#define TRACE_BUFFER_SIZE   256     /* Power of two */
 
+/* diag_trace_event() produces (possibly from an ISR), GET_TRACE_DATA drains */
 static diag_trace_config_t trace_config;
 static diag_trace_entry_t trace_buffer[TRACE_BUFFER_SIZE];
-static uint32_t trace_head;
-static uint32_t trace_count;
+static ring_t trace_ring;
+static uint32_t trace_drops_flagged;    /* ring dropped count already flagged */
 static bool trace_active;
 static bool trigger_armed;
 static bool trigger_fired;
@@ -69,8 +128,6 @@ static bool trigger_fired;
  * Private Data - System
  *---------------------------------------------------------------------------*/
 
-static uint32_t uptime_seconds;
-static uint32_t uptime_ms;
 static uint32_t reset_count;
 static uint32_t power_cycles;
 static bool initialized;
@@ -81,8 +138,15 @@ static bool initialized;
 
 static uint32_t get_uptime_ms(void)
 {
-    /* TODO: Read from hardware timer */
-    return uptime_seconds * 1000 + uptime_ms;
+    return timer_get_ms();
+}
+
+/* Copy statistics that an ISR may be updating as one consistent snapshot */
+static void snapshot(void *dst, const void *src, uint32_t n)
+{
+    uint32_t irq = irq_save();
+    memcpy(dst, src, n);
+    irq_restore(irq);
 }
 
 static void build_response_header(uint8_t *buf, uint8_t status,
@@ -95,28 +159,218 @@ static void build_response_header(uint8_t *buf, uint8_t status,
     hdr->data_len = data_len;
 }
 
-static void histogram_init(diag_histogram_t *h, uint32_t min, uint32_t max)
+/**
+ * Set up a histogram covering at least [min, max)
+ * The bin width is rounded up to a power of two, so bin_max may end up
+ * above max.
+ */
+static void histogram_init(histogram_t *hist, uint32_t min, uint32_t max)
 {
+    diag_histogram_t *h = &hist->h;
+    uint32_t span = (max > min) ? max - min : 1;
+    uint8_t shift = 0;
+
+    while (((uint32_t)DIAG_HISTOGRAM_BINS << shift) < span) {
+        shift++;
+    }
+
     memset(h, 0, sizeof(diag_histogram_t));
     h->bin_min = min;
-    h->bin_max = max;
-    h->bin_width = (max - min) / DIAG_HISTOGRAM_BINS;
-    if (h->bin_width == 0) h->bin_width = 1;
+    h->bin_width = 1u << shift;
+    h->bin_max = min + ((uint32_t)DIAG_HISTOGRAM_BINS << shift);
+    hist->shift = shift;
 }
 
-static void histogram_add(diag_histogram_t *h, uint32_t value)
+static inline void histogram_bin(const histogram_t *hist, histogram_batch_t *b,
+                                 uint32_t value)
 {
-    h->total_samples++;
+    uint32_t bin = (value - hist->h.bin_min) >> hist->shift;
+
+    b->total++;
+    if (value < hist->h.bin_min) {
+        b->underflow++;
+    } else if (bin >= DIAG_HISTOGRAM_BINS) {
+        b->overflow++;
+    } else {
+        b->bins[bin]++;
+    }
+}
+
+/* Add a batch to a histogram as one update */
+static void histogram_merge(histogram_t *hist, const histogram_batch_t *b)
+{
+    diag_histogram_t *h = &hist->h;
+    uint32_t irq = irq_save();
+
+    h->total_samples += b->total;
+    h->underflow += b->underflow;
+    h->overflow += b->overflow;
+    for (int i = 0; i < DIAG_HISTOGRAM_BINS; i++) {
+        h->bins[i] += b->bins[i];
+    }
+
+    irq_restore(irq);
+}
+
+static void histogram_add(histogram_t *hist, uint32_t value)
+{
+    PROF_BEGIN(PROF_HISTOGRAM_ADD);
+    diag_histogram_t *h = &hist->h;
+    uint32_t bin = (value - h->bin_min) >> hist->shift;
+    uint32_t irq = irq_save();
 
+    h->total_samples++;
     if (value < h->bin_min) {
         h->underflow++;
-    } else if (value >= h->bin_max) {
+    } else if (bin >= DIAG_HISTOGRAM_BINS) {
         h->overflow++;
     } else {
-        uint32_t bin = (value - h->bin_min) / h->bin_width;
-        if (bin >= DIAG_HISTOGRAM_BINS) bin = DIAG_HISTOGRAM_BINS - 1;
         h->bins[bin]++;
     }
+
+    irq_restore(irq);
+    PROF_END(PROF_HISTOGRAM_ADD);
+}
+
+/*---------------------------------------------------------------------------
+ * Eye Diagram / Waveform Capture
+ *---------------------------------------------------------------------------*/
+
+/* Counts in DIAG_CAPTURE_BASE, followed by the waveform pair ring */
+static uint16_t *eye_bins(void)
+{
+    return (uint16_t *)DIAG_CAPTURE_BASE;
+}
+
+static wave_pair_t *wave_storage(void)
+{
+    return (wave_pair_t *)(DIAG_CAPTURE_BASE + EYE_CELLS * sizeof(uint16_t));
+}
+
+static void eye_reset(void)
+{
+    memset(eye_bins(), 0, EYE_CELLS * sizeof(uint16_t));
+    memset(&eye_info, 0, sizeof(eye_info));
+    eye_info.phase_bins = DIAG_EYE_PHASE_BINS;
+    eye_info.ampl_bins = DIAG_EYE_AMPL_BINS;
+    eye_info.ampl_bin_mv = 1u << EYE_AMPL_SHIFT;
+    eye_rev_active = false;
+}
+
+/* A cell saturated: halve every count, which keeps the shape */
+static void eye_rescale(void)
+{
+    uint16_t *bins = eye_bins();
+
+    for (uint32_t i = 0; i < EYE_CELLS; i++) {
+        bins[i] >>= 1;
+    }
+    eye_info.rescales++;
+}
+
+static void wave_stop(void)
+{
+    wave.armed = false;
+    wave.running = false;
+}
+
+static void wave_start(const diag_waveform_config_t *config)
+{
+    wave_stop();
+    wave.cfg = *config;
+    ring_reset(&wave.ring);
+    wave.rate_hz = 0;
+    wave.decim = 0;
+    wave.fill = 0;
+    wave.produced = 0;
+    wave.next_pos = 0;
+    wave.dropped_seen = 0;
+    wave.prev_mv = -1;
+
+    if (config->sample_rate_hz == 0) {
+        return;
+    }
+    if (config->trigger_source == DIAG_WAVE_TRIG_MANUAL) {
+        wave.running = true;
+    } else {
+        wave.armed = true;
+    }
+}
+
+static void wave_trigger(void)
+{
+    wave.armed = false;
+    wave.running = true;
+}
+
+static bool wave_level_crossed(uint16_t mv)
+{
+    int32_t level = wave.cfg.trigger_level;
+    int32_t prev = wave.prev_mv;
+
+    wave.prev_mv = mv;
+    if (prev < 0) {
+        return false;
+    }
+    return (wave.cfg.trigger_edge == 0) ? (prev < level && mv >= level)
+                                        : (prev > level && mv <= level);
+}
+
+/* Fold one source sample into the pair being built; emit it when full */
+static void wave_sample(uint16_t mv)
+{
+    if (wave.fill == 0) {
+        wave.pair.min_mv = mv;
+        wave.pair.max_mv = mv;
+    } else if (mv < wave.pair.min_mv) {
+        wave.pair.min_mv = mv;
+    } else if (mv > wave.pair.max_mv) {
+        wave.pair.max_mv = mv;
+    }
+
+    if (++wave.fill < wave.decim) {
+        return;
+    }
+    wave.fill = 0;
+
+    /* Host not keeping up: the ring counts the drop */
+    ring_push(&wave.ring, &wave.pair);
+    wave.produced++;
+    if (wave.cfg.sample_count != 0 && wave.produced >= wave.cfg.sample_count) {
+        wave.running = false;
+    }
+}
+
+static void wave_block(const uint16_t *mv, uint32_t n, uint32_t rate_hz)
+{
+    uint32_t i = 0;
+
+    if (rate_hz != wave.rate_hz) {
+        wave.rate_hz = rate_hz;
+        wave.decim = rate_hz / wave.cfg.sample_rate_hz;
+        if (wave.decim == 0) {
+            wave.decim = 1;
+        }
+        wave.fill = 0;
+    }
+
+    /* Level trigger: the capture starts at the crossing */
+    if (wave.armed) {
+        if (wave.cfg.trigger_source != DIAG_WAVE_TRIG_LEVEL) {
+            return;
+        }
+        while (i < n && !wave_level_crossed(mv[i])) {
+            i++;
+        }
+        if (i == n) {
+            return;
+        }
+        wave_trigger();
+    }
+
+    for (; i < n && wave.running; i++) {
+        wave_sample(mv[i]);
+    }
 }
 
 /*---------------------------------------------------------------------------
@@ -136,6 +390,15 @@ int diag_init(void)
     memset(error_log, 0, sizeof(error_log));
     memset(&trace_config, 0, sizeof(trace_config));
     memset(trace_buffer, 0, sizeof(trace_buffer));
+    ring_init(&trace_ring, trace_buffer, sizeof(diag_trace_entry_t),
+              TRACE_BUFFER_SIZE);
+    memset(&wave, 0, sizeof(wave));
+    ring_init(&wave.ring, wave_storage(), sizeof(wave_pair_t), WAVE_RING_SIZE);
+    eye_reset();
+
+    /* Uncalibrated (defaults) if the EEPROM has no records */
+    pllcal_load();
+    pcal_apply();
 
     /* Initialize histograms with typical ranges */
     histogram_init(&flux_histogram, 1000, 10000);       /* 1-10 us */
@@ -145,14 +408,11 @@ int diag_init(void)
     error_log_head = 0;
     error_log_count = 0;
     error_total_count = 0;
-    trace_head = 0;
-    trace_count = 0;
+    trace_drops_flagged = 0;
     trace_active = false;
     trigger_armed = false;
     trigger_fired = false;
 
-    uptime_seconds = 0;
-    uptime_ms = 0;
     reset_count = 0;
     power_cycles = 0;
 
@@ -165,6 +425,7 @@ void diag_reset(void)
     diag_cmd_reset_perf_counters();
     diag_cmd_clear_error_log();
     diag_histogram_reset_all();
+    wave_stop();
     trace_active = false;
     trigger_armed = false;
     trigger_fired = false;
@@ -213,6 +474,13 @@ int diag_process_command(uint8_t opcode, const uint8_t *params,
             return diag_cmd_get_usb_stats(response, response_len);
         case DIAG_CMD_GET_FIFO_STATS:
             return diag_cmd_get_fifo_stats(response, response_len);
+        case DIAG_CMD_GET_PROFILE:
+            return diag_cmd_get_profile(response, response_len);
+        case DIAG_CMD_RESET_PROFILE:
+            prof_reset();
+            build_response_header(response, RAW_RSP_OK, opcode, 0);
+            *response_len = sizeof(raw_rsp_header_t);
+            return 0;
 
         /* Signal Analysis */
         case DIAG_CMD_GET_SIGNAL_STATS:
@@ -225,6 +493,13 @@ int diag_process_command(uint8_t opcode, const uint8_t *params,
             return diag_cmd_get_jitter_stats(response, response_len);
         case DIAG_CMD_GET_BIT_TIMING:
             return diag_cmd_get_bit_timing(response, response_len);
+        case DIAG_CMD_CAPTURE_WAVEFORM:
+            return diag_cmd_capture_waveform(
+                param_len >= sizeof(diag_waveform_config_t)
+                    ? (const diag_waveform_config_t *)params : NULL,
+                response, response_len);
+        case DIAG_CMD_GET_EYE_DIAGRAM:
+            return diag_cmd_get_eye_diagram(response, response_len);
 
         /* PLL/Clock */
         case DIAG_CMD_GET_PLL_DETAILED:
@@ -252,6 +527,22 @@ int diag_process_command(uint8_t opcode, const uint8_t *params,
         case DIAG_CMD_GET_STATE_MACHINE:
             return diag_cmd_get_state_machines(response, response_len);
 
+        /* Calibration */
+        case DIAG_CMD_RUN_CALIBRATION:
+            return diag_cmd_run_calibration(param_len >= 4 ? *(uint32_t*)params : 0,
+                                            response, response_len);
+        case DIAG_CMD_GET_CAL_DATA:
+            return diag_cmd_get_calibration_data(response, response_len);
+        case DIAG_CMD_SAVE_CAL_DATA:
+        case DIAG_CMD_LOAD_CAL_DATA: {
+            int ret = (opcode == DIAG_CMD_SAVE_CAL_DATA) ? diag_cmd_save_calibration()
+                                                         : diag_cmd_load_calibration();
+            build_response_header(response, ret == 0 ? RAW_RSP_OK : RAW_RSP_ERR_NOT_READY,
+                                  opcode, 0);
+            *response_len = sizeof(raw_rsp_header_t);
+            return ret;
+        }
+
         default:
             build_response_header(response, RAW_RSP_ERR_INVALID_CMD, opcode, 0);
             *response_len = sizeof(raw_rsp_header_t);
@@ -311,6 +602,8 @@ int diag_cmd_get_build_info(uint8_t *response, uint32_t *len)
 int diag_cmd_get_uptime(uint8_t *response, uint32_t *len)
 {
     diag_uptime_t *info;
+    uint64_t uptime_us = timer_get_us();
+    uint32_t uptime_seconds = (uint32_t)(uptime_us / 1000000);
 
     build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_UPTIME,
                           sizeof(diag_uptime_t));
@@ -318,7 +611,7 @@ int diag_cmd_get_uptime(uint8_t *response, uint32_t *len)
     info = (diag_uptime_t *)(response + sizeof(raw_rsp_header_t));
 
     info->uptime_seconds = uptime_seconds;
-    info->uptime_ms = uptime_ms;
+    info->uptime_ms = (uint32_t)(uptime_us / 1000 % 1000);
     info->reset_count = reset_count;
     info->last_reset_reason = 0;
     info->power_cycles = power_cycles;
@@ -434,8 +727,8 @@ int diag_cmd_get_perf_counters(uint8_t *response, uint32_t *len)
     build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_PERF_COUNTERS,
                           sizeof(diag_perf_counters_t));
 
-    memcpy(response + sizeof(raw_rsp_header_t), &perf_counters,
-           sizeof(diag_perf_counters_t));
+    snapshot(response + sizeof(raw_rsp_header_t), &perf_counters,
+             sizeof(diag_perf_counters_t));
 
     *len = sizeof(raw_rsp_header_t) + sizeof(diag_perf_counters_t);
     return 0;
@@ -443,7 +736,9 @@ int diag_cmd_get_perf_counters(uint8_t *response, uint32_t *len)
 
 int diag_cmd_reset_perf_counters(void)
 {
+    uint32_t irq = irq_save();
     memset(&perf_counters, 0, sizeof(perf_counters));
+    irq_restore(irq);
     return 0;
 }
 
@@ -451,18 +746,45 @@ int diag_cmd_get_usb_stats(uint8_t *response, uint32_t *len)
 {
     build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_USB_STATS, 32);
 
-    uint8_t *ptr = response + sizeof(raw_rsp_header_t);
-    memcpy(ptr, &perf_counters.usb_bytes_rx, 8);
-    memcpy(ptr + 8, &perf_counters.usb_bytes_tx, 8);
-    memcpy(ptr + 16, &perf_counters.usb_packets_rx, 4);
-    memcpy(ptr + 20, &perf_counters.usb_packets_tx, 4);
-    memcpy(ptr + 24, &perf_counters.usb_errors, 4);
-    memcpy(ptr + 28, &perf_counters.usb_retries, 4);
+    /* The USB fields lead diag_perf_counters_t */
+    snapshot(response + sizeof(raw_rsp_header_t), &perf_counters.usb_bytes_rx, 32);
 
     *len = sizeof(raw_rsp_header_t) + 32;
     return 0;
 }
 
+int diag_cmd_get_profile(uint8_t *response, uint32_t *len)
+{
+    uint32_t data_len = sizeof(diag_prof_header_t) +
+                        PROF_ZONES * sizeof(diag_prof_zone_t);
+    uint8_t *p = response + sizeof(raw_rsp_header_t);
+    prof_stats_t zones[PROF_ZONES];
+    diag_prof_header_t hdr = {
+        .cpu_freq_hz = CPU_FREQ_HZ,
+        .zone_count = PROF_ZONES,
+    };
+
+    build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_PROFILE, data_len);
+
+    prof_snapshot(zones);
+    memcpy(p, &hdr, sizeof(hdr));
+    p += sizeof(hdr);
+
+    for (int i = 0; i < PROF_ZONES; i++) {
+        diag_prof_zone_t z = {
+            .calls = zones[i].calls,
+            .min_cycles = zones[i].min,
+            .max_cycles = zones[i].max,
+            .total_cycles = zones[i].total,
+        };
+        memcpy(p, &z, sizeof(z));
+        p += sizeof(z);
+    }
+
+    *len = sizeof(raw_rsp_header_t) + data_len;
+    return 0;
+}
+
 int diag_cmd_get_fifo_stats(uint8_t *response, uint32_t *len)
 {
     build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_FIFO_STATS,
@@ -484,8 +806,8 @@ int diag_cmd_get_signal_stats(uint8_t *response, uint32_t *len)
     build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_SIGNAL_STATS,
                           sizeof(diag_signal_stats_t));
 
-    memcpy(response + sizeof(raw_rsp_header_t), &signal_stats,
-           sizeof(diag_signal_stats_t));
+    snapshot(response + sizeof(raw_rsp_header_t), &signal_stats,
+             sizeof(diag_signal_stats_t));
 
     *len = sizeof(raw_rsp_header_t) + sizeof(diag_signal_stats_t);
     return 0;
@@ -496,8 +818,8 @@ int diag_cmd_get_flux_histogram(uint8_t *response, uint32_t *len)
     build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_FLUX_HISTOGRAM,
                           sizeof(diag_histogram_t));
 
-    memcpy(response + sizeof(raw_rsp_header_t), &flux_histogram,
-           sizeof(diag_histogram_t));
+    snapshot(response + sizeof(raw_rsp_header_t), &flux_histogram.h,
+             sizeof(diag_histogram_t));
 
     *len = sizeof(raw_rsp_header_t) + sizeof(diag_histogram_t);
     return 0;
@@ -508,8 +830,8 @@ int diag_cmd_get_amplitude_histogram(uint8_t *response, uint32_t *len)
     build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_AMPLITUDE_HIST,
                           sizeof(diag_histogram_t));
 
-    memcpy(response + sizeof(raw_rsp_header_t), &amplitude_histogram,
-           sizeof(diag_histogram_t));
+    snapshot(response + sizeof(raw_rsp_header_t), &amplitude_histogram.h,
+             sizeof(diag_histogram_t));
 
     *len = sizeof(raw_rsp_header_t) + sizeof(diag_histogram_t);
     return 0;
@@ -539,6 +861,76 @@ int diag_cmd_get_bit_timing(uint8_t *response, uint32_t *len)
     return 0;
 }
 
+int diag_cmd_capture_waveform(const diag_waveform_config_t *config,
+                              uint8_t *response, uint32_t *len)
+{
+    diag_waveform_header_t *hdr =
+        (diag_waveform_header_t *)(response + sizeof(raw_rsp_header_t));
+    uint32_t count = 0;
+    uint32_t data_len;
+
+    if (config != NULL) {
+        if (config->pre_trigger != 0 ||
+            config->trigger_source > DIAG_WAVE_TRIG_LEVEL) {
+            build_response_header(response, RAW_RSP_ERR_INVALID_PARAM,
+                                  DIAG_CMD_CAPTURE_WAVEFORM, 0);
+            *len = sizeof(raw_rsp_header_t);
+            return -1;
+        }
+        wave_start(config);
+    } else {
+        /* Drain straight into the response, oldest first */
+        count = ring_pop_batch(&wave.ring, hdr + 1, WAVE_RING_SIZE);
+    }
+
+    hdr->sample_rate_hz = wave.decim ? wave.rate_hz / wave.decim : 0;
+    hdr->sample_count = (uint16_t)count;
+    hdr->bits_per_sample = 16;
+    hdr->offset_mv = 0;
+    hdr->scale_uv = 1000;
+
+    /* Stream offset from the trigger; pairs the ring dropped open a gap */
+    hdr->trigger_pos = wave.next_pos;
+    wave.next_pos += count + (wave.ring.dropped - wave.dropped_seen);
+    wave.dropped_seen = wave.ring.dropped;
+
+    data_len = sizeof(diag_waveform_header_t) + count * sizeof(wave_pair_t);
+    build_response_header(response, RAW_RSP_OK, DIAG_CMD_CAPTURE_WAVEFORM,
+                          (uint16_t)data_len);
+    *len = sizeof(raw_rsp_header_t) + data_len;
+    return 0;
+}
+
+int diag_cmd_get_eye_diagram(uint8_t *response, uint32_t *len)
+{
+    diag_eye_header_t *hdr =
+        (diag_eye_header_t *)(response + sizeof(raw_rsp_header_t));
+    uint8_t *cells = (uint8_t *)(hdr + 1);
+    const uint16_t *bins = eye_bins();
+    uint32_t peak = 0;
+    uint32_t scale;
+
+    for (uint32_t i = 0; i < EYE_CELLS; i++) {
+        if (bins[i] > peak) {
+            peak = bins[i];
+        }
+    }
+
+    /* 16.16 reciprocal, rounded up so the densest cell reaches 255 */
+    scale = peak ? ((255u << 16) + peak - 1) / peak : 0;
+    for (uint32_t i = 0; i < EYE_CELLS; i++) {
+        cells[i] = (uint8_t)((bins[i] * scale) >> 16);
+    }
+
+    memcpy(hdr, &eye_info, sizeof(diag_eye_header_t));
+    hdr->peak_count = peak;
+
+    build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_EYE_DIAGRAM,
+                          sizeof(diag_eye_header_t) + EYE_CELLS);
+    *len = sizeof(raw_rsp_header_t) + sizeof(diag_eye_header_t) + EYE_CELLS;
+    return 0;
+}
+
 /*---------------------------------------------------------------------------
  * PLL/Clock Commands
  *---------------------------------------------------------------------------*/
@@ -593,20 +985,14 @@ int diag_cmd_set_trace_mask(uint32_t mask)
 
 int diag_cmd_get_trace_data(uint8_t *response, uint32_t *len)
 {
-    uint32_t count = (trace_count < TRACE_BUFFER_SIZE) ?
-                     trace_count : TRACE_BUFFER_SIZE;
+    uint8_t *ptr = response + sizeof(raw_rsp_header_t);
+
+    /* Drain straight into the response, oldest first */
+    uint32_t count = ring_pop_batch(&trace_ring, ptr + 4, TRACE_BUFFER_SIZE);
     uint32_t data_len = 4 + count * sizeof(diag_trace_entry_t);
 
     build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_TRACE_DATA, data_len);
-
-    uint8_t *ptr = response + sizeof(raw_rsp_header_t);
-    *(uint32_t *)ptr = count;
-    ptr += 4;
-
-    for (uint32_t i = 0; i < count; i++) {
-        memcpy(ptr, &trace_buffer[i], sizeof(diag_trace_entry_t));
-        ptr += sizeof(diag_trace_entry_t);
-    }
+    memcpy(ptr, &count, sizeof(count));
 
     *len = sizeof(raw_rsp_header_t) + data_len;
     return 0;
@@ -643,26 +1029,116 @@ int diag_cmd_get_state_machines(uint8_t *response, uint32_t *len)
     return 0;
 }
 
+/*---------------------------------------------------------------------------
+ * Calibration Commands
+ *---------------------------------------------------------------------------*/
+
+#define CAL_DATA_LEN    (DIAG_CAL_DRIVES * sizeof(diag_cal_record_t))
+
+static uint8_t cal_status(int ret)
+{
+    switch (ret) {
+        case FLUXSTAT_OK:           return RAW_RSP_OK;
+        case FLUXSTAT_ERR_INVALID:  return RAW_RSP_ERR_INVALID_PARAM;
+        case FLUXSTAT_ERR_BUSY:     return RAW_RSP_ERR_BUSY;
+        case FLUXSTAT_ERR_TIMEOUT:  return RAW_RSP_ERR_TIMEOUT;
+        default:                    return RAW_RSP_ERR_NOT_READY;
+    }
+}
+
+static void cal_copy_records(uint8_t *dst)
+{
+    for (uint8_t d = 0; d < DIAG_CAL_DRIVES; d++) {
+        memcpy(dst + d * sizeof(diag_cal_record_t), pllcal_record(d),
+               sizeof(diag_cal_record_t));
+    }
+}
+
+int diag_cmd_run_calibration(uint32_t cal_mask, uint8_t *response, uint32_t *len)
+{
+    int ret = FLUXSTAT_OK;
+
+    for (uint8_t d = 0; d < DIAG_CAL_DRIVES && ret == FLUXSTAT_OK; d++) {
+        if (cal_mask & DIAG_CAL_PLL(d)) {
+            ret = pllcal_calibrate_drive(d, 0);
+        }
+        if (ret == FLUXSTAT_OK && (cal_mask & DIAG_CAL_PRECOMP(d))) {
+            ret = pcal_calibrate_drive(d, 0);
+        }
+    }
+
+    /* Zones calibrated before a failure are kept and reported */
+    build_response_header(response, cal_status(ret), DIAG_CMD_RUN_CALIBRATION,
+                          CAL_DATA_LEN);
+    cal_copy_records(response + sizeof(raw_rsp_header_t));
+    *len = sizeof(raw_rsp_header_t) + CAL_DATA_LEN;
+    return ret == FLUXSTAT_OK ? 0 : -1;
+}
+
+int diag_cmd_get_calibration_data(uint8_t *response, uint32_t *len)
+{
+    build_response_header(response, RAW_RSP_OK, DIAG_CMD_GET_CAL_DATA, CAL_DATA_LEN);
+    cal_copy_records(response + sizeof(raw_rsp_header_t));
+    *len = sizeof(raw_rsp_header_t) + CAL_DATA_LEN;
+    return 0;
+}
+
+int diag_cmd_save_calibration(void)
+{
+    return pllcal_save() == HAL_OK ? 0 : -1;
+}
+
+int diag_cmd_load_calibration(void)
+{
+    if (pllcal_load() != HAL_OK) {
+        return -1;
+    }
+    pcal_apply();
+    return 0;
+}
+
 /*---------------------------------------------------------------------------
  * Real-time Updates
  *---------------------------------------------------------------------------*/
 
 void diag_update_usb_rx(uint32_t bytes)
 {
-    perf_counters.usb_bytes_rx += bytes;
-    perf_counters.usb_packets_rx++;
+    diag_update_usb_rx_batch(bytes, 1);
 }
 
 void diag_update_usb_tx(uint32_t bytes)
 {
-    perf_counters.usb_bytes_tx += bytes;
-    perf_counters.usb_packets_tx++;
+    diag_update_usb_tx_batch(bytes, 1);
 }
 
 void diag_update_dma(uint32_t bytes)
 {
+    diag_update_dma_batch(bytes, 1);
+}
+
+/* 64-bit byte totals take two stores on RV32: update them with IRQs off */
+void diag_update_usb_rx_batch(uint32_t bytes, uint32_t packets)
+{
+    uint32_t irq = irq_save();
+    perf_counters.usb_bytes_rx += bytes;
+    perf_counters.usb_packets_rx += packets;
+    irq_restore(irq);
+}
+
+void diag_update_usb_tx_batch(uint32_t bytes, uint32_t packets)
+{
+    uint32_t irq = irq_save();
+    perf_counters.usb_bytes_tx += bytes;
+    perf_counters.usb_packets_tx += packets;
+    irq_restore(irq);
+}
+
+void diag_update_dma_batch(uint32_t bytes, uint32_t transfers)
+{
+    uint32_t irq = irq_save();
     perf_counters.dma_bytes_total += bytes;
-    perf_counters.dma_transfers++;
+    perf_counters.dma_transfers += transfers;
+    irq_restore(irq);
 }
 
 void diag_update_sector_read(void)
@@ -708,6 +1184,7 @@ void diag_update_flux_sample(uint32_t flux_word)
     uint32_t timestamp = flux_word & FLUX_TIMESTAMP_MASK;
 
     /* Update signal stats */
+    uint32_t irq = irq_save();
     signal_stats.total_transitions++;
 
     if (flux_word & FLUX_FLAG_INDEX) {
@@ -717,11 +1194,54 @@ void diag_update_flux_sample(uint32_t flux_word)
     if (flux_word & FLUX_FLAG_WEAK) {
         signal_stats.weak_bit_count++;
     }
+    irq_restore(irq);
 
     /* Add to histogram (convert to nanoseconds assuming 5ns/tick) */
     histogram_add(&flux_histogram, timestamp * 5);
 }
 
+void diag_update_flux_block(const uint32_t *words, uint32_t n)
+{
+    histogram_batch_t batch;
+    uint32_t weak = 0;
+    uint32_t prev = flux_prev_ts;
+    bool have_prev = flux_prev_valid;
+
+    if (n == 0) {
+        return;
+    }
+    memset(&batch, 0, sizeof(batch));
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t word = words[i];
+        uint32_t ts = word & FLUX_TIMESTAMP_MASK;
+
+        if (word & FLUX_FLAG_WEAK) {
+            weak++;
+        }
+        /* Index markers carry a timestamp but are not transitions */
+        if (word & FLUX_FLAG_INDEX) {
+            continue;
+        }
+        if (have_prev) {
+            histogram_bin(&flux_histogram, &batch,
+                          ((ts - prev) & FLUX_TIMESTAMP_MASK) * 5);
+        }
+        prev = ts;
+        have_prev = true;
+    }
+
+    flux_prev_ts = prev;
+    flux_prev_valid = have_prev;
+
+    histogram_merge(&flux_histogram, &batch);
+
+    uint32_t irq = irq_save();
+    signal_stats.total_transitions += batch.total;
+    signal_stats.weak_bit_count = (uint8_t)(signal_stats.weak_bit_count + weak);
+    irq_restore(irq);
+}
+
 void diag_update_amplitude(uint16_t amplitude_mv)
 {
     histogram_add(&amplitude_histogram, amplitude_mv);
@@ -736,6 +1256,40 @@ void diag_update_amplitude(uint16_t amplitude_mv)
     }
 }
 
+void diag_update_eye_block(const int16_t *phase, const uint16_t *amplitude_mv,
+                           uint32_t n, uint32_t rate_hz)
+{
+    uint16_t *bins = eye_bins();
+    uint32_t clipped = 0;
+
+    if (n == 0) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t col = (uint16_t)(phase[i] + 0x8000) >> EYE_PHASE_SHIFT;
+        uint32_t row = amplitude_mv[i] >> EYE_AMPL_SHIFT;
+        uint16_t *cell;
+
+        if (row >= DIAG_EYE_AMPL_BINS) {
+            row = DIAG_EYE_AMPL_BINS - 1;
+            clipped++;
+        }
+        cell = &bins[row * DIAG_EYE_PHASE_BINS + col];
+        if (++*cell == EYE_COUNT_MAX) {
+            eye_rescale();
+        }
+    }
+
+    eye_info.samples += n;
+    eye_info.clipped += clipped;
+    eye_rev_active = true;
+
+    if (wave.armed || wave.running) {
+        wave_block(amplitude_mv, n, rate_hz);
+    }
+}
+
 void diag_update_pll_lock(bool locked)
 {
     if (locked && !pll_status.locked) {
@@ -763,13 +1317,24 @@ void diag_update_index_pulse(uint32_t period_ns)
     if (period_ns > 0) {
         rpm_stats.measured_rpm = (uint16_t)(60000000000ULL / period_ns);
     }
+
+    /* Revolutions that contributed samples to the eye */
+    if (eye_rev_active) {
+        eye_info.revolutions++;
+        eye_rev_active = false;
+    }
+    if (wave.armed && wave.cfg.trigger_source == DIAG_WAVE_TRIG_INDEX) {
+        wave_trigger();
+    }
 }
 
 void diag_trace_event(uint8_t event_type, uint32_t data0, uint32_t data1)
 {
     if (!trace_active) return;
 
-    diag_trace_entry_t *entry = &trace_buffer[trace_head];
+    /* Full: the ring counts the drop, the next stored entry flags it */
+    diag_trace_entry_t *entry = ring_claim(&trace_ring);
+    if (entry == NULL) return;
 
     entry->timestamp = get_uptime_ms();
     entry->event_type = event_type;
@@ -780,10 +1345,12 @@ void diag_trace_event(uint8_t event_type, uint32_t data0, uint32_t data1)
     entry->data[2] = 0;
     entry->data[3] = 0;
 
-    trace_head = (trace_head + 1) % TRACE_BUFFER_SIZE;
-    if (trace_count < TRACE_BUFFER_SIZE) {
-        trace_count++;
+    if (trace_ring.dropped != trace_drops_flagged) {
+        trace_drops_flagged = trace_ring.dropped;
+        entry->flags |= DIAG_TRACE_FLAG_DROPPED;
     }
+
+    ring_commit(&trace_ring);
 }
 
 /*---------------------------------------------------------------------------
@@ -807,9 +1374,14 @@ void diag_histogram_add_phase_error(int16_t error_deg)
 
 void diag_histogram_reset_all(void)
 {
+    uint32_t irq = irq_save();
     histogram_init(&flux_histogram, 1000, 10000);
     histogram_init(&amplitude_histogram, 0, 2000);
     histogram_init(&phase_error_histogram, 0, 360);
+    flux_prev_valid = false;
+    irq_restore(irq);
+
+    eye_reset();
 }
 
 /*---------------------------------------------------------------------------
@@ -821,6 +1393,11 @@ bool diag_is_tracing(void)
     return trace_active;
 }
 
+bool diag_is_capturing_waveform(void)
+{
+    return wave.armed || wave.running;
+}
+
 bool diag_trigger_armed(void)
 {
     return trigger_armed;
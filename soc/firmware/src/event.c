@@ -0,0 +1,52 @@
+/**
+ * FluxRipper SoC - Completion Events
+ *
+ * Interrupt-fed completion waits with a status-poll fallback
+ *
+ * Updated: 2025-12-08 10:00
+ */
+
+#include "event.h"
+#include "timer.h"
+
+static void (*idle_hook)(void);
+
+bool event_wait(event_t *ev, event_check_t check, void *arg, uint32_t timeout_ms)
+{
+    uint64_t start = timer_get_us();
+    uint64_t limit = (uint64_t)timeout_ms * 1000;
+    uint64_t last_check = start;
+
+    /* Already done: no need to wait for the interrupt */
+    if (check(arg)) {
+        return true;
+    }
+
+    for (;;) {
+        uint64_t now = timer_get_us();
+
+        if ((ev != NULL && ev->signalled) || (now - last_check) >= EVENT_POLL_US) {
+            if (ev != NULL) {
+                event_clear(ev);
+            }
+            if (check(arg)) {
+                return true;
+            }
+            last_check = now;
+        }
+
+        if ((now - start) >= limit) {
+            /* One last look: the timeout may have raced the completion */
+            return check(arg);
+        }
+
+        if (idle_hook != NULL) {
+            idle_hook();
+        }
+    }
+}
+
+void event_set_idle_hook(void (*hook)(void))
+{
+    idle_hook = hook;
+}
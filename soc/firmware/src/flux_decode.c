@@ -0,0 +1,746 @@
+/**
+ * FluxRipper Software Flux Decoder - Implementation
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-10 19:00
+ */
+
+#include "flux_decode.h"
+#include "fluxripper_hal.h"
+#include "raw_protocol.h"
+#include "crc16.h"
+#include <stddef.h>
+#include <string.h>
+
+#define FDEC_INLINE         static inline __attribute__((always_inline))
+
+/*============================================================================
+ * Tables
+ *============================================================================*/
+
+/* Data bits of 8 clock/data cells (clock first) */
+static const uint8_t cd_nibble[256] = {
+    0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x02, 0x03, 0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x02, 0x03,
+    0x04, 0x05, 0x04, 0x05, 0x06, 0x07, 0x06, 0x07, 0x04, 0x05, 0x04, 0x05, 0x06, 0x07, 0x06, 0x07,
+    0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x02, 0x03, 0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x02, 0x03,
+    0x04, 0x05, 0x04, 0x05, 0x06, 0x07, 0x06, 0x07, 0x04, 0x05, 0x04, 0x05, 0x06, 0x07, 0x06, 0x07,
+    0x08, 0x09, 0x08, 0x09, 0x0A, 0x0B, 0x0A, 0x0B, 0x08, 0x09, 0x08, 0x09, 0x0A, 0x0B, 0x0A, 0x0B,
+    0x0C, 0x0D, 0x0C, 0x0D, 0x0E, 0x0F, 0x0E, 0x0F, 0x0C, 0x0D, 0x0C, 0x0D, 0x0E, 0x0F, 0x0E, 0x0F,
+    0x08, 0x09, 0x08, 0x09, 0x0A, 0x0B, 0x0A, 0x0B, 0x08, 0x09, 0x08, 0x09, 0x0A, 0x0B, 0x0A, 0x0B,
+    0x0C, 0x0D, 0x0C, 0x0D, 0x0E, 0x0F, 0x0E, 0x0F, 0x0C, 0x0D, 0x0C, 0x0D, 0x0E, 0x0F, 0x0E, 0x0F,
+    0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x02, 0x03, 0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x02, 0x03,
+    0x04, 0x05, 0x04, 0x05, 0x06, 0x07, 0x06, 0x07, 0x04, 0x05, 0x04, 0x05, 0x06, 0x07, 0x06, 0x07,
+    0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x02, 0x03, 0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x02, 0x03,
+    0x04, 0x05, 0x04, 0x05, 0x06, 0x07, 0x06, 0x07, 0x04, 0x05, 0x04, 0x05, 0x06, 0x07, 0x06, 0x07,
+    0x08, 0x09, 0x08, 0x09, 0x0A, 0x0B, 0x0A, 0x0B, 0x08, 0x09, 0x08, 0x09, 0x0A, 0x0B, 0x0A, 0x0B,
+    0x0C, 0x0D, 0x0C, 0x0D, 0x0E, 0x0F, 0x0E, 0x0F, 0x0C, 0x0D, 0x0C, 0x0D, 0x0E, 0x0F, 0x0E, 0x0F,
+    0x08, 0x09, 0x08, 0x09, 0x0A, 0x0B, 0x0A, 0x0B, 0x08, 0x09, 0x08, 0x09, 0x0A, 0x0B, 0x0A, 0x0B,
+    0x0C, 0x0D, 0x0C, 0x0D, 0x0E, 0x0F, 0x0E, 0x0F, 0x0C, 0x0D, 0x0C, 0x0D, 0x0E, 0x0F, 0x0E, 0x0F
+};
+
+/* Apple 6-and-2 disk nibble (bit 7 set) to 6 bits, 0xFF invalid; index nibble & 0x7F */
+static const uint8_t gcr62_dec[128] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x01, 0xFF, 0xFF, 0x02, 0x03, 0xFF, 0x04, 0x05, 0x06,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x08, 0xFF, 0xFF, 0xFF, 0x09, 0x0A, 0x0B, 0x0C, 0x0D,
+    0xFF, 0xFF, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, 0xFF, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x1B, 0xFF, 0x1C, 0x1D, 0x1E,
+    0xFF, 0xFF, 0xFF, 0x1F, 0xFF, 0xFF, 0x20, 0x21, 0xFF, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x29, 0x2A, 0x2B, 0xFF, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32,
+    0xFF, 0xFF, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0xFF, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F
+};
+
+/* CBM GCR quintet to nibble, 0xFF invalid (gcr_cbm.v) */
+static const uint8_t gcr5_dec[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x08, 0x00, 0x01, 0xFF, 0x0C, 0x04, 0x05,
+    0xFF, 0xFF, 0x02, 0x03, 0xFF, 0x0F, 0x06, 0x07, 0xFF, 0x09, 0x0A, 0x0B, 0xFF, 0x0D, 0x0E, 0xFF
+};
+
+/*============================================================================
+ * Marks
+ *============================================================================*/
+
+#define MFM_SYNC_A1         0x4489      /* A1 with a missing clock */
+#define MFM_SYNC_CRC        0xCDB4      /* CRC16 of A1 A1 A1 */
+#define M2FM_SYNC           0xF77A      /* m2fm_sync_detector */
+#define FM_MARK_IDAM        0xF57E      /* FE / C7 */
+#define FM_MARK_DAM         0xF56F      /* FB / C7 */
+#define FM_MARK_DDAM        0xF56A      /* F8 / C7 */
+
+#define APPLE_ADDR_PROLOG   0xD5AA96
+#define APPLE_DATA_PROLOG   0xD5AAAD
+#define APPLE_DATA_NIBBLES  343         /* 342 6-and-2 nibbles + checksum */
+
+#define C64_SYNC_ONES       10
+#define C64_BLOCK_HEADER    0x08
+#define C64_BLOCK_DATA      0x07
+#define C64_GCR_INVALID     0x100
+
+enum {
+    ST_HUNT = 0,                        /* Looking for a sync mark */
+    ST_SYNC,                            /* Synced, next byte is the mark */
+    ST_ID,                              /* ID / address field */
+    ST_DATA                             /* Data field */
+};
+
+/*============================================================================
+ * Common
+ *============================================================================*/
+
+bool fdec_is_clock_data(uint8_t encoding)
+{
+    return encoding == ENC_FM || encoding == ENC_MFM || encoding == ENC_M2FM;
+}
+
+bool fdec_supported(uint8_t encoding)
+{
+    return fdec_is_clock_data(encoding) ||
+           encoding == ENC_GCR_APPLE || encoding == ENC_GCR_C64;
+}
+
+uint32_t fdec_cell_ticks(uint8_t encoding, uint32_t data_rate)
+{
+    uint32_t rate = data_rate ? data_rate : 250000;
+
+    if (encoding == ENC_GCR_APPLE || encoding == ENC_GCR_C64) {
+        return FDC_FREQ_HZ / rate;
+    }
+    return FDC_FREQ_HZ / (2 * rate);
+}
+
+uint8_t fdec_cd_byte(uint16_t cells)
+{
+    return (uint8_t)((cd_nibble[cells >> 8] << 4) | cd_nibble[cells & 0xFF]);
+}
+
+uint8_t fdec_cd_mark(uint8_t encoding, uint16_t cells)
+{
+    switch (encoding) {
+    case ENC_MFM:
+        return cells == MFM_SYNC_A1 ? FDEC_MARK_SYNC : FDEC_MARK_NONE;
+    case ENC_M2FM:
+        return cells == M2FM_SYNC ? FDEC_MARK_SYNC : FDEC_MARK_NONE;
+    case ENC_FM:
+        if (cells == FM_MARK_IDAM) return FDEC_MARK_IDAM;
+        if (cells == FM_MARK_DAM)  return FDEC_MARK_DAM;
+        if (cells == FM_MARK_DDAM) return FDEC_MARK_DDAM;
+        return FDEC_MARK_NONE;
+    default:
+        return FDEC_MARK_NONE;
+    }
+}
+
+uint16_t fdec_mark_crc(uint8_t encoding, uint8_t mark)
+{
+    return crc16_update_byte(encoding == ENC_MFM ? MFM_SYNC_CRC : CRC16_INIT, mark);
+}
+
+/*============================================================================
+ * Flux Source
+ *============================================================================*/
+
+void fdec_src_init(fdec_src_t *s, const uint32_t *words, uint32_t count,
+                   uint32_t cell_ticks)
+{
+    s->words = words;
+    s->count = count;
+    s->pos = 0;
+    s->prev = 0;
+    s->primed = false;
+    s->gap_max = (FDEC_MAX_RUN + 1) * cell_ticks;
+}
+
+uint32_t fdec_src_block(fdec_src_t *s, int32_t *dt)
+{
+    uint32_t n = 0;
+
+    while (s->pos < s->count && n < FDEC_BLOCK) {
+        uint32_t w = s->words[s->pos++];
+        uint32_t ts = FLUX_TIMESTAMP(w);
+        uint32_t d = (ts - s->prev) & FLUX_TIMESTAMP_MASK;
+
+        if (FLUX_IS_INDEX(w)) {
+            continue;
+        }
+        s->prev = ts;
+        if (!s->primed) {
+            s->primed = true;
+            continue;
+        }
+        dt[n++] = (int32_t)((d < s->gap_max ? d : s->gap_max) << 8);
+    }
+    return n;
+}
+
+/*============================================================================
+ * PLL
+ *
+ * Second-order loop updated once per transition: Kp = 2 zeta wT and
+ * Ki = wT^2 with wT = 2 pi bw, bw the bandwidth as a fraction of the cell
+ * rate. The phase error of a transition is its distance from the nearest
+ * cell boundary of the tracked period; Kp of it moves the next cell,
+ * Ki of it stays in the period.
+ *============================================================================*/
+
+/* 2 pi / 1000 in Q16: per mille bandwidth to wT */
+#define WT_PER_PM_Q16       412
+
+void fdec_pll_init(fdec_pll_t *p, uint32_t cell_ticks, uint16_t bandwidth_pm,
+                   uint16_t damping)
+{
+    int32_t wt = bandwidth_pm * WT_PER_PM_Q16;
+
+    memset(p, 0, sizeof(*p));
+    p->p0 = (int32_t)(cell_ticks << 8);
+    p->period = p->p0;
+    p->pmin = p->p0 - p->p0 / 8;
+    p->pmax = p->p0 + p->p0 / 8;
+    p->kp = damping * wt / 800;
+    if (p->kp > 4095) {
+        p->kp = 4095;
+    }
+    p->ki = (int32_t)(((int64_t)wt * wt) >> 16);
+}
+
+void fdec_pll_block(fdec_pll_t *p, const int32_t *dt, uint32_t n, uint8_t *runs)
+{
+    int32_t period = p->period;
+    int32_t carry = p->carry;
+    uint32_t transitions = 0;
+    uint64_t err2 = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t t = carry + dt[i];
+        uint32_t cells = (uint32_t)((t + (period >> 1)) / period);
+        int32_t r;
+
+        /* Inside the current cell: a spurious pulse */
+        if (cells == 0) {
+            carry = t;
+            runs[i] = FDEC_RUN_NONE;
+            continue;
+        }
+        if (cells > FDEC_MAX_RUN) {
+            carry = 0;
+            period = p->p0;
+            runs[i] = FDEC_RUN_LOST;
+            continue;
+        }
+
+        r = t - (int32_t)cells * period;
+        err2 += (uint64_t)((int64_t)r * r);
+        transitions++;
+
+        period += (int32_t)(((int64_t)r * p->ki) >> 16);
+        period = period < p->pmin ? p->pmin : (period > p->pmax ? p->pmax : period);
+        carry = r - ((r * p->kp) >> 12);
+        runs[i] = (uint8_t)cells;
+    }
+
+    p->period = period;
+    p->carry = carry;
+    p->transitions += transitions;
+    p->err2 += err2;
+}
+
+static uint32_t isqrt64(uint64_t v)
+{
+    uint64_t r = 0, bit = 1ull << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+uint8_t fdec_phase_rms(uint64_t err2, uint32_t transitions, uint32_t cell_ticks)
+{
+    uint32_t rms;
+
+    if (transitions == 0 || cell_ticks == 0) {
+        return 255;
+    }
+    /* Q8 clocks over the Q8 cell, in 1/256 cell */
+    rms = isqrt64(err2 / transitions) / cell_ticks;
+    return (uint8_t)(rms > 255 ? 255 : rms);
+}
+
+/*============================================================================
+ * Field Framing
+ *============================================================================*/
+
+void fdec_track_init(fdec_track_t *t, fdec_sector_t *list, uint8_t list_max)
+{
+    memset(t, 0, sizeof(*t));
+    t->list = list;
+    t->list_max = list ? list_max : 0;
+}
+
+/**
+ * ID field complete: count it and open it for a data field
+ */
+static void frame_id(fdec_t *d, uint8_t c, uint8_t h, uint8_t r, uint8_t n, bool ok)
+{
+    fdec_track_t *t = d->out;
+
+    if (ok) {
+        t->ids++;
+    } else {
+        t->bad_ids++;
+    }
+
+    d->pend_slot = -1;
+    if (t->count < t->list_max) {
+        fdec_sector_t *s = &t->list[t->count];
+
+        s->cylinder = c;
+        s->head = h;
+        s->sector = r;
+        s->size_code = n;
+        s->flags = ok ? FDEC_SEC_ID_OK : 0;
+        s->id_cell = d->pend_cell;
+        s->data_cell = 0;
+        d->pend_slot = (int8_t)t->count++;
+    }
+
+    d->pend_ok = ok && n <= 6;
+    d->pend_size = (uint16_t)(128u << (n & 0x07));
+    d->pend_cell = d->cell;
+    d->state = ST_HUNT;
+}
+
+/**
+ * Data mark seen: take it if a good ID field ended close enough before
+ */
+static bool frame_data_open(fdec_t *d, bool deleted)
+{
+    bool ok = d->pend_ok && d->cell - d->pend_cell <= FDEC_ID_TO_DATA_CELLS;
+
+    d->pend_ok = false;
+    if (!ok) {
+        d->state = ST_HUNT;
+        return false;
+    }
+    if (d->pend_slot >= 0) {
+        fdec_sector_t *s = &d->out->list[d->pend_slot];
+
+        s->flags |= FDEC_SEC_DATA | (deleted ? FDEC_SEC_DELETED : 0);
+        s->data_cell = d->cell;
+    }
+    d->state = ST_DATA;
+    return true;
+}
+
+static void frame_data_done(fdec_t *d, bool ok)
+{
+    if (ok) {
+        d->out->sectors++;
+        if (d->pend_slot >= 0) {
+            d->out->list[d->pend_slot].flags |= FDEC_SEC_DATA_OK;
+        }
+    } else {
+        d->out->bad_data++;
+    }
+    d->pend_slot = -1;
+    d->state = ST_HUNT;
+}
+
+/*----------------------------------------------------------------------------
+ * IBM (FM, MFM, M2FM)
+ *----------------------------------------------------------------------------*/
+
+static void ibm_mark(fdec_t *d, uint8_t mark, uint16_t crc)
+{
+    d->crc = crc16_update_byte(crc, mark);
+
+    if (mark == FDEC_MARK_IDAM) {
+        d->state = ST_ID;
+        d->pos = 0;
+        d->left = 6;
+        d->pend_cell = d->cell;
+    } else if (mark == FDEC_MARK_DAM || mark == FDEC_MARK_DDAM) {
+        if (frame_data_open(d, mark == FDEC_MARK_DDAM)) {
+            d->left = d->pend_size + 2;
+        }
+    } else {
+        d->state = ST_HUNT;
+    }
+}
+
+static void ibm_byte(fdec_t *d, uint8_t b)
+{
+    switch (d->state) {
+    case ST_SYNC:
+        ibm_mark(d, b, d->encoding == ENC_MFM ? MFM_SYNC_CRC : CRC16_INIT);
+        break;
+
+    case ST_ID:
+        d->crc = crc16_update_byte(d->crc, b);
+        d->hdr[d->pos++] = b;
+        if (--d->left == 0) {
+            frame_id(d, d->hdr[0], d->hdr[1], d->hdr[2], d->hdr[3], d->crc == 0);
+        }
+        break;
+
+    case ST_DATA:
+        d->crc = crc16_update_byte(d->crc, b);
+        if (--d->left == 0) {
+            frame_data_done(d, d->crc == 0);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * Match a mark ending tz cells after the previous transition
+ * run cells just came in, the newest (a transition) in bit 0 of sr.
+ */
+FDEC_INLINE bool mark_at(uint32_t sr, uint32_t run, uint32_t tz, uint16_t pattern)
+{
+    return run > tz && ((sr >> (run - tz)) & 0xFFFF) == pattern;
+}
+
+FDEC_INLINE void feed_cd(fdec_t *d, const uint8_t *runs, uint32_t n, const uint8_t enc)
+{
+    uint32_t sr = d->sr;
+    uint32_t bits = d->bits;
+    uint32_t cell = d->cell;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t run = runs[i];
+
+        if (run == FDEC_RUN_NONE) {
+            continue;
+        }
+        if (run == FDEC_RUN_LOST) {
+            d->state = ST_HUNT;
+            continue;
+        }
+        sr = (sr << run) | 1;
+        cell += run;
+
+        if (d->state <= ST_SYNC) {
+            uint8_t mark = 0;
+
+            if (enc == ENC_MFM) {
+                if ((sr & 0xFFFF) == MFM_SYNC_A1) {
+                    d->state = ST_SYNC;
+                    bits = 0;
+                    continue;
+                }
+            } else if (enc == ENC_M2FM) {
+                if (mark_at(sr, run, 1, M2FM_SYNC)) {
+                    d->state = ST_SYNC;
+                    bits = run - 1;
+                    continue;
+                }
+            } else {
+                /* FM marks carry their value; DAM ends in a transition */
+                if (mark_at(sr, run, 0, FM_MARK_DAM)) {
+                    mark = FDEC_MARK_DAM;
+                    bits = run;
+                } else if (mark_at(sr, run, 1, FM_MARK_IDAM)) {
+                    mark = FDEC_MARK_IDAM;
+                    bits = run - 1;
+                } else if (mark_at(sr, run, 1, FM_MARK_DDAM)) {
+                    mark = FDEC_MARK_DDAM;
+                    bits = run - 1;
+                }
+                if (mark) {
+                    d->cell = cell - bits;
+                    ibm_mark(d, mark, CRC16_INIT);
+                    continue;
+                }
+            }
+            if (d->state == ST_HUNT) {
+                continue;
+            }
+        }
+
+        bits += run;
+        if (bits >= 16) {
+            bits -= 16;
+            d->cell = cell - bits;
+            ibm_byte(d, fdec_cd_byte((uint16_t)(sr >> bits)));
+        }
+    }
+
+    d->sr = sr;
+    d->bits = (uint8_t)bits;
+    d->cell = cell;
+}
+
+/*----------------------------------------------------------------------------
+ * Apple GCR 6-and-2
+ *----------------------------------------------------------------------------*/
+
+static void apple_nibble(fdec_t *d, uint8_t nib)
+{
+    d->marks = (d->marks << 8) | nib;
+
+    switch (d->state) {
+    case ST_HUNT:
+        if ((d->marks & 0xFFFFFF) == APPLE_ADDR_PROLOG) {
+            d->state = ST_ID;
+            d->pos = 0;
+            d->pend_cell = d->cell;
+        } else if ((d->marks & 0xFFFFFF) == APPLE_DATA_PROLOG) {
+            if (frame_data_open(d, false)) {
+                d->left = APPLE_DATA_NIBBLES;
+                d->sum = 0;
+                d->bad = false;
+            }
+        }
+        break;
+
+    case ST_ID:
+        /* Volume, track, sector, checksum; 4-and-4 pairs */
+        d->hdr[d->pos++] = nib;
+        if (d->pos == 8) {
+            uint8_t v[4];
+
+            for (int i = 0; i < 4; i++) {
+                v[i] = (uint8_t)(((d->hdr[2 * i] << 1) | 1) & d->hdr[2 * i + 1]);
+            }
+            frame_id(d, v[1], 0, v[2], 1, (v[0] ^ v[1] ^ v[2]) == v[3]);
+        }
+        break;
+
+    case ST_DATA: {
+        uint8_t x = gcr62_dec[nib & 0x7F];
+
+        d->bad |= (x == 0xFF);
+        d->sum ^= x;
+        if (--d->left == 0) {
+            frame_data_done(d, !d->bad && d->sum == 0);
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+FDEC_INLINE void feed_apple(fdec_t *d, const uint8_t *runs, uint32_t n)
+{
+    uint32_t nib = d->sr;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t run = runs[i];
+
+        if (run == FDEC_RUN_NONE) {
+            continue;
+        }
+        if (run == FDEC_RUN_LOST) {
+            d->state = ST_HUNT;
+            nib = 0;
+            continue;
+        }
+        d->cell += run;
+
+        /* Self-sync: a nibble starts at a one, ends once bit 7 is set */
+        for (uint32_t k = 1; k < run && nib != 0; k++) {
+            nib <<= 1;
+            if (nib & 0x80) {
+                apple_nibble(d, (uint8_t)nib);
+                nib = 0;
+            }
+        }
+        nib = (nib << 1) | 1;
+        if (nib & 0x80) {
+            apple_nibble(d, (uint8_t)nib);
+            nib = 0;
+        }
+    }
+    d->sr = nib;
+}
+
+/*----------------------------------------------------------------------------
+ * CBM GCR
+ *----------------------------------------------------------------------------*/
+
+static void c64_byte(fdec_t *d, uint32_t v)
+{
+    switch (d->state) {
+    case ST_SYNC:
+        if (v == C64_BLOCK_HEADER) {
+            d->state = ST_ID;
+            d->pos = 0;
+            d->bad = false;
+            d->pend_cell = d->cell;
+        } else if (v == C64_BLOCK_DATA) {
+            if (frame_data_open(d, false)) {
+                d->left = 256 + 1;
+                d->sum = 0;
+                d->bad = false;
+            }
+        } else {
+            d->state = ST_HUNT;
+        }
+        break;
+
+    case ST_ID:
+        /* Checksum, sector, track, id2, id1 */
+        d->bad |= (v & C64_GCR_INVALID) != 0;
+        d->hdr[d->pos++] = (uint8_t)v;
+        if (d->pos == 5) {
+            const uint8_t *h = d->hdr;
+
+            frame_id(d, h[2], 0, h[1], 1, !d->bad && (h[1] ^ h[2] ^ h[3] ^ h[4]) == h[0]);
+        }
+        break;
+
+    case ST_DATA:
+        d->bad |= (v & C64_GCR_INVALID) != 0;
+        d->sum ^= (uint8_t)v;
+        if (--d->left == 0) {
+            frame_data_done(d, !d->bad && d->sum == 0);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+FDEC_INLINE void feed_c64(fdec_t *d, const uint8_t *runs, uint32_t n)
+{
+    uint32_t sr = d->sr;
+    uint32_t bits = d->bits;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t run = runs[i];
+
+        if (run == FDEC_RUN_NONE) {
+            continue;
+        }
+        if (run == FDEC_RUN_LOST) {
+            d->state = ST_HUNT;
+            d->ones = 0;
+            continue;
+        }
+        d->cell += run;
+
+        if (run == 1) {
+            if (d->ones < 255) {
+                d->ones++;
+            }
+        } else {
+            /* The first zero after a sync starts the block */
+            if (d->ones >= C64_SYNC_ONES) {
+                d->state = ST_SYNC;
+                bits = 0;
+            }
+            d->ones = 1;
+        }
+        if (d->ones >= C64_SYNC_ONES) {
+            d->state = ST_HUNT;
+            continue;
+        }
+        if (d->state == ST_HUNT) {
+            continue;
+        }
+
+        sr = (sr << run) | 1;
+        bits += run;
+        if (bits >= 10) {
+            uint32_t q;
+            uint8_t hi, lo;
+
+            bits -= 10;
+            q = sr >> bits;
+            hi = gcr5_dec[(q >> 5) & 0x1F];
+            lo = gcr5_dec[q & 0x1F];
+            c64_byte(d, ((hi | lo) & 0xF0) ? C64_GCR_INVALID | (uint32_t)((hi << 4) | lo)
+                                           : (uint32_t)((hi << 4) | lo));
+        }
+    }
+    d->sr = sr;
+    d->bits = (uint8_t)bits;
+}
+
+/*============================================================================
+ * Decoder Variants
+ *============================================================================*/
+
+static void feed_fm(fdec_t *d, const uint8_t *runs, uint32_t n)
+{
+    feed_cd(d, runs, n, ENC_FM);
+}
+
+static void feed_mfm(fdec_t *d, const uint8_t *runs, uint32_t n)
+{
+    feed_cd(d, runs, n, ENC_MFM);
+}
+
+static void feed_m2fm(fdec_t *d, const uint8_t *runs, uint32_t n)
+{
+    feed_cd(d, runs, n, ENC_M2FM);
+}
+
+static void feed_gcr_apple(fdec_t *d, const uint8_t *runs, uint32_t n)
+{
+    feed_apple(d, runs, n);
+}
+
+static void feed_gcr_c64(fdec_t *d, const uint8_t *runs, uint32_t n)
+{
+    feed_c64(d, runs, n);
+}
+
+int fdec_init(fdec_t *d, uint8_t encoding, fdec_track_t *out)
+{
+    memset(d, 0, sizeof(*d));
+    d->encoding = encoding;
+    d->out = out;
+    d->pend_slot = -1;
+
+    switch (encoding) {
+    case ENC_FM:        d->feed = feed_fm;        break;
+    case ENC_MFM:       d->feed = feed_mfm;       break;
+    case ENC_M2FM:      d->feed = feed_m2fm;      break;
+    case ENC_GCR_APPLE: d->feed = feed_gcr_apple; break;
+    case ENC_GCR_C64:   d->feed = feed_gcr_c64;   break;
+    default:
+        return -1;
+    }
+    return 0;
+}
+
+int fdec_decode_pass(const uint32_t *words, uint32_t count, uint8_t encoding,
+                     uint32_t data_rate, uint16_t bandwidth_pm, uint16_t damping,
+                     fdec_track_t *out)
+{
+    static int32_t dt[FDEC_BLOCK];
+    static uint8_t runs[FDEC_BLOCK];
+    uint32_t cell_ticks = fdec_cell_ticks(encoding, data_rate);
+    fdec_src_t src;
+    fdec_pll_t pll;
+    fdec_t dec;
+    uint32_t n;
+
+    if (fdec_init(&dec, encoding, out) != 0) {
+        return -1;
+    }
+    fdec_src_init(&src, words, count, cell_ticks);
+    fdec_pll_init(&pll, cell_ticks, bandwidth_pm, damping);
+
+    while ((n = fdec_src_block(&src, dt)) > 0) {
+        fdec_pll_block(&pll, dt, n, runs);
+        fdec_feed(&dec, runs, n);
+    }
+    return 0;
+}
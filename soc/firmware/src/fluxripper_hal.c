@@ -10,6 +10,10 @@
 
 #include "fluxripper_hal.h"
 #include "platform.h"
+#include "timer.h"
+#include "prof.h"
+#include "event.h"
+#include "spinup.h"
 #include <string.h>
 
 /*============================================================================
@@ -21,29 +25,56 @@ static struct {
     hal_mode_t mode[MAX_DRIVES];
     uint8_t current_track[MAX_DRIVES];
     bool motor_running[MAX_DRIVES];
+    bool motor_starting[MAX_DRIVES];    /* Started, not yet at speed */
+    uint32_t motor_start_ms[MAX_DRIVES];
+    uint32_t motor_used_ms[MAX_DRIVES]; /* Last motor access (idle policy) */
+    bool motor_held[MAX_DRIVES];        /* hal_motor_on() not yet released */
+    uint32_t motor_idle_ms;
+    hal_motor_stats_t motor_stats;
     flux_cb_t flux_callback[MAX_DRIVES];
+    uint8_t seek_target[MAX_DRIVES];
+    bool seek_pending[MAX_DRIVES];
+    bool seek_settling[MAX_DRIVES];
+    uint32_t seek_time[MAX_DRIVES];     /* Seek issue / settle start (ms) */
+    bool fdc_configured[MAX_DRIVES];    /* SPECIFY/CONFIGURE issued */
+    uint8_t fdc_head[MAX_DRIVES];       /* HDS latched by the last command */
+    uint8_t precomp[MAX_DRIVES][HAL_PRECOMP_ZONES]; /* PRECOMP_* per zone */
 } hal_state = {
     .initialized = false,
     .mode = {MODE_IDLE, MODE_IDLE},
     .current_track = {0, 0},
     .motor_running = {false, false},
-    .flux_callback = {NULL, NULL}
+    .flux_callback = {NULL, NULL},
+    .motor_idle_ms = MOTOR_IDLE_MS
 };
 
+/* READ DATA running beside a flux capture (hal_sector_capture_*) */
+static struct {
+    bool active;
+    bool cancel;                        /* Run out, no restart on CRC */
+    uint8_t drive;
+    uint8_t cyl;
+    uint8_t head;
+    uint8_t gpl;
+    uint8_t sector;                     /* First sector of the running command */
+    uint8_t *buf;
+    uint32_t len;                       /* Bytes the running command reads */
+    uint32_t pos;                       /* Bytes received */
+    uint32_t moved_ms;                  /* Last FIFO progress */
+    hal_sector_capture_t result;
+} sect_cap;
+
 /*============================================================================
  * Internal Helper Functions
  *============================================================================*/
 
 /**
- * Get current time in milliseconds (simple implementation)
- * Note: Requires timer to be initialized
+ * Get current time in milliseconds
+ * Note: Requires timer_init()
  */
 static uint32_t get_time_ms(void)
 {
-    /* Timer counts down from 0xFFFFFFFF at CPU_FREQ_HZ (100 MHz) */
-    uint32_t timer_val = TIMER_TCR0;
-    uint32_t elapsed_cycles = 0xFFFFFFFF - timer_val;
-    return elapsed_cycles / (CPU_FREQ_HZ / 1000);
+    return timer_get_ms();
 }
 
 /**
@@ -143,6 +174,392 @@ static void unpack_profile(uint32_t reg_val, drive_profile_t *profile)
     profile->quality = (reg_val & PROFILE_QUALITY_MASK) >> PROFILE_QUALITY_SHIFT;
 }
 
+/**
+ * Get sector layout and data rate for the inserted media
+ */
+static void get_media_params(uint8_t drive, uint8_t *spt, uint8_t *drate, uint8_t *gpl)
+{
+    drive_profile_t profile;
+
+    /* Default: 3.5" HD, 1.44MB */
+    *spt = 18;
+    *drate = DSR_DRATE_500K;
+    *gpl = 0x1B;
+
+    if (hal_get_profile(drive, &profile) != HAL_OK || !profile.valid) {
+        return;
+    }
+
+    /* Same layouts as msc_hal reports to the host */
+    switch (profile.density) {
+        case DENS_DD:
+            *spt = (profile.form_factor == FF_8) ? 26 : 9;
+            *drate = (profile.rpm == 360) ? DSR_DRATE_300K : DSR_DRATE_250K;
+            *gpl = 0x2A;
+            break;
+        case DENS_HD:
+            *spt = (profile.form_factor == FF_5_25) ? 15 : 18;
+            break;
+        case DENS_ED:
+            *spt = 36;
+            *drate = DSR_DRATE_1M;
+            break;
+        default:
+            if (profile.form_factor != FF_3_5) {
+                *spt = 9;
+                *drate = DSR_DRATE_250K;
+                *gpl = 0x2A;
+            }
+            break;
+    }
+}
+
+static bool fdc_rqm_check(void *arg)
+{
+    return (read_reg32(*(const uint32_t *)arg) & MSR_RQM) != 0;
+}
+
+/**
+ * Wait for RQM on the FDC serving a drive
+ */
+static int fdc_wait_ready(uint8_t drive, uint32_t timeout_ms)
+{
+    uint32_t msr_addr = get_msr_addr(drive);
+
+    /* RQM has no interrupt; it is polled every EVENT_POLL_US */
+    return event_wait(NULL, fdc_rqm_check, &msr_addr, timeout_ms) ?
+           HAL_OK : HAL_ERR_TIMEOUT;
+}
+
+/**
+ * Send a command byte to the FDC serving a drive
+ */
+static int fdc_send(uint8_t drive, uint8_t cmd)
+{
+    /* Wait for FDC ready */
+    int ret = fdc_wait_ready(drive, TIMEOUT_READY);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
+    /* Check that DIO is clear (ready for write) */
+    uint32_t msr = read_reg32(get_msr_addr(drive));
+    if (msr & MSR_DIO) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    /* Write command byte */
+    write_reg32(get_data_addr(drive), cmd);
+
+    return HAL_OK;
+}
+
+/**
+ * Read a result byte from the FDC serving a drive
+ */
+static int fdc_result(uint8_t drive, uint8_t *result)
+{
+    /* Wait for FDC ready */
+    int ret = fdc_wait_ready(drive, TIMEOUT_READY);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
+    /* Check that DIO is set (ready for read) */
+    uint32_t msr = read_reg32(get_msr_addr(drive));
+    if (!(msr & MSR_DIO)) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    /* Read result byte */
+    *result = read_reg32(get_data_addr(drive)) & 0xFF;
+
+    return HAL_OK;
+}
+
+/**
+ * Program drive timing and select non-DMA (FIFO) data transfers
+ */
+static int fdc_configure(uint8_t drive)
+{
+    static const uint8_t cmds[] = {
+        /* SPECIFY: SRT 3 ms, HUT max, HLT 2 ms, ND=1 */
+        FDC_CMD_SPECIFY, 0xDF, 0x03,
+        /* CONFIGURE: FIFO enabled, drive polling off, threshold 8 */
+        FDC_CMD_CONFIGURE, 0x00, 0x17, 0x00
+    };
+
+    for (uint32_t i = 0; i < sizeof(cmds); i++) {
+        int ret = fdc_send(drive, cmds[i]);
+        if (ret != HAL_OK) {
+            return ret;
+        }
+    }
+
+    hal_state.fdc_configured[drive] = true;
+    return HAL_OK;
+}
+
+/**
+ * Drain the execution phase of a read command from the FIFO
+ * @return HAL_OK when len bytes were read, HAL_ERR_HARDWARE if the
+ *         controller entered the result phase early
+ */
+static int fdc_read_fifo(uint8_t drive, uint8_t *dst, uint32_t len)
+{
+    uint32_t msr_addr = get_msr_addr(drive);
+    uint32_t data_addr = get_data_addr(drive);
+    uint32_t start = get_time_ms();
+    uint32_t i = 0;
+
+    while (i < len) {
+        uint32_t msr = read_reg32(msr_addr);
+
+        if ((msr & (MSR_RQM | MSR_DIO)) == (MSR_RQM | MSR_DIO)) {
+            if (!(msr & MSR_NON_DMA)) {
+                return HAL_ERR_HARDWARE;
+            }
+            dst[i++] = read_reg32(data_addr) & 0xFF;
+            continue;
+        }
+
+        if ((get_time_ms() - start) >= TIMEOUT_OPERATION) {
+            return HAL_ERR_TIMEOUT;
+        }
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * Feed the execution phase of a write command through the FIFO
+ * @return HAL_OK when len bytes were written, HAL_ERR_HARDWARE if the
+ *         controller entered the result phase early
+ */
+static int fdc_write_fifo(uint8_t drive, const uint8_t *src, uint32_t len)
+{
+    uint32_t msr_addr = get_msr_addr(drive);
+    uint32_t data_addr = get_data_addr(drive);
+    uint32_t start = get_time_ms();
+    uint32_t i = 0;
+
+    while (i < len) {
+        uint32_t msr = read_reg32(msr_addr);
+
+        if (msr & MSR_RQM) {
+            if ((msr & MSR_DIO) || !(msr & MSR_NON_DMA)) {
+                return HAL_ERR_HARDWARE;
+            }
+            write_reg32(data_addr, src[i++]);
+            continue;
+        }
+
+        if ((get_time_ms() - start) >= TIMEOUT_OPERATION) {
+            return HAL_ERR_TIMEOUT;
+        }
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * Issue a multi-sector READ DATA / WRITE DATA / VERIFY for one track side
+ */
+static int fdc_track_cmd(uint8_t opcode, uint8_t drive, uint8_t cyl, uint8_t head,
+                         uint8_t sector, uint8_t count, uint8_t gpl)
+{
+    const uint8_t cmd[9] = {
+        opcode | FDC_CMD_MFM,
+        (uint8_t)((head << 2) | drive),
+        cyl, head, sector,
+        2,                              /* N: 512 bytes */
+        (uint8_t)(sector + count - 1),  /* EOT: stop after the last one */
+        gpl,
+        0xFF                            /* DTL (unused with N != 0) */
+    };
+
+    for (uint32_t i = 0; i < sizeof(cmd); i++) {
+        int ret = fdc_send(drive, cmd[i]);
+        if (ret != HAL_OK) {
+            return ret;
+        }
+    }
+    hal_state.fdc_head[drive] = head;
+    return HAL_OK;
+}
+
+/**
+ * Collect the result phase: ST0, ST1, ST2, C, H, R, N
+ */
+static int fdc_track_result(uint8_t drive, uint8_t st[7])
+{
+    for (uint32_t i = 0; i < 7; i++) {
+        int ret = fdc_result(drive, &st[i]);
+        if (ret != HAL_OK) {
+            return ret;
+        }
+    }
+    return HAL_OK;
+}
+
+/**
+ * Map a track command's status to a HAL result
+ */
+static int fdc_track_status(const uint8_t st[7], int xfer)
+{
+    /* Without TC, reaching EOT ends with abnormal termination + EN */
+    uint8_t ic = st[0] & ST0_IC_MASK;
+    if (xfer == HAL_OK &&
+        (ic == ST0_IC_NORMAL || (ic == ST0_IC_ABNORMAL && st[1] == ST1_EN))) {
+        return HAL_OK;
+    }
+
+    if ((st[1] & ST1_DE) || (st[2] & ST2_DD)) {
+        return HAL_ERR_CRC;
+    }
+    if (st[1] & ST1_OR) {
+        return HAL_ERR_OVERFLOW;
+    }
+
+    return HAL_ERR_HARDWARE;
+}
+
+/**
+ * Read consecutive sectors from one track side with a single READ DATA
+ */
+static int fdc_read_track(uint8_t drive, uint8_t cyl, uint8_t head,
+                          uint8_t sector, uint8_t count, uint8_t gpl, uint8_t *dst)
+{
+    uint8_t st[7];
+    int ret;
+
+    ret = fdc_track_cmd(FDC_CMD_READ_DATA, drive, cyl, head, sector, count, gpl);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
+    int xfer = fdc_read_fifo(drive, dst, (uint32_t)count * FDC_SECTOR_SIZE);
+    if (xfer == HAL_ERR_TIMEOUT) {
+        return xfer;
+    }
+
+    ret = fdc_track_result(drive, st);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+    return fdc_track_status(st, xfer);
+}
+
+/**
+ * Write consecutive sectors to one track side with a single WRITE DATA
+ */
+static int fdc_write_track(uint8_t drive, uint8_t cyl, uint8_t head,
+                           uint8_t sector, uint8_t count, uint8_t gpl,
+                           uint8_t drate, const uint8_t *src)
+{
+    uint32_t zone = cyl / HAL_PRECOMP_ZONE_TRACKS;
+    uint8_t st[7];
+    int ret;
+
+    if (zone >= HAL_PRECOMP_ZONES) {
+        zone = HAL_PRECOMP_ZONES - 1;
+    }
+
+    /* Precompensation is only set through the DSR, with the data rate */
+    write_reg32(get_msr_addr(drive), drate |
+                ((uint32_t)hal_state.precomp[drive][zone] << DSR_PRECOMP_SHIFT));
+
+    ret = fdc_track_cmd(FDC_CMD_WRITE_DATA, drive, cyl, head, sector, count, gpl);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
+    int xfer = fdc_write_fifo(drive, src, (uint32_t)count * FDC_SECTOR_SIZE);
+    if (xfer == HAL_ERR_TIMEOUT) {
+        return xfer;
+    }
+
+    ret = fdc_track_result(drive, st);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+    if (st[1] & ST1_NW) {
+        return HAL_ERR_WRITE_PROT;
+    }
+    return fdc_track_status(st, xfer);
+}
+
+/**
+ * CRC-check consecutive sectors on one track side with a single VERIFY
+ * @param failed Output: sector the command stopped on
+ */
+static int fdc_verify_track(uint8_t drive, uint8_t cyl, uint8_t head,
+                            uint8_t sector, uint8_t count, uint8_t gpl,
+                            uint8_t *failed)
+{
+    uint8_t st[7];
+    int ret;
+
+    ret = fdc_track_cmd(FDC_CMD_VERIFY, drive, cyl, head, sector, count, gpl);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
+    /* No data phase: the result follows once the last sector has passed */
+    ret = fdc_wait_ready(drive, TIMEOUT_OPERATION);
+    if (ret == HAL_OK) {
+        ret = fdc_track_result(drive, st);
+    }
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
+    *failed = st[5];
+    return fdc_track_status(st, HAL_OK);
+}
+
+/**
+ * Select the side the flux engine reads
+ * The FDC latches HDS from each read/write/READ ID command and holds it;
+ * a READ ID on the head switches the side. Its status is not checked:
+ * an unformatted side still ends up selected.
+ */
+static int fdc_select_side(uint8_t drive, uint8_t head)
+{
+    uint8_t st[7];
+    int ret = HAL_OK;
+
+    if (hal_state.fdc_head[drive] == head) {
+        return HAL_OK;
+    }
+
+    if (!hal_state.fdc_configured[drive]) {
+        ret = fdc_configure(drive);
+    }
+
+    /* A read-ahead seek may still be in flight */
+    while (ret == HAL_OK && hal_seek_poll(drive) == HAL_ERR_BUSY) {
+    }
+
+    if (ret == HAL_OK) {
+        ret = fdc_send(drive, FDC_CMD_READ_ID | FDC_CMD_MFM);
+    }
+    if (ret == HAL_OK) {
+        ret = fdc_send(drive, (uint8_t)((head << 2) | drive));
+    }
+    if (ret != HAL_OK) {
+        return ret;
+    }
+    hal_state.fdc_head[drive] = head;
+
+    /* The result follows the first ID field, or two index pulses */
+    ret = fdc_wait_ready(drive, TIMEOUT_OPERATION);
+    if (ret == HAL_OK) {
+        ret = fdc_track_result(drive, st);
+    }
+    return ret;
+}
+
 /*============================================================================
  * HAL API Implementation
  *============================================================================*/
@@ -165,11 +582,6 @@ int hal_init(void)
     write_reg32(FDC_MSR_DSR, DSR_DRATE_500K);
     write_reg32(FDC_DIR_CCR, DSR_DRATE_500K);
 
-    /* Initialize timer for delays */
-    TIMER_TLR0 = 0xFFFFFFFF;  /* Load max value */
-    TIMER_TCSR0 = TIMER_TCSR_ARHT | TIMER_TCSR_LOAD;  /* Auto-reload, load */
-    TIMER_TCSR0 = TIMER_TCSR_ARHT | TIMER_TCSR_ENT;   /* Enable timer */
-
     /* Initialize state */
     hal_state.initialized = true;
     for (int i = 0; i < MAX_DRIVES; i++) {
@@ -195,6 +607,14 @@ hal_mode_t hal_get_mode(uint8_t drive)
     return hal_state.mode[drive];
 }
 
+uint8_t hal_get_track(uint8_t drive)
+{
+    if (drive >= MAX_DRIVES) {
+        return 0;
+    }
+    return hal_state.current_track[drive];
+}
+
 int hal_get_profile(uint8_t drive, drive_profile_t *profile)
 {
     if (!hal_state.initialized) {
@@ -216,7 +636,7 @@ int hal_get_profile(uint8_t drive, drive_profile_t *profile)
     return HAL_OK;
 }
 
-int hal_motor_on(uint8_t drive)
+int hal_motor_start(uint8_t drive)
 {
     if (!hal_state.initialized) {
         return HAL_ERR_NOT_READY;
@@ -226,8 +646,8 @@ int hal_motor_on(uint8_t drive)
         return HAL_ERR_INVALID;
     }
 
-    /* Check if already running */
-    if (hal_state.motor_running[drive]) {
+    /* Check if already running or coming up */
+    if (hal_state.motor_running[drive] || hal_state.motor_starting[drive]) {
         return HAL_OK;
     }
 
@@ -243,14 +663,81 @@ int hal_motor_on(uint8_t drive)
     /* Write DOR */
     write_reg32(FDC_DOR, dor);
 
-    /* Wait for motor spin-up */
-    delay_ms(TIMEOUT_MOTOR);
+    hal_state.motor_start_ms[drive] = get_time_ms();
+    hal_state.motor_used_ms[drive] = hal_state.motor_start_ms[drive];
+    hal_state.motor_starting[drive] = true;
+    hal_state.motor_stats.spinups++;
+
+    return HAL_OK;
+}
+
+bool hal_motor_at_speed(uint8_t drive)
+{
+    if (drive >= MAX_DRIVES) {
+        return false;
+    }
+
+    if (hal_state.motor_starting[drive] &&
+        get_time_ms() - hal_state.motor_start_ms[drive] >= TIMEOUT_MOTOR) {
+        hal_state.motor_starting[drive] = false;
+        hal_state.motor_running[drive] = true;
+    }
+    return hal_state.motor_running[drive];
+}
+
+/**
+ * Get the motor running for an access, without taking a hold on it
+ * Restarts the drive's idle time; a running motor is reused as is.
+ */
+static int motor_use(uint8_t drive)
+{
+    hal_state.motor_used_ms[drive] = get_time_ms();
+
+    /* Check if already running */
+    if (hal_state.motor_running[drive]) {
+        return HAL_OK;
+    }
 
-    hal_state.motor_running[drive] = true;
+    /*
+     * Connector power and motor start go through the spin-up scheduler,
+     * which holds this drive back while other surges use up the budget
+     */
+    int ret = spinup_wait(SPINUP_MASK(PWR_CONN_FDD0 + drive), SPINUP_WAIT_MS);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
+    /* Normally at speed already; covers a connector that was up before */
+    if (hal_motor_start(drive) != HAL_OK) {
+        return HAL_ERR_HARDWARE;
+    }
+    while (!hal_motor_at_speed(drive)) {
+        delay_ms(1);
+    }
+    hal_state.motor_used_ms[drive] = get_time_ms();
 
     return HAL_OK;
 }
 
+int hal_motor_on(uint8_t drive)
+{
+    if (!hal_state.initialized) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    if (drive >= MAX_DRIVES) {
+        return HAL_ERR_INVALID;
+    }
+
+    if (hal_state.motor_running[drive]) {
+        hal_state.motor_stats.reuses++;
+    }
+
+    /* The caller's job owns the motor until hal_motor_release() */
+    hal_state.motor_held[drive] = true;
+    return motor_use(drive);
+}
+
 int hal_motor_off(uint8_t drive)
 {
     if (!hal_state.initialized) {
@@ -271,71 +758,93 @@ int hal_motor_off(uint8_t drive)
     write_reg32(FDC_DOR, dor);
 
     hal_state.motor_running[drive] = false;
+    hal_state.motor_starting[drive] = false;
+    hal_state.motor_held[drive] = false;
+
+    /* The next motor-on is a fresh surge */
+    spinup_release((pwr_conn_t)(PWR_CONN_FDD0 + drive));
 
     return HAL_OK;
 }
 
-int hal_wait_ready(uint32_t timeout_ms)
+int hal_motor_release(uint8_t drive)
 {
-    uint32_t start = get_time_ms();
+    if (!hal_state.initialized) {
+        return HAL_ERR_NOT_READY;
+    }
 
-    while ((get_time_ms() - start) < timeout_ms) {
-        uint32_t msr = read_reg32(FDC_MSR_DSR);
-        if (msr & MSR_RQM) {
-            return HAL_OK;
-        }
-        /* Small delay to avoid hammering the bus */
-        delay_ms(1);
+    if (drive >= MAX_DRIVES) {
+        return HAL_ERR_INVALID;
     }
 
-    return HAL_ERR_TIMEOUT;
+    if (hal_state.motor_idle_ms == 0) {
+        return hal_motor_off(drive);
+    }
+
+    hal_state.motor_used_ms[drive] = get_time_ms();
+    hal_state.motor_held[drive] = false;
+    return HAL_OK;
 }
 
-int hal_send_cmd(uint8_t cmd)
+void hal_motor_poll(void)
 {
-    /* Wait for FDC ready */
-    int ret = hal_wait_ready(TIMEOUT_READY);
-    if (ret != HAL_OK) {
-        return ret;
+    uint32_t now;
+
+    /* Timeout 0: motors only stop when released or switched off */
+    if (!hal_state.initialized || hal_state.motor_idle_ms == 0) {
+        return;
     }
+    now = get_time_ms();
 
-    /* Check that DIO is clear (ready for write) */
-    uint32_t msr = read_reg32(FDC_MSR_DSR);
-    if (msr & MSR_DIO) {
-        return HAL_ERR_NOT_READY;
+    for (uint8_t i = 0; i < MAX_DRIVES; i++) {
+        if (!hal_state.motor_running[i] || hal_state.motor_held[i] ||
+            hal_state.mode[i] != MODE_IDLE || hal_state.seek_pending[i]) {
+            continue;
+        }
+        if (now - hal_state.motor_used_ms[i] >= hal_state.motor_idle_ms) {
+            hal_motor_off(i);
+            hal_state.motor_stats.idle_stops++;
+        }
     }
+}
 
-    /* Write command byte */
-    write_reg32(FDC_DATA, cmd);
+void hal_motor_set_idle_ms(uint32_t idle_ms)
+{
+    hal_state.motor_idle_ms = idle_ms;
+}
 
-    return HAL_OK;
+uint32_t hal_motor_get_idle_ms(void)
+{
+    return hal_state.motor_idle_ms;
 }
 
-int hal_read_result(uint8_t *result)
+void hal_motor_get_stats(hal_motor_stats_t *stats)
 {
-    if (result == NULL) {
-        return HAL_ERR_INVALID;
+    if (stats != NULL) {
+        *stats = hal_state.motor_stats;
     }
+}
 
-    /* Wait for FDC ready */
-    int ret = hal_wait_ready(TIMEOUT_READY);
-    if (ret != HAL_OK) {
-        return ret;
-    }
+int hal_wait_ready(uint32_t timeout_ms)
+{
+    return fdc_wait_ready(DRIVE_A, timeout_ms);
+}
 
-    /* Check that DIO is set (ready for read) */
-    uint32_t msr = read_reg32(FDC_MSR_DSR);
-    if (!(msr & MSR_DIO)) {
-        return HAL_ERR_NOT_READY;
-    }
+int hal_send_cmd(uint8_t cmd)
+{
+    return fdc_send(DRIVE_A, cmd);
+}
 
-    /* Read result byte */
-    *result = read_reg32(FDC_DATA) & 0xFF;
+int hal_read_result(uint8_t *result)
+{
+    if (result == NULL) {
+        return HAL_ERR_INVALID;
+    }
 
-    return HAL_OK;
+    return fdc_result(DRIVE_A, result);
 }
 
-int hal_seek(uint8_t drive, uint8_t track)
+int hal_seek_start(uint8_t drive, uint8_t track)
 {
     if (!hal_state.initialized) {
         return HAL_ERR_NOT_READY;
@@ -345,103 +854,388 @@ int hal_seek(uint8_t drive, uint8_t track)
         return HAL_ERR_INVALID;
     }
 
-    /* Ensure motor is running */
-    if (!hal_state.motor_running[drive]) {
-        int ret = hal_motor_on(drive);
-        if (ret != HAL_OK) {
-            return ret;
-        }
+    if (sect_cap.active) {
+        return HAL_ERR_BUSY;
+    }
+
+    /* Ensure motor is running (reused if it still is) */
+    int ret = motor_use(drive);
+    if (ret != HAL_OK) {
+        return ret;
     }
 
     /* Send SEEK command (0x0F) */
-    int ret = hal_send_cmd(0x0F);
+    ret = fdc_send(drive, 0x0F);
     if (ret != HAL_OK) {
         return ret;
     }
 
     /* Send head/drive byte (head 0, drive number) */
-    ret = hal_send_cmd((0 << 2) | drive);
+    ret = fdc_send(drive, (0 << 2) | drive);
     if (ret != HAL_OK) {
         return ret;
     }
 
     /* Send cylinder number */
-    ret = hal_send_cmd(track);
+    ret = fdc_send(drive, track);
     if (ret != HAL_OK) {
         return ret;
     }
 
-    /* Wait for seek to complete (check for interrupt) */
-    uint32_t start = get_time_ms();
-    while ((get_time_ms() - start) < TIMEOUT_SEEK) {
-        uint32_t sra = read_reg32(FDC_SRA_SRB) & 0xFF;
-        if (sra & SRA_INT_PENDING) {
-            break;
+    hal_state.seek_target[drive] = track;
+    hal_state.seek_pending[drive] = true;
+    hal_state.seek_settling[drive] = false;
+    hal_state.seek_time[drive] = get_time_ms();
+
+    return HAL_OK;
+}
+
+int hal_seek_poll(uint8_t drive)
+{
+    if (drive >= MAX_DRIVES) {
+        return HAL_ERR_INVALID;
+    }
+
+    if (!hal_state.seek_pending[drive]) {
+        return HAL_OK;
+    }
+
+    uint32_t now = get_time_ms();
+
+    /* Head settle after the step pulses have finished */
+    if (hal_state.seek_settling[drive]) {
+        if ((now - hal_state.seek_time[drive]) < SEEK_SETTLE_MS) {
+            return HAL_ERR_BUSY;
         }
-        delay_ms(10);
+        hal_state.seek_pending[drive] = false;
+        hal_state.seek_settling[drive] = false;
+        return HAL_OK;
     }
 
+    /* Wait for seek to complete (interrupt pending on A, busy clear on B) */
+    bool done = (drive == DRIVE_A) ?
+                (read_reg32(FDC_SRA_SRB) & SRA_INT_PENDING) != 0 :
+                (read_reg32(FDC_B_STATUS) & FDC_B_STAT_BUSY) == 0;
+    if (!done) {
+        if ((now - hal_state.seek_time[drive]) >= TIMEOUT_SEEK) {
+            hal_state.seek_pending[drive] = false;
+            return HAL_ERR_TIMEOUT;
+        }
+        return HAL_ERR_BUSY;
+    }
+
+    hal_state.seek_pending[drive] = false;
+
     /* Send SENSE INTERRUPT STATUS (0x08) */
-    ret = hal_send_cmd(0x08);
+    int ret = fdc_send(drive, 0x08);
     if (ret != HAL_OK) {
         return ret;
     }
 
     /* Read ST0 */
     uint8_t st0;
-    ret = hal_read_result(&st0);
+    ret = fdc_result(drive, &st0);
     if (ret != HAL_OK) {
         return ret;
     }
 
     /* Read PCN (Present Cylinder Number) */
     uint8_t pcn;
-    ret = hal_read_result(&pcn);
+    ret = fdc_result(drive, &pcn);
     if (ret != HAL_OK) {
         return ret;
     }
 
     /* Verify we're at the correct track */
-    if (pcn != track) {
+    if (pcn != hal_state.seek_target[drive]) {
         return HAL_ERR_HARDWARE;
     }
 
-    hal_state.current_track[drive] = track;
+    hal_state.current_track[drive] = pcn;
 
-    return HAL_OK;
+    /* Settle before the head is used */
+    hal_state.seek_pending[drive] = true;
+    hal_state.seek_settling[drive] = true;
+    hal_state.seek_time[drive] = now;
+
+    return HAL_ERR_BUSY;
 }
 
-int hal_read_sectors(uint8_t drive, uint32_t lba, void *buf, uint32_t count)
+int hal_seek(uint8_t drive, uint8_t track)
 {
-    if (!hal_state.initialized) {
-        return HAL_ERR_NOT_READY;
+    /* Finish a seek left running in the background first */
+    while (hal_seek_poll(drive) == HAL_ERR_BUSY) {
     }
 
-    if (drive >= MAX_DRIVES || buf == NULL || count == 0) {
-        return HAL_ERR_INVALID;
+    int ret = hal_seek_start(drive, track);
+    if (ret != HAL_OK) {
+        return ret;
     }
 
+    do {
+        ret = hal_seek_poll(drive);
+    } while (ret == HAL_ERR_BUSY);
+
+    return ret;
+}
+
+/**
+ * Prepare a drive for sector commands
+ * Takes the drive into FDC mode and leaves it there (also on error, for
+ * the caller to restore), spins the motor, sets the data rate and waits
+ * out a read-ahead seek still in flight.
+ */
+static int fdc_sector_begin(uint8_t drive, uint8_t *spt, uint8_t *drate, uint8_t *gpl)
+{
+    int ret = HAL_OK;
+
     /* Check if we're in FDC mode */
     if (hal_state.mode[drive] != MODE_IDLE &&
         hal_state.mode[drive] != MODE_FDC) {
         return HAL_ERR_MODE;
     }
 
+    /* The controller is reading alongside a flux capture */
+    if (sect_cap.active) {
+        return HAL_ERR_BUSY;
+    }
+
+    if (!hal_disk_present(drive)) {
+        return HAL_ERR_NO_DISK;
+    }
+
     /* Set mode to FDC */
     hal_state.mode[drive] = MODE_FDC;
 
-    /* Milestone 1: Stub implementation - register access only */
-    /* Full implementation requires:
-     * 1. Convert LBA to CHS (cylinder, head, sector)
-     * 2. Seek to cylinder
-     * 3. Send READ DATA command (0xE6 or 0x66)
-     * 4. Read sector data from FIFO
-     * 5. Check result phase
-     */
+    get_media_params(drive, spt, drate, gpl);
+
+    if (!hal_state.fdc_configured[drive]) {
+        ret = fdc_configure(drive);
+    }
+    if (ret == HAL_OK) {
+        ret = motor_use(drive);
+    }
+    /* The data rate is shared by both interfaces through the CCR */
+    write_reg32(FDC_DIR_CCR, *drate);
+
+    /* A read-ahead seek may still be in flight */
+    while (ret == HAL_OK && hal_seek_poll(drive) == HAL_ERR_BUSY) {
+    }
+    return ret;
+}
+
+int hal_read_sectors(uint8_t drive, uint32_t lba, void *buf, uint32_t count)
+{
+    if (!hal_state.initialized) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    if (drive >= MAX_DRIVES || buf == NULL || count == 0) {
+        return HAL_ERR_INVALID;
+    }
+
+    uint8_t spt, drate, gpl;
+    uint8_t *dst = (uint8_t *)buf;
+    int ret = fdc_sector_begin(drive, &spt, &drate, &gpl);
+
+    if (ret == HAL_ERR_MODE || ret == HAL_ERR_NO_DISK || ret == HAL_ERR_BUSY) {
+        return ret;
+    }
+
+    PROF_BEGIN(PROF_FDD_READ);
+    while (ret == HAL_OK && count > 0) {
+        /* LBA -> CHS, two heads per cylinder */
+        uint8_t cyl = lba / (spt * 2);
+        uint8_t head = (lba / spt) % 2;
+        uint8_t sector = lba % spt + 1;
+
+        /* Rest of this track side, in one command */
+        uint32_t n = spt - sector + 1;
+        if (n > count) {
+            n = count;
+        }
+
+        if (hal_state.current_track[drive] != cyl) {
+            ret = hal_seek(drive, cyl);
+            if (ret != HAL_OK) {
+                break;
+            }
+        }
+
+        for (int attempt = 0; attempt < FDC_READ_RETRIES; attempt++) {
+            ret = fdc_read_track(drive, cyl, head, sector, (uint8_t)n, gpl, dst);
+            if (ret != HAL_ERR_CRC && ret != HAL_ERR_OVERFLOW) {
+                break;
+            }
+        }
+
+        lba += n;
+        count -= n;
+        dst += n * FDC_SECTOR_SIZE;
+    }
+    PROF_END(PROF_FDD_READ);
 
-    /* For now, return not implemented */
     hal_state.mode[drive] = MODE_IDLE;
-    return HAL_ERR_HARDWARE;
+    return ret;
+}
+
+int hal_write_sectors(uint8_t drive, uint32_t lba, const void *buf, uint32_t count)
+{
+    if (!hal_state.initialized) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    if (drive >= MAX_DRIVES || buf == NULL || count == 0) {
+        return HAL_ERR_INVALID;
+    }
+
+    if (hal_write_protected(drive)) {
+        return HAL_ERR_WRITE_PROT;
+    }
+
+    uint8_t spt, drate, gpl;
+    const uint8_t *src = (const uint8_t *)buf;
+    int ret = fdc_sector_begin(drive, &spt, &drate, &gpl);
+
+    if (ret == HAL_ERR_MODE || ret == HAL_ERR_NO_DISK || ret == HAL_ERR_BUSY) {
+        return ret;
+    }
+
+    while (ret == HAL_OK && count > 0) {
+        uint8_t cyl = lba / (spt * 2);
+        uint8_t head = (lba / spt) % 2;
+        uint8_t sector = lba % spt + 1;
+
+        uint32_t n = spt - sector + 1;
+        if (n > count) {
+            n = count;
+        }
+
+        if (hal_state.current_track[drive] != cyl) {
+            ret = hal_seek(drive, cyl);
+            if (ret != HAL_OK) {
+                break;
+            }
+        }
+
+        /* A FIFO underrun leaves the sector unfinished: write it again */
+        for (int attempt = 0; attempt < FDC_READ_RETRIES; attempt++) {
+            ret = fdc_write_track(drive, cyl, head, sector, (uint8_t)n, gpl, drate, src);
+            if (ret != HAL_ERR_OVERFLOW) {
+                break;
+            }
+        }
+
+        lba += n;
+        count -= n;
+        src += n * FDC_SECTOR_SIZE;
+    }
+
+    /* Back to the default precompensation for anything else on the bus */
+    write_reg32(get_msr_addr(drive), drate);
+
+    hal_state.mode[drive] = MODE_IDLE;
+    return ret;
+}
+
+int hal_set_write_precomp(uint8_t drive, uint8_t zone, uint8_t code)
+{
+    if (drive >= MAX_DRIVES || zone >= HAL_PRECOMP_ZONES ||
+        code > (DSR_PRECOMP_MASK >> DSR_PRECOMP_SHIFT)) {
+        return HAL_ERR_INVALID;
+    }
+
+    hal_state.precomp[drive][zone] = code;
+    return HAL_OK;
+}
+
+uint8_t hal_get_write_precomp(uint8_t drive, uint8_t track)
+{
+    uint32_t zone = track / HAL_PRECOMP_ZONE_TRACKS;
+
+    if (drive >= MAX_DRIVES) {
+        return PRECOMP_DEFAULT;
+    }
+    if (zone >= HAL_PRECOMP_ZONES) {
+        zone = HAL_PRECOMP_ZONES - 1;
+    }
+    return hal_state.precomp[drive][zone];
+}
+
+uint8_t hal_get_sectors_per_track(uint8_t drive)
+{
+    uint8_t spt, drate, gpl;
+
+    get_media_params(drive, &spt, &drate, &gpl);
+    return spt;
+}
+
+int hal_verify_sectors(uint8_t drive, uint32_t lba, uint32_t count, uint32_t *bad_lba)
+{
+    if (!hal_state.initialized) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    if (drive >= MAX_DRIVES || count == 0) {
+        return HAL_ERR_INVALID;
+    }
+
+    uint8_t spt, drate, gpl;
+    int ret = fdc_sector_begin(drive, &spt, &drate, &gpl);
+
+    if (ret == HAL_ERR_MODE || ret == HAL_ERR_NO_DISK || ret == HAL_ERR_BUSY) {
+        return ret;
+    }
+
+    PROF_BEGIN(PROF_FDD_READ);
+    while (ret == HAL_OK && count > 0) {
+        uint8_t cyl = lba / (spt * 2);
+        uint8_t head = (lba / spt) % 2;
+        uint8_t sector = lba % spt + 1;
+
+        uint32_t n = spt - sector + 1;
+        if (n > count) {
+            n = count;
+        }
+
+        if (hal_state.current_track[drive] != cyl) {
+            ret = hal_seek(drive, cyl);
+            if (ret != HAL_OK) {
+                break;
+            }
+        }
+
+        for (int attempt = 0; attempt < FDC_READ_RETRIES; attempt++) {
+            uint8_t failed = sector;
+
+            ret = fdc_verify_track(drive, cyl, head, sector, (uint8_t)n, gpl, &failed);
+            if (ret != HAL_ERR_CRC) {
+                break;
+            }
+
+            /* Sectors ahead of the one that failed passed: retry from it */
+            if (failed > sector && failed < sector + n) {
+                lba += failed - sector;
+                count -= failed - sector;
+                n -= failed - sector;
+                sector = failed;
+            }
+        }
+
+        if (ret != HAL_OK) {
+            break;
+        }
+        lba += n;
+        count -= n;
+    }
+    PROF_END(PROF_FDD_READ);
+
+    if (ret != HAL_OK && bad_lba != NULL) {
+        *bad_lba = lba;
+    }
+
+    hal_state.mode[drive] = MODE_IDLE;
+    return ret;
 }
 
 int hal_start_flux_capture(uint8_t drive, uint8_t track,
@@ -460,15 +1254,7 @@ int hal_start_flux_capture(uint8_t drive, uint8_t track,
         return HAL_ERR_MODE;
     }
 
-    /* Ensure motor is running */
-    if (!hal_state.motor_running[drive]) {
-        int ret = hal_motor_on(drive);
-        if (ret != HAL_OK) {
-            return ret;
-        }
-    }
-
-    /* Seek to track if needed */
+    /* Seek to track if needed (the seek and the arm start the motor) */
     if (hal_state.current_track[drive] != track) {
         int ret = hal_seek(drive, track);
         if (ret != HAL_OK) {
@@ -476,6 +1262,35 @@ int hal_start_flux_capture(uint8_t drive, uint8_t track,
         }
     }
 
+    return hal_arm_flux_capture(drive, 0, revolutions, callback);
+}
+
+int hal_arm_flux_capture(uint8_t drive, uint8_t head,
+                         uint8_t revolutions, flux_cb_t callback)
+{
+    if (!hal_state.initialized) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    if (drive >= MAX_DRIVES || head > 1 || revolutions == 0 || callback == NULL) {
+        return HAL_ERR_INVALID;
+    }
+
+    if (hal_state.mode[drive] != MODE_IDLE) {
+        return HAL_ERR_MODE;
+    }
+
+    /* Ensure motor is running (reused if it still is) */
+    int ret = motor_use(drive);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
+    ret = fdc_select_side(drive, head);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
     /* Store callback */
     hal_state.flux_callback[drive] = callback;
 
@@ -485,13 +1300,11 @@ int hal_start_flux_capture(uint8_t drive, uint8_t track,
     /* Get flux control register address */
     uint32_t flux_ctrl_addr = get_flux_ctrl_addr(drive);
 
-    /* Reset flux capture logic */
+    /* Reset flux capture logic (synchronous, no settle time needed) */
     write_reg32(flux_ctrl_addr, FLUX_CTRL_RESET);
-    delay_ms(1);
 
-    /* Start flux capture with revolution count */
-    uint32_t ctrl = FLUX_CTRL_START | ((revolutions << 8) & FLUX_CTRL_REV_MASK);
-    write_reg32(flux_ctrl_addr, ctrl);
+    /* Arm: the engine starts at the next index pulse */
+    write_reg32(flux_ctrl_addr, FLUX_CTRL_START | ((revolutions << 8) & FLUX_CTRL_REV_MASK));
 
     return HAL_OK;
 }
@@ -520,12 +1333,197 @@ int hal_stop_flux_capture(uint8_t drive)
     /* Clear callback */
     hal_state.flux_callback[drive] = NULL;
 
-    /* Reset mode */
+    /* Reset mode; idle time runs from the end of the capture */
     hal_state.mode[drive] = MODE_IDLE;
+    hal_state.motor_used_ms[drive] = get_time_ms();
+
+    return HAL_OK;
+}
+
+/*============================================================================
+ * Sector Capture
+ *============================================================================*/
+
+/**
+ * Mark one sector bad
+ */
+static void sect_cap_bad(uint8_t r)
+{
+    uint64_t bit = (uint64_t)1 << (r - 1);
+
+    if (!(sect_cap.result.bad_mask & bit)) {
+        sect_cap.result.bad_mask |= bit;
+        sect_cap.result.bad++;
+    }
+}
+
+/**
+ * Issue READ DATA from a sector to the end of the track side
+ */
+static int sect_cap_issue(uint8_t sector)
+{
+    uint8_t count = (uint8_t)(sect_cap.result.sectors - sector + 1);
+
+    sect_cap.sector = sector;
+    sect_cap.len = (uint32_t)count * FDC_SECTOR_SIZE;
+    sect_cap.pos = 0;
+    sect_cap.moved_ms = get_time_ms();
+
+    return fdc_track_cmd(FDC_CMD_READ_DATA, sect_cap.drive, sect_cap.cyl,
+                         sect_cap.head, sector, count, sect_cap.gpl);
+}
+
+/**
+ * Finish the capture; sectors from "unread" on were not read
+ */
+static int sect_cap_end(int ret, uint8_t unread)
+{
+    if (ret != HAL_OK) {
+        for (uint32_t r = unread; r >= 1 && r <= sect_cap.result.sectors; r++) {
+            sect_cap_bad((uint8_t)r);
+        }
+    }
+    sect_cap.active = false;
+    return ret;
+}
+
+int hal_sector_capture_start(uint8_t drive, uint8_t head, void *buf)
+{
+    uint8_t spt, drate, gpl;
+    int ret = HAL_OK;
+
+    if (!hal_state.initialized) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    if (drive >= MAX_DRIVES || head > 1 || buf == NULL) {
+        return HAL_ERR_INVALID;
+    }
+
+    if (sect_cap.active) {
+        return HAL_ERR_BUSY;
+    }
+
+    /* Only beside a capture: the flux engine owns the drive */
+    if (hal_state.mode[drive] != MODE_FLUX_CAPTURE) {
+        return HAL_ERR_MODE;
+    }
+
+    get_media_params(drive, &spt, &drate, &gpl);
+    if (spt > FDC_TRACK_MAX_SECTORS) {
+        return HAL_ERR_INVALID;
+    }
+
+    if (!hal_state.fdc_configured[drive]) {
+        ret = fdc_configure(drive);
+        if (ret != HAL_OK) {
+            return ret;
+        }
+    }
+    write_reg32(FDC_DIR_CCR, drate);
+
+    memset(&sect_cap, 0, sizeof(sect_cap));
+    sect_cap.drive = drive;
+    sect_cap.cyl = hal_state.current_track[drive];
+    sect_cap.head = head;
+    sect_cap.gpl = gpl;
+    sect_cap.buf = (uint8_t *)buf;
+    sect_cap.result.sectors = spt;
 
+    ret = sect_cap_issue(1);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+    sect_cap.active = true;
     return HAL_OK;
 }
 
+int hal_sector_capture_poll(hal_sector_capture_t *result)
+{
+    bool moved = false;
+    uint8_t st[7];
+    int ret;
+
+    if (!sect_cap.active) {
+        return HAL_ERR_INVALID;
+    }
+
+    uint32_t msr_addr = get_msr_addr(sect_cap.drive);
+    uint32_t data_addr = get_data_addr(sect_cap.drive);
+
+    for (;;) {
+        uint32_t msr = read_reg32(msr_addr);
+
+        if ((msr & (MSR_RQM | MSR_DIO)) != (MSR_RQM | MSR_DIO)) {
+            uint32_t now = get_time_ms();
+
+            if (moved) {
+                sect_cap.moved_ms = now;
+            } else if ((now - sect_cap.moved_ms) >= TIMEOUT_OPERATION) {
+                ret = sect_cap_end(HAL_ERR_TIMEOUT,
+                                   (uint8_t)(sect_cap.sector + sect_cap.pos / FDC_SECTOR_SIZE));
+                break;
+            }
+            return HAL_ERR_BUSY;
+        }
+
+        /* Execution phase: one data byte */
+        if (msr & MSR_NON_DMA) {
+            uint8_t b = read_reg32(data_addr) & 0xFF;
+
+            if (sect_cap.pos < sect_cap.len) {
+                sect_cap.buf[(sect_cap.sector - 1) * FDC_SECTOR_SIZE + sect_cap.pos] = b;
+            }
+            sect_cap.pos++;
+            moved = true;
+            continue;
+        }
+
+        /* Result phase */
+        ret = fdc_track_result(sect_cap.drive, st);
+        if (ret != HAL_OK) {
+            ret = sect_cap_end(ret, sect_cap.sector);
+            break;
+        }
+        ret = fdc_track_status(st, (sect_cap.pos >= sect_cap.len) ? HAL_OK : HAL_ERR_HARDWARE);
+
+        /* R is the sector the command stopped on */
+        if (ret != HAL_OK &&
+            (st[5] < sect_cap.sector || st[5] > sect_cap.result.sectors)) {
+            ret = sect_cap_end(ret, sect_cap.sector);
+            break;
+        }
+        if (ret == HAL_ERR_CRC) {
+            /* Its data has been read; carry on with the next one */
+            sect_cap_bad(st[5]);
+            ret = HAL_OK;
+            if (st[5] < sect_cap.result.sectors && !sect_cap.cancel) {
+                ret = sect_cap_issue((uint8_t)(st[5] + 1));
+                if (ret == HAL_OK) {
+                    return HAL_ERR_BUSY;
+                }
+                ret = sect_cap_end(ret, sect_cap.sector);
+                break;
+            }
+        }
+        ret = sect_cap_end(ret, st[5]);
+        break;
+    }
+
+    if (result != NULL) {
+        *result = sect_cap.result;
+    }
+    return ret;
+}
+
+void hal_sector_capture_cancel(void)
+{
+    sect_cap.cancel = true;
+    while (sect_cap.active) {
+        (void)hal_sector_capture_poll(NULL);
+    }
+}
+
 bool hal_disk_present(uint8_t drive)
 {
     if (!hal_state.initialized || drive >= MAX_DRIVES) {
@@ -583,7 +1581,10 @@ int hal_reset(void)
         hal_state.current_track[i] = 0;
         hal_state.motor_running[i] = false;
         hal_state.flux_callback[i] = NULL;
+        hal_state.fdc_configured[i] = false;
+        hal_state.fdc_head[i] = 0;
     }
+    sect_cap.active = false;
 
     return HAL_OK;
 }
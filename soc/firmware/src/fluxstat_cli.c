@@ -8,7 +8,13 @@
 
 #include "fluxstat_cli.h"
 #include "fluxstat_hal.h"
+#include "pll_cal.h"
+#include "precomp_cal.h"
+#include "format_cache.h"
+#include "fluxripper_hal.h"
+#include "cli_bin.h"
 #include "uart.h"
+#include "task.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -32,6 +38,22 @@ static void print_confidence_bar(uint8_t confidence)
     uart_printf("] %d%%", confidence);
 }
 
+static const char *const enc_names[] = {
+    [ENC_UNKNOWN]   = "auto",
+    [ENC_FM]        = "fm",
+    [ENC_MFM]       = "mfm",
+    [ENC_GCR_APPLE] = "apple",
+    [ENC_GCR_C64]   = "c64",
+    [ENC_M2FM]      = "m2fm",
+};
+
+#define ENC_NAME_COUNT  (sizeof(enc_names) / sizeof(enc_names[0]))
+
+static const char *enc_name(uint8_t enc)
+{
+    return enc < ENC_NAME_COUNT ? enc_names[enc] : "?";
+}
+
 /*============================================================================
  * fluxstat config - Configure FluxStat Parameters
  *============================================================================*/
@@ -48,16 +70,21 @@ static int cmd_fluxstat_config(int argc, char *argv[])
         uart_printf("  Pass Count:         %d\n", config.pass_count);
         uart_printf("  Confidence Thresh:  %d%%\n", config.confidence_threshold);
         uart_printf("  Max Correction:     %d bits\n", config.max_correction_bits);
-        uart_printf("  Encoding:           %d\n", config.encoding);
+        uart_printf("  Encoding:           %s\n", enc_name(config.encoding));
         uart_printf("  Data Rate:          %lu bps\n", config.data_rate);
         uart_printf("  CRC Correction:     %s\n", config.use_crc_correction ? "ON" : "OFF");
         uart_printf("  Preserve Weak:      %s\n", config.preserve_weak_bits ? "ON" : "OFF");
+        uart_printf("  Adaptive:           %s (stop after %d passes without gain)\n",
+                    config.adaptive ? "ON" : "OFF", config.adaptive_stall);
         print_separator();
         uart_puts("\nUsage: fluxstat config <param>=<value> ...\n");
         uart_puts("  passes=N        Pass count (2-64)\n");
         uart_puts("  threshold=N     Confidence threshold (0-100)\n");
         uart_puts("  correction=on|off  CRC correction\n");
         uart_puts("  rate=N          Expected data rate (bps)\n");
+        uart_puts("  encoding=E      fm|mfm|m2fm|apple|c64, auto = per track\n");
+        uart_puts("  adaptive=on|off Stop early once the track converges\n");
+        uart_puts("  stall=N         Adaptive: passes without gain (1-16)\n");
         return 0;
     }
 
@@ -100,6 +127,33 @@ static int cmd_fluxstat_config(int argc, char *argv[])
             config.data_rate = atoi(value);
             uart_printf("Data rate set to %lu bps\n", config.data_rate);
         }
+        else if (strcmp(param, "encoding") == 0) {
+            uint8_t e;
+            for (e = 0; e < ENC_NAME_COUNT; e++) {
+                if (strcmp(value, enc_names[e]) == 0) {
+                    break;
+                }
+            }
+            if (e < ENC_NAME_COUNT) {
+                config.encoding = e;
+                uart_printf("Encoding set to %s\n", enc_names[e]);
+            } else {
+                uart_puts("Invalid encoding (fm, mfm, m2fm, apple, c64, auto)\n");
+            }
+        }
+        else if (strcmp(param, "adaptive") == 0) {
+            config.adaptive = (strcmp(value, "on") == 0 || strcmp(value, "1") == 0);
+            uart_printf("Adaptive pass count %s\n", config.adaptive ? "enabled" : "disabled");
+        }
+        else if (strcmp(param, "stall") == 0) {
+            int n = atoi(value);
+            if (n >= 1 && n <= 16) {
+                config.adaptive_stall = n;
+                uart_printf("Adaptive stall set to %d passes\n", n);
+            } else {
+                uart_puts("Invalid stall (must be 1-16)\n");
+            }
+        }
         else {
             uart_printf("Unknown parameter: %s\n", param);
         }
@@ -116,15 +170,17 @@ static int cmd_fluxstat_config(int argc, char *argv[])
 static int cmd_fluxstat_capture(int argc, char *argv[])
 {
     if (argc < 2) {
-        uart_puts("Usage: fluxstat capture <track> [head=N] [passes=N]\n");
+        uart_puts("Usage: fluxstat capture <track> [head=N] [drive=N] [passes=N]\n");
         uart_puts("  track     Track number (0-79)\n");
         uart_puts("  head=N    Head number (0-1, default 0)\n");
+        uart_puts("  drive=N   Drive number (0-3, default 0)\n");
         uart_puts("  passes=N  Override pass count\n");
         return 0;
     }
 
     uint8_t track = atoi(argv[1]);
     uint8_t head = 0;
+    uint8_t drive = 0;
     uint8_t passes = 0;  /* 0 = use config default */
 
     /* Parse optional parameters */
@@ -137,6 +193,9 @@ static int cmd_fluxstat_capture(int argc, char *argv[])
         if (strcmp(param, "head") == 0) {
             head = atoi(value);
         }
+        else if (strcmp(param, "drive") == 0) {
+            drive = atoi(value);
+        }
         else if (strcmp(param, "passes") == 0) {
             passes = atoi(value);
         }
@@ -152,11 +211,11 @@ static int cmd_fluxstat_capture(int argc, char *argv[])
         fluxstat_configure(&config);
     }
 
-    uart_printf("\nCapturing track %d, head %d with %d passes...\n",
-                track, head, config.pass_count);
+    uart_printf("\nCapturing drive %d track %d, head %d with %d passes...\n",
+                drive, track, head, config.pass_count);
 
     /* Start capture */
-    int ret = fluxstat_capture_start(0, track, head);
+    int ret = fluxstat_capture_start(drive, track, head);
     if (ret != FLUXSTAT_OK) {
         uart_printf("Failed to start capture: %d\n", ret);
         return -1;
@@ -173,8 +232,8 @@ static int cmd_fluxstat_capture(int argc, char *argv[])
             last_pass = current;
         }
 
-        /* Small delay */
-        for (volatile int i = 0; i < 100000; i++);
+        /* Let the host link and other tasks run meanwhile */
+        task_yield();
     }
 
     uart_puts("\n");
@@ -241,6 +300,27 @@ static int cmd_fluxstat_histogram(int argc, char *argv[])
         return -1;
     }
 
+    static uint16_t bins[FLUXSTAT_HIST_BINS];
+    fluxstat_histogram_read_all(bins);
+
+    if (cli_bin_active()) {
+        uint32_t rate;
+
+        cli_bin_uint("total_count", hist.total_count);
+        cli_bin_uint("interval_min", hist.interval_min);
+        cli_bin_uint("interval_max", hist.interval_max);
+        cli_bin_uint("peak_bin", hist.peak_bin);
+        cli_bin_uint("peak_count", hist.peak_count);
+        cli_bin_uint("mean_interval", hist.mean_interval);
+        cli_bin_uint("overflow_count", hist.overflow_count);
+        cli_bin_uint("bin_shift", FLUXSTAT_HIST_BIN_SHIFT);
+        if (fluxstat_estimate_rate(&rate) == FLUXSTAT_OK) {
+            cli_bin_uint("rate_bps", rate);
+        }
+        cli_bin_u16_array("bins", bins, FLUXSTAT_HIST_BINS);
+        return 0;
+    }
+
     uart_puts("\nFlux Interval Histogram\n");
     print_separator();
     uart_printf("  Total Count:    %lu transitions\n", hist.total_count);
@@ -269,15 +349,12 @@ static int cmd_fluxstat_histogram(int argc, char *argv[])
     /* Find max in range for scaling */
     uint16_t max_count = 1;
     for (int b = start_bin; b <= end_bin; b++) {
-        uint16_t count;
-        fluxstat_histogram_read_bin(b, &count);
-        if (count > max_count) max_count = count;
+        if (bins[b] > max_count) max_count = bins[b];
     }
 
     /* Draw bins */
     for (int b = start_bin; b <= end_bin; b += 2) {
-        uint16_t count;
-        fluxstat_histogram_read_bin(b, &count);
+        uint16_t count = bins[b];
 
         int bars = (count * 40) / max_count;
         uart_printf("  %3d: ", b);
@@ -346,7 +423,7 @@ static int cmd_fluxstat_analyze(int argc, char *argv[])
         }
 
         uart_printf("  %2d   %4d   %s   %3d%%   %2d    %2d    %s\n",
-                    s, sec->size,
+                    sec->sector_id, sec->size,
                     sec->crc_ok ? "OK " : "BAD",
                     sec->confidence_avg,
                     sec->weak_bit_count,
@@ -365,16 +442,57 @@ static int cmd_fluxstat_analyze(int argc, char *argv[])
 static int cmd_fluxstat_recover(int argc, char *argv[])
 {
     if (argc < 2) {
-        uart_puts("Usage: fluxstat recover <sector>\n");
+        uart_puts("Usage: fluxstat recover <sector> [recapture=N] [drive=N]\n");
+        uart_puts("  recapture=N  First re-read just this sector N times\n");
+        uart_puts("  drive=N      Drive of the track capture (default 0)\n");
         return 0;
     }
 
     uint8_t sector = atoi(argv[1]);
+    uint8_t drive = 0;
+    uint8_t recapture = 0;
+    int ret;
+
+    for (int i = 2; i < argc; i++) {
+        char *param = argv[i];
+        char *value = strchr(param, '=');
+        if (!value) continue;
+        *value++ = '\0';
+
+        if (strcmp(param, "drive") == 0) {
+            drive = atoi(value);
+        }
+        else if (strcmp(param, "recapture") == 0) {
+            recapture = atoi(value);
+        }
+    }
+
+    /* Windowed re-capture of the sector from the last track capture */
+    if (recapture > 0) {
+        uart_printf("\nRe-capturing sector %d with %d passes...\n", sector, recapture);
+
+        ret = fluxstat_capture_sector(drive, sector, recapture);
+        if (ret != FLUXSTAT_OK) {
+            uart_printf("Failed to start re-capture: %d\n", ret);
+            return -1;
+        }
+        while (fluxstat_capture_busy()) {
+            task_yield();
+        }
+
+        fluxstat_capture_t capture;
+        ret = fluxstat_capture_result(&capture);
+        if (ret != FLUXSTAT_OK) {
+            uart_printf("Re-capture failed: %d\n", ret);
+            return -1;
+        }
+        uart_printf("  %d passes, %lu transitions\n", capture.pass_count, capture.total_flux);
+    }
 
     uart_printf("\nRecovering sector %d...\n", sector);
 
     fluxstat_sector_t result;
-    int ret = fluxstat_recover_sector(sector, &result);
+    ret = fluxstat_recover_sector(sector, &result);
     if (ret != FLUXSTAT_OK) {
         uart_printf("Recovery failed: %d\n", ret);
         return -1;
@@ -495,6 +613,30 @@ static int cmd_fluxstat_status(int argc, char *argv[])
     (void)argc;
     (void)argv;
 
+    if (cli_bin_active()) {
+        fluxstat_capture_t result;
+        fluxstat_histogram_t hist;
+        uint8_t current, total;
+
+        cli_bin_bool("busy", fluxstat_capture_busy());
+        if (fluxstat_capture_busy()) {
+            fluxstat_capture_progress(&current, &total);
+            cli_bin_uint("pass", current);
+            cli_bin_uint("passes", total);
+        } else if (fluxstat_capture_result(&result) == FLUXSTAT_OK) {
+            cli_bin_uint("pass_count", result.pass_count);
+            cli_bin_uint("total_flux", result.total_flux);
+            cli_bin_uint("min_flux", result.min_flux);
+            cli_bin_uint("max_flux", result.max_flux);
+            cli_bin_uint("total_time", result.total_time);
+        }
+        if (fluxstat_histogram_stats(&hist) == FLUXSTAT_OK) {
+            cli_bin_uint("hist_count", hist.total_count);
+            cli_bin_uint("peak_interval", hist.peak_bin << FLUXSTAT_HIST_BIN_SHIFT);
+        }
+        return 0;
+    }
+
     uart_puts("\nFluxStat Status\n");
     print_separator();
 
@@ -540,62 +682,234 @@ static int cmd_fluxstat_clear(int argc, char *argv[])
 }
 
 /*============================================================================
- * Main FluxStat Command Dispatcher
+ * fluxstat format - Automatic Encoding Session
+ *============================================================================*/
+
+static int cmd_fluxstat_format(int argc, char *argv[])
+{
+    uint8_t drive = argc > 1 ? (uint8_t)atoi(argv[1]) : 0;
+    fmtc_format_t fmt;
+    fmtc_stats_t st;
+
+    if (drive >= FMTC_DRIVES) {
+        uart_puts("Usage: fluxstat format [drive] [reset]\n");
+        return -1;
+    }
+    if (argc > 2 && strcmp(argv[2], "reset") == 0) {
+        fmtc_reset(drive);
+        uart_printf("Format session of drive %d reset.\n", drive);
+        return 0;
+    }
+
+    fmtc_get_stats(drive, &st);
+    uart_printf("\nFormat Session (drive %d)\n", drive);
+    print_separator();
+    if (fmtc_get(drive, &fmt)) {
+        uart_printf("  Encoding:       %s, %lu bps\n", enc_name(fmt.encoding), fmt.data_rate);
+        uart_printf("  Sectors:        %d-%d (%d seen), size code %d\n",
+                    fmt.first_sector, fmt.last_sector, fmt.sectors, fmt.size_code);
+    } else {
+        uart_puts("  Encoding:       none cached\n");
+    }
+    uart_printf("  Tracks:         %lu (%lu predicted, %lu probed)\n",
+                st.tracks, st.hits, st.probes);
+    uart_printf("  Mismatches:     %lu (%lu unidentified)\n", st.mismatches, st.unknown);
+    print_separator();
+    return 0;
+}
+
+/*============================================================================
+ * fluxstat pllcal - PLL Bandwidth/Damping Search
+ *============================================================================*/
+
+static int cmd_fluxstat_pllcal(int argc, char *argv[])
+{
+    static pllcal_results_t results;
+
+    if (argc < 2) {
+        uart_puts("Usage: fluxstat pllcal <drive> [track|all] [head=N] [save]\n");
+        uart_puts("  drive     Drive number (0-3)\n");
+        uart_puts("  track     Sweep one track and show every candidate\n");
+        uart_puts("  all       Calibrate every zone (default)\n");
+        uart_puts("  save      Write the calibration to EEPROM afterwards\n");
+        return 0;
+    }
+
+    uint8_t drive = atoi(argv[1]);
+    uint8_t head = 0;
+    int track = -1;
+    bool save = false;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "save") == 0) {
+            save = true;
+        } else if (strncmp(argv[i], "head=", 5) == 0) {
+            head = atoi(argv[i] + 5);
+        } else if (strcmp(argv[i], "all") != 0) {
+            track = atoi(argv[i]);
+        }
+    }
+
+    int ret;
+    if (track >= 0) {
+        ret = pllcal_calibrate_track(drive, (uint8_t)track, head, &results);
+        if (ret == FLUXSTAT_OK) {
+            uint32_t best = pllcal_best(&results);
+
+            uart_printf("\nDrive %d track %d, %u passes:\n", drive, track,
+                        (unsigned)results.passes);
+            uart_puts("  BW(pm)  Damp   IDs  Sectors  Phase RMS\n");
+            for (uint32_t c = 0; c < PLLCAL_CANDIDATES; c++) {
+                const pllcal_result_t *r = &results.cand[c];
+
+                uart_printf("  %6u  %4u  %4u  %7u  %5u/256%s\n", r->bandwidth_pm,
+                            r->damping, (unsigned)r->ids, (unsigned)r->sectors,
+                            r->phase_rms, c == best ? "  <" : "");
+            }
+        }
+    } else {
+        uart_printf("Calibrating drive %d, %d zones...\n", drive, DIAG_CAL_ZONES);
+        ret = pllcal_calibrate_drive(drive, head);
+    }
+    if (ret != FLUXSTAT_OK) {
+        uart_printf("Calibration failed: %d\n", ret);
+        return -1;
+    }
+
+    const diag_cal_record_t *rec = pllcal_record(drive);
+    print_separator();
+    uart_puts("Zone  Tracks  BW(pm)  Damp  Sectors  Phase RMS\n");
+    for (int z = 0; z < DIAG_CAL_ZONES; z++) {
+        const diag_pll_cal_t *c = &rec->zone[z];
+
+        if (c->bandwidth_pm == 0) {
+            uart_printf("%4d  %2d-%-3d      --\n", z, z * DIAG_CAL_ZONE_TRACKS,
+                        (z + 1) * DIAG_CAL_ZONE_TRACKS - 1);
+            continue;
+        }
+        uart_printf("%4d  %2d-%-3d  %6u  %4u  %7u  %5u/256\n", z,
+                    z * DIAG_CAL_ZONE_TRACKS, (z + 1) * DIAG_CAL_ZONE_TRACKS - 1,
+                    c->bandwidth_pm, c->damping, c->sectors, c->phase_rms);
+    }
+
+    if (save) {
+        ret = pllcal_save();
+        uart_puts(ret == HAL_OK ? "Saved to EEPROM.\n" : "EEPROM write failed.\n");
+    }
+    return 0;
+}
+
+/*============================================================================
+ * fluxstat precomp - Write Precompensation Search
  *============================================================================*/
 
-int cmd_fluxstat(int argc, char *argv[])
+static int cmd_fluxstat_precomp(int argc, char *argv[])
 {
+    static pcal_results_t results;
+
     if (argc < 2) {
-        uart_puts("FluxStat Statistical Recovery Commands:\n");
-        uart_puts("  fluxstat config    - Show/set configuration\n");
-        uart_puts("  fluxstat capture   - Multi-pass flux capture\n");
-        uart_puts("  fluxstat histogram - Display flux histogram\n");
-        uart_puts("  fluxstat analyze   - Analyze captured data\n");
-        uart_puts("  fluxstat recover   - Recover specific sector\n");
-        uart_puts("  fluxstat map       - Display bit confidence map\n");
-        uart_puts("  fluxstat status    - Show current status\n");
-        uart_puts("  fluxstat clear     - Clear captured data\n");
+        uart_puts("Usage: fluxstat precomp <drive> [track|all] [head=N] [save]\n");
+        uart_puts("  drive     Drive number (0-1)\n");
+        uart_puts("  track     Sweep one track and show every setting\n");
+        uart_puts("  all       Calibrate every zone (default)\n");
+        uart_puts("  save      Write the calibration to EEPROM afterwards\n");
+        uart_puts("Overwrites the calibration tracks: use scratch media.\n");
         return 0;
     }
 
-    /* Dispatch to subcommand */
-    if (strcmp(argv[1], "config") == 0) {
-        return cmd_fluxstat_config(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "capture") == 0) {
-        return cmd_fluxstat_capture(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "histogram") == 0 || strcmp(argv[1], "hist") == 0) {
-        return cmd_fluxstat_histogram(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "analyze") == 0) {
-        return cmd_fluxstat_analyze(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "recover") == 0) {
-        return cmd_fluxstat_recover(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "map") == 0) {
-        return cmd_fluxstat_map(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "status") == 0) {
-        return cmd_fluxstat_status(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "clear") == 0) {
-        return cmd_fluxstat_clear(argc - 1, &argv[1]);
+    uint8_t drive = atoi(argv[1]);
+    uint8_t head = 0;
+    int track = -1;
+    bool save = false;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "save") == 0) {
+            save = true;
+        } else if (strncmp(argv[i], "head=", 5) == 0) {
+            head = atoi(argv[i] + 5);
+        } else if (strcmp(argv[i], "all") != 0) {
+            track = atoi(argv[i]);
+        }
+    }
+
+    int ret;
+    if (track >= 0) {
+        ret = pcal_calibrate_track(drive, (uint8_t)track, head, &results);
+        if (ret == FLUXSTAT_OK) {
+            uint32_t best = pcal_best(&results);
+
+            uart_printf("\nDrive %d track %d, %u sectors written per setting:\n",
+                        drive, track, (unsigned)results.sectors);
+            uart_puts("  Precomp  Sectors  2T shift  4T shift (1/256 cell)\n");
+            for (uint32_t c = 0; c < PCAL_SETTINGS; c++) {
+                const pcal_result_t *r = &results.cand[c];
+
+                uart_printf("  %4u ns  %7u  %8d  %8d%s\n", r->precomp_ns,
+                            (unsigned)r->sectors, r->shift2, r->shift4,
+                            c == best ? "  <" : "");
+            }
+        }
     } else {
-        uart_printf("Unknown fluxstat command: %s\n", argv[1]);
-        uart_puts("Type 'fluxstat' for available commands.\n");
+        uart_printf("Calibrating drive %d, %d zones...\n", drive, DIAG_CAL_ZONES);
+        ret = pcal_calibrate_drive(drive, head);
+    }
+    if (ret != FLUXSTAT_OK) {
+        uart_printf("Calibration failed: %d\n", ret);
         return -1;
     }
+
+    print_separator();
+    uart_puts("Zone  Tracks  Code  2T shift\n");
+    for (int z = 0; z < DIAG_CAL_ZONES; z++) {
+        const diag_precomp_cal_t *c = pcal_lookup(drive, (uint8_t)(z * DIAG_CAL_ZONE_TRACKS));
+
+        if (c == NULL) {
+            uart_printf("%4d  %2d-%-3d    --\n", z, z * DIAG_CAL_ZONE_TRACKS,
+                        (z + 1) * DIAG_CAL_ZONE_TRACKS - 1);
+            continue;
+        }
+        uart_printf("%4d  %2d-%-3d  %4u  %8d\n", z, z * DIAG_CAL_ZONE_TRACKS,
+                    (z + 1) * DIAG_CAL_ZONE_TRACKS - 1,
+                    c->code & ~DIAG_PRECOMP_VALID, c->shift);
+    }
+
+    if (save) {
+        ret = pllcal_save();
+        uart_puts(ret == HAL_OK ? "Saved to EEPROM.\n" : "EEPROM write failed.\n");
+    }
+    return 0;
 }
 
 /*============================================================================
  * CLI Registration
  *============================================================================*/
 
+static const cli_cmd_t fluxstat_subcmds[] = {
+    { "config",    "Show/set configuration",                   cmd_fluxstat_config, 0, NULL },
+    { "capture",   "Multi-pass flux capture",                  cmd_fluxstat_capture, 0, NULL },
+    { "histogram", "Display flux histogram",                   cmd_fluxstat_histogram, 0, NULL },
+    { "hist",      "Alias for histogram",                      cmd_fluxstat_histogram, 0, NULL },
+    { "analyze",   "Analyze captured data",                    cmd_fluxstat_analyze, 0, NULL },
+    { "recover",   "Recover specific sector (optional re-capture)", cmd_fluxstat_recover, 0, NULL },
+    { "map",       "Display bit confidence map",               cmd_fluxstat_map, 0, NULL },
+    { "status",    "Show current status",                      cmd_fluxstat_status, 0, NULL },
+    { "clear",     "Clear captured data",                      cmd_fluxstat_clear, 0, NULL },
+    { "pllcal",    "Search PLL bandwidth/damping per zone",    cmd_fluxstat_pllcal, 0, NULL },
+    { "precomp",   "Calibrate write precompensation per zone (destructive)", cmd_fluxstat_precomp, 0, NULL },
+    { "format",    "Show/reset the automatic encoding session", cmd_fluxstat_format, 0, NULL },
+    { NULL, NULL, NULL, 0, NULL }
+};
+
 const cli_cmd_t fluxstat_cli_cmd = {
     "fluxstat", "Statistical flux recovery (capture, analyze, recover)",
-    cmd_fluxstat
+    NULL,
+    CLI_CMD_DRIVES,
+    fluxstat_subcmds
 };
+CLI_COMMAND(fluxstat_cli_cmd);
 
 void fluxstat_cli_init(void)
 {
     /* Initialize FluxStat HAL */
     fluxstat_init();
-
-    /* Register CLI command */
-    cli_register(&fluxstat_cli_cmd);
 }
@@ -9,6 +9,10 @@
 
 #include "fluxstat_hal.h"
 #include "fluxripper_hal.h"
+#include "flux_decode.h"
+#include "format_cache.h"
+#include "crc16.h"
+#include "raw_protocol.h"
 #include "timer.h"
 #include <string.h>
 
@@ -23,14 +27,78 @@ static fluxstat_config_t g_config = {
     .encoding = ENC_MFM,
     .data_rate = 250000,
     .use_crc_correction = true,
-    .preserve_weak_bits = true
+    .preserve_weak_bits = true,
+    .adaptive = false,
+    .adaptive_stall = FLUXSTAT_DEFAULT_STALL
 };
 
 static bool g_initialized = false;
 
-/* Cache of last capture result */
-static fluxstat_capture_t g_last_capture;
-static bool g_capture_valid = false;
+/* Histogram bank mode bits kept across the HIST_CTRL rewrites */
+static uint32_t g_hist_banks = 0;
+
+/* Per-interface capture state */
+typedef struct {
+    fluxstat_capture_t capture;     /* Last result read back */
+    bool     valid;                 /* capture holds a finished capture */
+    uint8_t  drive;                 /* Drive, track and head of the capture */
+    uint8_t  track;
+    uint8_t  head;
+    uint32_t stride;                /* Bytes between pass buffers */
+    ddr_buf_t *buf;                 /* Arena run holding the passes */
+    uint8_t  encoding;              /* Format decoded as (ENC_UNKNOWN: not resolved) */
+    uint32_t data_rate;
+
+    /* Sector window re-capture (see fluxstat_capture_sector) */
+    bool     windowed;              /* Passes hold one sector window */
+    uint8_t  window_sector;         /* Sector the window was placed on */
+
+    /* Adaptive pass count */
+    uint8_t  evaluated;             /* Passes covered by the last check */
+    uint8_t  best_good;             /* Most CRC-good sectors so far */
+    uint8_t  best_found;            /* Most sectors found so far */
+    uint8_t  stall;                 /* Checks since the last gain */
+    bool     early;                 /* Stopped before pass_count */
+} fluxstat_iface_t;
+
+static fluxstat_iface_t g_if[FLUXSTAT_INTERFACES];
+
+/* Interface the capture, histogram and analysis calls act on */
+static uint8_t g_sel = 0;
+static fluxstat_iface_t *g_cur = &g_if[0];
+
+/* Streaming correlator state (one cursor per pass) */
+typedef struct {
+    const uint32_t *data;           /* Pass flux words */
+    uint32_t count;                 /* Words in pass */
+    uint32_t start;                 /* First word after the index mark */
+    uint32_t pos;                   /* Next unread word */
+    uint32_t origin;                /* Timestamp of the index mark */
+    uint32_t scale;                 /* Q16 time scale to the reference revolution */
+    int32_t  align;                 /* Initial phase from pass alignment (clocks) */
+    int32_t  phase;                 /* Tracked cell phase vs. nominal (clocks) */
+} flux_cursor_t;
+
+/* Per-pass clock phase snapshot for seeking into a revolution */
+typedef struct {
+    int32_t  base;                  /* Phase of the first pass (clocks) */
+    int16_t  delta[FLUXSTAT_MAX_PASSES];  /* Other passes relative to base */
+} corr_ckpt_t;
+
+static struct {
+    flux_cursor_t cursor[FLUXSTAT_MAX_PASSES];
+    uint8_t  pass_count;            /* Passes with data */
+    uint32_t cell_ticks;            /* Nominal bitcell width (clocks) */
+    uint32_t next_bit;              /* Bitcell the cursors are positioned at */
+    uint32_t track_cells;           /* Bitcells in one revolution */
+    bool     valid;                 /* Cursors match g_cur->capture */
+} g_corr;
+
+/* Per-track sector index built by the track decoder */
+static fluxstat_track_index_t g_index;
+
+/* Per-pass phase checkpoint at each indexed data field */
+static corr_ckpt_t g_index_ckpt[FLUXSTAT_MAX_SECTORS];
 
 /*============================================================================
  * Initialization
@@ -43,18 +111,23 @@ int fluxstat_init(void)
     }
 
     /* Clear control registers */
-    FLUXSTAT_MP_CTRL = 0;
-    FLUXSTAT_HIST_CTRL = HIST_CTRL_CLEAR;
+    for (uint8_t i = 0; i < FLUXSTAT_INTERFACES; i++) {
+        FLUXSTAT_MP_CTRL(i) = 0;
+        FLUXSTAT_HIST_CTRL(i) = HIST_CTRL_CLEAR;
+    }
 
     /* Small delay for clear to take effect */
     timer_delay_us(10);
 
-    FLUXSTAT_HIST_CTRL = 0;
-
-    /* Set default base address (after HyperRAM reserved areas) */
-    FLUXSTAT_MP_BASE_ADDR = 0x100000;  /* 1MB offset */
+    /* Pass buffers are allocated per capture from the DDR arena */
+    ddr_init();
+    for (uint8_t i = 0; i < FLUXSTAT_INTERFACES; i++) {
+        FLUXSTAT_HIST_CTRL(i) = 0;
+        g_if[i].stride = FLUXSTAT_PASS_SIZE;
+        g_if[i].buf = NULL;
+        g_if[i].valid = false;
+    }
 
-    g_capture_valid = false;
     g_initialized = true;
 
     return FLUXSTAT_OK;
@@ -75,7 +148,15 @@ int fluxstat_configure(const fluxstat_config_t *config)
         return FLUXSTAT_ERR_INVALID;
     }
 
+    if (config->adaptive &&
+        (config->adaptive_stall < 1 || config->adaptive_stall > 16)) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
     memcpy(&g_config, config, sizeof(fluxstat_config_t));
+
+    /* A new job: automatic encoding starts a fresh format session */
+    fmtc_reset(FMTC_ALL_DRIVES);
     return FLUXSTAT_OK;
 }
 
@@ -93,19 +174,113 @@ int fluxstat_get_config(fluxstat_config_t *config)
  * Multi-Pass Capture
  *============================================================================*/
 
-int fluxstat_capture_start(uint8_t drive, uint8_t track, uint8_t head)
+int fluxstat_select(uint8_t iface)
+{
+    if (iface >= FLUXSTAT_INTERFACES) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
+    /* Correlator and sector index describe the selected capture only */
+    if (iface != g_sel) {
+        g_sel = iface;
+        g_cur = &g_if[iface];
+        g_corr.valid = false;
+        g_index.valid = false;
+    }
+
+    return FLUXSTAT_OK;
+}
+
+uint8_t fluxstat_selected(void)
+{
+    return g_sel;
+}
+
+/**
+ * Internal: Pass stride for full revolutions of a drive's next track
+ *
+ * One flux word per data bit (two for FM) over the longest revolution.
+ * ENC_UNKNOWN takes the session's cached format; a track denser than
+ * the prediction is truncated and its probe corrects the next stride.
+ * Without a session the stride covers ED.
+ */
+static uint32_t rev_stride(uint8_t drive)
+{
+    uint8_t encoding = g_config.encoding;
+    uint32_t rate = g_config.data_rate;
+    fmtc_format_t fmt;
+
+    if (encoding == ENC_UNKNOWN) {
+        if (fmtc_get(drive, &fmt)) {
+            encoding = fmt.encoding;
+            rate = fmt.data_rate;
+        } else {
+            encoding = ENC_MFM;
+            rate = FLUXSTAT_RATE_MAX;
+        }
+    }
+
+    uint32_t words = rate / 1000 * FLUXSTAT_REV_MS_MAX;
+    if (encoding == ENC_FM) {
+        words *= 2;
+    }
+    return ((words + 2) * 4 + FLUXSTAT_STRIDE_ALIGN - 1) &
+           ~(uint32_t)(FLUXSTAT_STRIDE_ALIGN - 1);
+}
+
+/**
+ * Internal: Allocate the pass buffers of an interface's next capture
+ *
+ * The interface's reference to its last capture is dropped first so the
+ * run can be reused, unless fluxstat_capture_buffer() handed it out.
+ * The pass count shrinks to what the longest free run holds.
+ */
+static int alloc_passes(uint8_t iface, uint8_t *passes, uint32_t stride)
+{
+    ddr_release(g_if[iface].buf);
+    g_if[iface].buf = NULL;
+    g_if[iface].valid = false;
+
+    uint32_t fit = ddr_largest_free() / stride;
+    if (fit < FLUXSTAT_MIN_PASSES) {
+        return FLUXSTAT_ERR_OVERFLOW;
+    }
+    if (*passes > fit) {
+        *passes = (uint8_t)fit;
+    }
+
+    g_if[iface].buf = ddr_alloc((uint32_t)*passes * stride);
+    return g_if[iface].buf ? FLUXSTAT_OK : FLUXSTAT_ERR_OVERFLOW;
+}
+
+/**
+ * Internal: Seek and arm the multipass engine of the drive's interface
+ * @param win_start window start in clocks after index (0 with win_len 0)
+ * @param win_len window length in clocks, 0 for full revolutions
+ * @param stride bytes between pass buffers
+ */
+static int begin_capture(uint8_t drive, uint8_t track, uint8_t head,
+                         uint8_t passes, uint32_t win_start, uint32_t win_len,
+                         uint32_t stride)
 {
-    if (!g_initialized) {
+    uint8_t iface = FLUXSTAT_DRIVE_IF(drive);
+
+    if (!g_initialized || iface >= FLUXSTAT_INTERFACES) {
         return FLUXSTAT_ERR_INVALID;
     }
 
-    /* Check if already busy */
-    if (FLUXSTAT_MP_STATUS & MP_STATUS_BUSY) {
+    /* Check if already busy (the other interface may be) */
+    if (FLUXSTAT_MP_STATUS(iface) & MP_STATUS_BUSY) {
         return FLUXSTAT_ERR_BUSY;
     }
 
+    int ret = alloc_passes(iface, &passes, stride);
+    if (ret != FLUXSTAT_OK) {
+        return ret;
+    }
+
     /* Seek to track first */
-    int ret = hal_motor_on(drive);
+    ret = hal_motor_on(drive);
     if (ret != HAL_OK) {
         return FLUXSTAT_ERR_INVALID;
     }
@@ -116,34 +291,82 @@ int fluxstat_capture_start(uint8_t drive, uint8_t track, uint8_t head)
     }
 
     /* Clear histogram for fresh capture */
-    FLUXSTAT_HIST_CTRL = HIST_CTRL_CLEAR;
+    FLUXSTAT_HIST_CTRL(iface) = HIST_CTRL_CLEAR;
     timer_delay_us(10);
-    FLUXSTAT_HIST_CTRL = HIST_CTRL_ENABLE;
+    FLUXSTAT_HIST_CTRL(iface) = HIST_CTRL_ENABLE | g_hist_banks;
+
+    /* Buffer, window and stride are latched by the start pulse */
+    FLUXSTAT_MP_BASE_ADDR(iface) = g_if[iface].buf->addr;
+    FLUXSTAT_MP_WIN_START(iface) = win_start;
+    FLUXSTAT_MP_WIN_LEN(iface) = win_len;
+    FLUXSTAT_MP_STRIDE(iface) = stride;
 
     /* Start multipass capture */
     uint32_t ctrl = MP_CTRL_START |
-                    ((g_config.pass_count << MP_CTRL_PASS_COUNT_SHIFT) &
+                    ((passes << MP_CTRL_PASS_COUNT_SHIFT) &
                      MP_CTRL_PASS_COUNT_MASK);
-    FLUXSTAT_MP_CTRL = ctrl;
+    FLUXSTAT_MP_CTRL(iface) = ctrl;
+
+    g_if[iface].drive = drive;
+    g_if[iface].track = track;
+    g_if[iface].head = head;
+    g_if[iface].stride = stride;
+    if (win_len == 0) {
+        /* A window keeps the format of the capture it was placed from */
+        g_if[iface].encoding = g_config.encoding;
+        g_if[iface].data_rate = g_config.data_rate;
+    }
+    g_if[iface].windowed = (win_len != 0);
+    g_if[iface].valid = false;
+    g_if[iface].evaluated = 0;
+    g_if[iface].best_good = 0;
+    g_if[iface].best_found = 0;
+    g_if[iface].stall = 0;
+    g_if[iface].early = false;
 
-    g_capture_valid = false;
+    /* Follow-up calls act on the capture just started */
+    fluxstat_select(iface);
 
     return FLUXSTAT_OK;
 }
 
+int fluxstat_capture_start(uint8_t drive, uint8_t track, uint8_t head)
+{
+    return begin_capture(drive, track, head, g_config.pass_count,
+                         0, 0, rev_stride(drive));
+}
+
+ddr_buf_t *fluxstat_capture_buffer(void)
+{
+    if (!g_cur->valid || g_cur->buf == NULL) {
+        return NULL;
+    }
+
+    ddr_retain(g_cur->buf);
+    return g_cur->buf;
+}
+
 int fluxstat_capture_abort(void)
 {
-    FLUXSTAT_MP_CTRL = MP_CTRL_ABORT;
-    FLUXSTAT_HIST_CTRL = 0;  /* Disable histogram */
+    FLUXSTAT_MP_CTRL(g_sel) = MP_CTRL_ABORT;
+    FLUXSTAT_HIST_CTRL(g_sel) = 0;  /* Disable histogram */
 
     /* Wait for abort to complete */
     uint32_t timeout = 1000;
-    while ((FLUXSTAT_MP_STATUS & MP_STATUS_BUSY) && timeout > 0) {
+    while ((FLUXSTAT_MP_STATUS(g_sel) & MP_STATUS_BUSY) && timeout > 0) {
         timer_delay_us(100);
         timeout--;
     }
 
-    g_capture_valid = false;
+    g_cur->valid = false;
+    g_cur->early = false;
+    hal_motor_release(g_cur->drive);
+
+    /* Nothing to keep: give the passes back to the arena */
+    if (timeout != 0) {
+        ddr_release(g_cur->buf);
+        g_cur->buf = NULL;
+    }
 
     if (timeout == 0) {
         return FLUXSTAT_ERR_TIMEOUT;
@@ -152,9 +375,99 @@ int fluxstat_capture_abort(void)
     return FLUXSTAT_OK;
 }
 
+/**
+ * Internal: Read capture metadata for the first 'passes' passes
+ */
+static void read_capture(fluxstat_capture_t *result, uint8_t passes)
+{
+    result->pass_count = passes;
+    result->total_flux = FLUXSTAT_MP_TOTAL_FLUX(g_sel);
+    result->min_flux = FLUXSTAT_MP_MIN_FLUX(g_sel);
+    result->max_flux = FLUXSTAT_MP_MAX_FLUX(g_sel);
+    result->total_time = FLUXSTAT_MP_TOTAL_TIME(g_sel);
+    result->base_addr = FLUXSTAT_MP_BASE_ADDR(g_sel);
+
+    /* Read per-pass data */
+    for (int i = 0; i < result->pass_count && i < FLUXSTAT_MAX_PASSES; i++) {
+        result->passes[i].flux_count = FLUXSTAT_PASS_FLUX(g_sel, i);
+        result->passes[i].index_time = FLUXSTAT_PASS_TIME(g_sel, i);
+        result->passes[i].base_addr = result->base_addr + (i * g_cur->stride);
+        result->passes[i].data_size = result->passes[i].flux_count * 4;  /* 4 bytes per flux */
+    }
+}
+
+static int build_track_index(fluxstat_track_t *result);
+
+/**
+ * Internal: Adaptive pass count check on the selected interface
+ *
+ * Decodes the passes completed so far (their memory no longer changes
+ * while the engine fills the next one) and stops the engine when more
+ * passes are not paying off.
+ */
+static void adapt_step(void)
+{
+    uint32_t status = FLUXSTAT_MP_STATUS(g_sel);
+    uint8_t done = (status & MP_STATUS_COMPLETE_MASK) >> MP_STATUS_COMPLETE_SHIFT;
+
+    if (!g_config.adaptive || !(status & MP_STATUS_BUSY) ||
+        done < FLUXSTAT_MIN_PASSES || done <= g_cur->evaluated) {
+        return;
+    }
+    g_cur->evaluated = done;
+
+    read_capture(&g_cur->capture, done);
+    g_cur->valid = true;
+    g_corr.valid = false;
+    g_index.valid = false;
+
+    if (build_track_index(NULL) != FLUXSTAT_OK) {
+        g_cur->valid = false;
+        return;
+    }
+
+    /* A sector window only has to deliver its own sector */
+    uint8_t found = 0;
+    uint8_t good = 0;
+    for (int s = 0; s < g_index.count; s++) {
+        if (g_cur->windowed && g_index.sectors[s].sector != g_cur->window_sector) {
+            continue;
+        }
+        found++;
+        if (g_index.sectors[s].data_bit != 0 && g_index.sectors[s].data_crc_ok) {
+            good++;
+        }
+    }
+
+    bool stop = false;
+    if (found > 0 && good == found) {
+        stop = true;                    /* Every sector reads clean */
+    } else if (good > g_cur->best_good || found > g_cur->best_found) {
+        g_cur->best_good = good > g_cur->best_good ? good : g_cur->best_good;
+        g_cur->best_found = found > g_cur->best_found ? found : g_cur->best_found;
+        g_cur->stall = 0;
+    } else if (++g_cur->stall >= g_config.adaptive_stall) {
+        stop = true;                    /* Converged: more passes add nothing */
+    }
+
+    if (!stop) {
+        g_cur->valid = false;           /* Still capturing */
+        return;
+    }
+
+    /* Keep the passes decoded above; the index built for them stays valid */
+    FLUXSTAT_MP_CTRL(g_sel) = MP_CTRL_ABORT;
+    for (uint32_t timeout = 1000;
+         (FLUXSTAT_MP_STATUS(g_sel) & MP_STATUS_BUSY) && timeout > 0; timeout--) {
+        timer_delay_us(100);
+    }
+    g_cur->early = true;
+}
+
 bool fluxstat_capture_busy(void)
 {
-    return (FLUXSTAT_MP_STATUS & MP_STATUS_BUSY) != 0;
+    adapt_step();
+    return (FLUXSTAT_MP_STATUS(g_sel) & MP_STATUS_BUSY) != 0;
 }
 
 int fluxstat_capture_wait(uint32_t timeout_ms)
@@ -168,8 +481,16 @@ int fluxstat_capture_wait(uint32_t timeout_ms)
         timer_delay_us(1000);  /* 1ms polling */
     }
 
+    /* Passes done: the motor idles out unless the next pass reuses it */
+    hal_motor_release(g_cur->drive);
+
+    /* Stopped early on purpose */
+    if (g_cur->early) {
+        return FLUXSTAT_OK;
+    }
+
     /* Check for error */
-    if (FLUXSTAT_MP_STATUS & MP_STATUS_ERROR) {
+    if (FLUXSTAT_MP_STATUS(g_sel) & MP_STATUS_ERROR) {
         return FLUXSTAT_ERR_ABORT;
     }
 
@@ -182,39 +503,33 @@ int fluxstat_capture_result(fluxstat_capture_t *result)
         return FLUXSTAT_ERR_INVALID;
     }
 
+    /* Adaptive stop: the result was read when the engine was stopped */
+    if (g_cur->early) {
+        memcpy(result, &g_cur->capture, sizeof(fluxstat_capture_t));
+        return FLUXSTAT_OK;
+    }
+
     /* Check if capture completed */
-    if (!(FLUXSTAT_MP_STATUS & MP_STATUS_DONE)) {
+    if (!(FLUXSTAT_MP_STATUS(g_sel) & MP_STATUS_DONE)) {
         return FLUXSTAT_ERR_NO_DATA;
     }
 
-    uint32_t status = FLUXSTAT_MP_STATUS;
-
-    result->pass_count = (status & MP_STATUS_COMPLETE_MASK) >> MP_STATUS_COMPLETE_SHIFT;
-    result->total_flux = FLUXSTAT_MP_TOTAL_FLUX;
-    result->min_flux = FLUXSTAT_MP_MIN_FLUX;
-    result->max_flux = FLUXSTAT_MP_MAX_FLUX;
-    result->total_time = FLUXSTAT_MP_TOTAL_TIME;
-    result->base_addr = FLUXSTAT_MP_BASE_ADDR;
-
-    /* Read per-pass data */
-    for (int i = 0; i < result->pass_count && i < FLUXSTAT_MAX_PASSES; i++) {
-        result->passes[i].flux_count = FLUXSTAT_PASS_FLUX(i);
-        result->passes[i].index_time = FLUXSTAT_PASS_TIME(i);
-        result->passes[i].base_addr = result->base_addr + (i * FLUXSTAT_PASS_SIZE);
-        result->passes[i].data_size = result->passes[i].flux_count * 4;  /* 4 bytes per flux */
-    }
+    uint32_t status = FLUXSTAT_MP_STATUS(g_sel);
+    read_capture(result, (status & MP_STATUS_COMPLETE_MASK) >> MP_STATUS_COMPLETE_SHIFT);
 
     /* Cache result */
-    memcpy(&g_last_capture, result, sizeof(fluxstat_capture_t));
-    g_capture_valid = true;
+    memcpy(&g_cur->capture, result, sizeof(fluxstat_capture_t));
+    g_cur->valid = true;
+    g_corr.valid = false;
+    g_index.valid = false;
 
     return FLUXSTAT_OK;
 }
 
 int fluxstat_capture_progress(uint8_t *current_pass, uint8_t *total_passes)
 {
-    uint32_t status = FLUXSTAT_MP_STATUS;
-    uint32_t ctrl = FLUXSTAT_MP_CTRL;
+    uint32_t status = FLUXSTAT_MP_STATUS(g_sel);
+    uint32_t ctrl = FLUXSTAT_MP_CTRL(g_sel);
 
     if (current_pass) {
         *current_pass = (status & MP_STATUS_CURRENT_MASK) >> MP_STATUS_CURRENT_SHIFT;
@@ -232,9 +547,9 @@ int fluxstat_capture_progress(uint8_t *current_pass, uint8_t *total_passes)
 
 int fluxstat_histogram_clear(void)
 {
-    FLUXSTAT_HIST_CTRL = HIST_CTRL_CLEAR;
+    FLUXSTAT_HIST_CTRL(g_sel) = HIST_CTRL_CLEAR;
     timer_delay_us(10);
-    FLUXSTAT_HIST_CTRL = 0;
+    FLUXSTAT_HIST_CTRL(g_sel) = g_hist_banks;
     return FLUXSTAT_OK;
 }
 
@@ -244,12 +559,12 @@ int fluxstat_histogram_stats(fluxstat_histogram_t *hist)
         return FLUXSTAT_ERR_INVALID;
     }
 
-    hist->total_count = FLUXSTAT_HIST_TOTAL;
-    hist->interval_min = FLUXSTAT_HIST_MIN & 0xFFFF;
-    hist->interval_max = FLUXSTAT_HIST_MAX & 0xFFFF;
-    hist->peak_bin = FLUXSTAT_HIST_PEAK_BIN & 0xFF;
-    hist->peak_count = (FLUXSTAT_HIST_PEAK_BIN >> 16) & 0xFFFF;
-    hist->mean_interval = FLUXSTAT_HIST_MEAN & 0xFFFF;
+    hist->total_count = FLUXSTAT_HIST_TOTAL(g_sel);
+    hist->interval_min = FLUXSTAT_HIST_MIN(g_sel) & 0xFFFF;
+    hist->interval_max = FLUXSTAT_HIST_MAX(g_sel) & 0xFFFF;
+    hist->peak_bin = FLUXSTAT_HIST_PEAK_BIN(g_sel) & 0xFF;
+    hist->peak_count = (FLUXSTAT_HIST_PEAK_BIN(g_sel) >> 16) & 0xFFFF;
+    hist->mean_interval = FLUXSTAT_HIST_MEAN(g_sel) & 0xFFFF;
     hist->overflow_count = 0;  /* Would need separate register */
 
     return FLUXSTAT_OK;
@@ -261,21 +576,100 @@ int fluxstat_histogram_read_bin(uint8_t bin, uint16_t *count)
         return FLUXSTAT_ERR_INVALID;
     }
 
-    FLUXSTAT_HIST_READ_BIN = bin;
-    timer_delay_us(1);  /* Allow read to complete */
-    *count = FLUXSTAT_HIST_READ_DATA & 0xFFFF;
+    uint32_t pair = FLUXSTAT_HIST_PAIR(g_sel, bin >> 1);
+    *count = (bin & 1) ? (uint16_t)(pair >> 16) : (uint16_t)pair;
+
+    return FLUXSTAT_OK;
+}
+
+int fluxstat_histogram_read_all(uint16_t *bins)
+{
+    if (!bins) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
+    for (int n = 0; n < FLUXSTAT_HIST_BINS / 2; n++) {
+        uint32_t pair = FLUXSTAT_HIST_PAIR(g_sel, n);
+        bins[2 * n] = (uint16_t)pair;
+        bins[2 * n + 1] = (uint16_t)(pair >> 16);
+    }
 
     return FLUXSTAT_OK;
 }
 
 int fluxstat_histogram_snapshot(void)
 {
-    FLUXSTAT_HIST_CTRL |= HIST_CTRL_SNAPSHOT;
+    FLUXSTAT_HIST_CTRL(g_sel) |= HIST_CTRL_SNAPSHOT;
     timer_delay_us(1);
-    FLUXSTAT_HIST_CTRL &= ~HIST_CTRL_SNAPSHOT;
+    FLUXSTAT_HIST_CTRL(g_sel) &= ~HIST_CTRL_SNAPSHOT;
+    return FLUXSTAT_OK;
+}
+
+int fluxstat_histogram_banks(bool enable, bool swap_on_index)
+{
+    g_hist_banks = 0;
+    if (enable) {
+        g_hist_banks = HIST_CTRL_BANKED;
+        if (swap_on_index) {
+            g_hist_banks |= HIST_CTRL_SWAP_INDEX;
+        }
+    }
+
+    uint32_t ctrl = FLUXSTAT_HIST_CTRL(g_sel) & ~(HIST_CTRL_BANKED | HIST_CTRL_SWAP_INDEX);
+    FLUXSTAT_HIST_CTRL(g_sel) = ctrl | g_hist_banks;
+    return FLUXSTAT_OK;
+}
+
+int fluxstat_histogram_swap(void)
+{
+    if (!(g_hist_banks & HIST_CTRL_BANKED)) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
+    FLUXSTAT_HIST_CTRL(g_sel) |= HIST_CTRL_SWAP;
+    FLUXSTAT_HIST_CTRL(g_sel) &= ~HIST_CTRL_SWAP;
     return FLUXSTAT_OK;
 }
 
+int fluxstat_histogram_read_frozen(fluxstat_histogram_t *stats,
+                                   uint16_t *bins, uint16_t *seq)
+{
+    if (!(g_hist_banks & HIST_CTRL_BANKED)) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
+    /* A swap mid-read replaces the frozen bank: read again */
+    for (int attempt = 0; attempt < 3; attempt++) {
+        uint16_t before = FLUXSTAT_BANK_STATUS(g_sel) & BANK_STATUS_SWAPS_MASK;
+        if (before == 0) {
+            return FLUXSTAT_ERR_NO_DATA;
+        }
+
+        if (stats) {
+            uint32_t peak = FLUXSTAT_FRZ_PEAK_BIN(g_sel);
+            stats->total_count = FLUXSTAT_FRZ_TOTAL(g_sel);
+            stats->interval_min = FLUXSTAT_FRZ_MIN(g_sel) & 0xFFFF;
+            stats->interval_max = FLUXSTAT_FRZ_MAX(g_sel) & 0xFFFF;
+            stats->peak_bin = peak & 0xFF;
+            stats->peak_count = (peak >> 16) & 0xFFFF;
+            stats->mean_interval = FLUXSTAT_FRZ_MEAN(g_sel) & 0xFFFF;
+            stats->overflow_count = FLUXSTAT_FRZ_OVERFLOW(g_sel);
+        }
+        if (bins) {
+            fluxstat_histogram_read_all(bins);
+        }
+
+        if ((FLUXSTAT_BANK_STATUS(g_sel) & BANK_STATUS_SWAPS_MASK) == before) {
+            if (seq) {
+                *seq = before;
+            }
+            return FLUXSTAT_OK;
+        }
+    }
+
+    return FLUXSTAT_ERR_BUSY;
+}
+
 /*============================================================================
  * Analysis Functions (Firmware Implementation)
  *============================================================================*/
@@ -285,164 +679,1239 @@ int fluxstat_histogram_snapshot(void)
  */
 static int load_pass_data(uint8_t pass, uint32_t **data, uint32_t *count)
 {
-    if (!g_capture_valid || pass >= g_last_capture.pass_count) {
+    if (!g_cur->valid || pass >= g_cur->capture.pass_count) {
         return FLUXSTAT_ERR_NO_DATA;
     }
 
-    *data = (uint32_t *)(uintptr_t)g_last_capture.passes[pass].base_addr;
-    *count = g_last_capture.passes[pass].flux_count;
+    *data = (uint32_t *)(uintptr_t)g_cur->capture.passes[pass].base_addr;
+    *count = g_cur->capture.passes[pass].flux_count;
 
     return FLUXSTAT_OK;
 }
 
+/*============================================================================
+ * Streaming Pass Correlator
+ *
+ * Each pass is one index-aligned revolution of absolute 27-bit timestamps.
+ * One cursor per pass walks its flux words forward while the correlator
+ * steps through bitcells, so a sweep over N bitcells touches every flux
+ * word once: O(total flux) instead of O(bits x flux).
+ *
+ * Passes are normalized to a common revolution length (index_time), then
+ * slip-aligned against the first pass to absorb index sensor jitter. A
+ * per-pass first-order phase loop follows the remaining wow and flutter.
+ *============================================================================*/
+
 /**
- * Internal: Correlate flux transitions across passes
+ * Internal: Time of a flux word relative to its pass index mark
+ *
+ * A pass never spans more than one revolution (< 2^26 clocks), so the
+ * masked difference is monotonic within a pass even across counter wrap.
+ * Words stamped just before the index mark land in the upper half of the
+ * range and are clamped to zero.
  */
-static int correlate_flux(uint32_t bit_position, fluxstat_correlation_t *corr)
+static inline uint32_t cursor_raw(const flux_cursor_t *c, uint32_t word)
 {
-    /* This is a simplified implementation.
-     * Full implementation would:
-     * 1. Load flux data from all passes
-     * 2. Find transitions within tolerance window around expected position
-     * 3. Calculate statistics (mean, stddev, hit count)
-     */
+    uint32_t rel = (FLUX_TIMESTAMP(word) - c->origin) & FLUX_TIMESTAMP_MASK;
+    return (rel > (FLUX_TIMESTAMP_MASK >> 1)) ? 0 : rel;
+}
 
-    if (!g_capture_valid) {
-        return FLUXSTAT_ERR_NO_DATA;
+/**
+ * Internal: Relative time scaled to the reference revolution length
+ */
+static inline uint32_t cursor_rel(const flux_cursor_t *c, uint32_t word)
+{
+    return (uint32_t)(((uint64_t)cursor_raw(c, word) * c->scale) >> 16);
+}
+
+/* Phase tracking loop gain: phase += offset / CORR_PHASE_DIV */
+#define CORR_PHASE_DIV      8
+
+/* Pass alignment window and maximum slip searched (cells) */
+#define CORR_ALIGN_CELLS    1024
+#define CORR_ALIGN_SLIP     7
+
+/**
+ * Internal: Advance one cursor through one bitcell
+ *
+ * @param center    Nominal cell center (clocks from index)
+ * @param off       Hit offset from the tracked center (valid if hit)
+ * @return true if the pass has a transition in this cell
+ */
+static inline bool cursor_step(flux_cursor_t *c, int32_t center, int32_t *off)
+{
+    int32_t cell = (int32_t)g_corr.cell_ticks;
+    int32_t half = cell / 2;
+    int32_t pc = center + c->phase;
+    int32_t win_lo = pc - half;
+    int32_t win_hi = pc + (cell - half);
+    bool hit = false;
+
+    while (c->pos < c->count) {
+        uint32_t word = c->data[c->pos];
+        int32_t  rel = (int32_t)cursor_rel(c, word);
+
+        if (FLUX_IS_INDEX(word)) {
+            if (rel != 0) {
+                c->pos = c->count;          /* Next revolution - pass ends */
+                break;
+            }
+            c->pos++;
+            continue;
+        }
+        if (rel >= win_hi) {
+            break;
+        }
+        if (rel >= win_lo && !hit) {
+            *off = rel - pc;
+            c->phase += *off / CORR_PHASE_DIV;
+            hit = true;
+        }
+        c->pos++;
     }
 
-    /* Placeholder - real implementation would analyze flux data */
-    corr->time_mean = bit_position;
-    corr->time_stddev = 5;
-    corr->hit_count = g_last_capture.pass_count;
-    corr->total_passes = g_last_capture.pass_count;
+    return hit;
+}
+
+/**
+ * Internal: Sample the first CORR_ALIGN_CELLS cells of one pass in isolation
+ */
+static void cursor_sample(flux_cursor_t c, uint32_t *map)
+{
+    memset(map, 0, CORR_ALIGN_CELLS / 8);
 
-    return FLUXSTAT_OK;
+    for (uint32_t k = 0; k < CORR_ALIGN_CELLS; k++) {
+        int32_t off;
+        if (cursor_step(&c, (int32_t)(k * g_corr.cell_ticks), &off)) {
+            map[k >> 5] |= 1UL << (k & 31);
+        }
+    }
 }
 
-int fluxstat_analyze_track(fluxstat_track_t *result)
+static inline uint32_t map_bit(const uint32_t *map, uint32_t k)
 {
-    if (!result) {
-        return FLUXSTAT_ERR_INVALID;
+    return (map[k >> 5] >> (k & 31)) & 1;
+}
+
+/**
+ * Internal: Slip-align every pass against the first one
+ *
+ * Index jitter can offset a whole pass by a few cells. Compare the lead-in
+ * of each pass with pass 0 at every slip in +/- CORR_ALIGN_SLIP cells and
+ * start that pass's phase loop at the best match.
+ */
+static void corr_align(void)
+{
+    static uint32_t ref[CORR_ALIGN_CELLS / 32];
+    static uint32_t map[CORR_ALIGN_CELLS / 32];
+
+    if (g_corr.track_cells < CORR_ALIGN_CELLS) {
+        return;
     }
 
-    if (!g_capture_valid) {
-        return FLUXSTAT_ERR_NO_DATA;
+    cursor_sample(g_corr.cursor[0], ref);
+
+    for (uint8_t p = 1; p < g_corr.pass_count; p++) {
+        flux_cursor_t *c = &g_corr.cursor[p];
+        int best_slip = 0;
+        uint32_t best_score = 0;
+
+        cursor_sample(*c, map);
+
+        for (int slip = -CORR_ALIGN_SLIP; slip <= CORR_ALIGN_SLIP; slip++) {
+            uint32_t score = 0;
+            for (uint32_t k = CORR_ALIGN_SLIP;
+                 k < CORR_ALIGN_CELLS - CORR_ALIGN_SLIP; k++) {
+                score += !(map_bit(ref, k) ^ map_bit(map, k + slip));
+            }
+            if (score > best_score) {
+                best_score = score;
+                best_slip = slip;
+            }
+        }
+
+        c->align = best_slip * (int32_t)g_corr.cell_ticks;
+        c->phase = c->align;
     }
+}
 
-    memset(result, 0, sizeof(fluxstat_track_t));
+/**
+ * Internal: Bind cursors to the cached capture and align on index marks
+ */
+static int corr_reset(void)
+{
+    g_corr.valid = false;
+    g_corr.pass_count = 0;
+    g_corr.cell_ticks = fdec_cell_ticks(g_cur->encoding, g_cur->data_rate);
+    g_corr.next_bit = 0;
+    g_corr.track_cells = 0;
 
-    /* Get histogram to estimate data rate */
-    fluxstat_histogram_t hist;
-    fluxstat_histogram_stats(&hist);
+    if (!g_cur->valid) {
+        return FLUXSTAT_ERR_NO_DATA;
+    }
 
-    /* Estimate sectors based on encoding and index time */
-    uint32_t avg_index_time = g_last_capture.total_time / g_last_capture.pass_count;
+    uint64_t rev_sum = 0;
 
-    /* For MFM 250Kbps, 300 RPM (200ms/rev):
-     * ~250000 bits/sec * 0.2 sec = 50000 bits/track
-     * With 512 byte sectors + overhead, ~9 sectors
-     */
-    result->sector_count = 9;  /* Placeholder - would be detected from data */
-    result->track = 0;  /* Would come from capture parameters */
-    result->head = 0;
+    for (uint8_t p = 0; p < g_cur->capture.pass_count; p++) {
+        flux_cursor_t *c = &g_corr.cursor[g_corr.pass_count];
+        uint32_t *data;
+        uint32_t count;
 
-    /* Analyze each sector */
-    for (int s = 0; s < result->sector_count; s++) {
-        fluxstat_sector_t *sector = &result->sectors[s];
+        if (load_pass_data(p, &data, &count) != FLUXSTAT_OK || count == 0) {
+            continue;
+        }
 
-        /* Full implementation would:
-         * 1. Find sector header in flux data
-         * 2. Correlate data bits across passes
-         * 3. Calculate per-bit confidence
-         * 4. Try CRC correction if needed
-         */
+        /* Align on the leading index mark; fall back to the first word */
+        uint32_t i = 0;
+        while (i < count && !FLUX_IS_INDEX(data[i])) {
+            i++;
+        }
+        if (i == count) {
+            i = 0;
+        }
 
-        sector->size = 512;
-        sector->crc_ok = 1;  /* Placeholder */
-        sector->confidence_min = 85;
-        sector->confidence_avg = 95;
-        sector->weak_bit_count = 0;
-        sector->corrected_count = 0;
+        c->data = data;
+        c->count = count;
+        c->origin = FLUX_TIMESTAMP(data[i]);
+        c->start = FLUX_IS_INDEX(data[i]) ? i + 1 : i;
+        c->pos = c->start;
+        c->align = 0;
+        c->phase = 0;
+
+        /* Revolution length: measured index period, else last transition */
+        c->scale = g_cur->capture.passes[p].index_time;
+        if (c->scale == 0) {
+            c->scale = cursor_raw(c, data[count - 1]);
+        }
+        rev_sum += c->scale;
+        g_corr.pass_count++;
+    }
 
-        result->sectors_recovered++;
+    if (g_corr.pass_count == 0 || g_corr.cell_ticks == 0) {
+        return FLUXSTAT_ERR_NO_DATA;
     }
 
-    /* Calculate overall confidence */
-    uint32_t total_conf = 0;
-    for (int s = 0; s < result->sector_count; s++) {
-        total_conf += result->sectors[s].confidence_avg;
+    /* Normalize every pass to the mean revolution length */
+    uint32_t rev_ref = (uint32_t)(rev_sum / g_corr.pass_count);
+    for (uint8_t p = 0; p < g_corr.pass_count; p++) {
+        flux_cursor_t *c = &g_corr.cursor[p];
+        c->scale = c->scale ? (uint32_t)(((uint64_t)rev_ref << 16) / c->scale)
+                            : (1UL << 16);
     }
-    result->overall_confidence = total_conf / result->sector_count;
+    g_corr.track_cells = rev_ref / g_corr.cell_ticks + 1;
+
+    corr_align();
 
+    g_corr.valid = true;
     return FLUXSTAT_OK;
 }
 
-int fluxstat_recover_sector(uint8_t sector_num, fluxstat_sector_t *result)
+/**
+ * Internal: Position every cursor at the first transition of a bitcell
+ *
+ * Sequential calls continue from where the last sweep stopped; random
+ * access binary-searches each pass instead of rescanning from index.
+ * A phase checkpoint restores the tracked clock phase of every pass so a
+ * seek into the middle of a revolution stays cell-aligned.
+ */
+static void corr_seek(uint32_t bit, const corr_ckpt_t *ckpt)
 {
-    if (!result) {
-        return FLUXSTAT_ERR_INVALID;
+    if (bit == g_corr.next_bit && ckpt == NULL) {
+        return;
     }
 
-    if (!g_capture_valid) {
-        return FLUXSTAT_ERR_NO_DATA;
-    }
+    uint32_t half = g_corr.cell_ticks / 2;
 
-    memset(result, 0, sizeof(fluxstat_sector_t));
+    for (uint8_t p = 0; p < g_corr.pass_count; p++) {
+        flux_cursor_t *c = &g_corr.cursor[p];
+        uint32_t lo = c->start;
+        uint32_t hi = c->count;
 
-    /* Full implementation would:
-     * 1. Find sector header for sector_num in flux data
-     * 2. Extract and correlate data field across passes
-     * 3. Build bit-by-bit confidence map
-     * 4. Apply CRC correction for low-confidence bits
-     * 5. Return recovered data with quality metrics
-     */
+        c->phase = ckpt ? ckpt->base + ckpt->delta[p] : c->align;
 
-    result->size = 512;
-    result->crc_ok = 1;
-    result->confidence_min = 80;
-    result->confidence_avg = 95;
+        int32_t edge = (int32_t)(bit * g_corr.cell_ticks) + c->phase - (int32_t)half;
+        uint32_t win_lo = (edge > 0) ? (uint32_t)edge : 0;
 
-    return FLUXSTAT_OK;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (cursor_rel(c, c->data[mid]) < win_lo) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        c->pos = lo;
+    }
+
+    g_corr.next_bit = bit;
 }
 
-int fluxstat_get_bit_analysis(uint32_t bit_offset, uint32_t count,
-                              fluxstat_bit_t *bits)
+/**
+ * Internal: Save per-pass clock phase for a later corr_seek()
+ */
+static void corr_checkpoint(corr_ckpt_t *ckpt)
 {
-    if (!bits || count == 0) {
-        return FLUXSTAT_ERR_INVALID;
-    }
+    ckpt->base = g_corr.cursor[0].phase;
 
-    if (!g_capture_valid) {
-        return FLUXSTAT_ERR_NO_DATA;
+    for (uint8_t p = 0; p < g_corr.pass_count; p++) {
+        int32_t d = g_corr.cursor[p].phase - ckpt->base;
+        if (d > INT16_MAX) d = INT16_MAX;
+        if (d < INT16_MIN) d = INT16_MIN;
+        ckpt->delta[p] = (int16_t)d;
     }
+}
 
-    for (uint32_t i = 0; i < count; i++) {
-        fluxstat_correlation_t corr;
-        correlate_flux(bit_offset + i, &corr);
-
-        /* Determine bit value and confidence from correlation */
-        uint8_t confidence = (corr.hit_count * 100) / corr.total_passes;
-
-        bits[i].value = (corr.hit_count > corr.total_passes / 2) ? 1 : 0;
-        bits[i].confidence = confidence;
-        bits[i].transition_count = corr.hit_count;
-        bits[i].timing_stddev = corr.time_stddev;
-        bits[i].corrected = 0;
+/**
+ * Internal: Integer square root (for timing stddev)
+ */
+static uint32_t isqrt32(uint32_t v)
+{
+    uint32_t res = 0;
+    uint32_t one = 1UL << 30;
 
-        /* Classify */
-        if (bits[i].value == 1) {
-            bits[i].classification = (confidence >= CONF_STRONG) ?
-                                     BITCELL_STRONG_1 : BITCELL_WEAK_1;
+    while (one > v) {
+        one >>= 2;
+    }
+    while (one != 0) {
+        if (v >= res + one) {
+            v -= res + one;
+            res = (res >> 1) + one;
         } else {
-            bits[i].classification = (confidence >= CONF_STRONG) ?
-                                     BITCELL_STRONG_0 : BITCELL_WEAK_0;
-        }
-
-        if (confidence < CONF_AMBIGUOUS) {
-            bits[i].classification = BITCELL_AMBIGUOUS;
+            res >>= 1;
         }
+        one >>= 2;
     }
+    return res;
+}
+
+/**
+ * Internal: Correlate the next bitcell across all passes
+ *
+ * A pass "hits" the cell if it has a transition within +/- half a cell of
+ * its own tracked cell center. Mean is over absolute hit times; stddev is
+ * the RMS jitter of hits against each pass's tracked clock.
+ */
+static void corr_next(fluxstat_correlation_t *corr)
+{
+    int32_t  center = (int32_t)(g_corr.next_bit * g_corr.cell_ticks);
+    int32_t  sum = 0;
+    uint32_t sum_sq = 0;
+    uint16_t hits = 0;
+
+    for (uint8_t p = 0; p < g_corr.pass_count; p++) {
+        flux_cursor_t *c = &g_corr.cursor[p];
+        int32_t phase = c->phase;
+        int32_t off;
+
+        if (cursor_step(c, center, &off)) {
+            sum += phase + off;
+            sum_sq += (uint32_t)(off * off);
+            hits++;
+        }
+    }
+
+    corr->hit_count = hits;
+    corr->total_passes = g_corr.pass_count;
+
+    if (hits > 0) {
+        corr->time_mean = (uint32_t)(center + sum / hits);
+        corr->time_stddev = (uint16_t)isqrt32(sum_sq / hits);
+    } else {
+        corr->time_mean = (uint32_t)center;
+        corr->time_stddev = 0;
+    }
+
+    g_corr.next_bit++;
+}
+
+/**
+ * Internal: Resolve automatic encoding for the current capture
+ *
+ * The first pass goes to the drive's format session; a window capture
+ * takes the session's format, as it holds no complete track.
+ */
+static int resolve_format(void)
+{
+    const fluxstat_pass_t *p = &g_cur->capture.passes[0];
+    fmtc_format_t fmt;
+    int ret = FLUXSTAT_OK;
+
+    if (g_cur->windowed) {
+        if (!fmtc_get(g_cur->drive, &fmt)) {
+            ret = FLUXSTAT_ERR_NO_DATA;
+        }
+    } else if (g_cur->capture.pass_count == 0) {
+        ret = FLUXSTAT_ERR_NO_DATA;
+    } else {
+        ret = fmtc_identify(g_cur->drive, (const uint32_t *)(uintptr_t)p->base_addr,
+                            p->flux_count, &fmt);
+    }
+    if (ret != FLUXSTAT_OK) {
+        return ret;
+    }
+
+    g_cur->encoding = fmt.encoding;
+    g_cur->data_rate = fmt.data_rate;
+    return FLUXSTAT_OK;
+}
+
+/**
+ * Internal: Make sure the correlator is bound to the current capture
+ */
+static int corr_ensure(void)
+{
+    if (!g_cur->valid) {
+        return FLUXSTAT_ERR_NO_DATA;
+    }
+
+    if (g_cur->encoding == ENC_UNKNOWN) {
+        int ret = resolve_format();
+        if (ret != FLUXSTAT_OK) {
+            return ret;
+        }
+    }
+
+    if (!g_corr.valid || g_corr.cell_ticks != fdec_cell_ticks(g_cur->encoding, g_cur->data_rate)) {
+        g_index.valid = false;
+        return corr_reset();
+    }
+
+    return FLUXSTAT_OK;
+}
+
+/**
+ * Internal: Analyze the next `count` bitcells from the current position
+ */
+static void corr_fill(fluxstat_bit_t *bits, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        fluxstat_correlation_t corr;
+        corr_next(&corr);
+
+        /* Majority vote; confidence is the fraction of passes that agree */
+        uint16_t agree;
+        bits[i].value = (corr.hit_count * 2 > corr.total_passes) ? 1 : 0;
+        agree = bits[i].value ? corr.hit_count : corr.total_passes - corr.hit_count;
+
+        uint8_t confidence = (agree * 100) / corr.total_passes;
+
+        bits[i].confidence = confidence;
+        bits[i].transition_count = corr.hit_count;
+        bits[i].timing_stddev = corr.time_stddev;
+        bits[i].corrected = 0;
+
+        /* Classify */
+        if (bits[i].value == 1) {
+            bits[i].classification = (confidence >= CONF_STRONG) ?
+                                     BITCELL_STRONG_1 : BITCELL_WEAK_1;
+        } else {
+            bits[i].classification = (confidence >= CONF_STRONG) ?
+                                     BITCELL_STRONG_0 : BITCELL_WEAK_0;
+        }
+
+        if (confidence < CONF_AMBIGUOUS) {
+            bits[i].classification = BITCELL_AMBIGUOUS;
+        }
+    }
+}
+
+/*============================================================================
+ * Track Decoder (FM / MFM / M2FM)
+ *
+ * Walks the correlated bitcell stream once, hunting address marks and
+ * decoding every ID and data field as it passes. Sector offsets (plus a
+ * per-pass phase checkpoint) go into g_index so fluxstat_recover_sector()
+ * can seek straight to a data field instead of rescanning the track.
+ *============================================================================*/
+
+#define MARK_IDAM           FDEC_MARK_IDAM
+#define MARK_DAM            FDEC_MARK_DAM
+#define MARK_DDAM           FDEC_MARK_DDAM
+
+/* Max cells between ID field end and data mark (gap 2 + sync, generous) */
+#define IDAM_TO_DAM_CELLS   (64 * 16)
+
+/* Max sector size decoded (N = 5) */
+#define SECTOR_SIZE_MAX     4096
+
+/* Bitcells fetched from the correlator per refill */
+#define READER_CHUNK        32
+
+typedef struct {
+    fluxstat_bit_t bits[READER_CHUNK];
+    uint8_t  pos;                   /* Next entry in bits[] */
+    uint8_t  len;                   /* Valid entries in bits[] */
+    uint32_t next;                  /* Bitcell of bits[len] */
+    uint32_t end;                   /* First bitcell past the track */
+} bit_reader_t;
+
+/* Weak data cell considered for CRC correction */
+typedef struct {
+    uint16_t bit;                   /* Bit position in field (MSB of byte 0 = 0) */
+    uint8_t  confidence;            /* Cell confidence */
+    uint16_t syndrome;              /* CRC residual change if flipped */
+} corr_cand_t;
+
+typedef struct {
+    uint32_t conf_sum;              /* Sum of data-cell confidence */
+    uint32_t cells;                 /* Data cells seen */
+    uint8_t  conf_min;              /* Lowest data-cell confidence */
+    uint16_t weak_count;            /* Weak/ambiguous data cells */
+    uint16_t *weak_pos;             /* Optional: first 64 weak positions */
+    corr_cand_t *cand;              /* Optional: least-confident weak cells */
+    uint8_t  cand_count;            /* Valid entries in cand[] */
+    uint16_t bit_base;              /* Field bit position of this read */
+} field_stats_t;
+
+static void reader_open(bit_reader_t *r, uint32_t bit, const corr_ckpt_t *ckpt)
+{
+    corr_seek(bit, ckpt);
+    r->pos = 0;
+    r->len = 0;
+    r->next = bit;
+    r->end = g_corr.track_cells;
+}
+
+static inline const fluxstat_bit_t *reader_next(bit_reader_t *r)
+{
+    if (r->pos == r->len) {
+        if (r->next >= r->end) {
+            return NULL;
+        }
+        uint32_t n = r->end - r->next;
+        if (n > READER_CHUNK) {
+            n = READER_CHUNK;
+        }
+        corr_fill(r->bits, n);
+        r->next += n;
+        r->len = (uint8_t)n;
+        r->pos = 0;
+    }
+    return &r->bits[r->pos++];
+}
+
+/* Bitcell index of the next cell reader_next() will return */
+static inline uint32_t reader_tell(const bit_reader_t *r)
+{
+    return r->next - (r->len - r->pos);
+}
+
+/**
+ * Internal: Read 16 raw cells
+ */
+static bool read_cells(bit_reader_t *r, uint16_t *cells)
+{
+    uint16_t w = 0;
+    for (int i = 0; i < 16; i++) {
+        const fluxstat_bit_t *b = reader_next(r);
+        if (!b) {
+            return false;
+        }
+        w = (w << 1) | b->value;
+    }
+    *cells = w;
+    return true;
+}
+
+/* Weak cells kept as correction candidates per sector */
+#define CORR_CANDIDATES     48
+
+/*
+ * Flip combinations tried per Hamming weight. Each weight draws from the
+ * largest candidate pool that fits, so high weights only see the weakest
+ * cells. A random 16-bit residual matches one of N combinations with
+ * probability ~N/65536, so the CRC alone is not enough to trust a match;
+ * the two limits below keep the search to flips the passes support.
+ */
+#define CORR_MAX_COMBOS     256
+
+/* A flipped cell must have read the other way on >= 25% of the passes */
+#define CORR_FLIP_CONF_MAX  75
+
+/*
+ * Upper bound on the summed majority margin (confidence - 50) of a flip
+ * set: three cells outvoted 3:1 still fit, wider sets need near-ties
+ */
+#define CORR_MARGIN_MAX     80
+
+/**
+ * Internal: Track a weak cell, keeping the CORR_CANDIDATES least confident
+ */
+static void cand_add(field_stats_t *st, uint16_t bit, uint8_t confidence)
+{
+    int slot = st->cand_count;
+
+    if (slot == CORR_CANDIDATES) {
+        /* Full: replace the most confident entry if this one is weaker */
+        slot = 0;
+        for (int i = 1; i < CORR_CANDIDATES; i++) {
+            if (st->cand[i].confidence > st->cand[slot].confidence) {
+                slot = i;
+            }
+        }
+        if (st->cand[slot].confidence <= confidence) {
+            return;
+        }
+    } else {
+        st->cand_count++;
+    }
+
+    st->cand[slot].bit = bit;
+    st->cand[slot].confidence = confidence;
+}
+
+/**
+ * Internal: Decode `len` bytes of a field, accumulating CRC and stats
+ *
+ * @param dst   Destination (NULL to only check CRC)
+ * @param crc   In: preset, out: CRC over the field
+ * @param st    Optional per-cell confidence statistics
+ */
+static bool read_field(bit_reader_t *r, uint8_t *dst, uint16_t len,
+                       uint16_t *crc, field_stats_t *st)
+{
+    for (uint16_t n = 0; n < len; n++) {
+        uint8_t byte = 0;
+
+        for (int i = 0; i < 16; i++) {
+            const fluxstat_bit_t *b = reader_next(r);
+            if (!b) {
+                return false;
+            }
+            if ((i & 1) == 0) {
+                continue;               /* Clock cell */
+            }
+
+            byte = (byte << 1) | b->value;
+
+            if (st) {
+                st->conf_sum += b->confidence;
+                st->cells++;
+                if (b->confidence < st->conf_min) {
+                    st->conf_min = b->confidence;
+                }
+                if (b->classification != BITCELL_STRONG_0 &&
+                    b->classification != BITCELL_STRONG_1) {
+                    if (st->weak_pos && st->weak_count < 64) {
+                        st->weak_pos[st->weak_count] = n * 8 + (i >> 1);
+                    }
+                    if (st->cand) {
+                        cand_add(st, st->bit_base + n * 8 + (i >> 1),
+                                 b->confidence);
+                    }
+                    st->weak_count++;
+                }
+            }
+        }
+
+        *crc = crc16_update_byte(*crc, byte);
+        if (dst) {
+            *dst++ = byte;
+        }
+    }
+    return true;
+}
+
+/**
+ * Internal: Hunt the next address mark
+ *
+ * @return Mark byte (MARK_IDAM / MARK_DAM / MARK_DDAM), 0 at end of track
+ */
+static uint8_t hunt_mark(bit_reader_t *r)
+{
+    uint8_t enc = g_cur->encoding;
+    uint16_t sh = 0;
+    const fluxstat_bit_t *b;
+
+    while ((b = reader_next(r)) != NULL) {
+        sh = (sh << 1) | b->value;
+
+        uint8_t m = fdec_cd_mark(enc, sh);
+        if (m != FDEC_MARK_SYNC) {
+            if (m != FDEC_MARK_NONE) {
+                return m;               /* FM: the mark carries its value */
+            }
+            continue;
+        }
+
+        /* MFM needs three A1 syncs, M2FM one, then the mark byte */
+        int syncs = 1;
+        uint16_t w = 0;
+        while (read_cells(r, &w) && fdec_cd_mark(enc, w) == FDEC_MARK_SYNC) {
+            syncs++;
+        }
+        if (reader_tell(r) >= r->end) {
+            return 0;
+        }
+
+        uint8_t mark = fdec_cd_byte(w);
+        if (syncs >= (enc == ENC_MFM ? 3 : 1) &&
+            (mark == MARK_IDAM || mark == MARK_DAM || mark == MARK_DDAM)) {
+            return mark;
+        }
+        sh = w;                         /* Keep hunting from here */
+    }
+
+    return 0;
+}
+
+/**
+ * Internal: Fill sector result quality fields from field stats
+ */
+static void apply_field_stats(fluxstat_sector_t *sec, const field_stats_t *st)
+{
+    sec->confidence_min = st->cells ? st->conf_min : 0;
+    sec->confidence_avg = st->cells ? (uint8_t)(st->conf_sum / st->cells) : 0;
+    sec->weak_bit_count = (st->weak_count > 255) ? 255 : (uint8_t)st->weak_count;
+}
+
+/**
+ * Internal: Precompute per-bit CRC syndromes for the candidate cells
+ *
+ * The field CRC is linear, so flipping the bit with d bits after it
+ * (CRC bytes included) changes the residual by x^(d+16) mod G regardless
+ * of the data. Walking the candidates from the end of the field backwards
+ * lets one register advance through every syndrome, bytewise via the CRC
+ * table where the gap allows. Candidates are then ranked weakest first.
+ *
+ * @param field_bits    Bits in data field plus CRC
+ * @return Candidates eligible for flipping (confidence <= CORR_FLIP_CONF_MAX)
+ */
+static uint8_t cand_prepare(corr_cand_t *cand, uint8_t count, uint32_t field_bits)
+{
+    /* Sort by bit position, descending */
+    for (int i = 1; i < count; i++) {
+        corr_cand_t c = cand[i];
+        int j = i - 1;
+        while (j >= 0 && cand[j].bit < c.bit) {
+            cand[j + 1] = cand[j];
+            j--;
+        }
+        cand[j + 1] = c;
+    }
+
+    uint16_t reg = 1;
+    uint32_t done = 0;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t gap = (field_bits - 1 - cand[i].bit) + 16 - done;
+        done += gap;
+
+        while (gap >= 8) {
+            reg = (uint16_t)((reg << 8) ^ crc16_table[0][reg >> 8]);
+            gap -= 8;
+        }
+        while (gap--) {
+            reg = (reg & 0x8000) ? (uint16_t)((reg << 1) ^ 0x1021)
+                                 : (uint16_t)(reg << 1);
+        }
+        cand[i].syndrome = reg;
+    }
+
+    /* Rank by confidence, ascending */
+    for (int i = 1; i < count; i++) {
+        corr_cand_t c = cand[i];
+        int j = i - 1;
+        while (j >= 0 && cand[j].confidence > c.confidence) {
+            cand[j + 1] = cand[j];
+            j--;
+        }
+        cand[j + 1] = c;
+    }
+
+    /* Cells the passes (nearly) agree on are not flipped */
+    while (count > 0 && cand[count - 1].confidence > CORR_FLIP_CONF_MAX) {
+        count--;
+    }
+    return count;
+}
+
+/**
+ * Internal: Largest candidate pool with C(n, k) <= budget
+ *
+ * @param combos    Out: C(n, k) for the returned pool
+ * @return Pool size, 0 if not even C(k, k) fits
+ */
+static uint8_t cand_pool(uint8_t count, uint8_t k, uint32_t budget,
+                         uint32_t *combos)
+{
+    uint8_t n = k;
+
+    *combos = 1;
+    if (budget == 0) {
+        return 0;
+    }
+    while (n < count) {
+        /* C(n + 1, k) */
+        uint32_t c = 1;
+        for (uint8_t i = 0; i < k; i++) {
+            c = c * (n + 1 - i) / (i + 1);
+        }
+        if (c > budget) {
+            break;
+        }
+        *combos = c;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * Internal: Find the unique lowest-weight flip set that cancels `residual`
+ *
+ * Each candidate combination costs one XOR against a running prefix of
+ * syndromes; every weight gets its own CORR_MAX_COMBOS. Sets whose
+ * summed margin exceeds CORR_MARGIN_MAX are pruned (candidates are ranked
+ * by confidence, so the rest of that level only gets worse). A weight
+ * with two or more matches is ambiguous and ends the search without
+ * correcting.
+ *
+ * @param sel       Out: candidate indices of the match
+ * @return Weight of the correction, 0 if none was found
+ */
+static uint8_t cand_search(const corr_cand_t *cand, uint8_t count,
+                           uint16_t residual, uint8_t max_weight,
+                           uint8_t *sel)
+{
+    uint8_t  idx[FLUXSTAT_MAX_CORRECTION];
+    uint16_t acc[FLUXSTAT_MAX_CORRECTION + 1];
+    uint16_t margin[FLUXSTAT_MAX_CORRECTION + 1];
+
+    if (max_weight > FLUXSTAT_MAX_CORRECTION) {
+        max_weight = FLUXSTAT_MAX_CORRECTION;
+    }
+
+    for (uint8_t k = 1; k <= max_weight && k <= count; k++) {
+        uint32_t combos;
+        uint8_t n = cand_pool(count, k, CORR_MAX_COMBOS, &combos);
+        uint8_t matches = 0;
+        int d = 0;
+
+        if (n == 0) {
+            break;
+        }
+
+        idx[0] = 0;
+        acc[0] = residual;
+        margin[0] = 0;
+
+        /* Iterative k-combination walk over cand[0..n) */
+        while (d >= 0) {
+            if (idx[d] > n - (k - d)) {
+                if (--d >= 0) {
+                    idx[d]++;
+                }
+                continue;
+            }
+
+            margin[d + 1] = margin[d] + cand[idx[d]].confidence - 50;
+            if (margin[d + 1] > CORR_MARGIN_MAX) {
+                idx[d] = n;             /* Exhaust this level */
+                continue;
+            }
+            acc[d + 1] = acc[d] ^ cand[idx[d]].syndrome;
+
+            if (d == k - 1) {
+                if (acc[k] == 0 && ++matches == 1) {
+                    memcpy(sel, idx, k);
+                }
+                idx[d]++;
+            } else {
+                idx[d + 1] = idx[d] + 1;
+                d++;
+            }
+        }
+
+        if (matches == 1) {
+            return k;
+        }
+        if (matches > 1) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Internal: Decode the whole track once and build the sector index
+ *
+ * @param result    Optional track result; when given, every data field
+ *                  is decoded into result->sectors[] during the sweep
+ */
+static int build_track_index(fluxstat_track_t *result)
+{
+    int ret = corr_ensure();
+    if (ret != FLUXSTAT_OK) {
+        return ret;
+    }
+
+    memset(&g_index, 0, sizeof(g_index));
+    g_index.track = g_cur->track;
+    g_index.head = g_cur->head;
+    g_index.encoding = g_cur->encoding;
+
+    if (!fdec_is_clock_data(g_cur->encoding)) {
+        g_index.valid = true;           /* Nothing this decoder can find */
+        return FLUXSTAT_OK;
+    }
+
+    bit_reader_t r;
+    int pending = -1;                   /* ID field awaiting its data field */
+    uint8_t mark;
+
+    reader_open(&r, 0, NULL);
+
+    while ((mark = hunt_mark(&r)) != 0) {
+        uint32_t mark_end = reader_tell(&r);
+        uint16_t crc = fdec_mark_crc(g_cur->encoding, mark);
+
+        if (mark == MARK_IDAM) {
+            uint8_t hdr[6];
+            if (!read_field(&r, hdr, sizeof(hdr), &crc, NULL)) {
+                break;
+            }
+            if (g_index.count >= FLUXSTAT_MAX_SECTORS) {
+                continue;
+            }
+
+            fluxstat_sector_loc_t *loc = &g_index.sectors[g_index.count];
+            loc->cylinder = hdr[0];
+            loc->head = hdr[1];
+            loc->sector = hdr[2];
+            loc->size_code = hdr[3];
+            loc->idam_bit = mark_end;
+            loc->header_crc_ok = (crc == 0);
+            pending = g_index.count++;
+            continue;
+        }
+
+        /* Data mark: must follow an ID field closely */
+        if (pending < 0 ||
+            mark_end - g_index.sectors[pending].idam_bit > IDAM_TO_DAM_CELLS) {
+            pending = -1;
+            continue;
+        }
+
+        fluxstat_sector_loc_t *loc = &g_index.sectors[pending];
+        uint16_t size = (uint16_t)(128u << (loc->size_code & 0x07));
+        if (size > SECTOR_SIZE_MAX) {
+            size = SECTOR_SIZE_MAX;
+        }
+
+        loc->data_bit = mark_end;
+        loc->size = size;
+        loc->deleted = (mark == MARK_DDAM);
+        corr_checkpoint(&g_index_ckpt[pending]);
+
+        field_stats_t st = { .conf_min = 100 };
+        uint8_t crc_bytes[2];
+        uint8_t *dst = NULL;
+
+        if (result) {
+            fluxstat_sector_t *sec = &result->sectors[pending];
+            st.weak_pos = sec->weak_positions;
+            dst = sec->data;
+        }
+
+        if (!read_field(&r, dst, size, &crc, result ? &st : NULL) ||
+            !read_field(&r, crc_bytes, 2, &crc, NULL)) {
+            loc->data_bit = 0;
+            break;
+        }
+
+        loc->data_crc_ok = (crc == 0);
+
+        if (result) {
+            fluxstat_sector_t *sec = &result->sectors[pending];
+            sec->size = size;
+            sec->crc_ok = loc->data_crc_ok;
+            apply_field_stats(sec, &st);
+        }
+        pending = -1;
+    }
+
+    g_index.valid = true;
+    return FLUXSTAT_OK;
+}
+
+int fluxstat_get_track_index(fluxstat_track_index_t *index)
+{
+    if (!index) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
+    int ret = corr_ensure();
+    if (ret != FLUXSTAT_OK) {
+        return ret;
+    }
+
+    if (!g_index.valid) {
+        ret = build_track_index(NULL);
+        if (ret != FLUXSTAT_OK) {
+            return ret;
+        }
+    }
+
+    memcpy(index, &g_index, sizeof(fluxstat_track_index_t));
+    return FLUXSTAT_OK;
+}
+
+int fluxstat_analyze_track(fluxstat_track_t *result)
+{
+    if (!result) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
+    if (!g_cur->valid) {
+        return FLUXSTAT_ERR_NO_DATA;
+    }
+
+    memset(result, 0, sizeof(fluxstat_track_t));
+
+    int ret = build_track_index(result);
+    if (ret != FLUXSTAT_OK) {
+        return ret;
+    }
+
+    result->sector_count = g_index.count;
+    result->track = g_index.track;
+    result->head = g_index.head;
+
+    uint32_t total_conf = 0;
+    for (int s = 0; s < result->sector_count; s++) {
+        const fluxstat_sector_loc_t *loc = &g_index.sectors[s];
+        fluxstat_sector_t *sector = &result->sectors[s];
+
+        sector->sector_id = loc->sector;
+
+        if (loc->data_bit == 0) {
+            result->sectors_failed++;
+        } else if (sector->crc_ok) {
+            result->sectors_recovered++;
+        } else {
+            result->sectors_partial++;
+        }
+        total_conf += sector->confidence_avg;
+    }
+
+    if (result->sector_count > 0) {
+        result->overall_confidence = total_conf / result->sector_count;
+    }
+
+    return FLUXSTAT_OK;
+}
+
+int fluxstat_recover_sector(uint8_t sector_num, fluxstat_sector_t *result)
+{
+    if (!result) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
+    int ret = corr_ensure();
+    if (ret != FLUXSTAT_OK) {
+        return ret;
+    }
+
+    if (!g_index.valid) {
+        ret = build_track_index(NULL);
+        if (ret != FLUXSTAT_OK) {
+            return ret;
+        }
+    }
+
+    /* Look up the data field by sector ID */
+    int idx = -1;
+    for (int s = 0; s < g_index.count; s++) {
+        if (g_index.sectors[s].sector == sector_num &&
+            g_index.sectors[s].data_bit != 0) {
+            idx = s;
+            break;
+        }
+    }
+    if (idx < 0) {
+        return FLUXSTAT_ERR_NO_DATA;
+    }
+
+    const fluxstat_sector_loc_t *loc = &g_index.sectors[idx];
+
+    memset(result, 0, sizeof(fluxstat_sector_t));
+
+    static corr_cand_t cand[CORR_CANDIDATES];
+    bit_reader_t r;
+    field_stats_t st = { .conf_min = 100, .weak_pos = result->weak_positions };
+    field_stats_t crc_st = { .conf_min = 100 };
+    uint16_t crc = fdec_mark_crc(g_cur->encoding, loc->deleted ? MARK_DDAM : MARK_DAM);
+    uint8_t crc_bytes[2];
+
+    if (g_config.use_crc_correction) {
+        st.cand = cand;
+        crc_st.cand = cand;
+        crc_st.bit_base = loc->size * 8;
+    }
+
+    reader_open(&r, loc->data_bit, &g_index_ckpt[idx]);
+
+    if (!read_field(&r, result->data, loc->size, &crc, &st)) {
+        return FLUXSTAT_ERR_NO_DATA;
+    }
+
+    /* CRC cells are candidates too; share the pool with the data field */
+    crc_st.cand_count = st.cand_count;
+    if (!read_field(&r, crc_bytes, 2, &crc, &crc_st)) {
+        return FLUXSTAT_ERR_NO_DATA;
+    }
+
+    result->size = loc->size;
+    result->sector_id = loc->sector;
+    result->crc_ok = (crc == 0);
+    apply_field_stats(result, &st);
+
+    /* Weak-bit correction: flip the unique cheapest set that fixes the CRC */
+    if (!result->crc_ok && crc_st.cand_count > 0) {
+        uint8_t sel[FLUXSTAT_MAX_CORRECTION];
+        uint8_t n = cand_prepare(cand, crc_st.cand_count, (loc->size + 2) * 8);
+
+        uint8_t k = cand_search(cand, n, crc, g_config.max_correction_bits, sel);
+        if (k > 0) {
+            for (uint8_t i = 0; i < k; i++) {
+                uint16_t bit = cand[sel[i]].bit;
+                if (bit < loc->size * 8) {
+                    result->data[bit >> 3] ^= 0x80 >> (bit & 7);
+                } else {
+                    bit -= loc->size * 8;
+                    crc_bytes[bit >> 3] ^= 0x80 >> (bit & 7);
+                }
+            }
+
+            /* Re-check the corrected field rather than trust the syndromes */
+            crc = fdec_mark_crc(g_cur->encoding, loc->deleted ? MARK_DDAM : MARK_DAM);
+            crc = crc16_update(crc, result->data, loc->size);
+            crc = crc16_update(crc, crc_bytes, 2);
+            if (crc == 0) {
+                result->corrected_count = k;
+                result->crc_ok = true;
+            } else {
+                /* Put the data back as read */
+                for (uint8_t i = 0; i < k; i++) {
+                    uint16_t bit = cand[sel[i]].bit;
+                    if (bit < loc->size * 8) {
+                        result->data[bit >> 3] ^= 0x80 >> (bit & 7);
+                    }
+                }
+            }
+        }
+    }
+
+    return FLUXSTAT_OK;
+}
+
+/*============================================================================
+ * Targeted Sector Re-capture
+ *
+ * Once a track has been indexed, a sector that failed can be read again
+ * on its own: each pass captures only a window around that sector,
+ * placed by its index-relative position (ID mark to end of data CRC), so
+ * the pass buffers shrink to a sector's worth of flux and can be packed
+ * closely. The windowed passes go through the same correlator and track
+ * decoder, so fluxstat_recover_sector() works on them unchanged.
+ *============================================================================*/
+
+/* Window margins in channel cells (16 per byte for FM/MFM) */
+#define WINDOW_LEAD_CELLS   (32 * 16)   /* Gap, sync and mark before the ID field */
+#define WINDOW_TAIL_CELLS   (16 * 16)   /* Trailing gap after the data CRC */
+#define WINDOW_SPEED_SHIFT  6           /* Extra 1/64 of the offset for speed drift */
+#define WINDOW_STRIDE_ALIGN 1024        /* Pass buffer granularity (bytes) */
+
+int fluxstat_capture_sector(uint8_t drive, uint8_t sector_num, uint8_t passes)
+{
+    uint8_t iface = FLUXSTAT_DRIVE_IF(drive);
+
+    if (iface >= FLUXSTAT_INTERFACES) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+    if (passes == 0) {
+        passes = g_config.pass_count;
+    }
+    if (passes < FLUXSTAT_MIN_PASSES || passes > FLUXSTAT_MAX_PASSES) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
+    /* Needs a full-revolution capture of this drive to place the window */
+    fluxstat_select(iface);
+    if (!g_cur->valid || g_cur->windowed || g_cur->drive != drive) {
+        return FLUXSTAT_ERR_NO_DATA;
+    }
+
+    int ret = corr_ensure();
+    if (ret != FLUXSTAT_OK) {
+        return ret;
+    }
+    if (!g_index.valid) {
+        ret = build_track_index(NULL);
+        if (ret != FLUXSTAT_OK) {
+            return ret;
+        }
+    }
+
+    const fluxstat_sector_loc_t *loc = NULL;
+    for (int s = 0; s < g_index.count; s++) {
+        if (g_index.sectors[s].sector == sector_num) {
+            loc = &g_index.sectors[s];
+            break;
+        }
+    }
+    if (loc == NULL) {
+        return FLUXSTAT_ERR_NO_DATA;
+    }
+
+    /* ID mark through data CRC; a missing data mark gets the widest gap */
+    uint32_t size = loc->size ? loc->size : (128u << (loc->size_code & 7));
+    uint32_t first = loc->idam_bit > WINDOW_LEAD_CELLS ?
+                     loc->idam_bit - WINDOW_LEAD_CELLS : 0;
+    uint32_t last = (loc->data_bit ? loc->data_bit : loc->idam_bit + IDAM_TO_DAM_CELLS) +
+                    (size + 2) * 16 + WINDOW_TAIL_CELLS;
+
+    /* Positions come from the mean revolution: widen for spindle drift */
+    uint32_t cell = g_corr.cell_ticks;
+    uint32_t start = first * cell;
+    uint32_t end = last * cell;
+    start -= start >> WINDOW_SPEED_SHIFT;
+    end += end >> WINDOW_SPEED_SHIFT;
+
+    /* Room for a transition every cell (every other cell for MFM/M2FM) */
+    uint32_t words = (end - start) / cell;
+    if (g_cur->encoding == ENC_MFM || g_cur->encoding == ENC_M2FM) {
+        words /= 2;
+    }
+    uint32_t stride = ((words + 2) * 4 + WINDOW_STRIDE_ALIGN - 1) &
+                      ~(uint32_t)(WINDOW_STRIDE_ALIGN - 1);
+    if (stride > FLUXSTAT_PASS_SIZE) {
+        stride = FLUXSTAT_PASS_SIZE;
+    }
+
+    ret = begin_capture(drive, g_cur->track, g_cur->head, passes,
+                        start, end - start, stride);
+    if (ret == FLUXSTAT_OK) {
+        g_cur->window_sector = sector_num;
+    }
+    return ret;
+}
+
+int fluxstat_get_bit_analysis(uint32_t bit_offset, uint32_t count,
+                              fluxstat_bit_t *bits)
+{
+    if (!bits || count == 0) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+
+    int ret = corr_ensure();
+    if (ret != FLUXSTAT_OK) {
+        return ret;
+    }
+
+    corr_seek(bit_offset, NULL);
+    corr_fill(bits, count);
 
     return FLUXSTAT_OK;
 }
@@ -515,12 +1984,12 @@ int fluxstat_get_pass_data(uint8_t pass, uint32_t *addr, uint32_t *size)
         return FLUXSTAT_ERR_INVALID;
     }
 
-    if (!g_capture_valid || pass >= g_last_capture.pass_count) {
+    if (!g_cur->valid || pass >= g_cur->capture.pass_count) {
         return FLUXSTAT_ERR_NO_DATA;
     }
 
-    *addr = g_last_capture.passes[pass].base_addr;
-    *size = g_last_capture.passes[pass].data_size;
+    *addr = g_cur->capture.passes[pass].base_addr;
+    *size = g_cur->capture.passes[pass].data_size;
 
     return FLUXSTAT_OK;
 }
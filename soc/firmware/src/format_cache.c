@@ -0,0 +1,232 @@
+/**
+ * FluxRipper Track Format Cache - Implementation
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-10 21:00
+ */
+
+#include "format_cache.h"
+#include "flux_decode.h"
+#include "fluxstat_hal.h"
+#include "fluxripper_hal.h"
+#include <stddef.h>
+#include <string.h>
+
+/*============================================================================
+ * Candidates
+ *============================================================================*/
+
+/* Probe order doubles as the tie-break: the common formats first */
+static const struct {
+    uint8_t     encoding;
+    uint32_t    data_rate;
+} g_cand[] = {
+    { ENC_MFM,       250000 },          /* DD */
+    { ENC_MFM,       500000 },          /* HD */
+    { ENC_MFM,       300000 },          /* DD media in a 360 RPM drive */
+    { ENC_MFM,      1000000 },          /* ED */
+    { ENC_FM,        125000 },          /* 5.25" SD */
+    { ENC_FM,        250000 },          /* 8" SD */
+    { ENC_M2FM,      250000 },
+    { ENC_GCR_APPLE, 250000 },
+    { ENC_GCR_C64,   250000 },          /* CBM zones 4..1 */
+    { ENC_GCR_C64,   266667 },
+    { ENC_GCR_C64,   285714 },
+    { ENC_GCR_C64,   307692 },
+};
+
+#define CAND_COUNT          (sizeof(g_cand) / sizeof(g_cand[0]))
+#define SECTOR_LIST_MAX     64
+
+static struct {
+    bool            valid;
+    fmtc_format_t   fmt;
+    fmtc_stats_t    stats;
+} g_drive[FMTC_DRIVES];
+
+static fdec_sector_t g_list[SECTOR_LIST_MAX];
+
+/*============================================================================
+ * Decode
+ *============================================================================*/
+
+/**
+ * Decode one revolution as the given format
+ * @param out   Output: decode results over g_list
+ * @return good ID fields found
+ */
+static uint32_t decode(const uint32_t *words, uint32_t count, uint8_t encoding,
+                       uint32_t data_rate, fdec_track_t *out)
+{
+    fdec_track_init(out, g_list, SECTOR_LIST_MAX);
+    if (fdec_decode_pass(words, count, encoding, data_rate, FDEC_DEFAULT_BW_PM,
+                         FDEC_DEFAULT_DAMPING, out) != 0) {
+        return 0;
+    }
+    return out->ids;
+}
+
+/**
+ * Sector layout of the good ID fields in g_list
+ */
+static void layout(const fdec_track_t *out, fmtc_format_t *fmt)
+{
+    uint32_t seen[256 / 32] = { 0 };
+
+    fmt->sectors = 0;
+    fmt->first_sector = 0xFF;
+    fmt->last_sector = 0;
+    fmt->size_code = 0;
+
+    for (uint8_t i = 0; i < out->count; i++) {
+        const fdec_sector_t *s = &out->list[i];
+        uint32_t bit = 1u << (s->sector & 31);
+
+        if (!(s->flags & FDEC_SEC_ID_OK)) {
+            continue;
+        }
+        if (fmt->sectors == 0) {
+            fmt->size_code = s->size_code;
+        }
+        if (!(seen[s->sector >> 5] & bit)) {
+            seen[s->sector >> 5] |= bit;
+            fmt->sectors++;
+        }
+        if (s->sector < fmt->first_sector) {
+            fmt->first_sector = s->sector;
+        }
+        if (s->sector > fmt->last_sector) {
+            fmt->last_sector = s->sector;
+        }
+    }
+}
+
+/**
+ * Check a decode against the predicted layout
+ *
+ * Every good ID field must carry the predicted size and a sector number
+ * inside the predicted range. Missing sectors are fine: a damaged track
+ * is still the same format.
+ */
+static bool layout_fits(const fdec_track_t *out, const fmtc_format_t *fmt)
+{
+    bool any = false;
+
+    for (uint8_t i = 0; i < out->count; i++) {
+        const fdec_sector_t *s = &out->list[i];
+
+        if (!(s->flags & FDEC_SEC_ID_OK)) {
+            continue;
+        }
+        if (s->size_code != fmt->size_code ||
+            s->sector < fmt->first_sector || s->sector > fmt->last_sector) {
+            return false;
+        }
+        any = true;
+    }
+    return any;
+}
+
+/*============================================================================
+ * API Implementation
+ *============================================================================*/
+
+void fmtc_reset(uint8_t drive)
+{
+    if (drive == FMTC_ALL_DRIVES) {
+        memset(g_drive, 0, sizeof(g_drive));
+    } else if (drive < FMTC_DRIVES) {
+        memset(&g_drive[drive], 0, sizeof(g_drive[drive]));
+    }
+}
+
+int fmtc_probe(const uint32_t *words, uint32_t count, fmtc_format_t *fmt)
+{
+    fdec_track_t out;
+    uint32_t best = CAND_COUNT;
+    uint32_t best_sectors = 0, best_ids = 0;
+
+    for (uint32_t c = 0; c < CAND_COUNT; c++) {
+        uint32_t ids = decode(words, count, g_cand[c].encoding,
+                              g_cand[c].data_rate, &out);
+
+        if (ids == 0) {
+            continue;
+        }
+        if (best == CAND_COUNT || out.sectors > best_sectors ||
+            (out.sectors == best_sectors && ids > best_ids)) {
+            best = c;
+            best_sectors = out.sectors;
+            best_ids = ids;
+        }
+    }
+
+    if (best == CAND_COUNT) {
+        return FLUXSTAT_ERR_NO_DATA;
+    }
+
+    /* Decode the winner again for its sector list */
+    decode(words, count, g_cand[best].encoding, g_cand[best].data_rate, &out);
+    fmt->encoding = g_cand[best].encoding;
+    fmt->data_rate = g_cand[best].data_rate;
+    layout(&out, fmt);
+    return FLUXSTAT_OK;
+}
+
+int fmtc_identify(uint8_t drive, const uint32_t *words, uint32_t count,
+                  fmtc_format_t *fmt)
+{
+    fdec_track_t out;
+    int ret;
+
+    if (drive >= FMTC_DRIVES || fmt == NULL) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+    g_drive[drive].stats.tracks++;
+
+    if (g_drive[drive].valid) {
+        const fmtc_format_t *p = &g_drive[drive].fmt;
+
+        if (decode(words, count, p->encoding, p->data_rate, &out) > 0 &&
+            layout_fits(&out, p)) {
+            g_drive[drive].stats.hits++;
+            *fmt = *p;
+            return FLUXSTAT_OK;
+        }
+        g_drive[drive].stats.mismatches++;
+    }
+
+    g_drive[drive].stats.probes++;
+    ret = fmtc_probe(words, count, fmt);
+    if (ret != FLUXSTAT_OK) {
+        g_drive[drive].stats.unknown++;
+        return ret;
+    }
+
+    g_drive[drive].fmt = *fmt;
+    g_drive[drive].valid = true;
+    return FLUXSTAT_OK;
+}
+
+bool fmtc_get(uint8_t drive, fmtc_format_t *fmt)
+{
+    if (drive >= FMTC_DRIVES || !g_drive[drive].valid) {
+        return false;
+    }
+    if (fmt != NULL) {
+        *fmt = g_drive[drive].fmt;
+    }
+    return true;
+}
+
+void fmtc_get_stats(uint8_t drive, fmtc_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (drive < FMTC_DRIVES) {
+        *stats = g_drive[drive].stats;
+    } else {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
@@ -0,0 +1,274 @@
+/*-----------------------------------------------------------------------------
+ * gw_flux.c
+ * Greaseweazle Flux Stream Encoding
+ *
+ * Created: 2025-12-09 11:20
+ *
+ * Stream format (greaseweazle-firmware, floppy.c):
+ *   1-249       one byte, interval in ticks
+ *   250-1524    two bytes: 250 + (v-250)/255, 1 + (v-250)%255
+ *   1525+       0xFF FLUXOP_SPACE N28(v-249), then 249
+ *   index       0xFF FLUXOP_INDEX N28(ticks since the last transition)
+ *   0x00        end of stream
+ *---------------------------------------------------------------------------*/
+
+#include "gw_flux.h"
+#include "raw_protocol.h"
+#include <string.h>
+
+/*---------------------------------------------------------------------------
+ * Private Functions
+ *---------------------------------------------------------------------------*/
+
+/*
+ * x / 25 for any 32-bit x without a divide (-Os would otherwise emit one
+ * per flux word): 0x51EB851F = ceil(2^35 / 25).
+ */
+static inline uint32_t div25(uint32_t x)
+{
+    return (uint32_t)(((uint64_t)x * 0x51EB851Fu) >> 35);
+}
+
+static inline uint8_t *put_n28(uint8_t *p, uint32_t v)
+{
+    *p++ = (uint8_t)N28_BYTE0(v);
+    *p++ = (uint8_t)N28_BYTE1(v);
+    *p++ = (uint8_t)N28_BYTE2(v);
+    *p++ = (uint8_t)N28_BYTE3(v);
+    return p;
+}
+
+static inline uint32_t get_n28(const uint8_t *p)
+{
+    return ((uint32_t)(p[0] >> 1)) |
+           ((uint32_t)(p[1] & 0xFE) << 6) |
+           ((uint32_t)(p[2] & 0xFE) << 13) |
+           ((uint32_t)(p[3] & 0xFE) << 20);
+}
+
+static inline uint8_t *put_interval(uint8_t *p, uint32_t v)
+{
+    if (v == 0) {
+        /* Coincident transitions: nothing to send */
+    } else if (v <= FLUX_MAX_DIRECT) {
+        *p++ = (uint8_t)v;
+    } else if (v <= FLUX_2BYTE_MAX) {
+        *p++ = (uint8_t)FLUX_2BYTE_HI(v);
+        *p++ = (uint8_t)FLUX_2BYTE_LO(v);
+    } else {
+        *p++ = FLUX_OPCODE_MARKER;
+        *p++ = FLUXOP_SPACE;
+        p = put_n28(p, v - FLUX_MAX_DIRECT);
+        *p++ = FLUX_MAX_DIRECT;
+    }
+    return p;
+}
+
+/*---------------------------------------------------------------------------
+ * Encoder
+ *---------------------------------------------------------------------------*/
+
+void gw_flux_enc_init(gw_flux_enc_t *e, uint32_t max_ticks, uint16_t max_index,
+                      uint32_t linger_ticks)
+{
+    memset(e, 0, sizeof(*e));
+    e->max_ticks = max_ticks;
+    e->max_index = max_index;
+    e->linger_ticks = linger_ticks;
+}
+
+uint32_t gw_flux_encode(gw_flux_enc_t *e, const uint32_t *words, uint32_t n,
+                        uint8_t *dst, uint32_t *consumed)
+{
+    uint8_t *p = dst;
+    uint32_t i;
+
+    for (i = 0; i < n && !e->done; i++) {
+        uint32_t word = words[i];
+        uint32_t ts = FLUX_TIMESTAMP(word);
+        uint32_t t = 0;
+
+        if (e->started) {
+            /* Clocks * 9 / 25, carrying the remainder */
+            uint32_t acc = ((ts - e->prev_ts) & FLUX_TIMESTAMP_MASK) * GW_FLUX_TICK_MUL + e->rem;
+            t = div25(acc);
+            e->rem = acc - t * GW_FLUX_CLK_DIV;
+        }
+        e->started = true;
+        e->prev_ts = ts;
+        e->since_flux += t;
+        e->since_index += t;
+        e->ticks += t;
+
+        if (FLUX_IS_INDEX(word)) {
+            /* Index marks carry a time, not a transition */
+            if (e->index_count < GW_FLUX_INDEX_TIMES) {
+                e->index_times[e->index_count] = e->since_index;
+            }
+            e->index_count++;
+            e->since_index = 0;
+            *p++ = FLUX_OPCODE_MARKER;
+            *p++ = FLUXOP_INDEX;
+            p = put_n28(p, e->since_flux);
+        } else if (!FLUX_IS_OVERFLOW(word)) {
+            p = put_interval(p, e->since_flux);
+            e->since_flux = 0;
+        }
+
+        if ((e->max_ticks && e->ticks >= e->max_ticks) ||
+            (e->max_index && e->index_count >= e->max_index &&
+             e->since_index >= e->linger_ticks)) {
+            e->done = true;
+        }
+    }
+
+    if (consumed) {
+        *consumed = i;
+    }
+    return (uint32_t)(p - dst);
+}
+
+/*---------------------------------------------------------------------------
+ * Decoder
+ *---------------------------------------------------------------------------*/
+
+void gw_flux_dec_init(gw_flux_dec_t *d)
+{
+    memset(d, 0, sizeof(*d));
+}
+
+/* Ticks * 25 / 9, carrying the remainder */
+static uint32_t dec_to_clocks(gw_flux_dec_t *d, uint32_t ticks)
+{
+    uint64_t acc = (uint64_t)ticks * GW_FLUX_CLK_DIV + d->rem;
+    uint32_t clocks;
+
+    if (acc <= UINT32_MAX) {
+        clocks = (uint32_t)acc / GW_FLUX_TICK_MUL;
+    } else {
+        clocks = (uint32_t)(acc / GW_FLUX_TICK_MUL);
+    }
+    d->rem = (uint32_t)(acc - (uint64_t)clocks * GW_FLUX_TICK_MUL);
+    return clocks;
+}
+
+static bool dec_emit(gw_flux_dec_t *d, uint32_t ticks, uint32_t *out, uint32_t cap)
+{
+    if (d->count >= cap) {
+        return false;
+    }
+    d->ts += dec_to_clocks(d, ticks);
+    out[d->count++] = d->ts & FLUX_TIMESTAMP_MASK;
+    return true;
+}
+
+/* A transition 'v' ticks on from the last one (plus any SPACE pending) */
+static bool dec_interval(gw_flux_dec_t *d, uint32_t v, uint32_t *out, uint32_t cap)
+{
+    uint32_t total = d->pending + v;
+
+    d->pending = 0;
+    d->ticks += v;
+
+    /* ASTABLE: regular transitions at its period up to this one */
+    if (d->astable) {
+        while (total > d->astable) {
+            if (!dec_emit(d, d->astable, out, cap)) {
+                return false;
+            }
+            total -= d->astable;
+        }
+        d->astable = 0;
+    }
+
+    return dec_emit(d, total, out, cap);
+}
+
+gw_dec_status_t gw_flux_decode(gw_flux_dec_t *d, const uint8_t *src, uint32_t len,
+                               uint32_t *out, uint32_t cap, uint32_t *used)
+{
+    gw_dec_status_t status = GW_DEC_MORE;
+    uint32_t i = 0;
+
+    while (i < len) {
+        uint8_t need;
+
+        /* Stop at a token boundary so no input is lost */
+        if (d->count >= cap) {
+            status = GW_DEC_FULL;
+            break;
+        }
+
+        if (d->tok_len == 0) {
+            uint8_t b = src[i];
+
+            /* Common case, no token buffering */
+            if (b != 0 && b <= FLUX_MAX_DIRECT) {
+                if (!dec_interval(d, b, out, cap)) {
+                    status = GW_DEC_FULL;
+                    break;
+                }
+                i++;
+                continue;
+            }
+            if (b == FLUX_STREAM_END) {
+                i++;
+                status = GW_DEC_END;
+                break;
+            }
+        }
+
+        d->tok[d->tok_len++] = src[i++];
+
+        if (d->tok[0] != FLUX_OPCODE_MARKER) {
+            need = 2;
+        } else if (d->tok_len < 2) {
+            continue;
+        } else {
+            need = 6;
+        }
+        if (d->tok_len < need) {
+            continue;
+        }
+        d->tok_len = 0;
+
+        if (need == 2) {
+            uint32_t v = FLUX_2BYTE_MIN + (uint32_t)(d->tok[0] - FLUX_2BYTE_MIN) * 255 +
+                         (uint32_t)(d->tok[1] - 1);
+            if (d->tok[1] == 0) {
+                status = GW_DEC_BAD;
+                break;
+            }
+            if (!dec_interval(d, v, out, cap)) {
+                status = GW_DEC_FULL;
+                break;
+            }
+            continue;
+        }
+
+        uint32_t n28 = get_n28(&d->tok[2]);
+        switch (d->tok[1]) {
+            case FLUXOP_SPACE:
+                d->pending += n28;
+                d->ticks += n28;
+                break;
+            case FLUXOP_ASTABLE:
+                d->astable = n28;
+                break;
+            case FLUXOP_INDEX:
+                /* Capture-side information only */
+                break;
+            default:
+                status = GW_DEC_BAD;
+                break;
+        }
+        if (status != GW_DEC_MORE) {
+            break;
+        }
+    }
+
+    if (used) {
+        *used = i;
+    }
+    return status;
+}
@@ -0,0 +1,906 @@
+/*-----------------------------------------------------------------------------
+ * gw_mode.c
+ * Greaseweazle Compatibility Mode Handler
+ *
+ * Created: 2025-12-09 11:40
+ *
+ * Command set and data phases of the Greaseweazle personality. READ_FLUX
+ * runs the capture DMA like raw mode, but each completed DMA chunk is
+ * encoded word by word into the bulk IN segment about to be sent, so the
+ * only 32-bit copy of the flux is the one the DMA wrote.
+ *---------------------------------------------------------------------------*/
+
+#include "gw_mode.h"
+#include "gw_flux.h"
+#include "raw_protocol.h"
+#include "fluxripper_hal.h"
+#include "platform.h"
+#include "timer.h"
+#include <string.h>
+
+/*---------------------------------------------------------------------------
+ * Buffers (HyperRAM track buffer A)
+ *
+ * DMA chunks are small so one completes every few milliseconds even on a
+ * DD track; IN segments hold several encoded chunks, so a host that keeps
+ * up gets short segments and one that falls behind gets large ones.
+ *---------------------------------------------------------------------------*/
+
+#define GW_BUF_BASE         TRACK_BUF_A_BASE
+
+#define GW_DMA_CHUNKS       4
+#define GW_DMA_CHUNK_SIZE   (4 * 1024)
+#define GW_DMA_CHUNK_WORDS  (GW_DMA_CHUNK_SIZE / sizeof(uint32_t))
+
+/* Worst case for one chunk, plus the stream terminator */
+#define GW_ENC_MAX          (GW_DMA_CHUNK_WORDS * GW_FLUX_MAX_TOKEN + 1)
+
+#define GW_SEGS             2
+#define GW_SEG_SIZE         (32 * 1024)
+
+#define GW_SEG_BASE         (GW_BUF_BASE + GW_DMA_CHUNKS * GW_DMA_CHUNK_SIZE)
+
+/* WRITE_FLUX staging: decoded transition times, rest of the buffer */
+#define GW_WRITE_BASE       (GW_SEG_BASE + GW_SEGS * GW_SEG_SIZE)
+#define GW_WRITE_WORDS      ((TRACK_BUF_A_BASE + TRACK_BUF_A_SIZE - GW_WRITE_BASE) / sizeof(uint32_t))
+
+/* No index within this long: ACK_NO_INDEX */
+#define GW_INDEX_TIMEOUT_US 2000000
+
+/* Bandwidth is sampled over at least this many bytes */
+#define GW_BW_WINDOW        (16 * 1024)
+
+typedef enum {
+    PHASE_IDLE = 0,
+    PHASE_READ,                     /* READ_FLUX stream */
+    PHASE_SOURCE,                   /* SOURCE_BYTES */
+    PHASE_WRITE,                    /* WRITE_FLUX OUT stream */
+    PHASE_SINK,                     /* SINK_BYTES */
+    PHASE_STATUS                    /* Closing status byte */
+} gw_phase_t;
+
+typedef enum {
+    SEG_FREE = 0,
+    SEG_FILLING,                    /* Taking encoded chunks */
+    SEG_READY,                      /* Closed, waiting for the host */
+    SEG_SENDING                     /* Handed to the bulk endpoint */
+} seg_state_t;
+
+/*---------------------------------------------------------------------------
+ * Private Data
+ *---------------------------------------------------------------------------*/
+
+static struct {
+    bool        selected;
+    uint8_t     unit;
+    uint8_t     bus_type;
+    uint8_t     head;
+    bool        motor[2];
+    gw_delays_t delays;
+    uint8_t     flux_status;        /* CMD_GET_FLUX_STATUS */
+    uint8_t     phase;              /* gw_phase_t */
+    uint8_t     status_byte;        /* PHASE_STATUS payload */
+    bool        status_out;
+} gw;
+
+/* Bulk IN pipeline */
+static struct {
+    /* Capture DMA */
+    bool        dma_busy;
+    bool        capture_done;       /* Engine stopped or finished */
+    bool        stopped;            /* Stopped here: no TLAST will come */
+    bool        terminated;         /* Terminator written */
+    uint8_t     chunk_full[GW_DMA_CHUNKS];
+    uint32_t    chunk_len[GW_DMA_CHUNKS];
+    uint8_t     dma_fill;           /* Next chunk to arm */
+    uint8_t     dma_enc;            /* Next chunk to encode */
+    uint32_t    start_us;
+
+    /* IN segments */
+    uint8_t     seg_state[GW_SEGS];
+    uint32_t    seg_len[GW_SEGS];
+    uint8_t     seg_fill;
+    uint8_t     seg_send;
+    uint8_t     seg_release;
+
+    /* SOURCE_BYTES / SINK_BYTES */
+    uint32_t    todo;
+    uint32_t    seed;
+} in;
+
+static gw_flux_enc_t enc;
+static gw_flux_dec_t dec;
+static bool sink_discard;           /* Skipping to the terminator */
+
+static struct {
+    gw_bw_stats_t stats;
+    bool        valid;
+    uint32_t    bytes;              /* In the current window */
+    uint32_t    start_us;
+} bw;
+
+/*---------------------------------------------------------------------------
+ * Private Functions
+ *---------------------------------------------------------------------------*/
+
+static inline uint8_t *dma_chunk(uint8_t i)
+{
+    return (uint8_t *)(GW_BUF_BASE + (uint32_t)i * GW_DMA_CHUNK_SIZE);
+}
+
+static inline uint8_t *seg_buf(uint8_t i)
+{
+    return (uint8_t *)(GW_SEG_BASE + (uint32_t)i * GW_SEG_SIZE);
+}
+
+static inline uint32_t flux_stat_addr(void)
+{
+    return (gw.unit == DRIVE_A) ? FDC_FLUX_STAT_A : FDC_FLUX_STAT_B;
+}
+
+static inline uint32_t now_us(void)
+{
+    return (uint32_t)timer_get_us();
+}
+
+/* Greaseweazle SOURCE/SINK_BYTES byte generator */
+static inline uint32_t ss_rand_next(uint32_t x)
+{
+    return (x & 1) ? (x >> 1) ^ 0x80000062 : x >> 1;
+}
+
+static inline uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*
+ * Bandwidth: bytes over wall time, in windows of at least GW_BW_WINDOW,
+ * measured from the first byte of a data phase. This is what the host
+ * sees, endpoint and firmware together.
+ */
+static void bw_begin(void)
+{
+    bw.bytes = 0;
+    bw.start_us = now_us();
+}
+
+static void bw_sample(void)
+{
+    uint32_t us = now_us() - bw.start_us;
+    gw_bw_t s = { bw.bytes, us ? us : 1 };
+
+    if (bw.bytes == 0) {
+        return;
+    }
+
+    /* Compare bytes/us by cross-multiplying */
+    if (!bw.valid ||
+        (uint64_t)s.bytes * bw.stats.min_bw.usecs < (uint64_t)bw.stats.min_bw.bytes * s.usecs) {
+        bw.stats.min_bw = s;
+    }
+    if (!bw.valid ||
+        (uint64_t)s.bytes * bw.stats.max_bw.usecs > (uint64_t)bw.stats.max_bw.bytes * s.usecs) {
+        bw.stats.max_bw = s;
+    }
+    bw.valid = true;
+    bw_begin();
+}
+
+static void bw_account(uint32_t bytes)
+{
+    bw.bytes += bytes;
+    if (bw.bytes >= GW_BW_WINDOW) {
+        bw_sample();
+    }
+}
+
+static void in_reset(void)
+{
+    memset(&in, 0, sizeof(in));
+}
+
+static void dma_arm(void)
+{
+    uint8_t i = in.dma_fill;
+
+    if (in.dma_busy || in.capture_done || in.chunk_full[i]) {
+        return;
+    }
+
+    in.dma_busy = true;
+    DMA_S2MM_DA = (uint32_t)dma_chunk(i);
+    DMA_S2MM_LENGTH = GW_DMA_CHUNK_SIZE;    /* Starts the transfer */
+}
+
+static void capture_cb(uint8_t drive, const uint32_t *data, uint32_t length, bool done)
+{
+    (void)drive;
+    (void)data;
+    (void)length;
+
+    if (done) {
+        in.capture_done = true;
+    }
+}
+
+/* Stop the engine here (limit reached, timeout, error) */
+static void capture_stop(uint8_t status)
+{
+    if (!in.capture_done || in.dma_busy) {
+        hal_stop_flux_capture(gw.unit);
+        in.stopped = true;
+    }
+    in.capture_done = true;
+    if (gw.flux_status == ACK_OKAY) {
+        gw.flux_status = status;
+    }
+}
+
+/* The segment taking encoded data, or NULL if both are with the host */
+static uint8_t *seg_open(uint32_t need)
+{
+    uint8_t i = in.seg_fill;
+
+    if (in.seg_state[i] == SEG_FILLING && in.seg_len[i] + need > GW_SEG_SIZE) {
+        in.seg_state[i] = SEG_READY;
+        in.seg_fill = i = (i + 1) % GW_SEGS;
+    }
+    if (in.seg_state[i] == SEG_FREE) {
+        in.seg_state[i] = SEG_FILLING;
+        in.seg_len[i] = 0;
+    }
+    return (in.seg_state[i] == SEG_FILLING) ? seg_buf(i) + in.seg_len[i] : NULL;
+}
+
+static void read_poll(void)
+{
+    if (in.dma_busy) {
+        uint32_t sr = DMA_S2MM_DMASR;
+
+        if (sr & DMA_SR_ERR_IRQ) {
+            DMA_S2MM_DMASR = DMA_SR_ERR_IRQ;
+            in.dma_busy = false;
+            capture_stop(ACK_FLUX_OVERFLOW);
+        } else if (sr & DMA_SR_IOC_IRQ) {
+            /* Chunk complete: full, or cut short by TLAST */
+            uint8_t i = in.dma_fill;
+
+            DMA_S2MM_DMASR = DMA_SR_IOC_IRQ;
+            in.dma_busy = false;
+            in.chunk_len[i] = DMA_S2MM_LENGTH / sizeof(uint32_t);
+            in.chunk_full[i] = 1;
+            in.dma_fill = (i + 1) % GW_DMA_CHUNKS;
+        }
+    }
+
+    /* Keep the DMA running while chunks are encoded */
+    dma_arm();
+
+    /* Encode completed chunks straight into the IN segment */
+    while (in.chunk_full[in.dma_enc] && !enc.done) {
+        uint8_t i = in.dma_enc;
+        uint8_t *dst = seg_open(GW_ENC_MAX);
+
+        if (dst == NULL) {
+            break;
+        }
+
+        in.seg_len[in.seg_fill] +=
+            gw_flux_encode(&enc, (const uint32_t *)dma_chunk(i), in.chunk_len[i], dst, NULL);
+
+        in.chunk_full[i] = 0;
+        in.dma_enc = (i + 1) % GW_DMA_CHUNKS;
+        dma_arm();
+    }
+
+    if (enc.done && !in.capture_done) {
+        capture_stop(ACK_OKAY);
+    }
+
+    /* All chunks with the host and the FIFO could not wait */
+    if (REG32(flux_stat_addr()) & FLUX_STAT_OVERFLOW) {
+        capture_stop(ACK_FLUX_OVERFLOW);
+    }
+
+    if (enc.max_index && enc.index_count == 0 &&
+        now_us() - in.start_us > GW_INDEX_TIMEOUT_US) {
+        capture_stop(ACK_NO_INDEX);
+    }
+
+    if (in.capture_done && in.dma_busy && in.stopped) {
+        /* Stopped mid-chunk: no TLAST will come */
+        DMA_S2MM_DMACR = DMA_CR_RESET;
+        in.dma_busy = false;
+    }
+
+    /* Drained: terminate the stream, drop anything past the limit */
+    if (in.capture_done && !in.dma_busy && !in.terminated &&
+        (enc.done || !in.chunk_full[in.dma_enc])) {
+        uint8_t *dst = seg_open(1);
+
+        if (dst != NULL) {
+            *dst = FLUX_STREAM_END;
+            in.seg_len[in.seg_fill]++;
+            in.seg_state[in.seg_fill] = SEG_READY;
+            in.terminated = true;
+            memset(in.chunk_full, 0, sizeof(in.chunk_full));
+        }
+    }
+}
+
+static void source_poll(void)
+{
+    uint8_t i = in.seg_fill;
+
+    while (in.todo > 0 && in.seg_state[i] == SEG_FREE) {
+        uint32_t n = (in.todo < GW_SEG_SIZE) ? in.todo : GW_SEG_SIZE;
+        uint8_t *p = seg_buf(i);
+
+        for (uint32_t k = 0; k < n; k++) {
+            p[k] = (uint8_t)in.seed;
+            in.seed = ss_rand_next(in.seed);
+        }
+
+        in.seg_len[i] = n;
+        in.seg_state[i] = SEG_READY;
+        in.todo -= n;
+        in.seg_fill = i = (i + 1) % GW_SEGS;
+    }
+}
+
+static bool in_drained(void)
+{
+    for (int i = 0; i < GW_SEGS; i++) {
+        if (in.seg_state[i] != SEG_FREE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void finish(uint8_t status)
+{
+    gw.status_byte = status;
+    gw.status_out = false;
+    gw.phase = PHASE_STATUS;
+    bw_sample();
+}
+
+/*
+ * The FDC has no flux-level write channel in this bitstream, so a decoded
+ * WRITE_FLUX stream ends at the staging buffer and is refused here.
+ */
+static uint8_t write_commit(uint32_t count)
+{
+    (void)count;
+    return hal_write_protected(gw.unit) ? ACK_WRPROT : ACK_BAD_COMMAND;
+}
+
+/*---------------------------------------------------------------------------
+ * Command Handlers
+ *---------------------------------------------------------------------------*/
+
+static uint8_t drive_check(void)
+{
+    if (gw.bus_type == BUS_NONE) {
+        return ACK_NO_BUS;
+    }
+    if (!gw.selected) {
+        return ACK_NO_UNIT;
+    }
+    return ACK_OKAY;
+}
+
+static uint8_t cmd_get_info(uint8_t index, uint8_t *data)
+{
+    memset(data, 0, 32);
+
+    switch (index) {
+        case GETINFO_FIRMWARE: {
+            gw_info_t *info = (gw_info_t *)data;
+            info->fw_major = GW_FW_MAJOR;
+            info->fw_minor = GW_FW_MINOR;
+            info->is_main_firmware = GW_IS_MAIN_FIRMWARE;
+            info->max_cmd = CMD_MAX;
+            info->sample_freq = GW_SAMPLE_FREQ;
+            info->hw_model = GW_HW_MODEL;
+            info->hw_submodel = GW_HW_SUBMODEL;
+            info->usb_speed = GW_USB_SPEED;
+            info->mcu_id = GW_MCU_ID;
+            info->mcu_mhz = GW_MCU_MHZ;
+            info->mcu_sram_kb = GW_MCU_SRAM_KB;
+            info->usb_buf_kb = GW_USB_BUF_KB;
+            return ACK_OKAY;
+        }
+
+        case GETINFO_BW_STATS:
+            memcpy(data, &bw.stats, sizeof(bw.stats));
+            return ACK_OKAY;
+
+        case GETINFO_CURRENT_DRIVE: {
+            gw_drive_info_t *d = (gw_drive_info_t *)data;
+            if (gw.selected) {
+                d->flags = (1 << 0) | (1 << 1) | (gw.motor[gw.unit] ? (1 << 2) : 0);
+                d->cylinder = hal_get_track(gw.unit);
+            }
+            return ACK_OKAY;
+        }
+
+        default:
+            return ACK_BAD_COMMAND;
+    }
+}
+
+static uint8_t cmd_read_flux(const uint8_t *p, uint8_t len)
+{
+    uint8_t ack = drive_check();
+    uint32_t ticks, linger = 0;
+    uint16_t max_index;
+    uint8_t revs;
+
+    if (ack != ACK_OKAY) {
+        return ack;
+    }
+    if (len < 8) {
+        return ACK_BAD_COMMAND;
+    }
+
+    ticks = get_u32(&p[2]);
+    max_index = (uint16_t)(p[6] | (p[7] << 8));
+    if (len >= 12) {
+        linger = get_u32(&p[8]) * (GW_SAMPLE_FREQ / 1000000);
+    }
+
+    /* Enough revolutions for the index limit and any linger past it */
+    revs = 255;
+    if (max_index && max_index < 255) {
+        revs = (uint8_t)(max_index + (linger ? 1 : 0));
+    }
+
+    in_reset();
+    gw_flux_enc_init(&enc, ticks, max_index, linger);
+    gw.flux_status = ACK_OKAY;
+    in.start_us = now_us();
+
+    /* DMA first, so the capture FIFO drains from the first transition */
+    DMA_S2MM_DMACR = DMA_CR_RESET;
+    while (DMA_S2MM_DMACR & DMA_CR_RESET) {
+    }
+    DMA_S2MM_DMACR = DMA_CR_RS | DMA_CR_IOC_IRQ_EN | DMA_CR_ERR_IRQ_EN;
+    dma_arm();
+
+    if (hal_arm_flux_capture(gw.unit, gw.head, revs, capture_cb) != HAL_OK) {
+        DMA_S2MM_DMACR = DMA_CR_RESET;
+        in_reset();
+        return hal_disk_present(gw.unit) ? ACK_NO_INDEX : ACK_NO_UNIT;
+    }
+
+    gw.phase = PHASE_READ;
+    bw_begin();
+    return ACK_OKAY;
+}
+
+static uint8_t cmd_write_flux(uint8_t len)
+{
+    uint8_t ack = drive_check();
+
+    if (ack != ACK_OKAY) {
+        return ack;
+    }
+    if (len < 4) {
+        return ACK_BAD_COMMAND;
+    }
+    if (hal_write_protected(gw.unit)) {
+        return ACK_WRPROT;
+    }
+
+    gw_flux_dec_init(&dec);
+    sink_discard = false;
+    gw.flux_status = ACK_OKAY;
+    gw.phase = PHASE_WRITE;
+    bw_begin();
+    return ACK_OKAY;
+}
+
+static uint8_t cmd_source_sink(const uint8_t *p, uint8_t len, bool source)
+{
+    if (len < 6) {
+        return ACK_BAD_COMMAND;
+    }
+
+    in_reset();
+    in.todo = get_u32(&p[2]);
+    in.seed = (len >= 10) ? get_u32(&p[6]) : 0;
+    gw.status_byte = ACK_OKAY;
+
+    if (in.todo == 0) {
+        if (!source) {
+            finish(ACK_OKAY);
+        }
+        return ACK_OKAY;
+    }
+
+    gw.phase = source ? PHASE_SOURCE : PHASE_SINK;
+    bw_begin();
+    if (source) {
+        source_poll();
+    }
+    return ACK_OKAY;
+}
+
+/*---------------------------------------------------------------------------
+ * Public Functions - Initialization
+ *---------------------------------------------------------------------------*/
+
+int gw_mode_init(void)
+{
+    memset(&gw, 0, sizeof(gw));
+    memset(&bw, 0, sizeof(bw));
+    in_reset();
+
+    gw.delays.select_delay = DEFAULT_SELECT_DELAY;
+    gw.delays.step_delay = DEFAULT_STEP_DELAY;
+    gw.delays.seek_settle = DEFAULT_SEEK_SETTLE;
+    gw.delays.motor_delay = DEFAULT_MOTOR_DELAY;
+    gw.delays.watchdog = DEFAULT_WATCHDOG;
+    gw.delays.pre_write = DEFAULT_PRE_WRITE;
+    gw.delays.post_write = DEFAULT_POST_WRITE;
+    gw.delays.index_mask = DEFAULT_INDEX_MASK;
+    return 0;
+}
+
+void gw_mode_reset(void)
+{
+    if (gw.phase == PHASE_READ && !in.capture_done) {
+        hal_stop_flux_capture(gw.unit);
+        DMA_S2MM_DMACR = DMA_CR_RESET;
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        if (gw.motor[i]) {
+            hal_motor_release(i);
+        }
+    }
+
+    gw_bw_stats_t stats = bw.stats;
+    bool valid = bw.valid;
+    gw_mode_init();
+    bw.stats = stats;
+    bw.valid = valid;
+}
+
+/*---------------------------------------------------------------------------
+ * Public Functions - Command Processing
+ *---------------------------------------------------------------------------*/
+
+int gw_mode_process_command(const uint8_t *cmd, uint32_t len,
+                            uint8_t *response, uint32_t *response_len)
+{
+    uint8_t ack = ACK_OKAY;
+    uint32_t data_len = 0;
+    uint8_t *data = response + 2;
+
+    if (cmd == NULL || response == NULL || response_len == NULL) {
+        return -1;
+    }
+
+    response[0] = (len > 0) ? cmd[0] : 0;
+    *response_len = 2;
+
+    if (len < 2 || cmd[1] < 2 || cmd[1] > len) {
+        response[1] = ACK_BAD_COMMAND;
+        return -1;
+    }
+    if (gw.phase != PHASE_IDLE) {
+        /* A data phase owns the pipe until it completes */
+        response[1] = ACK_BAD_COMMAND;
+        return -1;
+    }
+
+    uint8_t n = cmd[1];
+
+    switch (cmd[0]) {
+        case CMD_GET_INFO:
+            ack = (n >= 3) ? cmd_get_info(cmd[2], data) : ACK_BAD_COMMAND;
+            data_len = (ack == ACK_OKAY) ? 32 : 0;
+            break;
+
+        case CMD_SEEK: {
+            int32_t cyl = (n >= 4) ? (int16_t)(cmd[2] | (cmd[3] << 8)) : (int8_t)cmd[2];
+            ack = drive_check();
+            if (ack == ACK_OKAY && n < 3) {
+                ack = ACK_BAD_COMMAND;
+            } else if (ack == ACK_OKAY && (cyl < 0 || cyl > 255)) {
+                ack = ACK_BAD_CYLINDER;
+            } else if (ack == ACK_OKAY && hal_seek(gw.unit, (uint8_t)cyl) != HAL_OK) {
+                ack = (cyl == 0) ? ACK_NO_TRK0 : ACK_BAD_CYLINDER;
+            }
+            break;
+        }
+
+        case CMD_NOCLICK_STEP:
+            ack = drive_check();
+            if (ack == ACK_OKAY && hal_seek(gw.unit, 0) != HAL_OK) {
+                ack = ACK_NO_TRK0;
+            }
+            break;
+
+        case CMD_HEAD:
+            if (n < 3 || cmd[2] > 1) {
+                ack = ACK_BAD_COMMAND;
+            } else {
+                gw.head = cmd[2];
+            }
+            break;
+
+        case CMD_SET_PARAMS:
+            if (n < 3 || cmd[2] != PARAMS_DELAYS) {
+                ack = ACK_BAD_COMMAND;
+            } else {
+                uint32_t k = n - 3;
+                memcpy(&gw.delays, &cmd[3], k < sizeof(gw.delays) ? k : sizeof(gw.delays));
+            }
+            break;
+
+        case CMD_GET_PARAMS:
+            if (n < 4 || cmd[2] != PARAMS_DELAYS || cmd[3] > sizeof(gw.delays)) {
+                ack = ACK_BAD_COMMAND;
+            } else {
+                memcpy(data, &gw.delays, cmd[3]);
+                data_len = cmd[3];
+            }
+            break;
+
+        case CMD_MOTOR:
+            if (n < 4) {
+                ack = ACK_BAD_COMMAND;
+            } else if (gw.bus_type == BUS_NONE) {
+                ack = ACK_NO_BUS;
+            } else if (cmd[2] > 1) {
+                ack = ACK_BAD_UNIT;
+            } else {
+                /* Motor-off idles out so the next read on the unit reuses it */
+                int ret = cmd[3] ? hal_motor_on(cmd[2]) : hal_motor_release(cmd[2]);
+                gw.motor[cmd[2]] = (cmd[3] != 0);
+                if (ret != HAL_OK) {
+                    ack = ACK_NO_UNIT;
+                }
+            }
+            break;
+
+        case CMD_READ_FLUX:
+            ack = cmd_read_flux(cmd, n);
+            break;
+
+        case CMD_WRITE_FLUX:
+            ack = cmd_write_flux(n);
+            break;
+
+        case CMD_GET_FLUX_STATUS:
+            ack = gw.flux_status;
+            break;
+
+        case CMD_GET_INDEX_TIMES: {
+            uint8_t first = (n >= 3) ? cmd[2] : 0;
+            uint8_t nr = (n >= 4) ? cmd[3] : GW_FLUX_INDEX_TIMES;
+            if (first + nr > GW_FLUX_INDEX_TIMES) {
+                ack = ACK_BAD_COMMAND;
+            } else {
+                memcpy(data, &enc.index_times[first], nr * sizeof(uint32_t));
+                data_len = nr * sizeof(uint32_t);
+            }
+            break;
+        }
+
+        case CMD_SELECT:
+            if (n < 3) {
+                ack = ACK_BAD_COMMAND;
+            } else if (gw.bus_type == BUS_NONE) {
+                ack = ACK_NO_BUS;
+            } else if (cmd[2] > 1) {
+                ack = ACK_BAD_UNIT;
+            } else {
+                gw.unit = cmd[2];
+                gw.selected = true;
+            }
+            break;
+
+        case CMD_DESELECT:
+            gw.selected = false;
+            break;
+
+        case CMD_SET_BUS_TYPE:
+            if (n < 3 || cmd[2] > BUS_SHUGART) {
+                ack = ACK_BAD_COMMAND;
+            } else {
+                gw.bus_type = cmd[2];
+            }
+            break;
+
+        case CMD_RESET:
+            gw_mode_reset();
+            break;
+
+        case CMD_SOURCE_BYTES:
+        case CMD_SINK_BYTES:
+            ack = cmd_source_sink(cmd, n, cmd[0] == CMD_SOURCE_BYTES);
+            break;
+
+        default:
+            ack = ACK_BAD_COMMAND;
+            break;
+    }
+
+    response[1] = ack;
+    *response_len = 2 + data_len;
+    return (ack == ACK_OKAY) ? 0 : -1;
+}
+
+/*---------------------------------------------------------------------------
+ * Public Functions - Data Phases
+ *---------------------------------------------------------------------------*/
+
+void gw_mode_stream_poll(void)
+{
+    switch (gw.phase) {
+        case PHASE_READ:
+            read_poll();
+            if (in.terminated && in_drained()) {
+                gw.phase = PHASE_IDLE;
+                bw_sample();
+            }
+            break;
+
+        case PHASE_SOURCE:
+            source_poll();
+            if (in.todo == 0 && in_drained()) {
+                gw.phase = PHASE_IDLE;
+                bw_sample();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+int gw_mode_stream_get(const uint8_t **data, uint32_t *len)
+{
+    if (data == NULL || len == NULL) {
+        return -1;
+    }
+
+    if (gw.phase == PHASE_STATUS) {
+        if (gw.status_out) {
+            return 0;
+        }
+        gw.status_out = true;
+        *data = &gw.status_byte;
+        *len = 1;
+        return 1;
+    }
+
+    gw_mode_stream_poll();
+
+    if (gw.phase != PHASE_READ && gw.phase != PHASE_SOURCE) {
+        return 0;
+    }
+
+    uint8_t i = in.seg_send;
+
+    /* Host waiting: send what has been encoded so far */
+    if (in.seg_state[i] == SEG_FILLING && in.seg_len[i] > 0) {
+        in.seg_state[i] = SEG_READY;
+        in.seg_fill = (i + 1) % GW_SEGS;
+    }
+
+    if (in.seg_state[i] != SEG_READY) {
+        return 0;
+    }
+
+    in.seg_state[i] = SEG_SENDING;
+    in.seg_send = (i + 1) % GW_SEGS;
+    *data = seg_buf(i);
+    *len = in.seg_len[i];
+    return 1;
+}
+
+void gw_mode_stream_release(void)
+{
+    if (gw.phase == PHASE_STATUS) {
+        if (gw.status_out) {
+            gw.phase = PHASE_IDLE;
+            gw.status_out = false;
+        }
+        return;
+    }
+
+    uint8_t i = in.seg_release;
+
+    if (in.seg_state[i] == SEG_SENDING) {
+        bw_account(in.seg_len[i]);
+        in.seg_state[i] = SEG_FREE;
+        in.seg_release = (i + 1) % GW_SEGS;
+    }
+
+    gw_mode_stream_poll();
+}
+
+uint32_t gw_mode_sink(const uint8_t *data, uint32_t len)
+{
+    uint32_t used = 0;
+
+    if (data == NULL) {
+        return 0;
+    }
+
+    if (gw.phase == PHASE_SINK) {
+        uint32_t n = (len < in.todo) ? len : in.todo;
+
+        for (uint32_t k = 0; k < n; k++) {
+            if (data[k] != (uint8_t)in.seed) {
+                gw.status_byte = ACK_BAD_COMMAND;
+            }
+            in.seed = ss_rand_next(in.seed);
+        }
+        in.todo -= n;
+        bw_account(n);
+        if (in.todo == 0) {
+            finish(gw.status_byte);
+        }
+        return n;
+    }
+
+    if (gw.phase != PHASE_WRITE) {
+        return 0;
+    }
+
+    if (sink_discard) {
+        /* Bad or oversized stream: consume through the terminator */
+        while (used < len && data[used] != FLUX_STREAM_END) {
+            used++;
+        }
+        if (used < len) {
+            used++;
+            finish(gw.flux_status);
+        }
+        bw_account(used);
+        return used;
+    }
+
+    gw_dec_status_t st = gw_flux_decode(&dec, data, len, (uint32_t *)GW_WRITE_BASE,
+                                        GW_WRITE_WORDS, &used);
+    bw_account(used);
+
+    switch (st) {
+        case GW_DEC_END:
+            gw.flux_status = write_commit(dec.count);
+            finish(gw.flux_status);
+            break;
+
+        case GW_DEC_FULL:
+        case GW_DEC_BAD:
+            gw.flux_status = (st == GW_DEC_FULL) ? ACK_OUT_OF_SRAM : ACK_BAD_COMMAND;
+            sink_discard = true;
+            used += gw_mode_sink(data + used, len - used);
+            break;
+
+        default:
+            break;
+    }
+
+    return used;
+}
+
+bool gw_mode_busy(void)
+{
+    return gw.phase != PHASE_IDLE;
+}
+
+void gw_mode_get_bw_stats(gw_bw_stats_t *stats)
+{
+    if (stats) {
+        *stats = bw.stats;
+    }
+}
@@ -10,6 +10,7 @@
 
 #include "cli.h"
 #include "hdd_hal.h"
+#include "hdd_profile_cache.h"
 #include "uart.h"
 #include <string.h>
 
@@ -135,11 +136,12 @@ int cmd_hdd_detect(int argc, char *argv[])
 }
 
 /**
- * hdd discover [drive] - Run full discovery pipeline
+ * hdd discover [drive] [quick] - Run full (or staged quick) discovery pipeline
  */
 int cmd_hdd_discover(int argc, char *argv[])
 {
     uint8_t drive = hdd_get_active_drive();
+    bool quick = (argc >= 3 && strcmp(argv[2], "quick") == 0);
 
     if (argc >= 2) {
         int d = parse_drive(argv[1]);
@@ -151,10 +153,12 @@ int cmd_hdd_discover(int argc, char *argv[])
     }
 
     uart_printf("Running HDD discovery pipeline on drive %d...\n", drive);
-    uart_puts("(This may take up to 60 seconds)\n\n");
+    uart_puts(quick ? "(Quick scan; full scan continues in background)\n\n"
+                    : "(This may take up to 60 seconds)\n\n");
 
     hdd_profile_t profile;
-    int ret = hdd_discover(drive, &profile);
+    int ret = quick ? hdd_discover_quick(drive, &profile)
+                    : hdd_discover(drive, &profile);
 
     if (ret != HAL_OK) {
         uart_printf("Discovery failed: %d\n", ret);
@@ -178,6 +182,8 @@ int cmd_hdd_discover(int argc, char *argv[])
     uart_printf("  Sectors:    %u\n", profile.geometry.sectors);
     uart_printf("  Sector sz:  %u bytes\n", profile.geometry.sector_size);
     uart_printf("  Interleave: %u\n", profile.geometry.interleave);
+    uart_printf("  Confidence: %u/255%s\n", profile.confidence,
+                profile.provisional ? " (provisional)" : "");
     uart_printf("  Capacity:   %u MB (%u sectors)\n",
                 profile.geometry.capacity_mb, profile.geometry.total_sectors);
 
@@ -590,58 +596,30 @@ int cmd_hdd_force(int argc, char *argv[])
 }
 
 /**
- * Main HDD command dispatcher
+ * hdd cache [clear] - Show or drop cached discovery profiles
  */
-int cmd_hdd(int argc, char *argv[])
+int cmd_hdd_cache(int argc, char *argv[])
 {
-    if (argc < 2) {
-        uart_puts("HDD Commands (Dual-Drive Support):\n");
-        uart_puts("  hdd status [d]       - Show drive status (default: both)\n");
-        uart_puts("  hdd select <d>       - Select active drive (0 or 1)\n");
-        uart_puts("  hdd detect [d]       - Detect interface type\n");
-        uart_puts("  hdd discover [d]     - Full discovery (geometry, health)\n");
-        uart_puts("  hdd seek <d> <c>     - Seek drive to cylinder\n");
-        uart_puts("  hdd seek-both <c0> <c1> - Parallel seek both drives\n");
-        uart_puts("  hdd recal <d>        - Recalibrate drive (seek to 0)\n");
-        uart_puts("  hdd read <d> <c> <h> <s> - Read sector\n");
-        uart_puts("  hdd geometry [d]     - Show geometry details\n");
-        uart_puts("  hdd health [d]       - Show health metrics\n");
-        uart_puts("  hdd force <type>     - Force type (mfm/rll/esdi)\n");
-        uart_puts("  hdd esdi-config [d]  - Query ESDI drive configuration\n");
-        uart_puts("\n  <d> = drive (0 or 1), [d] = optional (uses active drive)\n");
+    hdd_pcache_stats_t stats;
+
+    if (argc >= 2 && strcmp(argv[1], "clear") == 0) {
+        hdd_pcache_clear();
+        uart_puts("Profile cache cleared.\n");
         return 0;
     }
 
-    /* Dispatch to subcommand */
-    if (strcmp(argv[1], "select") == 0) {
-        return cmd_hdd_select(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "detect") == 0) {
-        return cmd_hdd_detect(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "discover") == 0) {
-        return cmd_hdd_discover(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "status") == 0) {
-        return cmd_hdd_status(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "seek") == 0) {
-        return cmd_hdd_seek(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "seek-both") == 0) {
-        return cmd_hdd_seek_both(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "recal") == 0) {
-        return cmd_hdd_recal(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "read") == 0) {
-        return cmd_hdd_read(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "geometry") == 0) {
-        return cmd_hdd_geometry(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "health") == 0) {
-        return cmd_hdd_health(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "force") == 0) {
-        return cmd_hdd_force(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "esdi-config") == 0) {
-        return cmd_hdd_esdi_config(argc - 1, &argv[1]);
-    } else {
-        uart_printf("Unknown HDD command: %s\n", argv[1]);
-        uart_puts("Type 'hdd' for available commands.\n");
-        return -1;
-    }
+    hdd_pcache_get_stats(&stats);
+
+    uart_puts("\nDiscovery Profile Cache\n");
+    uart_puts("-----------------------------------------\n");
+    uart_printf("  Entries:        %u/%u\n", stats.entries, PCACHE_SLOTS);
+    uart_printf("  Hits:           %lu\n", (unsigned long)stats.hits);
+    uart_printf("  Misses:         %lu\n", (unsigned long)stats.misses);
+    uart_printf("  Verify failed:  %lu\n", (unsigned long)stats.verify_failed);
+    uart_printf("  EEPROM:         %s\n", stats.eeprom_ok ? "OK" : "Unavailable (RAM only)");
+    uart_puts("-----------------------------------------\n");
+
+    return 0;
 }
 
 /*============================================================================
@@ -651,19 +629,35 @@ int cmd_hdd(int argc, char *argv[])
 /**
  * HDD CLI command definition for registration
  */
+static const cli_cmd_t hdd_subcmds[] = {
+    { "status",      "[d]        Show drive status (default: both)", cmd_hdd_status, 0, NULL },
+    { "select",      "<d>        Select active drive (0 or 1)",      cmd_hdd_select, 0, NULL },
+    { "detect",      "[d]        Detect interface type",             cmd_hdd_detect, 0, NULL },
+    { "discover",    "[d] [quick] Full discovery (geometry, health)", cmd_hdd_discover, 0, NULL },
+    { "seek",        "<d> <c>    Seek drive to cylinder",            cmd_hdd_seek, 0, NULL },
+    { "seek-both",   "<c0> <c1>  Parallel seek both drives",         cmd_hdd_seek_both, 0, NULL },
+    { "recal",       "<d>        Recalibrate drive (seek to 0)",     cmd_hdd_recal, 0, NULL },
+    { "read",        "<d> <c> <h> <s> Read sector",                  cmd_hdd_read, 0, NULL },
+    { "geometry",    "[d]        Show geometry details",             cmd_hdd_geometry, 0, NULL },
+    { "health",      "[d]        Show health metrics",               cmd_hdd_health, 0, NULL },
+    { "force",       "<type>     Force type (mfm/rll/esdi)",         cmd_hdd_force, 0, NULL },
+    { "esdi-config", "[d]        Query ESDI drive configuration",    cmd_hdd_esdi_config, 0, NULL },
+    { "cache",       "[clear]    Show/clear cached discovery profiles", cmd_hdd_cache, 0, NULL },
+    { NULL, NULL, NULL, 0, NULL }
+};
+
 const cli_cmd_t hdd_cli_cmd = {
-    "hdd", "HDD commands (dual-drive: status, detect, discover, seek, read)",
-    cmd_hdd
+    "hdd", "HDD commands (<d> = drive 0/1, [d] defaults to the active drive)",
+    NULL,
+    CLI_CMD_DRIVES,
+    hdd_subcmds
 };
+CLI_COMMAND(hdd_cli_cmd);
 
 /**
- * Initialize and register HDD CLI commands
+ * Initialize the HDD HAL (the command is linked in with CLI_COMMAND)
  */
 void hdd_cli_init(void)
 {
-    /* Initialize HDD HAL */
     hdd_hal_init();
-
-    /* Register HDD command */
-    cli_register(&hdd_cli_cmd);
 }
@@ -16,8 +16,76 @@
 
 #include "hdd_hal.h"
 #include "platform.h"
+#include "event.h"
+#include "timer.h"
 #include <string.h>
 
+/*============================================================================
+ * Local Helpers (platform-specific)
+ *============================================================================*/
+
+#ifndef delay_us
+static inline void delay_us(uint32_t us)
+{
+    /* Simple busy-wait for microseconds */
+    volatile uint32_t count = us * 10;  /* Adjust for clock speed */
+    while (count--);
+}
+#endif
+
+#ifndef valid_drive
+static inline bool valid_drive(uint8_t drive)
+{
+    return drive < HDD_NUM_DRIVES;
+}
+#endif
+
+#ifndef hdd_read_reg
+static inline uint32_t hdd_read_reg(uint32_t addr)
+{
+    return REG32(addr);
+}
+#endif
+
+#ifndef hdd_write_reg
+static inline void hdd_write_reg(uint32_t addr, uint32_t value)
+{
+    REG32(addr) = value;
+}
+#endif
+
+#ifndef delay_ms
+static inline void delay_ms(uint32_t ms)
+{
+    timer_delay_ms(ms);
+}
+#endif
+
+#ifndef wait_seek_done
+typedef struct {
+    uint8_t     drive;
+    uint32_t    status;         /* Status that ended the wait */
+} seek_wait_t;
+
+static bool seek_status_check(void *arg)
+{
+    seek_wait_t *w = (seek_wait_t *)arg;
+
+    w->status = hdd_read_reg(HDD_STATUS(w->drive));
+    return (w->status & (HDD_STAT_SEEK_DONE | HDD_STAT_SEEK_ERROR)) != 0;
+}
+
+static int wait_seek_done(uint8_t drive, uint32_t timeout_ms)
+{
+    seek_wait_t w = { drive, 0 };
+
+    if (!event_wait(NULL, seek_status_check, &w, timeout_ms)) {
+        return HAL_ERR_TIMEOUT;
+    }
+    return (w.status & HDD_STAT_SEEK_DONE) ? HAL_OK : HAL_ERR_HARDWARE;
+}
+#endif
+
 /*============================================================================
  * Additional Registers for Shared Cable Topology
  *============================================================================*/
@@ -46,14 +114,28 @@
 
 typedef struct {
     uint16_t    target_cylinder;    /* Pending seek target */
-    bool        seek_pending;       /* Seek waiting in queue */
     bool        seek_active;        /* Seek currently in progress */
 } drive_seek_state_t;
 
+/* Per-drive request queue (C-LOOK) */
+typedef struct {
+    hdd_req_t   *req[HDD_SCHED_DEPTH];  /* Waiting, in arrival order */
+    uint8_t     count;
+    hdd_req_t   *cur;               /* Being positioned or transferred */
+    bool        seeking;            /* Seek in flight */
+    uint16_t    seek_target;
+    uint32_t    seek_start_ms;
+    uint16_t    pos;                /* Cylinder the heads are on */
+    bool        pos_valid;          /* pos known (set by a queued seek) */
+    hdd_req_t   hint;               /* hdd_queue_seek() request */
+} drive_queue_t;
+
 static struct {
     uint8_t             current_ds;         /* Currently selected drive (DS0/DS1) */
     drive_seek_state_t  seek[HDD_NUM_DRIVES];
     bool                cable_busy;         /* Control cable in use */
+    drive_queue_t       queue[HDD_NUM_DRIVES];
+    uint8_t             last_xfer;          /* Drive of the last transfer */
 } dual_state = {
     .current_ds = HDD_DRIVE_0,
     .cable_busy = false
@@ -198,74 +280,413 @@ static int shared_cable_seek(uint8_t drive, uint16_t cylinder, bool wait)
     return HAL_OK;
 }
 
+/*============================================================================
+ * Request Queue (Elevator Ordering)
+ *============================================================================*/
+
 /**
- * Queue a seek for later execution
- * Useful when the control cable is busy with another drive
+ * Mirror queue occupancy into the hardware pending bits
  */
-int hdd_queue_seek(uint8_t drive, uint16_t cylinder)
+static void update_queue_reg(void)
 {
-    if (!valid_drive(drive)) {
-        return HAL_ERR_INVALID;
-    }
-
-    dual_state.seek[drive].target_cylinder = cylinder;
-    dual_state.seek[drive].seek_pending = true;
-
-    /* Update hardware queue register */
     uint32_t queue_ctrl = hdd_read_reg(HDD_SEEK_QUEUE_CTRL);
-    if (drive == HDD_DRIVE_0) {
+
+    queue_ctrl &= ~(SEEK_QUEUE_D0_PENDING | SEEK_QUEUE_D1_PENDING);
+    if (dual_state.queue[HDD_DRIVE_0].count || dual_state.queue[HDD_DRIVE_0].cur) {
         queue_ctrl |= SEEK_QUEUE_D0_PENDING;
-    } else {
+    }
+    if (dual_state.queue[HDD_DRIVE_1].count || dual_state.queue[HDD_DRIVE_1].cur) {
         queue_ctrl |= SEEK_QUEUE_D1_PENDING;
     }
+
     hdd_write_reg(HDD_SEEK_QUEUE_CTRL, queue_ctrl);
+}
+
+/**
+ * Take the next request in C-LOOK order off a drive's queue
+ * Nearest cylinder at or beyond the heads; once none is left in that
+ * direction, wrap to the lowest. Equal cylinders keep arrival order.
+ */
+static hdd_req_t *clook_next(drive_queue_t *q, uint16_t pos)
+{
+    int ahead = -1;
+    int wrap = -1;
+
+    for (int i = 0; i < q->count; i++) {
+        uint16_t cyl = q->req[i]->cylinder;
+
+        if (cyl >= pos) {
+            if (ahead < 0 || cyl < q->req[ahead]->cylinder) {
+                ahead = i;
+            }
+        } else if (wrap < 0 || cyl < q->req[wrap]->cylinder) {
+            wrap = i;
+        }
+    }
+
+    int pick = (ahead >= 0) ? ahead : wrap;
+    if (pick < 0) {
+        return NULL;
+    }
+
+    hdd_req_t *req = q->req[pick];
+    for (int i = pick; i < q->count - 1; i++) {
+        q->req[i] = q->req[i + 1];
+    }
+    q->count--;
+
+    return req;
+}
+
+/**
+ * Finish the request in service on a drive
+ */
+static void complete_current(uint8_t drive, int status)
+{
+    drive_queue_t *q = &dual_state.queue[drive];
+
+    if (q->cur != NULL) {
+        q->cur->status = status;
+        q->cur = NULL;
+    }
+    update_queue_reg();
+}
+
+int hdd_sched_submit(uint8_t drive, hdd_req_t *req)
+{
+    if (!valid_drive(drive) || req == NULL || req->count > HDD_TRACK_BUF_SECTORS) {
+        return HAL_ERR_INVALID;
+    }
+
+    drive_queue_t *q = &dual_state.queue[drive];
+    if (q->count >= HDD_SCHED_DEPTH) {
+        return HAL_ERR_BUSY;
+    }
+
+    req->status = HAL_ERR_BUSY;
+    q->req[q->count++] = req;
+    update_queue_reg();
 
     return HAL_OK;
 }
 
+int hdd_sched_poll(void)
+{
+    int outstanding = 0;
+
+    /* Get every drive with work moving towards its next cylinder */
+    for (uint8_t d = 0; d < HDD_NUM_DRIVES; d++) {
+        drive_queue_t *q = &dual_state.queue[d];
+
+        if (q->seeking) {
+            /* Seek completion is only visible while the drive is selected */
+            select_control_cable_drive(d);
+            int ret = hdd_seek_poll(d);
+            if (ret == HAL_ERR_BUSY) {
+                if ((timer_get_ms() - q->seek_start_ms) < HDD_SCHED_SEEK_MS) {
+                    continue;
+                }
+                ret = HAL_ERR_TIMEOUT;
+            }
+            q->seeking = false;
+            q->pos_valid = (ret == HAL_OK);
+            if (ret != HAL_OK) {
+                complete_current(d, ret);
+            } else {
+                q->pos = q->seek_target;
+                hdd_write_reg(d == HDD_DRIVE_0 ? HDD0_CYL_POS : HDD1_CYL_POS,
+                              q->pos);
+            }
+        }
+
+        if (q->cur == NULL) {
+            q->cur = clook_next(q, q->pos_valid ? q->pos : hdd_get_cylinder(d));
+        }
+        if (q->cur == NULL || (q->pos_valid && q->pos == q->cur->cylinder)) {
+            continue;
+        }
+
+        /* Buffered seek: the drive finishes it after DS moves on */
+        select_control_cable_drive(d);
+        int ret = hdd_seek_start(d, q->cur->cylinder);
+        if (ret != HAL_OK) {
+            complete_current(d, ret);
+            continue;
+        }
+        q->seeking = true;
+        q->seek_target = q->cur->cylinder;
+        q->seek_start_ms = timer_get_ms();
+    }
+
+    /* One transfer per call, alternating drives when both are on track */
+    for (uint8_t i = 1; i <= HDD_NUM_DRIVES; i++) {
+        uint8_t d = (dual_state.last_xfer + i) % HDD_NUM_DRIVES;
+        drive_queue_t *q = &dual_state.queue[d];
+
+        if (q->cur == NULL || q->seeking) {
+            continue;
+        }
+
+        int ret = HAL_OK;
+        if (q->cur->count != 0) {
+            ret = hdd_select_full(d);
+            if (ret == HAL_OK) {
+                ret = hdd_read_sectors(d, q->cur->cylinder, q->cur->head,
+                                       q->cur->sector, q->cur->count, q->cur->buf);
+            }
+            dual_state.last_xfer = d;
+        }
+        if (ret == HAL_OK) {
+            /* hdd_read_sectors() seeks itself if the heads had moved */
+            q->pos = q->cur->cylinder;
+            q->pos_valid = true;
+        }
+        complete_current(d, ret);
+        break;
+    }
+
+    for (uint8_t d = 0; d < HDD_NUM_DRIVES; d++) {
+        drive_queue_t *q = &dual_state.queue[d];
+        outstanding += q->count + (q->cur != NULL ? 1 : 0);
+    }
+    return outstanding;
+}
+
 /**
- * Execute next pending seek in queue
+ * Drop a request that is still queued or in service
  */
-int hdd_execute_pending_seek(void)
+static void sched_cancel(hdd_req_t *req)
 {
-    /* Check for pending seeks */
     for (uint8_t d = 0; d < HDD_NUM_DRIVES; d++) {
-        if (dual_state.seek[d].seek_pending) {
-            dual_state.seek[d].seek_pending = false;
+        drive_queue_t *q = &dual_state.queue[d];
 
-            /* Clear from hardware queue */
-            uint32_t queue_ctrl = hdd_read_reg(HDD_SEEK_QUEUE_CTRL);
-            if (d == HDD_DRIVE_0) {
-                queue_ctrl &= ~SEEK_QUEUE_D0_PENDING;
-            } else {
-                queue_ctrl &= ~SEEK_QUEUE_D1_PENDING;
+        if (q->cur == req) {
+            /* A seek in flight is still reaped by the next poll */
+            q->cur = NULL;
+        }
+        for (int i = 0; i < q->count; i++) {
+            if (q->req[i] == req) {
+                for (int j = i; j < q->count - 1; j++) {
+                    q->req[j] = q->req[j + 1];
+                }
+                q->count--;
+                break;
             }
-            hdd_write_reg(HDD_SEEK_QUEUE_CTRL, queue_ctrl);
+        }
+    }
+    update_queue_reg();
+}
 
-            /* Execute seek (non-blocking) */
-            return shared_cable_seek(d, dual_state.seek[d].target_cylinder, false);
+static bool sched_req_check(void *arg)
+{
+    hdd_req_t *req = (hdd_req_t *)arg;
+
+    if (req->status == HAL_ERR_BUSY) {
+        hdd_sched_poll();
+    }
+    return req->status != HAL_ERR_BUSY;
+}
+
+int hdd_sched_wait(hdd_req_t *req, uint32_t timeout_ms)
+{
+    if (!event_wait(NULL, sched_req_check, req, timeout_ms)) {
+        sched_cancel(req);
+        req->status = HAL_ERR_TIMEOUT;
+    }
+    return req->status;
+}
+
+int hdd_sched_read(uint8_t drive, uint16_t cylinder, uint8_t head,
+                   uint8_t sector, uint8_t count, void *buf)
+{
+    hdd_req_t req = {
+        .cylinder = cylinder,
+        .head = head,
+        .sector = sector,
+        .count = count,
+        .buf = buf,
+        .status = HAL_OK,
+    };
+    int ret;
+
+    while ((ret = hdd_sched_submit(drive, &req)) == HAL_ERR_BUSY) {
+        hdd_sched_poll();
+    }
+    if (ret != HAL_OK) {
+        return ret;
+    }
+    return hdd_sched_wait(&req, HDD_SCHED_SEEK_MS * 2);
+}
+
+int hdd_sched_seek(uint8_t drive, uint16_t cylinder)
+{
+    return hdd_sched_read(drive, cylinder, 0, 0, 0, NULL);
+}
+
+/**
+ * Find the first bad sector of a span that failed
+ * Only CRC failures are narrowed down; anything else blames the start.
+ */
+static uint32_t span_bad_lba(uint8_t drive, const hdd_req_t *r,
+                             const hdd_geometry_t *geom, int status)
+{
+    uint8_t bad = r->sector;
+
+    if (status == HAL_ERR_CRC && r->count > 1) {
+        for (uint8_t i = 0; i < r->count; i++) {
+            bad = r->sector + i;
+            if (hdd_sched_read(drive, r->cylinder, r->head, bad, 1, NULL) != HAL_OK) {
+                break;
+            }
+        }
+    }
+    return hdd_chs_to_lba(r->cylinder, r->head, bad, geom);
+}
+
+/**
+ * Run an LBA range through the queue in track spans
+ * buf NULL verifies; bad_lba then gets the first sector that failed.
+ */
+static int sched_lba(uint8_t drive, uint32_t lba, uint32_t count, void *buf,
+                     uint32_t *bad_lba)
+{
+    hdd_profile_t profile;
+    hdd_req_t req[HDD_SCHED_DEPTH];
+    uint8_t *buf8 = (uint8_t *)buf;
+
+    if (count == 0) {
+        return HAL_ERR_INVALID;
+    }
+    if (hdd_get_profile(drive, &profile) != HAL_OK || !profile.valid) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    const hdd_geometry_t *geom = &profile.geometry;
+    uint32_t sector_size = geom->sector_size ? geom->sector_size : 512;
+
+    while (count > 0) {
+        int queued = 0;
+        int ret = HAL_OK;
+
+        /* Queue a batch of track spans so the elevator can order them */
+        while (count > 0 && queued < HDD_SCHED_DEPTH) {
+            hdd_req_t *r = &req[queued];
+            uint16_t cyl;
+            uint8_t head, sec;
+
+            hdd_lba_to_chs(lba, &cyl, &head, &sec, geom);
+
+            uint32_t n = geom->sectors ? geom->sectors - sec + 1 : 1;
+            if (n > HDD_TRACK_BUF_SECTORS) {
+                n = HDD_TRACK_BUF_SECTORS;
+            }
+            if (n > count) {
+                n = count;
+            }
+
+            r->cylinder = cyl;
+            r->head = head;
+            r->sector = sec;
+            r->count = (uint8_t)n;
+            r->buf = buf8;
+            if (hdd_sched_submit(drive, r) != HAL_OK) {
+                break;      /* Queue full: send what we have */
+            }
+
+            queued++;
+            lba += n;
+            count -= n;
+            if (buf8 != NULL) {
+                buf8 += n * sector_size;
+            }
         }
+
+        if (queued == 0) {
+            hdd_sched_poll();
+            continue;
+        }
+
+        /* Wait for the whole batch so no request outlives this frame */
+        for (int i = 0; i < queued; i++) {
+            int r = hdd_sched_wait(&req[i], HDD_SCHED_SEEK_MS * 2);
+            if (r != HAL_OK && ret == HAL_OK) {
+                ret = r;
+                if (bad_lba != NULL) {
+                    *bad_lba = span_bad_lba(drive, &req[i], geom, r);
+                }
+            }
+        }
+        if (ret != HAL_OK) {
+            return ret;
+        }
+    }
+
+    return HAL_OK;
+}
+
+int hdd_sched_read_lba(uint8_t drive, uint32_t lba, uint32_t count, void *buf)
+{
+    if (buf == NULL) {
+        return HAL_ERR_INVALID;
     }
+    return sched_lba(drive, lba, count, buf, NULL);
+}
 
-    return HAL_OK;  /* No pending seeks */
+int hdd_sched_verify_lba(uint8_t drive, uint32_t lba, uint32_t count, uint32_t *bad_lba)
+{
+    return sched_lba(drive, lba, count, NULL, bad_lba);
 }
 
 /**
- * Seek with automatic queueing if cable is busy
+ * Queue a positioning seek (non-blocking)
+ * Useful when the control cable is busy with another drive
  */
-int hdd_seek_smart(uint8_t drive, uint16_t cylinder)
+int hdd_queue_seek(uint8_t drive, uint16_t cylinder)
 {
     if (!valid_drive(drive)) {
         return HAL_ERR_INVALID;
     }
 
-    /* If cable is busy, queue the seek */
-    if (dual_state.cable_busy && dual_state.current_ds != drive) {
-        return hdd_queue_seek(drive, cylinder);
+    drive_queue_t *q = &dual_state.queue[drive];
+    hdd_req_t *hint = &q->hint;
+
+    if (hint->status == HAL_ERR_BUSY) {
+        if (q->cur == hint) {
+            return HAL_ERR_BUSY;    /* Already on its way */
+        }
+        hint->cylinder = cylinder;  /* Still queued: retarget */
+        return HAL_OK;
     }
 
-    /* Execute immediately */
-    return shared_cable_seek(drive, cylinder, true);
+    hint->cylinder = cylinder;
+    hint->head = 0;
+    hint->sector = 0;
+    hint->count = 0;
+    hint->buf = NULL;
+    return hdd_sched_submit(drive, hint);
+}
+
+/**
+ * Advance the request queues (kept for existing callers)
+ */
+int hdd_execute_pending_seek(void)
+{
+    hdd_sched_poll();
+    return HAL_OK;
+}
+
+/**
+ * Seek through the request queue
+ * Queued behind (or ahead of, by cylinder order) other work on the
+ * drive, and overlapped with transfers on the other drive.
+ */
+int hdd_seek_smart(uint8_t drive, uint16_t cylinder)
+{
+    if (!valid_drive(drive)) {
+        return HAL_ERR_INVALID;
+    }
+
+    return hdd_sched_seek(drive, cylinder);
 }
 
 /*============================================================================
@@ -634,57 +1055,3 @@ void hdd_get_topology_info(uint8_t *num_drives, bool *shared_control,
         *separate_data = true;   /* 2x 20-pin dedicated */
     }
 }
-
-/*============================================================================
- * Helper macro for microsecond delay (platform-specific)
- *============================================================================*/
-
-#ifndef delay_us
-static inline void delay_us(uint32_t us)
-{
-    /* Simple busy-wait for microseconds */
-    volatile uint32_t count = us * 10;  /* Adjust for clock speed */
-    while (count--);
-}
-#endif
-
-#ifndef wait_seek_done
-static int wait_seek_done(uint8_t drive, uint32_t timeout_ms)
-{
-    uint32_t start = get_time_ms();
-
-    while ((get_time_ms() - start) < timeout_ms) {
-        uint32_t status = hdd_read_reg(HDD_STATUS(drive));
-        if (status & HDD_STAT_SEEK_DONE) {
-            return HAL_OK;
-        }
-        if (status & HDD_STAT_SEEK_ERROR) {
-            return HAL_ERR_HARDWARE;
-        }
-        delay_ms(1);
-    }
-
-    return HAL_ERR_TIMEOUT;
-}
-#endif
-
-#ifndef valid_drive
-static inline bool valid_drive(uint8_t drive)
-{
-    return drive < HDD_NUM_DRIVES;
-}
-#endif
-
-#ifndef hdd_read_reg
-static inline uint32_t hdd_read_reg(uint32_t addr)
-{
-    return REG32(addr);
-}
-#endif
-
-#ifndef hdd_write_reg
-static inline void hdd_write_reg(uint32_t addr, uint32_t value)
-{
-    REG32(addr) = value;
-}
-#endif
@@ -11,6 +11,11 @@
 
 #include "hdd_hal.h"
 #include "platform.h"
+#include "timer.h"
+#include "prof.h"
+#include "event.h"
+#include "hdd_profile_cache.h"
+#include "spinup.h"
 #include <string.h>
 
 /*============================================================================
@@ -20,17 +25,42 @@
 typedef struct {
     hdd_profile_t   profile;
     uint16_t        current_cylinder;
+    uint16_t        seek_target;        /* Cylinder of a seek in flight */
+    bool            seeking;            /* hdd_seek_start() not yet polled done */
     uint8_t         current_head;
     bool            detection_done;
+    bool            esdi_cached;        /* profile.esdi_config read from this drive */
+    bool            full_pending;       /* Full scan owed (profile provisional) */
+    uint32_t        last_io_ms;         /* Last seek/read, for background scans */
 } hdd_drive_state_t;
 
+/* Raised by hdd_irq_handler() on IRQ_HDD */
+static event_t hdd_event;
+
+/* Queued ESDI command */
+typedef struct {
+    hdd_esdi_req_t  *req;
+    uint8_t         drive;
+    bool            issued;
+    uint32_t        start_ms;
+} esdi_slot_t;
+
+static struct {
+    esdi_slot_t     slot[HDD_ESDI_QUEUE_DEPTH];     /* Submission order */
+    uint8_t         count;
+    bool            chan_busy;          /* Queued GET_STATUS on the serial channel */
+} esdi_q;
+
 static struct {
     bool                initialized;
     uint8_t             active_drive;       /* Currently selected drive for NCO */
     hdd_drive_state_t   drive[HDD_NUM_DRIVES];
+    int8_t              bg_drive;           /* Background full scan, -1 = none */
+    uint32_t            bg_start_ms;
 } hdd_state = {
     .initialized = false,
-    .active_drive = HDD_DRIVE_0
+    .active_drive = HDD_DRIVE_0,
+    .bg_drive = -1
 };
 
 /*============================================================================
@@ -40,12 +70,18 @@ static struct {
 /**
  * Get current time in milliseconds
  */
-extern uint32_t get_time_ms(void);
+static inline uint32_t get_time_ms(void)
+{
+    return timer_get_ms();
+}
 
 /**
  * Delay in milliseconds
  */
-extern void delay_ms(uint32_t ms);
+static inline void delay_ms(uint32_t ms)
+{
+    timer_delay_ms(ms);
+}
 
 /**
  * Read 32-bit register
@@ -71,25 +107,52 @@ static inline bool valid_drive(uint8_t drive)
     return drive < HDD_NUM_DRIVES;
 }
 
+/**
+ * Status register wait: done once any of the done bits is set
+ */
+typedef struct {
+    uint32_t    reg;
+    uint32_t    done_bits;
+    uint32_t    status;         /* Last value read */
+} hdd_wait_t;
+
+static bool hdd_status_check(void *arg)
+{
+    hdd_wait_t *w = (hdd_wait_t *)arg;
+
+    w->status = hdd_read_reg(w->reg);
+    return (w->status & w->done_bits) != 0;
+}
+
+/**
+ * Wait on IRQ_HDD for a status register bit
+ * event_wait() also re-checks every EVENT_POLL_US, which is what ends the
+ * wait on builds whose block design does not route irq_hdd to the INTC.
+ * @param status Receives the status that ended the wait
+ */
+static int wait_status(uint32_t reg, uint32_t done_bits, uint32_t timeout_ms,
+                       uint32_t *status)
+{
+    hdd_wait_t w = { reg, done_bits, 0 };
+    bool done = event_wait(&hdd_event, hdd_status_check, &w, timeout_ms);
+
+    *status = w.status;
+    return done ? HAL_OK : HAL_ERR_TIMEOUT;
+}
+
 /**
  * Wait for detection to complete
  */
 static int wait_detection_done(uint32_t timeout_ms)
 {
-    uint32_t start = get_time_ms();
+    uint32_t status;
+    int ret = wait_status(HDD_DETECT_STATUS, DETECT_STAT_DONE | DETECT_STAT_ERROR,
+                          timeout_ms, &status);
 
-    while ((get_time_ms() - start) < timeout_ms) {
-        uint32_t status = hdd_read_reg(HDD_DETECT_STATUS);
-        if (status & DETECT_STAT_DONE) {
-            return HAL_OK;
-        }
-        if (status & DETECT_STAT_ERROR) {
-            return HAL_ERR_HARDWARE;
-        }
-        delay_ms(10);
+    if (ret == HAL_OK && !(status & DETECT_STAT_DONE)) {
+        ret = HAL_ERR_HARDWARE;
     }
-
-    return HAL_ERR_TIMEOUT;
+    return ret;
 }
 
 /**
@@ -97,17 +160,9 @@ static int wait_detection_done(uint32_t timeout_ms)
  */
 static int wait_discovery_done(uint32_t timeout_ms)
 {
-    uint32_t start = get_time_ms();
-
-    while ((get_time_ms() - start) < timeout_ms) {
-        uint32_t status = hdd_read_reg(HDD_DISCOVER_STATUS);
-        if (status & DISCOVER_STAT_DONE) {
-            return HAL_OK;
-        }
-        delay_ms(50);
-    }
+    uint32_t status;
 
-    return HAL_ERR_TIMEOUT;
+    return wait_status(HDD_DISCOVER_STATUS, DISCOVER_STAT_DONE, timeout_ms, &status);
 }
 
 /**
@@ -115,20 +170,14 @@ static int wait_discovery_done(uint32_t timeout_ms)
  */
 static int wait_seek_done(uint8_t drive, uint32_t timeout_ms)
 {
-    uint32_t start = get_time_ms();
+    uint32_t status;
+    int ret = wait_status(HDD_STATUS(drive), HDD_STAT_SEEK_DONE | HDD_STAT_SEEK_ERROR,
+                          timeout_ms, &status);
 
-    while ((get_time_ms() - start) < timeout_ms) {
-        uint32_t status = hdd_read_reg(HDD_STATUS(drive));
-        if (status & HDD_STAT_SEEK_DONE) {
-            return HAL_OK;
-        }
-        if (status & HDD_STAT_SEEK_ERROR) {
-            return HAL_ERR_HARDWARE;
-        }
-        delay_ms(1);
+    if (ret == HAL_OK && !(status & HDD_STAT_SEEK_DONE)) {
+        ret = HAL_ERR_HARDWARE;
     }
-
-    return HAL_ERR_TIMEOUT;
+    return ret;
 }
 
 /**
@@ -216,11 +265,16 @@ int hdd_hal_init(void)
     for (int i = 0; i < HDD_NUM_DRIVES; i++) {
         memset(&hdd_state.drive[i].profile, 0, sizeof(hdd_profile_t));
         hdd_state.drive[i].current_cylinder = 0;
+        hdd_state.drive[i].seeking = false;
         hdd_state.drive[i].current_head = 0;
         hdd_state.drive[i].detection_done = false;
+        hdd_state.drive[i].esdi_cached = false;
+        hdd_state.drive[i].full_pending = false;
     }
+    memset(&esdi_q, 0, sizeof(esdi_q));
 
     hdd_state.active_drive = HDD_DRIVE_0;
+    hdd_state.bg_drive = -1;
     hdd_state.initialized = true;
 
     /* Enable HDD subsystem */
@@ -291,6 +345,7 @@ int hdd_detect_interface(uint8_t drive, hdd_detection_t *result)
     /* Store in per-drive profile */
     memcpy(&hdd_state.drive[drive].profile.detection, result, sizeof(*result));
     hdd_state.drive[drive].detection_done = true;
+    hdd_state.drive[drive].esdi_cached = false;
 
     return HAL_OK;
 }
@@ -325,7 +380,14 @@ int hdd_force_interface(hdd_type_t type)
     return HAL_OK;
 }
 
-int hdd_discover(uint8_t drive, hdd_profile_t *profile)
+/*============================================================================
+ * Discovery
+ *============================================================================*/
+
+/**
+ * Common discovery setup: detection, PHY mode, detection copied to profile
+ */
+static int discover_prepare(uint8_t drive, hdd_profile_t *profile)
 {
     if (!hdd_state.initialized) {
         return HAL_ERR_NOT_READY;
@@ -335,9 +397,15 @@ int hdd_discover(uint8_t drive, hdd_profile_t *profile)
         return HAL_ERR_INVALID;
     }
 
+    /* Spindle power comes up through the budget-aware scheduler */
+    int ret = spinup_wait(SPINUP_MASK(PWR_CONN_HDD0 + drive), SPINUP_WAIT_MS);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
     /* Run detection first if not done */
     if (!hdd_state.drive[drive].detection_done) {
-        int ret = hdd_detect_interface(drive, &profile->detection);
+        ret = hdd_detect_interface(drive, &profile->detection);
         if (ret != HAL_OK) {
             return ret;
         }
@@ -357,20 +425,71 @@ int hdd_discover(uint8_t drive, hdd_profile_t *profile)
     }
     hdd_write_reg(HDD_CTRL, ctrl);
 
-    /* Start discovery pipeline on selected drive */
-    uint32_t discover_ctrl = DISCOVER_CTRL_START | DISCOVER_CTRL_FULL;
+    memcpy(&profile->detection, &hdd_state.drive[drive].profile.detection,
+           sizeof(profile->detection));
+    return HAL_OK;
+}
+
+/**
+ * Known drive: cached profile, checked with a verify seek
+ */
+static bool discover_attach(uint8_t drive, hdd_profile_t *profile)
+{
+    if (hdd_pcache_attach(drive, profile) != HAL_OK) {
+        return false;
+    }
+
+    profile->confidence = 255;
+    profile->provisional = false;
+    memcpy(&hdd_state.drive[drive].profile, profile, sizeof(*profile));
+    hdd_state.drive[drive].esdi_cached = false;
+    hdd_state.drive[drive].full_pending = false;
+    return true;
+}
+
+/**
+ * Start the discovery pipeline on a drive
+ */
+static void discover_start(uint8_t drive, bool full)
+{
+    uint32_t discover_ctrl = DISCOVER_CTRL_START;
+
+    if (full) {
+        discover_ctrl |= DISCOVER_CTRL_FULL;
+    }
     if (drive == HDD_DRIVE_1) {
         discover_ctrl |= DISCOVER_CTRL_DRIVE_SEL;
     }
     hdd_write_reg(HDD_DISCOVER_CTRL, discover_ctrl);
+}
 
-    /* Wait for completion (can take 30+ seconds for full scan) */
-    int ret = wait_discovery_done(60000);
-    if (ret != HAL_OK) {
+/**
+ * Stop a background full scan; it stays queued and is restarted by poll
+ */
+static void discover_bg_abort(void)
+{
+    if (hdd_state.bg_drive >= 0) {
         hdd_write_reg(HDD_DISCOVER_CTRL, DISCOVER_CTRL_ABORT);
-        return ret;
+        hdd_state.bg_drive = -1;
     }
+}
 
+/**
+ * Seek/read on a drive: a background scan there gives way to it
+ */
+static inline void discover_yield(uint8_t drive)
+{
+    hdd_state.drive[drive].last_io_ms = get_time_ms();
+    if (hdd_state.bg_drive == (int8_t)drive) {
+        discover_bg_abort();
+    }
+}
+
+/**
+ * Read discovery results into a profile and the drive state
+ */
+static void discover_collect(uint8_t drive, hdd_profile_t *profile, bool provisional)
+{
     /* Read geometry from per-drive register */
     unpack_geometry(drive, &profile->geometry);
 
@@ -381,14 +500,121 @@ int hdd_discover(uint8_t drive, hdd_profile_t *profile)
     memcpy(&profile->detection, &hdd_state.drive[drive].profile.detection,
            sizeof(profile->detection));
 
+    profile->confidence = hdd_read_reg(HDD_QUALITY_REG) & 0xFF;
+    profile->provisional = provisional;
     profile->valid = true;
 
-    /* Store in state */
+    /* Store in state, and for the next attach of this drive */
     memcpy(&hdd_state.drive[drive].profile, profile, sizeof(*profile));
+    hdd_state.drive[drive].esdi_cached = false;
+    hdd_state.drive[drive].full_pending = provisional;
+    if (!provisional) {
+        hdd_pcache_store(drive, profile);
+    }
+}
+
+int hdd_discover(uint8_t drive, hdd_profile_t *profile)
+{
+    int ret = discover_prepare(drive, profile);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
+    if (discover_attach(drive, profile)) {
+        return HAL_OK;
+    }
+
+    /* Start discovery pipeline on selected drive (takes it from any background scan) */
+    discover_bg_abort();
+    discover_start(drive, true);
+
+    /* Wait for completion (can take 30+ seconds for full scan) */
+    ret = wait_discovery_done(HDD_DISCOVER_FULL_MS);
+    if (ret != HAL_OK) {
+        hdd_write_reg(HDD_DISCOVER_CTRL, DISCOVER_CTRL_ABORT);
+        return ret;
+    }
+
+    discover_collect(drive, profile, false);
+    return HAL_OK;
+}
+
+int hdd_discover_quick(uint8_t drive, hdd_profile_t *profile)
+{
+    int ret = discover_prepare(drive, profile);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+
+    if (discover_attach(drive, profile)) {
+        return HAL_OK;
+    }
+
+    /* The full scan is owed whatever the quick scan finds */
+    hdd_state.drive[drive].full_pending = true;
+
+    discover_bg_abort();
+    discover_start(drive, false);
+
+    ret = wait_discovery_done(HDD_DISCOVER_QUICK_MS);
+    if (ret != HAL_OK) {
+        hdd_write_reg(HDD_DISCOVER_CTRL, DISCOVER_CTRL_ABORT);
+        return ret;
+    }
 
+    discover_collect(drive, profile, true);
     return HAL_OK;
 }
 
+void hdd_discover_poll(void)
+{
+    uint32_t now = get_time_ms();
+
+    if (!hdd_state.initialized) {
+        return;
+    }
+
+    if (hdd_state.bg_drive >= 0) {
+        uint8_t drive = (uint8_t)hdd_state.bg_drive;
+        hdd_profile_t profile;
+
+        if (hdd_read_reg(HDD_DISCOVER_STATUS) & DISCOVER_STAT_DONE) {
+            hdd_state.bg_drive = -1;
+            discover_collect(drive, &profile, false);
+        } else if (now - hdd_state.bg_start_ms > HDD_DISCOVER_FULL_MS) {
+            /* Give up; the provisional profile stands */
+            discover_bg_abort();
+            hdd_state.drive[drive].full_pending = false;
+        }
+        return;
+    }
+
+    for (int i = 0; i < HDD_NUM_DRIVES; i++) {
+        hdd_drive_state_t *d = &hdd_state.drive[i];
+
+        if (d->full_pending && !d->seeking &&
+            now - d->last_io_ms >= HDD_DISCOVER_IDLE_MS) {
+            discover_start((uint8_t)i, true);
+            hdd_state.bg_drive = (int8_t)i;
+            hdd_state.bg_start_ms = now;
+            return;
+        }
+    }
+}
+
+bool hdd_discover_pending(uint8_t drive)
+{
+    return valid_drive(drive) && hdd_state.drive[drive].full_pending;
+}
+
+uint32_t hdd_idle_ms(uint8_t drive)
+{
+    if (!valid_drive(drive) || hdd_state.drive[drive].seeking) {
+        return 0;
+    }
+    return get_time_ms() - hdd_state.drive[drive].last_io_ms;
+}
+
 int hdd_get_profile(uint8_t drive, hdd_profile_t *profile)
 {
     if (!hdd_state.initialized) {
@@ -419,6 +645,8 @@ int hdd_seek(uint8_t drive, uint16_t cylinder)
         return HAL_ERR_NOT_READY;
     }
 
+    discover_yield(drive);
+
     /* Set target cylinder */
     hdd_write_reg(HDD_TARGET_CYL(drive), cylinder);
 
@@ -435,6 +663,55 @@ int hdd_seek(uint8_t drive, uint16_t cylinder)
     return HAL_OK;
 }
 
+int hdd_seek_start(uint8_t drive, uint16_t cylinder)
+{
+    if (!hdd_state.initialized) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    if (!valid_drive(drive)) {
+        return HAL_ERR_INVALID;
+    }
+
+    uint32_t status = hdd_read_reg(HDD_STATUS(drive));
+    if (!(status & HDD_STAT_READY)) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    discover_yield(drive);
+
+    hdd_write_reg(HDD_TARGET_CYL(drive), cylinder);
+    hdd_write_reg(HDD_CMD(drive), HDD_CMD_SEEK);
+
+    hdd_state.drive[drive].seek_target = cylinder;
+    hdd_state.drive[drive].seeking = true;
+    return HAL_OK;
+}
+
+int hdd_seek_poll(uint8_t drive)
+{
+    if (!valid_drive(drive)) {
+        return HAL_ERR_INVALID;
+    }
+
+    if (!hdd_state.drive[drive].seeking) {
+        return HAL_OK;
+    }
+
+    uint32_t status = hdd_read_reg(HDD_STATUS(drive));
+    if (status & HDD_STAT_SEEK_DONE) {
+        hdd_state.drive[drive].seeking = false;
+        hdd_state.drive[drive].current_cylinder = hdd_state.drive[drive].seek_target;
+        return HAL_OK;
+    }
+    if (status & HDD_STAT_SEEK_ERROR) {
+        hdd_state.drive[drive].seeking = false;
+        return HAL_ERR_HARDWARE;
+    }
+
+    return HAL_ERR_BUSY;
+}
+
 int hdd_select_head(uint8_t drive, uint8_t head)
 {
     if (!hdd_state.initialized) {
@@ -453,6 +730,15 @@ int hdd_select_head(uint8_t drive, uint8_t head)
     return HAL_OK;
 }
 
+static bool recal_check(void *arg)
+{
+    hdd_wait_t *w = (hdd_wait_t *)arg;
+
+    w->status = hdd_read_reg(w->reg);
+    return ((w->status & HDD_STAT_SEEK_DONE) && (w->status & HDD_STAT_TRACK00)) ||
+           (w->status & HDD_STAT_SEEK_ERROR);
+}
+
 int hdd_recalibrate(uint8_t drive)
 {
     if (!hdd_state.initialized) {
@@ -467,33 +753,81 @@ int hdd_recalibrate(uint8_t drive)
     hdd_write_reg(HDD_CMD(drive), HDD_CMD_RECAL);
 
     /* Wait for seek complete and track 0 */
-    uint32_t start = get_time_ms();
-    while ((get_time_ms() - start) < 10000) {
-        uint32_t status = hdd_read_reg(HDD_STATUS(drive));
-        if ((status & HDD_STAT_SEEK_DONE) && (status & HDD_STAT_TRACK00)) {
-            hdd_state.drive[drive].current_cylinder = 0;
-            return HAL_OK;
-        }
-        if (status & HDD_STAT_SEEK_ERROR) {
-            return HAL_ERR_HARDWARE;
-        }
-        delay_ms(10);
+    hdd_wait_t w = { HDD_STATUS(drive), 0, 0 };
+    if (!event_wait(&hdd_event, recal_check, &w, 10000)) {
+        return HAL_ERR_TIMEOUT;
+    }
+    if (w.status & HDD_STAT_SEEK_ERROR) {
+        return HAL_ERR_HARDWARE;
     }
 
-    return HAL_ERR_TIMEOUT;
+    hdd_state.drive[drive].current_cylinder = 0;
+    return HAL_OK;
 }
 
-int hdd_read_sector(uint8_t drive, uint16_t cylinder, uint8_t head,
-                    uint8_t sector, void *buf)
+/**
+ * Wait for the sector buffer to finish a read
+ * Normally ended by IRQ_HDD; the status poll covers interrupts being
+ * masked or the line not reaching the INTC.
+ */
+static int wait_sector_ready(uint32_t timeout_ms)
+{
+    uint32_t status;
+    int ret = wait_status(HDD_SECTOR_STATUS, SECTOR_STAT_READY | SECTOR_STAT_ERROR,
+                          timeout_ms, &status);
+
+    if (ret == HAL_OK && (status & SECTOR_STAT_ERROR)) {
+        ret = HAL_ERR_CRC;
+    }
+    return ret;
+}
+
+/**
+ * Run one sector buffer read and copy the sectors out
+ * With dst NULL the sectors are only CRC-checked and stay in the buffer.
+ */
+static int sector_buf_read(uint8_t sector, uint8_t count, uint8_t *dst,
+                           uint32_t sector_size)
+{
+    /* More than one sector fills the track buffer */
+    uint32_t ctrl = SECTOR_CTRL_READ | SECTOR_CTRL_IRQ_EN;
+    if (count > 1) {
+        ctrl |= SECTOR_CTRL_MULTI | ((uint32_t)count << SECTOR_CTRL_COUNT_SHIFT);
+    }
+
+    event_clear(&hdd_event);
+    hdd_write_reg(HDD_SECTOR_ADDR, sector);
+    hdd_write_reg(HDD_SECTOR_CTRL, ctrl);
+
+    /* Wait for sector data */
+    int ret = wait_sector_ready(1000);
+    if (ret != HAL_OK || dst == NULL) {
+        return ret;
+    }
+
+    PROF_BEGIN(PROF_HDD_READ);
+    uint32_t *buf32 = (uint32_t *)dst;
+    for (uint32_t i = 0; i < count * (sector_size / 4); i++) {
+        buf32[i] = hdd_read_reg(HDD_SECTOR_DATA);
+    }
+    PROF_END(PROF_HDD_READ);
+
+    return HAL_OK;
+}
+
+int hdd_read_sectors(uint8_t drive, uint16_t cylinder, uint8_t head,
+                     uint8_t sector, uint8_t count, void *buf)
 {
     if (!hdd_state.initialized) {
         return HAL_ERR_NOT_READY;
     }
 
-    if (!valid_drive(drive) || buf == NULL) {
+    if (!valid_drive(drive) || count == 0 || count > HDD_TRACK_BUF_SECTORS) {
         return HAL_ERR_INVALID;
     }
 
+    discover_yield(drive);
+
     /* Select this drive for NCO/decoder if not already */
     if (hdd_state.active_drive != drive) {
         int ret = hdd_select_drive(drive);
@@ -516,38 +850,64 @@ int hdd_read_sector(uint8_t drive, uint16_t cylinder, uint8_t head,
         return ret;
     }
 
-    /* Set up sector buffer for read */
-    hdd_write_reg(HDD_SECTOR_ADDR, sector);
-    hdd_write_reg(HDD_SECTOR_CTRL, BIT(0));  /* Start read */
+    const hdd_geometry_t *geom = &hdd_state.drive[drive].profile.geometry;
+    uint32_t sector_size = geom->sector_size;
+    if (sector_size == 0) sector_size = 512;
 
-    /* Wait for sector data */
-    uint32_t start = get_time_ms();
-    while ((get_time_ms() - start) < 1000) {
-        uint32_t status = hdd_read_reg(HDD_SECTOR_STATUS);
-        if (status & BIT(1)) {  /* Data ready */
-            break;
+    /*
+     * At 1:1 logical order is physical order: one track buffer command.
+     * Interleaved, a logical-order read waits most of a revolution
+     * between sectors, so walk the track in physical order instead.
+     */
+    uint8_t phys[HDD_MAX_SPT];
+    if (count == 1 || geom->interleave <= 1 ||
+        hdd_interleave_map(geom, phys) != HAL_OK) {
+        return sector_buf_read(sector, count, (uint8_t *)buf, sector_size);
+    }
+
+    uint8_t start = 0;
+    while (phys[start] != sector) {
+        if (++start >= geom->sectors) {
+            return HAL_ERR_INVALID;     /* Not on this track */
         }
-        delay_ms(1);
     }
 
-    /* Check for timeout */
-    uint32_t status = hdd_read_reg(HDD_SECTOR_STATUS);
-    if (!(status & BIT(1))) {
-        return HAL_ERR_TIMEOUT;
-    }
+    uint8_t *buf8 = (uint8_t *)buf;
+    for (uint8_t i = 0; i < geom->sectors; i++) {
+        uint8_t id = phys[(start + i) % geom->sectors];
 
-    /* Read sector data from buffer */
-    uint32_t *buf32 = (uint32_t *)buf;
-    uint32_t sector_size = hdd_state.drive[drive].profile.geometry.sector_size;
-    if (sector_size == 0) sector_size = 512;
+        if (id < sector || id >= sector + count) {
+            continue;
+        }
 
-    for (uint32_t i = 0; i < sector_size / 4; i++) {
-        buf32[i] = hdd_read_reg(HDD_SECTOR_DATA);
+        ret = sector_buf_read(id, 1, buf8 ? buf8 + (uint32_t)(id - sector) * sector_size
+                                          : NULL, sector_size);
+        if (ret != HAL_OK) {
+            return ret;
+        }
     }
 
     return HAL_OK;
 }
 
+int hdd_read_sector(uint8_t drive, uint16_t cylinder, uint8_t head,
+                    uint8_t sector, void *buf)
+{
+    return hdd_read_sectors(drive, cylinder, head, sector, 1, buf);
+}
+
+void hdd_irq_handler(void)
+{
+    uint32_t status = hdd_read_reg(HDD_SECTOR_STATUS);
+
+    if (status & SECTOR_STAT_IRQ) {
+        hdd_write_reg(HDD_SECTOR_STATUS, SECTOR_STAT_IRQ);
+    }
+
+    /* Any HDD interrupt: have the current wait re-check its status */
+    event_signal(&hdd_event);
+}
+
 int hdd_read_lba(uint8_t drive, uint32_t lba, uint32_t count, void *buf)
 {
     if (!hdd_state.initialized) {
@@ -562,23 +922,34 @@ int hdd_read_lba(uint8_t drive, uint32_t lba, uint32_t count, void *buf)
         return HAL_ERR_INVALID;
     }
 
+    const hdd_geometry_t *geom = &hdd_state.drive[drive].profile.geometry;
     uint8_t *buf8 = (uint8_t *)buf;
-    uint32_t sector_size = hdd_state.drive[drive].profile.geometry.sector_size;
+    uint32_t sector_size = geom->sector_size;
     if (sector_size == 0) sector_size = 512;
 
-    for (uint32_t i = 0; i < count; i++) {
+    while (count > 0) {
         uint16_t cyl;
         uint8_t head, sec;
 
-        hdd_lba_to_chs(lba + i, &cyl, &head, &sec,
-                       &hdd_state.drive[drive].profile.geometry);
+        hdd_lba_to_chs(lba, &cyl, &head, &sec, geom);
+
+        /* Rest of this track, as much as the track buffer holds */
+        uint32_t n = geom->sectors ? geom->sectors - sec + 1 : 1;
+        if (n > HDD_TRACK_BUF_SECTORS) {
+            n = HDD_TRACK_BUF_SECTORS;
+        }
+        if (n > count) {
+            n = count;
+        }
 
-        int ret = hdd_read_sector(drive, cyl, head, sec, buf8);
+        int ret = hdd_read_sectors(drive, cyl, head, sec, (uint8_t)n, buf8);
         if (ret != HAL_OK) {
             return ret;
         }
 
-        buf8 += sector_size;
+        lba += n;
+        count -= n;
+        buf8 += n * sector_size;
     }
 
     return HAL_OK;
@@ -704,20 +1075,13 @@ int hdd_set_termination(bool enable)
  */
 static int wait_esdi_cmd_done(uint32_t timeout_ms)
 {
-    uint32_t start = get_time_ms();
+    uint32_t status;
+    int ret = wait_status(HDD_ESDI_CMD_STATUS, ESDI_STAT_DONE, timeout_ms, &status);
 
-    while ((get_time_ms() - start) < timeout_ms) {
-        uint32_t status = hdd_read_reg(HDD_ESDI_CMD_STATUS);
-        if (status & ESDI_STAT_DONE) {
-            if (status & ESDI_STAT_ERROR) {
-                return HAL_ERR_HARDWARE;
-            }
-            return HAL_OK;
-        }
-        delay_ms(1);
+    if (ret == HAL_OK && (status & ESDI_STAT_ERROR)) {
+        ret = HAL_ERR_HARDWARE;
     }
-
-    return HAL_ERR_TIMEOUT;
+    return ret;
 }
 
 int hdd_esdi_get_config(uint8_t drive, esdi_config_t *config)
@@ -735,6 +1099,16 @@ int hdd_esdi_get_config(uint8_t drive, esdi_config_t *config)
         return HAL_ERR_NOT_SUPPORTED;
     }
 
+    /* Already read since the last reset/attach */
+    if (hdd_state.drive[drive].esdi_cached) {
+        memcpy(config, &hdd_state.drive[drive].profile.esdi_config, sizeof(*config));
+        return HAL_OK;
+    }
+
+    if (esdi_q.chan_busy) {
+        return HAL_ERR_BUSY;
+    }
+
     /* Select the drive */
     hdd_select_drive(drive);
 
@@ -778,6 +1152,7 @@ int hdd_esdi_get_config(uint8_t drive, esdi_config_t *config)
 
     /* Store in profile */
     memcpy(&hdd_state.drive[drive].profile.esdi_config, config, sizeof(*config));
+    hdd_state.drive[drive].esdi_cached = true;
 
     /* Also update geometry if this is better than probed */
     if (config->cylinders > 0 && config->heads > 0 && config->sectors_per_track > 0) {
@@ -808,6 +1183,10 @@ int hdd_esdi_command(uint8_t drive, uint8_t opcode, uint16_t param)
         return HAL_ERR_NOT_SUPPORTED;
     }
 
+    if (esdi_q.chan_busy) {
+        return HAL_ERR_BUSY;
+    }
+
     /* Select the drive */
     hdd_select_drive(drive);
 
@@ -834,6 +1213,199 @@ bool hdd_esdi_config_valid(uint8_t drive)
     return hdd_state.drive[drive].profile.esdi_config.valid;
 }
 
+/*============================================================================
+ * ESDI Command Queue
+ *============================================================================*/
+
+static void esdi_complete(esdi_slot_t *s, int status)
+{
+    if (s->req->op == HDD_ESDI_OP_STATUS && s->issued) {
+        esdi_q.chan_busy = false;
+    }
+    s->req->status = status;
+}
+
+/**
+ * Start a queued command
+ * Head selects finish here; seeks and status queries are left running.
+ */
+static void esdi_issue(esdi_slot_t *s)
+{
+    hdd_esdi_req_t *r = s->req;
+    int ret;
+
+    switch (r->op) {
+        case HDD_ESDI_OP_SEEK:
+            ret = hdd_seek_start(s->drive, r->arg);
+            break;
+        case HDD_ESDI_OP_HEAD:
+            ret = hdd_select_head(s->drive, (uint8_t)r->arg);
+            esdi_complete(s, ret);
+            return;
+        default:
+            ret = hdd_esdi_command(s->drive, ESDI_CMD_GET_STATUS, 0);
+            esdi_q.chan_busy = (ret == HAL_OK);
+            break;
+    }
+
+    if (ret != HAL_OK) {
+        esdi_complete(s, ret);
+        return;
+    }
+    s->issued = true;
+    s->start_ms = get_time_ms();
+}
+
+/**
+ * Check a running command
+ */
+static void esdi_check(esdi_slot_t *s)
+{
+    hdd_esdi_req_t *r = s->req;
+    uint32_t limit = HDD_ESDI_CMD_MS;
+    int ret;
+
+    if (r->op == HDD_ESDI_OP_SEEK) {
+        ret = hdd_seek_poll(s->drive);
+        limit = HDD_ESDI_SEEK_MS;
+    } else {
+        r->result = hdd_read_reg(HDD_ESDI_CMD_STATUS);
+        ret = HAL_ERR_BUSY;
+        if (r->result & ESDI_STAT_DONE) {
+            ret = (r->result & ESDI_STAT_ERROR) ? HAL_ERR_HARDWARE : HAL_OK;
+        }
+    }
+
+    if (ret == HAL_ERR_BUSY) {
+        if ((get_time_ms() - s->start_ms) < limit) {
+            return;
+        }
+        if (r->op == HDD_ESDI_OP_STATUS) {
+            hdd_write_reg(HDD_ESDI_CMD_CTRL, ESDI_CMD_ABORT);
+        }
+        ret = HAL_ERR_TIMEOUT;
+    }
+    esdi_complete(s, ret);
+}
+
+/**
+ * Take completed (or cancelled) commands off the queue
+ */
+static void esdi_retire(void)
+{
+    uint8_t n = 0;
+
+    for (uint8_t i = 0; i < esdi_q.count; i++) {
+        if (esdi_q.slot[i].req != NULL && esdi_q.slot[i].req->status == HAL_ERR_BUSY) {
+            esdi_q.slot[n++] = esdi_q.slot[i];
+        }
+    }
+    esdi_q.count = n;
+}
+
+int hdd_esdi_submit(uint8_t drive, hdd_esdi_req_t *req)
+{
+    if (!hdd_state.initialized) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    if (!valid_drive(drive) || req == NULL || req->op > HDD_ESDI_OP_STATUS) {
+        return HAL_ERR_INVALID;
+    }
+
+    if (hdd_state.drive[drive].profile.detection.type != HDD_TYPE_ESDI) {
+        return HAL_ERR_NOT_SUPPORTED;
+    }
+
+    if (esdi_q.count >= HDD_ESDI_QUEUE_DEPTH) {
+        return HAL_ERR_BUSY;
+    }
+
+    req->result = 0;
+    req->status = HAL_ERR_BUSY;
+    esdi_q.slot[esdi_q.count++] = (esdi_slot_t){ req, drive, false, 0 };
+
+    hdd_esdi_poll();
+    return HAL_OK;
+}
+
+int hdd_esdi_poll(void)
+{
+    bool held[HDD_NUM_DRIVES] = { false };
+
+    for (uint8_t i = 0; i < esdi_q.count; i++) {
+        esdi_slot_t *s = &esdi_q.slot[i];
+
+        if (s->req->status != HAL_ERR_BUSY) {
+            continue;
+        }
+
+        if (s->issued) {
+            esdi_check(s);
+        } else if (!held[s->drive] &&
+                   !(s->req->op == HDD_ESDI_OP_STATUS && esdi_q.chan_busy)) {
+            esdi_issue(s);
+        }
+
+        /* Later commands for this drive wait for this one */
+        if (s->req->status == HAL_ERR_BUSY) {
+            held[s->drive] = true;
+        }
+    }
+
+    esdi_retire();
+    return esdi_q.count;
+}
+
+static bool esdi_req_check(void *arg)
+{
+    hdd_esdi_req_t *req = (hdd_esdi_req_t *)arg;
+
+    if (req->status == HAL_ERR_BUSY) {
+        hdd_esdi_poll();
+    }
+    return req->status != HAL_ERR_BUSY;
+}
+
+int hdd_esdi_req_wait(hdd_esdi_req_t *req, uint32_t timeout_ms)
+{
+    if (event_wait(&hdd_event, esdi_req_check, req, timeout_ms)) {
+        return req->status;
+    }
+
+    for (uint8_t i = 0; i < esdi_q.count; i++) {
+        esdi_slot_t *s = &esdi_q.slot[i];
+
+        if (s->req == req) {
+            if (req->op == HDD_ESDI_OP_STATUS && s->issued) {
+                hdd_write_reg(HDD_ESDI_CMD_CTRL, ESDI_CMD_ABORT);
+            }
+            esdi_complete(s, HAL_ERR_TIMEOUT);
+        }
+    }
+    esdi_retire();
+    return req->status;
+}
+
+int hdd_esdi_seek_head(uint8_t drive, uint16_t cylinder, uint8_t head)
+{
+    hdd_esdi_req_t seek = { .op = HDD_ESDI_OP_SEEK, .arg = cylinder, .status = HAL_OK };
+    hdd_esdi_req_t sel = { .op = HDD_ESDI_OP_HEAD, .arg = head, .status = HAL_OK };
+    int ret;
+
+    if ((ret = hdd_esdi_submit(drive, &seek)) != HAL_OK) {
+        return ret;
+    }
+    if ((ret = hdd_esdi_submit(drive, &sel)) != HAL_OK) {
+        hdd_esdi_req_wait(&seek, HDD_ESDI_SEEK_MS);
+        return ret;
+    }
+
+    ret = hdd_esdi_req_wait(&seek, HDD_ESDI_SEEK_MS);
+    int sel_ret = hdd_esdi_req_wait(&sel, HDD_ESDI_CMD_MS);
+    return (ret != HAL_OK) ? ret : sel_ret;
+}
+
 /*============================================================================
  * Dual-Drive Convenience Functions
  *============================================================================*/
@@ -863,40 +1435,46 @@ int hdd_seek_both(uint16_t cyl_0, uint16_t cyl_1)
     return HAL_OK;
 }
 
+/**
+ * Both seeks finished, or either failed
+ */
+static bool seeks_check(void *arg)
+{
+    uint32_t *status = (uint32_t *)arg;
+
+    status[HDD_DRIVE_0] = hdd_read_reg(HDD_STATUS(HDD_DRIVE_0));
+    status[HDD_DRIVE_1] = hdd_read_reg(HDD_STATUS(HDD_DRIVE_1));
+
+    if ((status[HDD_DRIVE_0] | status[HDD_DRIVE_1]) & HDD_STAT_SEEK_ERROR) {
+        return true;
+    }
+    return !((status[HDD_DRIVE_0] | status[HDD_DRIVE_1]) & HDD_STAT_SEEK_BUSY);
+}
+
 int hdd_wait_seeks(uint32_t timeout_ms)
 {
     if (!hdd_state.initialized) {
         return HAL_ERR_NOT_READY;
     }
 
-    uint32_t start = get_time_ms();
-
-    while ((get_time_ms() - start) < timeout_ms) {
-        uint32_t status_0 = hdd_read_reg(HDD_STATUS(HDD_DRIVE_0));
-        uint32_t status_1 = hdd_read_reg(HDD_STATUS(HDD_DRIVE_1));
-
-        bool seek_busy_0 = (status_0 & HDD_STAT_SEEK_BUSY) != 0;
-        bool seek_busy_1 = (status_1 & HDD_STAT_SEEK_BUSY) != 0;
-
-        /* Check for errors */
-        if ((status_0 & HDD_STAT_SEEK_ERROR) || (status_1 & HDD_STAT_SEEK_ERROR)) {
-            return HAL_ERR_HARDWARE;
-        }
+    uint32_t status[HDD_NUM_DRIVES];
 
-        /* Both done? */
-        if (!seek_busy_0 && !seek_busy_1) {
-            /* Update cached positions */
-            hdd_state.drive[HDD_DRIVE_0].current_cylinder =
-                (status_0 & HDD_STAT_CYL_MASK) >> HDD_STAT_CYL_SHIFT;
-            hdd_state.drive[HDD_DRIVE_1].current_cylinder =
-                (status_1 & HDD_STAT_CYL_MASK) >> HDD_STAT_CYL_SHIFT;
-            return HAL_OK;
-        }
+    if (!event_wait(&hdd_event, seeks_check, status, timeout_ms)) {
+        return HAL_ERR_TIMEOUT;
+    }
 
-        delay_ms(1);
+    /* Check for errors */
+    if ((status[HDD_DRIVE_0] & HDD_STAT_SEEK_ERROR) ||
+        (status[HDD_DRIVE_1] & HDD_STAT_SEEK_ERROR)) {
+        return HAL_ERR_HARDWARE;
     }
 
-    return HAL_ERR_TIMEOUT;
+    /* Update cached positions */
+    hdd_state.drive[HDD_DRIVE_0].current_cylinder =
+        (status[HDD_DRIVE_0] & HDD_STAT_CYL_MASK) >> HDD_STAT_CYL_SHIFT;
+    hdd_state.drive[HDD_DRIVE_1].current_cylinder =
+        (status[HDD_DRIVE_1] & HDD_STAT_CYL_MASK) >> HDD_STAT_CYL_SHIFT;
+    return HAL_OK;
 }
 
 bool hdd_any_seeking(void)
@@ -1005,3 +1583,26 @@ void hdd_lba_to_chs(uint32_t lba, uint16_t *cylinder, uint8_t *head,
     if (head) *head = temp % geom->heads;
     if (cylinder) *cylinder = temp / geom->heads;
 }
+
+int hdd_interleave_map(const hdd_geometry_t *geom, uint8_t phys[HDD_MAX_SPT])
+{
+    if (geom == NULL || geom->sectors == 0 || geom->sectors > HDD_MAX_SPT) {
+        return HAL_ERR_INVALID;
+    }
+
+    uint8_t n = geom->sectors;
+    uint8_t step = geom->interleave ? geom->interleave : 1;
+    uint8_t slot = 0;
+
+    memset(phys, 0, n);
+
+    for (uint8_t id = 1; id <= n; id++) {
+        while (phys[slot] != 0) {
+            slot = (slot + 1) % n;
+        }
+        phys[slot] = id;
+        slot = (slot + step) % n;
+    }
+
+    return HAL_OK;
+}
@@ -20,9 +20,13 @@
 
 #include "hdd_metadata.h"
 #include "hdd_hal.h"
+#include "cli.h"
 #include "fluxripper_hal.h"
+#include "event.h"
+#include "timer.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 
 //=============================================================================
@@ -33,15 +37,39 @@
 #define META_BASE   (HDD_BASE + META_REG_BASE)
 
 static inline void meta_reg_write(uint32_t offset, uint32_t value) {
-    volatile uint32_t *reg = (volatile uint32_t *)(META_BASE + offset);
+    volatile uint32_t *reg = &REG32(META_BASE + offset);
     *reg = value;
 }
 
 static inline uint32_t meta_reg_read(uint32_t offset) {
-    volatile uint32_t *reg = (volatile uint32_t *)(META_BASE + offset);
+    volatile uint32_t *reg = &REG32(META_BASE + offset);
     return *reg;
 }
 
+/**
+ * Copy a block of consecutive registers in one burst of back-to-back loads
+ */
+static void meta_reg_burst(uint32_t offset, uint32_t *dst, uint32_t words) {
+    const volatile uint32_t *src = &REG32(META_BASE + offset);
+
+    for (uint32_t i = 0; i < words; i++) {
+        dst[i] = src[i];
+    }
+}
+
+// Layout of the META_REG_WINDOW block
+typedef struct {
+    uint32_t guid[4];           // 0x10
+    uint32_t timestamp_lo;      // 0x20
+    uint32_t timestamp_hi;      // 0x24
+    uint32_t flags;             // 0x28
+    uint32_t session_count;     // 0x2C
+    uint32_t read_count;        // 0x30
+    uint32_t error_count;       // 0x34
+    uint32_t reserved[2];       // 0x38
+    uint32_t fingerprint[8];    // 0x40
+} meta_window_t;
+
 //=============================================================================
 // Module State
 //=============================================================================
@@ -52,36 +80,149 @@ static struct {
     hdd_metadata_t cache[2];    // Cached metadata
 } g_meta;
 
+// Deferred write-back: one queued image per drive, one write in flight
+static struct {
+    hdd_metadata_t pending[2];  // Latest image queued per drive
+    bool queued[2];
+    uint8_t retries[2];
+    int8_t active;              // Drive being written, -1 = none
+    uint32_t start_ms;
+} g_wb = { .active = -1 };
+
 //=============================================================================
 // Private Functions
 //=============================================================================
 
+static bool meta_done_check(void *arg) {
+    uint32_t *status = (uint32_t *)arg;
+
+    *status = meta_reg_read(META_REG_CTRL - META_REG_BASE);
+    return (*status & META_CTRL_DONE) || !(*status & META_CTRL_BUSY);
+}
+
+/**
+ * Result of a finished operation from its final status
+ */
+static meta_error_t meta_status_result(uint32_t status) {
+    if (status & META_CTRL_DONE) {
+        if (status & META_CTRL_ERROR) {
+            return (meta_error_t)((status & META_CTRL_ERROR_CODE) >> 12);
+        }
+        return META_OK;
+    }
+
+    // Not busy but not done - something wrong
+    return META_ERR_TIMEOUT;
+}
+
 /**
  * Wait for metadata operation to complete
  */
 static meta_error_t wait_for_completion(uint32_t timeout_ms) {
-    uint32_t start = hal_get_time_ms();
+    uint32_t status = 0;
 
-    while ((hal_get_time_ms() - start) < timeout_ms) {
-        uint32_t status = meta_reg_read(META_REG_CTRL - META_REG_BASE);
+    if (!event_wait(NULL, meta_done_check, &status, timeout_ms)) {
+        return META_ERR_TIMEOUT;
+    }
 
-        if (status & META_CTRL_DONE) {
-            if (status & META_CTRL_ERROR) {
-                return (meta_error_t)((status & META_CTRL_ERROR_CODE) >> 12);
-            }
-            return META_OK;
-        }
+    return meta_status_result(status);
+}
 
-        if (!(status & META_CTRL_BUSY)) {
-            // Not busy but not done - something wrong
-            return META_ERR_TIMEOUT;
-        }
+/**
+ * Load the data registers for a write
+ */
+static void meta_load_regs(const hdd_metadata_t *meta) {
+    // GUID
+    meta_reg_write(META_REG_GUID_0 - META_REG_BASE, meta->guid.data1);
+    meta_reg_write(META_REG_GUID_1 - META_REG_BASE,
+                   ((uint32_t)meta->guid.data2 << 16) | meta->guid.data3);
+    uint32_t guid2, guid3;
+    memcpy(&guid2, meta->guid.data4, 4);
+    memcpy(&guid3, &meta->guid.data4[4], 4);
+    meta_reg_write(META_REG_GUID_2 - META_REG_BASE, guid2);
+    meta_reg_write(META_REG_GUID_3 - META_REG_BASE, guid3);
+
+    // Timestamp
+    meta_reg_write(META_REG_TIMESTAMP_LO - META_REG_BASE, (uint32_t)meta->timestamp);
+    meta_reg_write(META_REG_TIMESTAMP_HI - META_REG_BASE, (uint32_t)(meta->timestamp >> 32));
+
+    // Flags and stats
+    meta_reg_write(META_REG_FLAGS - META_REG_BASE, meta->flags);
+    meta_reg_write(META_REG_SESSION_COUNT - META_REG_BASE, meta->session_count);
+    meta_reg_write(META_REG_READ_COUNT - META_REG_BASE, meta->read_count);
+    meta_reg_write(META_REG_ERROR_COUNT - META_REG_BASE, meta->error_count);
 
-        // Small delay to avoid hammering the bus
-        hal_delay_us(100);
+    // Fingerprint
+    const uint32_t *fp_words = (const uint32_t *)&meta->fingerprint;
+    for (int i = 0; i < 8; i++) {
+        meta_reg_write((META_REG_FINGERPRINT_0 - META_REG_BASE) + i * 4, fp_words[i]);
     }
+}
 
-    return META_ERR_TIMEOUT;
+/**
+ * Decode one session record (4 words)
+ */
+static void meta_unpack_session(const uint32_t *d, diag_session_t *sess) {
+    sess->timestamp = ((uint64_t)d[1] << 32) | d[0];
+    sess->type = (uint8_t)(d[2] & 0xFF);
+    sess->duration_sec = (d[2] >> 8) | ((d[3] & 0xFF) << 24);
+    sess->errors = (uint16_t)(d[3] >> 8);
+    sess->warnings = (uint8_t)(d[3] >> 24);
+}
+
+/**
+ * Retire the write-back in flight once the engine reports completion
+ * @param wait_ms how long to wait for it (0 = check once)
+ * @return true if no write-back is in flight any more
+ */
+static bool wb_retire(uint32_t wait_ms) {
+    uint32_t status = 0;
+    meta_error_t err;
+    uint8_t drive;
+
+    if (g_wb.active < 0) {
+        return true;
+    }
+    drive = (uint8_t)g_wb.active;
+
+    if (event_wait(NULL, meta_done_check, &status, wait_ms)) {
+        err = meta_status_result(status);
+    } else if (timer_get_ms() - g_wb.start_ms > META_WB_TIMEOUT_MS) {
+        err = META_ERR_TIMEOUT;
+    } else {
+        return false;
+    }
+
+    g_wb.active = -1;
+    if (err == META_OK) {
+        g_wb.retries[drive] = 0;
+        g_meta.cache[drive].dirty = g_wb.queued[drive];
+    } else if (!g_wb.queued[drive] && ++g_wb.retries[drive] < META_WB_RETRIES) {
+        // Nothing newer queued meanwhile: try this image again
+        g_wb.queued[drive] = true;
+    }
+    return true;
+}
+
+/**
+ * Start the queued write-back for a drive
+ */
+static void wb_start(uint8_t drive) {
+    hdd_select(drive);
+    meta_load_regs(&g_wb.pending[drive]);
+
+    g_wb.queued[drive] = false;
+    g_wb.active = (int8_t)drive;
+    g_wb.start_ms = timer_get_ms();
+    meta_reg_write(META_REG_CTRL - META_REG_BASE, META_CTRL_WRITE_START);
+}
+
+/**
+ * Blocking operations take the engine from write-back first
+ */
+static void wb_quiesce(void) {
+    wb_retire(META_WB_TIMEOUT_MS);
+    g_wb.active = -1;
 }
 
 /**
@@ -96,7 +237,7 @@ static uint32_t lfsr_next(uint32_t *state) {
 /**
  * Simple hash function for fingerprint
  */
-static uint32_t fingerprint_hash(const drive_fingerprint_t *fp) {
+uint32_t meta_fingerprint_hash(const drive_fingerprint_t *fp) {
     const uint8_t *data = (const uint8_t *)fp;
     uint32_t hash = 5381;
 
@@ -164,6 +305,8 @@ meta_error_t meta_read(uint8_t drive, hdd_metadata_t *meta) {
         return META_ERR_INVALID_DRIVE;  // Using generic error
     }
 
+    wb_quiesce();
+
     // Select drive
     hdd_select(drive);
 
@@ -181,57 +324,59 @@ meta_error_t meta_read(uint8_t drive, hdd_metadata_t *meta) {
     if (!(status & META_CTRL_VALID)) {
         // No signature found - this is expected for untagged drives
         meta->valid = false;
+        g_meta.cache[drive].valid = false;
         return META_ERR_NO_SIGNATURE;
     }
 
-    // Read data from registers
+    // Header, stats and fingerprint in one burst, decoded from RAM
+    meta_window_t win;
+    meta_reg_burst(META_REG_WINDOW - META_REG_BASE, (uint32_t *)&win,
+                   META_REG_WINDOW_WORDS);
+
     meta->signature = METADATA_SIGNATURE;
     meta->version = METADATA_VERSION;
 
     // GUID
-    uint32_t guid0 = meta_reg_read(META_REG_GUID_0 - META_REG_BASE);
-    uint32_t guid1 = meta_reg_read(META_REG_GUID_1 - META_REG_BASE);
-    uint32_t guid2 = meta_reg_read(META_REG_GUID_2 - META_REG_BASE);
-    uint32_t guid3 = meta_reg_read(META_REG_GUID_3 - META_REG_BASE);
-    meta->guid.data1 = guid0;
-    meta->guid.data2 = (uint16_t)(guid1 >> 16);
-    meta->guid.data3 = (uint16_t)(guid1 & 0xFFFF);
-    memcpy(meta->guid.data4, &guid2, 4);
-    memcpy(&meta->guid.data4[4], &guid3, 4);
+    meta->guid.data1 = win.guid[0];
+    meta->guid.data2 = (uint16_t)(win.guid[1] >> 16);
+    meta->guid.data3 = (uint16_t)(win.guid[1] & 0xFFFF);
+    memcpy(meta->guid.data4, &win.guid[2], 4);
+    memcpy(&meta->guid.data4[4], &win.guid[3], 4);
 
     // Timestamp
-    meta->timestamp = ((uint64_t)meta_reg_read(META_REG_TIMESTAMP_HI - META_REG_BASE) << 32) |
-                      meta_reg_read(META_REG_TIMESTAMP_LO - META_REG_BASE);
+    meta->timestamp = ((uint64_t)win.timestamp_hi << 32) | win.timestamp_lo;
 
     // Flags and stats
-    meta->flags = (uint16_t)meta_reg_read(META_REG_FLAGS - META_REG_BASE);
-    meta->session_count = meta_reg_read(META_REG_SESSION_COUNT - META_REG_BASE);
-    meta->read_count = meta_reg_read(META_REG_READ_COUNT - META_REG_BASE);
-    meta->error_count = meta_reg_read(META_REG_ERROR_COUNT - META_REG_BASE);
+    meta->flags = (uint16_t)win.flags;
+    meta->session_count = win.session_count;
+    meta->read_count = win.read_count;
+    meta->error_count = win.error_count;
 
-    // Fingerprint (8 registers)
-    uint32_t *fp_words = (uint32_t *)&meta->fingerprint;
-    for (int i = 0; i < 8; i++) {
-        fp_words[i] = meta_reg_read((META_REG_FINGERPRINT_0 - META_REG_BASE) + i * 4);
-    }
+    // Fingerprint
+    memcpy(&meta->fingerprint, win.fingerprint, sizeof(win.fingerprint));
 
-    // Diagnostic sessions need to be read one at a time
-    for (int i = 0; i < 16; i++) {
-        meta_reg_write(META_REG_DIAG_IDX - META_REG_BASE, i);
+    // Diagnostic sessions: one burst from the table window if the RTL has
+    // it, otherwise one at a time through the index register
+    if (status & META_CTRL_DIAG_TABLE) {
+        uint32_t table[META_DIAG_TABLE_WORDS];
+
+        meta_reg_burst(META_REG_DIAG_TABLE - META_REG_BASE, table,
+                       META_DIAG_TABLE_WORDS);
+        for (int i = 0; i < 16; i++) {
+            meta_unpack_session(&table[i * 4], &meta->sessions[i]);
+        }
+    } else {
+        for (int i = 0; i < 16; i++) {
+            uint32_t d[4];
 
-        // Small delay for register update
-        hal_delay_us(10);
+            meta_reg_write(META_REG_DIAG_IDX - META_REG_BASE, i);
 
-        uint32_t d0 = meta_reg_read(META_REG_DIAG_DATA_0 - META_REG_BASE);
-        uint32_t d1 = meta_reg_read(META_REG_DIAG_DATA_1 - META_REG_BASE);
-        uint32_t d2 = meta_reg_read(META_REG_DIAG_DATA_2 - META_REG_BASE);
-        uint32_t d3 = meta_reg_read(META_REG_DIAG_DATA_3 - META_REG_BASE);
+            // Small delay for register update
+            hal_delay_us(10);
 
-        meta->sessions[i].timestamp = ((uint64_t)d1 << 32) | d0;
-        meta->sessions[i].type = (uint8_t)(d2 & 0xFF);
-        meta->sessions[i].duration_sec = (d2 >> 8) | ((d3 & 0xFF) << 24);
-        meta->sessions[i].errors = (uint16_t)(d3 >> 8);
-        meta->sessions[i].warnings = (uint8_t)(d3 >> 24);
+            meta_reg_burst(META_REG_DIAG_DATA_0 - META_REG_BASE, d, 4);
+            meta_unpack_session(d, &meta->sessions[i]);
+        }
     }
 
     // User notes are stored in firmware memory after reading sector 3
@@ -241,8 +386,10 @@ meta_error_t meta_read(uint8_t drive, hdd_metadata_t *meta) {
     meta->valid = true;
     meta->dirty = false;
 
-    // Cache a copy
-    memcpy(&g_meta.cache[drive], meta, sizeof(hdd_metadata_t));
+    // Cache a copy, unless a newer image is queued for write-back
+    if (!g_wb.queued[drive]) {
+        memcpy(&g_meta.cache[drive], meta, sizeof(hdd_metadata_t));
+    }
 
     return META_OK;
 }
@@ -258,35 +405,13 @@ meta_error_t meta_write(uint8_t drive, const hdd_metadata_t *meta) {
         return META_ERR_INVALID_DRIVE;
     }
 
+    wb_quiesce();
+
     // Select drive
     hdd_select(drive);
 
     // Write data to registers
-    // GUID
-    meta_reg_write(META_REG_GUID_0 - META_REG_BASE, meta->guid.data1);
-    meta_reg_write(META_REG_GUID_1 - META_REG_BASE,
-                   ((uint32_t)meta->guid.data2 << 16) | meta->guid.data3);
-    uint32_t guid2, guid3;
-    memcpy(&guid2, meta->guid.data4, 4);
-    memcpy(&guid3, &meta->guid.data4[4], 4);
-    meta_reg_write(META_REG_GUID_2 - META_REG_BASE, guid2);
-    meta_reg_write(META_REG_GUID_3 - META_REG_BASE, guid3);
-
-    // Timestamp
-    meta_reg_write(META_REG_TIMESTAMP_LO - META_REG_BASE, (uint32_t)meta->timestamp);
-    meta_reg_write(META_REG_TIMESTAMP_HI - META_REG_BASE, (uint32_t)(meta->timestamp >> 32));
-
-    // Flags and stats
-    meta_reg_write(META_REG_FLAGS - META_REG_BASE, meta->flags);
-    meta_reg_write(META_REG_SESSION_COUNT - META_REG_BASE, meta->session_count);
-    meta_reg_write(META_REG_READ_COUNT - META_REG_BASE, meta->read_count);
-    meta_reg_write(META_REG_ERROR_COUNT - META_REG_BASE, meta->error_count);
-
-    // Fingerprint
-    uint32_t *fp_words = (uint32_t *)&meta->fingerprint;
-    for (int i = 0; i < 8; i++) {
-        meta_reg_write((META_REG_FINGERPRINT_0 - META_REG_BASE) + i * 4, fp_words[i]);
-    }
+    meta_load_regs(meta);
 
     // Start write operation
     meta_reg_write(META_REG_CTRL - META_REG_BASE, META_CTRL_WRITE_START);
@@ -297,8 +422,10 @@ meta_error_t meta_write(uint8_t drive, const hdd_metadata_t *meta) {
         return err;
     }
 
-    // Update cache
+    // Update cache; this image supersedes anything queued
     memcpy(&g_meta.cache[drive], meta, sizeof(hdd_metadata_t));
+    g_meta.cache[drive].dirty = false;
+    g_wb.queued[drive] = false;
 
     return META_OK;
 }
@@ -311,6 +438,9 @@ meta_error_t meta_erase(uint8_t drive) {
         return META_ERR_NOT_INITIALIZED;
     }
 
+    wb_quiesce();
+    g_wb.queued[drive] = false;
+
     // Select drive
     hdd_select(drive);
 
@@ -329,6 +459,80 @@ meta_error_t meta_erase(uint8_t drive) {
     return META_OK;
 }
 
+meta_error_t meta_read_cached(uint8_t drive, hdd_metadata_t *meta) {
+    if (drive > 1) {
+        return META_ERR_INVALID_DRIVE;
+    }
+    if (!g_meta.initialized[drive]) {
+        return META_ERR_NOT_INITIALIZED;
+    }
+    if (meta == NULL) {
+        return META_ERR_INVALID_DRIVE;
+    }
+
+    if (g_meta.cache[drive].valid) {
+        memcpy(meta, &g_meta.cache[drive], sizeof(hdd_metadata_t));
+        return META_OK;
+    }
+
+    return meta_read(drive, meta);
+}
+
+meta_error_t meta_write_deferred(uint8_t drive, const hdd_metadata_t *meta) {
+    if (drive > 1) {
+        return META_ERR_INVALID_DRIVE;
+    }
+    if (!g_meta.initialized[drive]) {
+        return META_ERR_NOT_INITIALIZED;
+    }
+    if (meta == NULL) {
+        return META_ERR_INVALID_DRIVE;
+    }
+
+    memcpy(&g_wb.pending[drive], meta, sizeof(hdd_metadata_t));
+    g_wb.queued[drive] = true;
+    g_wb.retries[drive] = 0;
+
+    // Readers see the queued image straight away
+    memcpy(&g_meta.cache[drive], meta, sizeof(hdd_metadata_t));
+    g_meta.cache[drive].dirty = true;
+
+    return META_OK;
+}
+
+void meta_writeback_poll(void) {
+    if (!wb_retire(0)) {
+        return;
+    }
+
+    for (uint8_t d = 0; d < 2; d++) {
+        if (g_wb.queued[d] && hdd_idle_ms(d) >= META_WB_IDLE_MS &&
+            !hdd_discover_pending(d)) {
+            wb_start(d);
+            return;
+        }
+    }
+}
+
+meta_error_t meta_flush(uint8_t drive) {
+    if (drive > 1) {
+        return META_ERR_INVALID_DRIVE;
+    }
+
+    wb_quiesce();
+    if (!g_wb.queued[drive]) {
+        return META_OK;
+    }
+
+    // meta_write() clears the queue on success
+    hdd_metadata_t meta = g_wb.pending[drive];
+    return meta_write(drive, &meta);
+}
+
+bool meta_writeback_pending(uint8_t drive) {
+    return drive <= 1 && (g_wb.queued[drive] || g_wb.active == (int8_t)drive);
+}
+
 meta_error_t meta_create_new(hdd_metadata_t *meta,
                              const drive_fingerprint_t *fingerprint) {
     if (meta == NULL || fingerprint == NULL) {
@@ -502,7 +706,7 @@ void meta_generate_uuid(uuid_t *uuid,
     if (uuid == NULL) return;
 
     // Use fingerprint hash as primary seed
-    uint32_t fp_hash = fingerprint_hash(fingerprint);
+    uint32_t fp_hash = meta_fingerprint_hash(fingerprint);
 
     // LFSR state seeded from fingerprint + timestamp
     uint32_t lfsr = fp_hash ^ (uint32_t)timestamp ^ 0xDEADBEEF;
@@ -664,12 +868,12 @@ void meta_print_history(const hdd_metadata_t *meta) {
  * CLI: meta status [drive]
  * Shows metadata status for specified drive or both
  */
-void cmd_meta_status(int argc, char **argv) {
+static int cmd_meta_status(int argc, char *argv[]) {
     int drive_start = 0;
     int drive_end = 1;
 
-    if (argc > 2) {
-        int d = atoi(argv[2]);
+    if (argc > 1) {
+        int d = atoi(argv[1]);
         if (d >= 0 && d <= 1) {
             drive_start = d;
             drive_end = d;
@@ -696,22 +900,23 @@ void cmd_meta_status(int argc, char **argv) {
             printf("Error reading metadata: %d\n", err);
         }
     }
+    return 0;
 }
 
 /**
  * CLI: meta init <drive>
  * Initialize metadata on a drive (requires fingerprint first)
  */
-void cmd_meta_init(int argc, char **argv) {
-    if (argc < 3) {
+static int cmd_meta_init(int argc, char *argv[]) {
+    if (argc < 2) {
         printf("Usage: meta init <drive>\n");
-        return;
+        return -1;
     }
 
-    int drive = atoi(argv[2]);
+    int drive = atoi(argv[1]);
     if (drive < 0 || drive > 1) {
         printf("Invalid drive number (0 or 1)\n");
-        return;
+        return -1;
     }
 
     // Check if fingerprint exists
@@ -726,33 +931,34 @@ void cmd_meta_init(int argc, char **argv) {
     meta_error_t err = meta_create_new(&meta, &fp);
     if (err != META_OK) {
         printf("Failed to create metadata: %d\n", err);
-        return;
+        return -1;
     }
 
     err = meta_write(drive, &meta);
     if (err != META_OK) {
         printf("Failed to write metadata: %d\n", err);
-        return;
+        return -1;
     }
 
     printf("Metadata initialized successfully!\n");
     meta_print_summary(&meta);
+    return 0;
 }
 
 /**
  * CLI: meta history <drive>
  * Show diagnostic session history
  */
-void cmd_meta_history(int argc, char **argv) {
-    if (argc < 3) {
+static int cmd_meta_history(int argc, char *argv[]) {
+    if (argc < 2) {
         printf("Usage: meta history <drive>\n");
-        return;
+        return -1;
     }
 
-    int drive = atoi(argv[2]);
+    int drive = atoi(argv[1]);
     if (drive < 0 || drive > 1) {
         printf("Invalid drive number\n");
-        return;
+        return -1;
     }
 
     hdd_metadata_t meta;
@@ -762,36 +968,38 @@ void cmd_meta_history(int argc, char **argv) {
         meta_print_history(&meta);
     } else {
         printf("Error reading metadata: %d\n", err);
+        return -1;
     }
+    return 0;
 }
 
 /**
  * CLI: meta note <drive> <text>
  * Set user notes
  */
-void cmd_meta_note(int argc, char **argv) {
-    if (argc < 4) {
+static int cmd_meta_note(int argc, char *argv[]) {
+    if (argc < 3) {
         printf("Usage: meta note <drive> <text>\n");
-        return;
+        return -1;
     }
 
-    int drive = atoi(argv[2]);
+    int drive = atoi(argv[1]);
     if (drive < 0 || drive > 1) {
         printf("Invalid drive number\n");
-        return;
+        return -1;
     }
 
     hdd_metadata_t meta;
     meta_error_t err = meta_read(drive, &meta);
     if (err != META_OK) {
         printf("Error reading metadata: %d\n", err);
-        return;
+        return -1;
     }
 
     // Concatenate remaining arguments as note
     char note[32] = {0};
     int pos = 0;
-    for (int i = 3; i < argc && pos < 31; i++) {
+    for (int i = 2; i < argc && pos < 31; i++) {
         int len = strlen(argv[i]);
         if (pos + len + 1 < 31) {
             if (pos > 0) note[pos++] = ' ';
@@ -805,26 +1013,27 @@ void cmd_meta_note(int argc, char **argv) {
     err = meta_write(drive, &meta);
     if (err != META_OK) {
         printf("Error writing metadata: %d\n", err);
-        return;
+        return -1;
     }
 
     printf("Note saved: %s\n", note);
+    return 0;
 }
 
 /**
  * CLI: meta erase <drive>
  * Erase metadata from drive
  */
-void cmd_meta_erase(int argc, char **argv) {
-    if (argc < 3) {
+static int cmd_meta_erase(int argc, char *argv[]) {
+    if (argc < 2) {
         printf("Usage: meta erase <drive>\n");
-        return;
+        return -1;
     }
 
-    int drive = atoi(argv[2]);
+    int drive = atoi(argv[1]);
     if (drive < 0 || drive > 1) {
         printf("Invalid drive number\n");
-        return;
+        return -1;
     }
 
     printf("WARNING: This will erase FluxRipper metadata from drive %d\n", drive);
@@ -837,33 +1046,34 @@ void cmd_meta_erase(int argc, char **argv) {
     meta_error_t err = meta_erase(drive);
     if (err != META_OK) {
         printf("Error erasing metadata: %d\n", err);
-        return;
+        return -1;
     }
 
     printf("Metadata erased successfully\n");
+    return 0;
 }
 
 /**
  * CLI: meta id <drive> <vendor> <model> [serial]
  * Set drive identification from label
  */
-void cmd_meta_id(int argc, char **argv) {
-    if (argc < 5) {
+static int cmd_meta_id(int argc, char *argv[]) {
+    if (argc < 4) {
         printf("Usage: meta id <drive> <vendor> <model> [serial]\n");
         printf("Example: meta id 0 Seagate ST-225 8734291\n");
         printf("Example: meta id 1 \"Control Data\" \"Wren III\" \"ABC123\"\n");
-        return;
+        return -1;
     }
 
-    int drive = atoi(argv[2]);
+    int drive = atoi(argv[1]);
     if (drive < 0 || drive > 1) {
         printf("Invalid drive number\n");
-        return;
+        return -1;
     }
 
-    const char *vendor = argv[3];
-    const char *model = argv[4];
-    const char *serial = (argc > 5) ? argv[5] : NULL;
+    const char *vendor = argv[2];
+    const char *model = argv[3];
+    const char *serial = (argc > 4) ? argv[4] : NULL;
 
     hdd_metadata_t meta;
     meta_error_t err = meta_read(drive, &meta);
@@ -876,7 +1086,7 @@ void cmd_meta_id(int argc, char **argv) {
         meta_create_new(&meta, &fp);
     } else if (err != META_OK) {
         printf("Error reading metadata: %d\n", err);
-        return;
+        return -1;
     }
 
     meta_set_identity(&meta, vendor, model, serial);
@@ -884,7 +1094,7 @@ void cmd_meta_id(int argc, char **argv) {
     err = meta_write(drive, &meta);
     if (err != META_OK) {
         printf("Error writing metadata: %d\n", err);
-        return;
+        return -1;
     }
 
     printf("Drive identification saved:\n");
@@ -893,38 +1103,39 @@ void cmd_meta_id(int argc, char **argv) {
     if (meta.identity.serial[0] != '\0') {
         printf("  Serial: %s\n", meta.identity.serial);
     }
+    return 0;
 }
 
 /**
  * CLI: meta datecode <drive> <date_code> [revision]
  * Set extended identity fields
  */
-void cmd_meta_datecode(int argc, char **argv) {
-    if (argc < 4) {
+static int cmd_meta_datecode(int argc, char *argv[]) {
+    if (argc < 3) {
         printf("Usage: meta datecode <drive> <date_code> [revision]\n");
         printf("Example: meta datecode 0 8723 A.01\n");
-        return;
+        return -1;
     }
 
-    int drive = atoi(argv[2]);
+    int drive = atoi(argv[1]);
     if (drive < 0 || drive > 1) {
         printf("Invalid drive number\n");
-        return;
+        return -1;
     }
 
-    const char *date_code = argv[3];
-    const char *revision = (argc > 4) ? argv[4] : NULL;
+    const char *date_code = argv[2];
+    const char *revision = (argc > 3) ? argv[3] : NULL;
 
     hdd_metadata_t meta;
     meta_error_t err = meta_read(drive, &meta);
     if (err != META_OK && err != META_ERR_NO_SIGNATURE) {
         printf("Error reading metadata: %d\n", err);
-        return;
+        return -1;
     }
 
     if (err == META_ERR_NO_SIGNATURE) {
         printf("No metadata on drive. Use 'meta init' or 'meta id' first.\n");
-        return;
+        return -1;
     }
 
     meta_set_identity_extended(&meta, date_code, revision);
@@ -932,7 +1143,7 @@ void cmd_meta_datecode(int argc, char **argv) {
     err = meta_write(drive, &meta);
     if (err != META_OK) {
         printf("Error writing metadata: %d\n", err);
-        return;
+        return -1;
     }
 
     printf("Extended identity saved:\n");
@@ -940,4 +1151,24 @@ void cmd_meta_datecode(int argc, char **argv) {
     if (meta.identity.revision[0] != '\0') {
         printf("  Revision:  %s\n", meta.identity.revision);
     }
+    return 0;
 }
+
+static const cli_cmd_t meta_subcmds[] = {
+    { "status",   "[drive]  Show metadata status",                  cmd_meta_status,   0, NULL },
+    { "init",     "<drive>  Create metadata on a drive",            cmd_meta_init,     0, NULL },
+    { "history",  "<drive>  Show diagnostic session history",       cmd_meta_history,  0, NULL },
+    { "note",     "<drive> <text>  Set user notes",                 cmd_meta_note,     0, NULL },
+    { "erase",    "<drive>  Erase metadata from a drive",           cmd_meta_erase,    0, NULL },
+    { "id",       "<drive> <vendor> <model> [serial]  Set identity", cmd_meta_id,      0, NULL },
+    { "datecode", "<drive> <date_code> [revision]  Set date code",  cmd_meta_datecode, 0, NULL },
+    { NULL, NULL, NULL, 0, NULL }
+};
+
+static const cli_cmd_t meta_cli_cmd = {
+    "meta", "Drive metadata (status, init, history, note, erase, id, datecode)",
+    NULL,
+    CLI_CMD_DRIVES,
+    meta_subcmds
+};
+CLI_COMMAND(meta_cli_cmd);
@@ -0,0 +1,290 @@
+/**
+ * FluxRipper HDD Discovery Profile Cache - Implementation
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-09 17:30
+ */
+
+#include "hdd_profile_cache.h"
+#include "board_eeprom.h"
+#include "fluxripper_hal.h"
+#include "crc16.h"
+#include <stddef.h>
+#include <string.h>
+
+/*============================================================================
+ * Internal State
+ *============================================================================*/
+
+/* Key of the drive on each port, from the last hdd_pcache_attach() */
+typedef struct {
+    bool        valid;
+    uint32_t    fp_hash;
+    uuid_t      guid;
+} pcache_key_t;
+
+static struct {
+    bool                loaded;
+    uint32_t            seq;
+    hdd_pcache_rec_t    rec[PCACHE_SLOTS];
+    pcache_key_t        key[HDD_NUM_DRIVES];
+    hdd_pcache_stats_t  stats;
+} pcache;
+
+/*============================================================================
+ * Records
+ *============================================================================*/
+
+static uint16_t rec_crc(const hdd_pcache_rec_t *r)
+{
+    return crc16_ccitt(r, offsetof(hdd_pcache_rec_t, crc));
+}
+
+static bool rec_valid(const hdd_pcache_rec_t *r)
+{
+    return r->magic == PCACHE_MAGIC && r->crc == rec_crc(r);
+}
+
+static void rec_save(uint8_t slot)
+{
+    hdd_pcache_rec_t *r = &pcache.rec[slot];
+
+    r->crc = rec_crc(r);
+    if (pcache.stats.eeprom_ok &&
+        eeprom_write_page(PCACHE_EEPROM_BASE + slot * EEPROM_PAGE, r) != HAL_OK) {
+        /* Keep going from RAM */
+        pcache.stats.eeprom_ok = false;
+    }
+}
+
+static int rec_find(const pcache_key_t *k)
+{
+    for (int i = 0; i < PCACHE_SLOTS; i++) {
+        const hdd_pcache_rec_t *r = &pcache.rec[i];
+        if (rec_valid(r) && r->fp_hash == k->fp_hash &&
+            memcmp(&r->guid, &k->guid, sizeof(uuid_t)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Slot for a new record: a free one, else the least recently used
+ */
+static int rec_victim(void)
+{
+    int lru = 0;
+
+    for (int i = 0; i < PCACHE_SLOTS; i++) {
+        if (!rec_valid(&pcache.rec[i])) {
+            return i;
+        }
+        if (pcache.rec[i].seq < pcache.rec[lru].seq) {
+            lru = i;
+        }
+    }
+    return lru;
+}
+
+static void rec_to_profile(const hdd_pcache_rec_t *r, hdd_profile_t *p)
+{
+    hdd_geometry_t *g = &p->geometry;
+
+    g->cylinders = r->cylinders;
+    g->heads = r->heads;
+    g->sectors = r->sectors;
+    g->sector_size = r->sector_size;
+    g->interleave = r->interleave;
+    g->skew = r->skew;
+    g->from_esdi_config = (r->flags & PCACHE_F_FROM_ESDI) != 0;
+    g->total_sectors = (uint32_t)g->cylinders * g->heads * g->sectors;
+    g->capacity_mb = (g->total_sectors * g->sector_size) / (1024 * 1024);
+
+    p->esdi_config.cylinders = r->esdi_cylinders;
+    p->esdi_config.heads = r->esdi_heads;
+    p->esdi_config.sectors_per_track = r->esdi_spt;
+    p->esdi_config.total_sectors =
+        (uint32_t)r->esdi_cylinders * r->esdi_heads * r->esdi_spt;
+    p->esdi_config.transfer_rate = r->esdi_rate;
+    p->esdi_config.soft_sectored = (r->flags & PCACHE_F_ESDI_SOFT) != 0;
+    p->esdi_config.fixed_drive = (r->flags & PCACHE_F_ESDI_FIXED) != 0;
+    p->esdi_config.valid = (r->flags & PCACHE_F_ESDI_VALID) != 0;
+
+    p->health.rpm = r->rpm;
+    p->valid = true;
+}
+
+static void rec_from_profile(hdd_pcache_rec_t *r, const pcache_key_t *k,
+                             const hdd_profile_t *p)
+{
+    const hdd_geometry_t *g = &p->geometry;
+
+    memset(r, 0, sizeof(*r));
+    r->magic = PCACHE_MAGIC;
+    r->fp_hash = k->fp_hash;
+    r->guid = k->guid;
+    r->seq = ++pcache.seq;
+
+    r->type = (uint8_t)p->detection.type;
+    r->phy_mode = (uint8_t)p->detection.phy_mode;
+    r->rate = (uint8_t)p->detection.rate;
+    r->confidence = p->detection.confidence;
+
+    r->cylinders = g->cylinders;
+    r->heads = g->heads;
+    r->sectors = g->sectors;
+    r->sector_size = g->sector_size;
+    r->interleave = g->interleave;
+    r->skew = g->skew;
+
+    r->esdi_cylinders = p->esdi_config.cylinders;
+    r->esdi_heads = p->esdi_config.heads;
+    r->esdi_spt = p->esdi_config.sectors_per_track;
+    r->esdi_rate = p->esdi_config.transfer_rate;
+    r->flags = (g->from_esdi_config ? PCACHE_F_FROM_ESDI : 0) |
+               (p->esdi_config.valid ? PCACHE_F_ESDI_VALID : 0) |
+               (p->esdi_config.soft_sectored ? PCACHE_F_ESDI_SOFT : 0) |
+               (p->esdi_config.fixed_drive ? PCACHE_F_ESDI_FIXED : 0);
+    r->rpm = p->health.rpm;
+}
+
+/*============================================================================
+ * API Implementation
+ *============================================================================*/
+
+int hdd_pcache_init(void)
+{
+    int ret = HAL_OK;
+
+    memset(&pcache, 0, sizeof(pcache));
+    pcache.loaded = true;
+    pcache.stats.eeprom_ok = true;
+
+    for (int i = 0; i < PCACHE_SLOTS && ret == HAL_OK; i++) {
+        ret = eeprom_read(PCACHE_EEPROM_BASE + i * EEPROM_PAGE,
+                          &pcache.rec[i], sizeof(hdd_pcache_rec_t));
+    }
+
+    if (ret != HAL_OK) {
+        memset(pcache.rec, 0, sizeof(pcache.rec));
+        pcache.stats.eeprom_ok = false;
+        return ret;
+    }
+
+    for (int i = 0; i < PCACHE_SLOTS; i++) {
+        if (rec_valid(&pcache.rec[i])) {
+            pcache.stats.entries++;
+            if (pcache.rec[i].seq > pcache.seq) {
+                pcache.seq = pcache.rec[i].seq;
+            }
+        }
+    }
+    return HAL_OK;
+}
+
+int hdd_pcache_attach(uint8_t drive, hdd_profile_t *profile)
+{
+    hdd_metadata_t meta;
+    pcache_key_t *k;
+    int slot;
+
+    if (drive >= HDD_NUM_DRIVES || profile == NULL) {
+        return HAL_ERR_INVALID;
+    }
+    if (!pcache.loaded) {
+        hdd_pcache_init();
+    }
+
+    k = &pcache.key[drive];
+    k->valid = false;
+
+    /* Untagged drive: nothing to key on, scan it */
+    if (meta_read(drive, &meta) != META_OK) {
+        pcache.stats.misses++;
+        return HAL_ERR_NOT_READY;
+    }
+    k->valid = true;
+    k->fp_hash = meta_fingerprint_hash(&meta.fingerprint);
+    k->guid = meta.guid;
+
+    slot = rec_find(k);
+    if (slot < 0) {
+        pcache.stats.misses++;
+        return HAL_ERR_NOT_READY;
+    }
+
+    hdd_pcache_rec_t *r = &pcache.rec[slot];
+
+    /* Verify: same interface as detected now, and the last cylinder seeks */
+    if (r->type != (uint8_t)profile->detection.type ||
+        r->phy_mode != (uint8_t)profile->detection.phy_mode ||
+        r->rate != (uint8_t)profile->detection.rate ||
+        r->cylinders == 0 ||
+        hdd_seek(drive, r->cylinders - 1) != HAL_OK ||
+        hdd_seek(drive, 0) != HAL_OK) {
+        pcache.stats.verify_failed++;
+        pcache.stats.misses++;
+        return HAL_ERR_HARDWARE;
+    }
+
+    rec_to_profile(r, profile);
+    r->seq = ++pcache.seq;
+    rec_save((uint8_t)slot);
+    pcache.stats.hits++;
+    return HAL_OK;
+}
+
+int hdd_pcache_store(uint8_t drive, const hdd_profile_t *profile)
+{
+    pcache_key_t *k;
+    int slot;
+
+    if (drive >= HDD_NUM_DRIVES || profile == NULL || !profile->valid) {
+        return HAL_ERR_INVALID;
+    }
+
+    k = &pcache.key[drive];
+    if (!k->valid) {
+        return HAL_ERR_NOT_READY;
+    }
+
+    slot = rec_find(k);
+    if (slot < 0) {
+        slot = rec_victim();
+        if (!rec_valid(&pcache.rec[slot])) {
+            pcache.stats.entries++;
+        }
+    }
+
+    rec_from_profile(&pcache.rec[slot], k, profile);
+    rec_save((uint8_t)slot);
+    return HAL_OK;
+}
+
+void hdd_pcache_clear(void)
+{
+    bool eeprom_ok;
+
+    if (!pcache.loaded) {
+        hdd_pcache_init();
+    }
+    eeprom_ok = pcache.stats.eeprom_ok;
+
+    memset(pcache.rec, 0, sizeof(pcache.rec));
+    pcache.stats.entries = 0;
+    pcache.loaded = true;
+
+    for (int i = 0; i < PCACHE_SLOTS && eeprom_ok; i++) {
+        eeprom_ok = eeprom_write_page(PCACHE_EEPROM_BASE + i * EEPROM_PAGE,
+                                      &pcache.rec[i]) == HAL_OK;
+    }
+    pcache.stats.eeprom_ok = eeprom_ok;
+}
+
+void hdd_pcache_get_stats(hdd_pcache_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = pcache.stats;
+    }
+}
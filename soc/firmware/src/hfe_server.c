@@ -0,0 +1,297 @@
+/*-----------------------------------------------------------------------------
+ * hfe_server.c
+ * HxC HFE Image Server
+ *
+ * Created: 2025-12-09 16:00
+ *
+ * In the image a cylinder is a run of 512-byte blocks, each holding 256
+ * bytes of side 0 then 256 bytes of side 1. Staging undoes that interleave
+ * so a side can be played out as one contiguous bitstream.
+ *---------------------------------------------------------------------------*/
+
+#include "hfe_server.h"
+#include "platform.h"
+#include "timer.h"
+#include <string.h>
+
+/*---------------------------------------------------------------------------
+ * Private Data
+ *---------------------------------------------------------------------------*/
+
+typedef struct {
+    int16_t     cylinder;           /* -1 = unused */
+    bool        ready;              /* Fully staged */
+    uint32_t    done;               /* Image bytes staged so far */
+} hfe_slot_t;
+
+static struct {
+    const uint8_t       *image;
+    const hfe_header_t  *hdr;
+    uint8_t             cylinders;
+    uint8_t             current;
+    int8_t              direction;  /* Last step: +1 / -1 */
+    uint32_t            track_off[HFE_MAX_CYLINDERS];   /* Byte offset in image */
+    uint16_t            track_len[HFE_MAX_CYLINDERS];   /* Bytes, both sides */
+    hfe_slot_t          slot[HFE_SLOTS];
+    hfe_server_stats_t  stats;
+} srv;
+
+/*---------------------------------------------------------------------------
+ * Private Functions
+ *---------------------------------------------------------------------------*/
+
+static inline uint8_t *slot_side(uint8_t i, uint8_t side)
+{
+    return (uint8_t *)(HFE_STAGE_BASE +
+                       ((uint32_t)i * 2 + side) * HFE_SLOT_SIDE_SIZE);
+}
+
+static int slot_find(int cylinder)
+{
+    for (int i = 0; i < HFE_SLOTS; i++) {
+        if (srv.slot[i].cylinder == cylinder) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * De-interleave up to 'budget' image bytes of a slot's cylinder
+ * @return true once the slot is fully staged
+ */
+static bool slot_stage(uint8_t i, uint32_t budget)
+{
+    hfe_slot_t *s = &srv.slot[i];
+    uint32_t len = srv.track_len[s->cylinder];
+    const uint8_t *src = srv.image + srv.track_off[s->cylinder];
+    uint8_t *side0 = slot_side(i, 0);
+    uint8_t *side1 = slot_side(i, 1);
+
+    while (s->done < len && budget > 0) {
+        /* One 512-byte block: side 0 half, then side 1 half */
+        uint32_t at = s->done / 2;
+        uint32_t n = (len - s->done) / 2;
+
+        if (n > HFE_SIDE_CHUNK) {
+            n = HFE_SIDE_CHUNK;
+        }
+        memcpy(side0 + at, src + s->done, n);
+        memcpy(side1 + at, src + s->done + HFE_SIDE_CHUNK, n);
+
+        s->done += HFE_BLOCK_SIZE;
+        budget = (budget > HFE_BLOCK_SIZE) ? budget - HFE_BLOCK_SIZE : 0;
+    }
+
+    if (s->done >= len) {
+        s->done = len;
+        s->ready = true;
+    }
+    return s->ready;
+}
+
+static void slot_assign(uint8_t i, int cylinder)
+{
+    srv.slot[i].cylinder = (int16_t)cylinder;
+    srv.slot[i].ready = false;
+    srv.slot[i].done = 0;
+}
+
+/**
+ * Point the spare slots at the neighbours of the current cylinder
+ */
+static void slots_plan(void)
+{
+    int want[2];
+    int cur = srv.current;
+
+    /* The step direction first, so poll stages it first */
+    want[0] = cur + srv.direction;
+    want[1] = cur - srv.direction;
+
+    for (int w = 0; w < 2; w++) {
+        int cyl = want[w];
+
+        if (cyl < 0 || cyl >= srv.cylinders || slot_find(cyl) >= 0) {
+            continue;
+        }
+        for (int i = 0; i < HFE_SLOTS; i++) {
+            int c = srv.slot[i].cylinder;
+            if (c < 0 || c < cur - 1 || c > cur + 1) {
+                slot_assign((uint8_t)i, cyl);
+                break;
+            }
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------
+ * Public Functions
+ *---------------------------------------------------------------------------*/
+
+int hfe_server_open(const uint8_t *image, uint32_t size)
+{
+    const hfe_header_t *hdr = (const hfe_header_t *)image;
+    const hfe_track_entry_t *lut;
+
+    hfe_server_close();
+
+    if (image == NULL || size < HFE_BLOCK_SIZE) {
+        return HFE_ERR_INVALID;
+    }
+    if (memcmp(hdr->signature, HFE_SIGNATURE, sizeof(hdr->signature)) != 0 ||
+        hdr->format_revision != 0 || hdr->number_of_track == 0 ||
+        hdr->number_of_side == 0 || hdr->number_of_side > 2) {
+        return HFE_ERR_FORMAT;
+    }
+
+    /* Decode the LUT once: absolute offsets, bounds checked */
+    uint32_t lut_off = (uint32_t)hdr->track_list_offset * HFE_BLOCK_SIZE;
+    if (lut_off + hdr->number_of_track * sizeof(hfe_track_entry_t) > size) {
+        return HFE_ERR_FORMAT;
+    }
+    lut = (const hfe_track_entry_t *)(image + lut_off);
+
+    for (uint32_t c = 0; c < hdr->number_of_track; c++) {
+        uint32_t off = (uint32_t)lut[c].offset * HFE_BLOCK_SIZE;
+        uint32_t len = lut[c].track_len;
+        /* Blocks are whole: the last one may be only partly used */
+        uint32_t span = (len + HFE_BLOCK_SIZE - 1) & ~(uint32_t)(HFE_BLOCK_SIZE - 1);
+
+        if (len == 0 || off + span > size) {
+            return HFE_ERR_FORMAT;
+        }
+        srv.track_off[c] = off;
+        srv.track_len[c] = (uint16_t)len;
+    }
+
+    srv.image = image;
+    srv.hdr = hdr;
+    srv.cylinders = hdr->number_of_track;
+    srv.current = 0;
+    srv.direction = 1;
+
+    /* Cylinder 0 now, cylinder 1 in the background */
+    slot_assign(0, 0);
+    slot_stage(0, UINT32_MAX);
+    slots_plan();
+    return HFE_OK;
+}
+
+void hfe_server_close(void)
+{
+    memset(&srv, 0, sizeof(srv));
+    for (int i = 0; i < HFE_SLOTS; i++) {
+        srv.slot[i].cylinder = -1;
+    }
+}
+
+const hfe_header_t *hfe_server_header(void)
+{
+    return srv.hdr;
+}
+
+int hfe_server_seek(uint8_t cylinder)
+{
+    uint32_t start = (uint32_t)timer_get_us();
+    int i;
+
+    if (srv.image == NULL) {
+        return HFE_ERR_NOT_OPEN;
+    }
+    if (cylinder >= srv.cylinders) {
+        return HFE_ERR_RANGE;
+    }
+
+    srv.stats.steps++;
+    if (cylinder != srv.current) {
+        srv.direction = (cylinder > srv.current) ? 1 : -1;
+    }
+
+    i = slot_find(cylinder);
+    if (i >= 0 && srv.slot[i].ready) {
+        srv.stats.hits++;
+    } else {
+        /* Long seek, or stepped before the neighbour finished */
+        if (i < 0) {
+            for (i = 0; i < HFE_SLOTS; i++) {
+                int c = srv.slot[i].cylinder;
+                if (c < 0 || c < cylinder - 1 || c > cylinder + 1) {
+                    break;
+                }
+            }
+            if (i == HFE_SLOTS) {
+                i = 0;
+            }
+            slot_assign((uint8_t)i, cylinder);
+        }
+        slot_stage((uint8_t)i, UINT32_MAX);
+        srv.stats.misses++;
+    }
+
+    srv.current = cylinder;
+    slots_plan();
+
+    srv.stats.last_us = (uint32_t)timer_get_us() - start;
+    if (srv.stats.last_us > srv.stats.max_us) {
+        srv.stats.max_us = srv.stats.last_us;
+    }
+    if (srv.stats.last_us > HFE_SETTLE_US) {
+        srv.stats.late++;
+    }
+    return HFE_OK;
+}
+
+int hfe_server_track(uint8_t side, const uint8_t **bits, uint32_t *len)
+{
+    int i;
+
+    if (bits == NULL || len == NULL) {
+        return HFE_ERR_INVALID;
+    }
+    if (srv.image == NULL) {
+        return HFE_ERR_NOT_OPEN;
+    }
+    if (side >= srv.hdr->number_of_side) {
+        return HFE_ERR_RANGE;
+    }
+
+    i = slot_find(srv.current);
+    if (i < 0 || !srv.slot[i].ready) {
+        return HFE_ERR_NOT_OPEN;
+    }
+
+    *bits = slot_side((uint8_t)i, side);
+    *len = srv.track_len[srv.current] / 2;
+    return HFE_OK;
+}
+
+void hfe_server_poll(void)
+{
+    int next = srv.current + srv.direction;
+    int pick = -1;
+
+    if (srv.image == NULL) {
+        return;
+    }
+
+    /* The cylinder in the step direction first */
+    for (int i = 0; i < HFE_SLOTS; i++) {
+        if (srv.slot[i].cylinder >= 0 && !srv.slot[i].ready) {
+            if (pick < 0 || srv.slot[i].cylinder == next) {
+                pick = i;
+            }
+        }
+    }
+
+    if (pick >= 0) {
+        slot_stage((uint8_t)pick, HFE_STAGE_STEP);
+    }
+}
+
+void hfe_server_get_stats(hfe_server_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = srv.stats;
+    }
+}
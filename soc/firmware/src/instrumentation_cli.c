@@ -8,6 +8,8 @@
  */
 
 #include "cli.h"
+#include "cli_bin.h"
+#include "fluxripper_hal.h"
 #include "instrumentation_hal.h"
 #include "power_hal.h"
 #include "usb_logger_hal.h"
@@ -33,6 +35,21 @@ static int cmd_diag_errors(int argc, char *argv[])
         return -1;
     }
 
+    if (cli_bin_active()) {
+        cli_bin_uint("crc_data", errors.crc_data);
+        cli_bin_uint("crc_addr", errors.crc_addr);
+        cli_bin_uint("missing_am", errors.missing_am);
+        cli_bin_uint("missing_dam", errors.missing_dam);
+        cli_bin_uint("overrun", errors.overrun);
+        cli_bin_uint("underrun", errors.underrun);
+        cli_bin_uint("seek", errors.seek);
+        cli_bin_uint("write_fault", errors.write_fault);
+        cli_bin_uint("pll_unlock", errors.pll_unlock);
+        cli_bin_uint("total", errors.total);
+        cli_bin_uint("error_rate", errors.error_rate);
+        return 0;
+    }
+
     uart_puts("\nLifetime Error Counters\n");
     uart_puts("-----------------------------------------\n");
     uart_printf("  CRC Data:       %lu\n", errors.crc_data);
@@ -72,6 +89,22 @@ static int cmd_diag_pll(int argc, char *argv[])
         return -1;
     }
 
+    if (cli_bin_active()) {
+        cli_bin_int("phase_error", pll.phase_error);
+        cli_bin_int("phase_avg", pll.phase_avg);
+        cli_bin_int("phase_peak", pll.phase_peak);
+        cli_bin_uint("freq_word", pll.freq_word);
+        cli_bin_int("freq_offset_ppm", pll.freq_offset_ppm);
+        cli_bin_uint("lock_time", pll.lock_time);
+        cli_bin_uint("total_lock_time", pll.total_lock_time);
+        cli_bin_uint("unlock_count", pll.unlock_count);
+        cli_bin_uint("quality_min", pll.quality_min);
+        cli_bin_uint("quality_avg", pll.quality_avg);
+        cli_bin_uint("quality_max", pll.quality_max);
+        cli_bin_u16_array("histogram", pll.histogram, 8);
+        return 0;
+    }
+
     uart_puts("\nPLL/DPLL Diagnostics\n");
     uart_puts("-----------------------------------------\n");
 
@@ -141,6 +174,23 @@ static int cmd_diag_fifo(int argc, char *argv[])
         return -1;
     }
 
+    if (cli_bin_active()) {
+        cli_bin_uint("peak_level", fifo.peak_level);
+        cli_bin_uint("min_level", fifo.min_level);
+        cli_bin_uint("utilization_pct", fifo.utilization_pct);
+        cli_bin_uint("overflow_count", fifo.overflow_count);
+        cli_bin_bool("overflow_flag", fifo.overflow_flag);
+        cli_bin_uint("underrun_count", fifo.underrun_count);
+        cli_bin_bool("underrun_flag", fifo.underrun_flag);
+        cli_bin_uint("backpressure", fifo.backpressure_cnt);
+        cli_bin_uint("total_writes", fifo.total_writes);
+        cli_bin_uint("total_reads", fifo.total_reads);
+        cli_bin_uint("time_at_peak", fifo.time_at_peak);
+        cli_bin_uint("time_empty", fifo.time_empty);
+        cli_bin_uint("time_full", fifo.time_full);
+        return 0;
+    }
+
     uart_puts("\nFIFO Statistics\n");
     uart_puts("-----------------------------------------\n");
 
@@ -393,8 +443,11 @@ static int cmd_diag_power(int argc, char *argv[])
     (void)argv;
 
     pmu_system_t sys;
-    int ret = pmu_read_all(&sys);
+    int ret = pmu_get_cached(&sys, NULL);
 
+    if (ret == PMU_ERR_NOT_READY) {
+        ret = pmu_read_all(&sys);
+    }
     if (ret != PMU_OK) {
         uart_puts("Failed to read power status (INA3221 not detected?)\n");
         return -1;
@@ -557,11 +610,17 @@ static int cmd_diag_usb_status(void)
     uart_puts("\nUSB Traffic Logger Status\n");
     uart_puts("-----------------------------------------\n");
     uart_printf("  Capture:      %s\n", status.enabled ? "ENABLED" : "disabled");
-    uart_printf("  Triggered:    %s\n", status.triggered ? "YES" : "no");
+    uart_printf("  Triggered:    %s\n", status.triggered ? "YES" :
+                status.armed ? "armed" : "no");
+    if (status.triggered) {
+        uart_printf("  Trigger At:   %lu us%s\n", status.trigger_time_us,
+                    status.post_done ? " (window complete)" : "");
+    }
     uart_printf("  Overflow:     %s\n", status.overflow ? "YES!" : "no");
     uart_printf("  Wrapped:      %s\n", status.wrapped ? "yes" : "no");
     uart_puts("-----------------------------------------\n");
     uart_printf("  Transactions: %lu\n", status.trans_count);
+    uart_printf("  Dropped:      %lu\n", status.drop_count);
     uart_printf("  Buffer Used:  %lu / %u bytes (%u%%)\n",
         status.bytes_used, USBLOG_BUFFER_SIZE, usblog_utilization_pct());
     uart_printf("  Write Ptr:    0x%04lX\n", status.write_ptr);
@@ -592,31 +651,88 @@ static int cmd_diag_usb_status(void)
     return 0;
 }
 
+/* Trigger PID names */
+static const struct {
+    const char *name;
+    uint8_t     pid;
+} usb_trigger_pids[] = {
+    { "setup", USB_PID_SETUP }, { "in",    USB_PID_IN    },
+    { "out",   USB_PID_OUT   }, { "data0", USB_PID_DATA0 },
+    { "data1", USB_PID_DATA1 }, { "ack",   USB_PID_ACK   },
+    { "nak",   USB_PID_NAK   }, { "stall", USB_PID_STALL },
+    { "nyet",  USB_PID_NYET  },
+};
+
+static bool parse_usb_pid(const char *name, uint8_t *pid)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(usb_trigger_pids); i++) {
+        if (strcmp(name, usb_trigger_pids[i].name) == 0) {
+            *pid = usb_trigger_pids[i].pid;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Trigger arguments for start/stream:
+ *   <pid> [then <pid>]... [byte <off> <val> [mask]] [count <n> [gap_us]]
+ *         [pre <n>] [post <n>] [nosof]
+ * Returns false on a malformed trigger.
+ */
+static bool parse_usb_trigger(int argc, char *argv[], usblog_trigger_t *trigger)
+{
+    if (argc < 2) {
+        return true;
+    }
+    if (!parse_usb_pid(argv[1], &trigger->pid)) {
+        return true;    /* Not a trigger: immediate start */
+    }
+    trigger->enabled = true;
+
+    for (int i = 2; i < argc; i++) {
+        const char *kw = argv[i];
+
+        if (strcmp(kw, "then") == 0 && i + 1 < argc &&
+            trigger->seq_len < USBLOG_TRIG_SEQ_MAX &&
+            parse_usb_pid(argv[i + 1], &trigger->seq_pid[trigger->seq_len])) {
+            trigger->seq_len++;
+            i++;
+        } else if (strcmp(kw, "byte") == 0 && i + 2 < argc) {
+            trigger->match_enabled = true;
+            trigger->match_offset = (uint8_t)strtoul(argv[i + 1], NULL, 0);
+            trigger->match_value = (uint8_t)strtoul(argv[i + 2], NULL, 0);
+            trigger->match_mask = 0xFF;
+            i += 2;
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9') {
+                trigger->match_mask = (uint8_t)strtoul(argv[++i], NULL, 0);
+            }
+        } else if (strcmp(kw, "count") == 0 && i + 1 < argc) {
+            trigger->hits = (uint16_t)strtoul(argv[++i], NULL, 0);
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9') {
+                trigger->max_gap_us = strtoul(argv[++i], NULL, 0);
+            }
+        } else if (strcmp(kw, "pre") == 0 && i + 1 < argc) {
+            trigger->pre_records = (uint8_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(kw, "post") == 0 && i + 1 < argc) {
+            trigger->post_records = (uint16_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(kw, "nosof") == 0) {
+            trigger->skip_sof = true;
+        } else {
+            uart_printf("Bad trigger argument: %s\n", kw);
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static int cmd_diag_usb_start(int argc, char *argv[])
 {
     usblog_trigger_t trigger = {0};
 
-    /* Check for trigger PID argument */
-    if (argc >= 2) {
-        if (strcmp(argv[1], "setup") == 0) {
-            trigger.enabled = true;
-            trigger.pid = USB_PID_SETUP;
-        } else if (strcmp(argv[1], "in") == 0) {
-            trigger.enabled = true;
-            trigger.pid = USB_PID_IN;
-        } else if (strcmp(argv[1], "out") == 0) {
-            trigger.enabled = true;
-            trigger.pid = USB_PID_OUT;
-        } else if (strcmp(argv[1], "data0") == 0) {
-            trigger.enabled = true;
-            trigger.pid = USB_PID_DATA0;
-        } else if (strcmp(argv[1], "nak") == 0) {
-            trigger.enabled = true;
-            trigger.pid = USB_PID_NAK;
-        } else if (strcmp(argv[1], "stall") == 0) {
-            trigger.enabled = true;
-            trigger.pid = USB_PID_STALL;
-        }
+    if (!parse_usb_trigger(argc, argv, &trigger)) {
+        return -1;
     }
 
     int ret = usblog_start(trigger.enabled ? &trigger : NULL);
@@ -708,6 +824,46 @@ static int cmd_diag_usb_export(void)
     return 0;
 }
 
+static int cmd_diag_usb_stream(int argc, char *argv[])
+{
+    usblog_stream_stats_t stats;
+
+    if (argc >= 2 && strcmp(argv[1], "start") == 0) {
+        usblog_trigger_t trigger = {0};
+
+        if (!parse_usb_trigger(argc - 1, &argv[1], &trigger)) {
+            return -1;
+        }
+        if (usblog_stream_start(trigger.enabled ? &trigger : NULL) != USBLOG_OK) {
+            uart_puts("Failed to start stream\n");
+            return -1;
+        }
+        uart_puts("USB capture streaming (pcapng)\n");
+        return 0;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "stop") == 0) {
+        if (usblog_stream_stop() != USBLOG_OK) {
+            uart_puts("No stream open\n");
+            return -1;
+        }
+        uart_puts("Stream stopping, draining logger\n");
+        return 0;
+    }
+
+    if (usblog_stream_get_stats(&stats) != USBLOG_OK) {
+        uart_puts("USB logger not initialized\n");
+        return -1;
+    }
+
+    uart_printf("Stream:   %s\n", !stats.active ? "idle" :
+                stats.stopping ? "draining" : "active");
+    uart_printf("Records:  %lu (dropped %lu)\n", stats.records, stats.dropped);
+    uart_printf("Blocks:   %lu (%lu KB)\n", stats.blocks,
+                (uint32_t)(stats.bytes / 1024));
+    return 0;
+}
+
 static int cmd_diag_usb_filter(int argc, char *argv[])
 {
     if (argc < 2) {
@@ -773,10 +929,13 @@ static int cmd_diag_usb(int argc, char *argv[])
         uart_puts("USB Logger Commands:\n");
         uart_puts("  diag usb status           - Show logger status\n");
         uart_puts("  diag usb start [trigger]  - Start capture (trigger: setup,in,out,nak,stall)\n");
+        uart_puts("      trigger options: then <pid> | byte <off> <val> [mask] |\n");
+        uart_puts("                       count <n> [gap_us] | pre <n> | post <n> | nosof\n");
         uart_puts("  diag usb stop             - Stop capture\n");
         uart_puts("  diag usb clear            - Clear buffer\n");
         uart_puts("  diag usb dump [n]         - Show last n transactions (default 20)\n");
         uart_puts("  diag usb export           - Export as PCAP (binary)\n");
+        uart_puts("  diag usb stream [start [trigger]|stop] - Continuous pcapng stream\n");
         uart_puts("  diag usb filter <type>    - Set capture filter\n");
         return cmd_diag_usb_status();
     }
@@ -797,6 +956,8 @@ static int cmd_diag_usb(int argc, char *argv[])
         return cmd_diag_usb_export();
     } else if (strcmp(subcmd, "filter") == 0) {
         return cmd_diag_usb_filter(argc - 1, &argv[1]);
+    } else if (strcmp(subcmd, "stream") == 0) {
+        return cmd_diag_usb_stream(argc - 1, &argv[1]);
     } else {
         uart_printf("Unknown USB command: %s\n", subcmd);
         return -1;
@@ -906,6 +1067,35 @@ static int cmd_diag_drives(int argc, char *argv[])
     return 0;
 }
 
+/*============================================================================
+ * FDD Motor Policy
+ *============================================================================*/
+
+/**
+ * diag motor [idle <ms>] - Motor idle timeout and spin-up counters
+ */
+static int cmd_diag_motor(int argc, char *argv[])
+{
+    hal_motor_stats_t stats;
+
+    if (argc >= 3 && strcmp(argv[1], "idle") == 0) {
+        hal_motor_set_idle_ms((uint32_t)strtoul(argv[2], NULL, 0));
+    } else if (argc >= 2) {
+        uart_puts("Usage: diag motor [idle <ms>]\n");
+        return -1;
+    }
+
+    hal_motor_get_stats(&stats);
+    uart_printf("Idle timeout: %lu ms%s\n", hal_motor_get_idle_ms(),
+        hal_motor_get_idle_ms() == 0 ? " (stop at release)" : "");
+    for (uint8_t i = 0; i < MAX_DRIVES; i++) {
+        uart_printf("  Drive %u: %s\n", i, hal_motor_at_speed(i) ? "running" : "stopped");
+    }
+    uart_printf("Spin-ups: %lu  Reused: %lu  Idle stops: %lu\n",
+        stats.spinups, stats.reuses, stats.idle_stops);
+    return 0;
+}
+
 /*============================================================================
  * Uptime Display
  *============================================================================*/
@@ -918,6 +1108,19 @@ static int cmd_diag_uptime(int argc, char *argv[])
     uptime_stats_t stats;
     sys_get_uptime(&stats);
 
+    if (cli_bin_active()) {
+        cli_bin_uint("uptime_s", stats.uptime_seconds);
+        cli_bin_uint("boot_count", stats.boot_count);
+        cli_bin_uint("tracks_read", stats.tracks_read);
+        cli_bin_uint("tracks_written", stats.tracks_written);
+        cli_bin_uint("seeks", stats.seeks_performed);
+        cli_bin_uint("usb_kb", stats.bytes_transferred);
+        cli_bin_uint("captures", stats.captures_completed);
+        cli_bin_uint("session_errors", stats.session_errors);
+        cli_bin_uint("session_retries", stats.session_retries);
+        return 0;
+    }
+
     /* Convert seconds to d:h:m:s */
     uint32_t days = stats.uptime_seconds / 86400;
     uint32_t hours = (stats.uptime_seconds % 86400) / 3600;
@@ -1271,6 +1474,47 @@ static int cmd_diag_mem(int argc, char *argv[])
     return 0;
 }
 
+/*============================================================================
+ * Counter Delta
+ *============================================================================*/
+
+/**
+ * Words of one latched snapshot that changed since a generation
+ * A poller passes back the generation it was given last time.
+ */
+static int cmd_diag_delta(int argc, char *argv[])
+{
+    diag_delta_t delta[DIAG_SNAP_WORDS];
+    uint32_t gen = (argc >= 2) ? (uint32_t)strtoul(argv[1], NULL, 0) : 0;
+
+    int count = diag_read_delta(&gen, delta);
+    if (count < 0) {
+        uart_puts("Failed to latch counters.\n");
+        return -1;
+    }
+
+    if (cli_bin_active()) {
+        uint16_t offsets[DIAG_SNAP_WORDS];
+        uint32_t values[DIAG_SNAP_WORDS];
+
+        for (int i = 0; i < count; i++) {
+            offsets[i] = delta[i].offset;
+            values[i] = delta[i].value;
+        }
+        cli_bin_uint("gen", gen);
+        cli_bin_u16_array("offset", offsets, (uint32_t)count);
+        cli_bin_u32_array("value", values, (uint32_t)count);
+        return 0;
+    }
+
+    uart_printf("Generation %lu: %d changed\n", gen, count);
+    for (int i = 0; i < count; i++) {
+        uart_printf("  0x%03x  0x%08lx  %lu\n", delta[i].offset,
+            delta[i].value, delta[i].value);
+    }
+    return 0;
+}
+
 /*============================================================================
  * Show All Diagnostics
  *============================================================================*/
@@ -1304,90 +1548,46 @@ static int cmd_diag_all(int argc, char *argv[])
     return 0;
 }
 
-/*============================================================================
- * Main Diagnostics Command Dispatcher
- *============================================================================*/
-
-int cmd_diag(int argc, char *argv[])
-{
-    if (argc < 2) {
-        uart_puts("Diagnostics Commands:\n");
-        uart_puts("  diag version  - Show firmware/FPGA version info\n");
-        uart_puts("  diag drives   - Show connected drive status\n");
-        uart_puts("  diag uptime   - Show uptime and statistics\n");
-        uart_puts("  diag errors   - Show lifetime error counters\n");
-        uart_puts("  diag pll      - Show PLL/DPLL diagnostics\n");
-        uart_puts("  diag fifo     - Show FIFO statistics\n");
-        uart_puts("  diag capture  - Show capture timing\n");
-        uart_puts("  diag seek     - Show seek histogram (HDD)\n");
-        uart_puts("  diag power    - Show power rail monitoring\n");
-        uart_puts("  diag clocks   - Show clock status and frequencies\n");
-        uart_puts("  diag i2c [scan] - Show I2C bus diagnostics\n");
-        uart_puts("  diag temp     - Show temperature sensors\n");
-        uart_puts("  diag gpio     - Show GPIO pin states\n");
-        uart_puts("  diag mem [test] - Show memory status\n");
-        uart_puts("  diag usb      - USB traffic logger (start/stop/dump/export)\n");
-        uart_puts("  diag clear [cat] - Clear stats (all or category)\n");
-        uart_puts("  diag all      - Show all diagnostics\n");
-        return 0;
-    }
-
-    /* Dispatch to subcommand */
-    if (strcmp(argv[1], "version") == 0) {
-        return cmd_diag_version(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "drives") == 0) {
-        return cmd_diag_drives(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "uptime") == 0) {
-        return cmd_diag_uptime(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "errors") == 0) {
-        return cmd_diag_errors(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "pll") == 0) {
-        return cmd_diag_pll(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "fifo") == 0) {
-        return cmd_diag_fifo(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "capture") == 0) {
-        return cmd_diag_capture(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "seek") == 0) {
-        return cmd_diag_seek(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "power") == 0) {
-        return cmd_diag_power(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "clocks") == 0) {
-        return cmd_diag_clocks(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "i2c") == 0) {
-        return cmd_diag_i2c(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "temp") == 0) {
-        return cmd_diag_temp(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "gpio") == 0) {
-        return cmd_diag_gpio(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "mem") == 0) {
-        return cmd_diag_mem(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "usb") == 0) {
-        return cmd_diag_usb(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "clear") == 0) {
-        return cmd_diag_clear(argc - 1, &argv[1]);
-    } else if (strcmp(argv[1], "all") == 0) {
-        return cmd_diag_all(argc - 1, &argv[1]);
-    } else {
-        uart_printf("Unknown diag command: %s\n", argv[1]);
-        uart_puts("Type 'diag' for available commands.\n");
-        return -1;
-    }
-}
-
 /*============================================================================
  * CLI Registration
  *============================================================================*/
 
+static const cli_cmd_t diag_subcmds[] = {
+    { "version", "Show firmware/FPGA version info",               cmd_diag_version, 0, NULL },
+    { "drives",  "Show connected drive status",                   cmd_diag_drives, 0, NULL },
+    { "motor",   "[idle ms] FDD motor idle timeout and counters", cmd_diag_motor, 0, NULL },
+    { "uptime",  "Show uptime and statistics",                    cmd_diag_uptime, 0, NULL },
+    { "errors",  "Show lifetime error counters",                  cmd_diag_errors, 0, NULL },
+    { "pll",     "Show PLL/DPLL diagnostics",                     cmd_diag_pll, 0, NULL },
+    { "fifo",    "Show FIFO statistics",                          cmd_diag_fifo, 0, NULL },
+    { "capture", "Show capture timing",                           cmd_diag_capture, 0, NULL },
+    { "seek",    "Show seek histogram (HDD)",                     cmd_diag_seek, 0, NULL },
+    { "power",   "Show power rail monitoring",                    cmd_diag_power, 0, NULL },
+    { "clocks",  "Show clock status and frequencies",             cmd_diag_clocks, 0, NULL },
+    { "i2c",     "[scan] Show I2C bus diagnostics",               cmd_diag_i2c, 0, NULL },
+    { "temp",    "Show temperature sensors",                      cmd_diag_temp, 0, NULL },
+    { "gpio",    "Show GPIO pin states",                          cmd_diag_gpio, 0, NULL },
+    { "mem",     "[test] Show memory status",                     cmd_diag_mem, 0, NULL },
+    { "usb",     "USB traffic logger (start/stop/dump/export)",   cmd_diag_usb, 0, NULL },
+    { "clear",   "[cat] Clear stats (all or category)",           cmd_diag_clear, 0, NULL },
+    { "delta",   "[gen] Counter words changed since a generation", cmd_diag_delta, 0, NULL },
+    { "all",     "Show all diagnostics",                          cmd_diag_all, 0, NULL },
+    { NULL, NULL, NULL, 0, NULL }
+};
+
 /**
- * Diagnostics CLI command definition for registration
+ * Diagnostics CLI command definition, linked into the command table
  */
 const cli_cmd_t diag_cli_cmd = {
     "diag", "Diagnostics (version, drives, uptime, errors, pll, fifo, capture, seek, power, clocks, i2c, temp, gpio, mem, usb)",
-    cmd_diag
+    NULL,
+    0,
+    diag_subcmds
 };
+CLI_COMMAND(diag_cli_cmd);
 
 /**
- * Initialize and register instrumentation CLI commands
+ * Initialize the HALs behind the 'diag' command
  */
 void instrumentation_cli_init(void)
 {
@@ -1399,7 +1599,4 @@ void instrumentation_cli_init(void)
 
     /* Initialize USB traffic logger */
     usblog_init();
-
-    /* Register diag command */
-    cli_register(&diag_cli_cmd);
 }
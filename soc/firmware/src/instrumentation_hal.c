@@ -34,6 +34,49 @@ static const char *error_names[] = {
     "PLL Unlock"
 };
 
+/*============================================================================
+ * Register Banks
+ *============================================================================*/
+
+/* Live registers, or a copy of the shadow bank laid out the same way */
+#define LIVE                ((const volatile uint32_t *)DIAG_BASE)
+#define BANK(b, reg)        ((b)[((uintptr_t)&(reg) - DIAG_BASE) / 4])
+
+/* Last latched bank, and the generation each word last changed in */
+static uint32_t snap_words[DIAG_SNAP_WORDS];
+static uint32_t snap_changed[DIAG_SNAP_WORDS];
+static uint32_t snap_gen;
+
+/**
+ * Latch every counter and copy the shadow bank
+ * @return generation of the new snapshot
+ */
+static uint32_t diag_latch(void)
+{
+    DIAG_LATCH_CTRL = DIAG_LATCH_STROBE;
+
+    /* Reading back the latch count orders the bank reads after the strobe */
+    (void)DIAG_LATCH_GEN;
+
+    /* 0 is kept for "never seen" */
+    uint32_t gen = snap_gen + 1;
+    if (gen == 0) {
+        gen = 1;
+    }
+
+    for (int i = 0; i < DIAG_SNAP_WORDS; i++) {
+        uint32_t val = DIAG_SHADOW(i);
+
+        if (val != snap_words[i] || snap_gen == 0) {
+            snap_words[i] = val;
+            snap_changed[i] = gen;
+        }
+    }
+    snap_gen = gen;
+
+    return gen;
+}
+
 /*============================================================================
  * Initialization
  *============================================================================*/
@@ -49,22 +92,26 @@ int diag_init(void)
  * Error Counter Functions
  *============================================================================*/
 
+static void unpack_errors(const volatile uint32_t *b, diag_errors_t *errors)
+{
+    errors->crc_data    = BANK(b, DIAG_ERR_CRC_DATA);
+    errors->crc_addr    = BANK(b, DIAG_ERR_CRC_ADDR);
+    errors->missing_am  = BANK(b, DIAG_ERR_MISSING_AM);
+    errors->missing_dam = BANK(b, DIAG_ERR_MISSING_DAM);
+    errors->overrun     = BANK(b, DIAG_ERR_OVERRUN);
+    errors->underrun    = BANK(b, DIAG_ERR_UNDERRUN);
+    errors->seek        = BANK(b, DIAG_ERR_SEEK);
+    errors->write_fault = BANK(b, DIAG_ERR_WRITE_FAULT);
+    errors->pll_unlock  = BANK(b, DIAG_ERR_PLL_UNLOCK);
+    errors->total       = BANK(b, DIAG_ERR_TOTAL);
+    errors->error_rate  = (uint8_t)(BANK(b, DIAG_ERR_RATE) & 0xFF);
+}
+
 int diag_read_errors(diag_errors_t *errors)
 {
     if (!errors) return DIAG_ERR_INVALID;
 
-    errors->crc_data    = DIAG_ERR_CRC_DATA;
-    errors->crc_addr    = DIAG_ERR_CRC_ADDR;
-    errors->missing_am  = DIAG_ERR_MISSING_AM;
-    errors->missing_dam = DIAG_ERR_MISSING_DAM;
-    errors->overrun     = DIAG_ERR_OVERRUN;
-    errors->underrun    = DIAG_ERR_UNDERRUN;
-    errors->seek        = DIAG_ERR_SEEK;
-    errors->write_fault = DIAG_ERR_WRITE_FAULT;
-    errors->pll_unlock  = DIAG_ERR_PLL_UNLOCK;
-    errors->total       = DIAG_ERR_TOTAL;
-    errors->error_rate  = (uint8_t)(DIAG_ERR_RATE & 0xFF);
-
+    unpack_errors(LIVE, errors);
     return DIAG_OK;
 }
 
@@ -78,34 +125,32 @@ int diag_clear_errors(void)
  * PLL Diagnostic Functions
  *============================================================================*/
 
-int diag_read_pll(diag_pll_t *pll)
+static void unpack_pll(const volatile uint32_t *b, diag_pll_t *pll)
 {
-    if (!pll) return DIAG_ERR_INVALID;
-
-    uint32_t phase = DIAG_PLL_PHASE_ERR;
+    uint32_t phase = BANK(b, DIAG_PLL_PHASE_ERR);
     pll->phase_error = (int16_t)(phase & 0xFFFF);
 
-    uint32_t avg_peak = DIAG_PLL_PHASE_AVG;
+    uint32_t avg_peak = BANK(b, DIAG_PLL_PHASE_AVG);
     pll->phase_avg = (int16_t)(avg_peak & 0xFFFF);
-    pll->phase_peak = (int16_t)((DIAG_PLL_PHASE_PEAK) & 0xFFFF);
+    pll->phase_peak = (int16_t)(BANK(b, DIAG_PLL_PHASE_PEAK) & 0xFFFF);
 
-    pll->freq_word = DIAG_PLL_FREQ_WORD;
-    pll->freq_offset_ppm = (int32_t)DIAG_PLL_FREQ_PPM;
+    pll->freq_word = BANK(b, DIAG_PLL_FREQ_WORD);
+    pll->freq_offset_ppm = (int32_t)BANK(b, DIAG_PLL_FREQ_PPM);
 
-    pll->lock_time = DIAG_PLL_LOCK_TIME;
-    pll->total_lock_time = DIAG_PLL_TOTAL_LOCK;
-    pll->unlock_count = DIAG_PLL_UNLOCK_CNT;
+    pll->lock_time = BANK(b, DIAG_PLL_LOCK_TIME);
+    pll->total_lock_time = BANK(b, DIAG_PLL_TOTAL_LOCK);
+    pll->unlock_count = BANK(b, DIAG_PLL_UNLOCK_CNT);
 
-    uint32_t quality = DIAG_PLL_QUALITY;
+    uint32_t quality = BANK(b, DIAG_PLL_QUALITY);
     pll->quality_min = (uint8_t)(quality & 0xFF);
     pll->quality_max = (uint8_t)((quality >> 8) & 0xFF);
     pll->quality_avg = (uint8_t)((quality >> 16) & 0xFF);
 
     /* Read histogram (packed 2 per register) */
-    uint32_t hist01 = DIAG_PLL_HIST_01;
-    uint32_t hist23 = DIAG_PLL_HIST_23;
-    uint32_t hist45 = DIAG_PLL_HIST_45;
-    uint32_t hist67 = DIAG_PLL_HIST_67;
+    uint32_t hist01 = BANK(b, DIAG_PLL_HIST_01);
+    uint32_t hist23 = BANK(b, DIAG_PLL_HIST_23);
+    uint32_t hist45 = BANK(b, DIAG_PLL_HIST_45);
+    uint32_t hist67 = BANK(b, DIAG_PLL_HIST_67);
 
     pll->histogram[0] = (uint16_t)(hist01 & 0xFFFF);
     pll->histogram[1] = (uint16_t)(hist01 >> 16);
@@ -115,7 +160,13 @@ int diag_read_pll(diag_pll_t *pll)
     pll->histogram[5] = (uint16_t)(hist45 >> 16);
     pll->histogram[6] = (uint16_t)(hist67 & 0xFFFF);
     pll->histogram[7] = (uint16_t)(hist67 >> 16);
+}
 
+int diag_read_pll(diag_pll_t *pll)
+{
+    if (!pll) return DIAG_ERR_INVALID;
+
+    unpack_pll(LIVE, pll);
     return DIAG_OK;
 }
 
@@ -135,28 +186,32 @@ int diag_clear_pll(void)
  * FIFO Statistics Functions
  *============================================================================*/
 
-int diag_read_fifo(diag_fifo_t *fifo)
+static void unpack_fifo(const volatile uint32_t *b, diag_fifo_t *fifo)
 {
-    if (!fifo) return DIAG_ERR_INVALID;
-
-    uint32_t peak = DIAG_FIFO_PEAK;
+    uint32_t peak = BANK(b, DIAG_FIFO_PEAK);
     fifo->peak_level = (uint16_t)(peak & 0xFFFF);
     fifo->min_level = (uint16_t)(peak >> 16);
 
-    fifo->overflow_count = DIAG_FIFO_OVERFLOW;
-    fifo->underrun_count = DIAG_FIFO_UNDERRUN;
-    fifo->backpressure_cnt = DIAG_FIFO_BACKPRESS;
-    fifo->total_writes = DIAG_FIFO_WRITES;
-    fifo->total_reads = DIAG_FIFO_READS;
-    fifo->time_at_peak = DIAG_FIFO_TIME_PEAK;
-    fifo->time_empty = DIAG_FIFO_TIME_EMPTY;
-    fifo->time_full = DIAG_FIFO_TIME_FULL;
+    fifo->overflow_count = BANK(b, DIAG_FIFO_OVERFLOW);
+    fifo->underrun_count = BANK(b, DIAG_FIFO_UNDERRUN);
+    fifo->backpressure_cnt = BANK(b, DIAG_FIFO_BACKPRESS);
+    fifo->total_writes = BANK(b, DIAG_FIFO_WRITES);
+    fifo->total_reads = BANK(b, DIAG_FIFO_READS);
+    fifo->time_at_peak = BANK(b, DIAG_FIFO_TIME_PEAK);
+    fifo->time_empty = BANK(b, DIAG_FIFO_TIME_EMPTY);
+    fifo->time_full = BANK(b, DIAG_FIFO_TIME_FULL);
 
-    uint32_t util = DIAG_FIFO_UTIL;
+    uint32_t util = BANK(b, DIAG_FIFO_UTIL);
     fifo->utilization_pct = (uint8_t)(util & 0xFF);
     fifo->overflow_flag = (util >> 8) & 0x01;
     fifo->underrun_flag = (util >> 9) & 0x01;
+}
+
+int diag_read_fifo(diag_fifo_t *fifo)
+{
+    if (!fifo) return DIAG_ERR_INVALID;
 
+    unpack_fifo(LIVE, fifo);
     return DIAG_OK;
 }
 
@@ -170,21 +225,25 @@ int diag_clear_fifo(void)
  * Capture Timing Functions
  *============================================================================*/
 
+static void unpack_capture(const volatile uint32_t *b, diag_capture_t *capture)
+{
+    capture->duration = BANK(b, DIAG_CAP_DURATION);
+    capture->time_to_first_flux = BANK(b, DIAG_CAP_FIRST_FLUX);
+    capture->time_to_first_idx = BANK(b, DIAG_CAP_FIRST_IDX);
+    capture->index_period_last = BANK(b, DIAG_CAP_IDX_PERIOD);
+    capture->index_period_min = BANK(b, DIAG_CAP_IDX_MIN);
+    capture->index_period_max = BANK(b, DIAG_CAP_IDX_MAX);
+    capture->index_period_avg = BANK(b, DIAG_CAP_IDX_AVG);
+    capture->flux_interval_min = BANK(b, DIAG_CAP_FLUX_MIN);
+    capture->flux_interval_max = BANK(b, DIAG_CAP_FLUX_MAX);
+    capture->flux_count = (uint16_t)(BANK(b, DIAG_CAP_FLUX_CNT) & 0xFFFF);
+}
+
 int diag_read_capture(diag_capture_t *capture)
 {
     if (!capture) return DIAG_ERR_INVALID;
 
-    capture->duration = DIAG_CAP_DURATION;
-    capture->time_to_first_flux = DIAG_CAP_FIRST_FLUX;
-    capture->time_to_first_idx = DIAG_CAP_FIRST_IDX;
-    capture->index_period_last = DIAG_CAP_IDX_PERIOD;
-    capture->index_period_min = DIAG_CAP_IDX_MIN;
-    capture->index_period_max = DIAG_CAP_IDX_MAX;
-    capture->index_period_avg = DIAG_CAP_IDX_AVG;
-    capture->flux_interval_min = DIAG_CAP_FLUX_MIN;
-    capture->flux_interval_max = DIAG_CAP_FLUX_MAX;
-    capture->flux_count = (uint16_t)(DIAG_CAP_FLUX_CNT & 0xFFFF);
-
+    unpack_capture(LIVE, capture);
     return DIAG_OK;
 }
 
@@ -198,26 +257,24 @@ int diag_clear_capture(void)
  * Seek Histogram Functions
  *============================================================================*/
 
-int diag_read_seek(diag_seek_t *seek)
+static void unpack_seek(const volatile uint32_t *b, diag_seek_t *seek)
 {
-    if (!seek) return DIAG_ERR_INVALID;
-
     /* Read histogram counts */
     for (int i = 0; i < 8; i++) {
-        uint32_t val = DIAG_SEEK_HIST(i);
+        uint32_t val = BANK(b, DIAG_SEEK_HIST(i));
         seek->count[i] = (uint16_t)(val & 0xFFFF);
     }
 
     /* Read average times per bucket */
     for (int i = 0; i < 8; i++) {
-        uint32_t val = DIAG_SEEK_TIME(i);
+        uint32_t val = BANK(b, DIAG_SEEK_TIME(i));
         seek->time_us[i] = (uint16_t)(val & 0xFFFF);
     }
 
-    seek->total_seeks = DIAG_SEEK_TOTAL;
-    seek->total_errors = DIAG_SEEK_ERRORS;
+    seek->total_seeks = BANK(b, DIAG_SEEK_TOTAL);
+    seek->total_errors = BANK(b, DIAG_SEEK_ERRORS);
 
-    uint32_t avg = DIAG_SEEK_AVG_TIME;
+    uint32_t avg = BANK(b, DIAG_SEEK_AVG_TIME);
     seek->avg_time_us = (uint16_t)(avg & 0xFFFF);
     seek->min_time_us = (uint16_t)((avg >> 16) & 0xFFFF);
 
@@ -226,7 +283,13 @@ int diag_read_seek(diag_seek_t *seek)
     seek->errors_short = 0;
     seek->errors_medium = 0;
     seek->errors_long = 0;
+}
+
+int diag_read_seek(diag_seek_t *seek)
+{
+    if (!seek) return DIAG_ERR_INVALID;
 
+    unpack_seek(LIVE, seek);
     return DIAG_OK;
 }
 
@@ -244,24 +307,35 @@ int diag_read_all(diag_snapshot_t *snapshot)
 {
     if (!snapshot) return DIAG_ERR_INVALID;
 
-    int ret;
+    diag_latch();
 
-    ret = diag_read_errors(&snapshot->errors);
-    if (ret != DIAG_OK) return ret;
+    unpack_errors(snap_words, &snapshot->errors);
+    unpack_pll(snap_words, &snapshot->pll);
+    unpack_fifo(snap_words, &snapshot->fifo);
+    unpack_capture(snap_words, &snapshot->capture);
+    unpack_seek(snap_words, &snapshot->seek);
 
-    ret = diag_read_pll(&snapshot->pll);
-    if (ret != DIAG_OK) return ret;
+    return DIAG_OK;
+}
+
+int diag_read_delta(uint32_t *gen, diag_delta_t *out)
+{
+    if (!gen || !out) return DIAG_ERR_INVALID;
 
-    ret = diag_read_fifo(&snapshot->fifo);
-    if (ret != DIAG_OK) return ret;
+    uint32_t since = *gen;
+    int n = 0;
 
-    ret = diag_read_capture(&snapshot->capture);
-    if (ret != DIAG_OK) return ret;
+    *gen = diag_latch();
 
-    ret = diag_read_seek(&snapshot->seek);
-    if (ret != DIAG_OK) return ret;
+    for (int i = 0; i < DIAG_SNAP_WORDS; i++) {
+        if (since == 0 || (int32_t)(snap_changed[i] - since) > 0) {
+            out[n].offset = (uint16_t)(i * 4);
+            out[n].value = snap_words[i];
+            n++;
+        }
+    }
 
-    return DIAG_OK;
+    return n;
 }
 
 int diag_clear_all(void)
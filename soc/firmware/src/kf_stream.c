@@ -0,0 +1,179 @@
+/*-----------------------------------------------------------------------------
+ * kf_stream.c
+ * KryoFlux Stream Encoding
+ *
+ * Created: 2025-12-09 14:10
+ *
+ * Stream layout produced here:
+ *   KF_INFO (clock rates)
+ *   per chunk: STREAM_INFO, then flux cells with an INDEX block at each
+ *              index mark (position = the cell the index fell in, sample
+ *              counter = ticks into that cell)
+ *   STREAM_END, EOF
+ *---------------------------------------------------------------------------*/
+
+#include "kf_stream.h"
+#include "raw_protocol.h"
+#include <string.h>
+
+/* Clock rates as reported by the KryoFlux hardware */
+static const char kf_info_text[] =
+    "name=KryoFlux DiskSystem, version=3.00s, "
+    "sck=24027428.5714285, ick=3003428.5714285625";
+
+/*---------------------------------------------------------------------------
+ * Private Functions
+ *---------------------------------------------------------------------------*/
+
+/*
+ * x / 21875 for any 32-bit x without a divide: 0xBFBD572D = ceil(2^46 /
+ * 21875), exact over the full range.
+ */
+static inline uint32_t div21875(uint32_t x)
+{
+    return (uint32_t)(((uint64_t)x * 0xBFBD572Du) >> 46);
+}
+
+static inline uint8_t *put_le32(uint8_t *p, uint32_t v)
+{
+    *p++ = (uint8_t)v;
+    *p++ = (uint8_t)(v >> 8);
+    *p++ = (uint8_t)(v >> 16);
+    *p++ = (uint8_t)(v >> 24);
+    return p;
+}
+
+static inline uint8_t *put_oob(uint8_t *p, uint8_t type, uint16_t size)
+{
+    *p++ = KF_OOB;
+    *p++ = type;
+    *p++ = (uint8_t)size;
+    *p++ = (uint8_t)(size >> 8);
+    return p;
+}
+
+/* FDC clocks -> sck ticks, carrying the remainder */
+static inline uint32_t to_ticks(kf_stream_t *s, uint32_t clocks)
+{
+    uint32_t t;
+
+    /* Deltas under 2^20 clocks (5 ms) keep the product in 32 bits */
+    if (clocks < (1u << 20)) {
+        uint32_t acc = clocks * KF_TICK_MUL + s->rem;
+        t = div21875(acc);
+        s->rem = acc - t * KF_CLK_DIV;
+    } else {
+        uint64_t acc = (uint64_t)clocks * KF_TICK_MUL + s->rem;
+        t = (uint32_t)(acc / KF_CLK_DIV);
+        s->rem = (uint32_t)(acc - (uint64_t)t * KF_CLK_DIV);
+    }
+    return t;
+}
+
+/* One flux cell of v ticks (v > 0) */
+static inline uint8_t *put_cell(uint8_t *p, uint32_t v)
+{
+    while (v >= 0x10000) {
+        *p++ = KF_OVL16;
+        v -= 0x10000;
+    }
+
+    if (v >= KF_FLUX1_MIN && v <= 0xFF) {
+        *p++ = (uint8_t)v;
+    } else if (v <= ((KF_FLUX2_MAX << 8) | 0xFF)) {
+        *p++ = (uint8_t)(v >> 8);
+        *p++ = (uint8_t)v;
+    } else {
+        *p++ = KF_FLUX3;
+        *p++ = (uint8_t)(v >> 8);
+        *p++ = (uint8_t)v;
+    }
+    return p;
+}
+
+/*---------------------------------------------------------------------------
+ * Public Functions
+ *---------------------------------------------------------------------------*/
+
+void kf_stream_init(kf_stream_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+uint32_t kf_stream_begin(kf_stream_t *s, uint8_t *dst)
+{
+    uint8_t *p;
+
+    (void)s;
+    p = put_oob(dst, KF_OOB_KF_INFO, sizeof(kf_info_text));
+    memcpy(p, kf_info_text, sizeof(kf_info_text));
+    return (uint32_t)(p + sizeof(kf_info_text) - dst);
+}
+
+uint32_t kf_stream_info(kf_stream_t *s, uint8_t *dst, uint32_t transfer_ms)
+{
+    uint8_t *p = put_oob(dst, KF_OOB_STREAM_INFO, 8);
+
+    p = put_le32(p, s->position);
+    p = put_le32(p, transfer_ms);
+    return (uint32_t)(p - dst);
+}
+
+uint32_t kf_stream_encode(kf_stream_t *s, const uint32_t *words, uint32_t n,
+                          uint8_t *dst, uint32_t cap, uint32_t *consumed)
+{
+    uint8_t *p = dst;
+    uint8_t *end = dst + cap;
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        uint32_t word = words[i];
+        uint32_t ts = FLUX_TIMESTAMP(word);
+        uint32_t delta = s->started ? (ts - s->prev_ts) & FLUX_TIMESTAMP_MASK : 0;
+
+        /* Worst case for this word, checked before any state changes */
+        if ((uint32_t)(end - p) < KF_MAX_BLOCK + (s->since_flux >> 16) + (delta >> 18)) {
+            break;
+        }
+
+        uint32_t t = to_ticks(s, delta);
+        s->started = true;
+        s->prev_ts = ts;
+        s->since_flux += t;
+        s->ticks += t;
+
+        if (FLUX_IS_INDEX(word)) {
+            /* The index fell since_flux ticks into the next cell */
+            p = put_oob(p, KF_OOB_INDEX, 12);
+            p = put_le32(p, s->position);
+            p = put_le32(p, s->since_flux);
+            p = put_le32(p, s->ticks >> 3);
+            s->index_count++;
+        } else if (!FLUX_IS_OVERFLOW(word) && s->since_flux != 0) {
+            uint8_t *cell = p;
+            p = put_cell(p, s->since_flux);
+            s->position += (uint32_t)(p - cell);
+            s->since_flux = 0;
+        }
+    }
+
+    if (consumed) {
+        *consumed = i;
+    }
+    return (uint32_t)(p - dst);
+}
+
+uint32_t kf_stream_end(kf_stream_t *s, uint8_t *dst, uint32_t result)
+{
+    uint8_t *p;
+
+    if (result == KF_RESULT_OK && s->index_count == 0) {
+        result = KF_RESULT_NO_INDEX;
+    }
+
+    p = put_oob(dst, KF_OOB_STREAM_END, 8);
+    p = put_le32(p, s->position);
+    p = put_le32(p, result);
+    p = put_oob(p, KF_OOB_EOF, 0x0D0D);
+    return (uint32_t)(p - dst);
+}
@@ -6,8 +6,9 @@
  * - UART CLI interface
  * - Timer peripheral
  * - Memory test capability
+ * - Cooperative tasks: raw streaming, MSC, diagnostics sampling, CLI
  *
- * Updated: 2025-12-03 18:00
+ * Updated: 2025-12-08 14:00
  */
 
 #include "platform.h"
@@ -15,6 +16,29 @@
 #include "timer.h"
 #include "cli.h"
 #include "msc_config.h"
+#include "fluxripper_hal.h"
+#include "hdd_hal.h"
+#include "hdd_metadata.h"
+#include "task.h"
+#include "raw_mode.h"
+#include "gw_mode.h"
+#include "hfe_server.h"
+#include "msc_hal.h"
+#include "scsi_handler.h"
+#include "instrumentation_hal.h"
+#include "usb_logger_hal.h"
+#include "prof_cli.h"
+#include "hdd_cli.h"
+#include "power_cli.h"
+#include "power_hal.h"
+#include "fluxstat_cli.h"
+#include "instrumentation_cli.h"
+
+/* Diagnostics sampling interval */
+#define DIAG_SAMPLE_US      100000
+
+/* INTC inputs serviced by external_interrupt_handler() */
+#define IRQ_ENABLED_MASK    (BIT(IRQ_UART) | BIT(IRQ_HDD) | BIT(IRQ_MSC_MEDIA))
 
 /*============================================================================
  * Early Initialization
@@ -37,6 +61,67 @@ void _fini(void)
 {
 }
 
+/*============================================================================
+ * Tasks
+ *============================================================================*/
+
+/**
+ * MSC background work: SCSI transfer ring, then write-back/read-ahead,
+ * then stopping FDD motors that have idled out
+ */
+static void msc_task(void)
+{
+    scsi_xfer_poll();
+    msc_hal_poll();
+    hal_motor_poll();
+}
+
+/**
+ * HDD request queues: overlapped seeks and elevator-ordered transfers,
+ * then background work on idle drives (discovery scans, metadata write-back)
+ */
+static void hdd_task(void)
+{
+    hdd_sched_poll();
+    hdd_discover_poll();
+    meta_writeback_poll();
+}
+
+/**
+ * Background sampling: one PMU rail per run, and the PLL statistics
+ * latched every DIAG_SAMPLE_US so 'diag pll' reads a recent snapshot
+ */
+static void diag_sample_task(void)
+{
+    static uint32_t runs;
+
+    pmu_sample_poll();
+
+    if (++runs >= DIAG_SAMPLE_US / PMU_SAMPLE_STEP_US) {
+        runs = 0;
+        diag_snapshot_pll();
+    }
+}
+
+/*============================================================================
+ * Interrupt Setup
+ *============================================================================*/
+
+/**
+ * Enable the INTC inputs in IRQ_ENABLED_MASK and take interrupts
+ * Inputs not yet wired to the INTC simply never pend; their drivers'
+ * waits fall back to polling (event_wait, EVENT_POLL_US).
+ */
+static void irq_init(void)
+{
+    INTC_IER = 0;
+    INTC_IAR = 0xFFFFFFFF;
+    INTC_IER = IRQ_ENABLED_MASK;
+    INTC_MER = INTC_MER_ME | INTC_MER_HIE;
+
+    irq_enable();
+}
+
 /*============================================================================
  * Main
  *============================================================================*/
@@ -47,54 +132,84 @@ int main(void)
     uart_init();
     timer_init();
 
-    /* Initialize CLI */
+    /* Initialize CLI (commands are linked in) and the HALs behind it */
     cli_init();
+    prof_cli_init();
+    hdd_cli_init();
+    power_cli_init();
+    fluxstat_cli_init();
+    instrumentation_cli_init();
+    gw_mode_init();
+
+    /*
+     * Drive tasks first so host traffic is serviced ahead of the console.
+     * USB bulk endpoint servicing registers here once the transport is in.
+     */
+    task_register("raw", raw_mode_stream_poll, 0, TASK_DRIVES);
+    task_register("gw", gw_mode_stream_poll, 0, TASK_DRIVES);
+    task_register("hfe", hfe_server_poll, 0, TASK_DRIVES);
+    task_register("msc", msc_task, 0, TASK_DRIVES);
+    task_register("hdd", hdd_task, 0, TASK_DRIVES);
+    task_register("diag", diag_sample_task, PMU_SAMPLE_STEP_US, 0);
+    task_register("usblog", usblog_stream_poll, 1000, 0);
+    task_register("cli", cli_poll, 0, 0);
 
-    /* Run CLI loop (never returns) */
-    cli_run();
+    /* HALs are initialized: handlers may now run */
+    irq_init();
+
+    /* Run scheduler (never returns) */
+    cli_start();
+    task_run();
 
     /* Should never reach here */
     return 0;
 }
 
 /*============================================================================
- * Interrupt Handlers (stubs for M0)
+ * Interrupt Handlers
  *============================================================================*/
 
+/*
+ * Both handlers are plain functions called from _trap_vector (crt0.S),
+ * which saves the caller-saved registers and returns with mret.
+ */
+
 /**
- * Default trap handler
+ * Exception handler: report and halt
  */
-void trap_handler(void) __attribute__((interrupt));
 void trap_handler(void)
 {
     uart_puts("\n*** TRAP ***\n");
+    uart_flush();
     while (1)
         ;
 }
 
 /**
  * External interrupt handler
- * Dispatches to appropriate handler based on interrupt source
+ * Dispatches on the AXI INTC pending bits
  */
-void external_interrupt_handler(void) __attribute__((interrupt));
 void external_interrupt_handler(void)
 {
-    /* Read interrupt controller status to determine source */
-    /* For now, assume MSC media change is the only enabled interrupt */
-    /* In M1+, will read INTC_ISR to determine source */
+    uint32_t pending = INTC_IPR;
 
-    uint32_t int_ctrl = msc_config_read_int_ctrl();
-    uint32_t pending = (int_ctrl >> 4) & 0x0F;
-    uint32_t enabled = int_ctrl & 0x0F;
+    /* Inputs are edge-triggered: acknowledge first so a new edge re-pends */
+    INTC_IAR = pending;
 
-    /* Check if MSC media change interrupt is active */
-    if (pending & enabled) {
+    if (pending & BIT(IRQ_MSC_MEDIA)) {
         msc_config_irq_handler();
     }
 
+    if (pending & BIT(IRQ_UART)) {
+        uart_irq_handler();
+    }
+
+    if (pending & BIT(IRQ_HDD)) {
+        hdd_irq_handler();
+    }
+
     /* Additional interrupt sources will be added in M1+:
      * - IRQ_FDC_A, IRQ_FDC_B: FDC completion
      * - IRQ_DMA_A, IRQ_DMA_B: DMA completion
-     * - IRQ_HDD: HDD controller
      */
 }
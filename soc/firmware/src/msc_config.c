@@ -8,6 +8,7 @@
  *---------------------------------------------------------------------------*/
 
 #include "msc_config.h"
+#include "platform.h"
 #include <stddef.h>
 
 /*---------------------------------------------------------------------------
@@ -15,7 +16,7 @@
  *---------------------------------------------------------------------------*/
 
 #define MSC_REG(offset) \
-    (*(volatile uint32_t *)(MSC_CONFIG_BASE + (offset)))
+    REG32(MSC_CONFIG_BASE + (offset))
 
 #define MSC_REG_WRITE(offset, value) \
     do { MSC_REG(offset) = (value); } while(0)
@@ -14,6 +14,11 @@
 #include "fluxripper_hal.h"
 #include "hdd_hal.h"
 #include "hdd_metadata.h"
+#include "spinup.h"
+#include "scsi_handler.h"
+#include "platform.h"
+#include "timer.h"
+#include "prof.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -29,10 +34,95 @@ static uint32_t lun_write_count[MSC_MAX_LUNS];
 static uint32_t lun_error_count[MSC_MAX_LUNS];
 static int      lun_last_error[MSC_MAX_LUNS];
 
+/*
+ * LUN state words: what TEST UNIT READY and the data paths check, read
+ * without touching the drives. Presence and write protection are sampled
+ * whenever a LUN is (re)configured. The media-change interrupt clears
+ * READY and marks the LUN for a rescan, which msc_hal_poll() runs from
+ * task context; empty LUNs and HDDs are re-probed every MSC_PROBE_MS.
+ * The same probe checks ready floppies for a disk change, so a swap is
+ * seen even where the interrupt line does not reach the INTC.
+ */
+static volatile uint32_t lun_state[MSC_MAX_LUNS];
+static uint32_t lun_probe_ms;
+
+/*
+ * Track cache: whole track sides in HyperRAM, keyed by (LUN, cylinder,
+ * head). A miss reads the full track in one pass, so the small, repeated
+ * FAT and directory reads hosts issue then cost a memcpy. Bumping a LUN's
+ * generation drops all its tracks at once, which is safe from the
+ * media-change interrupt.
+ *
+ * Writes land in the cached track and are held as a dirty sector mask;
+ * each track goes to the media in one write pass on eviction, on an
+ * explicit flush, or once it has been dirty for WB_FLUSH_MS. A track
+ * that fails to write back is dropped and the error is reported by the
+ * next msc_hal_flush().
+ */
+#define TCACHE_SLOTS        32
+#define TCACHE_SLOT_SIZE    (SECTOR_CACHE_SIZE / TCACHE_SLOTS)  /* 64KB */
+#define TCACHE_SLOT(i)      ((uint8_t *)(SECTOR_CACHE_BASE + (uint32_t)(i) * TCACHE_SLOT_SIZE))
+
+#define WB_MAX_SPT          64          /* Width of the dirty mask */
+#define WB_FLUSH_MS         1000        /* Longest a write stays unwritten */
+
+typedef struct {
+    bool        valid;
+    uint8_t     lun;
+    uint8_t     head;
+    uint16_t    cylinder;
+    uint32_t    gen;            /* LUN generation when filled */
+    uint32_t    last_use;       /* LRU stamp */
+    uint64_t    dirty;          /* Sectors not yet on the media */
+    uint32_t    dirty_ms;       /* When the first of them was written */
+} tcache_entry_t;
+
+static tcache_entry_t tcache[TCACHE_SLOTS];
+static volatile uint32_t tcache_gen[MSC_MAX_LUNS];
+static uint32_t tcache_clock;
+static uint32_t tcache_hits;
+static uint32_t tcache_misses;
+static bool     wb_failed[MSC_MAX_LUNS];
+
+/*
+ * Read-ahead: one window of track sides on one LUN, filled a track at a
+ * time from msc_hal_poll() while the host drains the previous transfer.
+ * On FDD the seek to the window's cylinder is issued when it is queued.
+ */
+#define RA_MAX_TRACKS       8
+
+static struct {
+    bool        active;
+    bool        seeking;        /* Background FDD seek outstanding */
+    uint8_t     lun;
+    uint8_t     seek_drive;
+    uint32_t    track;          /* Next track side to fill */
+    uint32_t    last;           /* Last track side of the window */
+} ra;
+
 /*---------------------------------------------------------------------------
  * Private Functions
  *---------------------------------------------------------------------------*/
 
+/**
+ * Update bits of a LUN state word (also modified from the media-change ISR)
+ */
+static void lun_state_update(uint8_t lun, uint32_t clear, uint32_t set)
+{
+    uint32_t mstatus = irq_save();
+    lun_state[lun] = (lun_state[lun] & ~clear) | set;
+    irq_restore(mstatus);
+}
+
+/**
+ * Report a change the host must re-read the LUN for
+ */
+static void lun_changed(uint8_t lun)
+{
+    lun_state_update(lun, 0, MSC_STATE_CHANGED);
+    scsi_set_unit_attention(lun, ASC_NOT_READY_TO_READY, ASCQ_NO_ADDITIONAL_INFO);
+}
+
 /**
  * Map LUN to physical drive type and index
  */
@@ -50,38 +140,385 @@ static void lun_to_drive(uint8_t lun, uint8_t *type, uint8_t *index)
     }
 }
 
+/*---------------------------------------------------------------------------
+ * Track Cache
+ *---------------------------------------------------------------------------*/
+
 /**
- * Calculate FDD sector count from drive profile
- *
- * Common FDD geometries:
- *   360KB 5.25" DD:  40 tracks * 2 heads * 9 sectors  =  720 sectors
- *   720KB 3.5" DD:   80 tracks * 2 heads * 9 sectors  = 1440 sectors
- *   1.2MB 5.25" HD:  80 tracks * 2 heads * 15 sectors = 2400 sectors
- *   1.44MB 3.5" HD:  80 tracks * 2 heads * 18 sectors = 2880 sectors
- *   2.88MB 3.5" ED:  80 tracks * 2 heads * 36 sectors = 5760 sectors
+ * Route a sector read to the drive HAL
  */
-static uint32_t calculate_fdd_capacity(const drive_profile_t *profile)
+static int lun_read(const msc_lun_config_t *cfg, uint32_t lba, void *buf, uint32_t count)
 {
-    uint8_t cylinders;
-    uint8_t heads = 2;  /* Assume double-sided */
-    uint8_t spt;        /* Sectors per track */
+    if (cfg->lun_type == MSC_LUN_TYPE_FDD) {
+        return hal_read_sectors(cfg->drive_index, lba, buf, count);
+    }
+    return hdd_sched_read_lba(cfg->drive_index, lba, count, buf);
+}
 
-    /* Get cylinder count from track density */
-    switch (profile->tracks) {
-        case TRACKS_40:
-            cylinders = 40;
-            break;
-        case TRACKS_80:
-            cylinders = 80;
-            break;
-        case TRACKS_77:
-            cylinders = 77;  /* 8" floppies */
-            break;
-        default:
-            cylinders = 80;  /* Default to 80 track */
-            break;
+/**
+ * Route a sector write to the drive HAL
+ */
+static int lun_write(const msc_lun_config_t *cfg, uint32_t lba, const void *buf, uint32_t count)
+{
+    if (cfg->lun_type == MSC_LUN_TYPE_FDD) {
+        return hal_write_sectors(cfg->drive_index, lba, buf, count);
+    }
+    return hal_hdd_write_sectors(cfg->drive_index, lba, buf, count);
+}
+
+/**
+ * Check whether reads on a LUN can go through the track cache
+ */
+static bool tcache_usable(const msc_lun_config_t *cfg)
+{
+    return cfg->heads != 0 && cfg->sectors_per_track != 0 &&
+           cfg->block_size == MSC_SECTOR_SIZE &&
+           (uint32_t)cfg->sectors_per_track * MSC_SECTOR_SIZE <= TCACHE_SLOT_SIZE;
+}
+
+static int tcache_lookup(uint8_t lun, uint16_t cylinder, uint8_t head)
+{
+    for (int i = 0; i < TCACHE_SLOTS; i++) {
+        const tcache_entry_t *e = &tcache[i];
+        if (e->valid && e->lun == lun && e->cylinder == cylinder &&
+            e->head == head && e->gen == tcache_gen[lun]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Pick a slot to refill: a free or stale one, else the least recently
+ * used clean one, else the least recently used dirty one
+ */
+static int tcache_victim(void)
+{
+    int clean = -1;
+    int dirty = -1;
+
+    for (int i = 0; i < TCACHE_SLOTS; i++) {
+        const tcache_entry_t *e = &tcache[i];
+        if (!e->valid || e->gen != tcache_gen[e->lun]) {
+            return i;
+        }
+
+        int *best = e->dirty ? &dirty : &clean;
+        if (*best < 0 || e->last_use < tcache[*best].last_use) {
+            *best = i;
+        }
+    }
+    return clean >= 0 ? clean : dirty;
+}
+
+static uint32_t tcache_track(const tcache_entry_t *e)
+{
+    return (uint32_t)e->cylinder * msc_state.luns[e->lun].heads + e->head;
+}
+
+/**
+ * Write a slot's dirty sectors back in one pass
+ * The span from the first to the last dirty sector goes out as a single
+ * write; clean sectors inside it are rewritten with their cached data.
+ */
+static int tcache_flush_slot(int slot)
+{
+    tcache_entry_t *e = &tcache[slot];
+
+    if (e->dirty == 0) {
+        return HAL_OK;
+    }
+
+    /* Tracks of removed media are discarded, not written */
+    if (!e->valid || e->gen != tcache_gen[e->lun]) {
+        e->dirty = 0;
+        return HAL_OK;
+    }
+
+    const msc_lun_config_t *cfg = &msc_state.luns[e->lun];
+    uint32_t first = 0;
+    uint32_t last = 0;
+
+    while (!(e->dirty & (1ULL << first))) {
+        first++;
+    }
+    for (uint32_t i = first; i < cfg->sectors_per_track; i++) {
+        if (e->dirty & (1ULL << i)) {
+            last = i;
+        }
+    }
+
+    uint32_t lba = tcache_track(e) * cfg->sectors_per_track + first;
+    int ret = lun_write(cfg, lba, TCACHE_SLOT(slot) + first * MSC_SECTOR_SIZE,
+                        last - first + 1);
+
+    e->dirty = 0;
+    if (ret != HAL_OK) {
+        e->valid = false;
+        wb_failed[e->lun] = true;
+        lun_error_count[e->lun]++;
+        lun_last_error[e->lun] = MSC_ERR_WRITE;
+    }
+    return ret;
+}
+
+/**
+ * Take a slot for a new track, writing back what it holds first
+ */
+static int tcache_claim(void)
+{
+    int slot = tcache_victim();
+
+    tcache_flush_slot(slot);
+    tcache[slot].valid = false;
+    tcache[slot].dirty = 0;
+    return slot;
+}
+
+static void tcache_bind(int slot, uint8_t lun, uint32_t track, uint32_t gen)
+{
+    const msc_lun_config_t *cfg = &msc_state.luns[lun];
+
+    tcache[slot].lun = lun;
+    tcache[slot].cylinder = track / cfg->heads;
+    tcache[slot].head = track % cfg->heads;
+    tcache[slot].gen = gen;
+    tcache[slot].last_use = ++tcache_clock;
+    tcache[slot].valid = true;
+}
+
+static void tcache_invalidate_lun(uint8_t lun)
+{
+    tcache_gen[lun]++;
+}
+
+/**
+ * Drop cached tracks overlapping a sector range
+ */
+static void tcache_invalidate_range(uint8_t lun, uint32_t lba, uint32_t count)
+{
+    const msc_lun_config_t *cfg = &msc_state.luns[lun];
+
+    if (!tcache_usable(cfg)) {
+        return;
+    }
+
+    uint32_t first = lba / cfg->sectors_per_track;
+    uint32_t last = (lba + count - 1) / cfg->sectors_per_track;
+
+    for (int i = 0; i < TCACHE_SLOTS; i++) {
+        tcache_entry_t *e = &tcache[i];
+        uint32_t track = (uint32_t)e->cylinder * cfg->heads + e->head;
+        if (e->valid && e->lun == lun && track >= first && track <= last) {
+            e->valid = false;
+        }
+    }
+}
+
+/**
+ * Write back dirty cached tracks overlapping a sector range
+ * @return HAL_OK, or the first write-back error
+ */
+static int tcache_flush_range(uint8_t lun, uint32_t lba, uint32_t count)
+{
+    const msc_lun_config_t *cfg = &msc_state.luns[lun];
+    int ret = HAL_OK;
+
+    if (!tcache_usable(cfg)) {
+        return HAL_OK;
+    }
+
+    uint32_t first = lba / cfg->sectors_per_track;
+    uint32_t last = (lba + count - 1) / cfg->sectors_per_track;
+
+    for (int i = 0; i < TCACHE_SLOTS; i++) {
+        const tcache_entry_t *e = &tcache[i];
+        if (e->dirty != 0 && e->lun == lun &&
+            tcache_track(e) >= first && tcache_track(e) <= last) {
+            int r = tcache_flush_slot(i);
+            if (r != HAL_OK && ret == HAL_OK) {
+                ret = r;
+            }
+        }
+    }
+    return ret;
+}
+
+/**
+ * Read a whole track side into a cache slot
+ * @return Slot index, or -1 if the track could not be read
+ */
+static int tcache_fill(uint8_t lun, uint32_t track)
+{
+    const msc_lun_config_t *cfg = &msc_state.luns[lun];
+    uint32_t spt = cfg->sectors_per_track;
+    uint32_t gen = tcache_gen[lun];
+    int slot = tcache_claim();
+
+    if (lun_read(cfg, track * spt, TCACHE_SLOT(slot), spt) != HAL_OK) {
+        return -1;
+    }
+
+    tcache_bind(slot, lun, track, gen);
+    return slot;
+}
+
+/**
+ * Read through the track cache
+ */
+static int tcache_read(uint8_t lun, uint32_t lba, uint8_t *dst, uint32_t count)
+{
+    const msc_lun_config_t *cfg = &msc_state.luns[lun];
+    uint32_t spt = cfg->sectors_per_track;
+
+    while (count > 0) {
+        uint32_t track = lba / spt;
+        uint16_t cylinder = track / cfg->heads;
+        uint8_t head = track % cfg->heads;
+        uint32_t offset = lba - track * spt;
+        uint32_t n = spt - offset;
+        int ret;
+
+        if (n > count) {
+            n = count;
+        }
+
+        int slot = tcache_lookup(lun, cylinder, head);
+
+        if (slot < 0 && (track + 1) * spt <= cfg->capacity) {
+            /* A bad sector elsewhere on the track must not fail this read */
+            slot = tcache_fill(lun, track);
+            tcache_misses++;
+        } else if (slot >= 0) {
+            tcache_hits++;
+        }
+
+        if (slot >= 0) {
+            memcpy(dst, TCACHE_SLOT(slot) + offset * MSC_SECTOR_SIZE, n * MSC_SECTOR_SIZE);
+            tcache[slot].last_use = ++tcache_clock;
+        } else {
+            ret = lun_read(cfg, lba, dst, n);
+            if (ret != HAL_OK) {
+                return ret;
+            }
+        }
+
+        lba += n;
+        count -= n;
+        dst += n * MSC_SECTOR_SIZE;
     }
 
+    return HAL_OK;
+}
+
+/**
+ * Check whether writes on a LUN can be held in the track cache
+ */
+static bool wb_usable(const msc_lun_config_t *cfg)
+{
+    return tcache_usable(cfg) && cfg->sectors_per_track <= WB_MAX_SPT;
+}
+
+/**
+ * Write into the track cache, leaving the sectors dirty
+ * A partly written track is read in first so the slot stays a complete
+ * copy; a whole-track write skips the read.
+ */
+static int tcache_write(uint8_t lun, uint32_t lba, const uint8_t *src, uint32_t count)
+{
+    const msc_lun_config_t *cfg = &msc_state.luns[lun];
+    uint32_t spt = cfg->sectors_per_track;
+
+    while (count > 0) {
+        uint32_t track = lba / spt;
+        uint32_t offset = lba - track * spt;
+        uint32_t n = spt - offset;
+
+        if (n > count) {
+            n = count;
+        }
+
+        int slot = tcache_lookup(lun, track / cfg->heads, track % cfg->heads);
+
+        if (slot < 0 && (track + 1) * spt <= cfg->capacity) {
+            if (n == spt) {
+                slot = tcache_claim();
+                tcache_bind(slot, lun, track, tcache_gen[lun]);
+            } else {
+                slot = tcache_fill(lun, track);
+            }
+        }
+
+        if (slot >= 0) {
+            uint64_t mask = (n == 64) ? ~0ULL : ((1ULL << n) - 1);
+
+            memcpy(TCACHE_SLOT(slot) + offset * MSC_SECTOR_SIZE, src, n * MSC_SECTOR_SIZE);
+            if (tcache[slot].dirty == 0) {
+                tcache[slot].dirty_ms = timer_get_ms();
+            }
+            tcache[slot].dirty |= mask << offset;
+            tcache[slot].last_use = ++tcache_clock;
+        } else {
+            /* Unreadable or partial track: write this piece through */
+            int ret = lun_write(cfg, lba, src, n);
+            if (ret != HAL_OK) {
+                return ret;
+            }
+        }
+
+        lba += n;
+        count -= n;
+        src += n * MSC_SECTOR_SIZE;
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * Find the dirty slot that should be written back first
+ * @param lun LUN to restrict to, or MSC_MAX_LUNS for any
+ * @param by_age true for the oldest write, false for the lowest track
+ */
+static int wb_next(uint8_t lun, bool by_age)
+{
+    int best = -1;
+
+    for (int i = 0; i < TCACHE_SLOTS; i++) {
+        const tcache_entry_t *e = &tcache[i];
+        if (e->dirty == 0 || (lun < MSC_MAX_LUNS && e->lun != lun)) {
+            continue;
+        }
+        if (best < 0 ||
+            (by_age ? (int32_t)(e->dirty_ms - tcache[best].dirty_ms) < 0
+                    : tcache_track(e) < tcache_track(&tcache[best]))) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * Skip read-ahead tracks that are already cached
+ * @return true if the window still has a track to fill
+ */
+static bool ra_skip_cached(void)
+{
+    const msc_lun_config_t *cfg = &msc_state.luns[ra.lun];
+
+    while (ra.track <= ra.last &&
+           tcache_lookup(ra.lun, ra.track / cfg->heads, ra.track % cfg->heads) >= 0) {
+        ra.track++;
+    }
+    return ra.track <= ra.last;
+}
+
+/**
+ * Sectors per track for the media described by a drive profile
+ */
+static uint8_t fdd_sectors_per_track(const drive_profile_t *profile)
+{
+    uint8_t spt;
+
     /* Determine sectors per track from density and form factor */
     switch (profile->density) {
         case DENS_DD:  /* Double Density */
@@ -116,7 +553,41 @@ static uint32_t calculate_fdd_capacity(const drive_profile_t *profile)
             break;
     }
 
-    return (uint32_t)cylinders * heads * spt;
+    return spt;
+}
+
+/**
+ * Calculate FDD sector count from drive profile
+ *
+ * Common FDD geometries:
+ *   360KB 5.25" DD:  40 tracks * 2 heads * 9 sectors  =  720 sectors
+ *   720KB 3.5" DD:   80 tracks * 2 heads * 9 sectors  = 1440 sectors
+ *   1.2MB 5.25" HD:  80 tracks * 2 heads * 15 sectors = 2400 sectors
+ *   1.44MB 3.5" HD:  80 tracks * 2 heads * 18 sectors = 2880 sectors
+ *   2.88MB 3.5" ED:  80 tracks * 2 heads * 36 sectors = 5760 sectors
+ */
+static uint32_t calculate_fdd_capacity(const drive_profile_t *profile)
+{
+    uint8_t cylinders;
+    uint8_t heads = 2;  /* Assume double-sided */
+
+    /* Get cylinder count from track density */
+    switch (profile->tracks) {
+        case TRACKS_40:
+            cylinders = 40;
+            break;
+        case TRACKS_80:
+            cylinders = 80;
+            break;
+        case TRACKS_77:
+            cylinders = 77;  /* 8" floppies */
+            break;
+        default:
+            cylinders = 80;  /* Default to 80 track */
+            break;
+    }
+
+    return (uint32_t)cylinders * heads * fdd_sectors_per_track(profile);
 }
 
 /**
@@ -187,8 +658,8 @@ static void build_hdd_product_id(uint8_t drive_index, char *vendor, char *produc
 {
     hdd_metadata_t meta;
 
-    /* Try to read secret metadata from drive */
-    if (meta_read(drive_index, &meta) == META_OK &&
+    /* Secret metadata: usually already read at attach, so from the cache */
+    if (meta_read_cached(drive_index, &meta) == META_OK &&
         meta.signature == METADATA_SIGNATURE) {
 
         /* Use vendor from metadata if available */
@@ -235,6 +706,10 @@ static void configure_fdd_lun(uint8_t lun, uint8_t drive_index)
     cfg->drive_index = drive_index;
     cfg->removable = true;
     cfg->block_size = 512;
+    cfg->heads = 2;
+    cfg->sectors_per_track = 18;
+
+    tcache_invalidate_lun(lun);
 
     /* Check if disk is present */
     cfg->present = hal_disk_present(drive_index);
@@ -247,6 +722,7 @@ static void configure_fdd_lun(uint8_t lun, uint8_t drive_index)
         /* Query drive profile for geometry detection */
         if (hal_get_profile(drive_index, &profile) == HAL_OK && profile.valid) {
             cfg->capacity = calculate_fdd_capacity(&profile);
+            cfg->sectors_per_track = fdd_sectors_per_track(&profile);
 
             /* Build dynamic Product ID from detected profile */
             /* Examples: "3.5\" HD 80T MFM", "5.25\" DD 40T MFM" */
@@ -277,23 +753,18 @@ static void configure_fdd_lun(uint8_t lun, uint8_t drive_index)
     strncpy(cfg->revision, "1.00", 4);
     cfg->revision[4] = '\0';
 
-    cfg->changed = false;
+    lun_state_update(lun, MSC_STATE_READY | MSC_STATE_WP,
+                     (cfg->present ? MSC_STATE_READY : 0) |
+                     (cfg->readonly ? MSC_STATE_WP : 0));
 
     /* Update RTL configuration registers with detected geometry */
     if (cfg->present && hal_get_profile(drive_index, &profile) == HAL_OK && profile.valid) {
-        uint8_t spt;
-        switch (profile.density) {
-            case DENS_DD: spt = 9;  break;
-            case DENS_HD: spt = 18; break;
-            case DENS_ED: spt = 36; break;
-            default:      spt = 18; break;
-        }
         msc_config_set_fdd_params(
             (drive_index == 0) ? MSC_DRIVE_FDD0 : MSC_DRIVE_FDD1,
             (uint16_t)cfg->capacity,
             profile.tracks,
-            2,  /* heads */
-            spt
+            cfg->heads,
+            cfg->sectors_per_track
         );
     }
     msc_config_set_ready(
@@ -317,19 +788,32 @@ static void configure_hdd_lun(uint8_t lun, uint8_t drive_index)
     cfg->drive_index = drive_index;
     cfg->removable = false;  /* HDDs are fixed */
     cfg->block_size = 512;
+    cfg->heads = 0;
+    cfg->sectors_per_track = 0;
+
+    tcache_invalidate_lun(lun);
 
     /* Check if drive is present/ready */
-    cfg->present = hal_hdd_is_ready(drive_index);
+    cfg->present = hdd_is_ready(drive_index);
     cfg->readonly = false;  /* HDDs typically not write-protected */
 
-    /* Get capacity from HDD discovery */
+    /*
+     * Get capacity from HDD discovery. An undiscovered drive gets the quick
+     * scan only, so the LUN enumerates in seconds; the full scan runs in
+     * the background and hdd_lun_refresh() picks up its result.
+     */
+    cfg->provisional = false;
     if (cfg->present) {
-        hdd_geometry_t geom;
-        if (hal_hdd_get_geometry(drive_index, &geom) == HAL_OK) {
-            cfg->capacity = geom.total_sectors;
+        hdd_profile_t prof;
+        if ((hdd_get_profile(drive_index, &prof) == HAL_OK && prof.valid) ||
+            hdd_discover_quick(drive_index, &prof) == HAL_OK) {
+            cfg->capacity = prof.geometry.total_sectors;
+            cfg->heads = prof.geometry.heads;
+            cfg->sectors_per_track = prof.geometry.sectors;
         } else {
             cfg->capacity = 0;
         }
+        cfg->provisional = hdd_discover_pending(drive_index);
     } else {
         cfg->capacity = 0;
     }
@@ -343,7 +827,8 @@ static void configure_hdd_lun(uint8_t lun, uint8_t drive_index)
     strncpy(cfg->revision, "1.00", 4);
     cfg->revision[4] = '\0';
 
-    cfg->changed = false;
+    lun_state_update(lun, MSC_STATE_READY | MSC_STATE_WP,
+                     cfg->present ? MSC_STATE_READY : 0);
 
     /* Update RTL configuration registers with detected capacity */
     msc_config_set_hdd_capacity(
@@ -369,6 +854,10 @@ int msc_hal_init(void)
     memset(lun_write_count, 0, sizeof(lun_write_count));
     memset(lun_error_count, 0, sizeof(lun_error_count));
     memset(lun_last_error, 0, sizeof(lun_last_error));
+    for (i = 0; i < MSC_MAX_LUNS; i++) {
+        lun_state[i] = 0;
+    }
+    lun_probe_ms = timer_get_ms();
 
     /* Initialize RTL configuration registers (config_valid=0 initially) */
     msc_config_init();
@@ -378,6 +867,12 @@ int msc_hal_init(void)
         configure_fdd_lun(i, i);
     }
 
+    /*
+     * Bring both spindles up as one batch first, so they start in parallel
+     * when the supply allows instead of one per LUN probe
+     */
+    spinup_wait(SPINUP_MASK(PWR_CONN_HDD0) | SPINUP_MASK(PWR_CONN_HDD1), SPINUP_WAIT_MS);
+
     /* Configure HDD LUNs */
     for (i = 0; i < MSC_MAX_HDDS; i++) {
         configure_hdd_lun(MSC_MAX_FDDS + i, i);
@@ -392,6 +887,10 @@ int msc_hal_init(void)
     /* HDD doesn't have physical disk change, but enable for completeness */
     msc_config_int_enable(MSC_DRIVE_HDD0, false);
     msc_config_int_enable(MSC_DRIVE_HDD1, false);
+    /* Changes latched while the LUNs were being read are already covered */
+    for (i = 0; i < MSC_MAX_LUNS; i++) {
+        msc_config_int_clear((msc_drive_t)i);
+    }
     /* Enable global interrupt */
     msc_config_int_global_enable(true);
 
@@ -420,37 +919,19 @@ int msc_hal_get_lun_config(uint8_t lun, msc_lun_config_t *config)
  * Public Functions - Drive Operations
  *---------------------------------------------------------------------------*/
 
-bool msc_hal_is_ready(uint8_t lun)
+uint32_t msc_hal_get_state(uint8_t lun)
 {
-    if (lun >= MSC_MAX_LUNS) {
-        return false;
-    }
-
-    /* Refresh presence status */
-    msc_lun_config_t *cfg = &msc_state.luns[lun];
-
-    if (cfg->lun_type == MSC_LUN_TYPE_FDD) {
-        cfg->present = hal_disk_present(cfg->drive_index);
-    } else if (cfg->lun_type == MSC_LUN_TYPE_HDD) {
-        cfg->present = hal_hdd_is_ready(cfg->drive_index);
-    }
+    return lun < MSC_MAX_LUNS ? lun_state[lun] : 0;
+}
 
-    return cfg->present;
+bool msc_hal_is_ready(uint8_t lun)
+{
+    return (msc_hal_get_state(lun) & MSC_STATE_READY) != 0;
 }
 
 bool msc_hal_is_write_protected(uint8_t lun)
 {
-    if (lun >= MSC_MAX_LUNS) {
-        return true;
-    }
-
-    msc_lun_config_t *cfg = &msc_state.luns[lun];
-
-    if (cfg->lun_type == MSC_LUN_TYPE_FDD) {
-        cfg->readonly = hal_write_protected(cfg->drive_index);
-    }
-
-    return cfg->readonly;
+    return lun >= MSC_MAX_LUNS || (lun_state[lun] & MSC_STATE_WP) != 0;
 }
 
 bool msc_hal_media_changed(uint8_t lun)
@@ -459,9 +940,11 @@ bool msc_hal_media_changed(uint8_t lun)
         return false;
     }
 
-    msc_lun_config_t *cfg = &msc_state.luns[lun];
-    bool changed = cfg->changed;
-    cfg->changed = false;  /* Clear flag on read */
+    /* Clear flag on read */
+    uint32_t mstatus = irq_save();
+    bool changed = (lun_state[lun] & MSC_STATE_CHANGED) != 0;
+    lun_state[lun] &= ~MSC_STATE_CHANGED;
+    irq_restore(mstatus);
 
     return changed;
 }
@@ -472,15 +955,11 @@ void msc_hal_notify_media_changed(uint8_t lun)
         return;
     }
 
-    msc_lun_config_t *cfg = &msc_state.luns[lun];
-
-    /* Set the changed flag - will be reported on next SCSI TEST_UNIT_READY */
-    cfg->changed = true;
-
-    /* Re-scan drive to update capacity and presence */
-    if (cfg->lun_type == MSC_LUN_TYPE_FDD && lun < MSC_MAX_FDDS) {
-        configure_fdd_lun(lun, cfg->drive_index);
-    }
+    /* Interrupt context: no drive access, msc_hal_poll() re-reads the LUN */
+    tcache_invalidate_lun(lun);
+    lun_state[lun] = (lun_state[lun] & ~MSC_STATE_READY) |
+                     MSC_STATE_CHANGED | MSC_STATE_RESCAN;
+    scsi_set_unit_attention(lun, ASC_NOT_READY_TO_READY, ASCQ_NO_ADDITIONAL_INFO);
 }
 
 int msc_hal_read_sectors(uint8_t lun, uint32_t lba, void *buf, uint32_t count)
@@ -504,15 +983,19 @@ int msc_hal_read_sectors(uint8_t lun, uint32_t lba, void *buf, uint32_t count)
         return MSC_ERR_LBA_RANGE;
     }
 
-    /* Route to appropriate HAL */
-    if (cfg->lun_type == MSC_LUN_TYPE_FDD) {
-        ret = hal_read_sectors(cfg->drive_index, lba, buf, count);
-    } else if (cfg->lun_type == MSC_LUN_TYPE_HDD) {
-        ret = hal_hdd_read_sectors(cfg->drive_index, lba, buf, count);
-    } else {
+    if (cfg->lun_type != MSC_LUN_TYPE_FDD && cfg->lun_type != MSC_LUN_TYPE_HDD) {
         return MSC_ERR_INVALID_LUN;
     }
 
+    /* Route to appropriate HAL, through the track cache when possible */
+    PROF_BEGIN(PROF_MSC_READ);
+    if (tcache_usable(cfg)) {
+        ret = tcache_read(lun, lba, buf, count);
+    } else {
+        ret = lun_read(cfg, lba, buf, count);
+    }
+    PROF_END(PROF_MSC_READ);
+
     if (ret == HAL_OK) {
         lun_read_count[lun] += count;
         lun_last_error[lun] = MSC_OK;
@@ -524,6 +1007,244 @@ int msc_hal_read_sectors(uint8_t lun, uint32_t lba, void *buf, uint32_t count)
     }
 }
 
+int msc_hal_verify_sectors(uint8_t lun, uint32_t lba, uint32_t count, uint32_t *bad_lba)
+{
+    int ret;
+
+    if (lun >= MSC_MAX_LUNS) {
+        return MSC_ERR_INVALID_LUN;
+    }
+
+    msc_lun_config_t *cfg = &msc_state.luns[lun];
+
+    if (!cfg->present) {
+        lun_last_error[lun] = MSC_ERR_NO_MEDIA;
+        return MSC_ERR_NO_MEDIA;
+    }
+
+    if (lba + count > cfg->capacity) {
+        lun_last_error[lun] = MSC_ERR_LBA_RANGE;
+        return MSC_ERR_LBA_RANGE;
+    }
+
+    if (cfg->lun_type != MSC_LUN_TYPE_FDD && cfg->lun_type != MSC_LUN_TYPE_HDD) {
+        return MSC_ERR_INVALID_LUN;
+    }
+
+    if (count == 0) {
+        return MSC_OK;
+    }
+
+    /* The media is what gets checked, so pending writes go out first */
+    if (tcache_flush_range(lun, lba, count) != HAL_OK) {
+        if (bad_lba != NULL) {
+            *bad_lba = lba;
+        }
+        return MSC_ERR_WRITE;
+    }
+
+    /* Straight to the drive: a cached copy says nothing about the media */
+    PROF_BEGIN(PROF_MSC_READ);
+    if (cfg->lun_type == MSC_LUN_TYPE_FDD) {
+        ret = hal_verify_sectors(cfg->drive_index, lba, count, bad_lba);
+    } else {
+        ret = hdd_sched_verify_lba(cfg->drive_index, lba, count, bad_lba);
+    }
+    PROF_END(PROF_MSC_READ);
+
+    if (ret == HAL_OK) {
+        lun_last_error[lun] = MSC_OK;
+        return MSC_OK;
+    }
+    lun_error_count[lun]++;
+    lun_last_error[lun] = MSC_ERR_READ;
+    return MSC_ERR_READ;
+}
+
+void msc_hal_prefetch(uint8_t lun, uint32_t lba)
+{
+    if (lun >= MSC_MAX_LUNS) {
+        return;
+    }
+
+    const msc_lun_config_t *cfg = &msc_state.luns[lun];
+
+    if (!cfg->present || !tcache_usable(cfg)) {
+        return;
+    }
+
+    /* One cylinder's worth of track sides, whole tracks only */
+    uint32_t spt = cfg->sectors_per_track;
+    uint32_t tracks = cfg->capacity / spt;
+    uint32_t depth = cfg->heads < RA_MAX_TRACKS ? cfg->heads : RA_MAX_TRACKS;
+
+    ra.active = false;
+    ra.lun = lun;
+    ra.track = lba / spt;
+    ra.last = ra.track + depth - 1;
+    if (ra.last >= tracks) {
+        ra.last = tracks - 1;
+    }
+
+    if (ra.track >= tracks || !ra_skip_cached()) {
+        return;
+    }
+    ra.active = true;
+
+    /* Start moving the heads now so the step time overlaps the transfer */
+    if (cfg->lun_type == MSC_LUN_TYPE_FDD && !ra.seeking &&
+        hal_get_mode(cfg->drive_index) == MODE_IDLE) {
+        uint8_t cylinder = ra.track / cfg->heads;
+        if (hal_get_track(cfg->drive_index) != cylinder &&
+            hal_seek_start(cfg->drive_index, cylinder) == HAL_OK) {
+            ra.seeking = true;
+            ra.seek_drive = cfg->drive_index;
+        }
+    }
+}
+
+void msc_hal_prefetch_cancel(uint8_t lun)
+{
+    if (ra.lun == lun) {
+        ra.active = false;
+    }
+}
+
+/**
+ * Check a drive's presence directly (task context)
+ */
+static bool lun_probe(const msc_lun_config_t *cfg)
+{
+    if (cfg->lun_type == MSC_LUN_TYPE_FDD) {
+        return hal_disk_present(cfg->drive_index);
+    }
+    if (cfg->lun_type == MSC_LUN_TYPE_HDD) {
+        return hdd_is_ready(cfg->drive_index);
+    }
+    return false;
+}
+
+/**
+ * Disk-change probe for ready floppies (task context)
+ * Collects the change bits the MSC block latched for the media-change
+ * interrupt, then checks the drive's disk-change line itself. Either
+ * flags the LUN exactly as the ISR would.
+ */
+static void fdd_change_probe(void)
+{
+    uint32_t mstatus = irq_save();
+    msc_config_irq_handler();
+    irq_restore(mstatus);
+
+    for (uint8_t lun = 0; lun < MSC_MAX_LUNS; lun++) {
+        msc_lun_config_t *cfg = &msc_state.luns[lun];
+
+        if (cfg->lun_type != MSC_LUN_TYPE_FDD ||
+            (lun_state[lun] & (MSC_STATE_READY | MSC_STATE_RESCAN)) != MSC_STATE_READY) {
+            continue;
+        }
+        if (!hal_disk_present(cfg->drive_index)) {
+            mstatus = irq_save();
+            msc_hal_notify_media_changed(lun);
+            irq_restore(mstatus);
+        }
+    }
+}
+
+/**
+ * Re-read LUNs the media-change interrupt (or the ready-floppy probe)
+ * flagged, and probe the ones it cannot report: an empty floppy drive
+ * without a ready line, and HDDs
+ */
+static void lun_state_poll(void)
+{
+    uint32_t now = timer_get_ms();
+    bool probe = (now - lun_probe_ms) >= MSC_PROBE_MS;
+
+    if (probe) {
+        lun_probe_ms = now;
+        fdd_change_probe();
+    }
+
+    for (uint8_t lun = 0; lun < MSC_MAX_LUNS; lun++) {
+        msc_lun_config_t *cfg = &msc_state.luns[lun];
+        uint32_t state = lun_state[lun];
+
+        if (state & MSC_STATE_RESCAN) {
+            /* Cleared first: a change during the rescan flags it again */
+            lun_state_update(lun, MSC_STATE_RESCAN, 0);
+            msc_hal_refresh_lun(lun);
+        } else if (probe && (cfg->lun_type == MSC_LUN_TYPE_HDD ||
+                             !(state & MSC_STATE_READY)) &&
+                   lun_probe(cfg) != ((state & MSC_STATE_READY) != 0)) {
+            msc_hal_refresh_lun(lun);
+        }
+    }
+}
+
+/**
+ * Provisional HDD LUNs: adopt the full-scan geometry once it lands
+ */
+static void hdd_lun_refresh(void)
+{
+    for (uint8_t lun = MSC_MAX_FDDS; lun < MSC_MAX_FDDS + MSC_MAX_HDDS; lun++) {
+        msc_lun_config_t *cfg = &msc_state.luns[lun];
+
+        if (cfg->lun_type != MSC_LUN_TYPE_HDD || !cfg->provisional ||
+            hdd_discover_pending(cfg->drive_index)) {
+            continue;
+        }
+
+        uint32_t capacity = cfg->capacity;
+        configure_hdd_lun(lun, cfg->drive_index);
+
+        /* Unit attention makes the host re-read the capacity */
+        if (cfg->capacity != capacity) {
+            lun_changed(lun);
+        }
+    }
+}
+
+void msc_hal_poll(void)
+{
+    lun_state_poll();
+    hdd_lun_refresh();
+
+    if (ra.seeking) {
+        if (hal_seek_poll(ra.seek_drive) == HAL_ERR_BUSY) {
+            return;
+        }
+        ra.seeking = false;
+    }
+
+    /* Aged writes go before read-ahead, one track per call */
+    int slot = wb_next(MSC_MAX_LUNS, true);
+    if (slot >= 0 && (timer_get_ms() - tcache[slot].dirty_ms) >= WB_FLUSH_MS) {
+        tcache_flush_slot(slot);
+        return;
+    }
+
+    if (!ra.active) {
+        return;
+    }
+
+    if (!msc_hal_is_ready(ra.lun) || !ra_skip_cached()) {
+        ra.active = false;
+        return;
+    }
+
+    /* One track side per call bounds how long the next command waits */
+    if (tcache_fill(ra.lun, ra.track) < 0) {
+        ra.active = false;
+        return;
+    }
+
+    ra.track++;
+    if (ra.track > ra.last) {
+        ra.active = false;
+    }
+}
+
 int msc_hal_write_sectors(uint8_t lun, uint32_t lba, const void *buf, uint32_t count)
 {
     int ret;
@@ -550,15 +1271,19 @@ int msc_hal_write_sectors(uint8_t lun, uint32_t lba, const void *buf, uint32_t c
         return MSC_ERR_LBA_RANGE;
     }
 
-    /* Route to appropriate HAL */
-    if (cfg->lun_type == MSC_LUN_TYPE_FDD) {
-        ret = hal_write_sectors(cfg->drive_index, lba, buf, count);
-    } else if (cfg->lun_type == MSC_LUN_TYPE_HDD) {
-        ret = hal_hdd_write_sectors(cfg->drive_index, lba, buf, count);
-    } else {
+    if (cfg->lun_type != MSC_LUN_TYPE_FDD && cfg->lun_type != MSC_LUN_TYPE_HDD) {
         return MSC_ERR_INVALID_LUN;
     }
 
+    /* Route to appropriate HAL, held in the track cache when possible */
+    if (wb_usable(cfg)) {
+        ret = tcache_write(lun, lba, buf, count);
+    } else {
+        /* Cached copies go stale even if the write fails part way */
+        tcache_invalidate_range(lun, lba, count);
+        ret = lun_write(cfg, lba, buf, count);
+    }
+
     if (ret == HAL_OK) {
         lun_write_count[lun] += count;
         lun_last_error[lun] = MSC_OK;
@@ -578,7 +1303,11 @@ int msc_hal_start_stop(uint8_t lun, bool start, bool eject)
 
     msc_lun_config_t *cfg = &msc_state.luns[lun];
 
+    /* Nothing may be left unwritten once the host stops the unit */
+    int ret = msc_hal_flush(lun);
+
     if (cfg->lun_type == MSC_LUN_TYPE_FDD) {
+        /* The host asked explicitly: STOP bypasses the idle timeout */
         if (start) {
             hal_motor_on(cfg->drive_index);
         } else {
@@ -591,17 +1320,36 @@ int msc_hal_start_stop(uint8_t lun, bool start, bool eject)
         (void)eject;
     }
 
-    return MSC_OK;
+    return ret;
 }
 
 int msc_hal_prevent_removal(uint8_t lun, bool prevent)
 {
-    /* Not implemented - FluxRipper doesn't have door lock */
-    (void)lun;
-    (void)prevent;
+    /* No door lock; allowing removal means the media may go any moment */
+    if (!prevent) {
+        return msc_hal_flush(lun);
+    }
     return MSC_OK;
 }
 
+int msc_hal_flush(uint8_t lun)
+{
+    if (lun >= MSC_MAX_LUNS) {
+        return MSC_ERR_INVALID_LUN;
+    }
+
+    /* In track order, so a floppy steps across once */
+    int slot;
+    while ((slot = wb_next(lun, false)) >= 0) {
+        tcache_flush_slot(slot);
+    }
+
+    /* Failed write-backs, including earlier background ones */
+    bool failed = wb_failed[lun];
+    wb_failed[lun] = false;
+    return failed ? MSC_ERR_WRITE : MSC_OK;
+}
+
 /*---------------------------------------------------------------------------
  * Public Functions - Geometry
  *---------------------------------------------------------------------------*/
@@ -641,7 +1389,7 @@ int msc_hal_refresh_lun(uint8_t lun)
 
     /* Detect media change */
     if (cfg->present != was_present) {
-        cfg->changed = true;
+        lun_changed(lun);
     }
 
     return MSC_OK;
@@ -673,3 +1421,9 @@ void msc_hal_get_stats(uint8_t lun, uint32_t *read_count,
     if (write_count) *write_count = lun_write_count[lun];
     if (error_count) *error_count = lun_error_count[lun];
 }
+
+void msc_hal_get_cache_stats(uint32_t *hits, uint32_t *misses)
+{
+    if (hits) *hits = tcache_hits;
+    if (misses) *misses = tcache_misses;
+}
@@ -0,0 +1,266 @@
+/**
+ * FluxRipper PLL Parameter Search - Implementation
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-10 16:00
+ */
+
+#include "pll_cal.h"
+#include "board_eeprom.h"
+#include "flux_decode.h"
+#include "format_cache.h"
+#include "fluxstat_hal.h"
+#include "fluxripper_hal.h"
+#include "crc16.h"
+#include <stddef.h>
+#include <string.h>
+
+/*============================================================================
+ * Sweep Grid
+ *============================================================================*/
+
+static const uint16_t bw_grid[PLLCAL_BW_STEPS] = { 5, 10, 20, 40, 80 };
+static const uint16_t damp_grid[PLLCAL_DAMP_STEPS] = { 50, 71, 100, 150 };
+
+/*============================================================================
+ * Candidates
+ *============================================================================*/
+
+/* Each grid point: its own loop and decoder over the shared intervals */
+static struct {
+    fdec_pll_t      pll;
+    fdec_t          dec;
+    fdec_track_t    out;
+} g_cand[PLLCAL_CANDIDATES];
+
+static int32_t g_dt[FDEC_BLOCK];
+static uint8_t g_runs[FDEC_BLOCK];
+
+/*============================================================================
+ * Sweep
+ *============================================================================*/
+
+void pllcal_results_init(pllcal_results_t *results, uint8_t encoding,
+                         uint32_t cell_ticks)
+{
+    memset(results, 0, sizeof(*results));
+    results->encoding = encoding;
+    results->cell_ticks = cell_ticks;
+
+    for (uint32_t b = 0; b < PLLCAL_BW_STEPS; b++) {
+        for (uint32_t d = 0; d < PLLCAL_DAMP_STEPS; d++) {
+            pllcal_result_t *c = &results->cand[b * PLLCAL_DAMP_STEPS + d];
+
+            c->bandwidth_pm = bw_grid[b];
+            c->damping = damp_grid[d];
+        }
+    }
+}
+
+void pllcal_sweep_pass(const uint32_t *words, uint32_t count,
+                       pllcal_results_t *results)
+{
+    fdec_src_t src;
+    uint32_t n;
+
+    for (uint32_t c = 0; c < PLLCAL_CANDIDATES; c++) {
+        fdec_pll_init(&g_cand[c].pll, results->cell_ticks,
+                      results->cand[c].bandwidth_pm, results->cand[c].damping);
+        fdec_track_init(&g_cand[c].out, NULL, 0);
+        if (fdec_init(&g_cand[c].dec, results->encoding, &g_cand[c].out) != 0) {
+            return;
+        }
+    }
+
+    /* One fetch of the block, shared by every candidate */
+    fdec_src_init(&src, words, count, results->cell_ticks);
+    while ((n = fdec_src_block(&src, g_dt)) > 0) {
+        for (uint32_t c = 0; c < PLLCAL_CANDIDATES; c++) {
+            fdec_pll_block(&g_cand[c].pll, g_dt, n, g_runs);
+            fdec_feed(&g_cand[c].dec, g_runs, n);
+        }
+    }
+
+    results->passes++;
+    for (uint32_t c = 0; c < PLLCAL_CANDIDATES; c++) {
+        pllcal_result_t *r = &results->cand[c];
+
+        r->ids += g_cand[c].out.ids;
+        r->sectors += g_cand[c].out.sectors;
+        r->transitions += g_cand[c].pll.transitions;
+        r->err2 += g_cand[c].pll.err2;
+        r->phase_rms = fdec_phase_rms(r->err2, r->transitions, results->cell_ticks);
+    }
+}
+
+uint32_t pllcal_best(const pllcal_results_t *results)
+{
+    uint32_t best = 0;
+
+    for (uint32_t c = 1; c < PLLCAL_CANDIDATES; c++) {
+        const pllcal_result_t *a = &results->cand[c];
+        const pllcal_result_t *b = &results->cand[best];
+
+        if (a->sectors != b->sectors) {
+            if (a->sectors > b->sectors) {
+                best = c;
+            }
+        } else if (a->ids != b->ids) {
+            if (a->ids > b->ids) {
+                best = c;
+            }
+        } else if (a->phase_rms < b->phase_rms) {
+            best = c;
+        }
+    }
+    return best;
+}
+
+/*============================================================================
+ * Calibration Records
+ *============================================================================*/
+
+static diag_cal_record_t g_cal[DIAG_CAL_DRIVES];
+
+static uint16_t cal_crc(const diag_cal_record_t *r)
+{
+    return crc16_ccitt(r, offsetof(diag_cal_record_t, crc));
+}
+
+static void cal_init(diag_cal_record_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    r->magic = DIAG_CAL_MAGIC;
+}
+
+int pllcal_calibrate_track(uint8_t drive, uint8_t track, uint8_t head,
+                           pllcal_results_t *results)
+{
+    static fluxstat_capture_t cap;
+    static pllcal_results_t local;
+    fluxstat_config_t cfg;
+    uint32_t zone, best;
+    diag_pll_cal_t *z;
+    int ret;
+
+    if (drive >= DIAG_CAL_DRIVES) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+    if (fluxstat_get_config(&cfg) != FLUXSTAT_OK ||
+        (cfg.encoding != ENC_UNKNOWN && !fdec_supported(cfg.encoding))) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+    if (results == NULL) {
+        results = &local;
+    }
+
+    ret = fluxstat_capture_start(drive, track, head);
+    if (ret == FLUXSTAT_OK) {
+        ret = fluxstat_capture_wait(cfg.pass_count * PLLCAL_PASS_MS + 1000);
+    }
+    if (ret == FLUXSTAT_OK) {
+        ret = fluxstat_capture_result(&cap);
+    }
+    hal_motor_release(drive);
+    if (ret == FLUXSTAT_OK && cfg.encoding == ENC_UNKNOWN) {
+        fmtc_format_t fmt;
+
+        ret = fmtc_identify(drive, (const uint32_t *)(uintptr_t)cap.passes[0].base_addr,
+                            cap.passes[0].flux_count, &fmt);
+        cfg.encoding = fmt.encoding;
+        cfg.data_rate = fmt.data_rate;
+    }
+    if (ret != FLUXSTAT_OK) {
+        return ret;
+    }
+
+    pllcal_results_init(results, cfg.encoding,
+                        fdec_cell_ticks(cfg.encoding, cfg.data_rate));
+    for (uint8_t i = 0; i < cap.pass_count; i++) {
+        pllcal_sweep_pass((const uint32_t *)(uintptr_t)cap.passes[i].base_addr,
+                          cap.passes[i].flux_count, results);
+    }
+
+    best = pllcal_best(results);
+    zone = track / DIAG_CAL_ZONE_TRACKS;
+    if (zone >= DIAG_CAL_ZONES) {
+        zone = DIAG_CAL_ZONES - 1;
+    }
+    z = &g_cal[drive].zone[zone];
+    z->bandwidth_pm = results->cand[best].bandwidth_pm;
+    z->damping = results->cand[best].damping;
+    z->sectors = (uint8_t)(results->cand[best].sectors / (results->passes ? results->passes : 1));
+    z->phase_rms = results->cand[best].phase_rms;
+    g_cal[drive].magic = DIAG_CAL_MAGIC;
+    return FLUXSTAT_OK;
+}
+
+int pllcal_calibrate_drive(uint8_t drive, uint8_t head)
+{
+    for (uint8_t z = 0; z < DIAG_CAL_ZONES; z++) {
+        uint8_t track = (uint8_t)(z * DIAG_CAL_ZONE_TRACKS + DIAG_CAL_ZONE_TRACKS / 2);
+        int ret = pllcal_calibrate_track(drive, track, head, NULL);
+
+        if (ret != FLUXSTAT_OK) {
+            return ret;
+        }
+    }
+    return FLUXSTAT_OK;
+}
+
+const diag_pll_cal_t *pllcal_lookup(uint8_t drive, uint8_t track)
+{
+    uint32_t zone = track / DIAG_CAL_ZONE_TRACKS;
+
+    if (drive >= DIAG_CAL_DRIVES) {
+        return NULL;
+    }
+    if (zone >= DIAG_CAL_ZONES) {
+        zone = DIAG_CAL_ZONES - 1;
+    }
+    return g_cal[drive].zone[zone].bandwidth_pm ? &g_cal[drive].zone[zone] : NULL;
+}
+
+diag_cal_record_t *pllcal_record(uint8_t drive)
+{
+    return drive < DIAG_CAL_DRIVES ? &g_cal[drive] : NULL;
+}
+
+void pllcal_clear(void)
+{
+    for (uint8_t d = 0; d < DIAG_CAL_DRIVES; d++) {
+        cal_init(&g_cal[d]);
+    }
+}
+
+int pllcal_load(void)
+{
+    for (uint8_t d = 0; d < DIAG_CAL_DRIVES; d++) {
+        diag_cal_record_t *r = &g_cal[d];
+
+        if (eeprom_read(EEPROM_CAL_BASE + d * EEPROM_PAGE, r, sizeof(*r)) != HAL_OK) {
+            pllcal_clear();
+            return HAL_ERR_HARDWARE;
+        }
+        if (r->magic != DIAG_CAL_MAGIC || r->crc != cal_crc(r)) {
+            cal_init(r);
+        }
+    }
+    return HAL_OK;
+}
+
+int pllcal_save(void)
+{
+    for (uint8_t d = 0; d < DIAG_CAL_DRIVES; d++) {
+        diag_cal_record_t *r = &g_cal[d];
+        int ret;
+
+        r->magic = DIAG_CAL_MAGIC;
+        r->crc = cal_crc(r);
+        ret = eeprom_write_page(EEPROM_CAL_BASE + d * EEPROM_PAGE, r);
+        if (ret != HAL_OK) {
+            return ret;
+        }
+    }
+    return HAL_OK;
+}
@@ -9,7 +9,10 @@
  */
 
 #include "cli.h"
+#include "cli_bin.h"
 #include "power_hal.h"
+#include "spinup.h"
+#include "timer.h"
 #include "uart.h"
 #include <string.h>
 
@@ -61,6 +64,73 @@ static const char *get_source_str(pwr_source_t src)
     }
 }
 
+static void bin_reading(const char *key, const pmu_reading_t *r)
+{
+    cli_bin_map_begin(key);
+    cli_bin_uint("mv", r->voltage_mv);
+    cli_bin_int("ma", r->current_ma);
+    cli_bin_uint("mw", r->power_mw);
+    cli_bin_bool("valid", r->valid);
+    cli_bin_bool("alert", r->alert);
+    cli_bin_end_container();
+}
+
+/**
+ * power status --bin: the whole pmu_system_t, one map per rail/connector
+ */
+static void bin_power_status(const pmu_system_t *sys)
+{
+    uint32_t available, allocated, remaining;
+
+    cli_bin_str("source", get_source_str(sys->active_source));
+    cli_bin_map_begin("usbc");
+    cli_bin_uint("pd_version", sys->usbc_status.pd_version);
+    cli_bin_uint("mv", sys->usbc_status.voltage_mv);
+    cli_bin_uint("ma", sys->usbc_status.current_ma);
+    cli_bin_uint("mw", sys->usbc_status.power_mw);
+    cli_bin_end_container();
+    cli_bin_uint("atx_12v_mv", sys->atx_12v_mv);
+    cli_bin_uint("atx_5v_mv", sys->atx_5v_mv);
+
+    cli_bin_array_begin("connectors");
+    for (int i = 0; i < PWR_CONN_COUNT; i++) {
+        const pwr_conn_status_t *c = &sys->connectors[i];
+
+        cli_bin_map_begin(NULL);
+        cli_bin_str("name", pwr_conn_name((pwr_conn_t)i));
+        bin_reading("rail_5v", &c->rail_5v);
+        bin_reading("rail_12v", &c->rail_12v);
+        cli_bin_uint("mw", c->total_power_mw);
+        cli_bin_bool("enabled", c->enabled);
+        cli_bin_bool("fault", c->fault);
+        cli_bin_bool("present", c->present);
+        cli_bin_end_container();
+    }
+    cli_bin_end_container();
+
+    cli_bin_array_begin("rails");
+    for (int i = 0; i < PMU_RAIL_COUNT; i++) {
+        bin_reading(NULL, &sys->rails[i]);
+    }
+    cli_bin_end_container();
+
+    cli_bin_uint("input_mw", sys->input_power_mw);
+    cli_bin_uint("fdd_mw", sys->fdd_power_mw);
+    cli_bin_uint("hdd_mw", sys->hdd_power_mw);
+    cli_bin_uint("system_mw", sys->system_power_mw);
+    cli_bin_uint("total_mw", sys->total_power_mw);
+
+    pwr_budget_report(&available, &allocated, &remaining);
+    cli_bin_uint("budget_available_mw", available);
+    cli_bin_uint("budget_allocated_mw", allocated);
+
+    cli_bin_array_begin("ina3221");
+    for (int i = 0; i < INA3221_COUNT_TOTAL; i++) {
+        cli_bin_bool(NULL, sys->ina3221_present[i]);
+    }
+    cli_bin_end_container();
+}
+
 /*============================================================================
  * CLI Command Implementations
  *============================================================================*/
@@ -74,13 +144,24 @@ static int cmd_power_status(int argc, char *argv[])
     (void)argv;
 
     pmu_system_t sys;
-    int ret = pmu_read_all(&sys);
+    uint32_t age_ms = 0;
+    int ret = pmu_get_cached(&sys, &age_ms);
 
+    /* No sweep finished yet (just after boot): read the bus directly */
+    if (ret == PMU_ERR_NOT_READY) {
+        ret = pmu_read_all(&sys);
+    }
     if (ret != PMU_OK) {
         uart_puts("Failed to read power status\n");
         return -1;
     }
 
+    if (cli_bin_active()) {
+        cli_bin_uint("age_ms", age_ms);
+        bin_power_status(&sys);
+        return 0;
+    }
+
     /* Input Power Sources */
     uart_puts("\n╔═══════════════════════════════════════════════════════════════╗\n");
     uart_puts("║                    POWER INPUT STATUS                         ║\n");
@@ -235,6 +316,7 @@ static int cmd_power_status(int argc, char *argv[])
         }
     }
     uart_printf("(%d/6 INA3221)\n", found);
+    uart_printf("Sampled %lu ms ago\n", age_ms);
 
     return 0;
 }
@@ -600,6 +682,9 @@ static int cmd_power_enable(int argc, char *argv[], bool enable)
     if (strcmp(name, "all") == 0) {
         for (int i = 0; i < PWR_CONN_COUNT; i++) {
             pwr_conn_enable((pwr_conn_t)i, enable);
+            if (!enable) {
+                spinup_release((pwr_conn_t)i);
+            }
         }
         uart_printf("All connectors %s\n", enable ? "enabled" : "disabled");
         return 0;
@@ -620,6 +705,9 @@ static int cmd_power_enable(int argc, char *argv[], bool enable)
     }
 
     int ret = pwr_conn_enable(conn, enable);
+    if (!enable) {
+        spinup_release(conn);
+    }
     if (ret == PMU_OK) {
         uart_printf("%s: %s\n", pwr_conn_name(conn), enable ? "ENABLED" : "DISABLED");
     } else {
@@ -629,6 +717,63 @@ static int cmd_power_enable(int argc, char *argv[], bool enable)
     return ret;
 }
 
+static const char *const spinup_state_names[] = {
+    "idle", "pending", "surge", "up", "FAILED"
+};
+
+static const char *const conn_arg_names[PWR_CONN_COUNT] = {
+    "fdd0", "fdd1", "fdd2", "fdd3", "hdd0", "hdd1"
+};
+
+/**
+ * power spinup [conn...|all] - Staggered, budget-checked spin-up
+ * Without arguments, shows each connector's spin-up state.
+ */
+static int cmd_power_spinup(int argc, char *argv[])
+{
+    spinup_stats_t stats;
+    uint32_t mask = 0;
+
+    for (int i = 1; i < argc; i++) {
+        int c;
+
+        if (strcmp(argv[i], "all") == 0) {
+            mask = SPINUP_MASK_ALL;
+            continue;
+        }
+        for (c = 0; c < PWR_CONN_COUNT; c++) {
+            if (strcmp(argv[i], conn_arg_names[c]) == 0) {
+                break;
+            }
+        }
+        if (c == PWR_CONN_COUNT) {
+            uart_printf("Unknown connector: %s\n", argv[i]);
+            return -1;
+        }
+        mask |= SPINUP_MASK(c);
+    }
+
+    if (mask != 0) {
+        uint32_t start = timer_get_ms();
+        int ret = spinup_wait(mask, SPINUP_WAIT_MS);
+
+        uart_printf("Spin-up %s in %lu ms\n",
+            ret == 0 ? "complete" : "FAILED", timer_get_ms() - start);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    spinup_get_stats(&stats);
+    for (int i = 0; i < PWR_CONN_COUNT; i++) {
+        uart_printf("  %-5s %s\n", pwr_conn_name((pwr_conn_t)i),
+            spinup_state_names[spinup_get_state((pwr_conn_t)i)]);
+    }
+    uart_printf("Started: %lu  Peak parallel: %lu  Deferred: %lu  Failed: %lu\n",
+        stats.started, stats.peak_parallel, stats.deferred, stats.failed);
+    return 0;
+}
+
 /**
  * power 8inch [on|off] - Control 24V 8" drive mode
  */
@@ -671,6 +816,7 @@ int cmd_power(int argc, char *argv[])
         uart_puts("  power rail <name>        - Specific rail details\n");
         uart_puts("  power enable <conn>      - Enable connector power\n");
         uart_puts("  power disable <conn>     - Disable connector power\n");
+        uart_puts("  power spinup [conn|all]  - Staggered spin-up within the power budget\n");
         uart_puts("  power 8inch [on|off]     - 24V 8\" drive mode (FDD3)\n");
         uart_puts("  power dcdc               - DC-DC converter status\n");
         uart_puts("  power total              - Total power consumption\n");
@@ -688,6 +834,8 @@ int cmd_power(int argc, char *argv[])
         return cmd_power_enable(argc - 1, &argv[1], true);
     } else if (strcmp(argv[1], "disable") == 0) {
         return cmd_power_enable(argc - 1, &argv[1], false);
+    } else if (strcmp(argv[1], "spinup") == 0) {
+        return cmd_power_spinup(argc - 1, &argv[1]);
     } else if (strcmp(argv[1], "8inch") == 0) {
         return cmd_power_8inch(argc - 1, &argv[1]);
     } else if (strcmp(argv[1], "dcdc") == 0) {
@@ -709,8 +857,11 @@ int cmd_power(int argc, char *argv[])
 
 const cli_cmd_t power_cli_cmd = {
     "power", "Power monitoring (status, rail, total)",
-    cmd_power
+    cmd_power,
+    0,
+    NULL
 };
+CLI_COMMAND(power_cli_cmd);
 
 void power_cli_init(void)
 {
@@ -719,7 +870,4 @@ void power_cli_init(void)
 
     /* Initialize power HAL (INA3221 monitors) */
     pmu_init();
-
-    /* Register power command */
-    cli_register(&power_cli_cmd);
 }
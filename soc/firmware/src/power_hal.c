@@ -8,6 +8,9 @@
 
 #include "power_hal.h"
 #include "uart.h"
+#include "timer.h"
+#include "task.h"
+#include <string.h>
 
 /*============================================================================
  * Internal State
@@ -15,10 +18,29 @@
 
 static struct {
     bool initialized;
-    uint8_t ina3221_present[4];     /* Device presence flags (A, B, C, D) */
+    uint8_t ina3221_present[INA3221_COUNT_TOTAL];  /* Device presence flags */
     uint16_t shunt_mohm[PMU_RAIL_COUNT];  /* Shunt resistances */
 } pmu_state;
 
+/* Background sampler: snap[front] is published, the other is being filled */
+static struct {
+    pmu_system_t snap[2];
+    uint8_t front;
+    bool valid;                     /* snap[front] holds a complete sweep */
+    uint8_t step;                   /* Next rail; PMU_RAIL_COUNT = status step */
+    uint32_t taken_ms;              /* When snap[front] completed */
+} pmu_sampler;
+
+/* Rails feeding each connector: 5V, 12V */
+static const uint8_t conn_rails[PWR_CONN_COUNT][2] = {
+    [PWR_CONN_FDD0] = { PMU_RAIL_FDD0_5V, PMU_RAIL_FDD0_12V },
+    [PWR_CONN_FDD1] = { PMU_RAIL_FDD1_5V, PMU_RAIL_FDD1_12V },
+    [PWR_CONN_FDD2] = { PMU_RAIL_FDD2_5V, PMU_RAIL_FDD2_12V },
+    [PWR_CONN_FDD3] = { PMU_RAIL_FDD3_5V, PMU_RAIL_FDD3_12V },
+    [PWR_CONN_HDD0] = { PMU_RAIL_HDD0_5V, PMU_RAIL_HDD0_12V },
+    [PWR_CONN_HDD1] = { PMU_RAIL_HDD1_5V, PMU_RAIL_HDD1_12V }
+};
+
 /* Shunt resistor values for each rail (milliohms) */
 static const uint16_t rail_shunts[PMU_RAIL_COUNT] = {
     [PMU_RAIL_5V_DRV01]   = SHUNT_5V_DRIVE,
@@ -505,22 +527,131 @@ int pmu_read_all(pmu_system_t *system)
     return PMU_OK;
 }
 
-uint32_t pmu_get_total_power_mw(void)
+/*============================================================================
+ * Background Sampler
+ *============================================================================*/
+
+static uint32_t rail_mw(const pmu_system_t *s, int rail)
 {
-    pmu_system_t sys;
-    if (pmu_read_all(&sys) != PMU_OK) {
-        return 0;
+    return s->rails[rail].valid ? s->rails[rail].power_mw : 0;
+}
+
+/**
+ * Derive connector status and power summaries from the rails of a sweep
+ */
+static void snapshot_finish(pmu_system_t *s)
+{
+    uint32_t fdd = 0;
+    uint32_t hdd = 0;
+
+    for (int i = 0; i < PWR_CONN_COUNT; i++) {
+        pwr_conn_status_t *c = &s->connectors[i];
+        int r12 = conn_rails[i][1];
+
+        /* 8" mode feeds FDD3 from the 24V boost instead of 12V */
+        if (i == PWR_CONN_FDD3 && pwr_conn_is_8inch_mode()) {
+            r12 = PMU_RAIL_24V_8INCH;
+        }
+
+        c->rail_5v = s->rails[conn_rails[i][0]];
+        c->rail_12v = s->rails[r12];
+        c->total_power_mw = (uint16_t)(rail_mw(s, conn_rails[i][0]) + rail_mw(s, r12));
+        c->enabled = (c->rail_5v.valid && c->rail_5v.voltage_mv > PMU_CONN_ON_MV) ||
+                     (c->rail_12v.valid && c->rail_12v.voltage_mv > PMU_CONN_ON_MV);
+        c->present = c->enabled && c->total_power_mw > PMU_CONN_PRESENT_MW;
+        c->fault = pwr_conn_fault((pwr_conn_t)i);
+
+        if (i <= PWR_CONN_FDD3) {
+            fdd += c->total_power_mw;
+        } else {
+            hdd += c->total_power_mw;
+        }
     }
-    return sys.total_power_mw;
+
+    s->atx_12v_mv = s->rails[PMU_RAIL_ATX_12V].valid ? s->rails[PMU_RAIL_ATX_12V].voltage_mv : 0;
+    s->atx_5v_mv = s->rails[PMU_RAIL_ATX_5V].valid ? s->rails[PMU_RAIL_ATX_5V].voltage_mv : 0;
+
+    s->fdd_power_mw = fdd;
+    s->hdd_power_mw = hdd;
+    s->system_power_mw = rail_mw(s, PMU_RAIL_3V3_IO) + rail_mw(s, PMU_RAIL_1V0_CORE);
+    s->input_power_mw = rail_mw(s, PMU_RAIL_USB_C_VBUS) + rail_mw(s, PMU_RAIL_ATX_12V) +
+                        rail_mw(s, PMU_RAIL_ATX_5V);
+    s->total_power_mw = fdd + hdd + s->system_power_mw;
 }
 
-uint32_t pmu_get_drive_power_mw(void)
+void pmu_sample_poll(void)
 {
-    pmu_system_t sys;
-    if (pmu_read_all(&sys) != PMU_OK) {
-        return 0;
+    pmu_system_t *back = &pmu_sampler.snap[pmu_sampler.front ^ 1];
+
+    if (!pmu_state.initialized) {
+        return;
+    }
+
+    /* Keep the bus quiet around drive work while the snapshot is fresh */
+    if (task_drives_busy() && pmu_sampler.valid &&
+        timer_get_ms() - pmu_sampler.taken_ms < PMU_SAMPLE_STALE_MS) {
+        return;
+    }
+
+    if (pmu_sampler.step < PMU_RAIL_COUNT) {
+        pmu_read_rail((pmu_rail_t)pmu_sampler.step, &back->rails[pmu_sampler.step]);
+        pmu_sampler.step++;
+        return;
     }
-    return sys.drive_power_mw;
+
+    /* Status step: GPIO and PD controller, then publish */
+    dcdc_read_all(back->converters);
+    back->active_source = pwr_get_source();
+    if (pwr_get_usbc_status(&back->usbc_status) != PMU_OK) {
+        memset(&back->usbc_status, 0, sizeof(back->usbc_status));
+    }
+    for (int i = 0; i < INA3221_COUNT_TOTAL; i++) {
+        back->ina3221_present[i] = pmu_state.ina3221_present[i];
+    }
+    snapshot_finish(back);
+
+    pmu_sampler.front ^= 1;
+    pmu_sampler.taken_ms = timer_get_ms();
+    pmu_sampler.valid = true;
+    pmu_sampler.step = 0;
+}
+
+int pmu_get_cached(pmu_system_t *system, uint32_t *age_ms)
+{
+    if (!pmu_sampler.valid) {
+        return PMU_ERR_NOT_READY;
+    }
+
+    *system = pmu_sampler.snap[pmu_sampler.front];
+    if (age_ms != NULL) {
+        *age_ms = timer_get_ms() - pmu_sampler.taken_ms;
+    }
+    return PMU_OK;
+}
+
+/* Published snapshot, or a blocking read into 'tmp' before the first sweep */
+static const pmu_system_t *snapshot_or_read(pmu_system_t *tmp)
+{
+    if (pmu_sampler.valid) {
+        return &pmu_sampler.snap[pmu_sampler.front];
+    }
+    return pmu_read_all(tmp) == PMU_OK ? tmp : NULL;
+}
+
+uint32_t pmu_get_total_power_mw(void)
+{
+    pmu_system_t tmp;
+    const pmu_system_t *s = snapshot_or_read(&tmp);
+
+    return s ? s->total_power_mw : 0;
+}
+
+uint32_t pmu_get_drive_power_mw(void)
+{
+    pmu_system_t tmp;
+    const pmu_system_t *s = snapshot_or_read(&tmp);
+
+    return s ? s->fdd_power_mw + s->hdd_power_mw : 0;
 }
 
 const char *pmu_rail_name(pmu_rail_t rail)
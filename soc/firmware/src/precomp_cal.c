@@ -0,0 +1,312 @@
+/**
+ * FluxRipper Write Precompensation Calibration - Implementation
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-11 09:30
+ */
+
+#include "precomp_cal.h"
+#include "pll_cal.h"
+#include "flux_decode.h"
+#include "format_cache.h"
+#include "fluxstat_hal.h"
+#include "fluxripper_hal.h"
+#include "platform.h"
+#include <stddef.h>
+#include <string.h>
+
+/*============================================================================
+ * Settings
+ *============================================================================*/
+
+/* Swept in order of increasing shift; PRECOMP_DEFAULT repeats one of them */
+static const uint8_t g_settings[PCAL_SETTINGS] = {
+    PRECOMP_OFF, PRECOMP_41NS, PRECOMP_83NS, PRECOMP_125NS,
+    PRECOMP_167NS, PRECOMP_208NS, PRECOMP_250NS
+};
+
+/* Write shift per PRECOMP_* code, ns (code 0 depends on the rate) */
+static const uint16_t g_code_ns[8] = { 125, 42, 83, 125, 167, 208, 250, 0 };
+
+/* 0x6D 0xB6 0xDB: every MFM interval next to every other one */
+static const uint8_t g_pattern[3] = { 0x6D, 0xB6, 0xDB };
+
+#define SECTOR_LIST_MAX     64
+#define SHIFT_NONE          INT16_MAX   /* A peak is missing */
+
+static fdec_sector_t g_list[SECTOR_LIST_MAX];
+static int32_t g_dt[FDEC_BLOCK];
+
+/*============================================================================
+ * Measurement
+ *============================================================================*/
+
+uint16_t pcal_precomp_ns(uint8_t code, uint32_t data_rate)
+{
+    if (code == PRECOMP_DEFAULT && data_rate >= 1000000) {
+        return 42;
+    }
+    return g_code_ns[code & 7];
+}
+
+void pcal_histogram(const uint32_t *words, uint32_t count, uint32_t cell_ticks,
+                    pcal_hist_t *hist)
+{
+    /* fdec_src_block() intervals are Q8 clocks: one bin is cell / 32 */
+    uint32_t bin_q8 = cell_ticks * 256 / PCAL_BINS_PER_CELL;
+    fdec_src_t src;
+    uint32_t n;
+
+    fdec_src_init(&src, words, count, cell_ticks);
+    while ((n = fdec_src_block(&src, g_dt)) > 0) {
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t b = (uint32_t)g_dt[i] / bin_q8;
+
+            if (b < PCAL_HIST_BINS) {
+                hist->bins[b]++;
+            }
+        }
+        hist->intervals += n;
+    }
+}
+
+/**
+ * Centroid of the bins within half a cell of "cells", 1/256 cell
+ * @return 0 if the window is empty
+ */
+static int32_t peak_centroid(const pcal_hist_t *hist, uint32_t cells)
+{
+    uint32_t lo = cells * PCAL_BINS_PER_CELL - PCAL_BINS_PER_CELL / 2;
+    uint32_t hi = lo + PCAL_BINS_PER_CELL;
+    uint64_t sum = 0;
+    uint32_t total = 0;
+
+    for (uint32_t b = lo; b < hi && b < PCAL_HIST_BINS; b++) {
+        /* Bin centre in 1/256 cell */
+        sum += (uint64_t)hist->bins[b] * (b * (256 / PCAL_BINS_PER_CELL) +
+                                          128 / PCAL_BINS_PER_CELL);
+        total += hist->bins[b];
+    }
+    return total ? (int32_t)(sum / total) : 0;
+}
+
+void pcal_measure(const pcal_hist_t *hist, pcal_result_t *result)
+{
+    for (uint32_t k = 0; k < 3; k++) {
+        result->peak[k] = (int16_t)peak_centroid(hist, k + 2);
+    }
+
+    /* The 3-cell peak is the reference: the drive's speed moves all three */
+    if (result->peak[0] == 0 || result->peak[1] == 0 || result->peak[2] == 0) {
+        result->shift2 = SHIFT_NONE;
+        result->shift4 = SHIFT_NONE;
+        return;
+    }
+    result->shift2 = (int16_t)(result->peak[0] - result->peak[1] * 2 / 3);
+    result->shift4 = (int16_t)(result->peak[2] - result->peak[1] * 4 / 3);
+}
+
+static uint32_t shift_score(const pcal_result_t *r)
+{
+    if (r->shift2 == SHIFT_NONE) {
+        return UINT32_MAX;
+    }
+    return (uint32_t)(r->shift2 < 0 ? -r->shift2 : r->shift2) +
+           (uint32_t)(r->shift4 < 0 ? -r->shift4 : r->shift4);
+}
+
+uint32_t pcal_best(const pcal_results_t *results)
+{
+    uint32_t best = 0;
+
+    for (uint32_t c = 1; c < PCAL_SETTINGS; c++) {
+        const pcal_result_t *a = &results->cand[c];
+        const pcal_result_t *b = &results->cand[best];
+
+        if (a->sectors > b->sectors ||
+            (a->sectors == b->sectors && shift_score(a) < shift_score(b))) {
+            best = c;
+        }
+    }
+    return best;
+}
+
+/*============================================================================
+ * Calibration
+ *============================================================================*/
+
+static int write_status(int ret)
+{
+    switch (ret) {
+        case HAL_OK:                return FLUXSTAT_OK;
+        case HAL_ERR_BUSY:          return FLUXSTAT_ERR_BUSY;
+        case HAL_ERR_TIMEOUT:       return FLUXSTAT_ERR_TIMEOUT;
+        case HAL_ERR_OVERFLOW:      return FLUXSTAT_ERR_OVERFLOW;
+        case HAL_ERR_WRITE_PROT:
+        case HAL_ERR_INVALID:       return FLUXSTAT_ERR_INVALID;
+        default:                    return FLUXSTAT_ERR_NO_DATA;
+    }
+}
+
+static uint8_t zone_of(uint8_t track)
+{
+    uint32_t zone = track / DIAG_CAL_ZONE_TRACKS;
+
+    return (uint8_t)(zone < DIAG_CAL_ZONES ? zone : DIAG_CAL_ZONES - 1);
+}
+
+int pcal_calibrate_track(uint8_t drive, uint8_t track, uint8_t head,
+                         pcal_results_t *results)
+{
+    static fluxstat_capture_t cap;
+    static pcal_results_t local;
+    static pcal_hist_t hist;
+    uint8_t *buf = (uint8_t *)PRECOMP_BUF_BASE;
+    const diag_pll_cal_t *pll = pllcal_lookup(drive, track);
+    uint16_t bw = pll ? pll->bandwidth_pm : FDEC_DEFAULT_BW_PM;
+    uint16_t damp = pll ? pll->damping : FDEC_DEFAULT_DAMPING;
+    fluxstat_config_t cfg;
+    diag_precomp_cal_t *z;
+    uint8_t zone = zone_of(track);
+    uint8_t spt, prev;
+    uint32_t lba, best;
+    int ret = FLUXSTAT_OK;
+
+    if (drive >= MAX_DRIVES || head > 1) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+    if (fluxstat_get_config(&cfg) != FLUXSTAT_OK ||
+        (cfg.encoding != ENC_UNKNOWN && cfg.encoding != ENC_MFM)) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+    if (hal_write_protected(drive)) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+    if (results == NULL) {
+        results = &local;
+    }
+
+    spt = hal_get_sectors_per_track(drive);
+    if ((uint32_t)spt * FDC_SECTOR_SIZE > PRECOMP_BUF_SIZE) {
+        return FLUXSTAT_ERR_INVALID;
+    }
+    for (uint32_t i = 0; i < (uint32_t)spt * FDC_SECTOR_SIZE; i++) {
+        buf[i] = g_pattern[i % 3];
+    }
+    lba = ((uint32_t)track * 2 + head) * spt;
+    prev = hal_get_write_precomp(drive, track);
+
+    memset(results, 0, sizeof(*results));
+    results->sectors = spt;
+
+    for (uint32_t c = 0; c < PCAL_SETTINGS && ret == FLUXSTAT_OK; c++) {
+        pcal_result_t *r = &results->cand[c];
+        fdec_track_t out;
+
+        r->code = g_settings[c];
+        hal_set_write_precomp(drive, zone, r->code);
+        ret = write_status(hal_write_sectors(drive, lba, buf, spt));
+        if (ret == FLUXSTAT_OK) {
+            ret = fluxstat_capture_start(drive, track, head);
+        }
+        if (ret == FLUXSTAT_OK) {
+            ret = fluxstat_capture_wait(cfg.pass_count * PCAL_PASS_MS + 1000);
+        }
+        if (ret == FLUXSTAT_OK) {
+            ret = fluxstat_capture_result(&cap);
+        }
+        if (ret != FLUXSTAT_OK) {
+            break;
+        }
+
+        /* Automatic encoding: the media rate from the first read-back */
+        if (results->cell_ticks == 0) {
+            if (cfg.encoding == ENC_UNKNOWN) {
+                fmtc_format_t fmt;
+
+                ret = fmtc_identify(drive, (const uint32_t *)(uintptr_t)cap.passes[0].base_addr,
+                                    cap.passes[0].flux_count, &fmt);
+                if (ret == FLUXSTAT_OK && fmt.encoding != ENC_MFM) {
+                    ret = FLUXSTAT_ERR_INVALID;
+                }
+                cfg.data_rate = fmt.data_rate;
+                if (ret != FLUXSTAT_OK) {
+                    break;
+                }
+            }
+            results->cell_ticks = fdec_cell_ticks(ENC_MFM, cfg.data_rate);
+        }
+
+        memset(&hist, 0, sizeof(hist));
+        for (uint8_t i = 0; i < cap.pass_count; i++) {
+            pcal_histogram((const uint32_t *)(uintptr_t)cap.passes[i].base_addr,
+                           cap.passes[i].flux_count, results->cell_ticks, &hist);
+        }
+        pcal_measure(&hist, r);
+        r->precomp_ns = pcal_precomp_ns(r->code, cfg.data_rate);
+
+        fdec_track_init(&out, g_list, SECTOR_LIST_MAX);
+        fdec_decode_pass((const uint32_t *)(uintptr_t)cap.passes[0].base_addr,
+                         cap.passes[0].flux_count, ENC_MFM, cfg.data_rate, bw, damp, &out);
+        r->sectors = (uint8_t)out.sectors;
+    }
+    hal_motor_release(drive);
+
+    best = pcal_best(results);
+    if (ret == FLUXSTAT_OK && results->cand[best].sectors == 0) {
+        ret = FLUXSTAT_ERR_NO_DATA;
+    }
+    if (ret != FLUXSTAT_OK) {
+        hal_set_write_precomp(drive, zone, prev);
+        return ret;
+    }
+
+    z = &pllcal_record(drive)->precomp[zone];
+    z->code = results->cand[best].code | DIAG_PRECOMP_VALID;
+    z->shift = (int8_t)(results->cand[best].shift2 < INT8_MIN ? INT8_MIN :
+                        results->cand[best].shift2 > INT8_MAX ? INT8_MAX :
+                        results->cand[best].shift2);
+    pllcal_record(drive)->magic = DIAG_CAL_MAGIC;
+    hal_set_write_precomp(drive, zone, results->cand[best].code);
+    return FLUXSTAT_OK;
+}
+
+int pcal_calibrate_drive(uint8_t drive, uint8_t head)
+{
+    for (uint8_t z = 0; z < DIAG_CAL_ZONES; z++) {
+        uint8_t track = (uint8_t)(z * DIAG_CAL_ZONE_TRACKS + DIAG_CAL_ZONE_TRACKS / 2);
+        int ret = pcal_calibrate_track(drive, track, head, NULL);
+
+        if (ret != FLUXSTAT_OK) {
+            return ret;
+        }
+    }
+    return FLUXSTAT_OK;
+}
+
+const diag_precomp_cal_t *pcal_lookup(uint8_t drive, uint8_t track)
+{
+    const diag_cal_record_t *rec = pllcal_record(drive);
+    const diag_precomp_cal_t *z;
+
+    if (rec == NULL) {
+        return NULL;
+    }
+    z = &rec->precomp[zone_of(track)];
+    return (z->code & DIAG_PRECOMP_VALID) ? z : NULL;
+}
+
+void pcal_apply(void)
+{
+    for (uint8_t d = 0; d < MAX_DRIVES; d++) {
+        const diag_cal_record_t *rec = pllcal_record(d);
+
+        for (uint8_t z = 0; z < DIAG_CAL_ZONES; z++) {
+            uint8_t code = rec->precomp[z].code;
+
+            hal_set_write_precomp(d, z, (code & DIAG_PRECOMP_VALID)
+                                  ? (uint8_t)(code & ~DIAG_PRECOMP_VALID)
+                                  : PRECOMP_DEFAULT);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+/**
+ * FluxRipper SoC - Hot Path Profiler
+ *
+ * Created: 2025-12-09 09:10
+ */
+
+#include "prof.h"
+#include <string.h>
+
+prof_stats_t prof_table[PROF_ZONES];
+
+static const char *const zone_names[PROF_ZONES] = {
+    [PROF_SCSI_CMD]      = "scsi",
+    [PROF_RAW_CMD]       = "raw",
+    [PROF_HISTOGRAM_ADD] = "hist",
+    [PROF_FDD_READ]      = "fdd_read",
+    [PROF_HDD_READ]      = "hdd_read",
+    [PROF_MSC_READ]      = "msc_read",
+};
+
+/*============================================================================
+ * Readout
+ *============================================================================*/
+
+void prof_reset(void)
+{
+    uint32_t irq = irq_save();
+
+    memset(prof_table, 0, sizeof(prof_table));
+    irq_restore(irq);
+}
+
+void prof_snapshot(prof_stats_t *out)
+{
+    uint32_t irq = irq_save();
+    memcpy(out, prof_table, sizeof(prof_table));
+    irq_restore(irq);
+}
+
+const char *prof_zone_name(prof_zone_t zone)
+{
+    return (zone < PROF_ZONES) ? zone_names[zone] : "?";
+}
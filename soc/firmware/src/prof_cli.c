@@ -0,0 +1,63 @@
+/**
+ * FluxRipper SoC - Profiler CLI Commands
+ *
+ * Created: 2025-12-09 09:10
+ */
+
+#include "prof_cli.h"
+#include "prof.h"
+#include "uart.h"
+#include <string.h>
+
+/*============================================================================
+ * Zone Table Display
+ *============================================================================*/
+
+int cmd_prof(int argc, char *argv[])
+{
+    if (argc >= 2 && strcmp(argv[1], "reset") == 0) {
+        prof_reset();
+        uart_puts("Profile cleared.\n");
+        return 0;
+    }
+    if (argc >= 2) {
+        uart_puts("Usage: prof [reset]\n");
+        return -1;
+    }
+
+    prof_stats_t zones[PROF_ZONES];
+    prof_snapshot(zones);
+
+    uart_printf("\nHot Path Profile (cycles @ %u MHz)\n", CPU_FREQ_HZ / 1000000);
+    uart_puts("-----------------------------------------\n");
+
+    for (int i = 0; i < PROF_ZONES; i++) {
+        const prof_stats_t *z = &zones[i];
+        uint32_t avg = z->calls ? (uint32_t)(z->total / z->calls) : 0;
+        uint32_t total_us = (uint32_t)(z->total / (CPU_FREQ_HZ / 1000000));
+
+        uart_printf("  %s:\n", prof_zone_name((prof_zone_t)i));
+        uart_printf("    Calls %u  Min/Avg/Max %u / %u / %u  Total %u us\n",
+                    z->calls, z->min, avg, z->max, total_us);
+    }
+    uart_puts("-----------------------------------------\n");
+
+    return 0;
+}
+
+/*============================================================================
+ * CLI Registration
+ *============================================================================*/
+
+const cli_cmd_t prof_cli_cmd = {
+    "prof", "Hot path cycle profile: prof [reset]",
+    cmd_prof,
+    0,
+    NULL
+};
+CLI_COMMAND(prof_cli_cmd);
+
+void prof_cli_init(void)
+{
+    prof_reset();
+}
@@ -12,19 +12,241 @@
 #include "raw_protocol.h"
 #include "fluxripper_hal.h"
 #include "hdd_hal.h"
+#include "platform.h"
+#include "timer.h"
+#include "prof.h"
+#include "kf_stream.h"
+#include "debug_hal.h"
+#include "tape_hal.h"
+#include "ddr_arena.h"
+#include "fluxstat_hal.h"
 #include <string.h>
 
 /*---------------------------------------------------------------------------
  * Private Data
  *---------------------------------------------------------------------------*/
 
-static raw_mode_state_t raw_state;
-
-/* Capture statistics */
-static uint32_t capture_sample_count;
-static uint32_t capture_index_count;
-static uint32_t capture_overflow_count;
-static uint32_t capture_start_time;
+/*
+ * READ_FLUX streaming: two DMA chunks in HyperRAM, each an 8-byte
+ * response header followed by flux words, so a filled chunk goes to the
+ * bulk endpoint as one contiguous transfer with no copy. The DMA fills one
+ * chunk while the host drains the other.
+ *
+ * Each session streams from its own half of track buffer B. Session 0's
+ * half also holds the BATCH and IMAGE buffers behind its stream.
+ */
+#define STREAM_SESSION_SPAN (TRACK_BUF_B_SIZE / RAW_SESSIONS)
+#define STREAM_BUF_BASE     TRACK_BUF_B_BASE
+#define STREAM_CHUNKS       2
+#define STREAM_PAYLOAD      (RAW_FLUX_CHUNK_SIZE - sizeof(raw_rsp_header_t))
+
+/* Encoded chunks (RAW_FLUX_FMT_DELTA/KRYOFLUX) follow the DMA chunks;
+ * worst case is 5 bytes per word, so they are sized for 5/4 of the
+ * payload. A KryoFlux cell takes at most 3 bytes plus its overflows. */
+#define STREAM_ZBUF_OFS     (STREAM_CHUNKS * RAW_FLUX_CHUNK_SIZE)
+#define STREAM_ZBUF_BASE    (STREAM_BUF_BASE + STREAM_ZBUF_OFS)
+#define STREAM_ZBUF_SIZE    (sizeof(raw_rsp_header_t) + STREAM_PAYLOAD / 4 * 5)
+
+/* Once the engine stops, the chunk in flight gets this long to see TLAST */
+#define STREAM_DRAIN_US     1000
+
+/* S2MM soft reset normally clears within a few bus cycles */
+#define DMA_RESET_TIMEOUT_US 1000
+
+typedef enum {
+    CHUNK_FREE = 0,                 /* Available for DMA */
+    CHUNK_DMA,                      /* DMA filling */
+    CHUNK_READY,                    /* Filled, waiting for the host */
+    CHUNK_SENDING                   /* Handed to the bulk endpoint */
+} chunk_state_t;
+
+/*
+ * Raw session: one per endpoint set (see RAW_SESSION_EP_*). A session
+ * has its own drive selection, capture statistics and READ_FLUX stream,
+ * so an FDD on each flux interface can stream at the same time. The
+ * BATCH, IMAGE, TAPE_READ and TRACE_DUMP jobs belong to session 0.
+ */
+typedef struct {
+    raw_mode_state_t state;
+
+    /* Capture statistics */
+    uint32_t    sample_count;
+    uint32_t    index_count;
+    uint32_t    overflow_count;
+    uint32_t    start_time;
+
+    uint32_t    buf;                /* Stream buffer base */
+
+    struct {
+        bool        active;             /* READ_FLUX stream open */
+        bool        capture_done;       /* Capture engine stopped */
+        bool        dma_busy;           /* S2MM transfer in flight */
+        bool        end_pending;        /* End frame handed out, not released */
+        bool        draining;           /* Stopped with a chunk still in flight */
+        uint32_t    drain_start;
+        uint8_t     chan;               /* DMA channel = flux interface of the drive */
+        uint8_t     state[STREAM_CHUNKS];
+        uint32_t    len[STREAM_CHUNKS]; /* Bytes incl. header */
+        uint8_t     fill;               /* Next chunk to arm */
+        uint8_t     send;               /* Next chunk to hand out */
+        uint8_t     release;            /* Oldest chunk with the host */
+        uint8_t     format;             /* RAW_FLUX_FMT_* */
+        bool        kf_closed;          /* KryoFlux trailer chunk queued */
+        uint32_t    remaining;          /* Samples still allowed */
+        uint32_t    armed;              /* Bytes the running transfer was armed for */
+        uint8_t     end_frame[sizeof(raw_rsp_header_t) + sizeof(raw_capture_info_t)];
+    } stream;
+
+    kf_stream_t kf;                 /* RAW_FLUX_FMT_KRYOFLUX encoder */
+} raw_session_t;
+
+static raw_session_t sessions[RAW_SESSIONS];
+
+/* Session being serviced; back to session 0 after every session call */
+static raw_session_t *rs = &sessions[0];
+
+static uint8_t rr_next;             /* Session offered the bulk IN first */
+
+/*
+ * BATCH: sub-commands are copied into HyperRAM after the stream buffers,
+ * and their responses accumulate behind a BATCH header for the closing
+ * frame.
+ */
+#define BATCH_BUF_BASE      ((STREAM_ZBUF_BASE + STREAM_CHUNKS * STREAM_ZBUF_SIZE + 0xFFF) & ~0xFFFu)
+#define BATCH_QUEUE         ((raw_cmd_packet_t *)BATCH_BUF_BASE)
+#define BATCH_FRAME         ((uint8_t *)(BATCH_BUF_BASE + RAW_BATCH_MAX_CMDS * RAW_CMD_PACKET_SIZE))
+#define BATCH_RSP_SLOT      64      /* Largest single sub-command response */
+#define BATCH_DATA_MAX      0xFFFF  /* raw_rsp_header_t.data_len */
+
+static struct {
+    bool        active;             /* Batch accepted, not yet closed */
+    bool        frame_ready;        /* Closing frame built */
+    bool        frame_out;          /* Closing frame handed to the host */
+    uint8_t     flags;              /* RAW_BATCH_* */
+    uint8_t     status;             /* First failing sub-command status */
+    uint16_t    count;              /* Sub-commands queued */
+    uint16_t    next;               /* Next sub-command to run */
+    uint32_t    data_len;           /* Response bytes accumulated */
+} batch;
+
+/*
+ * IMAGE: a track range captured as a sequence of READ_FLUX streams.
+ * Once a track's capture has stopped, the seek to the next track runs
+ * while its chunks are still draining to the host. With
+ * RAW_IMAGE_SECTORS the FDC reads the sectors into a frame after the
+ * batch buffers while the DMA captures the flux.
+ */
+#define IMAGE_SECT_BASE     ((BATCH_BUF_BASE + RAW_BATCH_MAX_CMDS * RAW_CMD_PACKET_SIZE + \
+                              sizeof(raw_rsp_header_t) + BATCH_DATA_MAX + 0xFFF) & ~0xFFFu)
+#define IMAGE_SECT_FRAME    ((uint8_t *)IMAGE_SECT_BASE)
+#define IMAGE_SECT_DATA     (IMAGE_SECT_FRAME + sizeof(raw_rsp_header_t) + sizeof(raw_image_sectors_t))
+typedef enum {
+    JOB_SEEK = 0,                   /* Seek issued, waiting for settle */
+    JOB_ARM,                        /* On track, waiting for the stream */
+    JOB_CAPTURE,                    /* Stream open */
+    JOB_DONE,                       /* Waiting to build the closing frame */
+    JOB_CLOSED                      /* Closing frame built */
+} job_phase_t;
+
+static struct {
+    bool        active;             /* Job accepted, not yet closed */
+    bool        frame_ready;        /* IMAGE frame built */
+    bool        frame_out;          /* IMAGE frame handed to the host */
+    bool        sectors;            /* RAW_IMAGE_SECTORS */
+    bool        sect_running;       /* Sector read in progress */
+    bool        sect_pending;       /* Sector frame owed for the last attempt */
+    uint8_t     phase;              /* job_phase_t */
+    uint8_t     status;             /* First failed track status */
+    uint8_t     revolutions;
+    uint8_t     heads;              /* RAW_IMAGE_HEAD* */
+    uint8_t     retries;
+    uint8_t     format;             /* RAW_FLUX_FMT_* */
+    uint8_t     last;               /* Last track */
+    uint8_t     track;              /* Current track side */
+    uint8_t     head;
+    uint8_t     attempt;
+    int         seek_ret;           /* hal_seek_start() result */
+    uint32_t    max_samples;
+    uint16_t    tracks_ok;
+    uint16_t    tracks_failed;
+    uint16_t    retries_used;
+    uint16_t    frame_len;
+    const uint8_t *frame_data;      /* frame or IMAGE_SECT_FRAME */
+    uint8_t     sect_track;         /* Track side of the sector read */
+    uint8_t     sect_head;
+    int         sect_ret;           /* hal_sector_capture_*() result */
+    hal_sector_capture_t sect;
+    uint8_t     frame[sizeof(raw_rsp_header_t) + sizeof(raw_image_done_t)];
+} job;
+
+/*
+ * TRACE_DUMP: the frame is built in the trace readout area, and the
+ * debug port block engine writes the entries straight behind its header.
+ */
+#define TRACE_FRAME         ((uint8_t *)DBG_TRACE_BASE)
+#define TRACE_ENTRIES       (TRACE_FRAME + sizeof(raw_rsp_header_t) + sizeof(raw_trace_info_t))
+#define TRACE_CLOCK_HZ      100000000   /* fluxripper_debug_top CLK_FREQ_HZ */
+
+static struct {
+    bool        frame_ready;        /* TRACE_DUMP frame built */
+    bool        frame_out;          /* TRACE_DUMP frame handed to the host */
+    uint32_t    frame_len;
+} dump;
+
+/*
+ * TAPE_READ: a ring of DDR buffers, one tape segment each. The DMA
+ * writes a segment TAPE_DATA_OFS into its buffer, leaving room for the
+ * frame headers, so the segment goes to the bulk endpoint as one
+ * transfer with no copy. Segments are ordered by tape position so the
+ * ones read again after a restart can be dropped.
+ */
+#define TAPE_BUFS           16
+#define TAPE_DATA_OFS       (sizeof(raw_rsp_header_t) + sizeof(raw_tape_segment_t))
+#define TAPE_BUF_SIZE       (TAPE_DATA_OFS + TAPE_SEG_MAX)
+#define TAPE_BACKUP_SEGS    2       /* Segments backed up before a restart */
+#define TAPE_IDLE_MS        3000    /* Stopped this long: end of tape */
+#define TAPE_MOTION_MS      300000  /* Longest rewind */
+
+typedef enum {
+    TAPE_CMD = 0,                   /* QIC command being sent */
+    TAPE_WAIT,                      /* Waiting for the tape to stop */
+    TAPE_GO,                        /* Start streaming */
+    TAPE_STREAM,                    /* Streaming segments */
+    TAPE_HELD,                      /* Paused until the host catches up */
+    TAPE_BACKUP,                    /* Backing up before the restart */
+    TAPE_END,                       /* Stop the tape */
+    TAPE_DONE,                      /* Waiting to build the closing frame */
+    TAPE_CLOSED                     /* Closing frame built */
+} tape_phase_t;
+
+static struct {
+    bool        active;             /* Job accepted, not yet closed */
+    bool        capturing;          /* Segment capture and DMA running */
+    bool        stop;               /* CAPTURE_STOP received */
+    bool        wait_stop;          /* Wait for the tape to stop after the command */
+    bool        seg_out;            /* Oldest segment handed to the host */
+    bool        frame_ready;        /* Closing frame built */
+    bool        frame_out;          /* Closing frame handed to the host */
+    uint8_t     phase;              /* tape_phase_t */
+    uint8_t     next;               /* Phase after the command */
+    uint8_t     status;             /* First failure */
+    uint8_t     backup;             /* Skips left */
+    uint8_t     q_head;             /* Oldest filled segment */
+    uint8_t     q_count;
+    ddr_buf_t  *q[TAPE_BUFS];       /* Filled segments, tape order */
+    ddr_buf_t  *dma_buf;            /* Segment the DMA is filling */
+    uint32_t    max_segments;       /* 0 = to the end */
+    uint32_t    next_ord;           /* Lowest position still wanted */
+    uint32_t    wait_start;
+    uint32_t    idle_start;
+    uint32_t    segments;
+    uint32_t    blocks;
+    uint16_t    ecc_errors;
+    uint16_t    gaps;
+    uint16_t    repositions;
+    ddr_slab_t  slab;
+    uint8_t     frame[sizeof(raw_rsp_header_t) + sizeof(raw_tape_done_t)];
+} tjob;
 
 /*---------------------------------------------------------------------------
  * Private Functions
@@ -32,8 +254,8 @@ static uint32_t capture_start_time;
 
 static uint32_t get_timestamp_us(void)
 {
-    /* TODO: Implement actual timestamp from timer */
-    return 0;
+    /* Durations are 32-bit; deltas stay valid across the wrap */
+    return (uint32_t)timer_get_us();
 }
 
 static void build_response_header(raw_rsp_header_t *hdr, uint8_t status,
@@ -45,47 +267,583 @@ static void build_response_header(raw_rsp_header_t *hdr, uint8_t status,
     hdr->data_len = data_len;
 }
 
+static inline uint8_t *stream_chunk(uint8_t i)
+{
+    return (uint8_t *)(rs->buf + (uint32_t)i * RAW_FLUX_CHUNK_SIZE);
+}
+
+static inline uint32_t stream_flux_stat_addr(void)
+{
+    return (rs->stream.chan == DRIVE_A) ? FDC_FLUX_STAT_A : FDC_FLUX_STAT_B;
+}
+
+static inline uint8_t *stream_zbuf(uint8_t i)
+{
+    return (uint8_t *)(rs->buf + STREAM_ZBUF_OFS + (uint32_t)i * STREAM_ZBUF_SIZE);
+}
+
+/**
+ * Check whether another session holds an FDD
+ * Tape segments use DMA channel 0, so TAPE_READ holds drive A too.
+ * @return true if the drive is capturing or running a job elsewhere
+ */
+static bool drive_busy_elsewhere(uint8_t drive)
+{
+    if (drive >= MAX_DRIVES) {
+        return false;               /* HDDs: no flux stream to share */
+    }
+
+    for (uint8_t s = 0; s < RAW_SESSIONS; s++) {
+        const raw_session_t *o = &sessions[s];
+
+        if (o == rs) {
+            continue;
+        }
+        if (o->stream.active && o->stream.chan == drive) {
+            return true;
+        }
+        if (o->state.capture_active && o->state.is_fdd &&
+            o->state.selected_drive == drive) {
+            return true;
+        }
+        if (s == 0 && ((job.active && o->state.selected_drive == drive) ||
+                       (tjob.active && (o->state.selected_drive == drive ||
+                                        drive == DRIVE_A)))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline uint8_t *put_varint(uint8_t *p, uint32_t v)
+{
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+/**
+ * Encode flux words as RAW_FLUX_FMT_DELTA tokens
+ * @return Encoded length in bytes
+ */
+static uint32_t flux_encode_delta(const uint32_t *src, uint32_t count, uint8_t *dst)
+{
+    uint8_t *p = dst;
+    uint32_t prev = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t word = src[i];
+        uint32_t ts = FLUX_TIMESTAMP(word);
+        uint32_t delta = (ts - prev) & FLUX_TIMESTAMP_MASK;
+        uint32_t flags = 0;
+
+        prev = ts;
+
+        if (word & (FLUX_FLAG_INDEX | FLUX_FLAG_OVERFLOW | FLUX_FLAG_WEAK)) {
+            if (FLUX_IS_INDEX(word))    flags |= RAW_FLUX_ESC_INDEX;
+            if (FLUX_IS_OVERFLOW(word)) flags |= RAW_FLUX_ESC_OVERFLOW;
+            if (FLUX_IS_WEAK(word))     flags |= RAW_FLUX_ESC_WEAK;
+            *p++ = (uint8_t)((flags << 1) | 1);
+            p = put_varint(p, delta);
+        } else {
+            p = put_varint(p, delta << 1);
+        }
+    }
+
+    return (uint32_t)(p - dst);
+}
+
+static inline bool flux_format_valid(uint8_t format)
+{
+    return format == RAW_FLUX_FMT_RAW32 || format == RAW_FLUX_FMT_DELTA ||
+           format == RAW_FLUX_FMT_KRYOFLUX;
+}
+
+/**
+ * Encode a chunk as the next piece of a RAW_FLUX_FMT_KRYOFLUX stream
+ * @return Encoded length in bytes
+ */
+static uint32_t flux_encode_kf(const uint32_t *src, uint32_t count, uint8_t *dst)
+{
+    uint8_t *p = dst;
+    uint32_t used;
+
+    if (!rs->kf.started) {
+        p += kf_stream_begin(&rs->kf, p);
+    }
+    p += kf_stream_info(&rs->kf, p, (get_timestamp_us() - rs->start_time) / 1000);
+    p += kf_stream_encode(&rs->kf, src, count, p,
+                          STREAM_ZBUF_SIZE - sizeof(raw_rsp_header_t) - (uint32_t)(p - dst),
+                          &used);
+
+    /* Only a pathological chunk (minutes of overflow words) gets here */
+    if (used < count) {
+        rs->overflow_count++;
+    }
+
+    return (uint32_t)(p - dst);
+}
+
+/**
+ * Queue the chunk closing a KryoFlux stream (STREAM_END, EOF)
+ */
+static void stream_close_kf(void)
+{
+    uint8_t i = rs->stream.send;
+    uint8_t *z = stream_zbuf(i);
+    uint32_t len = kf_stream_end(&rs->kf, z + sizeof(raw_rsp_header_t),
+                                 rs->overflow_count ? KF_RESULT_BUFFERING : KF_RESULT_OK);
+
+    build_response_header((raw_rsp_header_t *)z, RAW_RSP_OK, RAW_CMD_READ_FLUX, (uint16_t)len);
+    rs->stream.len[i] = sizeof(raw_rsp_header_t) + len;
+    rs->stream.state[i] = CHUNK_READY;
+    rs->stream.fill = (i + 1) % STREAM_CHUNKS;
+    rs->stream.kf_closed = true;
+}
+
+/**
+ * Soft-reset an S2MM channel and start it again
+ * @return HAL_OK, HAL_ERR_TIMEOUT if the reset never completed
+ */
+static int dma_restart(uint8_t ch)
+{
+    uint32_t start = get_timestamp_us();
+
+    DMA_S2MM_DMACR_CH(ch) = DMA_CR_RESET;
+    while (DMA_S2MM_DMACR_CH(ch) & DMA_CR_RESET) {
+        if (get_timestamp_us() - start > DMA_RESET_TIMEOUT_US) {
+            return HAL_ERR_TIMEOUT;
+        }
+    }
+    DMA_S2MM_DMACR_CH(ch) = DMA_CR_RS | DMA_CR_IOC_IRQ_EN | DMA_CR_ERR_IRQ_EN;
+    return HAL_OK;
+}
+
+/**
+ * Arm the DMA on the next chunk if it is free
+ */
+static void stream_arm(void)
+{
+    uint8_t i = rs->stream.fill;
+    uint32_t len;
+
+    if (rs->stream.dma_busy || rs->stream.capture_done ||
+        rs->stream.state[i] != CHUNK_FREE || rs->stream.remaining == 0) {
+        return;
+    }
+
+    len = STREAM_PAYLOAD;
+    if (rs->stream.remaining < len / sizeof(uint32_t)) {
+        len = rs->stream.remaining * sizeof(uint32_t);
+    }
+
+    rs->stream.state[i] = CHUNK_DMA;
+    rs->stream.dma_busy = true;
+    rs->stream.armed = len;
+
+    DMA_S2MM_DA_CH(rs->stream.chan) = (uint32_t)(stream_chunk(i) + sizeof(raw_rsp_header_t));
+    DMA_S2MM_LENGTH_CH(rs->stream.chan) = len;  /* Starts the transfer */
+}
+
+/**
+ * Flux capture completion (from hal_flux_capture_irq; stream_service()
+ * also polls FLUX_STAT_DONE, so this is not relied on)
+ */
+static void stream_capture_cb(uint8_t drive, const uint32_t *data,
+                              uint32_t length, bool done)
+{
+    (void)data;
+    (void)length;
+
+    if (!done) {
+        return;
+    }
+
+    /* May run in interrupt context: find the stream by its drive */
+    for (uint8_t s = 0; s < RAW_SESSIONS; s++) {
+        if (sessions[s].stream.active && sessions[s].stream.chan == drive) {
+            sessions[s].stream.capture_done = true;
+        }
+    }
+}
+
+/**
+ * Build the CAPTURE_STOP frame that closes a stream
+ */
+static void stream_build_end(void)
+{
+    raw_rsp_header_t *hdr = (raw_rsp_header_t *)rs->stream.end_frame;
+    raw_capture_info_t *info =
+        (raw_capture_info_t *)(rs->stream.end_frame + sizeof(raw_rsp_header_t));
+
+    build_response_header(hdr,
+                          rs->overflow_count ? RAW_RSP_ERR_OVERFLOW : RAW_RSP_OK,
+                          RAW_CMD_CAPTURE_STOP, sizeof(raw_capture_info_t));
+
+    info->sample_count = rs->sample_count;
+    info->index_count = rs->index_count;
+    info->overflow_count = rs->overflow_count;
+    info->duration_us = get_timestamp_us() - rs->start_time;
+}
+
+/**
+ * Reset the capture statistics and start the DMA for a new stream
+ * @return HAL_OK, HAL_ERR_TIMEOUT if the DMA would not reset (stream
+ *         left open for stream_cancel())
+ */
+static int stream_open(uint8_t format, uint32_t max_samples)
+{
+    memset(&rs->stream, 0, sizeof(rs->stream));
+    rs->stream.active = true;
+    rs->stream.chan = rs->state.selected_drive;
+    rs->stream.format = format;
+    rs->stream.remaining = max_samples;
+    kf_stream_init(&rs->kf);
+
+    rs->sample_count = 0;
+    rs->index_count = 0;
+    rs->overflow_count = 0;
+    rs->start_time = get_timestamp_us();
+
+    /* DMA first, so the capture FIFO drains from the first transition */
+    int ret = dma_restart(rs->stream.chan);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+    stream_arm();
+    return HAL_OK;
+}
+
+/**
+ * Abandon a stream whose capture could not be started
+ */
+static void stream_cancel(void)
+{
+    DMA_S2MM_DMACR_CH(rs->stream.chan) = DMA_CR_RESET;
+    rs->stream.active = false;
+}
+
+/**
+ * Build the IMAGE frame announcing the current attempt
+ */
+static void job_frame_track(uint8_t status)
+{
+    raw_image_track_t *t = (raw_image_track_t *)(job.frame + sizeof(raw_rsp_header_t));
+
+    build_response_header((raw_rsp_header_t *)job.frame, status, RAW_CMD_IMAGE,
+                          sizeof(raw_image_track_t));
+    t->kind = RAW_IMAGE_FRAME_TRACK;
+    t->track = job.track;
+    t->head = job.head;
+    t->attempt = job.attempt;
+
+    job.frame_len = sizeof(raw_rsp_header_t) + sizeof(raw_image_track_t);
+    job.frame_data = job.frame;
+    job.frame_ready = true;
+}
+
+/**
+ * Start reading the sectors of the attempt just armed
+ */
+static void job_sectors_start(void)
+{
+    memset(&job.sect, 0, sizeof(job.sect));
+    job.sect_track = job.track;
+    job.sect_head = job.head;
+    job.sect_ret = hal_sector_capture_start(rs->state.selected_drive, job.head,
+                                            IMAGE_SECT_DATA);
+    job.sect_running = (job.sect_ret == HAL_OK);
+    job.sect_pending = true;
+}
+
+static void job_sectors_poll(void)
+{
+    job.sect_ret = hal_sector_capture_poll(&job.sect);
+    if (job.sect_ret != HAL_ERR_BUSY) {
+        job.sect_running = false;
+    }
+}
+
+/**
+ * Build the IMAGE frame carrying the sectors of the last attempt
+ */
+static void job_frame_sectors(void)
+{
+    raw_image_sectors_t *t =
+        (raw_image_sectors_t *)(IMAGE_SECT_FRAME + sizeof(raw_rsp_header_t));
+    uint16_t len = (uint16_t)(sizeof(raw_image_sectors_t) +
+                              job.sect.sectors * FDC_SECTOR_SIZE);
+    uint8_t status = RAW_RSP_OK;
+
+    if (job.sect.sectors == 0) {
+        status = RAW_RSP_ERR_NOT_READY;
+    } else if (job.sect.bad != 0) {
+        status = RAW_RSP_ERR_CRC;
+    }
+
+    build_response_header((raw_rsp_header_t *)IMAGE_SECT_FRAME, status,
+                          RAW_CMD_IMAGE, len);
+    t->kind = RAW_IMAGE_FRAME_SECTORS;
+    t->track = job.sect_track;
+    t->head = job.sect_head;
+    t->sectors = job.sect.sectors;
+    t->bad_mask = job.sect.bad_mask;
+
+    job.frame_len = (uint16_t)(sizeof(raw_rsp_header_t) + len);
+    job.frame_data = IMAGE_SECT_FRAME;
+    job.frame_ready = true;
+    job.sect_pending = false;
+}
+
+static void job_seek(void)
+{
+    job.seek_ret = hal_seek_start(rs->state.selected_drive, job.track);
+    job.phase = JOB_SEEK;
+}
+
+static void job_fail(uint8_t status)
+{
+    job.tracks_failed++;
+    if (job.status == RAW_RSP_OK) {
+        job.status = status;
+    }
+}
+
+/**
+ * Move on to the next track side, seeking if the cylinder changes
+ */
+static void job_advance(void)
+{
+    job.attempt = 0;
+
+    if (job.head == 0 && (job.heads & RAW_IMAGE_HEAD1)) {
+        job.head = 1;
+        job.phase = JOB_ARM;
+        return;
+    }
+
+    if (job.track >= job.last) {
+        job.phase = JOB_DONE;
+        return;
+    }
+
+    job.track++;
+    job.head = (job.heads & RAW_IMAGE_HEAD0) ? 0 : 1;
+    job_seek();
+}
+
+static void tjob_fail(uint8_t status)
+{
+    if (tjob.status == RAW_RSP_OK) {
+        tjob.status = status;
+    }
+}
+
+/**
+ * Send a QIC command, then go to next (after the tape stops if wait_stop)
+ */
+static void tjob_cmd(uint8_t cmd, bool wait_stop, uint8_t next)
+{
+    if (tape_cmd_start(cmd) != HAL_OK) {
+        tjob_fail(RAW_RSP_ERR_NOT_READY);
+        tjob.phase = (next == TAPE_DONE) ? TAPE_DONE : TAPE_END;
+        return;
+    }
+
+    tjob.wait_stop = wait_stop;
+    tjob.next = next;
+    tjob.phase = TAPE_CMD;
+}
+
+/**
+ * Arm the DMA on a free ring buffer
+ * @return false if the ring is full
+ */
+static bool tjob_arm(void)
+{
+    if (!tjob.capturing || tjob.dma_buf != NULL) {
+        return true;
+    }
+
+    tjob.dma_buf = ddr_slab_alloc(&tjob.slab);
+    if (tjob.dma_buf == NULL) {
+        return false;
+    }
+
+    DMA_S2MM_DA = tjob.dma_buf->addr + TAPE_DATA_OFS;
+    DMA_S2MM_LENGTH = TAPE_SEG_MAX;     /* Ends at the segment trailer */
+    return true;
+}
+
+/**
+ * Start the DMA and segment capture
+ * @return false if the DMA would not reset
+ */
+static bool tjob_capture_start(void)
+{
+    if (dma_restart(0) != HAL_OK) {
+        return false;
+    }
+
+    tjob.capturing = true;
+    tjob_arm();
+    tape_seg_start(false);
+    return true;
+}
+
+/**
+ * Stop capture; the segment being filled is dropped
+ */
+static void tjob_capture_stop(void)
+{
+    tape_seg_stop();
+    DMA_S2MM_DMACR = DMA_CR_RESET;
+
+    ddr_release(tjob.dma_buf);
+    tjob.dma_buf = NULL;
+    tjob.capturing = false;
+}
+
+/**
+ * Frame a completed segment and queue it, or drop it if already sent
+ */
+static void tjob_frame_segment(ddr_buf_t *buf, uint32_t bytes)
+{
+    uint8_t *frame = (uint8_t *)buf->addr;
+    const uint8_t *data = frame + TAPE_DATA_OFS;
+    raw_tape_segment_t *s = (raw_tape_segment_t *)(frame + sizeof(raw_rsp_header_t));
+    uint32_t records = (bytes >= 4) ? (bytes - 4) / TAPE_RECORD_BYTES : 0;
+    uint32_t trailer = (bytes >= 4) ? *(const uint32_t *)(data + bytes - 4) : 0;
+    uint8_t ecc = 0;
+    bool gap = false;
+    uint8_t track;
+
+    if (!(trailer & TAPE_REC_TRAILER) || records == 0) {
+        ddr_release(buf);
+        return;
+    }
+
+    /* Odd tracks run in reverse: order by distance along the track */
+    uint16_t segment = (uint16_t)TAPE_REC_SEGMENT(trailer);
+    tape_position(&track, NULL);
+    uint32_t ord = ((uint32_t)track << 16) | ((track & 1) ? 0xFFFFu - segment : segment);
+
+    if (ord < tjob.next_ord) {
+        ddr_release(buf);
+        return;
+    }
+    tjob.next_ord = ord + 1;
+
+    for (uint32_t i = 0; i < records; i++) {
+        uint32_t st = *(const uint32_t *)(data + i * TAPE_RECORD_BYTES + TAPE_BLOCK_BYTES);
+
+        if (st & TAPE_REC_ECC) {
+            ecc++;
+        }
+        if (st & TAPE_REC_GAP) {
+            gap = true;
+        }
+    }
+
+    build_response_header((raw_rsp_header_t *)frame,
+                          ecc ? RAW_RSP_ERR_CRC : RAW_RSP_OK, RAW_CMD_TAPE_READ,
+                          (uint16_t)(sizeof(raw_tape_segment_t) + records * TAPE_RECORD_BYTES));
+    s->kind = RAW_TAPE_FRAME_SEGMENT;
+    s->track = track;
+    s->segment = segment;
+    s->blocks = (uint8_t)records;
+    s->ecc_errors = ecc;
+    s->flags = gap ? RAW_TAPE_SEG_GAP : 0;
+    s->reserved = 0;
+
+    tjob.q[(tjob.q_head + tjob.q_count) % TAPE_BUFS] = buf;
+    tjob.q_count++;
+
+    tjob.segments++;
+    tjob.blocks += records;
+    tjob.ecc_errors += ecc;
+    if (gap) {
+        tjob.gaps++;
+    }
+    if (ecc) {
+        tjob_fail(RAW_RSP_ERR_CRC);
+    }
+}
+
+static void tjob_dma_poll(void)
+{
+    uint32_t sr = DMA_S2MM_DMASR;
+
+    if (tjob.dma_buf == NULL) {
+        return;
+    }
+
+    if (sr & DMA_SR_ERR_IRQ) {
+        DMA_S2MM_DMASR = DMA_SR_ERR_IRQ;
+        tjob_capture_stop();
+        tjob_fail(RAW_RSP_ERR_OVERFLOW);
+        tjob.stop = true;
+    } else if (sr & DMA_SR_IOC_IRQ) {
+        ddr_buf_t *buf = tjob.dma_buf;
+        uint32_t bytes = DMA_S2MM_LENGTH;
+
+        DMA_S2MM_DMASR = DMA_SR_IOC_IRQ;
+        tjob.dma_buf = NULL;
+
+        tjob_frame_segment(buf, bytes);
+        tjob_arm();
+    }
+}
+
 /*---------------------------------------------------------------------------
  * Public Functions - Initialization
  *---------------------------------------------------------------------------*/
 
 int raw_mode_init(void)
 {
-    memset(&raw_state, 0, sizeof(raw_state));
-
-    raw_state.selected_drive = 0;
-    raw_state.is_fdd = true;
-    raw_state.capture_active = false;
+    memset(sessions, 0, sizeof(sessions));
+
+    /* Each session starts on the FDD of its own flux interface */
+    for (uint8_t s = 0; s < RAW_SESSIONS; s++) {
+        sessions[s].state.selected_drive = s;
+        sessions[s].state.is_fdd = true;
+        sessions[s].buf = STREAM_BUF_BASE + (uint32_t)s * STREAM_SESSION_SPAN;
+        sessions[s].state.initialized = true;
+    }
+    rs = &sessions[0];
+    rr_next = 0;
 
-    capture_sample_count = 0;
-    capture_index_count = 0;
-    capture_overflow_count = 0;
-    capture_start_time = 0;
+    memset(&batch, 0, sizeof(batch));
+    memset(&job, 0, sizeof(job));
+    memset(&dump, 0, sizeof(dump));
+    memset(&tjob, 0, sizeof(tjob));
 
-    raw_state.initialized = true;
     return 0;
 }
 
 void raw_mode_reset(void)
 {
-    /* Stop any active capture */
-    if (raw_state.capture_active) {
-        raw_mode_capture_stop();
-    }
+    for (uint8_t s = 0; s < RAW_SESSIONS; s++) {
+        raw_mode_state_t *st = &sessions[s].state;
 
-    /* Turn off motor */
-    if (raw_state.is_fdd) {
-        hal_motor_off(raw_state.selected_drive);
-    }
+        /* Stop any active capture */
+        st->capture_active = false;
 
-    raw_state.capture_active = false;
+        /* Let the motor idle out; a new session on this drive reuses it */
+        if (st->is_fdd) {
+            hal_motor_release(st->selected_drive);
+        }
+    }
 }
 
 /*---------------------------------------------------------------------------
  * Public Functions - Command Processing
  *---------------------------------------------------------------------------*/
 
-int raw_mode_process_command(const raw_cmd_packet_t *cmd,
+static int raw_mode_dispatch(const raw_cmd_packet_t *cmd, uint32_t cmd_len,
                              uint8_t *response, uint32_t *response_len)
 {
     raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
@@ -94,6 +852,13 @@ int raw_mode_process_command(const raw_cmd_packet_t *cmd,
         return -1;
     }
 
+    /* Short packet: not even the opcode can be trusted */
+    if (cmd_len < RAW_CMD_PACKET_SIZE) {
+        build_response_header(hdr, RAW_RSP_ERR_INVALID_CMD, RAW_CMD_NOP, 0);
+        *response_len = sizeof(raw_rsp_header_t);
+        return -1;
+    }
+
     /* Validate signature */
     if (cmd->signature != RAW_SIGNATURE) {
         build_response_header(hdr, RAW_RSP_ERR_INVALID_CMD, cmd->opcode, 0);
@@ -101,7 +866,16 @@ int raw_mode_process_command(const raw_cmd_packet_t *cmd,
         return -1;
     }
 
-    raw_state.last_command = cmd->opcode;
+    rs->state.last_command = cmd->opcode;
+
+    /* Jobs and their buffers exist once, on the primary endpoints */
+    if (rs != &sessions[0] &&
+        (cmd->opcode == RAW_CMD_IMAGE || cmd->opcode == RAW_CMD_TAPE_READ ||
+         cmd->opcode == RAW_CMD_BATCH || cmd->opcode == RAW_CMD_TRACE_DUMP)) {
+        build_response_header(hdr, RAW_RSP_ERR_INVALID_CMD, cmd->opcode, 0);
+        *response_len = sizeof(raw_rsp_header_t);
+        return -1;
+    }
 
     switch (cmd->opcode) {
         case RAW_CMD_NOP:
@@ -125,6 +899,10 @@ int raw_mode_process_command(const raw_cmd_packet_t *cmd,
         case RAW_CMD_CAPTURE_STOP:
             return raw_cmd_capture_stop(response, response_len);
 
+        case RAW_CMD_READ_FLUX:
+            return raw_cmd_read_flux(cmd->param1, (uint8_t)cmd->param2, cmd->param3,
+                                     response, response_len);
+
         case RAW_CMD_GET_PLL_STATUS:
             return raw_cmd_get_pll_status(response, response_len);
 
@@ -134,6 +912,18 @@ int raw_mode_process_command(const raw_cmd_packet_t *cmd,
         case RAW_CMD_GET_DRIVE_PROFILE:
             return raw_cmd_get_drive_profile(response, response_len);
 
+        case RAW_CMD_IMAGE:
+            return raw_cmd_image(cmd, response, response_len);
+
+        case RAW_CMD_TAPE_READ:
+            return raw_cmd_tape_read(cmd, response, response_len);
+
+        case RAW_CMD_BATCH:
+            return raw_cmd_batch(cmd, cmd_len, response, response_len);
+
+        case RAW_CMD_TRACE_DUMP:
+            return raw_cmd_trace_dump(response, response_len);
+
         default:
             build_response_header(hdr, RAW_RSP_ERR_INVALID_CMD, cmd->opcode, 0);
             *response_len = sizeof(raw_rsp_header_t);
@@ -141,6 +931,29 @@ int raw_mode_process_command(const raw_cmd_packet_t *cmd,
     }
 }
 
+int raw_mode_process_command(const raw_cmd_packet_t *cmd, uint32_t cmd_len,
+                             uint8_t *response, uint32_t *response_len)
+{
+    return raw_mode_session_command(0, cmd, cmd_len, response, response_len);
+}
+
+int raw_mode_session_command(uint8_t session, const raw_cmd_packet_t *cmd,
+                             uint32_t cmd_len, uint8_t *response,
+                             uint32_t *response_len)
+{
+    if (session >= RAW_SESSIONS) {
+        return -1;
+    }
+
+    PROF_BEGIN(PROF_RAW_CMD);
+    rs = &sessions[session];
+    int ret = raw_mode_dispatch(cmd, cmd_len, response, response_len);
+    rs = &sessions[0];
+    PROF_END(PROF_RAW_CMD);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------
  * Command Handlers
  *---------------------------------------------------------------------------*/
@@ -168,37 +981,40 @@ int raw_cmd_get_info(uint8_t *response, uint32_t *response_len)
     info->max_luns = 4;
     info->max_fdds = 2;
     info->max_hdds = 2;
-    info->reserved1 = 0;
+    info->flux_formats = RAW_FLUX_CAP_RAW32 | RAW_FLUX_CAP_DELTA | RAW_FLUX_CAP_KRYOFLUX;
 
     /* Build status flags */
     info->status_flags = 0;
-    if (raw_state.is_fdd) {
-        if (hal_disk_present(raw_state.selected_drive)) {
+    if (rs->state.is_fdd) {
+        if (hal_disk_present(rs->state.selected_drive)) {
             info->status_flags |= RAW_STATUS_DISK_PRESENT;
         }
-        if (hal_write_protected(raw_state.selected_drive)) {
+        if (hal_write_protected(rs->state.selected_drive)) {
             info->status_flags |= RAW_STATUS_WRITE_PROTECTED;
         }
     } else {
-        if (hal_hdd_is_ready(raw_state.selected_drive)) {
+        if (hal_hdd_is_ready(rs->state.selected_drive)) {
             info->status_flags |= RAW_STATUS_HDD_READY;
         }
     }
-    if (raw_state.capture_active) {
+    if (rs->state.capture_active) {
         info->status_flags |= RAW_STATUS_CAPTURE_ACTIVE;
     }
+    if (rs->overflow_count != 0) {
+        info->status_flags |= RAW_STATUS_CAPTURE_OVERFLOW;
+    }
 
-    info->selected_drive = raw_state.selected_drive;
-    info->drive_type = raw_state.is_fdd ? 0 : 1;
-    info->current_track = raw_state.current_track;
+    info->selected_drive = rs->state.selected_drive;
+    info->drive_type = rs->state.is_fdd ? 0 : 1;
+    info->current_track = rs->state.current_track;
     info->reserved3 = 0;
 
     /* Get capacity */
-    if (raw_state.is_fdd) {
+    if (rs->state.is_fdd) {
         info->capacity = 2880;  /* 1.44MB default */
     } else {
         hdd_geometry_t geom;
-        if (hal_hdd_get_geometry(raw_state.selected_drive, &geom) == HAL_OK) {
+        if (hal_hdd_get_geometry(rs->state.selected_drive, &geom) == HAL_OK) {
             info->capacity = geom.total_sectors;
         } else {
             info->capacity = 0;
@@ -219,10 +1035,17 @@ int raw_cmd_select_drive(uint8_t drive, uint8_t *response, uint32_t *response_le
         return -1;
     }
 
-    raw_state.selected_drive = drive;
-    raw_state.is_fdd = (drive < 2);
+    /* Selecting would move the drive another session is reading */
+    if (drive_busy_elsewhere(drive)) {
+        build_response_header(hdr, RAW_RSP_ERR_BUSY, RAW_CMD_SELECT_DRIVE, 0);
+        *response_len = sizeof(raw_rsp_header_t);
+        return -1;
+    }
+
+    rs->state.selected_drive = drive;
+    rs->state.is_fdd = (drive < 2);
 
-    if (raw_state.is_fdd) {
+    if (rs->state.is_fdd) {
         hal_select_drive(drive);
     }
 
@@ -236,11 +1059,18 @@ int raw_cmd_motor_ctrl(uint8_t on, uint8_t *response, uint32_t *response_len)
 {
     raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
 
-    if (raw_state.is_fdd) {
+    if (rs->state.is_fdd && drive_busy_elsewhere(rs->state.selected_drive)) {
+        build_response_header(hdr, RAW_RSP_ERR_BUSY, RAW_CMD_MOTOR_CTRL, 0);
+        *response_len = sizeof(raw_rsp_header_t);
+        return -1;
+    }
+
+    if (rs->state.is_fdd) {
         if (on) {
-            hal_motor_on(raw_state.selected_drive);
+            hal_motor_on(rs->state.selected_drive);
         } else {
-            hal_motor_off(raw_state.selected_drive);
+            /* Stops after the idle timeout, so back-to-back captures reuse it */
+            hal_motor_release(rs->state.selected_drive);
         }
     }
     /* HDD motors are always on, ignore */
@@ -256,16 +1086,22 @@ int raw_cmd_seek(uint8_t track, uint8_t *response, uint32_t *response_len)
     raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
     int ret;
 
-    if (!raw_state.is_fdd) {
+    if (!rs->state.is_fdd) {
         build_response_header(hdr, RAW_RSP_ERR_INVALID_CMD, RAW_CMD_SEEK, 0);
         *response_len = sizeof(raw_rsp_header_t);
         return -1;
     }
 
-    ret = hal_seek(raw_state.selected_drive, track);
+    if (drive_busy_elsewhere(rs->state.selected_drive)) {
+        build_response_header(hdr, RAW_RSP_ERR_BUSY, RAW_CMD_SEEK, 0);
+        *response_len = sizeof(raw_rsp_header_t);
+        return -1;
+    }
+
+    ret = hal_seek(rs->state.selected_drive, track);
 
     if (ret == HAL_OK) {
-        raw_state.current_track = track;
+        rs->state.current_track = track;
         build_response_header(hdr, RAW_RSP_OK, RAW_CMD_SEEK, 0);
     } else {
         build_response_header(hdr, RAW_RSP_ERR_NOT_READY, RAW_CMD_SEEK, 0);
@@ -279,20 +1115,20 @@ int raw_cmd_capture_start(uint8_t *response, uint32_t *response_len)
 {
     raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
 
-    if (raw_state.capture_active) {
+    if (rs->state.capture_active) {
         build_response_header(hdr, RAW_RSP_ERR_BUSY, RAW_CMD_CAPTURE_START, 0);
         *response_len = sizeof(raw_rsp_header_t);
         return -1;
     }
 
     /* Reset capture statistics */
-    capture_sample_count = 0;
-    capture_index_count = 0;
-    capture_overflow_count = 0;
-    capture_start_time = get_timestamp_us();
+    rs->sample_count = 0;
+    rs->index_count = 0;
+    rs->overflow_count = 0;
+    rs->start_time = get_timestamp_us();
 
     /* Enable capture in RTL (this would be done via register write) */
-    raw_state.capture_active = true;
+    rs->state.capture_active = true;
 
     build_response_header(hdr, RAW_RSP_OK, RAW_CMD_CAPTURE_START, 0);
     *response_len = sizeof(raw_rsp_header_t);
@@ -305,29 +1141,275 @@ int raw_cmd_capture_stop(uint8_t *response, uint32_t *response_len)
     raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
     raw_capture_info_t *info;
 
-    if (!raw_state.capture_active) {
+    if (rs == &sessions[0]) {
+        /* End an IMAGE job after the current track */
+        if (job.active && job.phase != JOB_CLOSED) {
+            job.phase = JOB_DONE;
+        }
+
+        /* End a TAPE_READ job; segments already read still go out */
+        if (tjob.active) {
+            tjob.stop = true;
+        }
+    }
+
+    if (!rs->state.capture_active) {
         build_response_header(hdr, RAW_RSP_OK, RAW_CMD_CAPTURE_STOP, 0);
         *response_len = sizeof(raw_rsp_header_t);
         return 0;
     }
 
     /* Disable capture */
-    raw_state.capture_active = false;
+    rs->state.capture_active = false;
+
+    /* Streaming: stop the engine, the stream closes once drained */
+    if (rs->stream.active) {
+        hal_stop_flux_capture(rs->stream.chan);
+        rs->stream.capture_done = true;
+        raw_mode_stream_poll();
+    }
 
     /* Build response with capture info */
     build_response_header(hdr, RAW_RSP_OK, RAW_CMD_CAPTURE_STOP, sizeof(raw_capture_info_t));
 
     info = (raw_capture_info_t *)(response + sizeof(raw_rsp_header_t));
-    info->sample_count = capture_sample_count;
-    info->index_count = capture_index_count;
-    info->overflow_count = capture_overflow_count;
-    info->duration_us = get_timestamp_us() - capture_start_time;
+    info->sample_count = rs->sample_count;
+    info->index_count = rs->index_count;
+    info->overflow_count = rs->overflow_count;
+    info->duration_us = get_timestamp_us() - rs->start_time;
 
     *response_len = sizeof(raw_rsp_header_t) + sizeof(raw_capture_info_t);
 
     return 0;
 }
 
+int raw_cmd_read_flux(uint8_t revolutions, uint8_t format, uint32_t max_samples,
+                      uint8_t *response, uint32_t *response_len)
+{
+    raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
+    int ret;
+
+    *response_len = sizeof(raw_rsp_header_t);
+
+    if (!rs->state.is_fdd) {
+        build_response_header(hdr, RAW_RSP_ERR_INVALID_CMD, RAW_CMD_READ_FLUX, 0);
+        return -1;
+    }
+
+    if (rs->state.capture_active || rs->stream.active ||
+        (rs == &sessions[0] && (job.active || tjob.active)) ||
+        drive_busy_elsewhere(rs->state.selected_drive)) {
+        build_response_header(hdr, RAW_RSP_ERR_BUSY, RAW_CMD_READ_FLUX, 0);
+        return -1;
+    }
+
+    if (!flux_format_valid(format)) {
+        build_response_header(hdr, RAW_RSP_ERR_INVALID_PARAM, RAW_CMD_READ_FLUX, 0);
+        return -1;
+    }
+
+    if (max_samples == 0 || max_samples > RAW_MAX_FLUX_SAMPLES) {
+        max_samples = RAW_MAX_FLUX_SAMPLES;
+    }
+    if (revolutions == 0) {
+        revolutions = RAW_DEFAULT_CAPTURE_REVS;
+    }
+
+    ret = stream_open(format, max_samples);
+    if (ret == HAL_OK) {
+        ret = hal_start_flux_capture(rs->state.selected_drive, rs->state.current_track,
+                                     revolutions, stream_capture_cb);
+    }
+    if (ret != HAL_OK) {
+        stream_cancel();
+        build_response_header(hdr, RAW_RSP_ERR_NOT_READY, RAW_CMD_READ_FLUX, 0);
+        return ret;
+    }
+
+    rs->state.capture_active = true;
+
+    build_response_header(hdr, RAW_RSP_OK, RAW_CMD_READ_FLUX, 0);
+    return 0;
+}
+
+int raw_cmd_image(const raw_cmd_packet_t *cmd, uint8_t *response,
+                  uint32_t *response_len)
+{
+    raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
+    uint8_t first = (uint8_t)(cmd->param2 & 0xFF);
+    uint8_t last = (uint8_t)(cmd->param2 >> 8);
+    uint8_t heads = (uint8_t)(cmd->param3 & (RAW_IMAGE_HEAD0 | RAW_IMAGE_HEAD1));
+    bool sectors = (cmd->param3 & RAW_IMAGE_SECTORS) != 0;
+    uint8_t format = (uint8_t)(cmd->param3 >> 16);
+
+    *response_len = sizeof(raw_rsp_header_t);
+
+    if (!rs->state.is_fdd) {
+        build_response_header(hdr, RAW_RSP_ERR_INVALID_CMD, RAW_CMD_IMAGE, 0);
+        return -1;
+    }
+
+    if (rs->state.capture_active || rs->stream.active || job.active || tjob.active ||
+        drive_busy_elsewhere(rs->state.selected_drive)) {
+        build_response_header(hdr, RAW_RSP_ERR_BUSY, RAW_CMD_IMAGE, 0);
+        return -1;
+    }
+
+    if (first > last ||
+        !flux_format_valid(format)) {
+        build_response_header(hdr, RAW_RSP_ERR_INVALID_PARAM, RAW_CMD_IMAGE, 0);
+        return -1;
+    }
+
+    memset(&job, 0, sizeof(job));
+    job.active = true;
+    job.status = RAW_RSP_OK;
+    job.revolutions = cmd->param1 ? cmd->param1 : RAW_DEFAULT_CAPTURE_REVS;
+    job.heads = heads ? heads : RAW_IMAGE_HEAD0;
+    job.sectors = sectors;
+    job.retries = (uint8_t)(cmd->param3 >> 8);
+    job.format = format;
+    job.max_samples = cmd->param4;
+    if (job.max_samples == 0 || job.max_samples > RAW_MAX_FLUX_SAMPLES) {
+        job.max_samples = RAW_MAX_FLUX_SAMPLES;
+    }
+    job.last = last;
+    job.track = first;
+    job.head = (job.heads & RAW_IMAGE_HEAD0) ? 0 : 1;
+
+    job_seek();
+
+    build_response_header(hdr, RAW_RSP_OK, RAW_CMD_IMAGE, 0);
+    return 0;
+}
+
+int raw_cmd_tape_read(const raw_cmd_packet_t *cmd, uint8_t *response,
+                      uint32_t *response_len)
+{
+    raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
+    uint8_t unit = cmd->param1 ? cmd->param1 : 1;
+
+    *response_len = sizeof(raw_rsp_header_t);
+
+    if (!rs->state.is_fdd) {
+        build_response_header(hdr, RAW_RSP_ERR_INVALID_CMD, RAW_CMD_TAPE_READ, 0);
+        return -1;
+    }
+
+    if (rs->state.capture_active || rs->stream.active || job.active || tjob.active ||
+        drive_busy_elsewhere(rs->state.selected_drive) || drive_busy_elsewhere(DRIVE_A)) {
+        build_response_header(hdr, RAW_RSP_ERR_BUSY, RAW_CMD_TAPE_READ, 0);
+        return -1;
+    }
+
+    if (unit > TDR_TAPE_SEL_MASK) {
+        build_response_header(hdr, RAW_RSP_ERR_INVALID_PARAM, RAW_CMD_TAPE_READ, 0);
+        return -1;
+    }
+
+    memset(&tjob, 0, sizeof(tjob));
+    ddr_init();
+    if (ddr_slab_init(&tjob.slab, TAPE_BUF_SIZE, TAPE_BUFS) != FLUXSTAT_OK) {
+        build_response_header(hdr, RAW_RSP_ERR_OVERFLOW, RAW_CMD_TAPE_READ, 0);
+        return -1;
+    }
+
+    if (tape_open(rs->state.selected_drive, unit) != HAL_OK) {
+        ddr_slab_destroy(&tjob.slab);
+        build_response_header(hdr, RAW_RSP_ERR_NO_DRIVE, RAW_CMD_TAPE_READ, 0);
+        return -1;
+    }
+
+    tjob.active = true;
+    tjob.status = RAW_RSP_OK;
+    tjob.max_segments = cmd->param3;
+
+    if (cmd->param2 & RAW_TAPE_REWIND) {
+        tjob_cmd(QIC_CMD_SEEK_BOT, true, TAPE_GO);
+    } else {
+        tjob.phase = TAPE_GO;
+    }
+
+    build_response_header(hdr, RAW_RSP_OK, RAW_CMD_TAPE_READ, 0);
+    return 0;
+}
+
+int raw_cmd_batch(const raw_cmd_packet_t *cmd, uint32_t cmd_len,
+                  uint8_t *response, uint32_t *response_len)
+{
+    raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
+    uint16_t count = cmd->param2;
+
+    *response_len = sizeof(raw_rsp_header_t);
+
+    if (batch.active) {
+        build_response_header(hdr, RAW_RSP_ERR_BUSY, RAW_CMD_BATCH, 0);
+        return -1;
+    }
+
+    /* The sub-commands must all have arrived in this transfer */
+    if (count == 0 || count > RAW_BATCH_MAX_CMDS || cmd_len < RAW_CMD_PACKET_SIZE ||
+        (uint32_t)count * RAW_CMD_PACKET_SIZE > cmd_len - RAW_CMD_PACKET_SIZE) {
+        build_response_header(hdr, RAW_RSP_ERR_INVALID_PARAM, RAW_CMD_BATCH, 0);
+        return -1;
+    }
+
+    /* Sub-commands follow the BATCH packet in the same transfer */
+    memcpy(BATCH_QUEUE, cmd + 1, (uint32_t)count * RAW_CMD_PACKET_SIZE);
+
+    memset(&batch, 0, sizeof(batch));
+    batch.active = true;
+    batch.flags = cmd->param1;
+    batch.count = count;
+    batch.status = RAW_RSP_OK;
+
+    build_response_header(hdr, RAW_RSP_OK, RAW_CMD_BATCH, 0);
+    return 0;
+}
+
+int raw_cmd_trace_dump(uint8_t *response, uint32_t *response_len)
+{
+    raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
+    raw_rsp_header_t *frame = (raw_rsp_header_t *)TRACE_FRAME;
+    raw_trace_info_t *info = (raw_trace_info_t *)(TRACE_FRAME + sizeof(raw_rsp_header_t));
+    uint32_t count;
+    bool triggered, wrapped;
+
+    *response_len = sizeof(raw_rsp_header_t);
+
+    if (rs->stream.active || batch.active || job.active || tjob.active || dump.frame_ready) {
+        build_response_header(hdr, RAW_RSP_ERR_BUSY, RAW_CMD_TRACE_DUMP, 0);
+        return -1;
+    }
+
+    dbg_trace_status(&count, &triggered, &wrapped);
+
+    int got = dbg_trace_read_block(0, count, (uint32_t *)TRACE_ENTRIES);
+    if (got < 0) {
+        build_response_header(hdr, got == DBG_ERR_TIMEOUT ? RAW_RSP_ERR_TIMEOUT :
+                                   RAW_RSP_ERR_NOT_READY, RAW_CMD_TRACE_DUMP, 0);
+        return -1;
+    }
+
+    info->magic = RAW_TRACE_MAGIC;
+    info->version = RAW_TRACE_VERSION;
+    info->flags = (wrapped ? RAW_TRACE_WRAPPED : 0) |
+                  (triggered ? RAW_TRACE_TRIGGERED : 0);
+    info->count = (uint16_t)got;
+    info->trigger_pos = triggered ? (uint16_t)dbg_trace_trigger_index() : 0;
+    info->entry_size = sizeof(raw_trace_entry_t);
+    info->clock_hz = TRACE_CLOCK_HZ;
+
+    dump.frame_len = sizeof(raw_rsp_header_t) + sizeof(raw_trace_info_t) +
+                     (uint32_t)got * sizeof(raw_trace_entry_t);
+    build_response_header(frame, RAW_RSP_OK, RAW_CMD_TRACE_DUMP,
+                          (uint16_t)(dump.frame_len - sizeof(raw_rsp_header_t)));
+    dump.frame_ready = true;
+
+    build_response_header(hdr, RAW_RSP_OK, RAW_CMD_TRACE_DUMP, 0);
+    return 0;
+}
+
 int raw_cmd_get_pll_status(uint8_t *response, uint32_t *response_len)
 {
     raw_rsp_header_t *hdr = (raw_rsp_header_t *)response;
@@ -385,14 +1467,14 @@ int raw_cmd_get_drive_profile(uint8_t *response, uint32_t *response_len)
     profile = (raw_drive_profile_t *)(response + sizeof(raw_rsp_header_t));
     geom = (raw_fdd_geometry_t *)(response + sizeof(raw_rsp_header_t) + sizeof(raw_drive_profile_t));
 
-    profile->drive_num = raw_state.selected_drive;
-    profile->drive_type = raw_state.is_fdd ? 0 : 1;
+    profile->drive_num = rs->state.selected_drive;
+    profile->drive_type = rs->state.is_fdd ? 0 : 1;
 
-    if (raw_state.is_fdd) {
-        profile->disk_present = hal_disk_present(raw_state.selected_drive);
-        profile->write_protected = hal_write_protected(raw_state.selected_drive);
-        profile->at_track0 = hal_track0(raw_state.selected_drive);
-        profile->current_track = raw_state.current_track;
+    if (rs->state.is_fdd) {
+        profile->disk_present = hal_disk_present(rs->state.selected_drive);
+        profile->write_protected = hal_write_protected(rs->state.selected_drive);
+        profile->at_track0 = hal_track0(rs->state.selected_drive);
+        profile->current_track = rs->state.current_track;
         profile->capacity = 2880;  /* 1.44MB */
         profile->block_size = 512;
 
@@ -404,13 +1486,13 @@ int raw_cmd_get_drive_profile(uint8_t *response, uint32_t *response_len)
     } else {
         hdd_geometry_t hdd_geom;
 
-        profile->disk_present = hal_hdd_is_ready(raw_state.selected_drive);
+        profile->disk_present = hal_hdd_is_ready(rs->state.selected_drive);
         profile->write_protected = 0;
         profile->at_track0 = 0;
         profile->current_track = 0;
         profile->block_size = 512;
 
-        if (hal_hdd_get_geometry(raw_state.selected_drive, &hdd_geom) == HAL_OK) {
+        if (hal_hdd_get_geometry(rs->state.selected_drive, &hdd_geom) == HAL_OK) {
             profile->capacity = hdd_geom.total_sectors;
         } else {
             profile->capacity = 0;
@@ -436,28 +1518,28 @@ int raw_cmd_get_drive_profile(uint8_t *response, uint32_t *response_len)
 
 int raw_mode_capture_start(void)
 {
-    if (raw_state.capture_active) {
+    if (rs->state.capture_active) {
         return -1;
     }
 
-    capture_sample_count = 0;
-    capture_index_count = 0;
-    capture_overflow_count = 0;
-    capture_start_time = get_timestamp_us();
+    rs->sample_count = 0;
+    rs->index_count = 0;
+    rs->overflow_count = 0;
+    rs->start_time = get_timestamp_us();
 
-    raw_state.capture_active = true;
+    rs->state.capture_active = true;
     return 0;
 }
 
 int raw_mode_capture_stop(void)
 {
-    raw_state.capture_active = false;
+    rs->state.capture_active = false;
     return 0;
 }
 
 bool raw_mode_is_capturing(void)
 {
-    return raw_state.capture_active;
+    return rs->state.capture_active;
 }
 
 int raw_mode_get_capture_info(raw_capture_info_t *info)
@@ -466,28 +1548,733 @@ int raw_mode_get_capture_info(raw_capture_info_t *info)
         return -1;
     }
 
-    info->sample_count = capture_sample_count;
-    info->index_count = capture_index_count;
-    info->overflow_count = capture_overflow_count;
-    info->duration_us = get_timestamp_us() - capture_start_time;
+    info->sample_count = rs->sample_count;
+    info->index_count = rs->index_count;
+    info->overflow_count = rs->overflow_count;
+    info->duration_us = get_timestamp_us() - rs->start_time;
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------
+ * Batch Execution
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Run queued sub-commands until the batch ends or one opens a stream
+ */
+static void batch_run(void)
+{
+    while (batch.active && !batch.frame_ready && !rs->stream.active && !job.active &&
+           !tjob.active && batch.next < batch.count) {
+        const raw_cmd_packet_t *sub = &BATCH_QUEUE[batch.next++];
+        uint8_t *out = BATCH_FRAME + sizeof(raw_rsp_header_t) + batch.data_len;
+        raw_rsp_header_t *sub_hdr = (raw_rsp_header_t *)out;
+        uint32_t len = 0;
+
+        if (batch.data_len + BATCH_RSP_SLOT > BATCH_DATA_MAX) {
+            batch.status = RAW_RSP_ERR_OVERFLOW;
+            batch.next = batch.count;
+            break;
+        }
+
+        if (sub->opcode == RAW_CMD_BATCH) {
+            build_response_header(sub_hdr, RAW_RSP_ERR_INVALID_CMD, RAW_CMD_BATCH, 0);
+            len = sizeof(raw_rsp_header_t);
+        } else {
+            raw_mode_process_command(sub, RAW_CMD_PACKET_SIZE, out, &len);
+        }
+
+        batch.data_len += len;
+
+        if (sub_hdr->status != RAW_RSP_OK) {
+            if (batch.status == RAW_RSP_OK) {
+                batch.status = sub_hdr->status;
+            }
+            if (batch.flags & RAW_BATCH_STOP_ON_ERROR) {
+                batch.next = batch.count;
+            }
+        }
+    }
+
+    if (batch.active && !batch.frame_ready && !rs->stream.active && !job.active &&
+        !tjob.active && batch.next >= batch.count) {
+        build_response_header((raw_rsp_header_t *)BATCH_FRAME, batch.status,
+                              RAW_CMD_BATCH, (uint16_t)batch.data_len);
+        batch.frame_ready = true;
+    }
+}
+
+bool raw_mode_batch_active(void)
+{
+    return batch.active;
+}
+
+/*---------------------------------------------------------------------------
+ * Image Job
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Advance the IMAGE job as far as the stream and the seek allow
+ */
+static void job_run(void)
+{
+    uint8_t drive = rs->state.selected_drive;
+    uint8_t phase;
+
+    /* The sector frame follows its attempt's stream */
+    if (job.sect_pending && !job.sect_running && !rs->stream.active && !job.frame_ready) {
+        job_frame_sectors();
+    }
+
+    do {
+        phase = job.phase;
+
+        switch (job.phase) {
+            case JOB_SEEK: {
+                int ret = job.seek_ret;
+
+                if (ret == HAL_OK) {
+                    ret = hal_seek_poll(drive);
+                }
+                if (ret == HAL_ERR_BUSY) {
+                    break;
+                }
+                if (ret == HAL_OK) {
+                    rs->state.current_track = job.track;
+                    job.phase = JOB_ARM;
+                    break;
+                }
+                if (job.attempt < job.retries) {
+                    job.attempt++;
+                    job.retries_used++;
+                    job_seek();
+                    break;
+                }
+                /* Report after the previous track's stream; both sides
+                 * of an unreachable cylinder are lost */
+                if (!rs->stream.active && !job.frame_ready && !job.sect_pending) {
+                    job_frame_track(RAW_RSP_ERR_NOT_READY);
+                    job_fail(RAW_RSP_ERR_NOT_READY);
+                    if (job.head == 0 && (job.heads & RAW_IMAGE_HEAD1)) {
+                        job_fail(RAW_RSP_ERR_NOT_READY);
+                        job.head = 1;
+                    }
+                    job_advance();
+                }
+                break;
+            }
+
+            case JOB_ARM:
+                if (rs->stream.active || job.frame_ready || job.sect_pending) {
+                    break;
+                }
+                if (stream_open(job.format, job.max_samples) != HAL_OK ||
+                    hal_arm_flux_capture(drive, job.head, job.revolutions,
+                                         stream_capture_cb) != HAL_OK) {
+                    stream_cancel();
+                    job_frame_track(RAW_RSP_ERR_NOT_READY);
+                    job_fail(RAW_RSP_ERR_NOT_READY);
+                    job_advance();
+                    break;
+                }
+                rs->state.capture_active = true;
+                if (job.sectors) {
+                    job_sectors_start();
+                }
+                job_frame_track(RAW_RSP_OK);
+                job.phase = JOB_CAPTURE;
+                break;
+
+            case JOB_CAPTURE:
+                /* Decide as soon as the engine (and the sector read, which
+                 * owns the FDC until done) stops, so the seek overlaps the
+                 * drain */
+                if (!rs->stream.capture_done || job.sect_running) {
+                    break;
+                }
+                if (rs->overflow_count != 0 && job.attempt < job.retries) {
+                    job.attempt++;
+                    job.retries_used++;
+                    job.phase = JOB_ARM;
+                    break;
+                }
+                if (rs->overflow_count != 0) {
+                    job_fail(RAW_RSP_ERR_OVERFLOW);
+                } else {
+                    job.tracks_ok++;
+                }
+                job_advance();
+                break;
+
+            case JOB_DONE: {
+                raw_image_done_t *d =
+                    (raw_image_done_t *)(job.frame + sizeof(raw_rsp_header_t));
+
+                if (rs->stream.active || job.frame_ready || job.sect_pending) {
+                    break;
+                }
+                build_response_header((raw_rsp_header_t *)job.frame, job.status,
+                                      RAW_CMD_IMAGE, sizeof(raw_image_done_t));
+                d->kind = RAW_IMAGE_FRAME_DONE;
+                d->reserved = 0;
+                d->tracks_ok = job.tracks_ok;
+                d->tracks_failed = job.tracks_failed;
+                d->retries = job.retries_used;
+                job.frame_len = sizeof(raw_rsp_header_t) + sizeof(raw_image_done_t);
+                job.frame_data = job.frame;
+                job.frame_ready = true;
+                job.phase = JOB_CLOSED;
+                break;
+            }
+
+            default:
+                break;
+        }
+    } while (job.phase != phase);
+}
+
+bool raw_mode_image_active(void)
+{
+    return job.active;
+}
+
+/*---------------------------------------------------------------------------
+ * Tape Job
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Advance the TAPE_READ job: keep the DMA on the next segment, and stop
+ * and back up the drive only when the host has let the ring fill
+ */
+static void tjob_run(void)
+{
+    uint32_t now = timer_get_ms();
+    uint8_t track;
+    uint8_t phase;
+
+    if (tjob.capturing) {
+        tjob_dma_poll();
+    }
+
+    do {
+        phase = tjob.phase;
+
+        switch (tjob.phase) {
+            case TAPE_CMD: {
+                int ret = tape_cmd_poll();
+
+                if (ret == HAL_ERR_BUSY) {
+                    break;
+                }
+                if (ret != HAL_OK) {
+                    tjob_fail(RAW_RSP_ERR_TIMEOUT);
+                    tjob.phase = (tjob.next == TAPE_DONE) ? TAPE_DONE : TAPE_END;
+                    break;
+                }
+                tjob.wait_start = now;
+                tjob.phase = tjob.wait_stop ? TAPE_WAIT : tjob.next;
+                break;
+            }
+
+            case TAPE_WAIT:
+                if (tape_busy()) {
+                    if ((now - tjob.wait_start) >= TAPE_MOTION_MS) {
+                        tjob_fail(RAW_RSP_ERR_TIMEOUT);
+                        tjob.phase = (tjob.next == TAPE_DONE) ? TAPE_DONE : TAPE_END;
+                    }
+                    break;
+                }
+                tjob.phase = tjob.next;
+                break;
+
+            case TAPE_GO:
+                if (tjob.stop) {
+                    tjob.phase = TAPE_END;
+                    break;
+                }
+                /* Capture first, so the first segment is read whole */
+                if (!tjob_capture_start()) {
+                    tjob_fail(RAW_RSP_ERR_TIMEOUT);
+                    tjob.phase = TAPE_END;
+                    break;
+                }
+                tjob.idle_start = now;
+                tape_position(&track, NULL);
+                tjob_cmd((track & 1) ? QIC_CMD_LOGICAL_REV : QIC_CMD_LOGICAL_FWD,
+                         false, TAPE_STREAM);
+                break;
+
+            case TAPE_STREAM:
+                if (tjob.stop ||
+                    (tjob.max_segments != 0 && tjob.segments >= tjob.max_segments)) {
+                    tjob.phase = TAPE_END;
+                    break;
+                }
+                if (!tjob_arm()) {
+                    /* Ring full: stop before the drive outruns the banks */
+                    tjob_capture_stop();
+                    tjob.repositions++;
+                    tjob_cmd(QIC_CMD_PAUSE, true, TAPE_HELD);
+                    break;
+                }
+                /* The drive stops by itself after the last track */
+                if (tape_busy() || tape_streaming()) {
+                    tjob.idle_start = now;
+                } else if ((now - tjob.idle_start) >= TAPE_IDLE_MS) {
+                    tjob.phase = TAPE_END;
+                }
+                break;
+
+            case TAPE_HELD:
+                if (tjob.stop) {
+                    tjob.phase = TAPE_END;
+                    break;
+                }
+                if (tjob.slab.count - tjob.slab.in_use < TAPE_BUFS / 2) {
+                    break;
+                }
+                tjob.backup = TAPE_BACKUP_SEGS;
+                tjob.phase = TAPE_BACKUP;
+                break;
+
+            case TAPE_BACKUP:
+                if (tjob.backup == 0) {
+                    tjob.phase = TAPE_GO;
+                    break;
+                }
+                tjob.backup--;
+                /* Against the direction of travel on this track */
+                tape_position(&track, NULL);
+                tjob_cmd((track & 1) ? QIC_CMD_SKIP_FWD_SEG : QIC_CMD_SKIP_REV_SEG,
+                         true, TAPE_BACKUP);
+                break;
+
+            case TAPE_END:
+                if (tjob.capturing) {
+                    tjob_capture_stop();
+                }
+                tjob_cmd(QIC_CMD_STOP, true, TAPE_DONE);
+                break;
+
+            case TAPE_DONE: {
+                raw_tape_done_t *d =
+                    (raw_tape_done_t *)(tjob.frame + sizeof(raw_rsp_header_t));
+
+                if (tjob.q_count != 0) {
+                    break;
+                }
+                build_response_header((raw_rsp_header_t *)tjob.frame, tjob.status,
+                                      RAW_CMD_TAPE_READ, sizeof(raw_tape_done_t));
+                d->kind = RAW_TAPE_FRAME_DONE;
+                d->reserved = 0;
+                d->repositions = tjob.repositions;
+                d->segments = tjob.segments;
+                d->blocks = tjob.blocks;
+                d->ecc_errors = tjob.ecc_errors;
+                d->gaps = tjob.gaps;
+                tjob.frame_ready = true;
+                tjob.phase = TAPE_CLOSED;
+                break;
+            }
+
+            default:
+                break;
+        }
+    } while (tjob.phase != phase);
+}
+
+bool raw_mode_tape_active(void)
+{
+    return tjob.active;
+}
+
+/*---------------------------------------------------------------------------
+ * Flux Streaming
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Service the current session's flux DMA
+ */
+static void stream_service(void)
+{
+    uint8_t ch = rs->stream.chan;
+
+    if (!rs->stream.active) {
+        return;
+    }
+
+    if (rs->stream.dma_busy) {
+        uint32_t sr = DMA_S2MM_DMASR_CH(ch);
+
+        if (sr & DMA_SR_ERR_IRQ) {
+            /* Bus error: treat like an overrun and end the stream */
+            DMA_S2MM_DMASR_CH(ch) = DMA_SR_ERR_IRQ;
+            rs->overflow_count++;
+            rs->stream.state[rs->stream.fill] = CHUNK_FREE;
+            rs->stream.dma_busy = false;
+            hal_stop_flux_capture(ch);
+            rs->stream.capture_done = true;
+        } else if (sr & DMA_SR_IOC_IRQ) {
+            /* Chunk complete: full, or cut short by TLAST at index */
+            uint8_t i = rs->stream.fill;
+            uint32_t bytes = DMA_S2MM_LENGTH_CH(ch);
+
+            DMA_S2MM_DMASR_CH(ch) = DMA_SR_IOC_IRQ;
+
+            rs->stream.dma_busy = false;
+            rs->stream.fill = (i + 1) % STREAM_CHUNKS;
+
+            rs->sample_count += bytes / sizeof(uint32_t);
+            rs->stream.remaining -= bytes / sizeof(uint32_t);
+            /* Only TLAST cuts a transfer short of its armed length */
+            if (bytes < rs->stream.armed) {
+                rs->index_count++;
+            }
+
+            if (rs->stream.remaining == 0 && !rs->stream.capture_done) {
+                hal_stop_flux_capture(ch);
+                rs->stream.capture_done = true;
+            }
+
+            /* Keep the DMA running while this chunk is framed/encoded */
+            stream_arm();
+
+            if (rs->stream.format != RAW_FLUX_FMT_RAW32) {
+                const uint32_t *words =
+                    (const uint32_t *)(stream_chunk(i) + sizeof(raw_rsp_header_t));
+                uint8_t *z = stream_zbuf(i);
+                uint32_t zlen = (rs->stream.format == RAW_FLUX_FMT_KRYOFLUX)
+                    ? flux_encode_kf(words, bytes / sizeof(uint32_t), z + sizeof(raw_rsp_header_t))
+                    : flux_encode_delta(words, bytes / sizeof(uint32_t), z + sizeof(raw_rsp_header_t));
+
+                build_response_header((raw_rsp_header_t *)z, RAW_RSP_OK,
+                                      RAW_CMD_READ_FLUX, (uint16_t)zlen);
+                rs->stream.len[i] = sizeof(raw_rsp_header_t) + zlen;
+            } else {
+                build_response_header((raw_rsp_header_t *)stream_chunk(i), RAW_RSP_OK,
+                                      RAW_CMD_READ_FLUX, (uint16_t)bytes);
+                rs->stream.len[i] = sizeof(raw_rsp_header_t) + bytes;
+            }
+            rs->stream.state[i] = CHUNK_READY;
+        }
+    }
+
+    /* Both chunks with the host: the capture FIFO is the only slack left */
+    if (REG32(stream_flux_stat_addr()) & FLUX_STAT_OVERFLOW) {
+        if (rs->overflow_count == 0) {
+            rs->overflow_count = 1;
+        }
+    }
+
+    /* Revolutions done (or engine error): the capture has ended itself */
+    if (!rs->stream.capture_done &&
+        (REG32(stream_flux_stat_addr()) & (FLUX_STAT_DONE | FLUX_STAT_ERROR))) {
+        hal_stop_flux_capture(ch);
+        rs->stream.capture_done = true;
+    }
+
+    /*
+     * Stopped with a chunk still armed: the last words may still be on
+     * their way out of the capture FIFO, so give it STREAM_DRAIN_US to
+     * complete. After that no TLAST will come (host stop mid-revolution,
+     * or the chunk re-armed after the final index) and it is dropped.
+     */
+    if (rs->stream.capture_done && rs->stream.dma_busy) {
+        if (!rs->stream.draining) {
+            rs->stream.draining = true;
+            rs->stream.drain_start = get_timestamp_us();
+        } else if (get_timestamp_us() - rs->stream.drain_start >= STREAM_DRAIN_US) {
+            DMA_S2MM_DMACR_CH(ch) = DMA_CR_RESET;
+            rs->stream.state[rs->stream.fill] = CHUNK_FREE;
+            rs->stream.dma_busy = false;
+        }
+    }
+
+    stream_arm();
+}
+
+/**
+ * Service every session's flux DMA, keeping the current session
+ */
+static void stream_service_all(void)
+{
+    raw_session_t *cur = rs;
+
+    for (uint8_t s = 0; s < RAW_SESSIONS; s++) {
+        rs = &sessions[s];
+        stream_service();
+    }
+    rs = cur;
+}
+
+void raw_mode_stream_poll(void)
+{
+    /* The FDC FIFO holds 16 bytes: drain it ahead of everything else */
+    if (job.sect_running) {
+        job_sectors_poll();
+    }
+
+    stream_service_all();
+}
+
+/**
+ * Hand out the current session's next READ_FLUX chunk or end frame
+ */
+static int stream_next(const uint8_t **data, uint32_t *len)
+{
+    if (rs->stream.end_pending) {
+        return 0;
+    }
+
+    if (rs->stream.state[rs->stream.send] == CHUNK_READY) {
+        uint8_t i = rs->stream.send;
+
+        rs->stream.state[i] = CHUNK_SENDING;
+        rs->stream.send = (i + 1) % STREAM_CHUNKS;
+        *data = (rs->stream.format != RAW_FLUX_FMT_RAW32) ? stream_zbuf(i) : stream_chunk(i);
+        *len = rs->stream.len[i];
+        return 1;
+    }
+
+    /* Drained and stopped: close with the capture summary */
+    if (rs->stream.capture_done && !rs->stream.dma_busy &&
+        rs->stream.state[0] == CHUNK_FREE && rs->stream.state[1] == CHUNK_FREE) {
+        if (rs->stream.format == RAW_FLUX_FMT_KRYOFLUX && !rs->stream.kf_closed) {
+            /* The stream file ends before the CAPTURE_STOP frame */
+            stream_close_kf();
+            return stream_next(data, len);
+        }
+        stream_build_end();
+        rs->stream.end_pending = true;
+        *data = rs->stream.end_frame;
+        *len = sizeof(rs->stream.end_frame);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Return the oldest chunk (or the end frame) handed out by stream_next()
+ */
+static void stream_release(void)
+{
+    if (rs->stream.end_pending) {
+        rs->stream.active = false;
+        rs->stream.end_pending = false;
+        rs->state.capture_active = false;
+        return;
+    }
+
+    if (rs->stream.state[rs->stream.release] == CHUNK_SENDING) {
+        rs->stream.state[rs->stream.release] = CHUNK_FREE;
+        rs->stream.release = (rs->stream.release + 1) % STREAM_CHUNKS;
+    }
+
+    stream_arm();
+}
+
+/**
+ * Session 0: jobs and their frames, then the READ_FLUX stream
+ */
+static int primary_stream_get(const uint8_t **data, uint32_t *len)
+{
+    raw_mode_stream_poll();
+
+    if (!rs->stream.active) {
+        batch_run();
+    }
+
+    if (job.active) {
+        job_run();
+    }
+
+    if (tjob.active) {
+        tjob_run();
+    }
+
+    if (dump.frame_ready && !dump.frame_out) {
+        dump.frame_out = true;
+        *data = TRACE_FRAME;
+        *len = dump.frame_len;
+        return 1;
+    }
+
+    /* TAPE_READ segments in tape order, then the closing frame */
+    if (tjob.active && !tjob.seg_out && !tjob.frame_out) {
+        if (tjob.q_count != 0) {
+            const raw_rsp_header_t *seg = (const raw_rsp_header_t *)tjob.q[tjob.q_head]->addr;
+
+            tjob.seg_out = true;
+            *data = (const uint8_t *)seg;
+            *len = sizeof(raw_rsp_header_t) + seg->data_len;
+            return 1;
+        }
+        if (tjob.frame_ready) {
+            tjob.frame_out = true;
+            *data = tjob.frame;
+            *len = sizeof(tjob.frame);
+            return 1;
+        }
+    }
+
+    /* IMAGE frames precede the stream they announce */
+    if (job.frame_ready && !job.frame_out) {
+        job.frame_out = true;
+        *data = job.frame_data;
+        *len = job.frame_len;
+        return 1;
+    }
+
+    /* Batch closing frame, once any stream inside it has drained */
+    if (!rs->stream.active) {
+        if (batch.frame_ready && !batch.frame_out) {
+            batch.frame_out = true;
+            *data = BATCH_FRAME;
+            *len = sizeof(raw_rsp_header_t) + batch.data_len;
+            return 1;
+        }
+        return 0;
+    }
+
+    return stream_next(data, len);
+}
+
+int raw_mode_stream_get(const uint8_t **data, uint32_t *len)
+{
+    return raw_mode_session_stream_get(0, data, len);
+}
+
+int raw_mode_session_stream_get(uint8_t session, const uint8_t **data, uint32_t *len)
+{
+    int ret;
+
+    if (session >= RAW_SESSIONS || data == NULL || len == NULL) {
+        return -1;
+    }
+
+    if (session == 0) {
+        return primary_stream_get(data, len);
+    }
+
+    rs = &sessions[session];
+    stream_service_all();
+    ret = rs->stream.active ? stream_next(data, len) : 0;
+    rs = &sessions[0];
+
+    return ret;
+}
+
+int raw_mode_stream_next(uint8_t *session, const uint8_t **data, uint32_t *len)
+{
+    if (session == NULL) {
+        return -1;
+    }
+
+    /* Round robin: a chunk is at most RAW_FLUX_CHUNK_SIZE, so no session
+     * gets more than one chunk ahead of another with data waiting */
+    for (uint8_t n = 0; n < RAW_SESSIONS; n++) {
+        uint8_t s = (uint8_t)((rr_next + n) % RAW_SESSIONS);
+        int ret = raw_mode_session_stream_get(s, data, len);
+
+        if (ret != 0) {
+            if (ret > 0) {
+                *session = s;
+                rr_next = (uint8_t)((s + 1) % RAW_SESSIONS);
+            }
+            return ret;
+        }
+    }
 
     return 0;
 }
 
+void raw_mode_stream_release(void)
+{
+    if (dump.frame_out) {
+        dump.frame_out = false;
+        dump.frame_ready = false;
+        return;
+    }
+
+    if (tjob.seg_out) {
+        tjob.seg_out = false;
+        ddr_release(tjob.q[tjob.q_head]);
+        tjob.q[tjob.q_head] = NULL;
+        tjob.q_head = (tjob.q_head + 1) % TAPE_BUFS;
+        tjob.q_count--;
+        tjob_arm();
+        return;
+    }
+
+    if (tjob.frame_out) {
+        tjob.frame_out = false;
+        tjob.frame_ready = false;
+        ddr_slab_destroy(&tjob.slab);
+        tape_close();
+        tjob.active = false;
+        return;
+    }
+
+    if (job.frame_out) {
+        job.frame_out = false;
+        job.frame_ready = false;
+        if (job.phase == JOB_CLOSED) {
+            job.active = false;
+        }
+        return;
+    }
+
+    if (!rs->stream.active) {
+        if (batch.frame_out) {
+            batch.active = false;
+            batch.frame_ready = false;
+            batch.frame_out = false;
+        }
+        return;
+    }
+
+    stream_release();
+}
+
+void raw_mode_session_stream_release(uint8_t session)
+{
+    if (session >= RAW_SESSIONS) {
+        return;
+    }
+
+    if (session == 0) {
+        raw_mode_stream_release();
+        return;
+    }
+
+    rs = &sessions[session];
+    if (rs->stream.active) {
+        stream_release();
+    }
+    rs = &sessions[0];
+}
+
+bool raw_mode_is_streaming(void)
+{
+    return rs->stream.active;
+}
+
 /*---------------------------------------------------------------------------
  * Flux Data Processing
  *---------------------------------------------------------------------------*/
 
 void raw_mode_process_flux(uint32_t flux_word)
 {
-    capture_sample_count++;
+    rs->sample_count++;
 
     if (flux_word & FLUX_FLAG_INDEX) {
-        capture_index_count++;
+        rs->index_count++;
     }
 
     if (flux_word & FLUX_FLAG_OVERFLOW) {
-        capture_overflow_count++;
+        rs->overflow_count++;
     }
 }
 
@@ -498,16 +2285,39 @@ void raw_mode_process_flux(uint32_t flux_word)
 void raw_mode_get_state(raw_mode_state_t *state)
 {
     if (state != NULL) {
-        memcpy(state, &raw_state, sizeof(raw_mode_state_t));
+        memcpy(state, &rs->state, sizeof(raw_mode_state_t));
     }
 }
 
+int raw_mode_session_get_state(uint8_t session, raw_mode_state_t *state,
+                               raw_capture_info_t *info)
+{
+    const raw_session_t *s;
+
+    if (session >= RAW_SESSIONS) {
+        return -1;
+    }
+    s = &sessions[session];
+
+    if (state != NULL) {
+        memcpy(state, &s->state, sizeof(raw_mode_state_t));
+    }
+    if (info != NULL) {
+        info->sample_count = s->sample_count;
+        info->index_count = s->index_count;
+        info->overflow_count = s->overflow_count;
+        info->duration_us = get_timestamp_us() - s->start_time;
+    }
+
+    return 0;
+}
+
 uint8_t raw_mode_get_selected_drive(void)
 {
-    return raw_state.selected_drive;
+    return rs->state.selected_drive;
 }
 
 bool raw_mode_is_fdd_selected(void)
 {
-    return raw_state.is_fdd;
+    return rs->state.is_fdd;
 }
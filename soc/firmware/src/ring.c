@@ -0,0 +1,147 @@
+/**
+ * FluxRipper SoC - Single-Producer/Single-Consumer Ring Buffer
+ *
+ * Updated: 2025-12-08 16:00
+ */
+
+#include "ring.h"
+#include <string.h>
+
+/* Order element copies against index updates (single hart) */
+#define ring_barrier()      __asm__ volatile ("" ::: "memory")
+
+static inline uint8_t *slot(const ring_t *r, uint32_t index)
+{
+    return r->data + (index & r->mask) * r->elem_size;
+}
+
+int ring_init(ring_t *r, void *storage, uint32_t elem_size, uint32_t capacity)
+{
+    if (r == NULL || storage == NULL || elem_size == 0 ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return -1;
+    }
+
+    r->data = (uint8_t *)storage;
+    r->elem_size = elem_size;
+    r->mask = capacity - 1;
+    ring_reset(r);
+    return 0;
+}
+
+void ring_reset(ring_t *r)
+{
+    r->head = 0;
+    r->tail = 0;
+    r->dropped = 0;
+}
+
+bool ring_push(ring_t *r, const void *elem)
+{
+    uint32_t head = r->head;
+
+    if (head - r->tail > r->mask) {
+        r->dropped++;
+        return false;
+    }
+
+    memcpy(slot(r, head), elem, r->elem_size);
+    ring_barrier();
+    r->head = head + 1;
+    return true;
+}
+
+uint32_t ring_push_batch(ring_t *r, const void *elems, uint32_t n)
+{
+    const uint8_t *src = (const uint8_t *)elems;
+    uint32_t head = r->head;
+    uint32_t space = ring_capacity(r) - (head - r->tail);
+    uint32_t todo = (n < space) ? n : space;
+
+    /* At most two copies: up to the end of storage, then from the start */
+    uint32_t first = ring_capacity(r) - (head & r->mask);
+    if (first > todo) {
+        first = todo;
+    }
+    memcpy(slot(r, head), src, first * r->elem_size);
+    memcpy(r->data, src + first * r->elem_size, (todo - first) * r->elem_size);
+
+    ring_barrier();
+    r->head = head + todo;
+
+    if (todo < n) {
+        r->dropped += n - todo;
+    }
+    return todo;
+}
+
+void *ring_claim(ring_t *r)
+{
+    uint32_t head = r->head;
+
+    if (head - r->tail > r->mask) {
+        r->dropped++;
+        return NULL;
+    }
+    return slot(r, head);
+}
+
+void ring_commit(ring_t *r)
+{
+    ring_barrier();
+    r->head = r->head + 1;
+}
+
+bool ring_pop(ring_t *r, void *elem)
+{
+    uint32_t tail = r->tail;
+
+    if (tail == r->head) {
+        return false;
+    }
+
+    ring_barrier();
+    memcpy(elem, slot(r, tail), r->elem_size);
+    ring_barrier();
+    r->tail = tail + 1;
+    return true;
+}
+
+uint32_t ring_pop_batch(ring_t *r, void *elems, uint32_t max)
+{
+    uint8_t *dst = (uint8_t *)elems;
+    uint32_t tail = r->tail;
+    uint32_t avail = r->head - tail;
+    uint32_t todo = (max < avail) ? max : avail;
+
+    ring_barrier();
+
+    uint32_t first = ring_capacity(r) - (tail & r->mask);
+    if (first > todo) {
+        first = todo;
+    }
+    memcpy(dst, slot(r, tail), first * r->elem_size);
+    memcpy(dst + first * r->elem_size, r->data, (todo - first) * r->elem_size);
+
+    ring_barrier();
+    r->tail = tail + todo;
+    return todo;
+}
+
+const void *ring_peek(const ring_t *r, uint32_t index)
+{
+    if (index >= r->head - r->tail) {
+        return NULL;
+    }
+
+    ring_barrier();
+    return slot(r, r->tail + index);
+}
+
+void ring_consume(ring_t *r, uint32_t n)
+{
+    uint32_t avail = r->head - r->tail;
+
+    ring_barrier();
+    r->tail = r->tail + ((n < avail) ? n : avail);
+}
@@ -10,6 +10,8 @@
 
 #include "scsi_handler.h"
 #include "msc_hal.h"
+#include "platform.h"
+#include "prof.h"
 #include <string.h>
 
 /*---------------------------------------------------------------------------
@@ -18,6 +20,30 @@
 
 static scsi_handler_state_t scsi_state;
 
+/* Sequential READs needed before read-ahead starts */
+#define SCSI_SEQ_RUN_MIN    2
+
+/* Streamed data phase ring */
+#define SCSI_XFER_SLOTS     4
+#define SCSI_XFER_SLOT_SIZE (SCSI_XFER_SIZE / SCSI_XFER_SLOTS)     /* 16KB */
+#define SCSI_XFER_SLOT_SECTORS (SCSI_XFER_SLOT_SIZE / MSC_SECTOR_SIZE)
+#define SCSI_XFER_SLOT(i)   ((uint8_t *)(SCSI_XFER_BASE + (uint32_t)(i) * SCSI_XFER_SLOT_SIZE))
+
+static struct {
+    bool        active;
+    bool        data_in;
+    bool        failed;
+    uint8_t     lun;
+    uint32_t    lba;            /* First sector of the command */
+    uint32_t    total;          /* Sectors in the command */
+    uint32_t    queued;         /* Sectors read from media (in) / received (out) */
+    uint32_t    done;           /* Sectors sent to host (in) / written (out) */
+    uint8_t     fill;           /* Slot the producer fills next */
+    uint8_t     drain;          /* Slot the consumer takes next */
+    uint8_t     used;           /* Filled slots */
+    uint16_t    count[SCSI_XFER_SLOTS];
+} xfer;
+
 /* Per-LUN sense data */
 static scsi_sense_data_t sense_data[MSC_MAX_LUNS];
 
@@ -34,6 +60,20 @@ static void init_sense_data(uint8_t lun)
     sense_data[lun].add_sense_len = 10;    /* Standard length */
 }
 
+/**
+ * Report the failing LBA in the sense information field (VALID set)
+ */
+static void set_sense_information(uint8_t lun, uint32_t info)
+{
+    if (lun >= MSC_MAX_LUNS) return;
+
+    sense_data[lun].response_code = 0xF0;
+    sense_data[lun].information[0] = (uint8_t)(info >> 24);
+    sense_data[lun].information[1] = (uint8_t)(info >> 16);
+    sense_data[lun].information[2] = (uint8_t)(info >> 8);
+    sense_data[lun].information[3] = (uint8_t)info;
+}
+
 /*---------------------------------------------------------------------------
  * Private Functions - CDB Parsing
  *---------------------------------------------------------------------------*/
@@ -46,6 +86,11 @@ static uint32_t get_be32(const uint8_t *buf)
            ((uint32_t)buf[3]);
 }
 
+static uint64_t get_be64(const uint8_t *buf)
+{
+    return ((uint64_t)get_be32(&buf[0]) << 32) | get_be32(&buf[4]);
+}
+
 static uint16_t get_be16(const uint8_t *buf)
 {
     return ((uint16_t)buf[0] << 8) | (uint16_t)buf[1];
@@ -59,12 +104,47 @@ static void put_be32(uint8_t *buf, uint32_t val)
     buf[3] = val & 0xFF;
 }
 
+static void put_be64(uint8_t *buf, uint64_t val)
+{
+    put_be32(&buf[0], (uint32_t)(val >> 32));
+    put_be32(&buf[4], (uint32_t)val);
+}
+
 static void put_be16(uint8_t *buf, uint16_t val)
 {
     buf[0] = (val >> 8) & 0xFF;
     buf[1] = val & 0xFF;
 }
 
+/*---------------------------------------------------------------------------
+ * Private Functions - Read-Ahead
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Track the READ stream on a LUN and steer msc_hal read-ahead
+ *
+ * A READ starting where the previous one ended extends the run; once the
+ * run is long enough, the tracks after this transfer are prefetched while
+ * it goes to the host. Anything else is random access and cancels it.
+ */
+static void track_read_stream(uint8_t lun, uint32_t lba, uint32_t count)
+{
+    if (lba == scsi_state.next_lba[lun]) {
+        if (scsi_state.seq_run[lun] < 0xFF) {
+            scsi_state.seq_run[lun]++;
+        }
+    } else {
+        scsi_state.seq_run[lun] = 0;
+        msc_hal_prefetch_cancel(lun);
+    }
+
+    scsi_state.next_lba[lun] = lba + count;
+
+    if (scsi_state.seq_run[lun] >= SCSI_SEQ_RUN_MIN) {
+        msc_hal_prefetch(lun, scsi_state.next_lba[lun]);
+    }
+}
+
 /*---------------------------------------------------------------------------
  * Public Functions - Initialization
  *---------------------------------------------------------------------------*/
@@ -88,6 +168,8 @@ void scsi_handler_reset(void)
 {
     int i;
 
+    scsi_xfer_abort();
+
     for (i = 0; i < MSC_MAX_LUNS; i++) {
         init_sense_data(i);
         scsi_state.unit_attention[i] = true;  /* Signal reset */
@@ -102,6 +184,9 @@ void scsi_set_sense(uint8_t lun, uint8_t key, uint8_t asc, uint8_t ascq)
 {
     if (lun >= MSC_MAX_LUNS) return;
 
+    /* Information only applies to the error that set it */
+    sense_data[lun].response_code = 0x70;
+    memset(sense_data[lun].information, 0, sizeof(sense_data[lun].information));
     sense_data[lun].sense_key = key;
     sense_data[lun].asc = asc;
     sense_data[lun].ascq = ascq;
@@ -159,20 +244,16 @@ int scsi_cmd_test_unit_ready(uint8_t lun, scsi_result_t *result)
         return -1;
     }
 
-    /* Check if media is ready */
+    /*
+     * Cached LUN state: media changes arrive by interrupt and raise the
+     * unit attention above, so a poll costs no drive access
+     */
     if (!msc_hal_is_ready(lun)) {
         scsi_set_sense(lun, SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, ASCQ_NO_ADDITIONAL_INFO);
         result->status = -1;
         return -1;
     }
 
-    /* Check for media change */
-    if (msc_hal_media_changed(lun)) {
-        scsi_set_sense(lun, SENSE_UNIT_ATTENTION, ASC_NOT_READY_TO_READY, ASCQ_NO_ADDITIONAL_INFO);
-        result->status = -1;
-        return -1;
-    }
-
     scsi_clear_sense(lun);
     result->status = 0;
     return 0;
@@ -187,6 +268,12 @@ int scsi_cmd_request_sense(uint8_t lun, uint8_t *buf, uint32_t *len,
 {
     int sense_len;
 
+    /* A pending unit attention is reported (and consumed) here too */
+    if (lun < MSC_MAX_LUNS && scsi_state.unit_attention[lun]) {
+        scsi_state.unit_attention[lun] = false;
+        scsi_set_sense(lun, SENSE_UNIT_ATTENTION, ASC_NOT_READY_TO_READY, ASCQ_NO_ADDITIONAL_INFO);
+    }
+
     sense_len = scsi_build_sense_response(lun, buf);
 
     if (*len > (uint32_t)sense_len) {
@@ -315,10 +402,16 @@ int scsi_cmd_start_stop_unit(uint8_t lun, const uint8_t *cdb,
     bool start = (cdb[4] & 0x01) != 0;
     bool loej = (cdb[4] & 0x02) != 0;
 
-    msc_hal_start_stop(lun, start, loej);
-
     result->data_len = 0;
     result->data_in = false;
+
+    /* Buffered writes are flushed first and may turn up a medium error */
+    if (msc_hal_start_stop(lun, start, loej) == MSC_ERR_WRITE) {
+        scsi_set_sense(lun, SENSE_MEDIUM_ERROR, ASC_WRITE_ERROR, ASCQ_NO_ADDITIONAL_INFO);
+        result->status = -1;
+        return -1;
+    }
+
     result->status = 0;
 
     return 0;
@@ -333,10 +426,15 @@ int scsi_cmd_prevent_allow_removal(uint8_t lun, const uint8_t *cdb,
 {
     bool prevent = (cdb[4] & 0x01) != 0;
 
-    msc_hal_prevent_removal(lun, prevent);
-
     result->data_len = 0;
     result->data_in = false;
+
+    if (msc_hal_prevent_removal(lun, prevent) == MSC_ERR_WRITE) {
+        scsi_set_sense(lun, SENSE_MEDIUM_ERROR, ASC_WRITE_ERROR, ASCQ_NO_ADDITIONAL_INFO);
+        result->status = -1;
+        return -1;
+    }
+
     result->status = 0;
 
     return 0;
@@ -424,47 +522,133 @@ int scsi_cmd_read_capacity_10(uint8_t lun, uint8_t *buf, uint32_t *len,
     return 0;
 }
 
+int scsi_cmd_read_capacity_16(uint8_t lun, const uint8_t *cdb, uint8_t *buf,
+                              uint32_t *len, scsi_result_t *result)
+{
+    uint32_t last_lba;
+    uint16_t block_size;
+    uint32_t alloc_len = get_be32(&cdb[10]);
+
+    if (!msc_hal_is_ready(lun)) {
+        scsi_set_sense(lun, SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, ASCQ_NO_ADDITIONAL_INFO);
+        result->status = -1;
+        result->data_len = 0;
+        return -1;
+    }
+
+    if (msc_hal_get_capacity(lun, &last_lba, &block_size) != MSC_OK) {
+        scsi_set_sense(lun, SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, ASCQ_NO_ADDITIONAL_INFO);
+        result->status = -1;
+        result->data_len = 0;
+        return -1;
+    }
+
+    memset(buf, 0, SCSI_READ_CAPACITY_16_LEN);
+
+    /* Last logical block address */
+    put_be64(&buf[0], last_lba);
+
+    /* Block length in bytes; no protection, one block per physical block */
+    put_be32(&buf[8], block_size);
+
+    *len = alloc_len < SCSI_READ_CAPACITY_16_LEN ? alloc_len : SCSI_READ_CAPACITY_16_LEN;
+
+    result->data_len = *len;
+    result->data_in = true;
+    result->status = 0;
+
+    return 0;
+}
+
 /*---------------------------------------------------------------------------
  * Command Handlers - READ (10)
  *---------------------------------------------------------------------------*/
 
-int scsi_cmd_read_10(uint8_t lun, const uint8_t *cdb, uint8_t *buf,
-                     uint32_t *len, scsi_result_t *result)
+/**
+ * Common READ/WRITE path for the 10- and 16-byte CDBs
+ *
+ * A transfer that fits the caller's buffer completes here. A larger one
+ * starts a streamed data phase and returns with result->streamed set and
+ * data_len covering the whole transfer.
+ */
+static int do_read_write(uint8_t lun, bool data_in, uint64_t lba, uint32_t count,
+                         uint8_t *buf, uint32_t buf_len, scsi_result_t *result)
 {
-    uint32_t lba;
-    uint16_t transfer_len;
+    uint32_t last_lba;
+    uint16_t block_size;
     int ret;
 
-    /* Parse CDB */
-    lba = get_be32(&cdb[2]);
-    transfer_len = get_be16(&cdb[7]);
+    result->data_in = data_in;
 
-    if (transfer_len == 0) {
+    if (count == 0) {
         result->data_len = 0;
-        result->data_in = true;
         result->status = 0;
         return 0;
     }
 
     /* Check if ready */
-    if (!msc_hal_is_ready(lun)) {
+    if (!msc_hal_is_ready(lun) ||
+        msc_hal_get_capacity(lun, &last_lba, &block_size) != MSC_OK) {
         scsi_set_sense(lun, SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, ASCQ_NO_ADDITIONAL_INFO);
         result->status = -1;
         result->data_len = 0;
         return -1;
     }
 
-    /* Read sectors */
-    ret = msc_hal_read_sectors(lun, lba, buf, transfer_len);
+    /* Not lba + count: a READ(16)/WRITE(16) LBA near 2^64 would wrap */
+    if (lba > last_lba || count > (uint64_t)last_lba + 1 - lba) {
+        scsi_set_sense(lun, SENSE_ILLEGAL_REQUEST, ASC_LBA_OUT_OF_RANGE, ASCQ_NO_ADDITIONAL_INFO);
+        result->status = -1;
+        result->data_len = 0;
+        return -1;
+    }
+
+    /* Check write protection */
+    if (!data_in && msc_hal_is_write_protected(lun)) {
+        scsi_set_sense(lun, SENSE_DATA_PROTECT, ASC_WRITE_PROTECTED, ASCQ_NO_ADDITIONAL_INFO);
+        result->status = -1;
+        result->data_len = 0;
+        return -1;
+    }
+
+    if (data_in) {
+        track_read_stream(lun, (uint32_t)lba, count);
+    }
+
+    /* Too big for the caller's buffer: stream it through the ring */
+    if (buf == NULL || count > buf_len / MSC_SECTOR_SIZE) {
+        scsi_xfer_abort();
+        xfer.active = true;
+        xfer.data_in = data_in;
+        xfer.lun = lun;
+        xfer.lba = (uint32_t)lba;
+        xfer.total = count;
+
+        /* Have the first chunk ready before the host asks */
+        if (data_in) {
+            scsi_xfer_poll();
+        }
+
+        result->streamed = true;
+        result->data_len = count * MSC_SECTOR_SIZE;
+        result->status = 0;
+        return 0;
+    }
+
+    if (data_in) {
+        ret = msc_hal_read_sectors(lun, (uint32_t)lba, buf, count);
+    } else {
+        ret = msc_hal_write_sectors(lun, (uint32_t)lba, buf, count);
+    }
 
     if (ret == MSC_OK) {
-        *len = transfer_len * MSC_SECTOR_SIZE;
-        result->data_len = *len;
-        result->data_in = true;
+        result->data_len = data_in ? count * MSC_SECTOR_SIZE : 0;
         result->status = 0;
         return 0;
     } else if (ret == MSC_ERR_LBA_RANGE) {
         scsi_set_sense(lun, SENSE_ILLEGAL_REQUEST, ASC_LBA_OUT_OF_RANGE, ASCQ_NO_ADDITIONAL_INFO);
+    } else if (ret == MSC_ERR_WRITE_PROT) {
+        scsi_set_sense(lun, SENSE_DATA_PROTECT, ASC_WRITE_PROTECTED, ASCQ_NO_ADDITIONAL_INFO);
     } else {
         scsi_set_sense(lun, SENSE_MEDIUM_ERROR, ASC_NO_ADDITIONAL_INFO, ASCQ_NO_ADDITIONAL_INFO);
     }
@@ -474,86 +658,289 @@ int scsi_cmd_read_10(uint8_t lun, const uint8_t *cdb, uint8_t *buf,
     return -1;
 }
 
-/*---------------------------------------------------------------------------
- * Command Handlers - WRITE (10)
- *---------------------------------------------------------------------------*/
+int scsi_cmd_read_10(uint8_t lun, const uint8_t *cdb, uint8_t *buf,
+                     uint32_t *len, scsi_result_t *result)
+{
+    /* Parse CDB */
+    uint32_t lba = get_be32(&cdb[2]);
+    uint16_t transfer_len = get_be16(&cdb[7]);
+
+    int ret = do_read_write(lun, true, lba, transfer_len, buf, *len, result);
+    *len = result->streamed ? 0 : result->data_len;
+    return ret;
+}
 
 int scsi_cmd_write_10(uint8_t lun, const uint8_t *cdb, const uint8_t *buf,
                       uint32_t len, scsi_result_t *result)
 {
-    uint32_t lba;
-    uint16_t transfer_len;
+    /* Parse CDB */
+    uint32_t lba = get_be32(&cdb[2]);
+    uint16_t transfer_len = get_be16(&cdb[7]);
+
+    return do_read_write(lun, false, lba, transfer_len, (uint8_t *)buf, len, result);
+}
+
+int scsi_cmd_read_16(uint8_t lun, const uint8_t *cdb, uint8_t *buf,
+                     uint32_t *len, scsi_result_t *result)
+{
+    uint64_t lba = get_be64(&cdb[2]);
+    uint32_t transfer_len = get_be32(&cdb[10]);
+
+    int ret = do_read_write(lun, true, lba, transfer_len, buf, *len, result);
+    *len = result->streamed ? 0 : result->data_len;
+    return ret;
+}
+
+int scsi_cmd_write_16(uint8_t lun, const uint8_t *cdb, const uint8_t *buf,
+                      uint32_t len, scsi_result_t *result)
+{
+    uint64_t lba = get_be64(&cdb[2]);
+    uint32_t transfer_len = get_be32(&cdb[10]);
+
+    return do_read_write(lun, false, lba, transfer_len, (uint8_t *)buf, len, result);
+}
+
+int scsi_cmd_verify_10(uint8_t lun, const uint8_t *cdb, scsi_result_t *result)
+{
+    uint32_t lba = get_be32(&cdb[2]);
+    uint16_t count = get_be16(&cdb[7]);
+    uint32_t last_lba;
+    uint16_t block_size;
+    uint32_t bad_lba = lba;
     int ret;
 
-    /* Parse CDB */
-    lba = get_be32(&cdb[2]);
-    transfer_len = get_be16(&cdb[7]);
+    result->data_len = 0;
+    result->data_in = false;
 
-    if (transfer_len == 0) {
-        result->data_len = 0;
-        result->data_in = false;
-        result->status = 0;
-        return 0;
+    /* BYTCHK: comparing against host data is not supported */
+    if (cdb[1] & 0x06) {
+        scsi_set_sense(lun, SENSE_ILLEGAL_REQUEST, ASC_INVALID_FIELD_IN_CDB, ASCQ_NO_ADDITIONAL_INFO);
+        result->status = -1;
+        return -1;
     }
 
-    /* Check if ready */
-    if (!msc_hal_is_ready(lun)) {
+    if (!msc_hal_is_ready(lun) ||
+        msc_hal_get_capacity(lun, &last_lba, &block_size) != MSC_OK) {
         scsi_set_sense(lun, SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, ASCQ_NO_ADDITIONAL_INFO);
         result->status = -1;
         return -1;
     }
 
-    /* Check write protection */
-    if (msc_hal_is_write_protected(lun)) {
-        scsi_set_sense(lun, SENSE_DATA_PROTECT, ASC_WRITE_PROTECTED, ASCQ_NO_ADDITIONAL_INFO);
+    if ((uint64_t)lba + count > (uint64_t)last_lba + 1) {
+        scsi_set_sense(lun, SENSE_ILLEGAL_REQUEST, ASC_LBA_OUT_OF_RANGE, ASCQ_NO_ADDITIONAL_INFO);
         result->status = -1;
         return -1;
     }
 
-    /* Write sectors */
-    ret = msc_hal_write_sectors(lun, lba, buf, transfer_len);
-
+    ret = msc_hal_verify_sectors(lun, lba, count, &bad_lba);
     if (ret == MSC_OK) {
-        result->data_len = 0;
-        result->data_in = false;
         result->status = 0;
         return 0;
-    } else if (ret == MSC_ERR_LBA_RANGE) {
-        scsi_set_sense(lun, SENSE_ILLEGAL_REQUEST, ASC_LBA_OUT_OF_RANGE, ASCQ_NO_ADDITIONAL_INFO);
-    } else if (ret == MSC_ERR_WRITE_PROT) {
-        scsi_set_sense(lun, SENSE_DATA_PROTECT, ASC_WRITE_PROTECTED, ASCQ_NO_ADDITIONAL_INFO);
+    }
+
+    if (ret == MSC_ERR_WRITE) {
+        scsi_set_sense(lun, SENSE_MEDIUM_ERROR, ASC_WRITE_ERROR, ASCQ_NO_ADDITIONAL_INFO);
+    } else if (ret == MSC_ERR_NO_MEDIA) {
+        scsi_set_sense(lun, SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, ASCQ_NO_ADDITIONAL_INFO);
     } else {
-        scsi_set_sense(lun, SENSE_MEDIUM_ERROR, ASC_NO_ADDITIONAL_INFO, ASCQ_NO_ADDITIONAL_INFO);
+        scsi_set_sense(lun, SENSE_MEDIUM_ERROR, ASC_UNRECOVERED_READ_ERROR, ASCQ_NO_ADDITIONAL_INFO);
     }
+    set_sense_information(lun, bad_lba);
 
     result->status = -1;
     return -1;
 }
 
-/*---------------------------------------------------------------------------
- * Command Handlers - VERIFY (10)
- *---------------------------------------------------------------------------*/
-
-int scsi_cmd_verify_10(uint8_t lun, const uint8_t *cdb, scsi_result_t *result)
+int scsi_cmd_synchronize_cache_10(uint8_t lun, const uint8_t *cdb, scsi_result_t *result)
 {
-    /* For now, just return success - actual verification would read and compare */
+    (void)cdb;
+
+    result->data_len = 0;
+    result->data_in = false;
+
     if (!msc_hal_is_ready(lun)) {
         scsi_set_sense(lun, SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, ASCQ_NO_ADDITIONAL_INFO);
         result->status = -1;
         return -1;
     }
 
-    result->data_len = 0;
-    result->data_in = false;
+    if (msc_hal_flush(lun) != MSC_OK) {
+        scsi_set_sense(lun, SENSE_MEDIUM_ERROR, ASC_WRITE_ERROR, ASCQ_NO_ADDITIONAL_INFO);
+        result->status = -1;
+        return -1;
+    }
+
     result->status = 0;
     return 0;
 }
 
+/*---------------------------------------------------------------------------
+ * Public Functions - Streamed Data Phase
+ *---------------------------------------------------------------------------*/
+
+static uint32_t xfer_chunk(uint32_t remaining)
+{
+    return remaining < SCSI_XFER_SLOT_SECTORS ? remaining : SCSI_XFER_SLOT_SECTORS;
+}
+
+/**
+ * Stop a stream on a media error
+ * The host is told through the status; no further chunks are produced.
+ */
+static void xfer_fail(uint8_t key)
+{
+    xfer.failed = true;
+    scsi_set_sense(xfer.lun, key, ASC_NO_ADDITIONAL_INFO, ASCQ_NO_ADDITIONAL_INFO);
+}
+
+bool scsi_xfer_active(void)
+{
+    return xfer.active;
+}
+
+void scsi_xfer_poll(void)
+{
+    if (!xfer.active || xfer.failed) {
+        return;
+    }
+
+    if (xfer.data_in) {
+        /* Read ahead into a free slot */
+        if (xfer.used == SCSI_XFER_SLOTS || xfer.queued == xfer.total) {
+            return;
+        }
+
+        uint32_t n = xfer_chunk(xfer.total - xfer.queued);
+        if (msc_hal_read_sectors(xfer.lun, xfer.lba + xfer.queued,
+                                 SCSI_XFER_SLOT(xfer.fill), n) != MSC_OK) {
+            xfer_fail(SENSE_MEDIUM_ERROR);
+            return;
+        }
+
+        xfer.count[xfer.fill] = n;
+        xfer.fill = (xfer.fill + 1) % SCSI_XFER_SLOTS;
+        xfer.used++;
+        xfer.queued += n;
+    } else {
+        /* Write behind from the oldest full slot */
+        if (xfer.used == 0) {
+            return;
+        }
+
+        uint32_t n = xfer.count[xfer.drain];
+        int ret = msc_hal_write_sectors(xfer.lun, xfer.lba + xfer.done,
+                                        SCSI_XFER_SLOT(xfer.drain), n);
+        if (ret != MSC_OK) {
+            xfer_fail(ret == MSC_ERR_WRITE_PROT ? SENSE_DATA_PROTECT : SENSE_MEDIUM_ERROR);
+            return;
+        }
+
+        xfer.drain = (xfer.drain + 1) % SCSI_XFER_SLOTS;
+        xfer.used--;
+        xfer.done += n;
+    }
+}
+
+const uint8_t *scsi_xfer_in_get(uint32_t *len)
+{
+    if (!xfer.active || !xfer.data_in) {
+        return NULL;
+    }
+
+    if (xfer.used == 0) {
+        scsi_xfer_poll();
+        if (xfer.used == 0) {
+            return NULL;
+        }
+    }
+
+    *len = xfer.count[xfer.drain] * MSC_SECTOR_SIZE;
+    return SCSI_XFER_SLOT(xfer.drain);
+}
+
+void scsi_xfer_in_release(void)
+{
+    if (!xfer.active || !xfer.data_in || xfer.used == 0) {
+        return;
+    }
+
+    xfer.done += xfer.count[xfer.drain];
+    xfer.drain = (xfer.drain + 1) % SCSI_XFER_SLOTS;
+    xfer.used--;
+
+    /* Keep the ring topped up while the host drains it */
+    scsi_xfer_poll();
+}
+
+uint8_t *scsi_xfer_out_get(uint32_t *len)
+{
+    if (!xfer.active || xfer.data_in || xfer.queued == xfer.total) {
+        return NULL;
+    }
+
+    if (xfer.used == SCSI_XFER_SLOTS) {
+        scsi_xfer_poll();
+        if (xfer.used == SCSI_XFER_SLOTS) {
+            return NULL;
+        }
+    }
+
+    /* After a failure the data is still taken from the host, but dropped */
+    xfer.count[xfer.fill] = xfer_chunk(xfer.total - xfer.queued);
+    *len = xfer.count[xfer.fill] * MSC_SECTOR_SIZE;
+    return SCSI_XFER_SLOT(xfer.fill);
+}
+
+void scsi_xfer_out_commit(void)
+{
+    if (!xfer.active || xfer.data_in || xfer.queued == xfer.total) {
+        return;
+    }
+
+    xfer.queued += xfer.count[xfer.fill];
+    if (xfer.failed) {
+        return;
+    }
+
+    xfer.fill = (xfer.fill + 1) % SCSI_XFER_SLOTS;
+    xfer.used++;
+}
+
+int scsi_xfer_finish(scsi_result_t *result)
+{
+    if (!xfer.active) {
+        return result->status;
+    }
+
+    /* Write out what is still queued */
+    while (!xfer.data_in && !xfer.failed && xfer.used > 0) {
+        scsi_xfer_poll();
+    }
+
+    /* A stream that stopped short without an error counts as one */
+    if (!xfer.failed && xfer.done != xfer.total) {
+        xfer_fail(SENSE_ABORTED_COMMAND);
+    }
+
+    result->data_len = xfer.done * MSC_SECTOR_SIZE;
+    result->data_in = xfer.data_in;
+    result->streamed = true;
+    result->status = xfer.failed ? -1 : 0;
+
+    xfer.active = false;
+    return result->status;
+}
+
+void scsi_xfer_abort(void)
+{
+    memset(&xfer, 0, sizeof(xfer));
+}
+
 /*---------------------------------------------------------------------------
  * Main Command Dispatcher
  *---------------------------------------------------------------------------*/
 
-int scsi_process_command(uint8_t lun, const uint8_t *cdb, uint8_t cdb_len,
+static int scsi_dispatch(uint8_t lun, const uint8_t *cdb,
                          uint8_t *data_buf, uint32_t *data_len,
                          scsi_result_t *result)
 {
@@ -571,6 +958,7 @@ int scsi_process_command(uint8_t lun, const uint8_t *cdb, uint8_t cdb_len,
     }
 
     opcode = cdb[0];
+    result->streamed = false;
 
     switch (opcode) {
         case SCSI_TEST_UNIT_READY:
@@ -603,9 +991,27 @@ int scsi_process_command(uint8_t lun, const uint8_t *cdb, uint8_t cdb_len,
         case SCSI_WRITE_10:
             return scsi_cmd_write_10(lun, cdb, data_buf, *data_len, result);
 
+        case SCSI_READ_16:
+            return scsi_cmd_read_16(lun, cdb, data_buf, data_len, result);
+
+        case SCSI_WRITE_16:
+            return scsi_cmd_write_16(lun, cdb, data_buf, *data_len, result);
+
+        case SCSI_SERVICE_ACTION_IN_16:
+            if ((cdb[1] & 0x1F) == SCSI_SA_READ_CAPACITY_16) {
+                return scsi_cmd_read_capacity_16(lun, cdb, data_buf, data_len, result);
+            }
+            scsi_set_sense(lun, SENSE_ILLEGAL_REQUEST, ASC_INVALID_FIELD_IN_CDB, ASCQ_NO_ADDITIONAL_INFO);
+            result->status = -1;
+            result->data_len = 0;
+            return -1;
+
         case SCSI_VERIFY_10:
             return scsi_cmd_verify_10(lun, cdb, result);
 
+        case SCSI_SYNCHRONIZE_CACHE_10:
+            return scsi_cmd_synchronize_cache_10(lun, cdb, result);
+
         default:
             /* Unsupported command */
             scsi_set_sense(lun, SENSE_ILLEGAL_REQUEST, ASC_INVALID_COMMAND, ASCQ_NO_ADDITIONAL_INFO);
@@ -615,6 +1021,19 @@ int scsi_process_command(uint8_t lun, const uint8_t *cdb, uint8_t cdb_len,
     }
 }
 
+int scsi_process_command(uint8_t lun, const uint8_t *cdb, uint8_t cdb_len,
+                         uint8_t *data_buf, uint32_t *data_len,
+                         scsi_result_t *result)
+{
+    (void)cdb_len;
+
+    PROF_BEGIN(PROF_SCSI_CMD);
+    int ret = scsi_dispatch(lun, cdb, data_buf, data_len, result);
+    PROF_END(PROF_SCSI_CMD);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------
  * Utility Functions - Debug
  *---------------------------------------------------------------------------*/
@@ -633,6 +1052,10 @@ const char *scsi_opcode_name(uint8_t opcode)
         case SCSI_READ_10:                return "READ_10";
         case SCSI_WRITE_10:               return "WRITE_10";
         case SCSI_VERIFY_10:              return "VERIFY_10";
+        case SCSI_SYNCHRONIZE_CACHE_10:   return "SYNCHRONIZE_CACHE_10";
+        case SCSI_READ_16:                return "READ_16";
+        case SCSI_WRITE_16:               return "WRITE_16";
+        case SCSI_SERVICE_ACTION_IN_16:   return "SERVICE_ACTION_IN_16";
         default:                          return "UNKNOWN";
     }
 }
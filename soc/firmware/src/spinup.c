@@ -0,0 +1,276 @@
+/**
+ * FluxRipper Drive Spin-Up Scheduler - Implementation
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-09 23:00
+ */
+
+#include "spinup.h"
+#include "fluxripper_hal.h"
+#include "hdd_hal.h"
+#include "event.h"
+#include "timer.h"
+#include <stddef.h>
+
+/*============================================================================
+ * Internal State
+ *============================================================================*/
+
+typedef struct {
+    spinup_state_t  state;
+    uint32_t        start_ms;       /* Admission time */
+    bool            sensed;         /* Presence checked after SPINUP_SENSE_MS */
+} spinup_slot_t;
+
+static struct {
+    spinup_slot_t   slot[PWR_CONN_COUNT];
+    uint32_t        active;         /* Connectors pending or in surge */
+    spinup_stats_t  stats;
+} spinup;
+
+/*============================================================================
+ * Connector Classes
+ *============================================================================*/
+
+static bool conn_is_hdd(pwr_conn_t conn)
+{
+    return conn >= PWR_CONN_HDD0;
+}
+
+/* FDC drive on the connector, or -1 for a power-only FDD connector */
+static int conn_fdc_drive(pwr_conn_t conn)
+{
+    int drive = (int)conn - PWR_CONN_FDD0;
+
+    return (drive >= 0 && drive < MAX_DRIVES) ? drive : -1;
+}
+
+static uint32_t surge_mw(pwr_conn_t conn)
+{
+    if (conn_is_hdd(conn)) {
+        return SPINUP_HDD_SURGE_MW;
+    }
+    if (conn == PWR_CONN_FDD3 && pwr_conn_is_8inch_mode()) {
+        return SPINUP_FDD8_SURGE_MW;
+    }
+    return SPINUP_FDD_SURGE_MW;
+}
+
+/**
+ * Surge headroom left after the source's margin
+ */
+static uint32_t usable_mw(pwr_source_t src)
+{
+    uint32_t available, allocated, remaining, margin;
+
+    pwr_budget_report(&available, &allocated, &remaining);
+    margin = available * (src == PWR_SRC_USB_C ? SPINUP_MARGIN_USBC_PCT
+                                               : SPINUP_MARGIN_ATX_PCT) / 100;
+    return remaining > margin ? remaining - margin : 0;
+}
+
+/*============================================================================
+ * Slot Transitions
+ *============================================================================*/
+
+static void slot_finish(pwr_conn_t conn, spinup_state_t state)
+{
+    spinup.slot[conn].state = state;
+    spinup.active &= ~SPINUP_MASK(conn);
+    if (state == SPINUP_FAILED) {
+        spinup.stats.failed++;
+    }
+}
+
+static void slot_admit(pwr_conn_t conn, uint32_t now)
+{
+    spinup_slot_t *s = &spinup.slot[conn];
+    int drive = conn_fdc_drive(conn);
+
+    if (pwr_conn_enable(conn, true) != PMU_OK ||
+        (drive >= 0 && hal_motor_start((uint8_t)drive) != HAL_OK)) {
+        slot_finish(conn, SPINUP_FAILED);
+        return;
+    }
+
+    s->state = SPINUP_SURGE;
+    s->start_ms = now;
+    s->sensed = false;
+    spinup.stats.started++;
+}
+
+/**
+ * Check whether a drive in surge has reached speed
+ */
+static bool surge_done(pwr_conn_t conn, uint32_t now)
+{
+    spinup_slot_t *s = &spinup.slot[conn];
+    uint32_t elapsed = now - s->start_ms;
+    int drive = conn_fdc_drive(conn);
+
+    if (drive >= 0) {
+        return hal_motor_at_speed((uint8_t)drive);
+    }
+    if (!conn_is_hdd(conn)) {
+        return elapsed >= SPINUP_FDD_SURGE_MS;
+    }
+
+    if (hdd_is_ready((uint8_t)(conn - PWR_CONN_HDD0)) ||
+        elapsed >= SPINUP_HDD_SURGE_MS) {
+        return true;
+    }
+
+    /* Nothing drawing current once the spindle should be turning: empty */
+    if (!s->sensed && elapsed >= SPINUP_SENSE_MS) {
+        pwr_conn_status_t status;
+
+        s->sensed = true;
+        if (pwr_conn_read(conn, &status) == PMU_OK &&
+            status.total_power_mw < PMU_CONN_PRESENT_MW) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*============================================================================
+ * API Implementation
+ *============================================================================*/
+
+void spinup_request(uint32_t mask)
+{
+    for (int i = 0; i < PWR_CONN_COUNT; i++) {
+        spinup_slot_t *s = &spinup.slot[i];
+
+        if ((mask & SPINUP_MASK(i)) &&
+            (s->state == SPINUP_IDLE || s->state == SPINUP_FAILED)) {
+            s->state = SPINUP_PENDING;
+            spinup.active |= SPINUP_MASK(i);
+        }
+    }
+}
+
+void spinup_poll(void)
+{
+    uint32_t now, in_flight = 0, in_flight_mw = 0, usable = 0;
+    pwr_source_t src;
+
+    if (spinup.active == 0) {
+        return;
+    }
+    now = timer_get_ms();
+
+    /* Retire surges that have ended */
+    for (int i = 0; i < PWR_CONN_COUNT; i++) {
+        pwr_conn_t conn = (pwr_conn_t)i;
+
+        if (spinup.slot[i].state != SPINUP_SURGE) {
+            continue;
+        }
+        if (pwr_conn_fault(conn)) {
+            slot_finish(conn, SPINUP_FAILED);
+        } else if (surge_done(conn, now)) {
+            slot_finish(conn, SPINUP_UP);
+        } else {
+            in_flight++;
+            in_flight_mw += surge_mw(conn);
+        }
+    }
+
+    src = pwr_get_source();
+    if (src != PWR_SRC_NONE) {
+        usable = usable_mw(src);
+    }
+
+    /*
+     * Admit pending drives while their surge fits. The budget report
+     * already carries the running load of drives admitted on earlier
+     * polls, and their full surge is charged again on top, so the
+     * estimate errs toward serializing.
+     */
+    for (int i = 0; i < PWR_CONN_COUNT; i++) {
+        pwr_conn_t conn = (pwr_conn_t)i;
+
+        if (spinup.slot[i].state != SPINUP_PENDING) {
+            continue;
+        }
+
+        if (src == PWR_SRC_NONE) {
+            /* No budget to go by: one at a time */
+            if (in_flight > 0) {
+                break;
+            }
+        } else if (!pwr_budget_check(conn)) {
+            /* Running load does not fit even with nothing else starting */
+            if (in_flight == 0) {
+                slot_finish(conn, SPINUP_FAILED);
+            } else {
+                spinup.stats.deferred++;
+            }
+            continue;
+        } else if (in_flight > 0 && in_flight_mw + surge_mw(conn) > usable) {
+            /* A lone drive always starts; no better ordering exists */
+            spinup.stats.deferred++;
+            continue;
+        }
+
+        slot_admit(conn, now);
+        if (spinup.slot[i].state == SPINUP_SURGE) {
+            in_flight++;
+            in_flight_mw += surge_mw(conn);
+        }
+    }
+
+    if (in_flight > spinup.stats.peak_parallel) {
+        spinup.stats.peak_parallel = in_flight;
+    }
+}
+
+static bool batch_check(void *arg)
+{
+    uint32_t mask = *(const uint32_t *)arg;
+
+    spinup_poll();
+    return (spinup.active & mask) == 0;
+}
+
+int spinup_wait(uint32_t mask, uint32_t timeout_ms)
+{
+    uint32_t start = timer_get_ms();
+
+    mask &= SPINUP_MASK_ALL;
+    spinup_request(mask);
+
+    if (!event_wait(NULL, batch_check, &mask, timeout_ms)) {
+        return HAL_ERR_TIMEOUT;
+    }
+    spinup.stats.last_batch_ms = timer_get_ms() - start;
+
+    for (int i = 0; i < PWR_CONN_COUNT; i++) {
+        if ((mask & SPINUP_MASK(i)) && spinup.slot[i].state == SPINUP_FAILED) {
+            return HAL_ERR_HARDWARE;
+        }
+    }
+    return HAL_OK;
+}
+
+void spinup_release(pwr_conn_t conn)
+{
+    if (conn >= PWR_CONN_COUNT) {
+        return;
+    }
+    spinup.slot[conn].state = SPINUP_IDLE;
+    spinup.active &= ~SPINUP_MASK(conn);
+}
+
+spinup_state_t spinup_get_state(pwr_conn_t conn)
+{
+    return conn < PWR_CONN_COUNT ? spinup.slot[conn].state : SPINUP_IDLE;
+}
+
+void spinup_get_stats(spinup_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = spinup.stats;
+    }
+}
@@ -0,0 +1,165 @@
+/**
+ * FluxRipper QIC-117 Tape HAL - Implementation
+ *
+ * Target: AMD Spartan UltraScale+ SCU35
+ * Created: 2025-12-11 22:30
+ */
+
+#include "tape_hal.h"
+#include "fluxripper_hal.h"
+#include "timer.h"
+#include <stddef.h>
+
+/*============================================================================
+ * Internal State
+ *============================================================================*/
+
+static struct {
+    bool        open;
+    uint8_t     drive;              /* FDC drive carrying STEP */
+    uint8_t     unit;               /* TDR select */
+    bool        seeking;            /* Pulses being sent */
+    bool        gap;                /* Waiting out the command gap */
+    int         ret;                /* hal_seek_start()/poll() result */
+    uint32_t    gap_start;
+} tape;
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+int tape_open(uint8_t drive, uint8_t unit)
+{
+    if (drive >= MAX_DRIVES || unit > TDR_TAPE_SEL_MASK) {
+        return HAL_ERR_INVALID;
+    }
+
+    tape.open = true;
+    tape.drive = drive;
+    tape.unit = unit;
+    tape.seeking = false;
+    tape.gap = false;
+
+    REG32(TAPE_SEG_CTRL_REG) = TAPE_SEG_CLEAR;
+    REG32(FDC_TDR) = TDR_TAPE_MODE | unit;
+
+    return HAL_OK;
+}
+
+void tape_close(void)
+{
+    REG32(TAPE_SEG_CTRL_REG) = 0;
+    REG32(FDC_TDR) = 0;
+    tape.open = false;
+}
+
+int tape_cmd_start(uint8_t cmd)
+{
+    if (!tape.open) {
+        return HAL_ERR_NOT_READY;
+    }
+    if (cmd == 0 || cmd > QIC_CMD_MAX) {
+        return HAL_ERR_INVALID;
+    }
+    if (tape.seeking || tape.gap) {
+        return HAL_ERR_BUSY;
+    }
+
+    /* Step away from the current cylinder by cmd; either way counts */
+    uint8_t cur = hal_get_track(tape.drive);
+    uint8_t target = (cur + cmd <= 0xFF) ? (uint8_t)(cur + cmd) : (uint8_t)(cur - cmd);
+
+    tape.ret = hal_seek_start(tape.drive, target);
+    if (tape.ret != HAL_OK) {
+        return tape.ret;
+    }
+
+    tape.seeking = true;
+    return HAL_OK;
+}
+
+int tape_cmd_poll(void)
+{
+    if (tape.seeking) {
+        int ret = hal_seek_poll(tape.drive);
+
+        if (ret == HAL_ERR_BUSY) {
+            return HAL_ERR_BUSY;
+        }
+        tape.seeking = false;
+        tape.ret = ret;
+        if (ret != HAL_OK) {
+            return ret;
+        }
+
+        /* The controller latches the count once STEP has been quiet */
+        tape.gap = true;
+        tape.gap_start = timer_get_ms();
+    }
+
+    if (tape.gap) {
+        if ((timer_get_ms() - tape.gap_start) < TAPE_CMD_GAP_MS) {
+            return HAL_ERR_BUSY;
+        }
+        tape.gap = false;
+    }
+
+    return tape.ret;
+}
+
+uint32_t tape_status(void)
+{
+    return REG32(TAPE_STATUS_REG);
+}
+
+bool tape_busy(void)
+{
+    return (REG32(TAPE_STATUS_REG) & TAPE_STAT_ACTIVE) != 0;
+}
+
+bool tape_streaming(void)
+{
+    return (REG32(TAPE_DATA_STATUS_REG) & TAPE_DATA_STREAMING) != 0;
+}
+
+void tape_position(uint8_t *track, uint16_t *segment)
+{
+    uint32_t pos = REG32(TAPE_POS_REG);
+
+    if (track != NULL) {
+        *track = (uint8_t)TAPE_POS_TRACK(pos);
+    }
+    if (segment != NULL) {
+        *segment = (uint16_t)TAPE_POS_SEGMENT(pos);
+    }
+}
+
+void tape_seg_start(bool clear)
+{
+    REG32(TAPE_SEG_CTRL_REG) = TAPE_SEG_ENABLE | (clear ? TAPE_SEG_CLEAR : 0);
+}
+
+void tape_seg_stop(void)
+{
+    REG32(TAPE_SEG_CTRL_REG) = 0;
+}
+
+bool tape_seg_active(void)
+{
+    return (REG32(TAPE_SEG_CTRL_REG) & TAPE_SEG_ACTIVE) != 0;
+}
+
+void tape_seg_get_stats(tape_seg_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    uint32_t count = REG32(TAPE_SEG_COUNT_REG);
+    uint32_t errors = REG32(TAPE_SEG_ERRORS_REG);
+
+    stats->segments = (uint16_t)(count >> 16);
+    stats->blocks = (uint16_t)count;
+    stats->gaps = (uint16_t)(errors >> 16);
+    stats->ecc_errors = (uint16_t)errors;
+}
@@ -0,0 +1,133 @@
+/**
+ * FluxRipper SoC - Cooperative Task Scheduler
+ *
+ * Updated: 2025-12-08 14:00
+ */
+
+#include "task.h"
+#include "event.h"
+#include "timer.h"
+
+typedef struct {
+    const char  *name;
+    task_fn_t   fn;
+    uint32_t    period_us;
+    uint8_t     flags;
+    bool        running;            /* On the stack: do not re-enter */
+    uint64_t    next_us;            /* Earliest time of the next call */
+    uint32_t    runs;
+    uint32_t    max_us;
+    uint64_t    total_us;
+} task_t;
+
+static task_t tasks[TASK_MAX];
+static int num_tasks;
+static uint8_t drive_claims;        /* Drive tasks running + explicit claims */
+
+int task_register(const char *name, task_fn_t fn, uint32_t period_us,
+                  uint8_t flags)
+{
+    task_t *t;
+
+    if (num_tasks >= TASK_MAX || fn == NULL) {
+        return -1;
+    }
+
+    t = &tasks[num_tasks];
+    t->name = name;
+    t->fn = fn;
+    t->period_us = period_us;
+    t->flags = flags;
+    t->running = false;
+    t->next_us = 0;
+    t->runs = 0;
+    t->max_us = 0;
+    t->total_us = 0;
+
+    return num_tasks++;
+}
+
+void task_yield(void)
+{
+    for (int i = 0; i < num_tasks; i++) {
+        task_t *t = &tasks[i];
+        uint64_t start, elapsed;
+
+        if (t->running) {
+            continue;
+        }
+        if ((t->flags & TASK_DRIVES) && drive_claims != 0) {
+            continue;
+        }
+
+        start = timer_get_us();
+        if (start < t->next_us) {
+            continue;
+        }
+
+        t->running = true;
+        if (t->flags & TASK_DRIVES) {
+            drive_claims++;
+        }
+
+        t->fn();
+
+        if (t->flags & TASK_DRIVES) {
+            drive_claims--;
+        }
+        t->running = false;
+
+        elapsed = timer_get_us() - start;
+        t->runs++;
+        t->total_us += elapsed;
+        if (elapsed > t->max_us) {
+            t->max_us = (uint32_t)elapsed;
+        }
+        /* Period runs from the start of the call, not from the end */
+        t->next_us = start + t->period_us;
+    }
+}
+
+void task_run(void)
+{
+    event_set_idle_hook(task_yield);
+
+    for (;;) {
+        task_yield();
+    }
+}
+
+void task_drives_claim(void)
+{
+    drive_claims++;
+}
+
+void task_drives_release(void)
+{
+    if (drive_claims != 0) {
+        drive_claims--;
+    }
+}
+
+bool task_drives_busy(void)
+{
+    return drive_claims != 0;
+}
+
+int task_get_stats(int id, task_stats_t *stats)
+{
+    if (id < 0 || id >= num_tasks || stats == NULL) {
+        return -1;
+    }
+
+    stats->name = tasks[id].name;
+    stats->runs = tasks[id].runs;
+    stats->max_us = tasks[id].max_us;
+    stats->total_us = tasks[id].total_us;
+    return 0;
+}
+
+int task_count(void)
+{
+    return num_tasks;
+}
@@ -12,10 +12,15 @@
 /* Clocks per microsecond */
 #define CLKS_PER_US     (CPU_FREQ_HZ / 1000000)
 
-/* Uptime tracking */
-static volatile uint32_t uptime_overflows = 0;
+/* Monotonic clock: counter delta accumulated into microseconds */
+static uint64_t now_us = 0;
+static uint32_t now_rem = 0;         /* Cycles not yet a whole microsecond */
 static uint32_t last_count = 0;
 
+/* Millisecond clock kept alongside, so timer_get_ms() needs no 64-bit divide */
+static uint32_t now_ms = 0;
+static uint32_t ms_rem = 0;          /* Microseconds not yet a whole millisecond */
+
 void timer_init(void)
 {
     /* Load max value for free-running */
@@ -25,8 +30,11 @@ void timer_init(void)
     TIMER_TCSR0 = TIMER_TCSR_LOAD;  /* Load counter */
     TIMER_TCSR0 = TIMER_TCSR_ENT | TIMER_TCSR_ARHT;  /* Enable, auto-reload */
 
-    uptime_overflows = 0;
+    now_us = 0;
+    now_rem = 0;
     last_count = 0;
+    now_ms = 0;
+    ms_rem = 0;
 }
 
 uint32_t timer_get_count(void)
@@ -66,19 +74,50 @@ void timer_delay_ms(uint32_t ms)
 }
 
 uint32_t timer_uptime_ms(void)
+{
+    return timer_get_ms();
+}
+
+/*
+ * Fold the counter delta into both clocks (interrupts masked by the caller).
+ * 32-bit divides only; the remainders carry to the next call, and the
+ * millisecond divide only runs once a whole millisecond has built up.
+ */
+static void timer_update(void)
 {
     uint32_t count = timer_get_count();
 
-    /* Detect overflow */
-    if (count < last_count) {
-        uptime_overflows++;
-    }
+    /* Up counter: unsigned subtraction handles one wrap */
+    uint32_t cycles = (count - last_count) + now_rem;
     last_count = count;
 
-    /* Calculate total milliseconds */
-    /* At 100 MHz, 32-bit counter overflows every ~42.9 seconds */
-    uint32_t ms_from_count = count / (CLKS_PER_US * 1000);
-    uint32_t ms_from_overflows = uptime_overflows * 42949;  /* ~42949 ms per overflow */
+    uint32_t us = cycles / CLKS_PER_US;
+    now_rem = cycles % CLKS_PER_US;
+    now_us += us;
+
+    ms_rem += us;
+    if (ms_rem >= 1000) {
+        now_ms += ms_rem / 1000;
+        ms_rem %= 1000;
+    }
+}
+
+uint64_t timer_get_us(void)
+{
+    uint32_t flags = irq_save();
+    timer_update();
+    uint64_t us = now_us;
+    irq_restore(flags);
+
+    return us;
+}
+
+uint32_t timer_get_ms(void)
+{
+    uint32_t flags = irq_save();
+    timer_update();
+    uint32_t ms = now_ms;
+    irq_restore(flags);
 
-    return ms_from_overflows + ms_from_count;
+    return ms;
 }
@@ -3,67 +3,197 @@
  *
  * AXI UART Lite driver implementation
  *
- * Updated: 2025-12-03 18:00
+ * The interrupt handler is the TX ring's consumer and the RX ring's
+ * producer. Task context also services the FIFOs (to start an idle
+ * transmitter, or before irq_init() and inside the trap handler, where
+ * interrupts are off), always with interrupts masked so the two never
+ * run at once.
+ *
+ * Updated: 2025-12-09 19:00
  */
 
 #include "uart.h"
 #include "platform.h"
+#include "ring.h"
+#include "event.h"
 #include <stdarg.h>
 
+static ring_t tx_ring;
+static ring_t rx_ring;
+static event_t tx_event;                /* Raised when the ISR frees TX space */
+static volatile uint32_t rx_overruns;
+
+/*============================================================================
+ * FIFO Service
+ *============================================================================*/
+
+/**
+ * Move bytes between the rings and the hardware FIFOs
+ * Interrupt context, or task context with interrupts masked.
+ */
+static void uart_service(void)
+{
+    uint32_t stat;
+    uint8_t c;
+
+    while ((stat = UART_STAT) & UART_STAT_RX_VALID) {
+        if (stat & UART_STAT_OVERRUN) {
+            rx_overruns++;
+        }
+        c = (uint8_t)UART_RX_FIFO;
+        ring_push(&rx_ring, &c);
+    }
+
+    while (!(UART_STAT & UART_STAT_TX_FULL) && ring_pop(&tx_ring, &c)) {
+        UART_TX_FIFO = c;
+    }
+}
+
+/**
+ * Service the FIFOs from task context
+ */
+static void uart_kick(void)
+{
+    uint32_t mstatus = irq_save();
+    uart_service();
+    irq_restore(mstatus);
+}
+
+static bool tx_space_check(void *arg)
+{
+    (void)arg;
+    uart_kick();
+    return ring_space(&tx_ring) != 0;
+}
+
+/**
+ * Queue one byte
+ * @param block wait (running the idle hook) while the ring is full
+ * @return true if queued; false if dropped
+ */
+static bool tx_put(char c, bool block)
+{
+    uint8_t b = (uint8_t)c;
+
+    if (block && ring_space(&tx_ring) == 0) {
+        event_clear(&tx_event);
+        event_wait(&tx_event, tx_space_check, NULL, UART_TX_WAIT_MS);
+    }
+
+    /* A full ring refuses the byte and counts it */
+    return ring_push(&tx_ring, &b);
+}
+
+void uart_irq_handler(void)
+{
+    uart_service();
+    event_signal(&tx_event);
+}
+
+/*============================================================================
+ * Character I/O
+ *============================================================================*/
+
 void uart_init(void)
 {
-    /* Reset TX and RX FIFOs */
+    ring_init(&tx_ring, (void *)UART_RING_BASE, 1, UART_TX_RING_SIZE);
+    ring_init(&rx_ring, (void *)(UART_RING_BASE + UART_TX_RING_SIZE), 1,
+              UART_RX_RING_SIZE);
+    rx_overruns = 0;
+
+    /* Reset TX and RX FIFOs, then interrupt on RX data / TX FIFO empty */
     UART_CTRL = UART_CTRL_RST_TX | UART_CTRL_RST_RX;
+    UART_CTRL = UART_CTRL_INTR_EN;
 }
 
 bool uart_rx_ready(void)
 {
-    return (UART_STAT & UART_STAT_RX_VALID) != 0;
+    return !ring_empty(&rx_ring) || (UART_STAT & UART_STAT_RX_VALID) != 0;
 }
 
 bool uart_tx_ready(void)
 {
-    return (UART_STAT & UART_STAT_TX_FULL) == 0;
+    return ring_space(&tx_ring) != 0;
 }
 
 char uart_getc(void)
 {
+    char c;
+
     /* Wait for data */
-    while (!uart_rx_ready())
+    while (!uart_getc_nb(&c))
         ;
-    return (char)(UART_RX_FIFO & 0xFF);
+    return c;
 }
 
 bool uart_getc_nb(char *c)
 {
-    if (!uart_rx_ready())
+    uint8_t b;
+
+    if (ring_empty(&rx_ring)) {
+        uart_kick();
+    }
+    if (!ring_pop(&rx_ring, &b))
         return false;
-    *c = (char)(UART_RX_FIFO & 0xFF);
+    *c = (char)b;
     return true;
 }
 
 void uart_putc(char c)
 {
-    /* Wait for space in TX FIFO */
-    while (!uart_tx_ready())
-        ;
-    UART_TX_FIFO = (uint32_t)c;
+    tx_put(c, true);
+    uart_kick();
+}
+
+bool uart_putc_nb(char c)
+{
+    bool ok = tx_put(c, false);
+
+    uart_kick();
+    return ok;
 }
 
 void uart_puts(const char *s)
 {
     while (*s) {
         if (*s == '\n')
-            uart_putc('\r');
-        uart_putc(*s++);
+            tx_put('\r', true);
+        tx_put(*s++, true);
     }
+    uart_kick();
+}
+
+void uart_flush(void)
+{
+    while (!ring_empty(&tx_ring) || !(UART_STAT & UART_STAT_TX_EMPTY)) {
+        uart_kick();
+    }
+}
+
+void uart_get_stats(uart_stats_t *stats)
+{
+    stats->tx_queued = ring_count(&tx_ring);
+    stats->tx_dropped = tx_ring.dropped;
+    stats->rx_dropped = rx_ring.dropped;
+    stats->rx_overruns = rx_overruns;
 }
 
 /*============================================================================
  * Minimal printf implementation
  *============================================================================*/
 
-static void print_dec(uint32_t val, bool is_signed)
+typedef struct {
+    bool    block;          /* Wait for ring space, else drop */
+    int     count;          /* Characters queued */
+} uart_out_t;
+
+static void out_putc(uart_out_t *o, char c)
+{
+    if (tx_put(c, o->block))
+        o->count++;
+}
+
+static void print_dec(uart_out_t *o, uint32_t val, bool is_signed)
 {
     char buf[12];
     int i = 0;
@@ -75,7 +205,7 @@ static void print_dec(uint32_t val, bool is_signed)
     }
 
     if (val == 0) {
-        uart_putc('0');
+        out_putc(o, '0');
         return;
     }
 
@@ -85,20 +215,20 @@ static void print_dec(uint32_t val, bool is_signed)
     }
 
     if (neg)
-        uart_putc('-');
+        out_putc(o, '-');
 
     while (i > 0)
-        uart_putc(buf[--i]);
+        out_putc(o, buf[--i]);
 }
 
-static void print_hex(uint32_t val, bool uppercase)
+static void print_hex(uart_out_t *o, uint32_t val, bool uppercase)
 {
     const char *digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
     char buf[8];
     int i = 0;
 
     if (val == 0) {
-        uart_putc('0');
+        out_putc(o, '0');
         return;
     }
 
@@ -108,32 +238,27 @@ static void print_hex(uint32_t val, bool uppercase)
     }
 
     while (i > 0)
-        uart_putc(buf[--i]);
+        out_putc(o, buf[--i]);
 }
 
-static void print_hex_padded(uint32_t val, int width, bool uppercase)
+static void print_hex_padded(uart_out_t *o, uint32_t val, int width, bool uppercase)
 {
     const char *digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
 
     for (int i = width - 1; i >= 0; i--) {
-        uart_putc(digits[(val >> (i * 4)) & 0xF]);
+        out_putc(o, digits[(val >> (i * 4)) & 0xF]);
     }
 }
 
-int uart_printf(const char *fmt, ...)
+static int uart_vprintf(uart_out_t *o, const char *fmt, va_list args)
 {
-    va_list args;
-    va_start(args, fmt);
-
-    int count = 0;
     char c;
 
     while ((c = *fmt++) != '\0') {
         if (c != '%') {
             if (c == '\n')
-                uart_putc('\r');
-            uart_putc(c);
-            count++;
+                out_putc(o, '\r');
+            out_putc(o, c);
             continue;
         }
 
@@ -142,55 +267,68 @@ int uart_printf(const char *fmt, ...)
         case 's': {
             const char *s = va_arg(args, const char *);
             if (!s) s = "(null)";
-            while (*s) {
-                uart_putc(*s++);
-                count++;
-            }
+            while (*s)
+                out_putc(o, *s++);
             break;
         }
         case 'c':
-            uart_putc((char)va_arg(args, int));
-            count++;
+            out_putc(o, (char)va_arg(args, int));
             break;
         case 'd':
         case 'i':
-            print_dec((uint32_t)va_arg(args, int), true);
-            count++;  /* Approximate */
+            print_dec(o, (uint32_t)va_arg(args, int), true);
             break;
         case 'u':
-            print_dec(va_arg(args, uint32_t), false);
-            count++;
+            print_dec(o, va_arg(args, uint32_t), false);
             break;
         case 'x':
-            print_hex(va_arg(args, uint32_t), false);
-            count++;
+            print_hex(o, va_arg(args, uint32_t), false);
             break;
         case 'X':
-            print_hex(va_arg(args, uint32_t), true);
-            count++;
+            print_hex(o, va_arg(args, uint32_t), true);
             break;
         case 'p':
-            uart_puts("0x");
-            print_hex_padded((uint32_t)va_arg(args, void *), 8, false);
-            count += 10;
+            out_putc(o, '0');
+            out_putc(o, 'x');
+            print_hex_padded(o, (uint32_t)va_arg(args, void *), 8, false);
             break;
         case '%':
-            uart_putc('%');
-            count++;
+            out_putc(o, '%');
             break;
         case '\0':
             goto done;
         default:
-            uart_putc('%');
-            uart_putc(c);
-            count += 2;
+            out_putc(o, '%');
+            out_putc(o, c);
             break;
         }
     }
 
 done:
+    uart_kick();
+    return o->count;
+}
+
+int uart_printf(const char *fmt, ...)
+{
+    uart_out_t o = { true, 0 };
+    va_list args;
+
+    va_start(args, fmt);
+    uart_vprintf(&o, fmt, args);
+    va_end(args);
+    return o.count;
+}
+
+int uart_printf_nb(const char *fmt, ...)
+{
+    uart_out_t o = { false, 0 };
+    va_list args;
+
+    va_start(args, fmt);
+    uart_vprintf(&o, fmt, args);
     va_end(args);
-    return count;
+    return o.count;
 }
 
 int uart_readline(char *buf, int maxlen)
@@ -234,6 +372,7 @@ void uart_hexdump(const void *addr, uint32_t len)
 {
     const uint8_t *p = (const uint8_t *)addr;
     uint32_t offset = 0;
+    uart_out_t o = { true, 0 };
 
     while (offset < len) {
         /* Address */
@@ -242,7 +381,7 @@ void uart_hexdump(const void *addr, uint32_t len)
         /* Hex bytes */
         for (int i = 0; i < 16; i++) {
             if (offset + i < len) {
-                print_hex_padded(p[offset + i], 2, false);
+                print_hex_padded(&o, p[offset + i], 2, false);
                 uart_putc(' ');
             } else {
                 uart_puts("   ");
@@ -6,6 +6,9 @@
  */
 
 #include "usb_logger_hal.h"
+#include "platform.h"
+#include "timer.h"
+#include "ring.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -28,6 +31,13 @@
 #define REG_BUFFER_DATA      0x20
 #define REG_BUFFER_SIZE      0x24
 #define REG_TRIGGER          0x28
+#define REG_BUFFER_WORD      0x2C
+#define REG_DROP_COUNT       0x30
+#define REG_TRIG_SEQ         0x34
+#define REG_TRIG_MATCH       0x38
+#define REG_TRIG_COUNT       0x3C
+#define REG_TRIG_DEPTH       0x40
+#define REG_TRIG_TIME        0x44
 
 /* Control register bits */
 #define CTRL_ENABLE          (1 << 0)
@@ -38,9 +48,14 @@
 #define STATUS_ACTIVE        (1 << 0)
 #define STATUS_OVERFLOW      (1 << 1)
 #define STATUS_WRAPPED       (1 << 2)
+#define STATUS_ARMED         (1 << 3)
+#define STATUS_POST_DONE     (1 << 4)
 
 /* Trigger register bits */
 #define TRIGGER_ENABLE       (1 << 8)
+#define TRIG_SEQ_SKIP_SOF    (1 << 14)
+#define TRIG_SEQ_MATCH       (1 << 15)
+#define TRIG_GAP_TICKS       64      /* REG_TRIG_COUNT gap unit (60 MHz clocks) */
 
 /*============================================================================
  * Register Access Macros
@@ -55,6 +70,39 @@
 static bool g_initialized = false;
 static uint32_t g_buffer_size = USBLOG_BUFFER_SIZE;
 static uint32_t g_capture_start_ptr = 0;
+static bool g_window_pending = false;   /* Rewind point moves to the trigger window */
+
+/* PCAP export staging (raw drain block, formatted packets) */
+#define EXPORT_DRAIN_SIZE    512
+#define EXPORT_PCAP_SIZE     1024
+
+static uint8_t g_export_raw[EXPORT_DRAIN_SIZE];
+static uint8_t g_export_pcap[EXPORT_PCAP_SIZE];
+
+/*
+ * Streaming: pcapng blocks in HyperRAM, kept as a ring of whole blocks.
+ * The packer claims a block, fills it and commits it; the transport peeks
+ * committed blocks in order and consumes each one on release. The raw
+ * drain block (g_export_raw) carries a record split between two drains.
+ */
+static struct {
+    bool     active;
+    bool     stopping;
+    bool     closed;                /* Statistics block written */
+    bool     need_header;           /* Next block opens the section */
+    bool     filling;               /* A claimed block is being packed */
+    ring_t   ring;                  /* USBLOG_STREAM_BLOCKS blocks */
+    uint32_t len[USBLOG_STREAM_BLOCKS];
+    uint8_t  fill;                  /* Block being packed */
+    uint8_t  sent;                  /* Committed blocks with the transport */
+    uint64_t opened_us;             /* When the fill block got its first byte */
+    uint32_t have;                  /* Raw bytes carried in g_export_raw */
+    uint32_t last_ticks;            /* Timestamp unwrap */
+    uint32_t ticks_hi;
+    uint32_t records;
+    uint32_t blocks;
+    uint64_t bytes;
+} g_stream;
 
 /*============================================================================
  * Initialization
@@ -93,19 +141,49 @@ int usblog_init(void)
 
 int usblog_start(const usblog_trigger_t *trigger)
 {
-    if (!g_initialized) {
+    if (!g_initialized || g_stream.active) {
         return USBLOG_ERR_NOT_READY;
     }
 
     /* Configure trigger */
     if (trigger && trigger->enabled) {
-        USBLOG_REG(REG_TRIGGER) = trigger->pid | TRIGGER_ENABLE;
+        if (trigger->seq_len > USBLOG_TRIG_SEQ_MAX ||
+            trigger->pre_records > USBLOG_PRE_MAX ||
+            trigger->match_offset > USBLOG_MAX_PAYLOAD + 1) {
+            return USBLOG_ERR_INVALID;
+        }
+
+        uint32_t seq = (uint32_t)trigger->seq_len << 12;
+        for (uint8_t i = 0; i < trigger->seq_len; i++) {
+            seq |= (uint32_t)(trigger->seq_pid[i] & 0x0F) << (i * 4);
+        }
+        if (trigger->skip_sof)      seq |= TRIG_SEQ_SKIP_SOF;
+        if (trigger->match_enabled) seq |= TRIG_SEQ_MATCH;
+
+        uint32_t gap = 0;
+        if (trigger->max_gap_us) {
+            uint64_t units = (uint64_t)trigger->max_gap_us * 60 / TRIG_GAP_TICKS;
+            gap = units == 0 ? 1 : units > 0xFFFF ? 0xFFFF : (uint32_t)units;
+        }
+
+        USBLOG_REG(REG_TRIG_SEQ) = seq;
+        USBLOG_REG(REG_TRIG_MATCH) = trigger->match_value |
+                                     ((uint32_t)trigger->match_mask << 8) |
+                                     ((uint32_t)trigger->match_offset << 16);
+        USBLOG_REG(REG_TRIG_COUNT) = trigger->hits | (gap << 16);
+        USBLOG_REG(REG_TRIG_DEPTH) = trigger->pre_records |
+                                     ((uint32_t)trigger->post_records << 16);
+        USBLOG_REG(REG_TRIGGER) = (trigger->pid & 0x0F) | TRIGGER_ENABLE;
     } else {
+        USBLOG_REG(REG_TRIG_SEQ) = 0;
+        USBLOG_REG(REG_TRIG_COUNT) = 0;
+        USBLOG_REG(REG_TRIG_DEPTH) = 0;
         USBLOG_REG(REG_TRIGGER) = 0;
     }
 
-    /* Save start position for rewind */
+    /* Save start position for rewind; a trigger moves it to the window */
     g_capture_start_ptr = USBLOG_REG(REG_WRITE_PTR);
+    g_window_pending = trigger && trigger->enabled;
 
     /* Enable capture */
     USBLOG_REG(REG_CONTROL) = CTRL_ENABLE;
@@ -118,6 +196,9 @@ int usblog_stop(void)
     if (!g_initialized) {
         return USBLOG_ERR_NOT_READY;
     }
+    if (g_stream.active) {
+        return usblog_stream_stop();
+    }
 
     USBLOG_REG(REG_CONTROL) = 0;
     return USBLOG_OK;
@@ -125,7 +206,7 @@ int usblog_stop(void)
 
 int usblog_clear(void)
 {
-    if (!g_initialized) {
+    if (!g_initialized || g_stream.active) {
         return USBLOG_ERR_NOT_READY;
     }
 
@@ -166,6 +247,10 @@ int usblog_get_status(usblog_status_t *status)
         status->bytes_used = g_buffer_size - rd_ptr + wr_ptr;
     }
     status->bytes_free = g_buffer_size - status->bytes_used;
+    status->drop_count = USBLOG_REG(REG_DROP_COUNT);
+    status->armed = (stat & STATUS_ARMED) != 0;
+    status->post_done = (stat & STATUS_POST_DONE) != 0;
+    status->trigger_time_us = USBLOG_REG(REG_TRIG_TIME) / 60;
 
     return USBLOG_OK;
 }
@@ -227,6 +312,26 @@ static uint8_t read_buffer_byte(void)
     return (uint8_t)(USBLOG_REG(REG_BUFFER_DATA) & 0xFF);
 }
 
+/**
+ * Check if the logger owns the read pointer (armed, pre-trigger window)
+ *
+ * Once it lets go, the read pointer sits on the oldest record kept from
+ * before the trigger, which becomes the rewind point.
+ */
+static bool window_armed(void)
+{
+    if (!g_window_pending) {
+        return false;
+    }
+    if (USBLOG_REG(REG_STATUS) & STATUS_ARMED) {
+        return true;
+    }
+
+    g_capture_start_ptr = USBLOG_REG(REG_READ_PTR);
+    g_window_pending = false;
+    return false;
+}
+
 /**
  * Check if buffer has data available
  */
@@ -237,54 +342,125 @@ static bool has_data(void)
     return wr_ptr != rd_ptr;
 }
 
-int usblog_read_record(usblog_record_t *record)
+/**
+ * Bytes waiting between read and write pointers
+ */
+static uint32_t bytes_available(void)
 {
-    if (!g_initialized || !record) {
-        return USBLOG_ERR_NOT_READY;
-    }
+    uint32_t wr_ptr = USBLOG_REG(REG_WRITE_PTR);
+    uint32_t rd_ptr = USBLOG_REG(REG_READ_PTR);
 
-    if (!has_data()) {
-        return USBLOG_ERR_EMPTY;
+    if (wr_ptr >= rd_ptr) {
+        return wr_ptr - rd_ptr;
     }
+    return g_buffer_size - rd_ptr + wr_ptr;
+}
 
-    /* Read header byte */
-    uint8_t header = read_buffer_byte();
+/**
+ * Decode the fixed record header (header byte, timestamp, length)
+ */
+static void decode_record_header(const uint8_t *raw, usblog_record_t *record)
+{
+    uint8_t header = raw[0];
 
-    /* Decode header */
     record->rec_type = (header >> 5) & 0x07;
     record->direction = (header >> 4) & 0x01;
     record->pid = header & 0x0F;
     record->is_tx = (header & 0x80) != 0;
     record->endpoint = 0;  /* Extracted from token if present */
 
-    /* Read timestamp (4 bytes, little-endian) */
-    uint32_t ts = 0;
-    ts |= read_buffer_byte();
-    ts |= read_buffer_byte() << 8;
-    ts |= read_buffer_byte() << 16;
-    ts |= read_buffer_byte() << 24;
-
-    /* Convert from 60 MHz ticks to microseconds */
+    /* Timestamp (4 bytes, little-endian), 60 MHz ticks to microseconds */
+    uint32_t ts = (uint32_t)raw[1] | ((uint32_t)raw[2] << 8) |
+                  ((uint32_t)raw[3] << 16) | ((uint32_t)raw[4] << 24);
     record->timestamp_us = ts / 60;
 
-    /* Read length */
-    record->length = read_buffer_byte();
+    record->length = raw[5];
     if (record->length > USBLOG_MAX_PAYLOAD + 2) {
         record->length = USBLOG_MAX_PAYLOAD + 2;
     }
+}
+
+/**
+ * Extract endpoint from token data if applicable
+ */
+static void decode_record_endpoint(usblog_record_t *record)
+{
+    if (record->rec_type == USBLOG_REC_TOKEN && record->length >= 2) {
+        record->endpoint = ((record->payload[1] & 0x07) << 1) |
+                          ((record->payload[0] >> 7) & 0x01);
+    }
+}
+
+int usblog_read_record(usblog_record_t *record)
+{
+    if (!g_initialized || !record || g_stream.active) {
+        return USBLOG_ERR_NOT_READY;
+    }
+
+    if (window_armed() || !has_data()) {
+        return USBLOG_ERR_EMPTY;
+    }
+
+    uint8_t raw[USBLOG_REC_HDR_SIZE];
+    for (int i = 0; i < USBLOG_REC_HDR_SIZE; i++) {
+        raw[i] = read_buffer_byte();
+    }
+    decode_record_header(raw, record);
 
     /* Read payload */
     for (uint8_t i = 0; i < record->length; i++) {
         record->payload[i] = read_buffer_byte();
     }
 
-    /* Extract endpoint from token data if applicable */
-    if (record->rec_type == USBLOG_REC_TOKEN && record->length >= 2) {
-        record->endpoint = ((record->payload[1] & 0x07) << 1) |
-                          ((record->payload[0] >> 7) & 0x01);
+    decode_record_endpoint(record);
+    return USBLOG_OK;
+}
+
+uint32_t usblog_drain(uint8_t *buf, uint32_t maxlen)
+{
+    if (!g_initialized || !buf || window_armed()) {
+        return 0;
     }
 
-    return USBLOG_OK;
+    uint32_t len = bytes_available();
+    if (len > maxlen) {
+        len = maxlen;
+    }
+
+    /* Whole words through the burst port, then the odd tail bytes */
+    uint32_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        uint32_t w = USBLOG_REG(REG_BUFFER_WORD);
+        buf[i]     = (uint8_t)w;
+        buf[i + 1] = (uint8_t)(w >> 8);
+        buf[i + 2] = (uint8_t)(w >> 16);
+        buf[i + 3] = (uint8_t)(w >> 24);
+    }
+    for (; i < len; i++) {
+        buf[i] = read_buffer_byte();
+    }
+
+    return len;
+}
+
+uint32_t usblog_parse_record(const uint8_t *buf, uint32_t len,
+                             usblog_record_t *record)
+{
+    if (!buf || !record || len < USBLOG_REC_HDR_SIZE) {
+        return 0;
+    }
+
+    /* Framing length as stored, even if the decoded length is clamped */
+    uint32_t total = USBLOG_REC_HDR_SIZE + buf[5];
+    if (len < total) {
+        return 0;
+    }
+
+    decode_record_header(buf, record);
+    memcpy(record->payload, &buf[USBLOG_REC_HDR_SIZE], record->length);
+    decode_record_endpoint(record);
+
+    return total;
 }
 
 int usblog_peek_record(usblog_record_t *record)
@@ -321,6 +497,10 @@ int usblog_rewind(void)
         return USBLOG_ERR_NOT_READY;
     }
 
+    if (window_armed()) {
+        return USBLOG_ERR_NOT_READY;
+    }
+
     USBLOG_REG(REG_READ_PTR) = g_capture_start_ptr;
     return USBLOG_OK;
 }
@@ -356,13 +536,12 @@ int usblog_write_pcap_header(void (*write_fn)(const uint8_t*, uint32_t))
     return USBLOG_OK;
 }
 
-int usblog_write_pcap_record(const usblog_record_t *record,
-                              void (*write_fn)(const uint8_t*, uint32_t))
+/**
+ * Format one record as a PCAP packet
+ * @return Packet size in bytes (at most USBLOG_PCAP_REC_MAX)
+ */
+static uint32_t build_pcap_record(const usblog_record_t *record, uint8_t *dst)
 {
-    if (!record || !write_fn) {
-        return USBLOG_ERR_INVALID;
-    }
-
     /* Build USB 2.0 PCAP header */
     pcap_usb2_header_t usb_hdr = {
         .pid = record->pid,
@@ -385,13 +564,67 @@ int usblog_write_pcap_record(const usblog_record_t *record,
         .orig_len = pkt_len
     };
 
-    /* Write headers and payload */
-    write_fn((const uint8_t*)&pkt_hdr, sizeof(pkt_hdr));
-    write_fn((const uint8_t*)&usb_hdr, sizeof(usb_hdr));
-    if (record->length > 0) {
-        write_fn(record->payload, record->length);
+    memcpy(dst, &pkt_hdr, sizeof(pkt_hdr));
+    memcpy(dst + sizeof(pkt_hdr), &usb_hdr, sizeof(usb_hdr));
+    memcpy(dst + sizeof(pkt_hdr) + sizeof(usb_hdr), record->payload,
+           record->length);
+
+    return sizeof(pkt_hdr) + pkt_len;
+}
+
+int usblog_write_pcap_record(const usblog_record_t *record,
+                              void (*write_fn)(const uint8_t*, uint32_t))
+{
+    if (!record || !write_fn) {
+        return USBLOG_ERR_INVALID;
     }
 
+    uint8_t pkt[USBLOG_PCAP_REC_MAX];
+    write_fn(pkt, build_pcap_record(record, pkt));
+
+    return USBLOG_OK;
+}
+
+int usblog_pcap_batch_init(usblog_pcap_batch_t *batch, uint8_t *buf,
+                           uint32_t size,
+                           void (*write_fn)(const uint8_t*, uint32_t))
+{
+    if (!batch || !buf || !write_fn || size < USBLOG_PCAP_REC_MAX) {
+        return USBLOG_ERR_INVALID;
+    }
+
+    batch->buf = buf;
+    batch->size = size;
+    batch->used = 0;
+    batch->write_fn = write_fn;
+    return USBLOG_OK;
+}
+
+int usblog_pcap_batch_flush(usblog_pcap_batch_t *batch)
+{
+    if (!batch || !batch->write_fn) {
+        return USBLOG_ERR_INVALID;
+    }
+
+    if (batch->used > 0) {
+        batch->write_fn(batch->buf, batch->used);
+        batch->used = 0;
+    }
+    return USBLOG_OK;
+}
+
+int usblog_pcap_batch_add(usblog_pcap_batch_t *batch,
+                          const usblog_record_t *record)
+{
+    if (!batch || !record || !batch->write_fn) {
+        return USBLOG_ERR_INVALID;
+    }
+
+    if (batch->size - batch->used < USBLOG_PCAP_REC_MAX) {
+        usblog_pcap_batch_flush(batch);
+    }
+
+    batch->used += build_pcap_record(record, batch->buf + batch->used);
     return USBLOG_OK;
 }
 
@@ -400,6 +633,9 @@ int usblog_export_pcap(void (*write_fn)(const uint8_t*, uint32_t))
     if (!write_fn) {
         return USBLOG_ERR_INVALID;
     }
+    if (g_stream.active) {
+        return USBLOG_ERR_NOT_READY;
+    }
 
     /* Write PCAP global header */
     int ret = usblog_write_pcap_header(write_fn);
@@ -410,21 +646,397 @@ int usblog_export_pcap(void (*write_fn)(const uint8_t*, uint32_t))
     /* Rewind to start of capture */
     usblog_rewind();
 
-    /* Export all records */
+    usblog_pcap_batch_t batch;
+    usblog_pcap_batch_init(&batch, g_export_pcap, sizeof(g_export_pcap),
+                           write_fn);
+
+    /* Export all records, one drained block at a time */
     int count = 0;
+    uint32_t have = 0;
     usblog_record_t record;
 
-    while (usblog_read_record(&record) == USBLOG_OK) {
-        ret = usblog_write_pcap_record(&record, write_fn);
-        if (ret != USBLOG_OK) {
-            return ret;
+    for (;;) {
+        uint32_t got = usblog_drain(g_export_raw + have,
+                                    sizeof(g_export_raw) - have);
+        have += got;
+
+        uint32_t pos = 0;
+        uint32_t used;
+        while ((used = usblog_parse_record(g_export_raw + pos, have - pos,
+                                           &record)) != 0) {
+            usblog_pcap_batch_add(&batch, &record);
+            pos += used;
+            count++;
+        }
+
+        /* Carry a record split across blocks to the next one */
+        have -= pos;
+        memmove(g_export_raw, g_export_raw + pos, have);
+
+        if (got == 0) {
+            break;
         }
-        count++;
     }
 
+    usblog_pcap_batch_flush(&batch);
     return count;
 }
 
+/*============================================================================
+ * Streaming Capture (pcapng)
+ *============================================================================*/
+
+/* pcapng block types */
+#define PCAPNG_SHB           0x0A0D0D0A
+#define PCAPNG_IDB           0x00000001
+#define PCAPNG_ISB           0x00000005
+#define PCAPNG_EPB           0x00000006
+#define PCAPNG_BYTE_ORDER    0x1A2B3C4D
+
+/* Options */
+#define PCAPNG_OPT_END       0
+#define PCAPNG_IF_TSRESOL    9          /* IDB: timestamp resolution */
+#define PCAPNG_ISB_IFDROP    5          /* ISB: packets dropped */
+
+#define PCAPNG_SHB_LEN       28
+#define PCAPNG_IDB_LEN       32
+#define PCAPNG_ISB_LEN       40
+#define PCAPNG_EPB_LEN(n)    (32 + (((n) + 3) & ~3u))
+#define PCAPNG_EPB_MAX       PCAPNG_EPB_LEN(1 + USBLOG_MAX_PAYLOAD + 2)
+
+/* Records drained per poll, bounded so other tasks keep running */
+#define STREAM_DRAIN_PASSES  4
+
+static inline uint8_t *stream_block(uint8_t i)
+{
+    return (uint8_t *)(USBLOG_STREAM_BASE + (uint32_t)i * USBLOG_STREAM_BLOCK_SIZE);
+}
+
+static inline uint8_t stream_block_index(const uint8_t *block)
+{
+    return (uint8_t)((uint32_t)(block - stream_block(0)) / USBLOG_STREAM_BLOCK_SIZE);
+}
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint8_t *put_section_header(uint8_t *p)
+{
+    p = put_u32(p, PCAPNG_SHB);
+    p = put_u32(p, PCAPNG_SHB_LEN);
+    p = put_u32(p, PCAPNG_BYTE_ORDER);
+    p = put_u16(p, 1);                  /* Version 1.0 */
+    p = put_u16(p, 0);
+    p = put_u32(p, 0xFFFFFFFF);         /* Section length unknown */
+    p = put_u32(p, 0xFFFFFFFF);
+    p = put_u32(p, PCAPNG_SHB_LEN);
+
+    /* One interface, timestamps in nanoseconds */
+    p = put_u32(p, PCAPNG_IDB);
+    p = put_u32(p, PCAPNG_IDB_LEN);
+    p = put_u16(p, LINKTYPE_USB_2_0);
+    p = put_u16(p, 0);
+    p = put_u32(p, PCAP_SNAPLEN);
+    p = put_u16(p, PCAPNG_IF_TSRESOL);
+    p = put_u16(p, 1);
+    p = put_u32(p, 9);                  /* 10^-9, padded to 4 bytes */
+    p = put_u32(p, PCAPNG_OPT_END);
+    p = put_u32(p, PCAPNG_IDB_LEN);
+    return p;
+}
+
+/**
+ * 60 MHz record timestamp to nanoseconds, extended past the 32-bit wrap
+ * (every 71.6 s) by watching it go backwards
+ */
+static uint64_t stream_timestamp_ns(uint32_t ticks)
+{
+    if (ticks < g_stream.last_ticks) {
+        g_stream.ticks_hi++;
+    }
+    g_stream.last_ticks = ticks;
+
+    uint64_t t = ((uint64_t)g_stream.ticks_hi << 32) | ticks;
+    return t * 50 / 3;
+}
+
+static uint8_t *put_packet(uint8_t *p, const uint8_t *raw,
+                           const usblog_record_t *record)
+{
+    uint32_t ticks = (uint32_t)raw[1] | ((uint32_t)raw[2] << 8) |
+                     ((uint32_t)raw[3] << 16) | ((uint32_t)raw[4] << 24);
+    uint64_t ns = stream_timestamp_ns(ticks);
+    uint32_t caplen = 1 + record->length;
+    uint32_t blen = PCAPNG_EPB_LEN(caplen);
+
+    p = put_u32(p, PCAPNG_EPB);
+    p = put_u32(p, blen);
+    p = put_u32(p, 0);                  /* Interface 0 */
+    p = put_u32(p, (uint32_t)(ns >> 32));
+    p = put_u32(p, (uint32_t)ns);
+    p = put_u32(p, caplen);
+    p = put_u32(p, caplen);
+
+    /* LINKTYPE_USB_2_0 packet: full PID byte, then the bytes after it */
+    *p++ = (uint8_t)(record->pid | ((~record->pid & 0x0F) << 4));
+    memcpy(p, record->payload, record->length);
+    p += record->length;
+    while ((caplen & 3) != 0) {
+        *p++ = 0;
+        caplen++;
+    }
+
+    return put_u32(p, blen);
+}
+
+static uint8_t *put_statistics(uint8_t *p, uint32_t dropped)
+{
+    uint64_t ns = ((uint64_t)g_stream.ticks_hi << 32 | g_stream.last_ticks) * 50 / 3;
+
+    p = put_u32(p, PCAPNG_ISB);
+    p = put_u32(p, PCAPNG_ISB_LEN);
+    p = put_u32(p, 0);                  /* Interface 0 */
+    p = put_u32(p, (uint32_t)(ns >> 32));
+    p = put_u32(p, (uint32_t)ns);
+    p = put_u16(p, PCAPNG_ISB_IFDROP);
+    p = put_u16(p, 8);
+    p = put_u32(p, dropped);
+    p = put_u32(p, 0);
+    p = put_u32(p, PCAPNG_OPT_END);
+    return put_u32(p, PCAPNG_ISB_LEN);
+}
+
+/**
+ * Finish the fill block and move on
+ */
+static void stream_close_block(void)
+{
+    if (!g_stream.filling) {
+        return;
+    }
+
+    /* An empty block is left claimed-but-uncommitted, i.e. free again */
+    g_stream.filling = false;
+    if (g_stream.len[g_stream.fill] != 0) {
+        ring_commit(&g_stream.ring);
+    }
+}
+
+/**
+ * Get space for n bytes in the fill block, opening a new block if needed
+ * @return write pointer, or NULL if every block is with the transport
+ */
+static uint8_t *stream_reserve(uint32_t n)
+{
+    if (g_stream.filling &&
+        USBLOG_STREAM_BLOCK_SIZE - g_stream.len[g_stream.fill] < n) {
+        stream_close_block();
+    }
+
+    if (!g_stream.filling) {
+        uint8_t *block = ring_claim(&g_stream.ring);
+        if (block == NULL) {
+            return NULL;
+        }
+
+        uint8_t i = stream_block_index(block);
+        g_stream.filling = true;
+        g_stream.fill = i;
+        g_stream.len[i] = 0;
+        g_stream.opened_us = timer_get_us();
+
+        if (g_stream.need_header) {
+            g_stream.need_header = false;
+            g_stream.len[i] = (uint32_t)(put_section_header(block) - block);
+        }
+    }
+
+    return stream_block(g_stream.fill) + g_stream.len[g_stream.fill];
+}
+
+static void stream_commit(uint8_t *end)
+{
+    g_stream.len[g_stream.fill] = (uint32_t)(end - stream_block(g_stream.fill));
+}
+
+int usblog_stream_start(const usblog_trigger_t *trigger)
+{
+    if (!g_initialized || g_stream.active) {
+        return USBLOG_ERR_NOT_READY;
+    }
+
+    usblog_clear();
+
+    memset(&g_stream, 0, sizeof(g_stream));
+    ring_init(&g_stream.ring, stream_block(0), USBLOG_STREAM_BLOCK_SIZE,
+              USBLOG_STREAM_BLOCKS);
+    g_stream.need_header = true;
+
+    int ret = usblog_start(trigger);
+    if (ret != USBLOG_OK) {
+        return ret;
+    }
+
+    g_stream.active = true;
+    return USBLOG_OK;
+}
+
+int usblog_stream_stop(void)
+{
+    if (!g_stream.active) {
+        return USBLOG_ERR_NOT_READY;
+    }
+
+    USBLOG_REG(REG_CONTROL) = 0;
+    g_stream.stopping = true;
+    return USBLOG_OK;
+}
+
+void usblog_stream_poll(void)
+{
+    usblog_record_t record;
+    bool blocked = false;
+    uint32_t got = 0;
+
+    if (!g_stream.active || g_stream.closed) {
+        return;
+    }
+
+    /* Armed: the logger owns the read pointer for the pre-trigger window */
+    uint32_t stat = USBLOG_REG(REG_STATUS);
+    if ((stat & STATUS_ARMED) && !g_stream.stopping) {
+        return;
+    }
+
+    /* Post-trigger window captured: finish the stream */
+    if ((stat & STATUS_POST_DONE) && !g_stream.stopping) {
+        usblog_stream_stop();
+    }
+
+    for (int pass = 0; pass < STREAM_DRAIN_PASSES && !blocked; pass++) {
+        got = usblog_drain(g_export_raw + g_stream.have,
+                           sizeof(g_export_raw) - g_stream.have);
+        g_stream.have += got;
+
+        uint32_t pos = 0;
+        uint32_t used;
+        while ((used = usblog_parse_record(g_export_raw + pos,
+                                           g_stream.have - pos,
+                                           &record)) != 0) {
+            /* Transport behind: the logger FIFO takes the slack */
+            uint8_t *p = stream_reserve(PCAPNG_EPB_MAX);
+            if (p == NULL) {
+                blocked = true;
+                break;
+            }
+            stream_commit(put_packet(p, g_export_raw + pos, &record));
+            g_stream.records++;
+            pos += used;
+        }
+
+        g_stream.have -= pos;
+        memmove(g_export_raw, g_export_raw + pos, g_stream.have);
+
+        if (got == 0) {
+            break;
+        }
+    }
+
+    /* Stopped and drained: close the section with the drop count */
+    if (g_stream.stopping && !blocked && got == 0) {
+        uint8_t *p = stream_reserve(PCAPNG_ISB_LEN);
+        if (p != NULL) {
+            stream_commit(put_statistics(p, USBLOG_REG(REG_DROP_COUNT)));
+            stream_close_block();
+            g_stream.closed = true;
+        }
+        return;
+    }
+
+    /* Light traffic: don't sit on a part-filled block */
+    if (g_stream.filling &&
+        timer_get_us() - g_stream.opened_us >= USBLOG_STREAM_FLUSH_US) {
+        stream_close_block();
+    }
+}
+
+int usblog_stream_get(const uint8_t **data, uint32_t *len)
+{
+    if (!data || !len) {
+        return USBLOG_ERR_INVALID;
+    }
+
+    usblog_stream_poll();
+
+    if (!g_stream.active) {
+        return 0;
+    }
+
+    const uint8_t *block = ring_peek(&g_stream.ring, g_stream.sent);
+    if (block == NULL) {
+        return 0;
+    }
+
+    uint8_t i = stream_block_index(block);
+    g_stream.sent++;
+    g_stream.blocks++;
+    g_stream.bytes += g_stream.len[i];
+
+    *data = block;
+    *len = g_stream.len[i];
+    return 1;
+}
+
+void usblog_stream_release(void)
+{
+    if (!g_stream.active) {
+        return;
+    }
+
+    if (g_stream.sent != 0) {
+        ring_consume(&g_stream.ring, 1);
+        g_stream.sent--;
+    }
+
+    /* Last block back: the stream is over */
+    if (g_stream.closed && ring_empty(&g_stream.ring)) {
+        g_stream.active = false;
+    }
+}
+
+bool usblog_stream_active(void)
+{
+    return g_stream.active;
+}
+
+int usblog_stream_get_stats(usblog_stream_stats_t *stats)
+{
+    if (!g_initialized || !stats) {
+        return USBLOG_ERR_NOT_READY;
+    }
+
+    stats->active = g_stream.active;
+    stats->stopping = g_stream.stopping;
+    stats->records = g_stream.records;
+    stats->dropped = USBLOG_REG(REG_DROP_COUNT);
+    stats->blocks = g_stream.blocks;
+    stats->bytes = g_stream.bytes;
+    return USBLOG_OK;
+}
+
 /*============================================================================
  * Utility Functions
  *============================================================================*/
@@ -20,7 +20,8 @@
 static wd_config_t g_wd_config = {
     .variant = WD_VARIANT_GENERIC,
     .features = WD_FEAT_BIG_BUFFER | WD_FEAT_SET_GET_PARAMS |
-                WD_FEAT_GET_DIAG | WD_FEAT_GET_ID | WD_FEAT_MULTIPLE_SECT,
+                WD_FEAT_GET_DIAG | WD_FEAT_GET_ID | WD_FEAT_MULTIPLE_SECT |
+                WD_FEAT_TRACK_WINDOW,
     .step_rate = 3,
     .head_settle = 15,
     .irq_enabled = true,
@@ -66,13 +67,29 @@ static struct {
 /* Sector buffer pointer for data transfers */
 static uint16_t g_buffer_offset = 0;
 
+/*
+ * READ SECTORS/MULTIPLE burst: the whole sector count is read into
+ * WD_BURST_BASE before DRQ goes up, and the data register is served
+ * from memory instead of one MMIO round trip per word.
+ */
+static struct {
+    bool      active;
+    uint16_t  *data;        /* Staging buffer */
+    uint32_t  word;         /* Next word to hand to the host */
+    uint16_t  good;         /* Sectors read successfully */
+    uint16_t  served;       /* Sectors fully transferred */
+    uint8_t   block;        /* Sectors per DRQ block (IRQ interval) */
+    uint8_t   block_left;   /* Sectors left in the current block */
+} g_burst;
+
 /*============================================================================
  * Private Function Declarations
  *============================================================================*/
 
 static void wd_update_status(void);
 static int  wd_exec_restore(uint8_t step_rate);
-static int  wd_exec_read_sectors(bool with_retry, bool long_mode);
+static int  wd_exec_read_sectors(bool with_retry, bool long_mode,
+                                 uint8_t block);
 static int  wd_exec_write_sectors(bool with_retry, bool long_mode);
 static int  wd_exec_verify(bool with_retry);
 static int  wd_exec_format_track(void);
@@ -80,6 +97,9 @@ static int  wd_exec_seek(uint8_t step_rate);
 static int  wd_exec_diagnostics(void);
 static int  wd_exec_set_params(void);
 static int  wd_exec_identify(void);
+static int  wd_exec_set_multiple(void);
+static int  wd_exec_load_window(void);
+static void wd_window_header(uint8_t loaded);
 static void wd_set_error(uint8_t error);
 static void wd_complete_command(void);
 
@@ -121,7 +141,9 @@ int wd_reset(void)
     g_wd_state.command = 0;
     g_wd_state.bytes_pending = 0;
     g_wd_state.irq_pending = false;
+    g_wd_state.multiple = 0;
     g_buffer_offset = 0;
+    g_burst.active = false;
 
     /* Reset diagnostic result */
     g_diag_result.code = WD_DIAG_OK;
@@ -129,6 +151,7 @@ int wd_reset(void)
 
     /* Invalidate track buffer */
     wd_invalidate_buffer();
+    wd_window_header(0);
 
     return HAL_OK;
 }
@@ -190,7 +213,7 @@ uint32_t wd_variant_default_features(wd_variant_t variant)
             return WD_FEAT_RLL27 | WD_FEAT_SET_GET_PARAMS | WD_FEAT_GET_DIAG |
                    WD_FEAT_GET_ID | WD_FEAT_ESDI | WD_FEAT_BIG_BUFFER |
                    WD_FEAT_READ_WRITE_LONG | WD_FEAT_MULTIPLE_SECT |
-                   WD_FEAT_CORRECTED_STAT;
+                   WD_FEAT_CORRECTED_STAT | WD_FEAT_TRACK_WINDOW;
     }
 }
 
@@ -314,47 +337,125 @@ void wd_write_reg(uint8_t reg, uint8_t value)
     }
 }
 
+/*
+ * Step the task file CHS to the next sector, wrapping at the geometry
+ */
+static void wd_next_sector(void)
+{
+    g_wd_state.sector++;
+    if (g_wd_state.sector > g_drive_geometry[g_wd_state.drive].sectors) {
+        g_wd_state.sector = 1;
+        g_wd_state.head++;
+        if (g_wd_state.head >= g_drive_geometry[g_wd_state.drive].heads) {
+            g_wd_state.head = 0;
+            g_wd_state.cylinder++;
+        }
+    }
+}
+
+/*
+ * Burst sector boundary: advance the task file like the real controller
+ * and keep DRQ up for the next sector. Returns true at the end of a DRQ
+ * block (IRQ raised) or of the command.
+ */
+static bool wd_burst_sector_done(void)
+{
+    g_burst.served++;
+    g_wd_state.sector_count--;
+    if (g_wd_state.sector_count == 0) {
+        /* All sectors transferred */
+        g_burst.active = false;
+        wd_complete_command();
+        return true;
+    }
+
+    wd_next_sector();
+
+    if (g_burst.served >= g_burst.good) {
+        /* Task file now points at the sector that failed to read */
+        g_burst.active = false;
+        wd_set_error(WD_ERROR_IDNF);
+        return true;
+    }
+
+    g_wd_state.bytes_pending = 512;
+    if (--g_burst.block_left == 0) {
+        g_burst.block_left = g_burst.block;
+        if (g_wd_config.irq_enabled) {
+            g_wd_state.irq_pending = true;
+        }
+        return true;
+    }
+
+    return false;
+}
+
 uint16_t wd_read_data(void)
 {
     uint16_t data = 0;
 
-    if (g_wd_state.state == WD_STATE_DATA_OUT &&
-        (g_wd_state.status & WD_STATUS_DRQ)) {
-        /* Read from hardware buffer */
-        REG32(WD_BUFFER_ADDR) = g_buffer_offset;
-        data = (uint16_t)REG32(WD_BUFFER_DATA);
-        g_buffer_offset += 2;
-        g_wd_state.bytes_pending -= 2;
+    if (g_wd_state.state != WD_STATE_DATA_OUT ||
+        !(g_wd_state.status & WD_STATUS_DRQ)) {
+        return data;
+    }
 
+    if (g_burst.active) {
+        data = g_burst.data[g_burst.word++];
+        g_wd_state.bytes_pending -= 2;
         if (g_wd_state.bytes_pending == 0) {
-            /* Sector complete */
-            g_wd_state.sector_count--;
-            if (g_wd_state.sector_count == 0) {
-                /* All sectors transferred */
-                wd_complete_command();
-            } else {
-                /* More sectors - advance to next */
-                g_wd_state.sector++;
-                if (g_wd_state.sector > g_drive_geometry[g_wd_state.drive].sectors) {
-                    g_wd_state.sector = 1;
-                    g_wd_state.head++;
-                    if (g_wd_state.head >= g_drive_geometry[g_wd_state.drive].heads) {
-                        g_wd_state.head = 0;
-                        g_wd_state.cylinder++;
-                    }
-                }
-                g_wd_state.bytes_pending = 512;
-                g_buffer_offset = 0;
-                /* Read next sector */
-                hdd_read_sector(g_wd_state.drive, g_wd_state.cylinder,
-                               g_wd_state.head, g_wd_state.sector, NULL);
-            }
+            wd_burst_sector_done();
         }
+        return data;
+    }
+
+    /* Single-block data (IDENTIFY): read from hardware buffer */
+    REG32(WD_BUFFER_ADDR) = g_buffer_offset;
+    data = (uint16_t)REG32(WD_BUFFER_DATA);
+    g_buffer_offset += 2;
+    g_wd_state.bytes_pending -= 2;
+
+    if (g_wd_state.bytes_pending == 0) {
+        wd_complete_command();
     }
 
     return data;
 }
 
+uint32_t wd_read_data_block(uint16_t *buf, uint32_t words)
+{
+    uint32_t done = 0;
+
+    if (buf == NULL) {
+        return 0;
+    }
+
+    if (!g_burst.active) {
+        while (done < words && g_wd_state.state == WD_STATE_DATA_OUT &&
+               (g_wd_state.status & WD_STATUS_DRQ)) {
+            buf[done++] = wd_read_data();
+        }
+        return done;
+    }
+
+    while (done < words && g_burst.active) {
+        uint32_t n = g_wd_state.bytes_pending / 2;
+        if (n > words - done) {
+            n = words - done;
+        }
+
+        memcpy(&buf[done], &g_burst.data[g_burst.word], n * 2);
+        g_burst.word += n;
+        g_wd_state.bytes_pending -= (uint16_t)(n * 2);
+        done += n;
+
+        if (g_wd_state.bytes_pending == 0 && wd_burst_sector_done()) {
+            break;
+        }
+    }
+
+    return done;
+}
+
 void wd_write_data(uint16_t value)
 {
     if (g_wd_state.state == WD_STATE_DATA_IN &&
@@ -406,7 +507,22 @@ int wd_process_command(uint8_t cmd)
     switch (cmd) {
         case WD_CMD_READ_SECTORS:
         case WD_CMD_READ_SECTORS_NR:
-            return wd_exec_read_sectors(cmd == WD_CMD_READ_SECTORS, false);
+            return wd_exec_read_sectors(cmd == WD_CMD_READ_SECTORS, false, 1);
+
+        case WD_CMD_READ_MULTIPLE:
+            if (!wd_feature_enabled(WD_FEAT_MULTIPLE_SECT) ||
+                g_wd_state.multiple == 0) {
+                wd_set_error(WD_ERROR_ABRT);
+                return HAL_ERR_NOT_SUPPORTED;
+            }
+            return wd_exec_read_sectors(true, false, g_wd_state.multiple);
+
+        case WD_CMD_SET_MULTIPLE:
+            if (!wd_feature_enabled(WD_FEAT_MULTIPLE_SECT)) {
+                wd_set_error(WD_ERROR_ABRT);
+                return HAL_ERR_NOT_SUPPORTED;
+            }
+            return wd_exec_set_multiple();
 
         case WD_CMD_READ_LONG:
         case WD_CMD_READ_LONG_NR:
@@ -414,7 +530,7 @@ int wd_process_command(uint8_t cmd)
                 wd_set_error(WD_ERROR_ABRT);
                 return HAL_ERR_NOT_SUPPORTED;
             }
-            return wd_exec_read_sectors(cmd == WD_CMD_READ_LONG, true);
+            return wd_exec_read_sectors(cmd == WD_CMD_READ_LONG, true, 1);
 
         case WD_CMD_WRITE_SECTORS:
         case WD_CMD_WRITE_SECTORS_NR:
@@ -456,6 +572,13 @@ int wd_process_command(uint8_t cmd)
             }
             return wd_exec_identify();
 
+        case WD_CMD_LOAD_WINDOW:
+            if (!wd_feature_enabled(WD_FEAT_TRACK_WINDOW)) {
+                wd_set_error(WD_ERROR_ABRT);
+                return HAL_ERR_NOT_SUPPORTED;
+            }
+            return wd_exec_load_window();
+
         default:
             /* Unknown command */
             wd_set_error(WD_ERROR_ABRT);
@@ -502,8 +625,58 @@ static int wd_exec_restore(uint8_t step_rate)
     return HAL_OK;
 }
 
-static int wd_exec_read_sectors(bool with_retry, bool long_mode)
+/*
+ * Read the full sector count into the burst buffer, one track span per
+ * queued request. Returns the number of sectors read before the first
+ * failure.
+ */
+static uint16_t wd_burst_fill(uint16_t total, int *status)
 {
+    uint8_t  spt = g_drive_geometry[g_wd_state.drive].sectors;
+    uint8_t  heads = g_drive_geometry[g_wd_state.drive].heads;
+    uint16_t cyl = g_wd_state.cylinder;
+    uint8_t  head = g_wd_state.head;
+    uint8_t  sec = g_wd_state.sector;
+    uint16_t filled = 0;
+    uint8_t  *dst = (uint8_t *)g_burst.data;
+
+    *status = HAL_OK;
+
+    while (filled < total) {
+        uint32_t n = spt - sec + 1;
+        if (n > HDD_TRACK_BUF_SECTORS) {
+            n = HDD_TRACK_BUF_SECTORS;
+        }
+        if (n > (uint32_t)(total - filled)) {
+            n = total - filled;
+        }
+
+        int ret = hdd_sched_read(g_wd_state.drive, cyl, head, sec,
+                                 (uint8_t)n, dst + filled * 512);
+        if (ret != HAL_OK) {
+            *status = ret;
+            break;
+        }
+        filled += n;
+
+        sec += n;
+        if (sec > spt) {
+            sec = 1;
+            if (++head >= heads) {
+                head = 0;
+                cyl++;
+            }
+        }
+    }
+
+    return filled;
+}
+
+static int wd_exec_read_sectors(bool with_retry, bool long_mode,
+                                uint8_t block)
+{
+    int ret;
+
     (void)with_retry;
     (void)long_mode;
 
@@ -516,15 +689,21 @@ static int wd_exec_read_sectors(bool with_retry, bool long_mode)
 
     g_wd_state.state = WD_STATE_READ;
     g_buffer_offset = 0;
-    g_wd_state.bytes_pending = 512;  /* One sector at a time */
+    g_wd_state.bytes_pending = 512;
 
-    /* Start read via HDD HAL */
-    int ret = hdd_read_sector(g_wd_state.drive, g_wd_state.cylinder,
-                              g_wd_state.head, g_wd_state.sector, NULL);
-    if (ret != HAL_OK) {
+    /* Prefill the whole transfer (count 0 = 256 sectors) */
+    g_burst.data = (uint16_t *)WD_BURST_BASE;
+    g_burst.word = 0;
+    g_burst.served = 0;
+    g_burst.block = block;
+    g_burst.block_left = block;
+    g_burst.good = wd_burst_fill(g_wd_state.sector_count ?
+                                 g_wd_state.sector_count : 256, &ret);
+    if (g_burst.good == 0) {
         wd_set_error(WD_ERROR_IDNF);
         return ret;
     }
+    g_burst.active = true;
 
     /* Set DRQ - data ready for host */
     g_wd_state.status &= ~WD_STATUS_BSY;
@@ -594,8 +773,8 @@ static int wd_exec_seek(uint8_t step_rate)
 
     g_wd_state.state = WD_STATE_SEEK;
 
-    /* Seek via HDD HAL */
-    int ret = hdd_seek(g_wd_state.drive, g_wd_state.cylinder);
+    /* Seek through the drive's request queue */
+    int ret = hdd_sched_seek(g_wd_state.drive, g_wd_state.cylinder);
     if (ret != HAL_OK) {
         wd_set_error(WD_ERROR_IDNF);
         return ret;
@@ -669,7 +848,8 @@ static int wd_exec_identify(void)
     memcpy(&id_buf[27], "FluxRipper WD Emulation         ", 40);
 
     /* Word 47: Max sectors per interrupt */
-    id_buf[47] = 1;
+    id_buf[47] = wd_feature_enabled(WD_FEAT_MULTIPLE_SECT) ?
+                 WD_MULTIPLE_MAX : 1;
 
     /* Word 49: Capabilities */
     id_buf[49] = 0x0200;  /* LBA supported */
@@ -685,6 +865,95 @@ static int wd_exec_identify(void)
     return HAL_OK;
 }
 
+static int wd_exec_set_multiple(void)
+{
+    uint8_t count = g_wd_state.sector_count;
+
+    /* 0 turns block mode off; otherwise a power of two up to the max */
+    if (count > WD_MULTIPLE_MAX || (count & (count - 1)) != 0) {
+        wd_set_error(WD_ERROR_ABRT);
+        return HAL_ERR_PARAM;
+    }
+
+    g_wd_state.multiple = count;
+    wd_complete_command();
+    return HAL_OK;
+}
+
+/*
+ * Rewrite the window header after the data sectors. The signature and
+ * capacity are what the option ROM probes for; the rest describes the
+ * last LOAD WINDOW.
+ */
+static void wd_window_header(uint8_t loaded)
+{
+    const char *sig = WD_WINDOW_SIGNATURE;
+
+    REG32(WD_BUFFER_ADDR) = WD_WINDOW_HDR_OFFSET;
+    for (uint32_t i = 0; i < 4; i++) {
+        REG32(WD_BUFFER_DATA) = (uint8_t)sig[i];
+    }
+    REG32(WD_BUFFER_DATA) = WD_WINDOW_VERSION;
+    REG32(WD_BUFFER_DATA) = WD_WINDOW_SECTORS;
+    REG32(WD_BUFFER_DATA) = loaded;
+    REG32(WD_BUFFER_DATA) = g_wd_state.drive;
+    REG32(WD_BUFFER_DATA) = g_wd_state.cylinder & 0xFF;
+    REG32(WD_BUFFER_DATA) = g_wd_state.cylinder >> 8;
+    REG32(WD_BUFFER_DATA) = g_wd_state.head;
+    REG32(WD_BUFFER_DATA) = g_wd_state.sector;
+}
+
+/*
+ * LOAD WINDOW: read up to a track buffer of sectors and leave them at
+ * window offset 0 in request order, for the host to copy out of its
+ * memory window. No DRQ phase: the command ends with BSY clear and one
+ * interrupt. The task file advances past the loaded sectors and the
+ * sector count keeps what was not loaded, so on IDNF it points at the
+ * failing sector like READ SECTORS does.
+ */
+static int wd_exec_load_window(void)
+{
+    const uint8_t *src = (const uint8_t *)WD_BURST_BASE;
+    uint8_t count = g_wd_state.sector_count;
+    uint16_t good;
+    int ret;
+
+    if (count == 0 || count > WD_WINDOW_SECTORS) {
+        wd_set_error(WD_ERROR_ABRT);
+        return HAL_ERR_PARAM;
+    }
+    if (g_wd_state.sector == 0 ||
+        g_wd_state.sector > g_drive_geometry[g_wd_state.drive].sectors) {
+        wd_set_error(WD_ERROR_IDNF);
+        return HAL_ERR_PARAM;
+    }
+
+    g_wd_state.state = WD_STATE_READ;
+    g_burst.active = false;
+    g_burst.data = (uint16_t *)WD_BURST_BASE;
+    good = wd_burst_fill(count, &ret);
+
+    /* Buffer port is byte wide and auto-increments */
+    REG32(WD_BUFFER_ADDR) = 0;
+    for (uint32_t i = 0; i < (uint32_t)good * 512; i++) {
+        REG32(WD_BUFFER_DATA) = src[i];
+    }
+
+    for (uint16_t i = 0; i < good; i++) {
+        g_wd_state.sector_count--;
+        wd_next_sector();
+    }
+    wd_window_header((uint8_t)good);
+
+    if (good < count) {
+        wd_set_error(WD_ERROR_IDNF);
+        return ret;
+    }
+
+    wd_complete_command();
+    return HAL_OK;
+}
+
 static void wd_set_error(uint8_t error)
 {
     g_wd_state.error = error;
@@ -752,6 +1021,7 @@ int wd_get_state(wd_controller_state_t *state)
 
 int wd_abort_command(void)
 {
+    g_burst.active = false;
     g_wd_state.status &= ~(WD_STATUS_BSY | WD_STATUS_DRQ);
     g_wd_state.status |= WD_STATUS_RDY;
     g_wd_state.error = WD_ERROR_ABRT;
@@ -988,6 +1258,9 @@ const char *wd_cmd_to_string(uint8_t cmd)
         case WD_CMD_EXEC_DIAG:        return "DIAGNOSTICS";
         case WD_CMD_SET_PARAMS:       return "SET PARAMS";
         case WD_CMD_IDENTIFY:         return "IDENTIFY";
+        case WD_CMD_READ_MULTIPLE:    return "READ MULTIPLE";
+        case WD_CMD_SET_MULTIPLE:     return "SET MULTIPLE";
+        case WD_CMD_LOAD_WINDOW:      return "LOAD WINDOW";
         default:                      return "UNKNOWN";
     }
 }
@@ -1141,7 +1414,7 @@ int wd_build_identify_from_meta(const hdd_metadata_t *meta, wd_identify_t *ident
     identify->ecc_bytes = 4;        /* 4 ECC bytes per sector */
 
     /* Word 47: Max multi-sector */
-    identify->max_multi_sect = 16;
+    identify->max_multi_sect = WD_MULTIPLE_MAX;
 
     /* Word 49: Capabilities
      * Bit 9: LBA supported
@@ -36,6 +36,8 @@ set rtl_files [list \
     "$rtl_dir/top/fluxripper_dual_top.v" \
     "$rtl_dir/axi/axi_fdc_periph_dual.v" \
     "$rtl_dir/axi/axi_stream_flux_dual.v" \
+    "$rtl_dir/axi/axi_stream_tape.v" \
+    "$rtl_dir/dsp/reed_solomon_ecc.v" \
     "$rtl_dir/fdc_core/fdc_core_instance.v" \
     "$rtl_dir/fdc_core/command_fsm.v" \
     "$rtl_dir/fdc_core/motor_controller.v" \
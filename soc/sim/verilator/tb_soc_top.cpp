@@ -3,13 +3,31 @@
  *
  * Simulates the FluxRipper FDC IP with AXI stimulus
  *
- * Updated: 2025-12-03 19:30
+ * Run-time options (plusargs):
+ *   +sim_us=N             Simulated time in microseconds (default SIM_TIME_US)
+ *   +trace=full|off       VCD for the whole run, or none (default full)
+ *   +trace_start=NS       Dump only from NS ...
+ *   +trace_stop=NS        ... up to NS (either may be omitted)
+ *   +trace_trigger=irq_a|irq_b
+ *                         Start dumping on the first IRQ rising edge
+ *   +trace_len=NS         Dump length after a trigger (default 100000)
+ *
+ * Builds without --trace (make build-notrace) ignore the trace options.
+ * Simulated cycles per wall-clock second are reported at exit.
+ *
+ * Register accesses go through the AXI-Lite BFM in sim/common/axi_bfm.hpp.
+ *
+ * Updated: 2025-12-08 19:15
  *-----------------------------------------------------------------------------*/
 
 #include <verilated.h>
+#if VM_TRACE
 #include <verilated_vcd_c.h>
+#endif
 #include "Vfluxripper_dual_top.h"
+#include "axi_bfm.hpp"
 
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -22,8 +40,8 @@
 #define AXI_CLK_PERIOD_NS   10      /* 100 MHz = 10ns period */
 #define SIM_TIME_US         1000    /* Simulation time in microseconds */
 
-#define TRACE_ENABLE        1       /* Enable VCD waveform output */
 #define TRACE_DEPTH         99      /* VCD trace depth */
+#define TRACE_TRIGGER_LEN_NS 100000 /* Default dump length after a trigger */
 
 /*-----------------------------------------------------------------------------
  * AXI Register Addresses (from plan)
@@ -53,11 +71,108 @@
  *-----------------------------------------------------------------------------*/
 
 static Vfluxripper_dual_top *dut;
+#if VM_TRACE
 static VerilatedVcdC *trace;
+#endif
 static vluint64_t sim_time = 0;
 static vluint64_t clk_200_cycle = 0;
 static vluint64_t axi_clk_cycle = 0;
 
+/*-----------------------------------------------------------------------------
+ * Trace Window
+ *-----------------------------------------------------------------------------*/
+
+enum trace_trigger_t { TRIG_NONE, TRIG_IRQ_A, TRIG_IRQ_B };
+
+static struct {
+    bool enabled;               /* Any dumping requested */
+    vluint64_t start_ns;        /* Window start */
+    vluint64_t stop_ns;         /* Window end (0 = end of run) */
+    trace_trigger_t trigger;    /* Window opens on this event */
+    vluint64_t trigger_len_ns;
+    bool armed;                 /* Waiting for the trigger */
+    bool prev_irq;
+    vluint64_t dumps;           /* Samples written */
+} tw = { true, 0, 0, TRIG_NONE, TRACE_TRIGGER_LEN_NS, false, false, 0 };
+
+/* Value of +name=value, or NULL; "name=" is matched so +trace does not
+ * pick up +trace_start */
+static const char *plusarg_str(const char *name)
+{
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "%s=", name);
+
+    const char *match = Verilated::commandArgsPlusMatch(prefix);
+    if (match[0] != '+') {
+        return NULL;
+    }
+    return match + 1 + strlen(prefix);
+}
+
+static bool plusarg_u64(const char *name, vluint64_t *value)
+{
+    const char *str = plusarg_str(name);
+    if (!str) {
+        return false;
+    }
+    *value = strtoull(str, NULL, 0);
+    return true;
+}
+
+static void trace_configure()
+{
+    const char *mode = plusarg_str("trace");
+    if (mode && strcmp(mode, "off") == 0) {
+        tw.enabled = false;
+    }
+
+    plusarg_u64("trace_start", &tw.start_ns);
+    plusarg_u64("trace_stop", &tw.stop_ns);
+    plusarg_u64("trace_len", &tw.trigger_len_ns);
+
+    const char *trig = plusarg_str("trace_trigger");
+    if (trig) {
+        if (strcmp(trig, "irq_a") == 0) {
+            tw.trigger = TRIG_IRQ_A;
+        } else if (strcmp(trig, "irq_b") == 0) {
+            tw.trigger = TRIG_IRQ_B;
+        } else {
+            printf("WARNING: unknown +trace_trigger=%s ignored\n", trig);
+        }
+    }
+    tw.armed = (tw.trigger != TRIG_NONE);
+}
+
+/* Open the window on the trigger's rising edge */
+static void trace_check_trigger()
+{
+    if (!tw.armed) {
+        return;
+    }
+
+    bool irq = (tw.trigger == TRIG_IRQ_A) ? dut->irq_fdc_a : dut->irq_fdc_b;
+    if (irq && !tw.prev_irq) {
+        tw.armed = false;
+        tw.start_ns = sim_time;
+        tw.stop_ns = sim_time + tw.trigger_len_ns;
+        printf("[%lu] Trace triggered, dumping %lu ns\n",
+               (unsigned long)sim_time, (unsigned long)tw.trigger_len_ns);
+    }
+    tw.prev_irq = irq;
+}
+
+static inline void trace_dump()
+{
+#if VM_TRACE
+    if (!trace || tw.armed || sim_time < tw.start_ns ||
+        (tw.stop_ns != 0 && sim_time > tw.stop_ns)) {
+        return;
+    }
+    trace->dump(sim_time);
+    tw.dumps++;
+#endif
+}
+
 /*-----------------------------------------------------------------------------
  * Clock Generation
  *-----------------------------------------------------------------------------*/
@@ -66,12 +181,12 @@ void tick_200mhz()
 {
     dut->clk_200mhz = 0;
     dut->eval();
-    if (trace) trace->dump(sim_time);
+    trace_dump();
     sim_time += CLK_PERIOD_NS / 2;
 
     dut->clk_200mhz = 1;
     dut->eval();
-    if (trace) trace->dump(sim_time);
+    trace_dump();
     sim_time += CLK_PERIOD_NS / 2;
 
     clk_200_cycle++;
@@ -81,15 +196,16 @@ void tick_axi()
 {
     dut->s_axi_aclk = 0;
     dut->eval();
-    if (trace) trace->dump(sim_time);
+    trace_dump();
     sim_time += AXI_CLK_PERIOD_NS / 2;
 
     dut->s_axi_aclk = 1;
     dut->eval();
-    if (trace) trace->dump(sim_time);
+    trace_dump();
     sim_time += AXI_CLK_PERIOD_NS / 2;
 
     axi_clk_cycle++;
+    trace_check_trigger();
 }
 
 /* Combined clock tick - runs both clocks */
@@ -105,86 +221,36 @@ void tick()
  * AXI4-Lite Transactions
  *-----------------------------------------------------------------------------*/
 
+/* Bus-functional master on s_axi_*, clocked by tick() (one AXI cycle) */
+static CycleScheduler *sched;
+static AxiLiteMaster<Vfluxripper_dual_top> *csr;
+
+#define AXI_TIMEOUT_CYCLES  200
+
 uint32_t axi_read(uint32_t addr)
 {
-    uint32_t data;
+    uint32_t data = 0xDEADBEEF;
+    uint32_t resp = csr->read(addr, data, AXI_TIMEOUT_CYCLES);
 
-    /* Setup read address */
-    dut->s_axi_araddr = addr;
-    dut->s_axi_arvalid = 1;
-    dut->s_axi_rready = 1;
-
-    /* Wait for address accept */
-    int timeout = 100;
-    while (!dut->s_axi_arready && timeout-- > 0) {
-        tick();
-    }
-    if (timeout <= 0) {
-        printf("ERROR: AXI read address timeout @ 0x%02x\n", addr);
+    if (resp == AXI::RESP_TIMEOUT) {
+        printf("ERROR: AXI read timeout @ 0x%02x\n", addr);
         return 0xDEADBEEF;
     }
-
-    tick();
-    dut->s_axi_arvalid = 0;
-
-    /* Wait for read data */
-    timeout = 100;
-    while (!dut->s_axi_rvalid && timeout-- > 0) {
-        tick();
-    }
-    if (timeout <= 0) {
-        printf("ERROR: AXI read data timeout @ 0x%02x\n", addr);
-        return 0xDEADBEEF;
+    if (resp != AXI::RESP_OKAY) {
+        printf("WARNING: AXI read error response %u @ 0x%02x\n", resp, addr);
     }
-
-    data = dut->s_axi_rdata;
-    tick();
-    dut->s_axi_rready = 0;
-
     return data;
 }
 
 void axi_write(uint32_t addr, uint32_t data)
 {
-    /* Setup write address and data */
-    dut->s_axi_awaddr = addr;
-    dut->s_axi_awvalid = 1;
-    dut->s_axi_wdata = data;
-    dut->s_axi_wstrb = 0xF;
-    dut->s_axi_wvalid = 1;
-    dut->s_axi_bready = 1;
-
-    /* Wait for address accept */
-    int timeout = 100;
-    while ((!dut->s_axi_awready || !dut->s_axi_wready) && timeout-- > 0) {
-        tick();
-    }
-    if (timeout <= 0) {
-        printf("ERROR: AXI write address/data timeout @ 0x%02x\n", addr);
-        return;
-    }
-
-    tick();
-    dut->s_axi_awvalid = 0;
-    dut->s_axi_wvalid = 0;
-
-    /* Wait for write response */
-    timeout = 100;
-    while (!dut->s_axi_bvalid && timeout-- > 0) {
-        tick();
-    }
-    if (timeout <= 0) {
-        printf("ERROR: AXI write response timeout @ 0x%02x\n", addr);
-        return;
-    }
+    uint32_t resp = csr->write(addr, data, 0xF, AXI_TIMEOUT_CYCLES);
 
-    if (dut->s_axi_bresp != 0) {
-        printf("WARNING: AXI write error response %d @ 0x%02x\n",
-               dut->s_axi_bresp, addr);
+    if (resp == AXI::RESP_TIMEOUT) {
+        printf("ERROR: AXI write timeout @ 0x%02x\n", addr);
+    } else if (resp != AXI::RESP_OKAY) {
+        printf("WARNING: AXI write error response %u @ 0x%02x\n", resp, addr);
     }
-
-    tick();
-    dut->s_axi_bready = 0;
 }
 
 /*-----------------------------------------------------------------------------
@@ -383,18 +449,42 @@ int main(int argc, char **argv)
 
     /* Initialize Verilator */
     Verilated::commandArgs(argc, argv);
-    Verilated::traceEverOn(TRACE_ENABLE);
+    trace_configure();
+
+    vluint64_t sim_us = SIM_TIME_US;
+    plusarg_u64("sim_us", &sim_us);
+
+#if VM_TRACE
+    Verilated::traceEverOn(tw.enabled);
+#else
+    tw.enabled = false;
+#endif
 
     /* Create DUT */
     dut = new Vfluxripper_dual_top;
 
     /* Setup trace */
-    if (TRACE_ENABLE) {
+#if VM_TRACE
+    if (tw.enabled) {
         trace = new VerilatedVcdC;
         dut->trace(trace, TRACE_DEPTH);
         trace->open("fluxripper_soc.vcd");
         printf("VCD trace enabled: fluxripper_soc.vcd\n");
+        if (tw.armed) {
+            printf("  window: on %s, %lu ns\n",
+                   tw.trigger == TRIG_IRQ_A ? "irq_a" : "irq_b",
+                   (unsigned long)tw.trigger_len_ns);
+        } else if (tw.start_ns != 0 || tw.stop_ns != 0) {
+            printf("  window: %lu - %lu ns\n",
+                   (unsigned long)tw.start_ns, (unsigned long)tw.stop_ns);
+        }
     }
+#endif
+    if (!tw.enabled) {
+        printf("VCD trace disabled\n");
+    }
+
+    auto wall_start = std::chrono::steady_clock::now();
 
     /* Initialize signals */
     dut->clk_200mhz = 0;
@@ -402,16 +492,9 @@ int main(int argc, char **argv)
     dut->reset_n = 0;
     dut->s_axi_aresetn = 0;
 
-    /* Initialize AXI signals */
-    dut->s_axi_awaddr = 0;
-    dut->s_axi_awvalid = 0;
-    dut->s_axi_wdata = 0;
-    dut->s_axi_wstrb = 0;
-    dut->s_axi_wvalid = 0;
-    dut->s_axi_bready = 0;
-    dut->s_axi_araddr = 0;
-    dut->s_axi_arvalid = 0;
-    dut->s_axi_rready = 0;
+    /* Initialize AXI signals (the master idles its channels) */
+    sched = new CycleScheduler([] { dut->eval(); }, tick, AXI_CLK_PERIOD_NS);
+    csr = new AxiLiteMaster<Vfluxripper_dual_top>(dut, *sched);
 
     /* Initialize AXIS */
     dut->m_axis_a_tready = 0;
@@ -450,7 +533,7 @@ int main(int argc, char **argv)
 
     /* Run simulation for remaining time */
     printf("\n=== Running simulation... ===\n");
-    vluint64_t end_time = SIM_TIME_US * 1000;  /* Convert to ns */
+    vluint64_t end_time = sim_us * 1000;  /* Convert to ns */
     while (sim_time < end_time) {
         tick();
         update_drive_signals();
@@ -461,16 +544,32 @@ int main(int argc, char **argv)
         }
     }
 
+    double wall_s = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - wall_start).count();
+    if (wall_s <= 0.0) {
+        wall_s = 1e-9;
+    }
+
     /* Cleanup */
     printf("\n============================================\n");
     printf("Simulation complete: %lu ns (%lu us)\n",
            (unsigned long)sim_time, (unsigned long)(sim_time / 1000));
+    printf("Wall time:           %.3f s\n", wall_s);
+    printf("200 MHz cycles:      %lu (%.0f cycles/s)\n",
+           (unsigned long)clk_200_cycle, clk_200_cycle / wall_s);
+    printf("100 MHz cycles:      %lu (%.0f cycles/s)\n",
+           (unsigned long)axi_clk_cycle, axi_clk_cycle / wall_s);
+    printf("Trace samples:       %lu\n", (unsigned long)tw.dumps);
     printf("============================================\n");
 
+#if VM_TRACE
     if (trace) {
         trace->close();
         delete trace;
     }
+#endif
+    delete csr;
+    delete sched;
     delete dut;
 
     return 0;
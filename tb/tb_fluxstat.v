@@ -39,6 +39,19 @@ module tb_fluxstat;
     wire [31:0] hist_overflow_count;
     wire [15:0] hist_mean_interval;
 
+    // Histogram ping-pong banks and block read port
+    reg         hist_banked;
+    reg         hist_swap_on_index;
+    reg         hist_index;
+    reg         hist_swap;
+    reg  [6:0]  hist_read_word;
+    wire [31:0] hist_read_word_data;
+    wire        hist_active_bank;
+    wire [15:0] hist_swap_count;
+    wire [31:0] hist_frz_total;
+    wire [7:0]  hist_frz_peak_bin;
+    wire [15:0] hist_frz_peak_count;
+
     // Multipass capture signals
     reg         mp_start;
     reg         mp_abort;
@@ -98,8 +111,14 @@ module tb_fluxstat;
         .enable(hist_enable),
         .clear(hist_clear),
         .snapshot(hist_snapshot),
+        .banked(hist_banked),
+        .swap_on_index(hist_swap_on_index),
+        .index_pulse(hist_index),
+        .swap(hist_swap),
         .read_bin(hist_read_bin),
         .read_data(hist_read_data),
+        .read_word(hist_read_word),
+        .read_word_data(hist_read_word_data),
         .total_count(hist_total_count),
         .interval_min(hist_interval_min),
         .interval_max(hist_interval_max),
@@ -111,7 +130,16 @@ module tb_fluxstat;
         .snap_total(),
         .snap_peak_bin(),
         .snap_peak_count(),
-        .snap_mean()
+        .snap_mean(),
+        .active_bank(hist_active_bank),
+        .swap_count(hist_swap_count),
+        .frz_total(hist_frz_total),
+        .frz_min(),
+        .frz_max(),
+        .frz_peak_bin(hist_frz_peak_bin),
+        .frz_peak_count(hist_frz_peak_count),
+        .frz_mean(),
+        .frz_overflow()
     );
 
     //-------------------------------------------------------------------------
@@ -130,6 +158,9 @@ module tb_fluxstat;
         .abort(mp_abort),
         .pass_count(mp_pass_count),
         .base_addr(mp_base_addr),
+        .window_start(32'd0),
+        .window_len(32'd0),
+        .pass_stride(24'd0),
         .busy(mp_busy),
         .done(mp_done),
         .error(mp_error),
@@ -229,6 +260,58 @@ module tb_fluxstat;
     //-------------------------------------------------------------------------
     integer errors;
     integer i;
+    integer word_sum;
+
+    // One-clock histogram index / swap pulses (generate_index is wider)
+    task pulse_hist_index;
+        begin
+            @(posedge clk);
+            hist_index <= 1'b1;
+            @(posedge clk);
+            hist_index <= 1'b0;
+        end
+    endtask
+
+    task pulse_hist_swap;
+        begin
+            @(posedge clk);
+            hist_swap <= 1'b1;
+            @(posedge clk);
+            hist_swap <= 1'b0;
+        end
+    endtask
+
+    // Check one bin through the single-bin read port
+    task check_bin;
+        input [7:0]  bin;
+        input [15:0] expected;
+        begin
+            hist_read_bin = bin;
+            repeat(2) @(posedge clk);
+            if (hist_read_data != expected) begin
+                $display("ERROR: Bin %0d count = %0d, expected %0d", bin, hist_read_data, expected);
+                errors = errors + 1;
+            end else begin
+                $display("PASS: Bin %0d count = %0d", bin, hist_read_data);
+            end
+        end
+    endtask
+
+    // Check one bin pair through the block read port
+    task check_word;
+        input [6:0]  word;
+        input [31:0] expected;
+        begin
+            hist_read_word = word;
+            repeat(2) @(posedge clk);
+            if (hist_read_word_data != expected) begin
+                $display("ERROR: Word %0d = 0x%08h, expected 0x%08h", word, hist_read_word_data, expected);
+                errors = errors + 1;
+            end else begin
+                $display("PASS: Word %0d = 0x%08h", word, hist_read_word_data);
+            end
+        end
+    endtask
 
     initial begin
         $display("=========================================");
@@ -244,6 +327,11 @@ module tb_fluxstat;
         hist_clear = 0;
         hist_snapshot = 0;
         hist_read_bin = 0;
+        hist_banked = 0;
+        hist_swap_on_index = 0;
+        hist_index = 0;
+        hist_swap = 0;
+        hist_read_word = 0;
         mp_start = 0;
         mp_abort = 0;
         mp_pass_count = 8;
@@ -526,6 +614,151 @@ module tb_fluxstat;
             errors = errors + 1;
         end
 
+        //---------------------------------------------------------------------
+        // Test 7: Ping-pong Banks, Swap on Index
+        //---------------------------------------------------------------------
+        $display("\n--- Test 7: Ping-pong Banks, Swap on Index ---");
+
+        hist_clear = 1;
+        @(posedge clk);
+        hist_clear = 0;
+        hist_banked = 1;
+        hist_swap_on_index = 1;
+        hist_enable = 1;
+
+        // Revolution 1 counts into bank 0
+        generate_flux(16'd80);   // Bin 20
+        generate_flux(16'd80);   // Bin 20
+        generate_flux(16'd80);   // Bin 20
+        generate_flux(16'd120);  // Bin 30
+        generate_flux(16'd120);  // Bin 30
+        repeat(5) @(posedge clk);
+
+        // Reads see the frozen bank, still empty
+        check_bin(8'd20, 16'd0);
+
+        // Index freezes revolution 1
+        pulse_hist_index();
+        repeat(5) @(posedge clk);
+
+        if (hist_swap_count != 1 || hist_active_bank != 1'b1) begin
+            $display("ERROR: After index swap_count = %0d, active_bank = %0d, expected 1, 1",
+                     hist_swap_count, hist_active_bank);
+            errors = errors + 1;
+        end else begin
+            $display("PASS: Index swapped banks");
+        end
+
+        if (hist_frz_total != 5 || hist_frz_peak_bin != 20 || hist_frz_peak_count != 3) begin
+            $display("ERROR: Frozen stats total = %0d, peak bin = %0d, peak count = %0d, expected 5, 20, 3",
+                     hist_frz_total, hist_frz_peak_bin, hist_frz_peak_count);
+            errors = errors + 1;
+        end else begin
+            $display("PASS: Frozen stats captured at the swap");
+        end
+
+        if (hist_total_count != 0) begin
+            $display("ERROR: Live total after swap = %0d, expected 0", hist_total_count);
+            errors = errors + 1;
+        end else begin
+            $display("PASS: Live stats restarted");
+        end
+
+        // Revolution 2 counts into bank 1; revolution 1 stays readable
+        generate_flux(16'd160);  // Bin 40
+        repeat(5) @(posedge clk);
+
+        check_bin(8'd20, 16'd3);
+        check_bin(8'd30, 16'd2);
+        check_bin(8'd40, 16'd0);
+        check_word(7'd10, 32'h0000_0003);   // {bin 21, bin 20}
+        check_word(7'd15, 32'h0000_0002);   // {bin 31, bin 30}
+
+        // Next index freezes revolution 2 and empties bank 0 for counting
+        pulse_hist_index();
+        repeat(5) @(posedge clk);
+
+        check_bin(8'd20, 16'd0);
+        check_bin(8'd40, 16'd1);
+        check_word(7'd20, 32'h0000_0001);   // {bin 41, bin 40}
+
+        if (hist_swap_count != 2 || hist_frz_total != 1) begin
+            $display("ERROR: Second swap swap_count = %0d, frozen total = %0d, expected 2, 1",
+                     hist_swap_count, hist_frz_total);
+            errors = errors + 1;
+        end else begin
+            $display("PASS: Second index froze revolution 2");
+        end
+
+        // Without swap_on_index only the swap strobe changes banks
+        hist_swap_on_index = 0;
+        pulse_hist_index();
+        repeat(5) @(posedge clk);
+
+        if (hist_swap_count != 2) begin
+            $display("ERROR: Index swapped with swap_on_index clear (swap_count = %0d)",
+                     hist_swap_count);
+            errors = errors + 1;
+        end else begin
+            $display("PASS: Index ignored with swap_on_index clear");
+        end
+
+        pulse_hist_swap();
+        repeat(5) @(posedge clk);
+
+        if (hist_swap_count != 3) begin
+            $display("ERROR: Swap strobe swap_count = %0d, expected 3", hist_swap_count);
+            errors = errors + 1;
+        end else begin
+            $display("PASS: Swap strobe swapped banks");
+        end
+
+        hist_enable = 0;
+        hist_banked = 0;
+        hist_clear = 1;
+        @(posedge clk);
+        hist_clear = 0;
+
+        //---------------------------------------------------------------------
+        // Test 8: Block Read Port
+        //---------------------------------------------------------------------
+        $display("\n--- Test 8: Block Read Port ---");
+
+        hist_enable = 1;
+
+        // Both halves of a word populated, and the top word via overflow
+        generate_flux(16'd80);   // Bin 20
+        generate_flux(16'd80);   // Bin 20
+        generate_flux(16'd84);   // Bin 21
+        generate_flux(16'd1016); // Bin 254
+        generate_flux(16'd1020); // Bin 255
+        generate_flux(16'd2000); // Overflow, counted in bin 255
+        repeat(5) @(posedge clk);
+
+        check_word(7'd0,   32'h0000_0000);
+        check_word(7'd10,  32'h0001_0002);  // {bin 21, bin 20}
+        check_word(7'd127, 32'h0002_0001);  // {bin 255, bin 254}
+
+        // A full readout accounts for every counted transition
+        word_sum = 0;
+        for (i = 0; i < 128; i = i + 1) begin
+            hist_read_word = i;
+            @(posedge clk);
+            word_sum = word_sum + hist_read_word_data[15:0] + hist_read_word_data[31:16];
+        end
+
+        if (word_sum != hist_total_count) begin
+            $display("ERROR: Word readout sums to %0d, total count = %0d", word_sum, hist_total_count);
+            errors = errors + 1;
+        end else begin
+            $display("PASS: Word readout sums to total count (%0d)", word_sum);
+        end
+
+        hist_enable = 0;
+        hist_clear = 1;
+        @(posedge clk);
+        hist_clear = 0;
+
         //---------------------------------------------------------------------
         // Summary
         //---------------------------------------------------------------------
@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+"""
+FluxRipper CLI Binary Response Decoding
+
+Host-side parsing of the framed CBOR responses a CLI command sends when
+run with "--bin" (see soc/firmware/include/cli_bin.h):
+
+    0x02 'B' len[2] payload[len] crc[2]
+
+len and crc are little-endian; crc is CRC16-CCITT over len and payload.
+The payload is one CBOR map; only the subset the firmware encoder emits
+(integers, text, booleans, definite and indefinite arrays/maps) is
+decoded here.
+
+Created: 2025-12-09 20:30
+License: BSD-3-Clause
+"""
+
+import struct
+from typing import Any, List, Optional, Tuple
+
+#==============================================================================
+# Frame Constants (mirror cli_bin.h)
+#==============================================================================
+
+CLI_BIN_FLAG = "--bin"
+CLI_BIN_STX = 0x02
+CLI_BIN_TAG = ord('B')
+CLI_BIN_MAGIC = bytes([CLI_BIN_STX, CLI_BIN_TAG])
+CLI_BIN_OVERHEAD = 6
+
+LENGTH = struct.Struct('<H')
+
+
+class FrameError(ValueError):
+    """Malformed frame or CBOR payload."""
+
+
+#==============================================================================
+# CRC
+#==============================================================================
+
+def crc16_ccitt(data: bytes, crc: int = 0xFFFF) -> int:
+    """CRC16-CCITT (poly 0x1021, init 0xFFFF) as in firmware crc16.c."""
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+#==============================================================================
+# CBOR Decoding
+#==============================================================================
+
+_BREAK = object()
+
+
+def _decode_item(buf: bytes, pos: int) -> Tuple[Any, int]:
+    if pos >= len(buf):
+        raise FrameError("truncated CBOR item")
+
+    ib = buf[pos]
+    pos += 1
+    major, info = ib >> 5, ib & 0x1F
+
+    if ib == 0xFF:
+        return _BREAK, pos
+    if major == 7:
+        if info == 20:
+            return False, pos
+        if info == 21:
+            return True, pos
+        if info == 22:
+            return None, pos
+        raise FrameError(f"unsupported simple value 0x{ib:02X}")
+
+    if info < 24:
+        arg = info
+    elif info in (24, 25, 26, 27):
+        n = 1 << (info - 24)
+        if pos + n > len(buf):
+            raise FrameError("truncated CBOR argument")
+        arg = int.from_bytes(buf[pos:pos + n], 'big')
+        pos += n
+    elif info == 31 and major in (4, 5):
+        arg = None
+    else:
+        raise FrameError(f"unsupported CBOR head 0x{ib:02X}")
+
+    if major == 0:
+        return arg, pos
+    if major == 1:
+        return -1 - arg, pos
+    if major in (2, 3):
+        if pos + arg > len(buf):
+            raise FrameError("truncated CBOR string")
+        raw = buf[pos:pos + arg]
+        return (raw.decode('utf-8', errors='replace') if major == 3 else raw), pos + arg
+
+    if major == 4:
+        items = []
+        while arg is None or len(items) < arg:
+            item, pos = _decode_item(buf, pos)
+            if item is _BREAK:
+                if arg is not None:
+                    raise FrameError("unexpected break")
+                break
+            items.append(item)
+        return items, pos
+
+    if major == 5:
+        result = {}
+        while arg is None or len(result) < arg:
+            key, pos = _decode_item(buf, pos)
+            if key is _BREAK:
+                if arg is not None:
+                    raise FrameError("unexpected break")
+                break
+            value, pos = _decode_item(buf, pos)
+            if value is _BREAK:
+                raise FrameError("break inside map entry")
+            result[key] = value
+        return result, pos
+
+    raise FrameError(f"unsupported CBOR major type {major}")
+
+
+def decode_cbor(payload: bytes) -> Any:
+    """Decode one CBOR item that must fill the payload."""
+    item, pos = _decode_item(payload, 0)
+    if item is _BREAK or pos != len(payload):
+        raise FrameError("trailing bytes after CBOR item")
+    return item
+
+
+#==============================================================================
+# Frames
+#==============================================================================
+
+def decode_frame(frame: bytes) -> dict:
+    """Check and decode one complete frame."""
+    if len(frame) < CLI_BIN_OVERHEAD or frame[:2] != CLI_BIN_MAGIC:
+        raise FrameError("not a CLI binary frame")
+
+    (length,) = LENGTH.unpack_from(frame, 2)
+    if len(frame) != length + CLI_BIN_OVERHEAD:
+        raise FrameError("frame length mismatch")
+
+    (crc,) = LENGTH.unpack_from(frame, 4 + length)
+    if crc != crc16_ccitt(frame[2:4 + length]):
+        raise FrameError("frame CRC mismatch")
+
+    result = decode_cbor(frame[4:4 + length])
+    if not isinstance(result, dict):
+        raise FrameError("payload is not a map")
+    return result
+
+
+class FrameSplitter:
+    """
+    Separate binary frames from console text in a byte stream.
+
+    feed() returns (text, frames): the text bytes seen outside frames and
+    the complete frames found so far, still undecoded. Incomplete data is
+    kept for the next call.
+    """
+
+    def __init__(self):
+        self.buffer = bytearray()
+
+    def feed(self, data: bytes) -> Tuple[bytes, List[bytes]]:
+        self.buffer += data
+        text = bytearray()
+        frames: List[bytes] = []
+
+        while True:
+            start = self.buffer.find(CLI_BIN_MAGIC)
+            if start < 0:
+                # Hold back a lone STX that may start the next frame
+                keep = 1 if self.buffer.endswith(bytes([CLI_BIN_STX])) else 0
+                text += self.buffer[:len(self.buffer) - keep]
+                del self.buffer[:len(self.buffer) - keep]
+                break
+
+            text += self.buffer[:start]
+            del self.buffer[:start]
+            if len(self.buffer) < 4:
+                break
+
+            (length,) = LENGTH.unpack_from(self.buffer, 2)
+            total = length + CLI_BIN_OVERHEAD
+            if len(self.buffer) < total:
+                break
+
+            frames.append(bytes(self.buffer[:total]))
+            del self.buffer[:total]
+
+        return bytes(text), frames
+
+
+def parse_response(data: bytes) -> Optional[dict]:
+    """Decode the first valid frame in a captured response, if any."""
+    _, frames = FrameSplitter().feed(data)
+    for frame in frames:
+        try:
+            return decode_frame(frame)
+        except FrameError:
+            continue
+    return None
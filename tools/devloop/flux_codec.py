@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+"""
+FluxRipper Raw Mode Flux Stream Codec
+
+Host-side decoding of READ_FLUX chunk streams (see raw_protocol.h).
+Handles both payload formats: plain 32-bit flux words and the
+delta + varint encoding advertised as RAW_FLUX_CAP_DELTA.
+
+Created: 2025-12-07 17:00
+License: BSD-3-Clause
+"""
+
+import struct
+from dataclasses import dataclass
+from typing import Iterable, Iterator, List, Optional, Tuple
+
+#==============================================================================
+# Protocol Constants (mirror raw_protocol.h)
+#==============================================================================
+
+RAW_SIGNATURE = 0x46525751
+RAW_CMD_CAPTURE_STOP = 0x11
+RAW_CMD_READ_FLUX = 0x13
+RAW_RSP_OK = 0x00
+
+RAW_FLUX_FMT_RAW32 = 0
+RAW_FLUX_FMT_DELTA = 1
+
+RAW_FLUX_CAP_RAW32 = 1 << RAW_FLUX_FMT_RAW32
+RAW_FLUX_CAP_DELTA = 1 << RAW_FLUX_FMT_DELTA
+
+RAW_FLUX_ESC_INDEX = 1 << 0
+RAW_FLUX_ESC_OVERFLOW = 1 << 1
+RAW_FLUX_ESC_WEAK = 1 << 2
+
+FLUX_FLAG_INDEX = 1 << 31
+FLUX_FLAG_OVERFLOW = 1 << 30
+FLUX_FLAG_WEAK = 1 << 29
+FLUX_TIMESTAMP_MASK = 0x07FFFFFF
+
+FLUX_SAMPLE_RATE = 200_000_000
+
+HEADER = struct.Struct("<IBBH")          # raw_rsp_header_t
+CAPTURE_INFO = struct.Struct("<IIII")    # raw_capture_info_t
+
+#==============================================================================
+# Payload Decoders
+#==============================================================================
+
+def decode_raw32(payload: bytes) -> List[int]:
+    """Decode a RAW_FLUX_FMT_RAW32 payload into flux words."""
+    count = len(payload) // 4
+    return list(struct.unpack_from(f"<{count}I", payload))
+
+
+def _varint(payload: bytes, pos: int) -> Tuple[int, int]:
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(payload):
+            raise ValueError("truncated varint")
+        byte = payload[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+
+def decode_delta(payload: bytes) -> List[int]:
+    """Decode a RAW_FLUX_FMT_DELTA payload into flux words.
+
+    The predictor restarts at 0 for every chunk, so each chunk payload
+    decodes on its own.
+    """
+    words = []
+    prev = 0
+    pos = 0
+
+    while pos < len(payload):
+        token, pos = _varint(payload, pos)
+        word = 0
+        if token & 1:
+            flags = token >> 1
+            delta, pos = _varint(payload, pos)
+            if flags & RAW_FLUX_ESC_INDEX:
+                word |= FLUX_FLAG_INDEX
+            if flags & RAW_FLUX_ESC_OVERFLOW:
+                word |= FLUX_FLAG_OVERFLOW
+            if flags & RAW_FLUX_ESC_WEAK:
+                word |= FLUX_FLAG_WEAK
+        else:
+            delta = token >> 1
+
+        prev = (prev + delta) & FLUX_TIMESTAMP_MASK
+        words.append(word | prev)
+
+    return words
+
+
+def encode_delta(words: Iterable[int]) -> bytes:
+    """Encode flux words as RAW_FLUX_FMT_DELTA (reference for tests)."""
+    out = bytearray()
+    prev = 0
+
+    def put(v: int):
+        while v >= 0x80:
+            out.append((v & 0x7F) | 0x80)
+            v >>= 7
+        out.append(v)
+
+    for word in words:
+        ts = word & FLUX_TIMESTAMP_MASK
+        delta = (ts - prev) & FLUX_TIMESTAMP_MASK
+        prev = ts
+        flags = 0
+        if word & FLUX_FLAG_INDEX:
+            flags |= RAW_FLUX_ESC_INDEX
+        if word & FLUX_FLAG_OVERFLOW:
+            flags |= RAW_FLUX_ESC_OVERFLOW
+        if word & FLUX_FLAG_WEAK:
+            flags |= RAW_FLUX_ESC_WEAK
+        if flags:
+            out.append((flags << 1) | 1)
+            put(delta)
+        else:
+            put(delta << 1)
+
+    return bytes(out)
+
+
+def decode_payload(payload: bytes, fmt: int) -> List[int]:
+    """Decode one chunk payload in the negotiated format."""
+    if fmt == RAW_FLUX_FMT_DELTA:
+        return decode_delta(payload)
+    if fmt == RAW_FLUX_FMT_RAW32:
+        return decode_raw32(payload)
+    raise ValueError(f"unknown flux format {fmt}")
+
+#==============================================================================
+# Stream Parsing
+#==============================================================================
+
+@dataclass
+class CaptureInfo:
+    """Trailer frame closing a READ_FLUX stream."""
+    status: int
+    sample_count: int
+    index_count: int
+    overflow_count: int
+    duration_us: int
+
+
+def iter_chunks(stream: bytes) -> Iterator[Tuple[int, int, bytes]]:
+    """Split a concatenated stream into (status, opcode, payload) frames."""
+    pos = 0
+    while pos + HEADER.size <= len(stream):
+        sig, status, opcode, length = HEADER.unpack_from(stream, pos)
+        if sig != RAW_SIGNATURE:
+            raise ValueError(f"bad frame signature at offset {pos}")
+        pos += HEADER.size
+        yield status, opcode, stream[pos:pos + length]
+        pos += length
+
+
+def decode_stream(stream: bytes, fmt: int) -> Tuple[List[int], Optional[CaptureInfo]]:
+    """Decode a full READ_FLUX stream into flux words plus its trailer."""
+    words: List[int] = []
+    info = None
+
+    for status, opcode, payload in iter_chunks(stream):
+        if opcode == RAW_CMD_READ_FLUX:
+            words.extend(decode_payload(payload, fmt))
+        elif opcode == RAW_CMD_CAPTURE_STOP:
+            info = CaptureInfo(status, *CAPTURE_INFO.unpack_from(payload))
+            break
+
+    return words, info
+
+
+def flux_intervals(words: Iterable[int]) -> List[int]:
+    """Transition-to-transition intervals in sample ticks (index words skipped)."""
+    intervals = []
+    prev = None
+    for word in words:
+        ts = word & FLUX_TIMESTAMP_MASK
+        if word & FLUX_FLAG_INDEX:
+            continue
+        if prev is not None:
+            intervals.append((ts - prev) & FLUX_TIMESTAMP_MASK)
+        prev = ts
+    return intervals
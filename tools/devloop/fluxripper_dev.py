@@ -25,6 +25,8 @@ from enum import Enum
 import threading
 import queue
 
+import cli_bin
+
 #==============================================================================
 # Configuration
 #==============================================================================
@@ -69,6 +71,7 @@ class CDCConsole:
         self.baud = baud
         self.serial: Optional[serial.Serial] = None
         self.response_queue = queue.Queue()
+        self.frame_queue = queue.Queue()
         self.reader_thread: Optional[threading.Thread] = None
         self.running = False
 
@@ -102,11 +105,14 @@ class CDCConsole:
     def _reader_loop(self):
         """Background thread to read responses."""
         buffer = ""
+        splitter = cli_bin.FrameSplitter()
         while self.running:
             try:
                 if self.serial and self.serial.in_waiting:
-                    data = self.serial.read(self.serial.in_waiting).decode('utf-8', errors='replace')
-                    buffer += data
+                    text, frames = splitter.feed(self.serial.read(self.serial.in_waiting))
+                    for frame in frames:
+                        self.frame_queue.put(frame)
+                    buffer += text.decode('utf-8', errors='replace')
 
                     # Split on newlines
                     while '\n' in buffer:
@@ -157,6 +163,24 @@ class CDCConsole:
         lines = self.send(cmd)
         return '\n'.join(lines)
 
+    def command_bin(self, cmd: str) -> Optional[Dict]:
+        """Send command with --bin, return its decoded field map."""
+        while not self.frame_queue.empty():
+            try:
+                self.frame_queue.get_nowait()
+            except queue.Empty:
+                break
+
+        self.send(f"{cmd} {cli_bin.CLI_BIN_FLAG}")
+
+        # The frame precedes the prompt that ended send()
+        try:
+            frame = self.frame_queue.get(timeout=0.5)
+            return cli_bin.decode_frame(frame)
+        except (queue.Empty, cli_bin.FrameError) as e:
+            print(f"Binary response for '{cmd}' failed: {e or 'timeout'}")
+            return None
+
     def read_memory(self, addr: int) -> Optional[int]:
         """Read 32-bit word from memory."""
         response = self.command(f"dbg r {addr:08x}")
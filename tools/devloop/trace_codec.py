@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""
+FluxRipper Trace Dump Codec
+
+Host-side decoding of the TRACE_DUMP frame (see raw_protocol.h) and
+conversion of the debug trace buffer to VCD for a waveform viewer.
+
+Usage: trace_codec.py dump.bin out.vcd
+
+Created: 2025-12-11 21:10
+License: BSD-3-Clause
+"""
+
+import struct
+import sys
+from dataclasses import dataclass
+from typing import List, Optional, TextIO, Tuple
+
+#==============================================================================
+# Protocol Constants (mirror raw_protocol.h)
+#==============================================================================
+
+RAW_SIGNATURE = 0x46525751
+RAW_CMD_TRACE_DUMP = 0x60
+RAW_RSP_OK = 0x00
+
+RAW_TRACE_MAGIC = 0x52545246
+RAW_TRACE_VERSION = 1
+RAW_TRACE_WRAPPED = 1 << 0
+RAW_TRACE_TRIGGERED = 1 << 1
+
+HEADER = struct.Struct("<IBBH")          # raw_rsp_header_t
+TRACE_INFO = struct.Struct("<IBBHHHI")   # raw_trace_info_t
+TRACE_ENTRY = struct.Struct("<IBBH")     # raw_trace_entry_t
+
+TIMESTAMP_WRAP = 1 << 16
+
+#==============================================================================
+# Dump Parsing
+#==============================================================================
+
+@dataclass
+class TraceEntry:
+    """One trace buffer entry with its timestamp unwrapped."""
+    time: int                   # Clock cycles since the oldest entry
+    type: int                   # trace_event_t
+    source: int                 # trace_source_t
+    data: int
+
+
+@dataclass
+class TraceDump:
+    wrapped: bool
+    trigger: Optional[int]      # Entry index, None if not triggered
+    clock_hz: int
+    entries: List[TraceEntry]
+
+
+def parse_dump(frame: bytes) -> TraceDump:
+    """Decode a TRACE_DUMP frame (response header included)."""
+    sig, status, opcode, length = HEADER.unpack_from(frame, 0)
+    if sig != RAW_SIGNATURE or opcode != RAW_CMD_TRACE_DUMP:
+        raise ValueError("not a TRACE_DUMP frame")
+    if status != RAW_RSP_OK:
+        raise ValueError(f"TRACE_DUMP failed, status 0x{status:02X}")
+
+    pos = HEADER.size
+    magic, version, flags, count, trigger_pos, entry_size, clock_hz = \
+        TRACE_INFO.unpack_from(frame, pos)
+    if magic != RAW_TRACE_MAGIC or version != RAW_TRACE_VERSION:
+        raise ValueError("bad trace header")
+    if entry_size < TRACE_ENTRY.size or length < TRACE_INFO.size + count * entry_size:
+        raise ValueError("truncated trace dump")
+    pos += TRACE_INFO.size
+
+    # 16-bit cycle stamps: assume less than one wrap between neighbours.
+    # The buffer takes at most one entry per clock, so a zero step is a
+    # full wrap.
+    entries = []
+    time = 0
+    prev = None
+    for _ in range(count):
+        data, source, type_, ts = TRACE_ENTRY.unpack_from(frame, pos)
+        pos += entry_size
+        if prev is not None:
+            step = (ts - prev) % TIMESTAMP_WRAP
+            time += step if step else TIMESTAMP_WRAP
+        prev = ts
+        entries.append(TraceEntry(time, type_, source, data))
+
+    trigger = trigger_pos if flags & RAW_TRACE_TRIGGERED else None
+    return TraceDump(bool(flags & RAW_TRACE_WRAPPED), trigger, clock_hz, entries)
+
+#==============================================================================
+# VCD Export
+#==============================================================================
+
+def _timescale(clock_hz: int) -> Tuple[str, int]:
+    """Coarsest VCD timescale (1/10/100 ns, ps or fs) dividing the clock period."""
+    period_fs = round(1e15 / clock_hz)
+    for unit, fs in (("ns", 10**6), ("ps", 10**3), ("fs", 1)):
+        for mult in (100, 10, 1):
+            if period_fs % (mult * fs) == 0:
+                return f"{mult} {unit}", period_fs // (mult * fs)
+    return "1 fs", period_fs
+
+
+def write_vcd(dump: TraceDump, out: TextIO) -> None:
+    """Write a trace dump as VCD.
+
+    Each entry drives type, source and data at its own time; "event"
+    toggles on every entry so repeated identical events stay visible, and
+    "trigger" pulses high for the entry the trigger fired on.
+    """
+    scale, ticks = _timescale(dump.clock_hz)
+
+    out.write("$comment FluxRipper trace buffer dump $end\n")
+    out.write(f"$timescale {scale} $end\n")
+    out.write("$scope module trace $end\n")
+    out.write("$var wire 1 ! event $end\n")
+    out.write("$var wire 1 \" trigger $end\n")
+    out.write("$var wire 8 # type [7:0] $end\n")
+    out.write("$var wire 8 $ source [7:0] $end\n")
+    out.write("$var wire 32 % data [31:0] $end\n")
+    out.write("$upscope $end\n")
+    out.write("$enddefinitions $end\n")
+
+    out.write("#0\n$dumpvars\n0!\n0\"\nb0 #\nb0 $\nb0 %\n$end\n")
+
+    toggle = 0
+    for index, entry in enumerate(dump.entries):
+        toggle ^= 1
+        out.write(f"#{entry.time * ticks}\n")
+        out.write(f"{toggle}!\n")
+        out.write(f"{1 if index == dump.trigger else 0}\"\n")
+        out.write(f"b{entry.type:b} #\n")
+        out.write(f"b{entry.source:b} $\n")
+        out.write(f"b{entry.data:b} %\n")
+
+    if dump.entries:
+        out.write(f"#{(dump.entries[-1].time + 1) * ticks}\n")
+
+#==============================================================================
+# CLI
+#==============================================================================
+
+def main():
+    import argparse
+
+    parser = argparse.ArgumentParser(description="FluxRipper trace dump to VCD")
+    parser.add_argument("dump", help="TRACE_DUMP frame as received")
+    parser.add_argument("vcd", help="VCD file to write")
+
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        dump = parse_dump(f.read())
+
+    with open(args.vcd, "w") as f:
+        write_vcd(dump, f)
+
+    trig = f", trigger at entry {dump.trigger}" if dump.trigger is not None else ""
+    print(f"{len(dump.entries)} entries{' (wrapped)' if dump.wrapped else ''}{trig}")
+    sys.exit(0)
+
+
+if __name__ == "__main__":
+    main()
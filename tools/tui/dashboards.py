@@ -10,11 +10,17 @@ diagnostics and instrumentation data in a terminal interface.
 """
 
 import curses
+import sys
 import time
 import random
 from dataclasses import dataclass
+from pathlib import Path
 from typing import List, Optional
 
+# Flux stream decoder is shared with the devloop tools
+sys.path.insert(0, str(Path(__file__).parent.parent / "devloop"))
+import flux_codec
+
 # =============================================================================
 # Data Structures (matching C structures)
 # =============================================================================
@@ -75,6 +81,25 @@ class DriveStats:
     seek_count: int = 0
     errors: int = 0
 
+# =============================================================================
+# Flux Stream Helpers
+# =============================================================================
+
+def flux_histogram_from_stream(stream: bytes, fmt: int, bins: int = 32,
+                               lo_us: float = 1.0, hi_us: float = 8.0) -> List[int]:
+    """Bin a READ_FLUX stream (raw or delta-encoded) for the signal view."""
+    words, _ = flux_codec.decode_stream(stream, fmt)
+    hist = [0] * bins
+    ticks_per_us = flux_codec.FLUX_SAMPLE_RATE / 1e6
+    scale = bins / (hi_us - lo_us)
+
+    for interval in flux_codec.flux_intervals(words):
+        slot = int((interval / ticks_per_us - lo_us) * scale)
+        if 0 <= slot < bins:
+            hist[slot] += 1
+
+    return hist
+
 # =============================================================================
 # Dashboard Base Class
 # =============================================================================
@@ -715,6 +740,19 @@ class DriveDashboard(Dashboard):
 # Main Application
 # =============================================================================
 
+def generate_mock_flux_stream(transitions: int = 4000) -> bytes:
+    """Mock delta-encoded READ_FLUX chunk of MFM flux (2/3/4 us cells)."""
+    words = []
+    t = 0
+    for _ in range(transitions):
+        t = (t + random.choice((400, 600, 800)) + random.randint(-20, 20)) \
+            & flux_codec.FLUX_TIMESTAMP_MASK
+        words.append(t)
+
+    payload = flux_codec.encode_delta(words)
+    return flux_codec.HEADER.pack(flux_codec.RAW_SIGNATURE, flux_codec.RAW_RSP_OK,
+                                  flux_codec.RAW_CMD_READ_FLUX, len(payload)) + payload
+
 def generate_mock_data():
     """Generate mock data for demo"""
     sys_info = SystemInfo(
@@ -786,7 +824,8 @@ def main(stdscr):
     amplitude_history = [random.randint(700, 850) for _ in range(60)]
     jitter_history = [random.randint(10, 30) for _ in range(60)]
     rpm_history = [random.randint(297, 303) for _ in range(60)]
-    flux_histogram = [random.randint(100, 10000) for _ in range(32)]
+    flux_histogram = flux_histogram_from_stream(generate_mock_flux_stream(),
+                                                flux_codec.RAW_FLUX_FMT_DELTA)
 
     while True:
         # Generate mock data